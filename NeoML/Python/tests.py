@@ -2850,6 +2850,10 @@ class ClusteringTestCase(MultithreadedTestCase):
     def test_kmeans(self):
         self._test_clusterize('KMeans', dict(max_iteration_count=100, cluster_count=6, init='k++'))
 
+    def test_kmeans_minibatch(self):
+        self._test_clusterize('KMeans', dict(max_iteration_count=100, cluster_count=6, algo='minibatch',
+            mini_batch_size=8))
+
 
 class TestPca(TestCase):
     def test_full_svd(self):
@@ -59,4 +59,53 @@ private:
 	CString fileName; // the file name (needed for the CBaseFile::GetFileName() method)
 };
 
+//------------------------------------------------------------------------------------------------------------
+
+// The read-only NeoML archive file mapped into memory
+// The file pages are shared between all processes which map the same file
+// The mapping is copy-on-write: the changes of the mapped memory are private and are never written to the file
+class NEOML_API CMappedArchiveFile : public CBaseFile {
+public:
+	CMappedArchiveFile() = default;
+	// Creates an object and maps the file
+	// The same as calling a constructor without parameters and then the Open method
+	explicit CMappedArchiveFile( const char* fileName );
+	~CMappedArchiveFile() override { Abort(); }
+
+	// Checks if the file is open
+	bool IsOpen() const { return mapping != nullptr; }
+
+	// Maps the file into memory
+	void Open( const char* fileName );
+
+	// The mapped file contents
+	const char* GetData() const { return data; }
+	// The object that keeps the mapping alive after the file is closed
+	IObject* GetMapping() const { return mapping; }
+
+	// CBaseFile class methods
+#ifdef FINEOBJ_VERSION
+	CUnicodeString GetFileName() const override { return fileName.CreateUnicodeString( CP_UTF8 ); }
+#else
+	const char* GetFileName() const override { return fileName; }
+#endif
+	int Read( void*, int bytesCount ) override;
+	void Write( const void*, int bytesCount ) override;
+	__int64 GetPosition() const override;
+	__int64 Seek( __int64 offset, TSeekPosition from ) override;
+	void SetLength( __int64 newLength ) override;
+	__int64 GetLength() const override;
+	void Abort() final;
+	void Flush() override;
+	void Close() override;
+	bool IsEndOfFile() const override;
+
+private:
+	CPtr<IObject> mapping; // the mapped memory
+	const char* data{}; // the file contents
+	__int64 length{}; // the file length
+	__int64 position{}; // the current position
+	CString fileName; // the file name (needed for the CBaseFile::GetFileName() method)
+};
+
 } // namespace NeoML
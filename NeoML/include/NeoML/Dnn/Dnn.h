@@ -85,6 +85,8 @@ class CDnn;
 class CDnnLayerGraph;
 class CBaseLayer;
 class CCompositeLayer;
+class CDnnMemoryPlan;
+class CDnnBranchScheduler;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -422,6 +424,8 @@ private:
 	friend class CDnnLayerGraph;
 	friend class CDnnSolver;
 	friend class CCompositeLayer;
+	friend class CDnnMemoryPlan;
+	friend class CDnnBranchScheduler;
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -491,6 +495,23 @@ NEOML_API IMathEngine& GetMultiThreadCpuMathEngine();
 // The engine SHOULD be destroyed after use with standart delete
 NEOML_API IMathEngine* GetRecommendedGpuMathEngine( size_t memoryLimit );
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The critical path of the network: the chain of dependent layers with the largest total cost
+// The cost of a layer is its run time in nanoseconds if the profiling is enabled (see CDnn::EnableProfile)
+// Otherwise the cost of each layer is 1
+struct CDnnCriticalPath {
+	// The names of the layers on the path, from the first to the last
+	CArray<CString> Layers;
+	// The total cost of the layers on the path
+	int64_t PathCost;
+	// The total cost of all the layers in the network
+	// TotalCost / PathCost is the upper bound for the speedup from running the independent layers at the same time
+	int64_t TotalCost;
+
+	CDnnCriticalPath() : PathCost( 0 ), TotalCost( 0 ) {}
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
 // CDnn class represents a neural network
@@ -586,9 +607,41 @@ public:
 	// When loading from checkpoint creates new solver (old pointers will point to an object, not used by this net anymore)
 	void SerializeCheckpoint( CArchive& archive );
 
+	// Stores the network into the mapped model file
+	// The parameter blobs are written after the network and aligned, so they could be used without copying
+	void StoreMapped( const char* fileName );
+	// Loads the network from the mapped model file created by StoreMapped
+	// The file is mapped into memory; on CPU the parameter blobs point to the mapped memory directly,
+	// so the processes loading the same file share its pages; the changes of the parameters are never written to the file
+	void LoadMapped( const char* fileName );
+
 	// Enables profiling for all the layers in the network
 	void EnableProfile( bool profile );
 
+	// Enables the static memory planning for inference (off by default)
+	// RunOnce places the output blobs of the layers into one preallocated buffer
+	// so that the blobs which are not used at the same time share the memory
+	// The blobs in the sink layers are valid until the next run
+	// Should not be used with the layers that keep their output blobs between runs
+	void EnableStaticMemoryPlanning( bool enable );
+	bool IsStaticMemoryPlanningEnabled() const { return memoryPlan != nullptr; }
+	// Gets the size of the buffer used by the static memory planning (in bytes)
+	// Becomes available after the first RunOnce call
+	size_t GetStaticMemoryPlanSize() const;
+
+	// Enables running the independent layers at the same time in RunOnce (off by default)
+	// threadCount is the maximum number of layers running at the same time (0 means the number of OpenMP threads)
+	// The layers running at the same time use one thread each,
+	// the layers without independent neighbours use all the threads of the math engine
+	// Works only on CPU; the network is run sequentially if the static memory planning is enabled
+	// The layers must not use the shared state of the network (e.g. Random()) in RunOnce
+	void EnableParallelBranches( int threadCount = 0 );
+	void DisableParallelBranches();
+	bool IsParallelBranchesEnabled() const { return branchScheduler != nullptr; }
+
+	// Finds the critical path of the network (should be called after RunOnce)
+	void GetCriticalPath( CDnnCriticalPath& path ) const;
+
 private:
 	// Adds or deletes a layer
 	void AddLayerImpl(CBaseLayer& layer) override;
@@ -631,13 +684,20 @@ private:
 	bool autoRestartMode;
 	// The low memory use mode
 	bool isReuseMemoryMode;
+	// The static memory plan (null if the planning is off)
+	CPtr<CDnnMemoryPlan> memoryPlan;
+	// The scheduler of the independent layers (null if the layers are run sequentially)
+	CPtr<CDnnBranchScheduler> branchScheduler;
 
 	void setProcessingParams(bool isRecurrentMode, int sequenceLength, bool isReverseSequense, bool isBackwardPerformed);
 	void runOnce(int curSequencePos);
 	void backwardRunAndLearnOnce(int curSequencePos);
 	void reshape();
 	void rebuild();
+	bool isReshapePending() const;
+	bool isBranchSchedulerUsed() const;
 	size_t getOutputBlobsSize() const;
+	void getExecutionOrder( CArray<CBaseLayer*>& order ) const;
 
 	friend class CBaseLayer;
 	friend class CCompositeLayer;
@@ -232,27 +232,7 @@ private:
 	friend class CDnnBlobClassRegistrar;
 };
 
-inline void SerializeBlob( IMathEngine& mathEngine, CArchive& archive, CPtr<CDnnBlob>& blob )
-{
-	if( archive.IsStoring() ) {
-		bool isNull = ( blob == 0 );
-		archive << isNull;
-		if( !isNull ) {
-			blob->Serialize( archive );
-		}
-	} else if( archive.IsLoading() ) {
-		bool isNull = false;
-		archive >> isNull;
-		if( isNull ) {
-			blob = 0;
-		} else {
-			blob = FINE_DEBUG_NEW CDnnBlob( mathEngine );
-			blob->Serialize( archive );
-		}
-	} else {
-		NeoAssert( false );
-	}
-}
+NEOML_API void SerializeBlob( IMathEngine& mathEngine, CArchive& archive, CPtr<CDnnBlob>& blob );
 
 inline void SerializeBlobs( IMathEngine& mathEngine, CArchive& archive, CObjectArray<CDnnBlob>& blobs )
 {
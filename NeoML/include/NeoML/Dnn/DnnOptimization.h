@@ -27,13 +27,29 @@ struct NEOML_API CDnnOptimizationReport {
 	int MobileNetV2NonResidualBlocks;
 	// Number of optimized MobileNetV2 blocks with residual connection
 	int MobileNetV2ResidualBlocks;
+	// Number of layers removed as they don't change the data during inference
+	int RemovedTrivialLayers;
+	// Number of batch normalizations merged into the preceding layers
+	int FusedBatchNormalizations;
+	// Number of ReLU activations merged into the preceding layers (the other activations aren't merged)
+	int FusedActivations;
 };
 
 // Optimizes inference of given CDnn at the cost of trainability
 //
-// List of supported optimizations:
+// The optimizations are applied in the following order, every one is repeated while its pattern is found:
 //
-//     1. MobileNetV2 block optimizations.
+//     1. Trivial layers removal.
+//        Removes CDropoutLayer, CLinearLayer with multiplier 1 and free term 0, CTransposeLayer
+//        which swaps the dimension with itself and the pairs of CTransposeLayer swapping the same dimensions.
+//        Removes CTransformLayer if its output is transformed once again by CTransformLayer
+//        which doesn't depend on the input dimensions (only O_SetSize and O_Remainder rules)
+//
+//     2. Batch normalization fusion.
+//        Merges CBatchNormalizationLayer into the weights of the preceding CConvLayer (for channel-based
+//        normalization only) or CFullyConnectedLayer
+//
+//     3. MobileNetV2 block optimizations.
 //        Replaces the non-residual blocks of layers
 //
 //            conv1x1 (expand) -> relu (expandReLU) -> channelwiseConv3x3 -> relu (channelwiseReLU) -> conv1x1 (down)
@@ -46,6 +62,12 @@ struct NEOML_API CDnnOptimizationReport {
 //
 //        with optimized CMobileNetV2BlockLayer
 //
+//     4. Activation fusion.
+//        Merges CReLULayer into the preceding CConvLayer, CFullyConnectedLayer or CEltwiseSumLayer
+//        (see their SetFusedReLU method)
+//
+// The layer is merged into the preceding one only if nothing else is connected to the output of the preceding layer
+// The layers inside of the composite layers aren't optimized
 CDnnOptimizationReport NEOML_API OptimizeDnn( CDnn& dnn );
 
 } // namespace NeoML
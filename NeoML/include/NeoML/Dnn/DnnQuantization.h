@@ -0,0 +1,72 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/NeoMLDefs.h>
+
+namespace NeoML {
+
+class CDnn;
+class CDnnBlob;
+
+// The maximum absolute value of an int8 quantized number
+const int Int8QuantizationMaxValue = 127;
+
+// Returns the scale for the values in [-maxAbs; maxAbs] range
+// 0 means that the scale should be calculated dynamically
+inline float GetInt8Scale( float maxAbs ) { return maxAbs / Int8QuantizationMaxValue; }
+
+// Returns the maximum absolute value of the blob data
+float NEOML_API CalcMaxAbsValue( const CDnnBlob& blob );
+
+// Struct which contains the details of quantization result
+struct NEOML_API CDnnQuantizationReport {
+	// Number of fully-connected layers switched to int8 inference
+	int FullyConnectedLayers;
+	// Number of convolution layers switched to int8 inference
+	int ConvLayers;
+	// Number of layers which will use dynamic quantization of the input (no calibration data)
+	int DynamicInputLayers;
+};
+
+// Post-training int8 quantization of CDnn inference (supported only on CPU)
+//
+// The weights of CFullyConnectedLayer and CConvLayer (including the ones inside the composite layers)
+// are quantized to int8 with a separate scale for each output channel. By default the float weights are kept
+// in the network, so it may be calibrated again, trained or switched back to float inference at any moment.
+// With dropFloatWeights the float weights are freed and the network is inference-only: only the int8 weights
+// and the scales are stored in memory and serialized.
+//
+// Usage:
+//
+//     BeginInt8Calibration( dnn );
+//     ... run the network on the representative data ...
+//     QuantizeDnnToInt8( dnn );
+//
+// The calibration collects the ranges of the inputs of the layers.
+// Without calibration the inputs are quantized dynamically on every run which is slower and a bit more precise.
+
+// Resets the collected ranges and starts the calibration
+void NEOML_API BeginInt8Calibration( CDnn& dnn );
+
+// Stops the calibration and switches the supported layers to int8 inference
+// The network should have been run or loaded so that the float weights are present
+CDnnQuantizationReport NEOML_API QuantizeDnnToInt8( CDnn& dnn, bool dropFloatWeights = false );
+
+// Switches all the layers back to float inference (impossible after the float weights are dropped)
+void NEOML_API DisableInt8Inference( CDnn& dnn );
+
+} // namespace NeoML
@@ -505,6 +505,10 @@ void CActivationDesc::assertIsTypeCompatible() const {
 // Creates an activation layer using the specified activation function
 CPtr<CBaseLayer> NEOML_API CreateActivationLayer( IMathEngine& mathEngine, const CActivationDesc& activation );
 
+// Applies ReLU with the given upper threshold (see CReLULayer) to the blob in place
+// Used by the layers with the fused ReLU on the math engines which can't apply it inside the kernel (all except CPU)
+void NEOML_API ApplyFusedReLU( CDnnBlob& blob, float upperThreshold );
+
 //------------------------------------------------------------------------------------------------------------
 
 } // namespace NeoML
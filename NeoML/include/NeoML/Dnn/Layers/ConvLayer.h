@@ -122,6 +122,32 @@ public:
 
 	void Serialize( CArchive& archive ) override;
 
+	void SetFilterData( const CPtr<CDnnBlob>& newFilter ) override;
+
+	// Int8 quantized inference (supported only on CPU, ignored during training)
+	// Each filter is quantized separately, the input is quantized with the scale of GetInt8InputMaxAbs() / 127
+	// If GetInt8InputMaxAbs() is 0 the scale is calculated for every filter window separately
+	// The quantized filter is recalculated after reshape, learning or SetFilterData call
+	bool IsInt8InferenceEnabled() const { return isInt8Enabled; }
+	void SetInt8InferenceEnabled( bool enable );
+	float GetInt8InputMaxAbs() const { return int8InputMaxAbs; }
+	void SetInt8InputMaxAbs( float maxAbs );
+	// Int8 calibration: while it is on, the layer tracks the maximum absolute value of the input on every run
+	bool IsInt8CalibrationEnabled() const { return isInt8Calibration; }
+	void SetInt8CalibrationEnabled( bool enable ) { isInt8Calibration = enable; }
+	// Inference-only int8 mode: the float filter is freed, only the quantized filter is kept and serialized
+	// The int8 inference should be enabled and may not be disabled; the layer may not be trained
+	// GetFilterData returns an empty blob; SetFilterData switches the layer back to the float filter
+	bool IsFloatFilterDropped() const { return isFloatFilterDropped; }
+	void DropFloatFilter();
+
+	// ReLU applied to the output, OptimizeDnn merges the following CReLULayer into the layer this way
+	// The upper threshold has the same meaning as in CReLULayer
+	// The layer with the fused ReLU may be used only for inference
+	bool IsReLUFused() const { return isReLUFused; }
+	float GetFusedReLUThreshold() const { return fusedReLUThreshold; }
+	void SetFusedReLU( bool isFused, float upperThreshold = 0 );
+
 protected:
 	~CConvLayer() override;
 
@@ -131,13 +157,25 @@ protected:
 	void LearnOnce() override;
 	int BlobsForBackward() const override { return 0; }
 	int BlobsForLearn() const override { return TInputBlobs; }
+	void FilterLayerParams( float threshold ) override;
 
 private:
 	CConvolutionDesc* convDesc; // the convolution descriptor
+	bool isInt8Enabled; // indicates if the int8 inference is enabled
+	bool isInt8Calibration; // indicates if the input range is being collected
+	float int8InputMaxAbs; // the expected maximum absolute value of the input (0 for dynamic quantization)
+	CQuantizedMatrixDesc* quantizedFilter; // the quantized filter, created on the first int8 run
+	bool isFloatFilterDropped; // indicates if only the quantized filter is kept
+	int quantizedFilterSize; // the object size of the quantized filter if the float filter is dropped
+	bool isReLUFused; // indicates if ReLU is applied to the output
+	float fusedReLUThreshold; // the upper threshold of the fused ReLU
 
 	void calcOutputBlobSize(int& outputHeight, int& outputWidth) const;
 	void initConvDesc();
 	void destroyConvDesc();
+	bool isInt8InferencePossible() const;
+	void destroyQuantizedFilter();
+	void onFilterChanged();
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -36,14 +36,27 @@ protected:
 class NEOML_API CEltwiseSumLayer : public CEltwiseBaseLayer {
 	NEOML_DNN_LAYER( CEltwiseSumLayer )
 public:
-	explicit CEltwiseSumLayer( IMathEngine& mathEngine ) : CEltwiseBaseLayer( mathEngine, "CCnnEltwiseSumLayer" ) {}
+	explicit CEltwiseSumLayer( IMathEngine& mathEngine ) :
+		CEltwiseBaseLayer( mathEngine, "CCnnEltwiseSumLayer" ), isReLUFused( false ), fusedReLUThreshold( 0 ) {}
 
 	void Serialize( CArchive& archive ) override;
 
+	// ReLU applied to the output, OptimizeDnn merges the following CReLULayer into the layer this way
+	// The upper threshold has the same meaning as in CReLULayer
+	// The layer with the fused ReLU may be used only for inference
+	bool IsReLUFused() const { return isReLUFused; }
+	float GetFusedReLUThreshold() const { return fusedReLUThreshold; }
+	void SetFusedReLU( bool isFused, float upperThreshold = 0 );
+
 protected:
+	void Reshape() override;
 	void RunOnce() override;
 	void BackwardOnce() override;
 	int BlobsForBackward() const override { return 0; }
+
+private:
+	bool isReLUFused; // indicates if ReLU is applied to the output
+	float fusedReLUThreshold; // the upper threshold of the fused ReLU
 };
 
 NEOML_API CLayerWrapper<CEltwiseSumLayer> Sum();
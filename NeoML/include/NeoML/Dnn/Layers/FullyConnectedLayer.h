@@ -56,6 +56,30 @@ public:
 	bool IsZeroFreeTerm() const { return isZeroFreeTerm; }
 	void SetZeroFreeTerm(bool _isZeroFreeTerm);
 
+	// Int8 quantized inference (supported only on CPU, ignored during training)
+	// The weights are quantized per neuron, the input is quantized with the scale of GetInt8InputMaxAbs() / 127
+	// If GetInt8InputMaxAbs() is 0 the scale is calculated for every object separately
+	// The quantized weights are recalculated after reshape, learning or SetWeightsData call
+	bool IsInt8InferenceEnabled() const { return isInt8Enabled; }
+	void SetInt8InferenceEnabled( bool enable );
+	float GetInt8InputMaxAbs() const { return int8InputMaxAbs; }
+	void SetInt8InputMaxAbs( float maxAbs );
+	// Int8 calibration: while it is on, the layer tracks the maximum absolute value of the input on every run
+	bool IsInt8CalibrationEnabled() const { return isInt8Calibration; }
+	void SetInt8CalibrationEnabled( bool enable ) { isInt8Calibration = enable; }
+	// Inference-only int8 mode: the float weights are freed, only the quantized weights are kept and serialized
+	// The int8 inference should be enabled and may not be disabled; the layer may not be trained
+	// GetWeightsData returns an empty blob; SetWeightsData switches the layer back to the float weights
+	bool AreFloatWeightsDropped() const { return areFloatWeightsDropped; }
+	void DropFloatWeights();
+
+	// ReLU applied to the output, OptimizeDnn merges the following CReLULayer into the layer this way
+	// The upper threshold has the same meaning as in CReLULayer
+	// The layer with the fused ReLU may be used only for inference
+	bool IsReLUFused() const { return isReLUFused; }
+	float GetFusedReLUThreshold() const { return fusedReLUThreshold; }
+	void SetFusedReLU( bool isFused, float upperThreshold = 0 );
+
 	CPtr<CDnnBlob>& Weights() { return paramBlobs[0]; }
 	CPtr<CDnnBlob>& FreeTerms() { return paramBlobs[1]; }	// the free term matrix
 	const CPtr<CDnnBlob>& Weights() const { return paramBlobs[0]; }
@@ -79,6 +103,17 @@ protected:
 private:
 	int numberOfElements; // the number of elements (neurons) of the fully-connected layer
 	bool isZeroFreeTerm; // indicates if the free term should be set to zero
+	bool isInt8Enabled; // indicates if the int8 inference is enabled
+	bool isInt8Calibration; // indicates if the input range is being collected
+	float int8InputMaxAbs; // the expected maximum absolute value of the input (0 for dynamic quantization)
+	CQuantizedMatrixDesc* quantizedWeights; // the quantized weights, created on the first int8 run
+	bool areFloatWeightsDropped; // indicates if only the quantized weights are kept
+	int quantizedWeightsWidth; // the object size of the quantized weights if the float weights are dropped
+	bool isReLUFused; // indicates if ReLU is applied to the output
+	float fusedReLUThreshold; // the upper threshold of the fused ReLU
+
+	bool isInt8InferencePossible() const;
+	void destroyQuantizedWeights();
 };
 
 NEOML_API CLayerWrapper<CFullyConnectedLayer> FullyConnected(
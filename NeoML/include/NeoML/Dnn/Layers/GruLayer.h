@@ -47,6 +47,12 @@ public:
 	void SetGateWeightsData(CDnnBlob* newWeights) { gateLayer->SetWeightsData(newWeights); }
 	void SetGateFreeTermData(CDnnBlob* newFreeTerm) { gateLayer->SetFreeTermData(newFreeTerm); }
 
+	// The input #2 is used for the initial state if the sequences are packed
+	void SetPackedSequence( bool isPacked ) override;
+
+protected:
+	void RunOnce() override;
+
 private:
 	// The indices of the gates in the hidden layer output
 	enum TGateOut {
@@ -62,6 +68,7 @@ private:
 	CPtr<CBackLinkLayer> mainBackLink;
 
 	void buildLayer();
+	void runWholeSequence();
 };
 
 NEOML_API CLayerWrapper<CGruLayer> Gru( int hiddenSize );
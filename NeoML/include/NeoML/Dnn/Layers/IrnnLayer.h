@@ -68,6 +68,7 @@ public:
 
 protected:
 	void Reshape() override;
+	void RunOnce() override;
 
 private:
 	float identityScale; // scale of identity matrix (recurrent weights initialization)
@@ -78,6 +79,7 @@ private:
 	CPtr<CBackLinkLayer> backLink; // Back link for transferring Y_t-1 from formula above
 
 	void buildLayer();
+	void runWholeSequence();
 
 	void identityInitialization( CDnnBlob& blob );
 	void normalInitialization( CDnnBlob& blob );
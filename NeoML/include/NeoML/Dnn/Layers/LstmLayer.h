@@ -66,6 +66,9 @@ public:
 	bool IsInCompatibilityMode() const { return isInCompatibilityMode; }
 	void SetCompatibilityMode( bool compatibilityMode );
 
+	// The inputs #2 and #3 are used for the initial state and history if the sequences are packed
+	void SetPackedSequence( bool isPacked ) override;
+
 	void RunOnce() override;
 	void Reshape() override;
 
@@ -87,15 +90,17 @@ private:
 
 		void Reset() { isInitialized = false; }
 		void Init( CLstmLayer* lstmLayer );
+		// Changes the number of the sequences processed by the LSTM step
+		void SetObjectCount( CLstmLayer* lstmLayer, int objectCount );
 
-		CPtr<CDnnBlob>& StateBacklinkBlob() { return stateBacklinkBlob; }
 		CPtr<CDnnBlob>& InputFullyConnectedResult() { return inputFullyConnectedResult; }
 		CPtr<CDnnBlob>& ReccurentFullyConnectedResult() { return reccurentFullyConnectedResult; }
+		CPtr<CDnnBlob>& InputSequenceFullyConnectedResult() { return inputSequenceFullyConnectedResult; }
 		CLstmDesc& LstmDesc() { return *lstmDesc; }
 	private:
-		CPtr<CDnnBlob> stateBacklinkBlob;
 		CPtr<CDnnBlob> inputFullyConnectedResult;
 		CPtr<CDnnBlob> reccurentFullyConnectedResult;
+		CPtr<CDnnBlob> inputSequenceFullyConnectedResult;
 		CLstmDesc* lstmDesc;
 		bool isInitialized;
 
@@ -129,7 +134,7 @@ private:
 	void setWeightsData(const CPtr<CDnnBlob>& newWeights);
 
 	void fastLstm();
-	void initRecurentBlob( CPtr<CDnnBlob>& backlinkBlob, int num );
+	void initRecurentBlob( const CFloatHandle& backlink, int num );
 };
 
 NEOML_API CLayerWrapper<CLstmLayer> Lstm(
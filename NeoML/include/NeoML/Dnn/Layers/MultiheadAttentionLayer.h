@@ -43,6 +43,17 @@ namespace NeoML {
 //  W_* - trainable parameters and W_O is an additional trainable matrix of size (GetHiddenSize() x GetOutputSize())
 //
 // Result has size (1, BatchWidth, ListSize_Q, 1, 1, 1, GetOutputSize())
+//
+// If the layer is run on CPU without backward, the dropout is off and the softmax output (#1) isn't connected
+// the attention is calculated by IMathEngine::ScaledDotProductAttention which doesn't store the
+// ListSize_Q x ListSize_V scores matrix
+//
+// In the decoding mode the layer keeps the projected keys and values between the runs:
+// the K and V inputs contain only the new positions which are appended to the cache,
+// and Q attends to the whole cache. Only MT_Triangle or no mask is supported in this mode
+//
+// With MT_SequenceLengths the batch may contain the sequences of different lengths padded to ListSize_V:
+// the scores of the padded keys are not calculated at all
 class NEOML_API CMultiheadAttentionLayer : public CCompositeLayer {
 	NEOML_DNN_LAYER( CMultiheadAttentionLayer )
 public:
@@ -56,7 +67,17 @@ public:
 
 		// Different masks for different objects
 		// Its shape is (1 x BatchWidth x headCount x 1 x ListSize_Q x 1 x ListSize_V)
-		MT_Eltwise = 1
+		MT_Eltwise = 1,
+
+		// Causal mask: the i'th element of Q attends only to the elements j <= i + ListSize_V - ListSize_Q
+		// The mask input isn't used
+		MT_Triangle = 2,
+
+		// The mask input contains the numbers of the valid elements of K and V in each object (1..ListSize_V)
+		// The padded elements after them are skipped; the batch doesn't need to be sorted by the lengths
+		// Its shape is (1 x BatchWidth x 1 x 1 x 1 x 1 x 1) and its type is CT_Int
+		// Supported only with the fused attention (see above)
+		MT_SequenceLengths = 3
 	};
 
 	// The number of heads in attention
@@ -92,6 +113,23 @@ public:
 	bool IsInCompatibilityMode() const { return isInCompatibilityMode; }
 	void SetCompatibilityMode( bool value );
 
+	// Decoding mode for the autoregressive generation
+	// Requires the fused attention (see above); the cache isn't serialized
+	// Off by default; changing the mode resets the cache
+	bool IsDecodingMode() const { return isDecodingMode; }
+	void SetDecodingMode( bool isDecoding );
+
+	// The number of positions in the cache
+	int GetCachedLength() const { return cachedLength; }
+	// The number of positions the cache can hold without reallocation
+	// Grows geometrically while decoding
+	int GetCacheCapacity() const { return cachedK == nullptr ? 0 : cachedK->GetListSize(); }
+	// Clears the cache before decoding a new batch of sequences
+	// The allocated memory is kept for the sequences of the same batch width
+	void ResetCache() { cachedLength = 0; }
+	// Keeps only the first length positions in the cache
+	void TrimCache( int length );
+
 	void Serialize( CArchive& archive ) override;
 
 	// Recreates the layer if forceRebuild is true or it doesn't contain sublayers
@@ -99,6 +137,7 @@ public:
 
 protected:
 	void Reshape() override;
+	void RunOnce() override;
 
 private:
 	// The amount of heads
@@ -117,6 +156,18 @@ private:
 	bool isInCompatibilityMode;
 	// layer applying scale
 	CString multiplyByConstLayerName;
+	// Decoding mode
+	bool isDecodingMode;
+	// The projected keys and values of the previous positions in the decoding mode
+	// The shape is (1 x BatchWidth x GetCacheCapacity() x 1 x 1 x 1 x GetHiddenSize())
+	// Only the first cachedLength positions of each sequence are valid
+	CPtr<CDnnBlob> cachedK;
+	CPtr<CDnnBlob> cachedV;
+	int cachedLength;
+	// The projected keys and values of the new positions calculated by the fused attention
+	// Allocated on the first run after the reshape
+	CPtr<CDnnBlob> projectedK;
+	CPtr<CDnnBlob> projectedV;
 
 	void create();
 
@@ -143,6 +194,12 @@ private:
 	CBaseLayer* prepareK( CBaseLayer* input );
 	CBaseLayer* prepareV( CBaseLayer* input );
 	CBaseLayer* prepareOutput( CBaseLayer* input );
+	void updateTriangleMask();
+	bool isFusedAttentionPossible() const;
+	void runFusedAttention();
+	void releaseCache();
+	void reserveCache( int batchWidth, int length );
+	void appendToCache( CDnnBlob& cache, const CDnnBlob& newPositions );
 
 	// divide dot product by sqrt( d_k ) or sqrt( d_K ) in compatibility mode, where k - one key, K - concatenation of keys from all heads
 	float getScalingFactor() const
@@ -85,6 +85,7 @@ private:
 	CPtr<CDnnBlob> normalizedInput;
 	CPtr<CDnnBlob> outputDiffBackup;
 
+	// The step-by-step calculation for the math engines without the fused layer normalization
 	void runOnceImpl( const CFloatHandle& negMean, const CFloatHandle& invSqrtVar, const CFloatHandle& inputNorm );
 	void calcMean( const CFloatHandle& negMean );
 	void calcVar( const CConstFloatHandle& negMean, const CFloatHandle& invSqrtVar );
@@ -48,6 +48,16 @@ public:
 	// The full number of iterations and the sequence length of the result = Input[0]->BatchLength() * repeatCount
 	int GetRepeatCount() const { return repeatCount; }
 	void SetRepeatCount(int count);
+	// The packed batch of the sequences of different lengths
+	// If it is on, the input #1 contains the lengths of the sequences (CT_Int, 1 x BatchWidth x 1)
+	// and the optional inputs with the initial state follow it
+	// The sequences must be sorted by their lengths in descending order, each of them starts from position 0
+	// The finished sequences are excluded from the calculations and their outputs are filled with zeros
+	// In the reverse mode each sequence is processed from its last position
+	// Supported only if the whole sequence may be processed at once (see IsWholeSequenceRunAvailable)
+	// by the layers implementing it (LSTM, GRU, IRNN)
+	bool IsPackedSequence() const { return isPackedSequence; }
+	virtual void SetPackedSequence( bool isPacked );
 
 protected:
 	void OnDnnChanged( CDnn* old ) override;
@@ -55,6 +65,21 @@ protected:
 	void RunInternalDnnBackward() override;
 	void SetInternalDnnParams() override;
 
+	// Checks if the layer may process the whole sequence at once bypassing the internal network
+	// It is possible for inference on CPU when the sequence is processed once and starts from the initial state
+	bool IsWholeSequenceRunAvailable() const;
+	// The number of the first input with the initial state
+	int GetFirstStateInput() const { return isPackedSequence ? 2 : 1; }
+	// Gets the number of the sequences which are not finished yet at each position
+	// The active sequences are always the first ones in the batch
+	void GetActiveBatchWidths( CArray<int>& activeBatchWidths ) const;
+	// Gets the blocks of consecutive rows of the BatchLength x BatchWidth sequence that belong to the active sequences
+	// The i-th block starts from the row firstRows[i] and contains rowCounts[i] rows
+	static void GetActiveRowBlocks( const CArray<int>& activeBatchWidths, int batchWidth,
+		CArray<int>& firstRows, CArray<int>& rowCounts );
+	// Checks if the previous step result must be copied, because some sequences start later than the others
+	bool IsPreviousStepCopyNeeded() const { return isPackedSequence && IsReverseSequence(); }
+
 private:
 	// The backward links
 	CObjectArray<CBackLinkLayer> backLinks;
@@ -63,6 +88,8 @@ private:
 	bool isReverseSequence;
 	// The number of repetitions of the same input sequence
 	int repeatCount;
+	// Indicates if the input #1 contains the sequence lengths
+	bool isPackedSequence;
 
 	void getSequenceParams(int& batchWidth, int& sequenceLength);
 	void serializationHook(CArchive& archive) override;
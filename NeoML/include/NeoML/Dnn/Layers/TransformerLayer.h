@@ -73,6 +73,7 @@ class CActivationDesc;
 //				- ListSize - equal to the number of head counts
 //				- Other dimensions must be equal to 1
 //				- it can be easily created with TransformerSourceMaskLayer
+//			if GetMaskType() == MT_Triangle the input mask must not be connected (the causal mask is used)
 // Outputs:
 //      1. output data - float blob of size:
 //          - BatchWidth and ListSize are equal to the corresponding dims of the first input
@@ -111,6 +112,16 @@ public:
 	void SetMaskType( CMultiheadAttentionLayer::TMaskType type );
 	CMultiheadAttentionLayer::TMaskType GetMaskType() const { return selfAttention->GetMaskType(); }
 
+	// Decoding mode of the self-attention: the input contains only the new positions of the sequences
+	// and the keys and values of the previous ones are taken from the cache
+	// Must be used with MT_Triangle or without the mask; see CMultiheadAttentionLayer for details
+	bool IsDecodingMode() const { return selfAttention->IsDecodingMode(); }
+	void SetDecodingMode( bool isDecoding ) { selfAttention->SetDecodingMode( isDecoding ); }
+	int GetCachedLength() const { return selfAttention->GetCachedLength(); }
+	int GetCacheCapacity() const { return selfAttention->GetCacheCapacity(); }
+	void ResetCache() { selfAttention->ResetCache(); }
+	void TrimCache( int length ) { selfAttention->TrimCache( length ); }
+
 protected:
 	void Reshape() override;
 
@@ -20,12 +20,14 @@ limitations under the License.
 #include <NeoML/TraditionalML/FeatureSelection.h>
 #include <NeoML/TraditionalML/FloatVector.h>
 #include <NeoML/TraditionalML/GradientBoost.h>
+#include <NeoML/TraditionalML/GradientBoostBinnedProblem.h>
 #include <NeoML/TraditionalML/GradientBoostQuickScorer.h>
 #include <NeoML/TraditionalML/Linear.h>
 #include <NeoML/TraditionalML/MemoryProblem.h>
 #include <NeoML/TraditionalML/OneVersusAll.h>
 #include <NeoML/TraditionalML/OneVersusOne.h>
 #include <NeoML/TraditionalML/PlattScalling.h>
+#include <NeoML/TraditionalML/RandomForest.h>
 #include <NeoML/TraditionalML/Score.h>
 #include <NeoML/TraditionalML/Shuffler.h>
 #include <NeoML/TraditionalML/SimpleGenerator.h>
@@ -38,6 +40,7 @@ limitations under the License.
 #include <NeoML/Dnn/DnnBlob.h>
 #include <NeoML/Dnn/DnnInitializer.h>
 #include <NeoML/Dnn/DnnOptimization.h>
+#include <NeoML/Dnn/DnnQuantization.h>
 #include <NeoML/Dnn/DnnSolver.h>
 #include <NeoML/Dnn/DnnSparseMatrix.h>
 #include <NeoML/Dnn/Layers/3dConvLayer.h>
@@ -89,6 +92,7 @@ limitations under the License.
 #include <NeoML/TraditionalML/GraphGenerator.h>
 #include <NeoML/TraditionalML/HierarchicalClustering.h>
 #include <NeoML/TraditionalML/IsoDataClustering.h>
+#include <NeoML/TraditionalML/IvfIndex.h>
 #include <NeoML/TraditionalML/KMeansClustering.h>
 #include <NeoML/TraditionalML/LdGraph.h>
 #include <NeoML/TraditionalML/MatchingGenerator.h>
@@ -33,7 +33,9 @@ struct NEOML_API CCrossValidationResult {
 // The cross-validation algorithm
 class NEOML_API CCrossValidation {
 public:
-	CCrossValidation( ITrainingModel& trainingModel, const IProblem* problem );
+	// threadCount models are trained at once; in this case
+	// the Train method of trainingModel is called from several threads and should be thread-safe (CLinear and CSvm are)
+	CCrossValidation( ITrainingModel& trainingModel, const IProblem* problem, int threadCount = 1 );
 
 	// Performs cross-validation
 	void Execute( int partsCount, TScore score, CCrossValidationResult& results, bool stratified );
@@ -41,6 +43,7 @@ public:
 private:
 	ITrainingModel& trainingModel; // the base training model
 	const CPtr<const IProblem> problem; // the input data
+	const int threadCount; // the number of models trained at once
 };
 
 } // namespace NeoML
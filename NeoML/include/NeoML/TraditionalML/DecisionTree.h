@@ -138,6 +138,9 @@ public:
 		size_t AvailableMemory; 
 		// The algorithm used for multi-class classification
 		TMulticlassMode MulticlassMode;
+		// The number of threads used for training
+		// The trained tree does not depend on the number of threads
+		int ThreadCount;
 
 		CParams() :
 			MinContinuousSubsetSize( 1 ),
@@ -151,7 +154,8 @@ public:
 			ConstNodeThreshold( 0.99 ),
 			RandomSelectedFeaturesCount( NotFound ),
 			AvailableMemory( Gigabyte ),
-			MulticlassMode( MM_SingleClassifier )
+			MulticlassMode( MM_SingleClassifier ),
+			ThreadCount( 1 )
 		{
 		}
 	};
@@ -178,10 +182,18 @@ private:
 	mutable CPointerArray<CDecisionTreeNodeStatisticBase> statisticsCache; // the cache for statistics
 	mutable CArray<CDecisionTreeNodeBase*> classifyNodesCache; // the cache for leaf nodes
 	mutable CArray<int> classifyNodesLevel; // the levels of leaf nodes
+	// The non-zero feature values grouped by feature, built once for the training
+	// The values of each feature are ordered by vector index
+	CArray<int> featureValuesPtr; // the position of the first value of each feature
+	CArray<int> featureValuesVectors; // the vector to which the value belongs
+	CArray<float> featureValues; // the feature values
+	mutable CArray<int> vectorStatistics; // the index in statisticsCache for each vector (NotFound if not processed)
 
 	CPtr<CDecisionTreeNodeBase> buildTree( int vectorCount );
+	void buildFeatureValues( const CFloatMatrixDesc& matrix );
 	bool buildTreeLevel( const CFloatMatrixDesc& matrix, int level, CDecisionTreeNodeBase& root ) const;
 	bool collectStatistics( const CFloatMatrixDesc& matrix, int level, CDecisionTreeNodeBase* root ) const;
+	void fillStatistics() const;
 	bool split( const CDecisionTreeNodeStatisticBase& nodeStatistics, int level ) const;
 	void generateUsedFeatures( int randomSelectedFeaturesCount, int featuresCount, CArray<int>& features ) const;
 
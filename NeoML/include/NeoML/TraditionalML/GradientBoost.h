@@ -19,6 +19,7 @@ limitations under the License.
 #include <NeoML/TraditionalML/FloatVector.h>
 #include <NeoML/TraditionalML/ClassificationResult.h>
 #include <NeoML/TraditionalML/TrainingModel.h>
+#include <NeoML/TraditionalML/GradientBoostBinnedProblem.h>
 #include <NeoML/Random.h>
 
 namespace NeoML {
@@ -197,6 +198,7 @@ private:
 	CPtr<CGradientBoostFastHistTreeBuilder<CGradientBoostStatisticsSingle>> fastHistSingleClassTreeBuilder; // TGBT_FastHist tree builder for single class
 	CPtr<CGradientBoostFastHistTreeBuilder<CGradientBoostStatisticsMulti>> fastHistMultiClassTreeBuilder; // TGBT_MultiFastHist tree builder for multi class
 	CPtr<IMultivariateRegressionProblem> baseProblem; // base problem
+	CPtr<const CGradientBoostBinnedProblem> binnedProblem; // the binned data if the base problem was built over it
 	CPtr<CGradientBoostFullProblem> fullProblem; // the problem data for TGBT_Full mode
 	CPtr<CGradientBoostFastHistProblem> fastHistProblem; // the problem data for TGBT_FastHist mode
 	CArray< CArray<CPredictionCacheItem> > predictCache; // the cache for predictions of the models being built
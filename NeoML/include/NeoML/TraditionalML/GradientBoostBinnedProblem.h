@@ -0,0 +1,74 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/NeoMLDefs.h>
+#include <NeoML/TraditionalML/Problem.h>
+
+namespace NeoML {
+
+class CGradientBoostFastHistProblem;
+
+// The regression problem with the feature values quantized into the histogram bins
+// The problem is stored in a file that is built once from the chunked data and then mapped into memory,
+// so the data that doesn't fit into memory may be used for training
+//
+// The feature values are replaced by the bin cuts, so any tree built on these bins works the same way on the original data
+// The GBTB_FastHist and GBTB_MultiFastHist tree builders read the bins directly from the file
+// and ignore CGradientBoost::CParams::MaxBins; the other algorithms see it as a usual sparse problem
+class NEOML_API CGradientBoostBinnedProblem : public IMultivariateRegressionProblem {
+public:
+	// Maps the file created by the Build method
+	explicit CGradientBoostBinnedProblem( const char* fileName );
+
+	// Builds the binned problem file from the chunked data
+	// The chunks are read twice: to find the bins (the same way as GBTB_FastHist does) and to quantize the vectors
+	// Only one chunk at a time is kept in memory; the vectors with zero weight are skipped
+	static void Build( const IMultivariateRegressionChunkedProblem& problem, int maxBins, const char* fileName,
+		int threadCount = 1 );
+
+	// IMultivariateRegressionProblem interface methods
+	int GetFeatureCount() const override { return featureCount; }
+	int GetVectorCount() const override { return vectorCount; }
+	CFloatMatrixDesc GetMatrix() const override;
+	double GetVectorWeight( int index ) const override;
+	int GetValueSize() const override { return valueSize; }
+	CFloatVector GetValue( int index ) const override;
+
+protected:
+	~CGradientBoostBinnedProblem() override = default;
+
+private:
+	CPtr<IObject> mapping; // the mapped file
+	int featureCount;
+	int valueSize;
+	int vectorCount;
+	int idCount; // the total number of bins
+	const int* featurePos; // the first bin of each feature
+	const int* nullValueIds; // the bins of the zero feature values
+	const float* cuts; // the bin cuts
+	const int* idVectorCounts; // the number of vectors in each bin
+	const double* weights; // the vector weights
+	const float* values; // the function values
+	const int* vectorPtr; // the positions of the vector elements
+	const int* columns; // the features of the non-zero elements
+	const float* elementValues; // the cuts of the bins of the non-zero elements
+	const int* ids; // the bins of the non-zero elements
+
+	friend class CGradientBoostFastHistProblem;
+};
+
+} // namespace NeoML
@@ -26,6 +26,8 @@ namespace NeoML {
 DECLARE_NEOML_MODEL_NAME( GradientBoostQSModelName, "FmlGradientBoostQSModel" )
 
 // Optimized model interface
+// The batch classification (IModel::ClassifyBatch) uses the block-wise variant of the algorithm,
+// which is faster for the large ensembles
 class NEOML_API IGradientBoostQSModel : public IModel {
 public:
 	virtual ~IGradientBoostQSModel();
@@ -40,6 +42,7 @@ public:
 };
 
 // Optimized regression model interface
+// The batch prediction (IRegressionModel::PredictBatch) uses the block-wise variant of the algorithm
 class NEOML_API IGradientBoostQSRegressionModel : public IRegressionModel {
 public:
 	virtual ~IGradientBoostQSRegressionModel();
@@ -0,0 +1,117 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/NeoMLDefs.h>
+#include <NeoML/TraditionalML/FloatVector.h>
+#include <NeoMathEngine/NeoMathEngine.h>
+#include <memory>
+
+namespace NeoML {
+
+// Approximate nearest neighbours search index with inverted lists (IVF)
+// The space is split into cells by the k-means centers (coarse quantization)
+// Each vector is stored in the list of its closest center,
+// and only the lists of the ProbeCount centers closest to the query are searched
+// If product quantization is on, the differences between the vectors and their centers are stored
+// as one-byte codes of SubspaceCount subvectors, and the distances are calculated approximately
+// The distance is the squared euclidean distance
+class NEOML_API CIvfIndex : public IObject {
+public:
+	struct CParams {
+		// The number of coarse centers (inverted lists)
+		int ListCount;
+		// The number of lists searched for each query
+		int ProbeCount;
+		// The number of subvectors for product quantization; 0 means that the vectors are stored as is
+		// The number of features must be divisible by SubspaceCount
+		int SubspaceCount;
+		// The number of centers for each subvector, no more than 256
+		int SubspaceCenterCount;
+		// The maximum number of k-means iterations during training
+		int MaxIterations;
+		// The number of threads used for training, adding and searching
+		int ThreadCount;
+		// The seed for the k-means initialization
+		int Seed;
+
+		CParams() :
+			ListCount( 256 ),
+			ProbeCount( 8 ),
+			SubspaceCount( 0 ),
+			SubspaceCenterCount( 256 ),
+			MaxIterations( 20 ),
+			ThreadCount( 1 ),
+			Seed( 0xCEA )
+		{
+		}
+	};
+
+	CIvfIndex() : featureCount( 0 ), vectorCount( 0 ) {}
+	explicit CIvfIndex( const CParams& params );
+	~CIvfIndex() = default;
+
+	// Trains the coarse centers and the product quantizer on the given data
+	// The index must be empty
+	void Train( const CFloatMatrixDesc& data );
+	// Checks if the index has been trained
+	bool IsTrained() const { return featureCount > 0; }
+
+	// Adds the vectors to the index; the vectors get the ids Size(), Size() + 1, ...
+	void Add( const CFloatMatrixDesc& data );
+	// The number of vectors in the index
+	int Size() const { return vectorCount; }
+	// The number of features
+	int GetFeatureCount() const { return featureCount; }
+
+	// Searches for neighbourCount nearest neighbours of each query
+	// The neighbours of the i-th query are ids[i * neighbourCount], ..., ids[(i + 1) * neighbourCount - 1]
+	// in the order of increasing distance; if fewer neighbours are found, the rest are NotFound with FLT_MAX distance
+	void Search( const CFloatMatrixDesc& queries, int neighbourCount, CArray<int>& ids, CArray<float>& distances ) const;
+
+	// Sets the number of lists searched for each query
+	void SetProbeCount( int probeCount );
+	// Get the parameters
+	const CParams& GetParams() const { return params; }
+
+	// Serializes the index
+	void Serialize( CArchive& archive ) override;
+
+private:
+	CParams params;
+	int featureCount; // the number of features
+	int vectorCount; // the number of vectors in the index
+	CArray<float> centers; // the coarse centers, ListCount x featureCount
+	CArray<float> centerNorms; // the squared norms of the coarse centers
+	CArray<float> subspaceCenters; // the product quantizer centers, SubspaceCount x SubspaceCenterCount x subspace size
+	CArray<CArray<int>> listIds; // the ids of the vectors in each list
+	CArray<CArray<float>> listVectors; // the vectors of each list, if product quantization is off
+	CArray<CArray<unsigned char>> listCodes; // the product quantization codes of the vectors of each list
+	mutable CCriticalSection mathEngineSection; // guards the creation of the math engine
+	mutable std::unique_ptr<IMathEngine> mathEngine; // the engine for the distance calculation, created on first use
+
+	bool useProductQuantization() const { return params.SubspaceCount > 0; }
+	int subspaceSize() const { return featureCount / params.SubspaceCount; }
+	void calcCenterNorms();
+	IMathEngine& getMathEngine() const;
+	int getBatchSize() const;
+	void calcCenterDistances( IMathEngine& mathEngine, const CFloatMatrixDesc& data, int firstRow, int rowCount,
+		CArray<float>& rows, CArray<float>& distances ) const;
+	void encode( const float* residual, unsigned char* code ) const;
+	void fillDistanceTable( const float* residual, float* table ) const;
+};
+
+} // namespace NeoML
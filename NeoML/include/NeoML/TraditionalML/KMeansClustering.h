@@ -36,6 +36,14 @@ public:
 		// Elkan argorithm
 		// If used then the distance func must support triangle inequality
 		KMA_Elkan,
+		// Hamerly algorithm
+		// Keeps one lower bound per element instead of one per element and cluster, which suits large cluster counts
+		// If used then the distance func must support triangle inequality
+		KMA_Hamerly,
+		// Mini-batch algorithm
+		// On each iteration the centers are updated by a random sample of MiniBatchSize elements
+		// All the elements are assigned to the nearest centers after the last iteration
+		KMA_MiniBatch,
 
 		KMA_Count
 	};
@@ -74,9 +82,11 @@ public:
 		int RunCount;
 		// Initial seed for random
 		int Seed;
+		// The number of elements sampled on each iteration of the mini-batch algorithm
+		int MiniBatchSize;
 
 		CParam() : Algo( KMA_Lloyd ), DistanceFunc( DF_Euclid ), InitialClustersCount( 1 ), Initialization( KMI_Default ),
-			MaxIterations( 1 ), Tolerance( 1e-5f ), ThreadCount( 1 ), RunCount( 1 ), Seed( 0xCEA )
+			MaxIterations( 1 ), Tolerance( 1e-5f ), ThreadCount( 1 ), RunCount( 1 ), Seed( 0xCEA ), MiniBatchSize( 1024 )
 		{
 		}
 	};
@@ -113,7 +123,7 @@ private:
 	void kMeansPlusPlusInitialization( const CFloatMatrixDesc& matrix, int seed );
 
 	// Sparse data clusterization
-	bool clusterize( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia );
+	bool clusterize( const CFloatMatrixDesc& matrix, const CArray<double>& weights, int seed, double& inertia );
 
 	// Lloyd algorithm implementation for sparse data
 	bool lloydClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia );
@@ -139,6 +149,21 @@ private:
 	bool isPruned( const CArray<float>& upperBounds, const CVariableMatrix<float>& lowerBounds,
 		const CVariableMatrix<float>& clusterDists, int currentCluster, int clusterToProcess, int id) const;
 
+	// Hamerly algorithm implementation for sparse data
+	bool hamerlyClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia );
+	void computeClosestClusterDists( CArray<float>& closestClusterDist ) const;
+	void assignVectors( const CFloatMatrixDesc& matrix, const CArray<float>& closestClusterDist,
+		CArray<int>& assignments, CArray<float>& upperBounds, CArray<float>& lowerBounds ) const;
+	double updateUpperAndLowerBounds( const CFloatMatrixDesc& matrix, const CArray<float>& moveDistance,
+		const CArray<int>& assignments, CArray<float>& upperBounds, CArray<float>& lowerBounds ) const;
+
+	// Mini-batch algorithm implementation for sparse data
+	bool miniBatchClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights, int seed,
+		double& inertia );
+	double classifyBatch( const CFloatMatrixDesc& matrix, const CArray<int>& batch, CArray<int>& batchCluster ) const;
+	bool updateClustersByBatch( const CFloatMatrixDesc& matrix, const CArray<double>& weights,
+		const CArray<int>& batch, const CArray<int>& batchCluster );
+
 	// Specific case for dense data with Euclidean metrics and Lloyd algorithm
 	bool denseLloydL2Clusterize( IClusteringData* rawData, int seed, CClusteringResult& result, double& inertia );
 	// Initial cluster selection
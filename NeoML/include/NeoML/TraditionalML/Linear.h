@@ -23,8 +23,6 @@ limitations under the License.
 
 namespace NeoML {
 
-class CFunctionWithHessian;
-
 // The error function types
 enum TErrorFunction {
 	EF_SquaredHinge,	// squared hinge function
@@ -110,7 +108,6 @@ public:
 private:
 	const CParams params; // classification parameters
 	CTextStream* log; // logging stream
-	CFunctionWithHessian* function; // error function
 };
 
 // DEPRECATED: for backward compatibility
@@ -37,6 +37,12 @@ public:
 	virtual bool Classify( const CFloatVector& data, CClassificationResult& result ) const
 		{ return Classify( data.GetDesc(), result ); }
 
+	// Classifies all the rows of the matrix; results[i] is set to the result for the i-th row
+	// The results array is resized to data.Height, the buffers of its elements are reused
+	// Returns true if all the rows were classified successfully
+	virtual bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const;
+
 	// Serializes the model
 	void Serialize( CArchive& archive ) override = 0;
 };
@@ -53,6 +59,9 @@ public:
 	virtual double Predict( const CFloatVector& data ) const
 		{ return Predict( data.GetDesc() ); };
 
+	// Predicts the function values on all the rows of the matrix; results[i] is set to the value for the i-th row
+	virtual void PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount = 1 ) const;
+
 	// Serializes the model
 	void Serialize( CArchive& archive ) override = 0;
 };
@@ -69,6 +78,12 @@ public:
 		{ return MultivariatePredict( data.GetDesc() ); }
 	virtual CFloatVector MultivariatePredict( const CFloatVectorDesc& data ) const = 0;
 
+	// Predicts the function values on all the rows of the matrix
+	// The results matrix has data.Height rows, the i-th row contains the value for the i-th row of the data
+	// Returns the size of the value vector
+	virtual int MultivariatePredictBatch( const CFloatMatrixDesc& data, CArray<float>& results,
+		int threadCount = 1 ) const;
+
 	// Serializes the model
 	void Serialize( CArchive& archive ) override = 0;
 };
@@ -51,7 +51,9 @@ public:
 // One versus all classifier training interface
 class NEOML_API COneVersusAll : public ITrainingModel {
 public:
-	explicit COneVersusAll( ITrainingModel& baseBinaryClassifier );
+	// threadCount binary classifiers are trained at once; in this case
+	// the Train method of baseBinaryClassifier is called from several threads and should be thread-safe (CLinear and CSvm are)
+	explicit COneVersusAll( ITrainingModel& baseBinaryClassifier, int threadCount = 1 );
 
 	// Sets a text stream for logging processing
 	void SetLog( CTextStream* newLog ) { logStream = newLog; }
@@ -61,6 +63,7 @@ public:
 
 private:
 	ITrainingModel& baseBinaryClassifier; // the basic binary classifier used
+	const int threadCount; // the number of binary classifiers trained at once
 	CTextStream* logStream; // the logging stream
 };
 
@@ -27,7 +27,9 @@ DECLARE_NEOML_MODEL_NAME( OneVersusOneModelName, "NeoMLOneVersusOneModel" )
 // One versus one classifier training interface
 class NEOML_API COneVersusOne : public ITrainingModel {
 public:
-	explicit COneVersusOne( ITrainingModel& baseBinaryClassifier );
+	// threadCount binary classifiers are trained at once; in this case
+	// the Train method of baseBinaryClassifier is called from several threads and should be thread-safe (CLinear and CSvm are)
+	explicit COneVersusOne( ITrainingModel& baseBinaryClassifier, int threadCount = 1 );
 
 	// Sets a text stream for logging
 	void SetLog( CTextStream* newLog ) { log = newLog; }
@@ -37,6 +39,7 @@ public:
 
 private:
 	ITrainingModel& baseClassifier; // the basic binary classifier used
+	const int threadCount; // the number of binary classifiers trained at once
 	CTextStream* log; // the logging stream
 };
 
@@ -100,6 +100,27 @@ public:
 	virtual CFloatVector GetValue( int index ) const = 0;
 };
 
+// The input data for regression in case the data doesn't fit into memory
+// The vectors are provided by chunks, each chunk is a separate problem (e.g. loaded from disk on request)
+// This interface is implemented by the client
+class NEOML_API IMultivariateRegressionChunkedProblem : virtual public IObject {
+public:
+	~IMultivariateRegressionChunkedProblem() override;
+
+	// The number of features
+	virtual int GetFeatureCount() const = 0;
+
+	// The length of the function value vector
+	virtual int GetValueSize() const = 0;
+
+	// The number of chunks
+	virtual int GetChunkCount() const = 0;
+
+	// Gets the chunk with the given index
+	// The chunk is released before the next one is requested
+	virtual CPtr<const IMultivariateRegressionProblem> GetChunk( int index ) const = 0;
+};
+
 // The interface for accumulating vectors in a data set
 class NEOML_API IDataAccumulator : public IProblem {
 public:
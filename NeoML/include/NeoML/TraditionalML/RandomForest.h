@@ -0,0 +1,80 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/NeoMLDefs.h>
+#include <NeoML/TraditionalML/DecisionTree.h>
+#include <NeoML/TraditionalML/TrainingModel.h>
+#include <NeoML/Random.h>
+
+namespace NeoML {
+
+DECLARE_NEOML_MODEL_NAME( RandomForestModelName, "NeoMLRandomForestModel" )
+
+// Random forest classification model interface
+// The class probabilities are averaged over all the trees
+class NEOML_API IRandomForestModel : public IModel {
+public:
+	~IRandomForestModel() override;
+
+	// Gets the trees of the ensemble
+	virtual const CObjectArray<IModel>& GetTrees() const = 0;
+};
+
+//------------------------------------------------------------------------------------------------------------
+
+// Random forest training algorithm
+// Each tree is a CDecisionTree trained on its own bootstrap sample of the problem
+class NEOML_API CRandomForest : public ITrainingModel {
+public:
+	struct CParams {
+		// The number of trees in the ensemble
+		int TreeCount;
+		// The parameters of each tree
+		// If TreeParams.RandomSelectedFeaturesCount is NotFound, the square root of the number of features is used
+		// TreeParams.ThreadCount is ignored, the trees are trained with one thread each
+		CDecisionTree::CParams TreeParams;
+		// The size of the bootstrap sample relative to the number of vectors in the problem
+		// The vectors are sampled with replacement; the vector drawn several times gets the proportionally larger weight
+		double SubsampleRate;
+		// The number of threads used for training; the trees are trained concurrently
+		// The trained ensemble does not depend on the number of threads
+		int ThreadCount;
+
+		CParams() :
+			TreeCount( 100 ),
+			SubsampleRate( 1.0 ),
+			ThreadCount( 1 )
+		{
+		}
+	};
+
+	explicit CRandomForest( const CParams& params, CRandom* random = 0 );
+
+	// Set a text stream to log the progress
+	void SetLog( CTextStream* newLog ) { logStream = newLog; }
+
+	// The ITrainingModel interface methods:
+	CPtr<IModel> Train( const IProblem& problem ) override;
+
+private:
+	const CParams params; // the training parameters
+	CRandom defRandom; // the default random numbers generator
+	CRandom& random; // the actual random numbers generator
+	CTextStream* logStream; // the logging stream
+};
+
+} // namespace NeoML
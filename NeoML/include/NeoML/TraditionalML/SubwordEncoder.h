@@ -31,6 +31,13 @@ public:
 	// In this case 'tokenLengths' will contain lengths of the tokens according to the original string version.
 	virtual void Encode( const CString& word, CArray<int>& tokenIds,
 		CArray<int>& tokenLengths ) const = 0;
+
+	// Encodes a batch of words using threadCount threads.
+	// The tokens of all the words are added to 'tokenIds' and 'tokenLengths' in the order of the words,
+	// 'wordTokenCounts' receives the number of tokens of each word.
+	// The result is the same as after calling Encode for each word.
+	virtual void EncodeBatch( const CArray<CString>& words, CArray<int>& tokenIds,
+		CArray<int>& tokenLengths, CArray<int>& wordTokenCounts, int threadCount = 1 ) const;
 	
 	// Decodes sequence of token ids into a sequence of words.
 	virtual void Decode( const CArray<int>& tokenIds, CArray<CString>& words ) const = 0;
@@ -43,6 +50,7 @@ public:
 };
 
 // Subword encoder which supports caching results of 'Encode' calls.
+// Encode may be called from several threads at once.
 class NEOML_API ISubwordEncoderWithCache : public ISubwordEncoder {
 public:
 	void Encode( const CString& word, CArray<int>& tokenIds,
@@ -65,14 +73,17 @@ public:
 
 protected:
 	// 'Internal' Encode with the same meaning.
+	// May be called from several threads at once.
 	virtual void DoEncode( const CString& word, CArray<int>& tokenIds,
 		CArray<int>& tokenLengths ) const = 0;
 
 private:
 	// Internal cache for encoding requests.
+	// The words are distributed among several shards, each with its own lock,
+	// so the concurrent requests rarely wait for each other.
 	class CCache {
 	public:
-		CCache() : cacheTime( 0 ), cachePeriod( 50000 ) {}
+		CCache() : cachePeriod( 50000 ) {}
 		// Cache cleanup period
 		int GetCachePeriod() const { return cachePeriod; }
 		// Sets the cache cleanup period
@@ -84,9 +95,11 @@ private:
 		void Add( const CString& word, const CArray<int>& tokenIds,
 			const CArray<int>& tokenLengths );
 		// Clears cache.
-		void Clear() { cacheTime = 0; wordCache.DeleteAll(); }
+		void Clear();
 
 	private:
+		static constexpr int ShardCount = 16;
+
 		// Data stored in cache: token ids and their unicode lengths and the latest request time.
 		struct CCachedData {
 			CFastArray<int, 4> TokenIds;
@@ -98,12 +111,20 @@ private:
 			CCachedData( CCachedData&& other );
 		};
 
-		// Current cache state.
-		CMap<CString, CCachedData> wordCache;
-		// Current cache time.
-		long long cacheTime;
+		// A part of the cache with its own lock and time.
+		// Each shard is cleaned up after cachePeriod / ShardCount of its own requests.
+		struct CShard {
+			CCriticalSection Section;
+			CMap<CString, CCachedData> WordCache;
+			long long CacheTime = 0;
+		};
+
+		// Cache shards.
+		CShard shards[ShardCount];
 		// Cache cleanup period.
-		int cachePeriod;
+		std::atomic<int> cachePeriod;
+
+		CShard& getShard( const CString& word );
 	};
 
 	// Cache for Encode calls.
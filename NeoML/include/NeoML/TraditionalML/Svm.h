@@ -58,6 +58,11 @@ public:
 		bool DoShrinking; // do shrinking or not
 		int ThreadCount; // the number of processing threads used
 		TMulticlassMode MulticlassMode; // algorithm used for multiclass classification
+		// The kernel cache size in MB
+		// The multiclass training keeps one more cache of this size shared by all binary classifiers
+		int CacheSize;
+		// Store the shared multiclass cache in float16, so twice as many kernel rows fit into it
+		bool Float16Cache;
 
 		CParams( CSvmKernel::TKernelType kerneltype, double errorWeight = 1., int maxIterations = 10000,
 				int degree = 1, double gamma = 1., double coeff0 = 1., double tolerance = 0.1,
@@ -71,7 +76,9 @@ public:
 			Tolerance( tolerance ),
 			DoShrinking( doShrinking ),
 			ThreadCount( threadCount ),
-			MulticlassMode( multiclassMode )
+			MulticlassMode( multiclassMode ),
+			CacheSize( 200 ),
+			Float16Cache( false )
 		{
 		}
 	};
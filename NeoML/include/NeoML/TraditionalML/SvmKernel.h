@@ -39,6 +39,9 @@ public:
 	// Calculates the kernel value on given vectors
 	double Calculate(const CFloatVectorDesc& x1, const CFloatVectorDesc& x2) const;
 	double Calculate(const CFloatVector& x1, const CFloatVectorDesc& x2) const { return Calculate( x1.GetDesc(), x2 ); }
+	// Calculates the kernel value using the precalculated squared norms of the vectors
+	// The gaussian kernel then needs only the dot product, which skips the features missing in one of the sparse vectors
+	double Calculate( const CFloatVectorDesc& x1, double squaredNorm1, const CFloatVectorDesc& x2, double squaredNorm2 ) const;
 
 	friend CArchive& operator << ( CArchive& archive, const CSvmKernel& center );
 	friend CArchive& operator >> ( CArchive& archive, CSvmKernel& center );
@@ -21,8 +21,12 @@ limitations under the License.
 
 #if FINE_PLATFORM( FINE_WINDOWS )
 #include <io.h>
+#include <windows.h>
 #elif FINE_PLATFORM( FINE_LINUX ) || FINE_PLATFORM( FINE_DARWIN ) || FINE_PLATFORM( FINE_IOS )
 #include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #elif FINE_PLATFORM( FINE_ANDROID )
 #include <jni.h>
@@ -336,4 +340,214 @@ unsigned char CArchiveFile::ReadByte()
 	return ret;
 }
 
+//------------------------------------------------------------------------------------------------------------
+
+// The read-only copy-on-write mapping of the whole file
+class CFileMapping : public IObject {
+public:
+	explicit CFileMapping( const CString& fileName );
+	~CFileMapping() override;
+
+	const char* GetData() const { return data; }
+	__int64 GetLength() const { return length; }
+
+private:
+	char* data;
+	__int64 length;
+#if FINE_PLATFORM( FINE_WINDOWS )
+	HANDLE mappingHandle;
+#endif
+};
+
+#if FINE_PLATFORM( FINE_LINUX ) || FINE_PLATFORM( FINE_DARWIN ) || FINE_PLATFORM( FINE_IOS )
+
+CFileMapping::CFileMapping( const CString& fileName ) :
+	data( nullptr ),
+	length( 0 )
+{
+	const int file = open( fileName, O_RDONLY );
+	checkArchiveFileError( file != -1, fileName );
+	struct stat fileStat;
+	if( fstat( file, &fileStat ) != 0 ) {
+		const int error = errno;
+		close( file );
+		throwFileException( error, fileName );
+	}
+	length = static_cast<__int64>( fileStat.st_size );
+	if( length > 0 ) {
+		// The private mapping shares the pages with the page cache until they are written
+		void* ptr = mmap( nullptr, static_cast<size_t>( length ), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+		if( ptr == MAP_FAILED ) {
+			const int error = errno;
+			close( file );
+			throwFileException( error, fileName );
+		}
+		data = static_cast<char*>( ptr );
+	}
+	// The mapping stays valid after the file is closed
+	close( file );
+}
+
+CFileMapping::~CFileMapping()
+{
+	if( data != nullptr ) {
+		munmap( data, static_cast<size_t>( length ) );
+	}
+}
+
+#elif FINE_PLATFORM( FINE_WINDOWS )
+
+CFileMapping::CFileMapping( const CString& fileName ) :
+	data( nullptr ),
+	length( 0 ),
+	mappingHandle( nullptr )
+{
+	HANDLE file = CreateFileA( fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( file == INVALID_HANDLE_VALUE ) {
+		throwFileException( static_cast<int>( GetLastError() ), fileName );
+	}
+	LARGE_INTEGER fileSize;
+	if( GetFileSizeEx( file, &fileSize ) == 0 ) {
+		const DWORD error = GetLastError();
+		CloseHandle( file );
+		throwFileException( static_cast<int>( error ), fileName );
+	}
+	length = static_cast<__int64>( fileSize.QuadPart );
+	if( length > 0 ) {
+		mappingHandle = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+		if( mappingHandle != nullptr ) {
+			data = static_cast<char*>( MapViewOfFile( mappingHandle, FILE_MAP_COPY, 0, 0, 0 ) );
+		}
+		if( data == nullptr ) {
+			const DWORD error = GetLastError();
+			if( mappingHandle != nullptr ) {
+				CloseHandle( mappingHandle );
+			}
+			CloseHandle( file );
+			throwFileException( static_cast<int>( error ), fileName );
+		}
+	}
+	CloseHandle( file );
+}
+
+CFileMapping::~CFileMapping()
+{
+	if( data != nullptr ) {
+		UnmapViewOfFile( data );
+		CloseHandle( mappingHandle );
+	}
+}
+
+#elif FINE_PLATFORM( FINE_ANDROID )
+
+CFileMapping::CFileMapping( const CString& fileName ) :
+	data( nullptr ),
+	length( 0 )
+{
+	// The assets can't be mapped
+	throwFileException( ENOTSUP, fileName );
+}
+
+CFileMapping::~CFileMapping()
+{
+}
+
+#else
+	#error Unknown platform
+#endif
+
+//------------------------------------------------------------------------------------------------------------
+
+CMappedArchiveFile::CMappedArchiveFile( const char* fileName )
+{
+	Open( fileName );
+}
+
+void CMappedArchiveFile::Open( const char* _fileName )
+{
+	NeoAssert( !IsOpen() );
+	CPtr<CFileMapping> fileMapping = FINE_DEBUG_NEW CFileMapping( _fileName );
+	fileName = _fileName;
+	data = fileMapping->GetData();
+	length = fileMapping->GetLength();
+	position = 0;
+	mapping = fileMapping.Ptr();
+}
+
+int CMappedArchiveFile::Read( void* buffer, int bytesCount )
+{
+	NeoAssert( IsOpen() );
+	NeoAssert( bytesCount >= 0 );
+	const int bytesRead = static_cast<int>( min( static_cast<__int64>( bytesCount ), length - position ) );
+	if( bytesRead > 0 ) {
+		::memcpy( buffer, data + position, bytesRead );
+		position += bytesRead;
+	}
+	return bytesRead;
+}
+
+void CMappedArchiveFile::Write( const void*, int )
+{
+	NeoAssert( false );
+}
+
+__int64 CMappedArchiveFile::GetPosition() const
+{
+	NeoAssert( IsOpen() );
+	return position;
+}
+
+__int64 CMappedArchiveFile::Seek( __int64 offset, TSeekPosition from )
+{
+	NeoAssert( IsOpen() );
+	__int64 newPosition = offset;
+	if( from == current ) {
+		newPosition += position;
+	} else if( from == end ) {
+		newPosition += length;
+	}
+	if( newPosition < 0 || newPosition > length ) {
+		throwFileException( EINVAL, fileName );
+	}
+	position = newPosition;
+	return position;
+}
+
+void CMappedArchiveFile::SetLength( __int64 )
+{
+	NeoAssert( false );
+}
+
+__int64 CMappedArchiveFile::GetLength() const
+{
+	NeoAssert( IsOpen() );
+	return length;
+}
+
+void CMappedArchiveFile::Abort()
+{
+	Close();
+}
+
+void CMappedArchiveFile::Flush()
+{
+	NeoAssert( false );
+}
+
+void CMappedArchiveFile::Close()
+{
+	// The memory is unmapped when the last user of the mapping is destroyed
+	mapping = nullptr;
+	data = nullptr;
+	length = 0;
+	position = 0;
+	fileName = CString();
+}
+
+bool CMappedArchiveFile::IsEndOfFile() const
+{
+	NeoAssert( IsOpen() );
+	return position == length;
+}
+
 } // namespace NeoML
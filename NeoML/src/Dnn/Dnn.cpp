@@ -18,6 +18,10 @@ limitations under the License.
 
 #include <NeoMathEngine/NeoMathEngine.h>
 #include <NeoML/Dnn/Dnn.h>
+#include <Dnn/DnnMemoryPlan.h>
+#include <Dnn/DnnBranchScheduler.h>
+#include <Dnn/DnnMappedStorage.h>
+#include <NeoML/ArchiveFile.h>
 #include <NeoML/Dnn/Layers/3dConvLayer.h>
 #include <NeoML/Dnn/Layers/ActivationLayers.h>
 #include <NeoML/Dnn/Layers/AddToObjectLayer.h>
@@ -544,6 +548,39 @@ void CDnn::setProcessingParams( bool _isRecurrentMode, int sequenceLength, bool
 	isBackwardPerformed = _isBackwardPerformed;
 }
 
+// Gets the layers in the order of their execution by runOnce
+void CDnn::getExecutionOrder( CArray<CBaseLayer*>& order ) const
+{
+	order.Empty();
+	CHashTable<const CBaseLayer*> visited;
+	// The depth-first search from the sink layers, the layer is added after all its inputs
+	CArray<CBaseLayer*> stack;
+	CArray<int> nextInput;
+	for( int i = 0; i < sinkLayers.Size(); ++i ) {
+		if( visited.Has( sinkLayers[i] ) ) {
+			continue;
+		}
+		visited.Add( sinkLayers[i] );
+		stack.Add( sinkLayers[i] );
+		nextInput.Add( 0 );
+		while( !stack.IsEmpty() ) {
+			CBaseLayer* layer = stack.Last();
+			if( nextInput.Last() < layer->GetInputCount() ) {
+				CBaseLayer* input = layer->GetInputLayer( nextInput.Last()++ );
+				if( !visited.Has( input ) ) {
+					visited.Add( input );
+					stack.Add( input );
+					nextInput.Add( 0 );
+				}
+			} else {
+				order.Add( layer );
+				stack.DeleteLast();
+				nextInput.DeleteLast();
+			}
+		}
+	}
+}
+
 void CDnn::runOnce(int curSequencePos)
 {
 	currentSequencePos = curSequencePos;
@@ -552,6 +589,11 @@ void CDnn::runOnce(int curSequencePos)
 	if( IsLogging() ) {
 		*log << "Run " << runNumber << " : " << currentSequencePos;
 	}
+	if( isBranchSchedulerUsed() ) {
+		CArray<CBaseLayer*> order;
+		getExecutionOrder( order );
+		branchScheduler->Run( order );
+	}
 	// Run the network for each sink layer; they will recursively call RunOnce for all their inputs
 	for( int i = 0; i < sinkLayers.Size(); ++i ) {
 		sinkLayers[i]->runOnce();
@@ -580,10 +622,26 @@ void CDnn::RunOnce()
 		if(autoRestartMode) {
 			RestartSequence();
 		}
+		// The memory plan is built again only if the network may have changed
+		const bool isPlanOutdated = memoryPlan != nullptr && ( !memoryPlan->IsBuilt() || isReshapePending() );
 		reshape(); // rebuild the network if necessary
 
-		// During inference we turning reuseMemoryMode on when the net is big enough
-		isReuseMemoryMode = ( getOutputBlobsSize() > MinReuseMemoryModeNetSize );
+		if( memoryPlan != nullptr ) {
+			// The static memory plan replaces the memory reuse
+			isReuseMemoryMode = false;
+			if( isPlanOutdated ) {
+				CArray<CBaseLayer*> order;
+				getExecutionOrder( order );
+				memoryPlan->Build( order );
+			}
+			memoryPlan->Apply();
+		} else if( isBranchSchedulerUsed() ) {
+			// The blobs can't be released right after the last use as the layers may run in a different order
+			isReuseMemoryMode = false;
+		} else {
+			// During inference we turning reuseMemoryMode on when the net is big enough
+			isReuseMemoryMode = ( getOutputBlobsSize() > MinReuseMemoryModeNetSize );
+		}
 		runOnce(0);
 	}
 #ifdef NEOML_USE_FINEOBJ
@@ -726,6 +784,27 @@ void CDnn::rebuild()
 	RequestReshape(true);
 }
 
+// Checks if the independent layers are run concurrently on this run
+bool CDnn::isBranchSchedulerUsed() const
+{
+	return branchScheduler != nullptr && memoryPlan == nullptr && !isBackwardPerformed && !isRecurrentMode
+		&& mathEngine.GetType() == MET_Cpu;
+}
+
+// Checks if the next reshape may change the network
+bool CDnn::isReshapePending() const
+{
+	if( isRebuildNeeded ) {
+		return true;
+	}
+	for( int i = 0; i < layers.Size(); i++ ) {
+		if( layers[i]->isReshapeNeeded || layers[i]->forcedReshape ) {
+			return true;
+		}
+	}
+	return false;
+}
+
 size_t CDnn::getOutputBlobsSize() const
 {
 	size_t result = 0;
@@ -818,6 +897,36 @@ void CDnn::SerializeCheckpoint( CArchive& archive )
 	}
 }
 
+void CDnn::StoreMapped( const char* fileName )
+{
+	CArchiveFile file( fileName, CArchive::store );
+	CArchive archive( &file, CArchive::store );
+	CDnnMappedBlobStorage storage;
+	storage.SerializeHeader( archive );
+	{
+		CDnnMappedBlobStorage::CScope scope( storage );
+		Serialize( archive );
+	}
+	storage.StoreData( archive );
+	archive.Close();
+	file.Close();
+}
+
+void CDnn::LoadMapped( const char* fileName )
+{
+	CMappedArchiveFile file( fileName );
+	CArchive archive( &file, CArchive::load );
+	// The blobs keep the file mapped after it is closed
+	CDnnMappedBlobStorage storage( file );
+	storage.SerializeHeader( archive );
+	{
+		CDnnMappedBlobStorage::CScope scope( storage );
+		Serialize( archive );
+	}
+	archive.Close();
+	file.Close();
+}
+
 void CDnn::EnableProfile( bool profile )
 {
 	for( int i = 0; i < layers.Size(); ++i ) {
@@ -825,4 +934,68 @@ void CDnn::EnableProfile( bool profile )
 	}
 }
 
+void CDnn::EnableStaticMemoryPlanning( bool enable )
+{
+	if( enable == IsStaticMemoryPlanningEnabled() ) {
+		return;
+	}
+	memoryPlan = enable ? FINE_DEBUG_NEW CDnnMemoryPlan( mathEngine ) : nullptr;
+	// The layers may keep the blobs from the previous plan
+	RequestReshape( true );
+}
+
+size_t CDnn::GetStaticMemoryPlanSize() const
+{
+	return memoryPlan == nullptr ? 0 : memoryPlan->GetArenaSize();
+}
+
+void CDnn::EnableParallelBranches( int threadCount )
+{
+	NeoAssert( threadCount >= 0 );
+	branchScheduler = FINE_DEBUG_NEW CDnnBranchScheduler( threadCount );
+}
+
+void CDnn::DisableParallelBranches()
+{
+	branchScheduler = nullptr;
+}
+
+void CDnn::GetCriticalPath( CDnnCriticalPath& path ) const
+{
+	path.Layers.Empty();
+	path.PathCost = 0;
+	path.TotalCost = 0;
+
+	CArray<CBaseLayer*> order;
+	getExecutionOrder( order );
+	// The cost of the most expensive chain ending with the layer and the previous layer of that chain
+	CMap<const CBaseLayer*, int64_t> chainCost;
+	CMap<const CBaseLayer*, const CBaseLayer*> prevLayer;
+	const CBaseLayer* lastLayer = nullptr;
+	for( int i = 0; i < order.Size(); ++i ) {
+		const CBaseLayer* layer = order[i];
+		const int64_t cost = layer->useTimer ? static_cast<int64_t>( layer->runOnceTime ) : 1;
+		const CBaseLayer* prev = nullptr;
+		int64_t prevCost = 0;
+		for( int j = 0; j < layer->GetInputCount(); ++j ) {
+			const CBaseLayer* input = layer->GetInputLayer( j );
+			if( prev == nullptr || chainCost.Get( input ) > prevCost ) {
+				prev = input;
+				prevCost = chainCost.Get( input );
+			}
+		}
+		chainCost.Add( layer, prevCost + cost );
+		prevLayer.Add( layer, prev );
+		path.TotalCost += cost;
+		if( lastLayer == nullptr || chainCost.Get( layer ) > path.PathCost ) {
+			lastLayer = layer;
+			path.PathCost = chainCost.Get( layer );
+		}
+	}
+
+	for( const CBaseLayer* layer = lastLayer; layer != nullptr; layer = prevLayer.Get( layer ) ) {
+		path.Layers.InsertAt( layer->GetName(), 0 );
+	}
+}
+
 } // namespace NeoML
@@ -19,6 +19,7 @@ limitations under the License.
 #include <NeoML/Dnn/DnnBlob.h>
 #include <NeoMathEngine/NeoMathEngine.h>
 #include <NeoML/Dnn/Layers/LossLayer.h>
+#include <Dnn/DnnMappedStorage.h>
 
 namespace NeoML {
 
@@ -586,4 +587,32 @@ void CDnnBlob::Serialize( CArchive& archive )
 	}
 }
 
+// The blobs are stored into the mapped model file storage when it is active (see CDnn::StoreMapped)
+void SerializeBlob( IMathEngine& mathEngine, CArchive& archive, CPtr<CDnnBlob>& blob )
+{
+	CDnnMappedBlobStorage* mappedStorage = CDnnMappedBlobStorage::GetCurrent();
+	if( archive.IsStoring() ) {
+		bool isNull = ( blob == 0 );
+		archive << isNull;
+		if( !isNull && mappedStorage != nullptr ) {
+			mappedStorage->SerializeBlob( mathEngine, archive, blob );
+		} else if( !isNull ) {
+			blob->Serialize( archive );
+		}
+	} else if( archive.IsLoading() ) {
+		bool isNull = false;
+		archive >> isNull;
+		if( isNull ) {
+			blob = 0;
+		} else if( mappedStorage != nullptr ) {
+			mappedStorage->SerializeBlob( mathEngine, archive, blob );
+		} else {
+			blob = FINE_DEBUG_NEW CDnnBlob( mathEngine );
+			blob->Serialize( archive );
+		}
+	} else {
+		NeoAssert( false );
+	}
+}
+
 } // namespace NeoML
@@ -0,0 +1,123 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <Dnn/DnnBranchScheduler.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <exception>
+#include <mutex>
+
+namespace NeoML {
+
+CDnnBranchScheduler::CDnnBranchScheduler( int _threadCount ) :
+	threadCount( _threadCount == 0 ? OmpGetMaxThreadCount() : _threadCount )
+{
+	NeoAssert( threadCount > 0 );
+}
+
+void CDnnBranchScheduler::Run( const CArray<CBaseLayer*>& order )
+{
+	buildLevels( order );
+	for( int level = 0; level < levelStarts.Size() - 1; ++level ) {
+		const int first = levelStarts[level];
+		const int count = levelStarts[level + 1] - first;
+		if( count == 1 || threadCount == 1 ) {
+			// The layer may use all the threads of the math engine
+			for( int i = first; i < first + count; ++i ) {
+				levelLayers[i]->runOnce();
+			}
+		} else {
+			runConcurrently( first, count );
+		}
+	}
+}
+
+// Splits the layers into levels
+void CDnnBranchScheduler::buildLevels( const CArray<CBaseLayer*>& order )
+{
+	CArray<int> levels;
+	CMap<const CBaseLayer*, int> layerIndex;
+	// The maximum level of the layers which use each output of each layer
+	CArray<int> outputUserLevels;
+	CArray<int> firstOutput;
+	int levelCount = 0;
+	for( int i = 0; i < order.Size(); ++i ) {
+		CBaseLayer* layer = order[i];
+		layerIndex.Add( layer, i );
+		firstOutput.Add( outputUserLevels.Size() );
+		outputUserLevels.Add( NotFound, layer->GetOutputCount() );
+
+		int level = 0;
+		for( int j = 0; j < layer->GetInputCount(); ++j ) {
+			const int inputIndex = layerIndex.Get( layer->GetInputLayer( j ) );
+			level = max( level, levels[inputIndex] + 1 );
+			if( layer->IsInPlace() && j < layer->GetOutputCount() ) {
+				// The input is overwritten so the layer waits for all the other layers using it
+				// The in-place layer is the last user of its input in the sequential order (see CBaseLayer::InputsMayBeOverwritten)
+				level = max( level, outputUserLevels[firstOutput[inputIndex] + layer->inputLinks[j].OutputNumber] + 1 );
+			}
+		}
+		for( int j = 0; j < layer->GetInputCount(); ++j ) {
+			int& userLevel = outputUserLevels[firstOutput[layerIndex.Get( layer->GetInputLayer( j ) )]
+				+ layer->inputLinks[j].OutputNumber];
+			userLevel = max( userLevel, level );
+		}
+		levels.Add( level );
+		levelCount = max( levelCount, level + 1 );
+	}
+
+	levelStarts.Empty();
+	levelStarts.Add( 0, levelCount + 1 );
+	for( int i = 0; i < levels.Size(); ++i ) {
+		levelStarts[levels[i] + 1]++;
+	}
+	for( int level = 0; level < levelCount; ++level ) {
+		levelStarts[level + 1] += levelStarts[level];
+	}
+	CArray<int> positions;
+	levelStarts.CopyTo( positions );
+	levelLayers.SetSize( order.Size() );
+	for( int i = 0; i < order.Size(); ++i ) {
+		levelLayers[positions[levels[i]]++] = order[i];
+	}
+}
+
+// Runs the layers of one level on the OpenMP threads
+// The operations of the math engine called from the layers are not parallelized (as the nested OpenMP regions)
+void CDnnBranchScheduler::runConcurrently( int first, int count )
+{
+	const int curThreadCount = min( threadCount, count );
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int i = first; i < first + count; ++i ) {
+		try {
+			levelLayers[i]->runOnce();
+		} catch( ... ) {
+			// The exceptions may not leave the OpenMP region
+			std::lock_guard<std::mutex> lock( errorMutex );
+			if( error == nullptr ) {
+				error = std::current_exception();
+			}
+		}
+	}
+	if( error != nullptr ) {
+		std::rethrow_exception( error );
+	}
+}
+
+} // namespace NeoML
@@ -0,0 +1,46 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/Dnn/Dnn.h>
+
+namespace NeoML {
+
+// Runs the independent layers of the network at the same time
+// The layers are split into levels: each layer depends only on the layers of the previous levels
+// The levels are run one by one, the layers of one level are run on the OpenMP threads
+class CDnnBranchScheduler : public IObject {
+public:
+	// threadCount == 0 means the number of OpenMP threads
+	explicit CDnnBranchScheduler( int threadCount );
+
+	// Runs the layers of the network
+	// The layers must be in the order of their sequential execution
+	void Run( const CArray<CBaseLayer*>& order );
+
+private:
+	// The maximum number of layers running at the same time
+	const int threadCount;
+	// The layers sorted by level
+	CArray<CBaseLayer*> levelLayers;
+	// The start of each level in levelLayers (with the end of the last level)
+	CArray<int> levelStarts;
+
+	void buildLevels( const CArray<CBaseLayer*>& order );
+	void runConcurrently( int first, int count );
+};
+
+} // namespace NeoML
@@ -0,0 +1,204 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <Dnn/DnnMappedStorage.h>
+
+namespace NeoML {
+
+// The signature of the mapped model file
+static const unsigned int MappedModelSignature = 0x464D4D4E; // "NMMF"
+static const int MappedModelVersion = 0;
+// The alignment of the blob data in the file (in bytes)
+static const int MappedModelDataAlignment = 64;
+// The maximum size of one write operation
+static const int MappedModelWriteChunkSize = 1 << 24;
+
+// The storage used on the current thread
+static thread_local CDnnMappedBlobStorage* currentStorage = nullptr;
+
+// The blob which data is placed in the mapped file
+class CDnnMappedBlob : public CDnnBlob {
+public:
+	CDnnMappedBlob( IMathEngine& mathEngine, const CBlobDesc& desc, CMemoryHandle data, IObject* _mapping ) :
+		CDnnBlob( mathEngine, desc, data, false ),
+		mapping( _mapping )
+	{
+	}
+
+private:
+	// Keeps the file mapped while the blob is in use
+	const CPtr<IObject> mapping;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+
+CDnnMappedBlobStorage::CDnnMappedBlobStorage() :
+	fileData( nullptr ),
+	fileLength( 0 )
+{
+}
+
+CDnnMappedBlobStorage::CDnnMappedBlobStorage( const CMappedArchiveFile& file ) :
+	mapping( file.GetMapping() ),
+	fileData( file.GetData() ),
+	fileLength( file.GetLength() )
+{
+}
+
+void CDnnMappedBlobStorage::SerializeHeader( CArchive& archive )
+{
+	NeoAssert( archive.GetPosition() == 0 );
+	if( archive.IsStoring() ) {
+		archive << MappedModelSignature;
+		archive.SerializeVersion( MappedModelVersion );
+		archive << MappedModelDataAlignment;
+		return;
+	}
+
+	NeoAssert( mapping != nullptr );
+	unsigned int signature = 0;
+	archive >> signature;
+	check( signature == MappedModelSignature, ERR_BAD_ARCHIVE, archive.Name() );
+	archive.SerializeVersion( MappedModelVersion );
+	int alignment = 0;
+	archive >> alignment;
+	check( alignment > 0, ERR_BAD_ARCHIVE, archive.Name() );
+	const __int64 headerEnd = archive.GetPosition();
+
+	archive.Seek( -static_cast<__int64>( sizeof( __int64 ) ), CBaseFile::end );
+	__int64 tablePosition = 0;
+	archive >> tablePosition;
+	check( headerEnd <= tablePosition && tablePosition < fileLength, ERR_BAD_ARCHIVE, archive.Name() );
+	archive.Seek( tablePosition, CBaseFile::begin );
+	int entryCount = 0;
+	archive >> entryCount;
+	check( entryCount >= 0, ERR_BAD_ARCHIVE, archive.Name() );
+	dataTable.SetSize( entryCount );
+	for( int i = 0; i < entryCount; ++i ) {
+		archive >> dataTable[i].Offset >> dataTable[i].Size;
+		check( dataTable[i].Offset >= headerEnd && dataTable[i].Size >= 0
+			&& dataTable[i].Offset + dataTable[i].Size <= tablePosition, ERR_BAD_ARCHIVE, archive.Name() );
+	}
+	archive.Seek( headerEnd, CBaseFile::begin );
+}
+
+void CDnnMappedBlobStorage::StoreData( CArchive& archive )
+{
+	NeoAssert( archive.IsStoring() );
+
+	CArray<CDataEntry> entries;
+	CArray<char> buffer;
+	for( int i = 0; i < blobs.Size(); ++i ) {
+		const CDnnBlob& blob = *blobs[i];
+		const __int64 padding = ( MappedModelDataAlignment - archive.GetPosition() % MappedModelDataAlignment )
+			% MappedModelDataAlignment;
+		for( __int64 j = 0; j < padding; ++j ) {
+			archive << static_cast<char>( 0 );
+		}
+
+		CDataEntry& entry = entries.Append();
+		entry.Offset = archive.GetPosition();
+		entry.Size = static_cast<__int64>( blob.GetDataSize() * sizeof( float ) );
+		// The data of one blob is written from a single buffer
+		check( entry.Size <= INT_MAX, ERR_BAD_ARCHIVE, archive.Name() );
+		buffer.SetSize( static_cast<int>( entry.Size ) );
+		if( blob.GetDataType() == CT_Float ) {
+			blob.CopyTo( reinterpret_cast<float*>( buffer.GetPtr() ) );
+		} else {
+			blob.CopyTo( reinterpret_cast<int*>( buffer.GetPtr() ) );
+		}
+		for( int pos = 0; pos < buffer.Size(); pos += MappedModelWriteChunkSize ) {
+			archive.Write( buffer.GetPtr() + pos, min( MappedModelWriteChunkSize, buffer.Size() - pos ) );
+		}
+	}
+
+	const __int64 tablePosition = archive.GetPosition();
+	archive << entries.Size();
+	for( int i = 0; i < entries.Size(); ++i ) {
+		archive << entries[i].Offset << entries[i].Size;
+	}
+	archive << tablePosition;
+}
+
+void CDnnMappedBlobStorage::SerializeBlob( IMathEngine& mathEngine, CArchive& archive, CPtr<CDnnBlob>& blob )
+{
+	static_assert( sizeof( int ) == sizeof( float ), "The float and int blobs are stored in the same way" );
+
+	if( archive.IsStoring() ) {
+		NeoAssert( blob->GetParent() == nullptr );
+		archive << static_cast<int>( blob->GetDataType() );
+		for( TBlobDim d = TBlobDim( 0 ); d < BD_Count; ++d ) {
+			archive << blob->DimSize( d );
+		}
+		archive << blobs.Size();
+		blobs.Add( blob );
+		return;
+	}
+
+	NeoAssert( mapping != nullptr );
+	int type = 0;
+	archive >> type;
+	check( type == CT_Float || type == CT_Int, ERR_BAD_ARCHIVE, archive.Name() );
+	CBlobDesc desc( static_cast<TBlobType>( type ) );
+	for( TBlobDim d = TBlobDim( 0 ); d < BD_Count; ++d ) {
+		int size = 0;
+		archive >> size;
+		check( size > 0, ERR_BAD_ARCHIVE, archive.Name() );
+		desc.SetDimSize( d, size );
+	}
+	int index = 0;
+	archive >> index;
+	check( 0 <= index && index < dataTable.Size(), ERR_BAD_ARCHIVE, archive.Name() );
+	const CDataEntry& entry = dataTable[index];
+	check( entry.Size == static_cast<__int64>( desc.BlobSize() * sizeof( float ) ), ERR_BAD_ARCHIVE, archive.Name() );
+
+	const char* data = fileData + entry.Offset;
+	CMemoryHandle handle;
+	if( reinterpret_cast<size_t>( data ) % MappedModelDataAlignment == 0 ) {
+		handle = mathEngine.WrapHostMemory( data );
+	}
+	if( !handle.IsNull() ) {
+		blob = FINE_DEBUG_NEW CDnnMappedBlob( mathEngine, desc, handle, mapping );
+	} else {
+		// The math engine can't use the mapped memory, the data is copied
+		blob = CDnnBlob::CreateBlob( mathEngine, desc );
+		if( desc.GetDataType() == CT_Float ) {
+			blob->CopyFrom( reinterpret_cast<const float*>( data ) );
+		} else {
+			blob->CopyFrom( reinterpret_cast<const int*>( data ) );
+		}
+	}
+}
+
+CDnnMappedBlobStorage* CDnnMappedBlobStorage::GetCurrent()
+{
+	return currentStorage;
+}
+
+CDnnMappedBlobStorage::CScope::CScope( CDnnMappedBlobStorage& storage ) :
+	prevStorage( currentStorage )
+{
+	currentStorage = &storage;
+}
+
+CDnnMappedBlobStorage::CScope::~CScope()
+{
+	currentStorage = prevStorage;
+}
+
+} // namespace NeoML
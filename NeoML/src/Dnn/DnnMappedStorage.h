@@ -0,0 +1,78 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/ArchiveFile.h>
+#include <NeoML/Dnn/DnnBlob.h>
+
+namespace NeoML {
+
+// The storage for the blob data of the mapped model file (see CDnn::StoreMapped and CDnn::LoadMapped)
+// The file format:
+// - the header (the signature, the format version and the data alignment)
+// - the network archive; the blobs serialized by SerializeBlob contain the descriptors and the indices in the data table
+// - the blob data, each blob is aligned in the file
+// - the data table (the offset and the size of each blob data) and its position in the file
+class CDnnMappedBlobStorage {
+public:
+	// The storage for storing the blobs
+	CDnnMappedBlobStorage();
+	// The storage for loading the blobs from the mapped file
+	explicit CDnnMappedBlobStorage( const CMappedArchiveFile& file );
+
+	// Serializes the header and the data table (when loading)
+	// The archive must start at the beginning of the file
+	void SerializeHeader( CArchive& archive );
+	// Writes the blob data and the data table
+	void StoreData( CArchive& archive );
+
+	// Stores or loads the blob (called from SerializeBlob)
+	void SerializeBlob( IMathEngine& mathEngine, CArchive& archive, CPtr<CDnnBlob>& blob );
+
+	// The storage used by SerializeBlob on the current thread (null if the default serialization is used)
+	static CDnnMappedBlobStorage* GetCurrent();
+
+	// Sets the storage used by SerializeBlob on the current thread while the object exists
+	class CScope {
+	public:
+		explicit CScope( CDnnMappedBlobStorage& storage );
+		~CScope();
+
+	private:
+		CDnnMappedBlobStorage* const prevStorage;
+	};
+
+private:
+	// The blob data in the file
+	struct CDataEntry {
+		__int64 Offset; // the offset from the file start (in bytes)
+		__int64 Size; // the size (in bytes)
+	};
+
+	// The stored blobs
+	CObjectArray<CDnnBlob> blobs;
+	// The mapped file
+	CPtr<IObject> mapping;
+	const char* fileData;
+	__int64 fileLength;
+	// The loaded data table
+	CArray<CDataEntry> dataTable;
+
+	CDnnMappedBlobStorage( const CDnnMappedBlobStorage& ) = delete;
+	CDnnMappedBlobStorage& operator=( const CDnnMappedBlobStorage& ) = delete;
+};
+
+} // namespace NeoML
@@ -0,0 +1,221 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <Dnn/DnnMemoryPlan.h>
+
+namespace NeoML {
+
+// The alignment of the blobs in the arena (in elements)
+static const int ArenaBlobAlignment = 16;
+
+// The blob whose data is placed in the arena
+class CDnnArenaBlob : public CDnnBlob {
+public:
+	CDnnArenaBlob( CDnnBlob& _arena, const CBlobDesc& desc, int64_t offset ) :
+		CDnnBlob( _arena.GetMathEngine(), desc, _arena.GetData() + offset, false ),
+		arena( &_arena )
+	{
+	}
+
+private:
+	// Keeps the arena alive while the blob is in use
+	const CPtr<CDnnBlob> arena;
+};
+
+// The memory buffer used by one or several blobs (several if the layers work in-place)
+struct CArenaBuffer {
+	int64_t Size; // the buffer size (in elements)
+	int Start; // the first step of the execution when the buffer is used
+	int End; // the last step of the execution when the buffer is used
+	int64_t Offset; // the offset in the arena
+
+	CArenaBuffer( int64_t size, int start ) : Size( size ), Start( start ), End( start ), Offset( NotFound ) {}
+
+	bool IsIntersecting( const CArenaBuffer& other ) const { return Start <= other.End && other.Start <= End; }
+};
+
+// Orders the buffers by decreasing size, the buffers of the same size are ordered by their first use
+class CArenaBufferPlacementOrder {
+public:
+	bool Predicate( const CArenaBuffer* first, const CArenaBuffer* second ) const
+		{ return first->Size > second->Size || ( first->Size == second->Size && first->Start < second->Start ); }
+	bool IsEqual( const CArenaBuffer* first, const CArenaBuffer* second ) const
+		{ return first->Size == second->Size && first->Start == second->Start; }
+	void Swap( CArenaBuffer*& first, CArenaBuffer*& second ) const { std::swap( first, second ); }
+};
+
+// Orders the placed buffers by their offsets
+class CArenaBufferOffsetAscending {
+public:
+	bool Predicate( const CArenaBuffer* first, const CArenaBuffer* second ) const { return first->Offset < second->Offset; }
+	bool IsEqual( const CArenaBuffer* first, const CArenaBuffer* second ) const { return first->Offset == second->Offset; }
+	void Swap( CArenaBuffer*& first, CArenaBuffer*& second ) const { std::swap( first, second ); }
+};
+
+// Places the buffers in the arena
+// The largest buffers are placed first, each one is placed at the lowest offset that doesn't intersect with the placed buffers
+// Returns the arena size
+static int64_t placeBuffers( CArray<CArenaBuffer>& buffers )
+{
+	CArray<CArenaBuffer*> sorted;
+	for( int i = 0; i < buffers.Size(); ++i ) {
+		sorted.Add( &buffers[i] );
+	}
+	sorted.QuickSort<CArenaBufferPlacementOrder>();
+
+	int64_t arenaSize = 0;
+	CArray<CArenaBuffer*> conflicts;
+	for( int i = 0; i < sorted.Size(); ++i ) {
+		CArenaBuffer* buffer = sorted[i];
+		conflicts.Empty();
+		for( int j = 0; j < i; ++j ) {
+			if( sorted[j]->IsIntersecting( *buffer ) ) {
+				conflicts.Add( sorted[j] );
+			}
+		}
+		conflicts.QuickSort<CArenaBufferOffsetAscending>();
+
+		int64_t offset = 0;
+		for( int j = 0; j < conflicts.Size(); ++j ) {
+			if( offset + buffer->Size <= conflicts[j]->Offset ) {
+				break;
+			}
+			offset = max( offset, conflicts[j]->Offset + conflicts[j]->Size );
+		}
+		buffer->Offset = offset;
+		arenaSize = max( arenaSize, offset + buffer->Size );
+	}
+	return arenaSize;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+CDnnMemoryPlan::CDnnMemoryPlan( IMathEngine& _mathEngine ) :
+	mathEngine( _mathEngine )
+{
+}
+
+void CDnnMemoryPlan::Build( const CArray<CBaseLayer*>& order )
+{
+	CArray<CEntry> newEntries;
+	const int64_t plannedSize = max( buildPlan( order, newEntries ), static_cast<int64_t>( 1 ) );
+	// The arena is one blob
+	NeoAssert( plannedSize <= INT_MAX );
+	const int arenaSize = static_cast<int>( plannedSize );
+
+	if( arena == nullptr || arena->GetDataSize() != arenaSize || !isSamePlan( newEntries ) ) {
+		blobs.DeleteAll();
+		if( arena == nullptr || arena->GetDataSize() != arenaSize ) {
+			arena = nullptr;
+			arena = CDnnBlob::CreateVector( mathEngine, CT_Float, arenaSize );
+		}
+		for( int i = 0; i < newEntries.Size(); ++i ) {
+			blobs.Add( FINE_DEBUG_NEW CDnnArenaBlob( *arena, newEntries[i].Desc, newEntries[i].Offset ) );
+		}
+		newEntries.MoveTo( entries );
+	}
+}
+
+void CDnnMemoryPlan::Apply()
+{
+	NeoPresume( IsBuilt() );
+	for( int i = 0; i < entries.Size(); ++i ) {
+		CPtr<CDnnBlob>& output = entries[i].Layer->outputBlobs[entries[i].Output];
+		if( output != blobs[i] ) {
+			output = blobs[i];
+		}
+	}
+}
+
+// Builds the plan for the current state of the network
+// Returns the required arena size
+int64_t CDnnMemoryPlan::buildPlan( const CArray<CBaseLayer*>& order, CArray<CEntry>& newEntries ) const
+{
+	static_assert( sizeof( int ) == sizeof( float ), "The arena is shared between float and int blobs" );
+
+	// The layers without outputs may keep their inputs after the run (e.g. the sink layers)
+	const int lastStep = order.Size();
+	CArray<CArenaBuffer> buffers;
+	// The buffers of the layer outputs (NotFound if the output isn't placed in the arena)
+	CArray<int> outputBuffers;
+	CMap<const CBaseLayer*, int> firstOutputBuffer;
+	for( int step = 0; step < order.Size(); ++step ) {
+		CBaseLayer* layer = order[step];
+		const int inputEnd = layer->GetOutputCount() == 0 ? lastStep : step;
+		for( int i = 0; i < layer->GetInputCount(); ++i ) {
+			const int buffer = outputBuffers[firstOutputBuffer.Get( layer->GetInputLayer( i ) )
+				+ layer->inputLinks[i].OutputNumber];
+			if( buffer != NotFound ) {
+				buffers[buffer].End = max( buffers[buffer].End, inputEnd );
+			}
+		}
+
+		firstOutputBuffer.Add( layer, outputBuffers.Size() );
+		// The source layers provide the user blobs and the composite layers provide the blobs of the internal network
+		const bool isPlanned = layer->GetInputCount() > 0 && !layer->isComposite();
+		for( int i = 0; i < layer->GetOutputCount(); ++i ) {
+			if( !isPlanned ) {
+				outputBuffers.Add( NotFound );
+			} else if( layer->IsInPlace() ) {
+				// The output is the same blob as the corresponding input
+				const int inputBuffer = outputBuffers[firstOutputBuffer.Get( layer->GetInputLayer( i ) )
+					+ layer->inputLinks[i].OutputNumber];
+				outputBuffers.Add( inputBuffer );
+			} else {
+				const CBlobDesc& desc = layer->outputDescs[i];
+				const int64_t size = ( static_cast<int64_t>( desc.BlobSize() ) + ArenaBlobAlignment - 1 )
+					/ ArenaBlobAlignment * ArenaBlobAlignment;
+				outputBuffers.Add( buffers.Size() );
+				buffers.Add( CArenaBuffer( size, step ) );
+
+				CEntry& entry = newEntries.Append();
+				entry.Layer = layer;
+				entry.Output = i;
+				entry.Offset = outputBuffers.Last();
+				entry.Desc = desc;
+			}
+		}
+	}
+
+	const int64_t arenaSize = placeBuffers( buffers );
+	for( int i = 0; i < newEntries.Size(); ++i ) {
+		newEntries[i].Offset = buffers[newEntries[i].Offset].Offset;
+	}
+	return arenaSize;
+}
+
+// Checks if the plan is the same as the current one
+bool CDnnMemoryPlan::isSamePlan( const CArray<CEntry>& newEntries ) const
+{
+	if( newEntries.Size() != entries.Size() ) {
+		return false;
+	}
+	for( int i = 0; i < entries.Size(); ++i ) {
+		const CEntry& entry = entries[i];
+		const CEntry& newEntry = newEntries[i];
+		if( entry.Layer != newEntry.Layer || entry.Output != newEntry.Output || entry.Offset != newEntry.Offset
+			|| entry.Desc.GetDataType() != newEntry.Desc.GetDataType()
+			|| !entry.Desc.HasEqualDimensions( newEntry.Desc ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace NeoML
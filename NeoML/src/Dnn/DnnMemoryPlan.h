@@ -0,0 +1,63 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/Dnn/Dnn.h>
+
+namespace NeoML {
+
+// The static memory plan for the network inference
+// The output blobs of the layers are placed into one preallocated arena
+// The blobs whose lifetimes don't intersect share the same memory
+class CDnnMemoryPlan : public IObject {
+public:
+	explicit CDnnMemoryPlan( IMathEngine& mathEngine );
+
+	// Checks if the plan has been built
+	bool IsBuilt() const { return arena != nullptr; }
+	// Builds the plan for the current state of the network
+	// Must be called after each reshape of the network, the previous plan is kept if it is still correct
+	// The layers must be in the order of their execution
+	void Build( const CArray<CBaseLayer*>& order );
+	// Sets the output blobs of the layers
+	// Must be called before each run, as the layers delete their output blobs on reshape
+	void Apply();
+
+	// The size of the arena in bytes
+	size_t GetArenaSize() const { return arena == nullptr ? 0 : arena->GetDataSize() * sizeof( float ); }
+
+private:
+	// The output blob placed in the arena
+	struct CEntry {
+		CBaseLayer* Layer; // the layer
+		int Output; // the number of the layer output
+		int64_t Offset; // the offset in the arena (in elements)
+		CBlobDesc Desc; // the blob descriptor
+	};
+
+	IMathEngine& mathEngine;
+	// The current plan
+	CArray<CEntry> entries;
+	// The blobs in the arena, one for each entry
+	CObjectArray<CDnnBlob> blobs;
+	// The arena
+	CPtr<CDnnBlob> arena;
+
+	int64_t buildPlan( const CArray<CBaseLayer*>& order, CArray<CEntry>& newEntries ) const;
+	bool isSamePlan( const CArray<CEntry>& newEntries ) const;
+};
+
+} // namespace NeoML
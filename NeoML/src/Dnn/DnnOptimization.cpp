@@ -23,9 +23,233 @@ limitations under the License.
 #include <NeoML/Dnn/Layers/ChannelwiseConvLayer.h>
 #include <NeoML/Dnn/Layers/ActivationLayers.h>
 #include <NeoML/Dnn/Layers/EltwiseLayer.h>
+#include <NeoML/Dnn/Layers/BatchNormalizationLayer.h>
+#include <NeoML/Dnn/Layers/FullyConnectedLayer.h>
+#include <NeoML/Dnn/Layers/DropoutLayer.h>
+#include <NeoML/Dnn/Layers/TransposeLayer.h>
+#include <NeoML/Dnn/Layers/TransformLayer.h>
 
 namespace NeoML {
 
+// Fills map with pairs:
+//     layerName : number of inputs connected to its outputs
+static void calculateOutputConnections( const CDnn& dnn, CMap<CString, int>& outputConnections )
+{
+	outputConnections.DeleteAll();
+	CArray<const char*> layerList;
+	dnn.GetLayerList( layerList );
+	for( int i = 0; i < layerList.Size(); ++i ) {
+		outputConnections.GetOrCreateValue( layerList[i] ) = 0;
+	}
+	for( int i = 0; i < layerList.Size(); ++i ) {
+		const CBaseLayer* layer = dnn.GetLayer( layerList[i] );
+		for( int inputIndex = 0; inputIndex < layer->GetInputCount(); ++inputIndex ) {
+			outputConnections[layer->GetInputName( inputIndex )]++;
+		}
+	}
+}
+
+// Deletes the layer with a single input and connects everything connected to its output to its input
+static void removeLayer( CDnn& dnn, CBaseLayer& layer )
+{
+	NeoPresume( layer.GetInputCount() == 1 );
+	const CString name = layer.GetName();
+	const CString inputName = layer.GetInputName( 0 );
+	const int inputOutputNumber = layer.GetInputOutputNumber( 0 );
+
+	CArray<const char*> layerList;
+	dnn.GetLayerList( layerList );
+	for( int i = 0; i < layerList.Size(); ++i ) {
+		CBaseLayer* consumer = dnn.GetLayer( layerList[i] );
+		for( int inputIndex = 0; inputIndex < consumer->GetInputCount(); ++inputIndex ) {
+			if( name == consumer->GetInputName( inputIndex ) ) {
+				consumer->Connect( inputIndex, inputName, inputOutputNumber );
+			}
+		}
+	}
+	dnn.DeleteLayer( layer );
+}
+
+// The graph rewrite
+// Checks if the pattern ends with the given layer and replaces the pattern
+// Returns the number of the layers affected by the rewrite (0 if the pattern isn't found)
+typedef int ( *TDnnRewrite )( CDnn& dnn, const CMap<CString, int>& outputConnections, CBaseLayer& lastLayer );
+
+// Applies the rewrite to the layers of dnn while the pattern is found
+// Returns the sum of the rewrite results
+static int applyRewrite( CDnn& dnn, TDnnRewrite rewrite )
+{
+	int result = 0;
+	CMap<CString, int> outputConnections;
+	CArray<const char*> layerList;
+	bool isChanged = true;
+	while( isChanged ) {
+		isChanged = false;
+		// The layer list becomes invalid after any rewrite
+		calculateOutputConnections( dnn, outputConnections );
+		dnn.GetLayerList( layerList );
+		for( int i = 0; i < layerList.Size() && !isChanged; ++i ) {
+			CPtr<CBaseLayer> layer = dnn.GetLayer( layerList[i] );
+			const int affected = rewrite( dnn, outputConnections, *layer );
+			result += affected;
+			isChanged = affected > 0;
+		}
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Removes the layer which doesn't change the data during inference
+static int removeTrivialLayer( CDnn& dnn, const CMap<CString, int>& /* outputConnections */, CBaseLayer& layer )
+{
+	if( layer.GetInputCount() != 1 ) {
+		return 0;
+	}
+
+	bool isTrivial = dynamic_cast<CDropoutLayer*>( &layer ) != nullptr;
+	const CLinearLayer* linear = dynamic_cast<CLinearLayer*>( &layer );
+	if( linear != nullptr ) {
+		isTrivial = linear->GetMultiplier() == 1.f && linear->GetFreeTerm() == 0.f;
+	}
+	const CTransposeLayer* transpose = dynamic_cast<CTransposeLayer*>( &layer );
+	if( transpose != nullptr ) {
+		TBlobDim d1;
+		TBlobDim d2;
+		transpose->GetTransposedDimensions( d1, d2 );
+		isTrivial = d1 == d2;
+	}
+
+	if( !isTrivial ) {
+		return 0;
+	}
+	removeLayer( dnn, layer );
+	return 1;
+}
+
+// Removes two transpositions of the same dimensions in a row
+static int removeTransposePair( CDnn& dnn, const CMap<CString, int>& outputConnections, CBaseLayer& layer )
+{
+	CTransposeLayer* second = dynamic_cast<CTransposeLayer*>( &layer );
+	if( second == nullptr || second->GetInputCount() != 1 ) {
+		return 0;
+	}
+	CPtr<CTransposeLayer> first = dynamic_cast<CTransposeLayer*>( dnn.GetLayer( second->GetInputName( 0 ) ).Ptr() );
+	if( first == nullptr || first->GetInputCount() != 1 || outputConnections[first->GetName()] != 1 ) {
+		return 0;
+	}
+
+	TBlobDim firstD1;
+	TBlobDim firstD2;
+	first->GetTransposedDimensions( firstD1, firstD2 );
+	TBlobDim secondD1;
+	TBlobDim secondD2;
+	second->GetTransposedDimensions( secondD1, secondD2 );
+	if( !( firstD1 == secondD1 && firstD2 == secondD2 ) && !( firstD1 == secondD2 && firstD2 == secondD1 ) ) {
+		return 0;
+	}
+
+	removeLayer( dnn, *second );
+	removeLayer( dnn, *first );
+	return 2;
+}
+
+// Removes the transform if its output is transformed once again and the second transform
+// doesn't depend on the input dimensions
+static int removeTransformChain( CDnn& dnn, const CMap<CString, int>& outputConnections, CBaseLayer& layer )
+{
+	const CTransformLayer* second = dynamic_cast<CTransformLayer*>( &layer );
+	if( second == nullptr || second->GetInputCount() != 1 ) {
+		return 0;
+	}
+	for( int d = 0; d < BD_Count; ++d ) {
+		const CTransformLayer::TOperation operation = second->GetDimensionRule( TBlobDim( d ) ).Operation;
+		if( operation != CTransformLayer::O_SetSize && operation != CTransformLayer::O_Remainder ) {
+			return 0;
+		}
+	}
+	CTransformLayer* first = dynamic_cast<CTransformLayer*>( dnn.GetLayer( second->GetInputName( 0 ) ).Ptr() );
+	if( first == nullptr || first->GetInputCount() != 1 || outputConnections[first->GetName()] != 1 ) {
+		return 0;
+	}
+
+	removeLayer( dnn, *first );
+	return 1;
+}
+
+// Merges the batch normalization into the weights of the preceding layer
+static int fuseBatchNormalization( CDnn& dnn, const CMap<CString, int>& outputConnections, CBaseLayer& layer )
+{
+	CBatchNormalizationLayer* batchNorm = dynamic_cast<CBatchNormalizationLayer*>( &layer );
+	// The free term of the preceding layer would be changed even if the normalization has no free term
+	if( batchNorm == nullptr || batchNorm->GetInputCount() != 1 || batchNorm->IsZeroFreeTerm() ) {
+		return 0;
+	}
+	CBaseLayer* inputLayer = dnn.GetLayer( batchNorm->GetInputName( 0 ) );
+	if( outputConnections[inputLayer->GetName()] != 1 ) {
+		return 0;
+	}
+	CPtr<CDnnBlob> params = batchNorm->GetFinalParams();
+	if( params == nullptr ) {
+		return 0;
+	}
+
+	CConvLayer* conv = dynamic_cast<CConvLayer*>( inputLayer );
+	CFullyConnectedLayer* fc = dynamic_cast<CFullyConnectedLayer*>( inputLayer );
+	if( conv != nullptr && !conv->IsReLUFused() && batchNorm->IsChannelBased()
+		&& params->GetObjectSize() == conv->GetFilterCount() && conv->GetFilterData() != nullptr )
+	{
+		// The convolution always adds the free term, it's filled with zeros if IsZeroFreeTerm()
+		conv->ApplyBatchNormalization( *batchNorm );
+		conv->SetZeroFreeTerm( false );
+	} else if( fc != nullptr && !fc->IsReLUFused()
+		&& params->GetObjectSize() == fc->GetNumberOfElements() && fc->Weights() != nullptr )
+	{
+		if( fc->IsZeroFreeTerm() ) {
+			fc->FreeTerms()->Fill( 0 );
+			fc->SetZeroFreeTerm( false );
+		}
+		fc->ApplyBatchNormalization( *batchNorm );
+	} else {
+		return 0;
+	}
+
+	removeLayer( dnn, *batchNorm );
+	return 1;
+}
+
+// Merges ReLU into the preceding layer
+// Only CReLULayer is merged: the kernels apply no other activation (sigmoid, tanh, HSwish etc.) inside
+static int fuseReLU( CDnn& dnn, const CMap<CString, int>& outputConnections, CBaseLayer& layer )
+{
+	CReLULayer* relu = dynamic_cast<CReLULayer*>( &layer );
+	if( relu == nullptr || relu->GetInputCount() != 1 ) {
+		return 0;
+	}
+	CBaseLayer* inputLayer = dnn.GetLayer( relu->GetInputName( 0 ) );
+	if( outputConnections[inputLayer->GetName()] != 1 ) {
+		return 0;
+	}
+
+	CConvLayer* conv = dynamic_cast<CConvLayer*>( inputLayer );
+	CFullyConnectedLayer* fc = dynamic_cast<CFullyConnectedLayer*>( inputLayer );
+	CEltwiseSumLayer* sum = dynamic_cast<CEltwiseSumLayer*>( inputLayer );
+	if( conv != nullptr && !conv->IsReLUFused() ) {
+		conv->SetFusedReLU( true, relu->GetUpperThreshold() );
+	} else if( fc != nullptr && !fc->IsReLUFused() ) {
+		fc->SetFusedReLU( true, relu->GetUpperThreshold() );
+	} else if( sum != nullptr && !sum->IsReLUFused() ) {
+		sum->SetFusedReLU( true, relu->GetUpperThreshold() );
+	} else {
+		return 0;
+	}
+
+	removeLayer( dnn, *relu );
+	return 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
 namespace MobileNetV2 {
 
 // Information about mobile net block detected in CDnn
@@ -56,24 +280,6 @@ static void markLayersAsDeleted( const CBlockInfo& info,
 	}
 }
 
-// Fills map with pairs:
-//     layerName : number of inputs connected to its outputs
-static void calculateOutputConnections( const CDnn& dnn, CMap<CString, int>& outputConnections )
-{
-	outputConnections.DeleteAll();
-	CArray<const char*> layerList;
-	dnn.GetLayerList( layerList );
-	for( int i = 0; i < layerList.Size(); ++i ) {
-		outputConnections.GetOrCreateValue( layerList[i] ) = 0;
-	}
-	for( int i = 0; i < layerList.Size(); ++i ) {
-		const CBaseLayer* layer = dnn.GetLayer( layerList[i] );
-		for( int inputIndex = 0; inputIndex < layer->GetInputCount(); ++inputIndex ) {
-			outputConnections[layer->GetInputName( inputIndex )]++;
-		}
-	}
-}
-
 // Checks that there is a block ending with lastLayer
 // If block is detected returns true and fills the info with details
 // Otherwise returns false
@@ -83,7 +289,8 @@ static bool getMobileNetV2Block( const CMap<CString, int>& outputConnections, co
 	CEltwiseSumLayer* residual = dynamic_cast<CEltwiseSumLayer*>( lastLayer );
 	if( residual != nullptr ) {
 		if( lastLayer->GetInputCount() != 2
-			|| layersToDelete.Has( lastLayer->GetName() ) )
+			|| layersToDelete.Has( lastLayer->GetName() )
+			|| residual->IsReLUFused() )
 		{
 			return false;
 		}
@@ -109,6 +316,7 @@ static bool getMobileNetV2Block( const CMap<CString, int>& outputConnections, co
 	auto isValid1x1Conv = [&layersToDelete] ( const CConvLayer* conv ) -> bool
 	{
 		if( conv == nullptr
+			|| conv->IsReLUFused()
 			|| layersToDelete.Has( conv->GetName() )
 			|| conv->GetInputCount() > 1
 			|| conv->GetFilterHeight() != 1 || conv->GetFilterWidth() != 1
@@ -249,7 +457,13 @@ static void optimizeDnn( CDnn& dnn, CDnnOptimizationReport& report )
 CDnnOptimizationReport OptimizeDnn( CDnn& dnn )
 {
 	CDnnOptimizationReport report;
+	report.RemovedTrivialLayers = applyRewrite( dnn, removeTrivialLayer );
+	report.RemovedTrivialLayers += applyRewrite( dnn, removeTransposePair );
+	report.RemovedTrivialLayers += applyRewrite( dnn, removeTransformChain );
+	report.FusedBatchNormalizations = applyRewrite( dnn, fuseBatchNormalization );
+	// The activations are fused after MobileNetV2 optimization which looks for the separate ReLU layers
 	MobileNetV2::optimizeDnn( dnn, report );
+	report.FusedActivations = applyRewrite( dnn, fuseReLU );
 	return report;
 }
 
@@ -0,0 +1,156 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <NeoML/Dnn/DnnQuantization.h>
+#include <Dnn/DnnQuantizationInternal.h>
+#include <NeoML/Dnn/Dnn.h>
+#include <NeoML/Dnn/Layers/CompositeLayer.h>
+#include <NeoML/Dnn/Layers/ConvLayer.h>
+#include <NeoML/Dnn/Layers/FullyConnectedLayer.h>
+
+namespace NeoML {
+
+float CalcMaxAbsValue( const CDnnBlob& blob )
+{
+	NeoAssert( blob.GetDataType() == CT_Float );
+	IMathEngine& mathEngine = blob.GetMathEngine();
+	const int dataSize = blob.GetDataSize();
+
+	CFloatHandleStackVar buffer( mathEngine, dataSize + 1 );
+	CFloatHandle absData = buffer.GetHandle();
+	CFloatHandle maxValue = buffer.GetHandle() + dataSize;
+	mathEngine.VectorAbs( blob.GetData(), absData, dataSize );
+	mathEngine.FindMaxValueInRows( absData, 1, dataSize, maxValue, 1 );
+	return maxValue.GetValue();
+}
+
+void SerializeQuantizedMatrix( CArchive& archive, IMathEngine& mathEngine, CQuantizedMatrixDesc*& matrix,
+	int& height, int& width )
+{
+	archive.Serialize( height );
+	archive.Serialize( width );
+
+	CArray<signed char> data;
+	CArray<float> scales;
+	if( archive.IsStoring() ) {
+		NeoAssert( matrix != nullptr );
+		data.SetSize( height * width );
+		scales.SetSize( height );
+		mathEngine.GetQuantizedMatrixData( *matrix, data.GetPtr(), scales.GetPtr() );
+		archive.Write( data.GetPtr(), data.Size() * sizeof( signed char ) );
+		archive.Write( scales.GetPtr(), scales.Size() * sizeof( float ) );
+	} else if( archive.IsLoading() ) {
+		check( height > 0 && width > 0, ERR_BAD_ARCHIVE, archive.Name() );
+		data.SetSize( height * width );
+		scales.SetSize( height );
+		archive.Read( data.GetPtr(), data.Size() * sizeof( signed char ) );
+		archive.Read( scales.GetPtr(), scales.Size() * sizeof( float ) );
+		delete matrix;
+		matrix = mathEngine.InitQuantizedMatrix( data.GetPtr(), scales.GetPtr(), height, width );
+	} else {
+		NeoAssert( false );
+	}
+}
+
+// Calls the function for every layer of the graph including the layers of the composite layers
+template<class TFunction>
+static void forEachLayer( CDnnLayerGraph& graph, const TFunction& function )
+{
+	CArray<const char*> layerList;
+	graph.GetLayerList( layerList );
+	for( int i = 0; i < layerList.Size(); ++i ) {
+		CBaseLayer* layer = graph.GetLayer( layerList[i] ).Ptr();
+		CCompositeLayer* composite = dynamic_cast<CCompositeLayer*>( layer );
+		if( composite != nullptr ) {
+			forEachLayer( *composite, function );
+		} else {
+			function( *layer );
+		}
+	}
+}
+
+void BeginInt8Calibration( CDnn& dnn )
+{
+	forEachLayer( dnn, [] ( CBaseLayer& layer ) {
+		CFullyConnectedLayer* fc = dynamic_cast<CFullyConnectedLayer*>( &layer );
+		if( fc != nullptr ) {
+			fc->SetInt8InputMaxAbs( 0 );
+			fc->SetInt8CalibrationEnabled( true );
+		}
+		CConvLayer* conv = dynamic_cast<CConvLayer*>( &layer );
+		if( conv != nullptr ) {
+			conv->SetInt8InputMaxAbs( 0 );
+			conv->SetInt8CalibrationEnabled( true );
+		}
+	} );
+}
+
+CDnnQuantizationReport QuantizeDnnToInt8( CDnn& dnn, bool dropFloatWeights )
+{
+	CDnnQuantizationReport report;
+	report.FullyConnectedLayers = 0;
+	report.ConvLayers = 0;
+	report.DynamicInputLayers = 0;
+
+	forEachLayer( dnn, [&report, dropFloatWeights] ( CBaseLayer& layer ) {
+		CFullyConnectedLayer* fc = dynamic_cast<CFullyConnectedLayer*>( &layer );
+		if( fc != nullptr ) {
+			fc->SetInt8CalibrationEnabled( false );
+			fc->SetInt8InferenceEnabled( true );
+			if( dropFloatWeights ) {
+				fc->DropFloatWeights();
+			}
+			report.FullyConnectedLayers++;
+			if( fc->GetInt8InputMaxAbs() == 0 ) {
+				report.DynamicInputLayers++;
+			}
+		}
+		CConvLayer* conv = dynamic_cast<CConvLayer*>( &layer );
+		if( conv != nullptr ) {
+			conv->SetInt8CalibrationEnabled( false );
+			conv->SetInt8InferenceEnabled( true );
+			if( dropFloatWeights ) {
+				conv->DropFloatFilter();
+			}
+			report.ConvLayers++;
+			if( conv->GetInt8InputMaxAbs() == 0 ) {
+				report.DynamicInputLayers++;
+			}
+		}
+	} );
+
+	return report;
+}
+
+void DisableInt8Inference( CDnn& dnn )
+{
+	forEachLayer( dnn, [] ( CBaseLayer& layer ) {
+		CFullyConnectedLayer* fc = dynamic_cast<CFullyConnectedLayer*>( &layer );
+		if( fc != nullptr ) {
+			fc->SetInt8CalibrationEnabled( false );
+			fc->SetInt8InferenceEnabled( false );
+		}
+		CConvLayer* conv = dynamic_cast<CConvLayer*>( &layer );
+		if( conv != nullptr ) {
+			conv->SetInt8CalibrationEnabled( false );
+			conv->SetInt8InferenceEnabled( false );
+		}
+	} );
+}
+
+} // namespace NeoML
@@ -0,0 +1,29 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/NeoMLDefs.h>
+#include <NeoMathEngine/NeoMathEngine.h>
+
+namespace NeoML {
+
+// Serializes the quantized matrix of a layer which has dropped its float weights
+// The size, the int8 data and the scales are stored as is, so that the matrix is restored without requantization
+// On loading the previous matrix is destroyed
+void SerializeQuantizedMatrix( CArchive& archive, IMathEngine& mathEngine, CQuantizedMatrixDesc*& matrix,
+	int& height, int& width );
+
+} // namespace NeoML
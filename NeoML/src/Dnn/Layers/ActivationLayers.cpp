@@ -72,6 +72,14 @@ CPtr<CBaseLayer> CreateActivationLayer( IMathEngine& mathEngine, const CActivati
 	return 0;
 }
 
+void ApplyFusedReLU( CDnnBlob& blob, float upperThreshold )
+{
+	IMathEngine& mathEngine = blob.GetMathEngine();
+	CFloatHandleStackVar threshold( mathEngine );
+	threshold.SetValue( upperThreshold );
+	mathEngine.VectorReLU( blob.GetData(), blob.GetData(), blob.GetDataSize(), threshold );
+}
+
 ///////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////
 CLinearLayer::CLinearLayer( IMathEngine& mathEngine ) :
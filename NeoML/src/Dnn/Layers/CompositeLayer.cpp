@@ -63,10 +63,13 @@ void CCompositeSourceLayer::SetDiffBlob(CDnnBlob* blob)
 
 void CCompositeSourceLayer::Reshape()
 {
-	NeoPresume( outputDescs.Size() == 1 );
+	NeoPresume( outputDescs.Size() <= 1 );
 	NeoPresume( desc.GetDataType() != CT_Invalid );
 
-	outputDescs[0] = desc;
+	// The input may be not used by the internal network (e.g. the sequence lengths of the recurrent layers)
+	if( !outputDescs.IsEmpty() ) {
+		outputDescs[0] = desc;
+	}
 }
 
 void CCompositeSourceLayer::RunOnce()
@@ -85,10 +88,10 @@ void CCompositeSourceLayer::BackwardOnce()
 
 void CCompositeSourceLayer::AllocateOutputBlobs()
 {
-	NeoPresume( outputBlobs.Size() == 1 );
+	NeoPresume( outputBlobs.Size() <= 1 );
 	NeoPresume( blob != 0 );
 
-	if( outputBlobs[0].Ptr() != blob.Ptr() ) {
+	if( !outputBlobs.IsEmpty() && outputBlobs[0].Ptr() != blob.Ptr() ) {
 		outputBlobs[0] = blob;
 	}
 }
@@ -17,19 +17,31 @@ limitations under the License.
 #pragma hdrstop
 
 #include <NeoML/Dnn/Layers/ConvLayer.h>
+#include <NeoML/Dnn/DnnQuantization.h>
+#include <NeoML/Dnn/Layers/ActivationLayers.h>
+#include <Dnn/DnnQuantizationInternal.h>
 #include <NeoMathEngine/NeoMathEngine.h>
 
 namespace NeoML {
 
 CConvLayer::CConvLayer( IMathEngine& mathEngine ) :
 	CBaseConvLayer( mathEngine, "CCnnConvLayer" ),
-	convDesc( 0 )
+	convDesc( 0 ),
+	isInt8Enabled( false ),
+	isInt8Calibration( false ),
+	int8InputMaxAbs( 0 ),
+	quantizedFilter( nullptr ),
+	isFloatFilterDropped( false ),
+	quantizedFilterSize( 0 ),
+	isReLUFused( false ),
+	fusedReLUThreshold( 0 )
 {
 }
 
 CConvLayer::~CConvLayer()
 {
 	destroyConvDesc();
+	destroyQuantizedFilter();
 }
 
 void CConvLayer::initConvDesc()
@@ -37,9 +49,20 @@ void CConvLayer::initConvDesc()
 	if( convDesc == 0 ) {
 		NeoPresume( inputBlobs[0] != nullptr || inputDiffBlobs[0] != nullptr );
 		NeoPresume( outputBlobs[0] != nullptr || outputDiffBlobs[0] != nullptr );
-		convDesc = MathEngine().InitBlobConvolution(
-			inputBlobs[0] != nullptr ? inputBlobs[0]->GetDesc() : inputDiffBlobs[0]->GetDesc(),
-			paddingHeight, paddingWidth, strideHeight, strideWidth, dilationHeight, dilationWidth, Filter()->GetDesc(),
+		const CBlobDesc& inputDesc = inputBlobs[0] != nullptr ? inputBlobs[0]->GetDesc() : inputDiffBlobs[0]->GetDesc();
+		CBlobDesc filterDesc( CT_Float );
+		if( isFloatFilterDropped ) {
+			// The same dimensions as the filter created on reshape
+			filterDesc.SetDimSize( BD_BatchWidth, filterCount );
+			filterDesc.SetDimSize( BD_Height, filterHeight );
+			filterDesc.SetDimSize( BD_Width, filterWidth );
+			filterDesc.SetDimSize( BD_Depth, inputDesc.Depth() );
+			filterDesc.SetDimSize( BD_Channels, inputDesc.Channels() );
+		} else {
+			filterDesc = Filter()->GetDesc();
+		}
+		convDesc = MathEngine().InitBlobConvolution( inputDesc,
+			paddingHeight, paddingWidth, strideHeight, strideWidth, dilationHeight, dilationWidth, filterDesc,
 			outputBlobs[0] != nullptr ? outputBlobs[0]->GetDesc() : outputDiffBlobs[0]->GetDesc() );
 	}
 }
@@ -51,6 +74,81 @@ void CConvLayer::destroyConvDesc()
 	}
 }
 
+void CConvLayer::destroyQuantizedFilter()
+{
+	if( quantizedFilter != nullptr ) {
+		delete quantizedFilter;
+		quantizedFilter = nullptr;
+	}
+}
+
+// The int8 path is used only for inference on CPU
+bool CConvLayer::isInt8InferencePossible() const
+{
+	return isInt8Enabled && MathEngine().GetType() == MET_Cpu && !IsLearningPerformed() && !IsBackwardPerformed();
+}
+
+void CConvLayer::SetInt8InferenceEnabled( bool enable )
+{
+	NeoAssert( enable || !isFloatFilterDropped );
+	isInt8Enabled = enable;
+	if( !isFloatFilterDropped ) {
+		destroyQuantizedFilter();
+	}
+}
+
+void CConvLayer::DropFloatFilter()
+{
+	NeoAssert( isInt8Enabled );
+	NeoAssert( MathEngine().GetType() == MET_Cpu );
+	if( isFloatFilterDropped ) {
+		return;
+	}
+	NeoAssert( Filter() != nullptr );
+
+	if( quantizedFilter == nullptr ) {
+		quantizedFilter = MathEngine().InitQuantizedMatrix( Filter()->GetData(), filterCount, Filter()->GetObjectSize() );
+	}
+	quantizedFilterSize = Filter()->GetObjectSize();
+	Filter() = nullptr;
+	isFloatFilterDropped = true;
+}
+
+void CConvLayer::SetInt8InputMaxAbs( float maxAbs )
+{
+	NeoAssert( maxAbs >= 0 );
+	int8InputMaxAbs = maxAbs;
+}
+
+void CConvLayer::SetFusedReLU( bool isFused, float upperThreshold )
+{
+	isReLUFused = isFused;
+	fusedReLUThreshold = upperThreshold;
+}
+
+void CConvLayer::SetFilterData( const CPtr<CDnnBlob>& newFilter )
+{
+	CBaseConvLayer::SetFilterData( newFilter );
+	// The layer is switched back to the float filter
+	isFloatFilterDropped = false;
+	onFilterChanged();
+}
+
+void CConvLayer::FilterLayerParams( float threshold )
+{
+	CBaseConvLayer::FilterLayerParams( threshold );
+	onFilterChanged();
+}
+
+// Drops the data calculated from the filter
+// Without the float filter the quantized one is the only copy and is kept
+void CConvLayer::onFilterChanged()
+{
+	if( !isFloatFilterDropped ) {
+		destroyQuantizedFilter();
+	}
+}
+
 // Calculates the output blob size from the convolution parameters
 void CConvLayer::calcOutputBlobSize(int& outputHeight, int& outputWidth) const
 {
@@ -69,6 +167,10 @@ void CConvLayer::Reshape()
 		"different number of inputs and outputs in conv layer" );
 	CheckLayerArchitecture( paddingHeight < filterHeight * dilationHeight && paddingWidth < filterWidth * dilationWidth,
 		"padding is more or equal to receptive field size" );
+	CheckLayerArchitecture( !isReLUFused || ( !IsBackwardPerformed() && !IsLearningPerformed() ),
+		"the layer with the fused ReLU may be used only for inference" );
+	CheckLayerArchitecture( !isFloatFilterDropped || ( !IsBackwardPerformed() && !IsLearningPerformed() ),
+		"the layer without the float filter may be used only for inference" );
 
 	int outputHeight, outputWidth;
 	calcOutputBlobSize(outputHeight, outputWidth);
@@ -77,7 +179,10 @@ void CConvLayer::Reshape()
 			&& filterWidth <= inputDescs[i].Width() + 2 * paddingWidth,
 			"filter is bigger than input" );
 
-		if(Filter() == 0) {
+		if( isFloatFilterDropped ) {
+			CheckLayerArchitecture( quantizedFilterSize
+				== filterHeight * filterWidth * inputDescs[i].Depth() * inputDescs[i].Channels(), "filter size mismatch" );
+		} else if(Filter() == 0) {
 			// Create a weights matrix
 			Filter() = CDnnBlob::Create3DImageBlob( MathEngine(), CT_Float, 1, filterCount, filterHeight, filterWidth,
 				inputDescs[i].Depth(), inputDescs[i].Channels() );
@@ -109,16 +214,52 @@ void CConvLayer::Reshape()
 	}
 
 	destroyConvDesc();
+	if( !isFloatFilterDropped ) {
+		destroyQuantizedFilter();
+	}
 }
 
 void CConvLayer::RunOnce()
 {
 	initConvDesc();
 
-	for( int i = 0; i < outputBlobs.Size(); ++i ) {
-		CConstFloatHandle freeTerm = FreeTerms()->GetData();
-		MathEngine().BlobConvolution( *convDesc, inputBlobs[i]->GetData(),
-			Filter()->GetData(), &freeTerm, outputBlobs[i]->GetData() );
+	if( isInt8Calibration ) {
+		for( int i = 0; i < inputBlobs.Size(); ++i ) {
+			int8InputMaxAbs = max( int8InputMaxAbs, CalcMaxAbsValue( *inputBlobs[i] ) );
+		}
+	}
+
+	// On CPU the fused ReLU is applied inside the convolution kernel
+	const bool isActivationInKernel = MathEngine().GetType() == MET_Cpu;
+	const CFusedActivation activation = isReLUFused ? CFusedActivation( AF_ReLU, fusedReLUThreshold ) : CFusedActivation();
+
+	if( isInt8InferencePossible() ) {
+		if( quantizedFilter == nullptr ) {
+			quantizedFilter = MathEngine().InitQuantizedMatrix( Filter()->GetData(), filterCount, Filter()->GetObjectSize() );
+		}
+		for( int i = 0; i < outputBlobs.Size(); ++i ) {
+			CConstFloatHandle freeTerm = FreeTerms()->GetData();
+			MathEngine().BlobQuantizedConvolution( *convDesc, inputBlobs[i]->GetData(), GetInt8Scale( int8InputMaxAbs ),
+				*quantizedFilter, &freeTerm, activation, outputBlobs[i]->GetData() );
+		}
+	} else if( isActivationInKernel ) {
+		for( int i = 0; i < outputBlobs.Size(); ++i ) {
+			CConstFloatHandle freeTerm = FreeTerms()->GetData();
+			MathEngine().BlobConvolutionWithActivation( *convDesc, inputBlobs[i]->GetData(),
+				Filter()->GetData(), &freeTerm, activation, outputBlobs[i]->GetData() );
+		}
+	} else {
+		for( int i = 0; i < outputBlobs.Size(); ++i ) {
+			CConstFloatHandle freeTerm = FreeTerms()->GetData();
+			MathEngine().BlobConvolution( *convDesc, inputBlobs[i]->GetData(),
+				Filter()->GetData(), &freeTerm, outputBlobs[i]->GetData() );
+		}
+	}
+
+	if( isReLUFused && !isActivationInKernel ) {
+		for( int i = 0; i < outputBlobs.Size(); ++i ) {
+			ApplyFusedReLU( *outputBlobs[i], fusedReLUThreshold );
+		}
 	}
 }
 
@@ -135,6 +276,8 @@ void CConvLayer::BackwardOnce()
 void CConvLayer::LearnOnce()
 {
 	initConvDesc();
+	// The filter is going to change
+	onFilterChanged();
 
 	CFloatHandle freeTermDiff = FreeTermsDiff()->GetData();
 	for(int i = 0; i < outputDiffBlobs.Size(); ++i) {
@@ -143,12 +286,39 @@ void CConvLayer::LearnOnce()
 	}
 }
 
-static const int ConvLayerVersion = 2000;
+static const int ConvLayerVersion = 2003;
 
 void CConvLayer::Serialize( CArchive& archive )
 {
-	archive.SerializeVersion( ConvLayerVersion, CDnn::ArchiveMinSupportedVersion );
+	const int version = archive.SerializeVersion( ConvLayerVersion, CDnn::ArchiveMinSupportedVersion );
 	CBaseConvLayer::Serialize( archive );
+
+	if( version >= 2001 ) {
+		archive.Serialize( isInt8Enabled );
+		archive.Serialize( int8InputMaxAbs );
+	} else if( archive.IsLoading() ) {
+		isInt8Enabled = false;
+		int8InputMaxAbs = 0;
+	}
+	if( version >= 2002 ) {
+		archive.Serialize( isReLUFused );
+		archive.Serialize( fusedReLUThreshold );
+	} else if( archive.IsLoading() ) {
+		isReLUFused = false;
+		fusedReLUThreshold = 0;
+	}
+	if( version >= 2003 ) {
+		archive.Serialize( isFloatFilterDropped );
+	} else if( archive.IsLoading() ) {
+		isFloatFilterDropped = false;
+	}
+
+	if( isFloatFilterDropped ) {
+		SerializeQuantizedMatrix( archive, MathEngine(), quantizedFilter, filterCount, quantizedFilterSize );
+	}
+	if( archive.IsLoading() ) {
+		onFilterChanged();
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <NeoML/Dnn/Dnn.h>
 #include <NeoML/Dnn/Layers/EltwiseLayer.h>
+#include <NeoML/Dnn/Layers/ActivationLayers.h>
 #include <NeoMathEngine/NeoMathEngine.h>
 
 namespace NeoML {
@@ -65,13 +66,46 @@ static void eltwiseSumRunOnce( const CObjectArray<CDnnBlob>& inputBlobs, const C
 	}
 }
 
+void CEltwiseSumLayer::SetFusedReLU( bool isFused, float upperThreshold )
+{
+	isReLUFused = isFused;
+	fusedReLUThreshold = upperThreshold;
+}
+
+void CEltwiseSumLayer::Reshape()
+{
+	CEltwiseBaseLayer::Reshape();
+	CheckLayerArchitecture( !isReLUFused || inputDescs[0].GetDataType() == CT_Float, "integer ReLU" );
+	CheckLayerArchitecture( !isReLUFused || !IsBackwardPerformed(),
+		"the layer with the fused ReLU may be used only for inference" );
+}
+
 void CEltwiseSumLayer::RunOnce()
 {
+	if( isReLUFused && MathEngine().GetType() == MET_Cpu ) {
+		// On CPU the fused ReLU is applied inside the last addition
+		CFloatHandle output = outputBlobs[0]->GetData();
+		const int dataSize = outputBlobs[0]->GetDataSize();
+		const int last = inputBlobs.Size() - 1;
+		CConstFloatHandle sum = inputBlobs[0]->GetData();
+		for( int i = 1; i < last; ++i ) {
+			MathEngine().VectorAdd( sum, inputBlobs[i]->GetData(), output, dataSize );
+			sum = output;
+		}
+		MathEngine().VectorAddWithActivation( sum, inputBlobs[last]->GetData(), output, dataSize,
+			CFusedActivation( AF_ReLU, fusedReLUThreshold ) );
+		return;
+	}
+
 	if( inputBlobs[0]->GetDataType() == CT_Float ) {
 		eltwiseSumRunOnce<float>( inputBlobs, outputBlobs );
 	} else {
 		eltwiseSumRunOnce<int>( inputBlobs, outputBlobs );
 	}
+
+	if( isReLUFused ) {
+		ApplyFusedReLU( *outputBlobs[0], fusedReLUThreshold );
+	}
 }
 
 void CEltwiseSumLayer::BackwardOnce()
@@ -87,12 +121,19 @@ void CEltwiseSumLayer::BackwardOnce()
 	}
 }
 
-static const int EltwiseSumLayerVersion = 2000;
+static const int EltwiseSumLayerVersion = 2001;
 
 void CEltwiseSumLayer::Serialize( CArchive& archive )
 {
-	archive.SerializeVersion( EltwiseSumLayerVersion, CDnn::ArchiveMinSupportedVersion );
+	const int version = archive.SerializeVersion( EltwiseSumLayerVersion, CDnn::ArchiveMinSupportedVersion );
 	CEltwiseBaseLayer::Serialize( archive );
+	if( version >= 2001 ) {
+		archive.Serialize( isReLUFused );
+		archive.Serialize( fusedReLUThreshold );
+	} else if( archive.IsLoading() ) {
+		isReLUFused = false;
+		fusedReLUThreshold = 0;
+	}
 }
 
 CLayerWrapper<CEltwiseSumLayer> Sum()
@@ -17,6 +17,9 @@ limitations under the License.
 #pragma hdrstop
 
 #include <NeoML/Dnn/Layers/FullyConnectedLayer.h>
+#include <NeoML/Dnn/DnnQuantization.h>
+#include <NeoML/Dnn/Layers/ActivationLayers.h>
+#include <Dnn/DnnQuantizationInternal.h>
 #include <NeoMathEngine/NeoMathEngine.h>
 
 namespace NeoML {
@@ -24,13 +27,75 @@ namespace NeoML {
 CFullyConnectedLayer::CFullyConnectedLayer( IMathEngine& mathEngine, const char* name ) :
 	CBaseLayer( mathEngine, name == nullptr ? "CCnnFullyConnectedLayer" : name, true ),
 	numberOfElements(0),
-	isZeroFreeTerm(false)
+	isZeroFreeTerm(false),
+	isInt8Enabled(false),
+	isInt8Calibration(false),
+	int8InputMaxAbs(0),
+	quantizedWeights(nullptr),
+	areFloatWeightsDropped(false),
+	quantizedWeightsWidth(0),
+	isReLUFused(false),
+	fusedReLUThreshold(0)
 {
 	paramBlobs.SetSize(2);
 }
 
 CFullyConnectedLayer::~CFullyConnectedLayer()
 {
+	destroyQuantizedWeights();
+}
+
+void CFullyConnectedLayer::destroyQuantizedWeights()
+{
+	if( quantizedWeights != nullptr ) {
+		delete quantizedWeights;
+		quantizedWeights = nullptr;
+	}
+}
+
+// The int8 path is used only for inference on CPU
+bool CFullyConnectedLayer::isInt8InferencePossible() const
+{
+	return isInt8Enabled && MathEngine().GetType() == MET_Cpu && !IsLearningPerformed() && !IsBackwardPerformed();
+}
+
+void CFullyConnectedLayer::SetInt8InferenceEnabled( bool enable )
+{
+	NeoAssert( enable || !areFloatWeightsDropped );
+	isInt8Enabled = enable;
+	if( !areFloatWeightsDropped ) {
+		destroyQuantizedWeights();
+	}
+}
+
+void CFullyConnectedLayer::DropFloatWeights()
+{
+	NeoAssert( isInt8Enabled );
+	NeoAssert( MathEngine().GetType() == MET_Cpu );
+	if( areFloatWeightsDropped ) {
+		return;
+	}
+	NeoAssert( Weights() != nullptr );
+
+	if( quantizedWeights == nullptr ) {
+		quantizedWeights = MathEngine().InitQuantizedMatrix( Weights()->GetData(), numberOfElements,
+			Weights()->GetObjectSize() );
+	}
+	quantizedWeightsWidth = Weights()->GetObjectSize();
+	Weights() = nullptr;
+	areFloatWeightsDropped = true;
+}
+
+void CFullyConnectedLayer::SetInt8InputMaxAbs( float maxAbs )
+{
+	NeoAssert( maxAbs >= 0 );
+	int8InputMaxAbs = maxAbs;
+}
+
+void CFullyConnectedLayer::SetFusedReLU( bool isFused, float upperThreshold )
+{
+	isReLUFused = isFused;
+	fusedReLUThreshold = upperThreshold;
 }
 
 void CFullyConnectedLayer::Reshape()
@@ -38,8 +103,14 @@ void CFullyConnectedLayer::Reshape()
 	CheckInputs();
 	CheckLayerArchitecture( GetInputCount() == GetOutputCount(),
 		"fully connected layer with different numbers of input and output" );
+	CheckLayerArchitecture( !isReLUFused || ( !IsBackwardPerformed() && !IsLearningPerformed() ),
+		"the layer with the fused ReLU may be used only for inference" );
+	CheckLayerArchitecture( !areFloatWeightsDropped || ( !IsBackwardPerformed() && !IsLearningPerformed() ),
+		"the layer without the float weights may be used only for inference" );
 	for(int i = 0; i < GetInputCount(); i++) {
-		if(Weights() == 0) {
+		if( areFloatWeightsDropped ) {
+			CheckLayerArchitecture( quantizedWeightsWidth == inputDescs[i].ObjectSize(), "weights size mismatch" );
+		} else if(Weights() == 0) {
 			// Create a weights matrix
 			CBlobDesc weightsDesc = inputDescs[i];
 			weightsDesc.SetDimSize(BD_BatchLength, 1);
@@ -71,23 +142,63 @@ void CFullyConnectedLayer::Reshape()
 		outputDescs[i].SetDimSize(BD_Depth, 1);
 		outputDescs[i].SetDimSize(BD_Channels, numberOfElements);
 	}
+
+	if( !areFloatWeightsDropped ) {
+		destroyQuantizedWeights();
+	}
 }
 
 void CFullyConnectedLayer::RunOnce()
 {
-	for( int i = 0; i < GetInputCount(); i++ ) {
-		CConstFloatHandle inputData = inputBlobs[i]->GetData();
-		CFloatHandle outputData = outputBlobs[i]->GetData();
-		CConstFloatHandle weightData = Weights()->GetData();
+	if( isInt8Calibration ) {
+		for( int i = 0; i < GetInputCount(); i++ ) {
+			int8InputMaxAbs = max( int8InputMaxAbs, CalcMaxAbsValue( *inputBlobs[i] ) );
+		}
+	}
 
-		MathEngine().MultiplyMatrixByTransposedMatrix(inputData, inputBlobs[i]->GetObjectCount(),
-			inputBlobs[i]->GetObjectSize(), inputBlobs[i]->GetObjectSize(),
-			weightData, numberOfElements, Weights()->GetObjectSize(),
-			outputData, outputBlobs[i]->GetObjectSize(), outputBlobs[i]->GetObjectSize() * inputBlobs[i]->GetObjectCount());
+	// On CPU the free term and the fused ReLU are applied inside the multiplication kernel
+	const bool isActivationInKernel = MathEngine().GetType() == MET_Cpu;
+	const CFusedActivation activation = isReLUFused ? CFusedActivation( AF_ReLU, fusedReLUThreshold ) : CFusedActivation();
 
-		if( !isZeroFreeTerm ) {
-			MathEngine().AddVectorToMatrixRows(1, outputData, outputData, inputBlobs[i]->GetObjectCount(),
-				outputBlobs[i]->GetObjectSize(), FreeTerms()->GetData());
+	if( isInt8InferencePossible() ) {
+		if( quantizedWeights == nullptr ) {
+			quantizedWeights = MathEngine().InitQuantizedMatrix( Weights()->GetData(), numberOfElements,
+				Weights()->GetObjectSize() );
+		}
+		CConstFloatHandle freeTermData = FreeTerms()->GetData();
+		for( int i = 0; i < GetInputCount(); i++ ) {
+			MathEngine().MultiplyMatrixByTransposedQuantizedMatrix( inputBlobs[i]->GetData(), inputBlobs[i]->GetObjectCount(),
+				inputBlobs[i]->GetObjectSize(), GetInt8Scale( int8InputMaxAbs ), *quantizedWeights,
+				isZeroFreeTerm ? nullptr : &freeTermData, activation, outputBlobs[i]->GetData() );
+		}
+	} else if( isActivationInKernel ) {
+		CConstFloatHandle freeTermData = FreeTerms()->GetData();
+		for( int i = 0; i < GetInputCount(); i++ ) {
+			MathEngine().MultiplyMatrixByTransposedMatrixWithActivation( inputBlobs[i]->GetData(),
+				inputBlobs[i]->GetObjectCount(), inputBlobs[i]->GetObjectSize(), Weights()->GetData(), numberOfElements,
+				isZeroFreeTerm ? nullptr : &freeTermData, activation, outputBlobs[i]->GetData() );
+		}
+	} else {
+		for( int i = 0; i < GetInputCount(); i++ ) {
+			CConstFloatHandle inputData = inputBlobs[i]->GetData();
+			CFloatHandle outputData = outputBlobs[i]->GetData();
+			CConstFloatHandle weightData = Weights()->GetData();
+
+			MathEngine().MultiplyMatrixByTransposedMatrix(inputData, inputBlobs[i]->GetObjectCount(),
+				inputBlobs[i]->GetObjectSize(), inputBlobs[i]->GetObjectSize(),
+				weightData, numberOfElements, Weights()->GetObjectSize(),
+				outputData, outputBlobs[i]->GetObjectSize(), outputBlobs[i]->GetObjectSize() * inputBlobs[i]->GetObjectCount());
+
+			if( !isZeroFreeTerm ) {
+				MathEngine().AddVectorToMatrixRows(1, outputData, outputData, inputBlobs[i]->GetObjectCount(),
+					outputBlobs[i]->GetObjectSize(), FreeTerms()->GetData());
+			}
+		}
+	}
+
+	if( isReLUFused && !isActivationInKernel ) {
+		for( int i = 0; i < outputBlobs.Size(); i++ ) {
+			ApplyFusedReLU( *outputBlobs[i], fusedReLUThreshold );
 		}
 	}
 }
@@ -103,6 +214,9 @@ void CFullyConnectedLayer::BackwardOnce()
 
 void CFullyConnectedLayer::LearnOnce()
 {
+	// The weights are going to change
+	destroyQuantizedWeights();
+
 	for( int out = 0; out < outputDiffBlobs.Size(); out++ ) {
 		MathEngine().MultiplyTransposedMatrixByMatrixAndAdd(outputDiffBlobs[out]->GetData(),
 			outputDiffBlobs[out]->GetObjectCount(), numberOfElements, numberOfElements,
@@ -118,6 +232,9 @@ void CFullyConnectedLayer::LearnOnce()
 
 void CFullyConnectedLayer::FilterLayerParams( float threshold )
 {
+	if( !areFloatWeightsDropped ) {
+		destroyQuantizedWeights();
+	}
 	for( int blobIndex = 0; blobIndex < paramBlobs.Size(); ++blobIndex ) {
 		if( paramBlobs[blobIndex] != 0 ) {
 			MathEngine().FilterSmallValues( paramBlobs[blobIndex]->GetData(),
@@ -157,6 +274,9 @@ void CFullyConnectedLayer::SetWeightsData(const CDnnBlob* newWeights)
 	if(Weights() != 0) {
 		numberOfElements = Weights()->GetObjectCount();
 	}
+	// The layer is switched back to the float weights
+	areFloatWeightsDropped = false;
+	destroyQuantizedWeights();
 }
 
 CPtr<CDnnBlob> CFullyConnectedLayer::GetFreeTermData() const
@@ -206,6 +326,7 @@ void CFullyConnectedLayer::ApplyBatchNormalization(CBatchNormalizationLayer& bat
 	CFloatHandle weightData = Weights()->GetData();
 	CFloatHandle freeTermData = FreeTerms()->GetData();
 	int wieghtCount = Weights()->GetObjectSize();
+	destroyQuantizedWeights();
 	MathEngine().VectorEltwiseMultiply(freeTermData, gamma, freeTermData, numberOfElements);
 	MathEngine().VectorAdd(freeTermData, beta, freeTermData, numberOfElements);
 	for(int i = 0; i < numberOfElements; ++i) {
@@ -214,16 +335,40 @@ void CFullyConnectedLayer::ApplyBatchNormalization(CBatchNormalizationLayer& bat
 	}
 }
 
-static const int FullyConnectedLayerVersion = 2000;
+static const int FullyConnectedLayerVersion = 2003;
 
 void CFullyConnectedLayer::Serialize( CArchive& archive )
 {
-	archive.SerializeVersion( FullyConnectedLayerVersion, CDnn::ArchiveMinSupportedVersion );
+	const int version = archive.SerializeVersion( FullyConnectedLayerVersion, CDnn::ArchiveMinSupportedVersion );
 	CBaseLayer::Serialize( archive );
 
 	archive.Serialize( numberOfElements );
 	archive.Serialize( isZeroFreeTerm );
+	if( version >= 2001 ) {
+		archive.Serialize( isInt8Enabled );
+		archive.Serialize( int8InputMaxAbs );
+	} else if( archive.IsLoading() ) {
+		isInt8Enabled = false;
+		int8InputMaxAbs = 0;
+	}
+	if( version >= 2002 ) {
+		archive.Serialize( isReLUFused );
+		archive.Serialize( fusedReLUThreshold );
+	} else if( archive.IsLoading() ) {
+		isReLUFused = false;
+		fusedReLUThreshold = 0;
+	}
+	if( version >= 2003 ) {
+		archive.Serialize( areFloatWeightsDropped );
+	} else if( archive.IsLoading() ) {
+		areFloatWeightsDropped = false;
+	}
 
+	if( areFloatWeightsDropped ) {
+		SerializeQuantizedMatrix( archive, MathEngine(), quantizedWeights, numberOfElements, quantizedWeightsWidth );
+	} else if( archive.IsLoading() ) {
+		destroyQuantizedWeights();
+	}
 	if( archive.IsLoading() ) {
 		// Converts the free terms blob into a new tensor with the length in the first dimension not Channels
 		CDnnBlob* freeTerms = FreeTerms();
@@ -113,7 +113,7 @@ void CGruLayer::buildLayer()
 	mainBackLink->Connect(*newState);
 
 	// The initial state
-	SetInputMapping( 1, *mainBackLink, 1 );
+	SetInputMapping( GetFirstStateInput(), *mainBackLink, 1 );
 
 	// The output
 	SetOutputMapping(*newState);
@@ -127,6 +127,141 @@ void CGruLayer::SetHiddenSize(int size)
 	mainBackLink->SetDimSize(BD_Channels, size);
 }
 
+void CGruLayer::RunOnce()
+{
+	if( IsWholeSequenceRunAvailable()
+		&& inputBlobs[0]->GetListSize() == 1
+		&& !gateLayer->IsInt8InferenceEnabled()
+		&& !mainLayer->IsInt8InferenceEnabled() )
+	{
+		runWholeSequence();
+	} else {
+		CRecurrentLayer::RunOnce();
+	}
+}
+
+// Multiplies the objects by the part of the fully connected layer weights starting from the given column
+static void multiplyByWeightsPart( IMathEngine& mathEngine, const CConstFloatHandle& objects, int objectCount,
+	int objectSize, CFullyConnectedLayer& layer, int firstColumn, bool addFreeTerm, const CFloatHandle& result )
+{
+	CDnnBlob& weights = *layer.Weights();
+	const int resultWidth = weights.GetObjectCount();
+	mathEngine.MultiplyMatrixByTransposedMatrix( objects, objectCount, objectSize, objectSize,
+		weights.GetData() + firstColumn, resultWidth, weights.GetObjectSize(),
+		result, resultWidth, objectCount * resultWidth );
+	if( addFreeTerm && !layer.IsZeroFreeTerm() && layer.FreeTerms() != nullptr ) {
+		mathEngine.AddVectorToMatrixRows( 1, result, result, objectCount, resultWidth, layer.FreeTerms()->GetData() );
+	}
+}
+
+// Calculates the whole sequence without the internal network
+// The input parts of the fully connected layers don't depend on the recurrence,
+// so they are applied to the whole sequence at once
+void CGruLayer::runWholeSequence()
+{
+	const int sequenceLength = inputBlobs[0]->GetBatchLength();
+	const int batchWidth = inputBlobs[0]->GetBatchWidth();
+	const int inputSize = inputBlobs[0]->GetObjectSize();
+	const int hiddenSize = GetHiddenSize();
+	const int stepSize = batchWidth * hiddenSize;
+	CArray<int> activeBatchWidths;
+	GetActiveBatchWidths( activeBatchWidths );
+
+	if( IsPackedSequence() ) {
+		outputBlobs[0]->Clear();
+	}
+
+	// Only the rows of the active sequences are projected
+	CArray<int> firstRows;
+	CArray<int> rowCounts;
+	GetActiveRowBlocks( activeBatchWidths, batchWidth, firstRows, rowCounts );
+	if( firstRows.IsEmpty() ) {
+		return;
+	}
+	const int usedLength = ( firstRows.Last() + rowCounts.Last() + batchWidth - 1 ) / batchWidth;
+	CFloatHandleStackVar gateInput( MathEngine(), usedLength * G_Count * stepSize );
+	CFloatHandleStackVar mainInput( MathEngine(), usedLength * stepSize );
+	for( int i = 0; i < firstRows.Size(); i++ ) {
+		const CConstFloatHandle blockInput = inputBlobs[0]->GetData() + firstRows[i] * inputSize;
+		multiplyByWeightsPart( MathEngine(), blockInput, rowCounts[i], inputSize, *gateLayer, 0, true,
+			gateInput.GetHandle() + firstRows[i] * G_Count * hiddenSize );
+		multiplyByWeightsPart( MathEngine(), blockInput, rowCounts[i], inputSize, *mainLayer, 0, true,
+			mainInput.GetHandle() + firstRows[i] * hiddenSize );
+	}
+
+	// The state of the previous step of each sequence, starting from the initial one
+	CFloatHandleStackVar prevState( MathEngine(), stepSize );
+	const int stateInput = GetFirstStateInput();
+	if( inputBlobs.Size() > stateInput && inputBlobs[stateInput] != nullptr ) {
+		MathEngine().VectorCopy( prevState.GetHandle(), inputBlobs[stateInput]->GetData(), stepSize );
+	} else {
+		MathEngine().VectorFill( prevState.GetHandle(), 0, stepSize );
+	}
+
+	CFloatHandleStackVar gates( MathEngine(), G_Count * stepSize );
+	CFloatHandleStackVar update( MathEngine(), stepSize );
+	CFloatHandleStackVar reset( MathEngine(), stepSize );
+	CFloatHandleStackVar main( MathEngine(), stepSize );
+
+	CFloatHandle gateData[G_Count];
+	gateData[G_Update] = update.GetHandle();
+	gateData[G_Reset] = reset.GetHandle();
+
+	// Only the first activeCount sequences are calculated on each step
+	// The previous step is read from the output unless some sequences start later and need their initial state
+	const bool copyPrevious = IsPreviousStepCopyNeeded();
+	CConstFloatHandle prev = prevState.GetHandle();
+	const CFloatHandle output = outputBlobs[0]->GetData();
+	for( int i = 0; i < sequenceLength; i++ ) {
+		const int pos = IsReverseSequence() ? sequenceLength - 1 - i : i;
+		const int activeCount = activeBatchWidths[pos];
+		if( activeCount == 0 ) {
+			continue;
+		}
+		const int activeSize = activeCount * hiddenSize;
+		const CFloatHandle state = output + pos * stepSize;
+
+		CBlobDesc gatesDesc( CT_Float );
+		gatesDesc.SetDimSize( BD_BatchWidth, activeCount );
+		gatesDesc.SetDimSize( BD_Channels, G_Count * hiddenSize );
+		CBlobDesc gateDescs[G_Count];
+		for( int j = 0; j < G_Count; j++ ) {
+			gateDescs[j] = gatesDesc;
+			gateDescs[j].SetDimSize( BD_Channels, hiddenSize );
+		}
+
+		multiplyByWeightsPart( MathEngine(), prev, activeCount, hiddenSize, *gateLayer, inputSize, false,
+			gates.GetHandle() );
+		MathEngine().VectorAdd( gates.GetHandle(), gateInput.GetHandle() + pos * G_Count * stepSize,
+			gates.GetHandle(), G_Count * activeSize );
+		MathEngine().VectorSigmoid( gates.GetHandle(), gates.GetHandle(), G_Count * activeSize );
+		MathEngine().BlobSplitByDim( BD_Channels, gatesDesc, gates.GetHandle(), gateDescs, gateData, G_Count );
+
+		MathEngine().VectorEltwiseMultiply( reset.GetHandle(), prev, reset.GetHandle(), activeSize );
+		multiplyByWeightsPart( MathEngine(), reset.GetHandle(), activeCount, hiddenSize, *mainLayer, inputSize, false,
+			main.GetHandle() );
+		MathEngine().VectorAdd( main.GetHandle(), mainInput.GetHandle() + pos * stepSize, main.GetHandle(), activeSize );
+		MathEngine().VectorTanh( main.GetHandle(), main.GetHandle(), activeSize );
+
+		// state = ( 1 - update ) * main + update * prevState
+		MathEngine().VectorSub( 1.f, update.GetHandle(), state, activeSize );
+		MathEngine().VectorEltwiseMultiply( state, main.GetHandle(), state, activeSize );
+		MathEngine().VectorEltwiseMultiplyAdd( update.GetHandle(), prev, state, activeSize );
+		if( copyPrevious ) {
+			MathEngine().VectorCopy( prevState.GetHandle(), state, activeSize );
+		} else {
+			prev = state;
+		}
+	}
+}
+
+void CGruLayer::SetPackedSequence( bool isPacked )
+{
+	CRecurrentLayer::SetPackedSequence( isPacked );
+	// The initial state input follows the sequence lengths
+	SetInputMapping( GetFirstStateInput(), *mainBackLink, 1 );
+}
+
 static const int GruLayerVersion = 2000;
 
 void CGruLayer::Serialize( CArchive& archive )
@@ -85,6 +85,101 @@ void CIrnnLayer::Reshape()
 	}
 }
 
+void CIrnnLayer::RunOnce()
+{
+	if( IsWholeSequenceRunAvailable()
+		&& inputBlobs[0]->GetListSize() == 1
+		&& !inputFc->IsInt8InferenceEnabled()
+		&& !recurFc->IsInt8InferenceEnabled() )
+	{
+		runWholeSequence();
+	} else {
+		CRecurrentLayer::RunOnce();
+	}
+}
+
+// Applies the fully connected layer to the objects
+static void fullyConnectedRunOnce( IMathEngine& mathEngine, const CConstFloatHandle& objects, int objectCount,
+	int objectSize, CFullyConnectedLayer& layer, const CFloatHandle& result )
+{
+	CDnnBlob& weights = *layer.Weights();
+	const int resultWidth = weights.GetObjectCount();
+	mathEngine.MultiplyMatrixByTransposedMatrix( objects, objectCount, objectSize, objectSize,
+		weights.GetData(), resultWidth, objectSize, result, resultWidth, objectCount * resultWidth );
+	if( !layer.IsZeroFreeTerm() && layer.FreeTerms() != nullptr ) {
+		mathEngine.AddVectorToMatrixRows( 1, result, result, objectCount, resultWidth, layer.FreeTerms()->GetData() );
+	}
+}
+
+// Calculates the whole sequence without the internal network
+// FC_input doesn't depend on the recurrence, so it is applied to the whole sequence at once
+void CIrnnLayer::runWholeSequence()
+{
+	const int sequenceLength = inputBlobs[0]->GetBatchLength();
+	const int batchWidth = inputBlobs[0]->GetBatchWidth();
+	const int hiddenSize = GetHiddenSize();
+	const int stepSize = batchWidth * hiddenSize;
+	CArray<int> activeBatchWidths;
+	GetActiveBatchWidths( activeBatchWidths );
+
+	if( IsPackedSequence() ) {
+		// The rows of the finished sequences stay zero
+		outputBlobs[0]->Clear();
+	}
+
+	// The output is used to store the FC_input result
+	// Only the rows of the active sequences are projected
+	const CFloatHandle output = outputBlobs[0]->GetData();
+	const int inputSize = inputBlobs[0]->GetObjectSize();
+	CArray<int> firstRows;
+	CArray<int> rowCounts;
+	GetActiveRowBlocks( activeBatchWidths, batchWidth, firstRows, rowCounts );
+	for( int i = 0; i < firstRows.Size(); i++ ) {
+		fullyConnectedRunOnce( MathEngine(), inputBlobs[0]->GetData() + firstRows[i] * inputSize, rowCounts[i],
+			inputSize, *inputFc, output + firstRows[i] * hiddenSize );
+	}
+
+	// Y_t-1 of each sequence, Y_-1 is zero
+	CFloatHandleStackVar prevState( MathEngine(), stepSize );
+	MathEngine().VectorFill( prevState.GetHandle(), 0, stepSize );
+	CFloatHandleStackVar recurResult( MathEngine(), stepSize );
+	CFloatHandleStackVar reluThreshold( MathEngine() );
+	reluThreshold.SetValue( 0.f );
+
+	// Only the first activeCount sequences are calculated on each step
+	// The previous step is read from the output unless some sequences start later and need their initial state
+	const bool copyPrevious = IsPreviousStepCopyNeeded();
+	CConstFloatHandle prev = prevState.GetHandle();
+	bool isFirstStep = true;
+	for( int i = 0; i < sequenceLength; i++ ) {
+		const int pos = IsReverseSequence() ? sequenceLength - 1 - i : i;
+		const int activeCount = activeBatchWidths[pos];
+		if( activeCount == 0 ) {
+			continue;
+		}
+		const int activeSize = activeCount * hiddenSize;
+		const CFloatHandle state = output + pos * stepSize;
+		if( isFirstStep ) {
+			// Y_-1 is zero, so FC_recur result is its free term
+			MathEngine().VectorFill( recurResult.GetHandle(), 0, activeSize );
+			if( !recurFc->IsZeroFreeTerm() && recurFc->FreeTerms() != nullptr ) {
+				MathEngine().AddVectorToMatrixRows( 1, recurResult.GetHandle(), recurResult.GetHandle(), activeCount,
+					hiddenSize, recurFc->FreeTerms()->GetData() );
+			}
+			isFirstStep = false;
+		} else {
+			fullyConnectedRunOnce( MathEngine(), prev, activeCount, hiddenSize, *recurFc, recurResult.GetHandle() );
+		}
+		MathEngine().VectorAdd( state, recurResult.GetHandle(), state, activeSize );
+		MathEngine().VectorReLU( state, state, activeSize, reluThreshold );
+		if( copyPrevious ) {
+			MathEngine().VectorCopy( prevState.GetHandle(), state, activeSize );
+		} else {
+			prev = state;
+		}
+	}
+}
+
 // Creates and connects layers in internal dnn
 void CIrnnLayer::buildLayer()
 {
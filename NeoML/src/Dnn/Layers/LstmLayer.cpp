@@ -175,10 +175,10 @@ void CLstmLayer::buildLayer(float dropout)
 	stateBackLink->Connect(*newState);
 
 	// Initial state
-	SetInputMapping( 1, *stateBackLink, 1 );
+	SetInputMapping( GetFirstStateInput(), *stateBackLink, 1 );
 
 	// Initial history
-	SetInputMapping( 2, *mainBackLink, 1 );
+	SetInputMapping( GetFirstStateInput() + 1, *mainBackLink, 1 );
 
 	// The output
 	if( isInCompatibilityMode ) {
@@ -202,6 +202,14 @@ void CLstmLayer::SetDropoutRate(float newDropoutRate)
 	}
 }
 
+void CLstmLayer::SetPackedSequence( bool isPacked )
+{
+	CRecurrentLayer::SetPackedSequence( isPacked );
+	// The initial state inputs follow the sequence lengths
+	SetInputMapping( GetFirstStateInput(), *stateBackLink, 1 );
+	SetInputMapping( GetFirstStateInput() + 1, *mainBackLink, 1 );
+}
+
 void CLstmLayer::SetHiddenSize(int size)
 {
 	inputHiddenLayer->SetNumberOfElements(size * G_Count);
@@ -314,11 +322,11 @@ void CLstmLayer::Serialize( CArchive& archive )
 }
 
 void CLstmLayer::RunOnce() {
-	if( MathEngine().GetType() == MET_Cpu && 
+	if( IsWholeSequenceRunAvailable() &&
 		!isInCompatibilityMode &&
-		!IsBackwardPerformed() &&
-		!IsLearningPerformed() &&
-		recurrentActivation == AF_Sigmoid )
+		recurrentActivation == AF_Sigmoid &&
+		!inputHiddenLayer->IsInt8InferenceEnabled() &&
+		!recurHiddenLayer->IsInt8InferenceEnabled() )
 	{
 		fastLstm();
 	} else {
@@ -337,7 +345,11 @@ void CLstmLayer::Reshape() {
 // Checks layer input and output descs
 void CLstmLayer::checkBlobDescs() const
 {
-	CheckLayerArchitecture( inputDescs.Size() >= 1 && inputDescs.Size() <= 3, "LSTM must have 1 to 3 inputs" );
+	// The sequence lengths input of the packed sequences is checked by CRecurrentLayer
+	const int stateInput = GetFirstStateInput();
+	const int mainInput = stateInput + 1;
+	CheckLayerArchitecture( inputDescs.Size() >= stateInput && inputDescs.Size() <= mainInput + 1,
+		"LSTM must have 1 to 3 inputs (and the sequence lengths if the sequences are packed)" );
 	CheckLayerArchitecture( outputDescs.Size() == 1 || outputDescs.Size() == 2, "LSTM must have 1 or 2 outputs" );
 
 	const int batchSize = inputDescs[0].BatchWidth();
@@ -346,23 +358,23 @@ void CLstmLayer::checkBlobDescs() const
 	CheckLayerArchitecture( inputDescs[0].GetDataType() == CT_Float, "LSTM's data input must be CT_Float" );
 	CheckLayerArchitecture( inputDescs[0].ListSize() == 1, "LSTM's data input's BD_ListSize must be 1" );
 
-	if( inputDescs.Size() > 1 ) {
-		CheckLayerArchitecture( inputDescs[1].GetDataType() == CT_Float, "LSTM's initial state must be CT_Float" );
-		CheckLayerArchitecture( inputDescs[1].BatchLength() == 1, "LSTM's initial state's BD_BatchLength must be 1" );
-		CheckLayerArchitecture( inputDescs[1].BatchWidth() == batchSize,
+	if( inputDescs.Size() > stateInput ) {
+		CheckLayerArchitecture( inputDescs[stateInput].GetDataType() == CT_Float, "LSTM's initial state must be CT_Float" );
+		CheckLayerArchitecture( inputDescs[stateInput].BatchLength() == 1, "LSTM's initial state's BD_BatchLength must be 1" );
+		CheckLayerArchitecture( inputDescs[stateInput].BatchWidth() == batchSize,
 			"LSTM's initial state's BD_BatchWidth must be equal to the BD_BatchWidth of the data input" );
-		CheckLayerArchitecture( inputDescs[1].ListSize() == 1, "LSTM's initial state's BD_ListSize must be 1" );
-		CheckLayerArchitecture( inputDescs[1].ObjectSize() == hiddenSize,
+		CheckLayerArchitecture( inputDescs[stateInput].ListSize() == 1, "LSTM's initial state's BD_ListSize must be 1" );
+		CheckLayerArchitecture( inputDescs[stateInput].ObjectSize() == hiddenSize,
 			"LSTM's initial state's object size must be equal to the hidden size" );
 	}
 
-	if( inputDescs.Size() > 2 ) {
-		CheckLayerArchitecture( inputDescs[2].GetDataType() == CT_Float, "LSTM's initial story must be CT_Float" );
-		CheckLayerArchitecture( inputDescs[2].BatchLength() == 1, "LSTM's initial story's BD_BatchLength must be 1" );
-		CheckLayerArchitecture( inputDescs[2].BatchWidth() == batchSize,
+	if( inputDescs.Size() > mainInput ) {
+		CheckLayerArchitecture( inputDescs[mainInput].GetDataType() == CT_Float, "LSTM's initial story must be CT_Float" );
+		CheckLayerArchitecture( inputDescs[mainInput].BatchLength() == 1, "LSTM's initial story's BD_BatchLength must be 1" );
+		CheckLayerArchitecture( inputDescs[mainInput].BatchWidth() == batchSize,
 			"LSTM's initial story's BD_BatchWidth must be equal to the BD_BatchWidth of the data input" );
-		CheckLayerArchitecture( inputDescs[2].ListSize() == 1, "LSTM's initial story's BD_ListSize must be 1" );
-		CheckLayerArchitecture( inputDescs[2].ObjectSize() == hiddenSize,
+		CheckLayerArchitecture( inputDescs[mainInput].ListSize() == 1, "LSTM's initial story's BD_ListSize must be 1" );
+		CheckLayerArchitecture( inputDescs[mainInput].ObjectSize() == hiddenSize,
 			"LSTM's initial story's object size must be equal to the hidden size" );
 	}
 }
@@ -431,69 +443,100 @@ void CLstmLayer::fastLstm()
 	const CPtr<CDnnBlob>& recurrentWeights = recurHiddenLayer->Weights();
 	const CPtr<CDnnBlob>& recurrentFreeTerm = recurHiddenLayer->FreeTerms();
 
-	// Emulate working of LSTM recurrent implementation
-	CPtr<CDnnBlob>& mainBacklink = outputBlobs[0];
-	CPtr<CDnnBlob>& stateBacklink = outputDescs.Size() == 2 ? outputBlobs[1] : fastLstmDesc.StateBacklinkBlob();
+	const int sequenceLength = inputBlobs[0]->GetBatchLength();
+	const int batchWidth = inputBlobs[0]->GetBatchWidth();
+	const int stepSize = batchWidth * GetHiddenSize();
+	CArray<int> activeBatchWidths;
+	GetActiveBatchWidths( activeBatchWidths );
+
+	// The state and the output of the previous step of each sequence, starting from the initial ones
+	CFloatHandleStackVar prevState( MathEngine(), stepSize );
+	CFloatHandleStackVar prevMain( MathEngine(), stepSize );
+	initRecurentBlob( prevState.GetHandle(), GetFirstStateInput() );
+	initRecurentBlob( prevMain.GetHandle(), GetFirstStateInput() + 1 );
+	if( IsPackedSequence() ) {
+		// The positions after the ends of the sequences are not calculated
+		for( int i = 0; i < outputBlobs.Size(); i++ ) {
+			outputBlobs[i]->Clear();
+		}
+	}
 
-	CPtr<CDnnBlob> mainBacklinkInput = CDnnBlob::CreateWindowBlob( mainBacklink );
-	CPtr<CDnnBlob> mainBacklinkOutput = CDnnBlob::CreateWindowBlob( mainBacklink );
-	CPtr<CDnnBlob> input = CDnnBlob::CreateWindowBlob( inputBlobs[0] );
-	CPtr<CDnnBlob> stateBacklinkInput = CDnnBlob::CreateWindowBlob( stateBacklink );
-	CPtr<CDnnBlob> stateBacklinkOutput = CDnnBlob::CreateWindowBlob( stateBacklink );
+	// The input fully connected layer doesn't depend on the recurrence, so it's applied to the whole sequence at once
+	// Only the recurrent fully connected layer and the gates are calculated step by step
+	// Only the rows of the active sequences are projected
+	CPtr<CDnnBlob>& inputSequenceResult = fastLstmDesc.InputSequenceFullyConnectedResult();
+	const int objectSize = inputBlobs[0]->GetObjectSize();
+	const int resultWidth = inputSequenceResult->GetObjectSize();
+	CArray<int> firstRows;
+	CArray<int> rowCounts;
+	GetActiveRowBlocks( activeBatchWidths, batchWidth, firstRows, rowCounts );
+	for( int i = 0; i < firstRows.Size(); i++ ) {
+		const CFloatHandle blockResult = inputSequenceResult->GetData() + firstRows[i] * resultWidth;
+		MathEngine().MultiplyMatrixByTransposedMatrix( inputBlobs[0]->GetData() + firstRows[i] * objectSize,
+			rowCounts[i], objectSize, objectSize, inputWeights->GetData(), resultWidth, objectSize,
+			blockResult, resultWidth, rowCounts[i] * resultWidth );
+		if( inputFreeTerm != nullptr && !inputHiddenLayer->IsZeroFreeTerm() ) {
+			MathEngine().AddVectorToMatrixRows( 1, blockResult, blockResult, rowCounts[i], resultWidth,
+				inputFreeTerm->GetData() );
+		}
+	}
 
-	// Init state and main backlink blobs
-	initRecurentBlob( stateBacklink, 1 );
-	initRecurentBlob( mainBacklink, 2 );
+	CConstFloatHandle recurrentFreeTermHandle;
+	if( recurrentFreeTerm.Ptr() && !recurHiddenLayer->IsZeroFreeTerm() ) {
+		recurrentFreeTermHandle = recurrentFreeTerm->GetData();
+	}
 
 	// Iterate recurent net step by step
-	for( int i = 0; i < inputBlobs[0]->GetBatchLength(); i++ ) {
-		int inputPos, outputPos;
-		if( IsReverseSequence() ) {
-			const int LastIdx = inputBlobs[0]->GetBatchLength() - 1;
-			int iRev = LastIdx - i;
-			inputPos = min( LastIdx, iRev + 1 );
-			outputPos = iRev;
-		} else {
-			inputPos = max( 0, i - 1 );
-			outputPos = i;
+	// Only the first activeCount sequences are calculated on each step
+	// The previous step is read from the outputs unless some sequences start later and need their initial state
+	const bool copyPrevious = IsPreviousStepCopyNeeded();
+	CConstFloatHandle prevStateHandle = prevState.GetHandle();
+	CConstFloatHandle prevMainHandle = prevMain.GetHandle();
+	int descObjectCount = batchWidth;
+	for( int i = 0; i < sequenceLength; i++ ) {
+		const int pos = IsReverseSequence() ? sequenceLength - 1 - i : i;
+		const int activeCount = activeBatchWidths[pos];
+		if( activeCount == 0 ) {
+			continue;
 		}
-		// Set current step
-		mainBacklinkInput->SetParentPos( inputPos );
-		input->SetParentPos( outputPos );
-
-		if( outputDescs.Size() == 2 ) {
-			// if ( outputDescs.Size() == 1 ) we could preserve only one step of state ( and we do it )
-			stateBacklinkInput->SetParentPos( inputPos );
-			stateBacklinkOutput->SetParentPos( outputPos );
+		if( activeCount != descObjectCount ) {
+			fastLstmDesc.SetObjectCount( this, activeCount );
+			descObjectCount = activeCount;
 		}
-		mainBacklinkOutput->SetParentPos( outputPos );
 
-		CConstFloatHandle inputFreeTermHandle;
-		CConstFloatHandle recurrentFreeTermHandle;
-		if( inputFreeTerm.Ptr() ) {
-			inputFreeTermHandle = inputFreeTerm->GetData();
-		}
-		if( recurrentFreeTerm.Ptr() ) {
-			recurrentFreeTermHandle = recurrentFreeTerm->GetData();
+		const CFloatHandle main = outputBlobs[0]->GetData() + pos * stepSize;
+		// If there is no state output only the last state is kept
+		const CFloatHandle state = outputBlobs.Size() == 2 ? outputBlobs[1]->GetData() + pos * stepSize
+			: prevState.GetHandle();
+		MathEngine().LstmRecurrentStep( fastLstmDesc.LstmDesc(), inputSequenceResult->GetData() + pos * batchWidth * resultWidth,
+			recurrentWeights->GetData(), recurrentFreeTermHandle, prevStateHandle, prevMainHandle,
+			state, main );
+
+		if( copyPrevious ) {
+			const int activeSize = activeCount * GetHiddenSize();
+			MathEngine().VectorCopy( prevMain.GetHandle(), main, activeSize );
+			if( outputBlobs.Size() == 2 ) {
+				MathEngine().VectorCopy( prevState.GetHandle(), state, activeSize );
+			}
+		} else {
+			prevMainHandle = main;
+			prevStateHandle = state;
 		}
-
-		MathEngine().Lstm( fastLstmDesc.LstmDesc(), 
-			inputWeights->GetData(), inputFreeTermHandle,
-			recurrentWeights->GetData(), recurrentFreeTermHandle,
-			stateBacklinkInput->GetData(), mainBacklinkInput->GetData(),
-			input->GetData(), stateBacklinkOutput->GetData(), mainBacklinkOutput->GetData() );
+	}
+	if( descObjectCount != batchWidth ) {
+		fastLstmDesc.SetObjectCount( this, batchWidth );
 	}
 }
 
-void CLstmLayer::initRecurentBlob( CPtr<CDnnBlob>& backlinkBlob, int num )
+// Fills the initial state or output by the corresponding input (or zeros if it's not connected)
+void CLstmLayer::initRecurentBlob( const CFloatHandle& backlink, int num )
 {
+	const int stepSize = inputBlobs[0]->GetBatchWidth() * GetHiddenSize();
 	if( inputBlobs.Size() > num && inputBlobs[num] != nullptr ) {
-		CPtr<CDnnBlob> windowBlob = CDnnBlob::CreateWindowBlob( backlinkBlob );
-		windowBlob->SetParentPos( IsReverseSequence() ? backlinkBlob->GetBatchLength() - 1 : 0 );
-		NeoAssert( windowBlob->GetDataSize() == inputBlobs[num]->GetDataSize() );
-		MathEngine().VectorCopy( windowBlob->GetData(), inputBlobs[num]->GetData(), windowBlob->GetDataSize() );
+		NeoAssert( inputBlobs[num]->GetDataSize() == stepSize );
+		MathEngine().VectorCopy( backlink, inputBlobs[num]->GetData(), stepSize );
 	} else {
-		backlinkBlob->Clear();
+		MathEngine().VectorFill( backlink, 0, stepSize );
 	}
 }
 
@@ -506,15 +549,6 @@ void CLstmLayer::CFastLstmDesc::Init( CLstmLayer* lstmLayer ) {
 
 	const int hiddenSize = lstmLayer->GetHiddenSize();
 
-	// Write state data directly to output or create temporary blob for recurent 
-	auto& sbl = stateBacklinkBlob;
-	auto& outDesc0 = lstmLayer->outputDescs[0];
-	if( lstmLayer->outputDescs.Size() != 2 &&
-		( sbl.Ptr() == nullptr || sbl->GetBatchWidth() != outDesc0.BatchWidth() || sbl->GetObjectSize() != outDesc0.ObjectSize() ) ) {
-		stateBacklinkBlob = CDnnBlob::CreateDataBlob( lstmLayer->MathEngine(), CT_Float, 1, 
-			lstmLayer->outputDescs[0].BatchWidth(), lstmLayer->outputDescs[0].ObjectSize() );
-	}
-
 	// Create temporary blobs for result of fully connected layers
 	// inputFullyConnectedResult and reccurentFullyConnectedResult always equal to zero or not simultaneously
 	auto& ifcl = inputFullyConnectedResult;
@@ -526,11 +560,28 @@ void CLstmLayer::CFastLstmDesc::Init( CLstmLayer* lstmLayer ) {
 			inputFullyConnectedResult->GetDesc() );
 	}
 
+	// The input fully connected layer result for the whole sequence
+	auto& isfcl = inputSequenceFullyConnectedResult;
+	if( isfcl.Ptr() == nullptr || isfcl->GetBatchLength() != inDesc0.BatchLength()
+		|| isfcl->GetBatchWidth() != inDesc0.BatchWidth() || isfcl->GetObjectSize() != G_Count * hiddenSize )
+	{
+		inputSequenceFullyConnectedResult = CDnnBlob::CreateDataBlob( lstmLayer->MathEngine(), CT_Float,
+			inDesc0.BatchLength(), inDesc0.BatchWidth(), G_Count * hiddenSize );
+	}
+
 	lstmDesc = lstmLayer->MathEngine().InitLstm( lstmDesc,
 		inputFullyConnectedResult->GetData(), reccurentFullyConnectedResult->GetData(),
 		hiddenSize, lstmLayer->inputDescs[0].BatchWidth(), lstmLayer->inputDescs[0].ObjectSize() );
 }
 
+void CLstmLayer::CFastLstmDesc::SetObjectCount( CLstmLayer* lstmLayer, int objectCount )
+{
+	NeoPresume( isInitialized );
+	lstmDesc = lstmLayer->MathEngine().InitLstm( lstmDesc,
+		inputFullyConnectedResult->GetData(), reccurentFullyConnectedResult->GetData(),
+		lstmLayer->GetHiddenSize(), objectCount, lstmLayer->inputDescs[0].ObjectSize() );
+}
+
 CLayerWrapper<CLstmLayer> Lstm(
 	int hiddenSize, float dropoutRate, bool isInCompatibilityMode )
 {
@@ -20,6 +20,7 @@ limitations under the License.
 #include <NeoML/Dnn/Layers/MatrixMultiplicationLayer.h>
 #include <NeoML/Dnn/Layers/ActivationLayers.h>
 #include <NeoML/Dnn/Layers/AddToObjectLayer.h>
+#include <NeoML/Dnn/Layers/DataLayer.h>
 #include <NeoML/Dnn/Layers/DropoutLayer.h>
 #include <NeoML/Dnn/Layers/EltwiseLayer.h>
 #include <NeoML/Dnn/Layers/FullyConnectedLayer.h>
@@ -29,6 +30,9 @@ limitations under the License.
 
 namespace NeoML {
 
+// The layer which provides the causal mask for MT_Triangle
+static const char* const triangleMaskName = "Mask.Triangle";
+
 CMultiheadAttentionLayer::CMultiheadAttentionLayer( IMathEngine& mathEngine ) :
 	CCompositeLayer( mathEngine ),
 	headCount( 1 ),
@@ -37,7 +41,9 @@ CMultiheadAttentionLayer::CMultiheadAttentionLayer( IMathEngine& mathEngine ) :
 	useMask( false ),
 	maskType( MT_OneObject ),
 	outputSize( 8 ),
-	isInCompatibilityMode( false )
+	isInCompatibilityMode( false ),
+	isDecodingMode( false ),
+	cachedLength( 0 )
 {
 }
 
@@ -95,6 +101,18 @@ void CMultiheadAttentionLayer::SetCompatibilityMode( bool value )
 	}
 }
 
+void CMultiheadAttentionLayer::SetDecodingMode( bool isDecoding )
+{
+	isDecodingMode = isDecoding;
+	releaseCache();
+}
+
+void CMultiheadAttentionLayer::TrimCache( int length )
+{
+	NeoAssert( length >= 0 && length <= GetCachedLength() );
+	cachedLength = length;
+}
+
 static const int MultiheadAttentionLayerVersion = 2;
 
 void CMultiheadAttentionLayer::Serialize( CArchive& archive )
@@ -118,6 +136,9 @@ void CMultiheadAttentionLayer::Serialize( CArchive& archive )
 		isInCompatibilityMode = true;
 		multiplyByConstLayerName = GetName() + CString( ".MultiplyByConst" );
 	}
+	if( archive.IsLoading() ) {
+		releaseCache();
+	}
 }
 
 void CMultiheadAttentionLayer::Reshape()
@@ -126,9 +147,42 @@ void CMultiheadAttentionLayer::Reshape()
 		create();
 	}
 
+	if( maskType == MT_Triangle ) {
+		CheckLayerArchitecture( inputDescs[I_K].ListSize() >= inputDescs[I_Q].ListSize(),
+			"causal mask requires K to be not shorter than Q" );
+		updateTriangleMask();
+	}
+	if( isDecodingMode ) {
+		CheckLayerArchitecture( maskType == MT_Triangle || !useMask, "decoding mode supports only the causal mask" );
+	}
+	if( useMask && maskType == MT_SequenceLengths ) {
+		CheckLayerArchitecture( inputDescs[I_Mask].GetDataType() == CT_Int, "sequence lengths must be integer" );
+		CheckLayerArchitecture( inputDescs[I_Mask].BlobSize() == inputDescs[I_Q].BatchLength() * inputDescs[I_Q].BatchWidth(),
+			"the number of sequence lengths differs from the number of objects" );
+	}
+	projectedK = nullptr;
+	projectedV = nullptr;
+
 	CCompositeLayer::Reshape();
 }
 
+void CMultiheadAttentionLayer::RunOnce()
+{
+	if( isDecodingMode ) {
+		CheckLayerArchitecture( isFusedAttentionPossible(),
+			"decoding mode is supported only for CPU inference without dropout and softmax output" );
+	}
+	if( useMask && maskType == MT_SequenceLengths ) {
+		CheckLayerArchitecture( isFusedAttentionPossible(),
+			"sequence lengths are supported only for CPU inference without dropout and softmax output" );
+	}
+	if( isFusedAttentionPossible() ) {
+		runFusedAttention();
+	} else {
+		CCompositeLayer::RunOnce();
+	}
+}
+
 // Recreates the layer if forceRebuild is true or it doesn't contain sublayers
 void CMultiheadAttentionLayer::Rebuild( bool forceRebuild )
 {
@@ -186,7 +240,8 @@ void CMultiheadAttentionLayer::create()
 	// [B, n_head, seq_Q, seq_to]
 
 	CBaseLayer* beforeSoftmax = multiplierLayer;
-	if( useMask ) {
+	// The sequence lengths are used only by the fused attention
+	if( ( useMask && maskType != MT_SequenceLengths ) || maskType == MT_Triangle ) {
 		beforeSoftmax = applyMask( beforeSoftmax );
 	}
 
@@ -308,12 +363,21 @@ CBaseLayer* CMultiheadAttentionLayer::applyMask( CBaseLayer* layer )
 	multiplierLayer->SetMultiplier( -1e+9 );
 	multiplierLayer->SetFreeTerm( 0 );
 	AddLayer( *multiplierLayer );
-	SetInputMapping( I_Mask, *multiplierLayer, 0 );
+	if( maskType == MT_Triangle ) {
+		// The mask is filled on reshape when the sequence lengths are known
+		CPtr<CDataLayer> triangleMask = new CDataLayer( MathEngine() );
+		triangleMask->SetName( triangleMaskName );
+		AddLayer( *triangleMask );
+		multiplierLayer->Connect( *triangleMask );
+	} else {
+		SetInputMapping( I_Mask, *multiplierLayer, 0 );
+	}
 
 	CPtr<CBaseLayer> sumLayer;
 	CString sumLayerName;
 	switch( maskType ) {
 		case MT_OneObject:
+		case MT_Triangle:
 			sumLayer = new CAddToObjectLayer( MathEngine() );
 			sumLayerName = CString( ".Mask.ObjEltwiseSum" );
 			break;
@@ -455,6 +519,183 @@ CBaseLayer* CMultiheadAttentionLayer::prepareOutput( CBaseLayer* input )
 	return reshape0;
 }
 
+// Fills the causal mask for the current lengths of the sequences
+void CMultiheadAttentionLayer::updateTriangleMask()
+{
+	NeoPresume( maskType == MT_Triangle );
+	const int seqQ = inputDescs[I_Q].ListSize();
+	const int seqKV = inputDescs[I_K].ListSize();
+
+	CPtr<CDataLayer> triangleMask = CheckCast<CDataLayer>( GetLayer( triangleMaskName ) );
+	const CDnnBlob* maskBlob = triangleMask->GetBlob();
+	if( maskBlob != nullptr && maskBlob->GetWidth() == seqQ && maskBlob->GetChannelsCount() == seqKV ) {
+		return;
+	}
+
+	CArray<float> mask;
+	mask.SetSize( seqQ * seqKV );
+	for( int i = 0; i < seqQ; ++i ) {
+		for( int j = 0; j < seqKV; ++j ) {
+			mask[i * seqKV + j] = j > i + seqKV - seqQ ? 1.f : 0.f;
+		}
+	}
+	CPtr<CDnnBlob> newMaskBlob = CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, 1, 1, 1, seqQ, 1, seqKV } );
+	newMaskBlob->CopyFrom( mask.GetPtr() );
+	triangleMask->SetBlob( newMaskBlob );
+}
+
+// Checks if the attention may be calculated without the sublayers
+bool CMultiheadAttentionLayer::isFusedAttentionPossible() const
+{
+	if( MathEngine().GetType() != MET_Cpu || dropoutRate > 0 || GetOutputCount() != 1
+		|| IsBackwardPerformed() || IsLearningPerformed() || GetDnn()->IsRecurrentMode() )
+	{
+		return false;
+	}
+	// The int8 inference and the fused ReLU are implemented by the fully-connected sublayers only
+	for( const char* name : { "Q", "K", "V", "Out.Dense" } ) {
+		const CFullyConnectedLayer* fc = dynamic_cast<const CFullyConnectedLayer*>( GetLayer( name ).Ptr() );
+		if( fc == nullptr || fc->IsInt8InferenceEnabled() || fc->IsReLUFused() ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Calculates the output of the fully-connected sublayer for the matrix of objectCount rows
+static void applyFullyConnected( IMathEngine& mathEngine, const CFullyConnectedLayer& fc, const CConstFloatHandle& input,
+	int objectCount, const CFloatHandle& output )
+{
+	const int inputSize = fc.Weights()->GetObjectSize();
+	const int outputSize = fc.GetNumberOfElements();
+	mathEngine.MultiplyMatrixByTransposedMatrix( input, objectCount, inputSize, inputSize,
+		fc.Weights()->GetData(), outputSize, inputSize, output, outputSize, objectCount * outputSize );
+	if( !fc.IsZeroFreeTerm() ) {
+		mathEngine.AddVectorToMatrixRows( 1, output, output, objectCount, outputSize, fc.FreeTerms()->GetData() );
+	}
+}
+
+// Calculates the layer output by the fused attention primitive
+// The sublayers are used only as the storage of the weights
+void CMultiheadAttentionLayer::runFusedAttention()
+{
+	const CDnnBlob& inputQ = *inputBlobs[I_Q];
+	const int batchSize = inputQ.GetBatchLength() * inputQ.GetBatchWidth();
+	const int seqQ = inputQ.GetListSize();
+	const int queryCount = batchSize * seqQ;
+	const int newKeyCount = batchSize * inputBlobs[I_K]->GetListSize();
+
+	CFloatHandleStackVar buffer( MathEngine(), static_cast<size_t>( 2 * queryCount ) * hiddenSize );
+	CFloatHandle q = buffer.GetHandle();
+	CFloatHandle attention = q + queryCount * hiddenSize;
+	if( projectedK == nullptr ) {
+		projectedK = CDnnBlob::CreateTensor( MathEngine(), CT_Float,
+			{ 1, batchSize, inputBlobs[I_K]->GetListSize(), 1, 1, 1, hiddenSize } );
+		projectedV = CDnnBlob::CreateBlob( MathEngine(), projectedK->GetDesc() );
+	}
+	CPtr<CDnnBlob> k = projectedK;
+	CPtr<CDnnBlob> v = projectedV;
+
+	applyFullyConnected( MathEngine(), *CheckCast<CFullyConnectedLayer>( GetLayer( "Q" ) ),
+		inputQ.GetData(), queryCount, q );
+	applyFullyConnected( MathEngine(), *CheckCast<CFullyConnectedLayer>( GetLayer( "K" ) ),
+		inputBlobs[I_K]->GetData(), newKeyCount, k->GetData() );
+	applyFullyConnected( MathEngine(), *CheckCast<CFullyConnectedLayer>( GetLayer( "V" ) ),
+		inputBlobs[I_V]->GetData(), newKeyCount, v->GetData() );
+
+	int seqKV = k->GetListSize();
+	int kvStride = seqKV;
+	if( isDecodingMode ) {
+		reserveCache( batchSize, cachedLength + seqKV );
+		appendToCache( *cachedK, *k );
+		appendToCache( *cachedV, *v );
+		cachedLength += seqKV;
+		k = cachedK;
+		v = cachedV;
+		seqKV = cachedLength;
+		kvStride = GetCacheCapacity();
+	}
+
+	CConstFloatHandle mask;
+	int maskObjectCount = 1;
+	CConstIntHandle kvLengths;
+	if( useMask && maskType == MT_SequenceLengths ) {
+		kvLengths = inputBlobs[I_Mask]->GetData<int>();
+	} else if( useMask && maskType != MT_Triangle ) {
+		mask = inputBlobs[I_Mask]->GetData();
+		maskObjectCount = maskType == MT_Eltwise ? batchSize * headCount : 1;
+		NeoAssert( inputBlobs[I_Mask]->GetDataSize() == maskObjectCount * seqQ * seqKV );
+	}
+	if( kvStride == seqKV || batchSize == 1 ) {
+		MathEngine().ScaledDotProductAttention( batchSize, headCount, hiddenSize / headCount, seqQ, seqKV,
+			getScalingFactor(), q, k->GetData(), v->GetData(), mask.IsNull() ? nullptr : &mask, maskObjectCount,
+			maskType == MT_Triangle, kvLengths.IsNull() ? nullptr : &kvLengths, attention );
+	} else {
+		// The cache isn't full: the sequences are kvStride positions apart
+		NeoAssert( mask.IsNull() && kvLengths.IsNull() );
+		for( int b = 0; b < batchSize; ++b ) {
+			const int queryOffset = b * seqQ * hiddenSize;
+			const int kvOffset = b * kvStride * hiddenSize;
+			MathEngine().ScaledDotProductAttention( 1, headCount, hiddenSize / headCount, seqQ, seqKV,
+				getScalingFactor(), q + queryOffset, k->GetData() + kvOffset, v->GetData() + kvOffset,
+				nullptr, 1, maskType == MT_Triangle, nullptr, attention + queryOffset );
+		}
+	}
+
+	applyFullyConnected( MathEngine(), *CheckCast<CFullyConnectedLayer>( GetLayer( "Out.Dense" ) ),
+		attention, queryCount, outputBlobs[O_Output]->GetData() );
+}
+
+// Frees the memory of the cache
+void CMultiheadAttentionLayer::releaseCache()
+{
+	cachedK = nullptr;
+	cachedV = nullptr;
+	cachedLength = 0;
+}
+
+// Makes sure the cache can hold the given number of positions of each sequence
+// The capacity is at least doubled on reallocation, so the cached positions are copied O(log(length)) times
+void CMultiheadAttentionLayer::reserveCache( int batchWidth, int length )
+{
+	if( cachedK != nullptr && ( cachedK->GetBatchWidth() != batchWidth || cachedK->GetChannelsCount() != hiddenSize ) ) {
+		CheckLayerArchitecture( cachedLength == 0, "the number of sequences differs from the cached one" );
+		releaseCache();
+	}
+	const int capacity = GetCacheCapacity();
+	if( length <= capacity ) {
+		return;
+	}
+
+	const int newCapacity = max( 2 * capacity, length );
+	for( CPtr<CDnnBlob>* cache : { &cachedK, &cachedV } ) {
+		CPtr<CDnnBlob> grown = CDnnBlob::CreateTensor( MathEngine(), CT_Float,
+			{ 1, batchWidth, newCapacity, 1, 1, 1, hiddenSize } );
+		if( cachedLength > 0 ) {
+			for( int b = 0; b < batchWidth; ++b ) {
+				MathEngine().VectorCopy( grown->GetData() + b * newCapacity * hiddenSize,
+					( *cache )->GetData() + b * capacity * hiddenSize, cachedLength * hiddenSize );
+			}
+		}
+		*cache = grown;
+	}
+}
+
+// Writes the projected keys or values of the new positions after the cached ones
+void CMultiheadAttentionLayer::appendToCache( CDnnBlob& cache, const CDnnBlob& newPositions )
+{
+	const int batchWidth = newPositions.GetBatchWidth();
+	const int newLength = newPositions.GetListSize();
+	const int capacity = cache.GetListSize();
+	NeoAssert( cache.GetBatchWidth() == batchWidth );
+	NeoAssert( cachedLength + newLength <= capacity );
+
+	for( int b = 0; b < batchWidth; ++b ) {
+		MathEngine().VectorCopy( cache.GetData() + ( b * capacity + cachedLength ) * hiddenSize,
+			newPositions.GetData() + b * newLength * hiddenSize, newLength * hiddenSize );
+	}
+}
+
 CLayerWrapper<CMultiheadAttentionLayer> MultiheadAttention(
 	int headCount, int hiddenSize, int outputSize, float dropoutRate )
 {
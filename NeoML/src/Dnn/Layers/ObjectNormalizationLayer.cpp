@@ -168,6 +168,16 @@ void CObjectNormalizationLayer::RunOnce()
 {
 	const int objectCount = inputBlobs[0]->GetObjectCount();
 
+	if( MathEngine().GetType() == MET_Cpu ) {
+		// The fused kernel calculates the statistics and the output in two passes over the input
+		CFloatHandle inputNorm = normalizedInput == nullptr ? CFloatHandle() : normalizedInput->GetData();
+		CFloatHandle invSqrtVar = internalParams == nullptr ? CFloatHandle() : internalParams->GetObjectData( IPN_InvSqrtVariance );
+		MathEngine().LayerNormalization( objectCount, inputBlobs[0]->GetObjectSize(), inputBlobs[0]->GetData(),
+			GetEpsilon(), Scale()->GetData(), Bias()->GetData(), outputBlobs[0]->GetData(),
+			normalizedInput == nullptr ? nullptr : &inputNorm, internalParams == nullptr ? nullptr : &invSqrtVar );
+		return;
+	}
+
 	if( internalParams == nullptr ) {
 		CFloatHandleStackVar meanAndVarBuff( MathEngine(), 2 * objectCount );
 		runOnceImpl( meanAndVarBuff.GetHandle(), meanAndVarBuff.GetHandle() + objectCount,
@@ -257,6 +267,11 @@ void CObjectNormalizationLayer::BackwardOnce()
 		MathEngine().VectorCopy( outputDiffBackup->GetData(), outputDiff, outputDiffBackup->GetDataSize() );
 	}
 
+	if( MathEngine().GetType() == MET_Cpu ) {
+		MathEngine().LayerNormalizationBackward( objectCount, objectSize, input, invSqrtVar, scale, outputDiff, inputDiff );
+		return;
+	}
+
 	// Average is used multiple times in RunOnce.
 	// But it is used neither in BackwardOnce nor in LearnOnce.
 	// That's why it's possible to reuse it here as a buffer.
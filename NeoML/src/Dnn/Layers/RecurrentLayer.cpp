@@ -25,7 +25,8 @@ namespace NeoML {
 CRecurrentLayer::CRecurrentLayer( IMathEngine& mathEngine, const char* name ) :
 	CCompositeLayer( mathEngine, name == nullptr ? "CCnnRecurrentLayer" : name ),
 	isReverseSequence(false),
-	repeatCount(1)
+	repeatCount(1),
+	isPackedSequence(false)
 {
 }
 
@@ -137,6 +138,14 @@ void CRecurrentLayer::SetRepeatCount(int count)
 	repeatCount = count;
 }
 
+void CRecurrentLayer::SetPackedSequence( bool isPacked )
+{
+	if( isPackedSequence != isPacked ) {
+		ForceReshape();
+	}
+	isPackedSequence = isPacked;
+}
+
 void CRecurrentLayer::getSequenceParams(int& batchWidth, int& sequenceLength)
 {
 	// The outermost recurrent layer runs in recurrent mode, 
@@ -156,6 +165,12 @@ void CRecurrentLayer::SetInternalDnnParams()
 	int batchWidth;
 	int sequenceLength;
 	getSequenceParams(batchWidth, sequenceLength);
+	if( isPackedSequence ) {
+		CheckLayerArchitecture( inputDescs.Size() > 1, "packed sequences require the sequence lengths input" );
+		CheckLayerArchitecture( inputDescs[1].GetDataType() == CT_Int, "sequence lengths must be CT_Int" );
+		CheckLayerArchitecture( inputDescs[1].BlobSize() == batchWidth,
+			"the number of sequence lengths must be equal to the BD_BatchWidth of the data input" );
+	}
 	if(!GetDnn()->IsRecurrentMode()) {
 		GetInternalDnn()->setProcessingParams(true, sequenceLength, isReverseSequence, GetDnn()->IsBackwardPerformed());
 	} else {
@@ -169,9 +184,67 @@ void CRecurrentLayer::SetInternalDnnParams()
 	}
 }
 
+bool CRecurrentLayer::IsWholeSequenceRunAvailable() const
+{
+	return MathEngine().GetType() == MET_Cpu
+		&& !IsBackwardPerformed()
+		&& !IsLearningPerformed()
+		&& !GetDnn()->IsRecurrentMode()
+		&& GetDnn()->GetAutoRestartMode()
+		&& repeatCount == 1;
+}
+
+void CRecurrentLayer::GetActiveBatchWidths( CArray<int>& activeBatchWidths ) const
+{
+	const int sequenceLength = inputBlobs[0]->GetBatchLength();
+	const int batchWidth = inputBlobs[0]->GetBatchWidth();
+	activeBatchWidths.DeleteAll();
+	activeBatchWidths.Add( batchWidth, sequenceLength );
+	if( !isPackedSequence ) {
+		return;
+	}
+
+	CArray<int> lengths;
+	lengths.SetSize( batchWidth );
+	inputBlobs[1]->CopyTo( lengths.GetPtr() );
+	for( int i = 0; i < batchWidth; ++i ) {
+		NeoAssert( lengths[i] >= 0 && lengths[i] <= sequenceLength );
+		NeoAssert( i == 0 || lengths[i] <= lengths[i - 1] );
+	}
+	int activeCount = batchWidth;
+	for( int pos = 0; pos < sequenceLength; ++pos ) {
+		while( activeCount > 0 && lengths[activeCount - 1] <= pos ) {
+			--activeCount;
+		}
+		activeBatchWidths[pos] = activeCount;
+	}
+}
+
+void CRecurrentLayer::GetActiveRowBlocks( const CArray<int>& activeBatchWidths, int batchWidth,
+	CArray<int>& firstRows, CArray<int>& rowCounts )
+{
+	firstRows.DeleteAll();
+	rowCounts.DeleteAll();
+	for( int pos = 0; pos < activeBatchWidths.Size(); ++pos ) {
+		if( activeBatchWidths[pos] == 0 ) {
+			continue;
+		}
+		const int firstRow = pos * batchWidth;
+		if( !firstRows.IsEmpty() && firstRows.Last() + rowCounts.Last() == firstRow ) {
+			// The previous position is full, the rows are merged into one block
+			rowCounts.Last() += activeBatchWidths[pos];
+		} else {
+			firstRows.Add( firstRow );
+			rowCounts.Add( activeBatchWidths[pos] );
+		}
+	}
+}
+
 // Runs the forward pass of the internal network (overloaded in children)
 void CRecurrentLayer::RunInternalDnn()
 {
+	CheckLayerArchitecture( !isPackedSequence,
+		"packed sequences are supported only if the whole sequence is processed at once (inference on CPU)" );
 	// Avoid calling GetPath on every run
 	if( outputBlobs[0]->GetOwner()->GetBatchLength() != inputBlobs[0]->GetOwner()->GetBatchLength() * repeatCount ) {
 		CheckLayerArchitecture( false, "incorrect batch length of outputBlobs[0]" );
@@ -249,12 +322,17 @@ void CRecurrentLayer::serializationHook(CArchive& archive)
 	}
 }
 
-static const int RecurrentLayerVersion = 2000;
+static const int RecurrentLayerVersion = 2001;
 
 void CRecurrentLayer::Serialize( CArchive& archive )
 {
-	archive.SerializeVersion( RecurrentLayerVersion, CDnn::ArchiveMinSupportedVersion );
+	const int version = archive.SerializeVersion( RecurrentLayerVersion, CDnn::ArchiveMinSupportedVersion );
 	CCompositeLayer::Serialize( archive );
+	if( version >= 2001 ) {
+		archive.Serialize( isPackedSequence );
+	} else {
+		isPackedSequence = false;
+	}
 }
 
 } // namespace NeoML
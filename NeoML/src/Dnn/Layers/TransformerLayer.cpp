@@ -173,6 +173,8 @@ void CTransformerEncoderLayer::Reshape()
 	CheckLayerArchitecture( GetHiddenSize() % GetHeadCount() == 0, "HiddenSize must be a multiple of HeadCount" );
 	CheckLayerArchitecture( GetInputCount() == 1 || GetInputCount() == 2, "Layer must have 1 or 2 inputs" );
 	checkBlob( inputDescs[0], GetPath(), "input data", -1, -1, 1, -1 );
+	CheckLayerArchitecture( GetMaskType() != CMultiheadAttentionLayer::MT_Triangle || GetInputCount() == 1,
+		"MT_Triangle doesn't use the input mask" );
 
 	if( GetInputCount() == 2 ) {
 		switch( GetMaskType() ) {
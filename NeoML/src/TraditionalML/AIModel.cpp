@@ -19,6 +19,8 @@ limitations under the License.
 #include <NeoML/NeoMLDefs.h>
 #include <NeoML/TraditionalML/Model.h>
 #include <NeoML/TraditionalML/TrainingModel.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <atomic>
 
 namespace NeoML {
 
@@ -27,10 +29,66 @@ static CMap<const std::type_info*, CString, CDefaultHash<const std::type_info*>,
 
 IModel::~IModel() = default;
 
+bool IModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	std::atomic<bool> success( true );
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		if( !Classify( row, results[i] ) ) {
+			success = false;
+		}
+	}
+	return success;
+}
+
 IRegressionModel::~IRegressionModel() = default;
 
+void IRegressionModel::PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		results[i] = Predict( row );
+	}
+}
+
 IMultivariateRegressionModel::~IMultivariateRegressionModel() = default;
 
+int IMultivariateRegressionModel::MultivariatePredictBatch( const CFloatMatrixDesc& data, CArray<float>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	if( data.Height == 0 ) {
+		results.Empty();
+		return 0;
+	}
+
+	// The first row is processed separately to find out the value size
+	const CFloatVector first = MultivariatePredict( data.GetRow( 0 ) );
+	const int valueSize = first.Size();
+	results.SetSize( data.Height * valueSize );
+	::memcpy( results.GetPtr(), first.GetPtr(), valueSize * sizeof( float ) );
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 1; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		const CFloatVector value = MultivariatePredict( row );
+		NeoAssert( value.Size() == valueSize );
+		::memcpy( results.GetPtr() + i * valueSize, value.GetPtr(), valueSize * sizeof( float ) );
+	}
+	return valueSize;
+}
+
 ITrainingModel::~ITrainingModel() = default;
 
 IRegressionTrainingModel::~IRegressionTrainingModel() = default;
@@ -104,6 +104,7 @@ void CBytePairEncoder::InitializeUnsafe( const CBPEDictionary& _tokens )
 		NeoAssert( !tokenToId.Has( token ) );
 		tokenToId.Add( token, tokenToId.Size() );
 	}
+	buildMergeTables();
 }
 
 void CBytePairEncoder::Decode( const CArray<int>& tokenIds, CArray<CString>& words ) const
@@ -234,6 +235,7 @@ void CBytePairEncoder::Serialize( CArchive& archive )
 		for( int i = 0; i < tokens.Size(); i++ ) {
 			tokenToId.Add( tokens[i], i );
 		}
+		buildMergeTables();
 	}
 }
 
@@ -307,45 +309,150 @@ void CBytePairEncoder::GetTokenToIdMapping( CMap<CString, int>& output ) const
 	}
 }
 
+int CBytePairEncoder::CTokenPair::HashKey() const
+{
+	int hash = Left;
+	AddToHashKey( Right, hash );
+	return hash;
+}
+
+// Fills the tables used for encoding the words without building the strings of the merged tokens
+void CBytePairEncoder::buildMergeTables()
+{
+	mergedTokens.DeleteAll();
+	mergedTokens.SetHashTableSize( tokens.Size() );
+	byteTokens.DeleteAll();
+	byteTokens.Add( NotFound, 256 );
+
+	for( int i = 0; i < tokens.Size(); ++i ) {
+		const CString& token = tokens[i];
+		if( token.Length() == 1 ) {
+			byteTokens[static_cast<unsigned char>( token[0] )] = i;
+		}
+		// Every split of the token into two other tokens gives the same token when merged
+		for( int j = 1; j < token.Length(); ++j ) {
+			CTokenPair pair;
+			if( tokenToId.Lookup( token.Mid( 0, j ), pair.Left )
+				&& tokenToId.Lookup( token.Mid( j, token.Length() - j ), pair.Right ) )
+			{
+				mergedTokens.Add( pair, i );
+			}
+		}
+	}
+
+	startOfWordTokenId = NotFound;
+	if( UseStartOfWordToken() ) {
+		tokenToId.Lookup( params.StartOfWordToken, startOfWordTokenId );
+	}
+	endOfWordTokenId = NotFound;
+	if( UseEndOfWordToken() ) {
+		tokenToId.Lookup( params.EndOfWordToken, endOfWordTokenId );
+	}
+}
+
+// Splits a word into the unshifted indices of the initial tokens, NotFound for the unknown ones
+void CBytePairEncoder::splitWordIntoInitialTokenIds( const CString& word,
+	CArray<int>& wordTokens, CArray<int>& wordTokenLengths ) const
+{
+	NeoAssert( !word.IsEmpty() );
+
+	wordTokens.SetBufferSize( word.Length() + 2 );
+	wordTokenLengths.SetBufferSize( word.Length() + 2 );
+	if( UseStartOfWordToken() ) {
+		wordTokens.Add( startOfWordTokenId );
+		wordTokenLengths.Add( 0 );
+	}
+
+	for( int curPos = 0; curPos < word.Length(); ) {
+		const int charLength = UseRawBytes() ? 1 : getUtf8CharLength( word[curPos] );
+		NeoAssert( charLength > 0 );
+		NeoAssert( curPos + charLength <= word.Length() );
+		int token = NotFound;
+		if( charLength == 1 ) {
+			token = byteTokens[static_cast<unsigned char>( word[curPos] )];
+		} else if( !tokenToId.Lookup( CString( ( const char* )word + curPos, charLength ), token ) ) {
+			token = NotFound;
+		}
+		wordTokens.Add( token );
+		wordTokenLengths.Add( 1 );
+		curPos += charLength;
+	}
+
+	if( UseEndOfWordToken() ) {
+		wordTokens.Add( endOfWordTokenId );
+		wordTokenLengths.Add( 0 );
+	}
+}
+
 void CBytePairEncoder::DoEncode( const CString& word, CArray<int>& tokenIds,
 	CArray<int>& tokenLengths ) const
 {
 	NeoAssert( IsInitialized() );
 
-	CArray<CString> wordTokens;
+	// The symbols of the word form a linked list; the merged symbol takes the place of the left one
+	// On each step the merge resulting in the token with the lowest index is performed (the leftmost one in case of a tie)
+	CArray<int> wordTokens;
 	CArray<int> wordTokenLengths;
-	SplitWordIntoInitialTokens( word, wordTokens, &wordTokenLengths );
-
-	while( true ) {
-		int bestPairIndex = getShiftedTokenIndex( tokens.Last() ) + 1;
-		int bestMergePos = NotFound;
-		for( int i = 0; i < wordTokens.Size() - 1; i++ ) {
-			const CString pair = MergeTokens( wordTokens[i], wordTokens[i + 1] );
-			const int pairIndex = getShiftedTokenIndex( pair );
-			if( pairIndex != UnknownTokenId() && pairIndex < bestPairIndex ) {
-				bestPairIndex = pairIndex;
-				bestMergePos = i;
-			}
+	splitWordIntoInitialTokenIds( word, wordTokens, wordTokenLengths );
+	const int symbolCount = wordTokens.Size();
+	CArray<int> next;
+	CArray<int> prev;
+	next.SetBufferSize( symbolCount );
+	prev.SetBufferSize( symbolCount );
+	for( int i = 0; i < symbolCount; i++ ) {
+		next.Add( i + 1 );
+		prev.Add( i - 1 );
+	}
+
+	CPriorityQueue<CFastArray<CMergeCandidate, 16>, CompositeComparer<CMergeCandidate,
+		DescendingByMember<CMergeCandidate, int, &CMergeCandidate::Token>,
+		DescendingByMember<CMergeCandidate, int, &CMergeCandidate::Left>>> queue;
+	auto addCandidate = [&]( int left, int right ) {
+		if( left < 0 || right >= symbolCount || wordTokens[left] == NotFound || wordTokens[right] == NotFound ) {
+			return;
+		}
+		CMergeCandidate candidate;
+		if( mergedTokens.Lookup( CTokenPair{ wordTokens[left], wordTokens[right] }, candidate.Token ) ) {
+			candidate.Left = left;
+			candidate.LeftToken = wordTokens[left];
+			candidate.RightToken = wordTokens[right];
+			queue.Push( candidate );
 		}
+	};
+	for( int i = 0; i < symbolCount - 1; i++ ) {
+		addCandidate( i, i + 1 );
+	}
 
-		if( bestMergePos == NotFound ) {
-			break;
+	const int Merged = NotFound - 1; // the token of the symbol merged into its left neighbour
+	CMergeCandidate candidate;
+	while( queue.Pop( candidate ) ) {
+		const int left = candidate.Left;
+		const int right = next[left];
+		// Skip the candidate if any of its symbols has changed since it was found
+		if( wordTokens[left] != candidate.LeftToken || right >= symbolCount
+			|| wordTokens[right] != candidate.RightToken )
+		{
+			continue;
 		}
 
-		wordTokens[bestMergePos] = MergeTokens( wordTokens[bestMergePos],
-			wordTokens[bestMergePos + 1] );
-		wordTokenLengths[bestMergePos] += wordTokenLengths[bestMergePos + 1];
+		wordTokens[left] = candidate.Token;
+		wordTokenLengths[left] += wordTokenLengths[right];
+		wordTokens[right] = Merged;
+		next[left] = next[right];
+		if( next[left] < symbolCount ) {
+			prev[next[left]] = left;
+		}
 
-		wordTokens.DeleteAt( bestMergePos + 1 );
-		wordTokenLengths.DeleteAt( bestMergePos + 1 );
+		addCandidate( prev[left], left );
+		addCandidate( left, next[left] );
 	}
 
-	NeoAssert( wordTokens.Size() == wordTokenLengths.Size() );
-	tokenIds.SetBufferSize( tokenIds.Size() + wordTokens.Size() );
-	for( int i = 0; i < wordTokens.Size(); i++ ) {
-		tokenIds.Add( getShiftedTokenIndex( wordTokens[i] ) );
+	tokenIds.SetBufferSize( tokenIds.Size() + symbolCount );
+	tokenLengths.SetBufferSize( tokenLengths.Size() + symbolCount );
+	for( int i = 0; i < symbolCount; i = next[i] ) {
+		tokenIds.Add( wordTokens[i] == NotFound ? UnknownTokenId() : wordTokens[i] + UnknownTokenId() + 1 );
+		tokenLengths.Add( wordTokenLengths[i] );
 	}
-	tokenLengths.Add( wordTokenLengths );
 }
 
 // Returns index of token for encoding.
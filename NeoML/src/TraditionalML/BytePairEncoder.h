@@ -57,13 +57,39 @@ protected:
 		CArray<int>& tokenLengths ) const override;
 
 private:
+	// A pair of adjacent tokens (unshifted indices).
+	struct CTokenPair {
+		int Left;
+		int Right;
+
+		int HashKey() const;
+		bool operator==( const CTokenPair& other ) const { return Left == other.Left && Right == other.Right; }
+	};
+
+	// A possible merge of two adjacent symbols of the word being encoded.
+	struct CMergeCandidate {
+		int Token; // the merged token (unshifted index), the tokens with lower indices are merged first
+		int Left; // the position of the left symbol
+		int LeftToken; // the tokens of the symbols when the candidate was found
+		int RightToken;
+	};
+
 	// Index map Id -> Token. Note that the ids are being shifted by UnknownTokenId() + 1 while encoding.
 	CBPEDictionary tokens;
 	// Reverse Map: Token -> Id. It is an unshifted index (matches 'tokens' array).
 	CMap<CString, int> tokenToId;
 	// Encoder parameters
 	CParams params;
+	// The token resulting from the merge of two tokens. All indices are unshifted.
+	CMap<CTokenPair, int> mergedTokens;
+	// The tokens of single bytes, NotFound if the byte is not a token.
+	CArray<int> byteTokens;
+	// The tokens of Start-of-Word and End-of-Word, NotFound if not used.
+	int startOfWordTokenId = NotFound;
+	int endOfWordTokenId = NotFound;
 
+	void buildMergeTables();
+	void splitWordIntoInitialTokenIds( const CString& word, CArray<int>& wordTokens, CArray<int>& wordTokenLengths ) const;
 	CString getToken( int shiftedTokenId ) const;
 	void removeSpecialTokens( CString& token, bool& hasEow, bool& hasSow ) const;
 	bool replaceEowToken( CString& token, const CString& eowToken, const CString& replacement ) const;
@@ -19,14 +19,17 @@ limitations under the License.
 #include <NeoML/TraditionalML/CrossValidation.h>
 #include <NeoML/TraditionalML/CrossValidationSubProblem.h>
 #include <NeoML/TraditionalML/StratifiedCrossValidationSubProblem.h>
+#include <ParallelTasks.h>
 
 namespace NeoML {
 
-CCrossValidation::CCrossValidation( ITrainingModel& _trainingModel, const IProblem* _problem ) :
+CCrossValidation::CCrossValidation( ITrainingModel& _trainingModel, const IProblem* _problem, int _threadCount ) :
 	trainingModel( _trainingModel ),
-	problem( _problem )
+	problem( _problem ),
+	threadCount( _threadCount )
 {
 	NeoAssert( problem != 0 );
+	NeoAssert( threadCount > 0 );
 }
 
 void CCrossValidation::Execute( int partsCount, TScore score, CCrossValidationResult& result, bool stratified )
@@ -41,8 +44,11 @@ void CCrossValidation::Execute( int partsCount, TScore score, CCrossValidationRe
 	result.ModelIndex.Empty();
 	result.ModelIndex.SetSize( problem->GetVectorCount() );
 	result.Success.Empty();
+	result.Models.SetSize( partsCount );
+	result.Success.SetSize( partsCount );
 
-	for( int i = 0; i < partsCount; i++ ) {
+	// The folds are independent and share the matrix of the input data
+	ExecuteParallelTasks( partsCount, threadCount, [&]( int i ) {
 		// Choose the training subset
 		CPtr<ISubProblem> trainSubProblem;
 		if( stratified ) {
@@ -53,7 +59,7 @@ void CCrossValidation::Execute( int partsCount, TScore score, CCrossValidationRe
 
 		// Train the model
 		CPtr<IModel> model = trainingModel.Train( *trainSubProblem );
-		result.Models.Add( model );
+		result.Models[i] = model;
 
 		// Choose the testing subset
 		CPtr<ISubProblem> testSubProblem;
@@ -77,8 +83,8 @@ void CCrossValidation::Execute( int partsCount, TScore score, CCrossValidationRe
 			result.ModelIndex[testSubProblem->GetOriginalIndex( j )] = i;
 		}
 
-		result.Success.Add( score( classificationResults, testSubProblem ) );
-	}
+		result.Success[i] = score( classificationResults, testSubProblem );
+	} );
 }
 
 } // namespace NeoML
@@ -22,6 +22,7 @@ limitations under the License.
 #include <DecisionTreeNodeBase.h>
 #include <DecisionTreeClassificationModel.h>
 #include <DecisionTreeNodeClassificationStatistic.h>
+#include <NeoMathEngine/OpenMP.h>
 #include <float.h>
 
 namespace NeoML {
@@ -51,6 +52,7 @@ CDecisionTree::CDecisionTree( const CParams& _params, CRandom* _random ) :
 	NeoAssert( params.MaxTreeDepth > 0 );
 	NeoAssert( params.MaxNodesCount > 1 );
 	NeoAssert( 0.00 <= params.ConstNodeThreshold && params.ConstNodeThreshold <= 1.0 );
+	NeoAssert( params.ThreadCount > 0 );
 }
 
 CDecisionTree::~CDecisionTree()
@@ -86,15 +88,15 @@ CPtr<CDecisionTreeNodeBase> CDecisionTree::buildTree( int vectorCount )
 	// Based on this data, decide what size cache we will need and can afford
 	CPtr<CDecisionTreeNodeBase> root = createNode();
 	nodesCount = 1;
-	CDecisionTreeNodeStatisticBase* rootStatistic = createStatistic( root );
 	CFloatMatrixDesc matrix = classificationProblem->GetMatrix();
+	buildFeatureValues( matrix );
 
-	CFloatVectorDesc desc;
-	for( int i = 0; i < vectorCount; i++ ) {
-		matrix.GetRow( i, desc );
-		rootStatistic->AddVector( i, desc );
-	}
-	rootStatistic->Finish();
+	statisticsCache.Empty();
+	statisticsCache.Add( createStatistic( root ) );
+	vectorStatistics.Empty();
+	vectorStatistics.Add( 0, vectorCount );
+	fillStatistics();
+	const CDecisionTreeNodeStatisticBase* rootStatistic = statisticsCache.First();
 
 	classifyNodesCache.Empty();
 	classifyNodesLevel.Empty();
@@ -104,11 +106,10 @@ CPtr<CDecisionTreeNodeBase> CDecisionTree::buildTree( int vectorCount )
 
 	statisticsCacheSize = static_cast<int>( params.AvailableMemory / rootStatistic->GetSize() );
 	NeoAssert( statisticsCacheSize > 0 ); // we need at least the amount of memory sufficient for one node statistics
-	statisticsCache.FreeBuffer();
-	statisticsCache.SetBufferSize( statisticsCacheSize );
 
 	split( *rootStatistic, 0 );
-	delete rootStatistic;
+	statisticsCache.FreeBuffer();
+	statisticsCache.SetBufferSize( statisticsCacheSize );
 
 	// Build the tree level by level
 	for( int i = 1; i <= params.MaxTreeDepth; i++ ) {
@@ -118,6 +119,10 @@ CPtr<CDecisionTreeNodeBase> CDecisionTree::buildTree( int vectorCount )
 	}
 
 	statisticsCache.FreeBuffer();
+	featureValuesPtr.FreeBuffer();
+	featureValuesVectors.FreeBuffer();
+	featureValues.FreeBuffer();
+	vectorStatistics.FreeBuffer();
 
 	if( logStream != 0 ) {
 		*logStream << "\nDecision tree training finished\n";
@@ -126,6 +131,42 @@ CPtr<CDecisionTreeNodeBase> CDecisionTree::buildTree( int vectorCount )
 	return root;
 }
 
+// Groups the non-zero feature values by feature, so that the statistics could be collected for different features in parallel
+void CDecisionTree::buildFeatureValues( const CFloatMatrixDesc& matrix )
+{
+	const int featureCount = classificationProblem->GetFeatureCount();
+	featureValuesPtr.Empty();
+	featureValuesPtr.Add( 0, featureCount + 1 );
+
+	CFloatVectorDesc vector;
+	for( int i = 0; i < matrix.Height; i++ ) {
+		matrix.GetRow( i, vector );
+		for( int j = 0; j < vector.Size; j++ ) {
+			if( vector.Values[j] != 0.0 ) {
+				featureValuesPtr[( vector.Indexes == nullptr ? j : vector.Indexes[j] ) + 1]++;
+			}
+		}
+	}
+	for( int i = 0; i < featureCount; i++ ) {
+		featureValuesPtr[i + 1] += featureValuesPtr[i];
+	}
+
+	featureValuesVectors.SetSize( featureValuesPtr.Last() );
+	featureValues.SetSize( featureValuesPtr.Last() );
+	CArray<int> positions;
+	featureValuesPtr.CopyTo( positions );
+	for( int i = 0; i < matrix.Height; i++ ) {
+		matrix.GetRow( i, vector );
+		for( int j = 0; j < vector.Size; j++ ) {
+			if( vector.Values[j] != 0.0 ) {
+				const int position = positions[vector.Indexes == nullptr ? j : vector.Indexes[j]]++;
+				featureValuesVectors[position] = i;
+				featureValues[position] = vector.Values[j];
+			}
+		}
+	}
+}
+
 // Builds one tree level
 bool CDecisionTree::buildTreeLevel( const CFloatMatrixDesc& matrix, int level, CDecisionTreeNodeBase& root ) const
 {
@@ -177,33 +218,42 @@ bool CDecisionTree::collectStatistics( const CFloatMatrixDesc& matrix, int level
 {
 	NeoAssert( level > 0 );
 	NeoAssert( root != 0 );
-	CMap<CDecisionTreeNodeBase*, int> nodesStatistics;
 
-	bool result = true;
 	const int matrixHeight = matrix.Height;
+	CArray<CDecisionTreeNodeBase*> vectorLeaves;
+	vectorLeaves.SetSize( matrixHeight );
 
+	// Find the leaf node for each vector in the current tree
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
 	for( int i = 0; i < matrixHeight; i++ ) {
 		CFloatVectorDesc vector;
 		matrix.GetRow( i, vector );
-		// Find the leaf node for this vector in the current tree
-		CPtr<CDecisionTreeNodeBase> leaf;
+		const CDecisionTreeNodeBase* leaf = nullptr;
 		int leafLevel = 0;
-		if( i < MaxClassifyNodesCacheSize ) {
-			classifyNodesCache[i]->GetClassifyNode( vector, leaf, leafLevel );
+		if( i < classifyNodesCache.Size() ) {
+			leaf = classifyNodesCache[i]->GetClassifyNode( vector, leafLevel );
 			leafLevel += classifyNodesLevel[i];
-			classifyNodesCache[i] = leaf;
+			classifyNodesCache[i] = const_cast<CDecisionTreeNodeBase*>( leaf );
 			classifyNodesLevel[i] = leafLevel;
 		} else {
-			root->GetClassifyNode( vector, leaf, leafLevel );
+			leaf = root->GetClassifyNode( vector, leafLevel );
 		}
 
-		if( leafLevel != level || leaf->GetType() != DTNT_Undefined ) {
-			// This node belongs to another level or was already processed on the current level
+		// Skip the nodes that belong to another level or were already processed on the current level
+		vectorLeaves[i] = ( leafLevel == level && leaf->GetType() == DTNT_Undefined ) ?
+			const_cast<CDecisionTreeNodeBase*>( leaf ) : nullptr;
+	}
+
+	CMap<CDecisionTreeNodeBase*, int> nodesStatistics;
+	bool result = true;
+	for( int i = 0; i < matrixHeight; i++ ) {
+		vectorStatistics[i] = NotFound;
+		CDecisionTreeNodeBase* leaf = vectorLeaves[i];
+		if( leaf == nullptr ) {
 			continue;
 		}
 
 		TMapPosition pos = nodesStatistics.GetFirstPosition( leaf );
-		int nodeStatisticIndex = NotFound;
 		if( pos == NotFound ) {
 			const int curStatisticsCashSize = nodesStatistics.Size();
 			// No statistics object for this node, create one
@@ -212,21 +262,42 @@ bool CDecisionTree::collectStatistics( const CFloatMatrixDesc& matrix, int level
 				result = false;
 				continue;
 			}
-			nodeStatisticIndex = curStatisticsCashSize;
+			vectorStatistics[i] = curStatisticsCashSize;
 			statisticsCache.Add( createStatistic( leaf ) );
-			nodesStatistics.Add( leaf, nodeStatisticIndex );
+			nodesStatistics.Add( leaf, curStatisticsCashSize );
 		} else {
-			nodeStatisticIndex = nodesStatistics.GetValue( pos );
+			vectorStatistics[i] = nodesStatistics.GetValue( pos );
 		}
-
-		statisticsCache[nodeStatisticIndex]->AddVector( i, vector );
 	}
 
-	for( int i = 0; i < statisticsCache.Size(); i++ ) {
-		statisticsCache[i]->Finish();
+	fillStatistics();
+	return result;
+}
+
+// Adds the vectors to the statistics they belong to and finishes the statistics
+// The features are processed in parallel; the values of each feature are added in the order of vectors,
+// so the statistics are the same for any number of threads
+void CDecisionTree::fillStatistics() const
+{
+	for( int i = 0; i < vectorStatistics.Size(); i++ ) {
+		if( vectorStatistics[i] != NotFound ) {
+			statisticsCache[vectorStatistics[i]]->AddVector( i );
+		}
 	}
 
-	return result;
+	const int featureCount = featureValuesPtr.Size() - 1;
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int feature = 0; feature < featureCount; feature++ ) {
+		for( int i = featureValuesPtr[feature]; i < featureValuesPtr[feature + 1]; i++ ) {
+			const int statistic = vectorStatistics[featureValuesVectors[i]];
+			if( statistic != NotFound ) {
+				statisticsCache[statistic]->AddFeatureValue( featureValuesVectors[i], feature, featureValues[i] );
+			}
+		}
+		for( int i = 0; i < statisticsCache.Size(); i++ ) {
+			statisticsCache[i]->FinishFeature( feature );
+		}
+	}
 }
 
 // Splits the specified node according to the accumulated statistics
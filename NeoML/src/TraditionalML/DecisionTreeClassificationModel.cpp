@@ -17,6 +17,8 @@ limitations under the License.
 #pragma hdrstop
 
 #include <DecisionTreeClassificationModel.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <atomic>
 
 namespace NeoML {
 
@@ -158,6 +160,24 @@ bool CDecisionTreeClassificationModel::Classify( const CFloatVectorDesc& data, C
 	return classify( node, result );
 }
 
+bool CDecisionTreeClassificationModel::ClassifyBatch( const CFloatMatrixDesc& data,
+	CArray<CClassificationResult>& results, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	std::atomic<bool> success( true );
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		if( !classify( GetClassifyNode( row ), results[i] ) ) {
+			success = false;
+		}
+	}
+	return success;
+}
+
 void CDecisionTreeClassificationModel::Serialize( CArchive& archive )
 {
 	archive.SerializeVersion( 0 );
@@ -230,7 +250,7 @@ void CDecisionTreeClassificationModel::Serialize( CArchive& archive )
 }
 
 // Performs classification in a node
-bool CDecisionTreeClassificationModel::classify( CDecisionTreeNodeBase* node, CClassificationResult& result ) const
+bool CDecisionTreeClassificationModel::classify( const CDecisionTreeNodeBase* node, CClassificationResult& result ) const
 {
 	NeoAssert( node != 0 );
 	NeoAssert( node->GetInfo() != 0 );
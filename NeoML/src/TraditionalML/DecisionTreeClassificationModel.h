@@ -33,10 +33,12 @@ public:
 	// IModel interface methods
 	int GetClassCount() const override;
 	bool Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const override;
+	bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const override;
 	void Serialize( CArchive& archive ) override;
 
 private:
-	bool classify( CDecisionTreeNodeBase* node, CClassificationResult& result ) const;
+	bool classify( const CDecisionTreeNodeBase* node, CClassificationResult& result ) const;
 };
 
 } // namespace NeoML
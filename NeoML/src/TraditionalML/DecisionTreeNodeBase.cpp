@@ -83,6 +83,55 @@ void CDecisionTreeNodeBase::GetClassifyNode( const CFloatVector& data, CPtr<CDec
 	GetClassifyNode( data.GetDesc(), node, additionalLevel );
 }
 
+const CDecisionTreeNodeBase* CDecisionTreeNodeBase::GetClassifyNode( const CFloatVectorDesc& data ) const
+{
+	int additionalLevel = 0;
+	return GetClassifyNode( data, additionalLevel );
+}
+
+const CDecisionTreeNodeBase* CDecisionTreeNodeBase::GetClassifyNode( const CFloatVectorDesc& data, int& additionalLevel ) const
+{
+	const CDecisionTreeNodeBase* node = this;
+	while( node->info != 0 ) {
+		switch( node->info->Type ) {
+			case DTNT_Discrete:
+			{
+				const CDecisionTreeDiscreteNodeInfo* discreteInfo = static_cast<const CDecisionTreeDiscreteNodeInfo*>( node->info );
+				float featureValue = 0;
+				GetValue( data, discreteInfo->FeatureIndex, featureValue );
+
+				const int index = discreteInfo->Values.Find( featureValue );
+				if( index == NotFound ) {
+					return node;
+				}
+				node = discreteInfo->Children[index];
+				additionalLevel++;
+				break;
+			}
+
+			case DTNT_Continuous:
+			{
+				const CDecisionTreeContinuousNodeInfo* continuousInfo = static_cast<const CDecisionTreeContinuousNodeInfo*>( node->info );
+				float featureValue = 0;
+				GetValue( data, continuousInfo->FeatureIndex, featureValue );
+
+				node = featureValue <= continuousInfo->Threshold ? continuousInfo->Child1.Ptr() : continuousInfo->Child2.Ptr();
+				NeoAssert( node != 0 );
+				additionalLevel++;
+				break;
+			}
+
+			case DTNT_Const:
+			case DTNT_Undefined:
+				return node;
+
+			default:
+				NeoAssert( false );
+		};
+	}
+	return node;
+}
+
 CDecisionTreeNodeBase::~CDecisionTreeNodeBase()
 {
 	if( info != 0 ) {
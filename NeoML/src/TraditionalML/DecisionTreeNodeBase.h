@@ -41,6 +41,9 @@ public:
 	// Gets the node to be used for classification
 	void GetClassifyNode( const CFloatVectorDesc& data, CPtr<CDecisionTreeNodeBase>& node, int& level ) const;
 	void GetClassifyNode( const CFloatVector& data, CPtr<CDecisionTreeNodeBase>& node, int& level ) const;
+	// Doesn't change the reference counters of the nodes, so may be used by several threads at once
+	const CDecisionTreeNodeBase* GetClassifyNode( const CFloatVectorDesc& data ) const;
+	const CDecisionTreeNodeBase* GetClassifyNode( const CFloatVectorDesc& data, int& level ) const;
 
 protected:
 	~CDecisionTreeNodeBase() override; // delete operator prohibited
@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <DecisionTreeNodeClassificationStatistic.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -41,41 +42,44 @@ CClassificationStatistics::CClassificationStatistics( CDecisionTreeNodeBase* _no
 	discretizationIntervals.SetSize( usedFeatures.Size() );
 }
 
-void CClassificationStatistics::AddVector( int index, const CFloatVectorDesc& vector )
+void CClassificationStatistics::AddVector( int index )
 {
 	NeoAssert( problem != 0 );
+	totalStatistics.AddVectorSet( 1, problem->GetClass( index ), problem->GetVectorWeight( index ) );
+}
+
+void CClassificationStatistics::AddFeatureValue( int index, int feature, float value )
+{
+	NeoAssert( problem != 0 );
+	const int featureNumber = usedFeatureNumber[feature];
+	if( featureNumber == NotFound || value == 0.0 ) {
+		return;
+	}
 	const double weight = problem->GetVectorWeight( index );
 	const int classIndex = problem->GetClass( index );
-	for( int i = 0; i < vector.Size; i++ ) {
-		if( vector.Values[i] != 0.0 ) {
-			const int index = vector.Indexes == nullptr ? i : vector.Indexes[i];
-			if( usedFeatureNumber[index] != NotFound ) {
-				addValue( usedFeatureNumber[index], vector.Values[i], 1, classIndex, weight );
-				featureStatistics[usedFeatureNumber[index]].AddVectorSet( 1, classIndex, weight );
-			}
-		}
-	}
-
-	totalStatistics.AddVectorSet( 1, classIndex, weight );
+	addValue( featureNumber, value, 1, classIndex, weight );
+	featureStatistics[featureNumber].AddVectorSet( 1, classIndex, weight );
 }
 
-void CClassificationStatistics::Finish()
+void CClassificationStatistics::FinishFeature( int feature )
 {
-	// We need also to add zero values for the features
+	const int featureNumber = usedFeatureNumber[feature];
+	if( featureNumber == NotFound ) {
+		return;
+	}
+
+	// We need also to add zero values for the feature
 	const CArray<double>& totalWeights = totalStatistics.Weights();
 	const CArray<int>& totalCounts = totalStatistics.Counts();
+	const CArray<double>& weights = featureStatistics[featureNumber].Weights();
+	const CArray<int>& counts = featureStatistics[featureNumber].Counts();
 
-	for( int i = 0; i < usedFeatures.Size(); i++ ) {
-		const CArray<double>& weights = featureStatistics[i].Weights();
-		const CArray<int>& counts = featureStatistics[i].Counts();
-
-		for( int j = 0; j < classCount; j++ ) {
-			if( totalCounts[j] - counts[j] > 0 ) {
-				addValue( i, 0, totalCounts[j] - counts[j], j, totalWeights[j] - weights[j] );
-			}
+	for( int j = 0; j < classCount; j++ ) {
+		if( totalCounts[j] - counts[j] > 0 ) {
+			addValue( featureNumber, 0, totalCounts[j] - counts[j], j, totalWeights[j] - weights[j] );
 		}
-		mergeIntervals( problem->GetDiscretizationValue( usedFeatures[i] ), discretizationIntervals[i] );
 	}
+	mergeIntervals( problem->GetDiscretizationValue( feature ), discretizationIntervals[featureNumber] );
 }
 
 size_t CClassificationStatistics::GetSize() const
@@ -101,21 +105,50 @@ bool CClassificationStatistics::GetSplit( CDecisionTree::CParams param,
 	criterionValue = totalStatistics.CalcCriterion( param.SplitCriterion );
 	featureIndex = NotFound;
 
-	CArray<double> splitValues;
-	for( int i = 0; i < discretizationIntervals.Size(); i++ ) {
-		double splitCriterionValue = 0;
-		const bool isDiscreteFeature = problem->IsDiscreteFeature( usedFeatures[i] );
-		if( isDiscreteFeature ) { 
-			splitCriterionValue = calcDiscreteSplitCriterion( param, discretizationIntervals[i], totalStatistics, splitValues );
-		} else {
-			splitCriterionValue = calcContinuousSplitCriterion( param, discretizationIntervals[i], totalStatistics, splitValues );
+	// Each thread looks for the best feature in its own range of features
+	// The ranges are then compared in order, so the result is the same for any number of threads
+	const int threadCount = max( 1, min( param.ThreadCount, discretizationIntervals.Size() ) );
+	CArray<double> threadCriterionValues;
+	threadCriterionValues.Add( criterionValue, threadCount );
+	CArray<int> threadFeatures;
+	threadFeatures.Add( NotFound, threadCount );
+	CArray<bool> threadIsDiscrete;
+	threadIsDiscrete.Add( false, threadCount );
+	CArray<CArray<double>> threadValues;
+	threadValues.SetSize( threadCount );
+
+	NEOML_OMP_NUM_THREADS( threadCount )
+	{
+		int start;
+		int count;
+		if( OmpGetTaskIndexAndCount( discretizationIntervals.Size(), start, count ) ) {
+			const int threadNumber = OmpGetThreadNum();
+			CArray<double> splitValues;
+			for( int i = start; i < start + count; i++ ) {
+				double splitCriterionValue = 0;
+				const bool isDiscreteFeature = problem->IsDiscreteFeature( usedFeatures[i] );
+				if( isDiscreteFeature ) {
+					splitCriterionValue = calcDiscreteSplitCriterion( param, discretizationIntervals[i], totalStatistics, splitValues );
+				} else {
+					splitCriterionValue = calcContinuousSplitCriterion( param, discretizationIntervals[i], totalStatistics, splitValues );
+				}
+
+				if( threadCriterionValues[threadNumber] > splitCriterionValue ) { // the split with a better criterion value is found
+					threadCriterionValues[threadNumber] = splitCriterionValue;
+					threadFeatures[threadNumber] = usedFeatures[i];
+					threadIsDiscrete[threadNumber] = isDiscreteFeature;
+					splitValues.CopyTo( threadValues[threadNumber] );
+				}
+			}
 		}
+	}
 
-		if( criterionValue > splitCriterionValue ) { // the split with a better criterion value is found
-			criterionValue = splitCriterionValue;
-			featureIndex = usedFeatures[i];
-			isDiscrete = isDiscreteFeature;
-			splitValues.CopyTo( values );
+	for( int i = 0; i < threadCount; i++ ) {
+		if( threadFeatures[i] != NotFound && criterionValue > threadCriterionValues[i] ) {
+			criterionValue = threadCriterionValues[i];
+			featureIndex = threadFeatures[i];
+			isDiscrete = threadIsDiscrete[i];
+			threadValues[i].CopyTo( values );
 		}
 	}
 
@@ -135,8 +135,9 @@ public:
 	explicit CClassificationStatistics( CDecisionTreeNodeBase* node, const IProblem& problem, const CArray<int>& usedFeatures );
 
 	// CDecisionTreeNodeStatisticBase interface methods
-	void AddVector( int index, const CFloatVectorDesc& vector ) override;
-	void Finish() override;
+	void AddVector( int index ) override;
+	void AddFeatureValue( int index, int feature, float value ) override;
+	void FinishFeature( int feature ) override;
 	size_t GetSize() const override;
 	bool GetSplit( CDecisionTree::CParams param,
 		bool& isDiscrete, int& featureIndex, CArray<double>& values, double& criterioValue ) const override;
@@ -25,10 +25,16 @@ public:
 	virtual ~CDecisionTreeNodeStatisticBase() = default;
 
 	// Adds a vector to the statistics
-	virtual void AddVector( int index, const CFloatVectorDesc& vector ) = 0;
+	// The non-zero feature values of the vector are added separately by AddFeatureValue
+	virtual void AddVector( int index ) = 0;
 
-	// Finishes accumulating data
-	virtual void Finish() = 0;
+	// Adds a non-zero value of the feature for the vector that was added by AddVector
+	// May be called for different features from several threads at once
+	virtual void AddFeatureValue( int index, int feature, float value ) = 0;
+
+	// Finishes accumulating data for the feature; should be called after all vectors and values have been added
+	// May be called for different features from several threads at once
+	virtual void FinishFeature( int feature ) = 0;
 
 	// Retrieves the size of accumulated data
 	virtual size_t GetSize() const = 0;
@@ -376,8 +376,13 @@ void CGradientBoost::createTreeBuilder( const IMultivariateRegressionProblem* pr
 			} else {
 				fastHistSingleClassTreeBuilder = FINE_DEBUG_NEW CGradientBoostFastHistTreeBuilder<CGradientBoostStatisticsSingle>( builderParams, logStream, 1 );
 			}
-			fastHistProblem = FINE_DEBUG_NEW CGradientBoostFastHistProblem( params.ThreadCount, params.MaxBins,
-				*problem, usedVectors, usedFeatures );
+			if( binnedProblem != nullptr ) {
+				// The bins are already built, the vector data stays in the mapped file
+				fastHistProblem = FINE_DEBUG_NEW CGradientBoostFastHistProblem( *binnedProblem, usedVectors, usedFeatures );
+			} else {
+				fastHistProblem = FINE_DEBUG_NEW CGradientBoostFastHistProblem( params.ThreadCount, params.MaxBins,
+					*problem, usedVectors, usedFeatures );
+			}
 			break;
 		}
 		default:
@@ -395,6 +400,7 @@ void CGradientBoost::destroyTreeBuilder()
 	fastHistMultiClassTreeBuilder.Release();
 	fastHistProblem.Release();
 	baseProblem.Release();
+	binnedProblem.Release();
 }
 
 // Creates a loss function based on CParam.LossFunction
@@ -732,6 +738,8 @@ void CGradientBoost::prepareProblem( const IRegressionProblem& _problem )
 void CGradientBoost::prepareProblem( const IMultivariateRegressionProblem& _problem )
 {
 	if( baseProblem == 0 ) {
+		// The binned problem contains no vectors with zero weight, so the view keeps the vector indices
+		binnedProblem = dynamic_cast<const CGradientBoostBinnedProblem*>( &_problem );
 		baseProblem = FINE_DEBUG_NEW CMultivariateRegressionProblemNotNullWeightsView( &_problem );
 		initialize();
 	}
@@ -0,0 +1,409 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <NeoML/TraditionalML/GradientBoostBinnedProblem.h>
+#include <NeoML/ArchiveFile.h>
+#include <GradientBoostFastHistProblem.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <climits>
+
+namespace NeoML {
+
+// The signature of the binned problem file
+static const unsigned int BinnedProblemSignature = 0x50424247; // "GBBP"
+static const int BinnedProblemVersion = 0;
+// The alignment of the file sections (in bytes)
+static const int BinnedProblemSectionAlignment = 64;
+// The maximum size of one write operation
+static const int BinnedProblemWriteChunkSize = 1 << 24;
+// The minimum number of distinct values kept for each feature while looking for the bins
+// If a feature has more values, they are grouped by weight (like the histogram bins)
+static const int BinnedProblemMinSummarySize = 4096;
+
+typedef CGradientBoostFastHistProblem::CFeatureValue CFeatureValue;
+
+// The positions of the binned problem file sections
+struct CBinnedProblemLayout {
+	__int64 FeaturePos;
+	__int64 NullValueIds;
+	__int64 Cuts;
+	__int64 IdVectorCounts;
+	__int64 Weights;
+	__int64 Values;
+	__int64 VectorPtr;
+	__int64 Columns;
+	__int64 ElementValues;
+	__int64 Ids;
+	__int64 End;
+
+	CBinnedProblemLayout( __int64 headerEnd, int featureCount, int valueSize, int vectorCount, int elementCount, int idCount );
+
+private:
+	static __int64 nextSection( __int64& position, __int64 size );
+};
+
+CBinnedProblemLayout::CBinnedProblemLayout( __int64 headerEnd, int featureCount, int valueSize, int vectorCount,
+	int elementCount, int idCount )
+{
+	__int64 position = headerEnd;
+	FeaturePos = nextSection( position, ( featureCount + 1LL ) * sizeof( int ) );
+	NullValueIds = nextSection( position, static_cast<__int64>( featureCount ) * sizeof( int ) );
+	Cuts = nextSection( position, static_cast<__int64>( idCount ) * sizeof( float ) );
+	IdVectorCounts = nextSection( position, static_cast<__int64>( idCount ) * sizeof( int ) );
+	Weights = nextSection( position, static_cast<__int64>( vectorCount ) * sizeof( double ) );
+	Values = nextSection( position, static_cast<__int64>( vectorCount ) * valueSize * sizeof( float ) );
+	VectorPtr = nextSection( position, ( vectorCount + 1LL ) * sizeof( int ) );
+	Columns = nextSection( position, static_cast<__int64>( elementCount ) * sizeof( int ) );
+	ElementValues = nextSection( position, static_cast<__int64>( elementCount ) * sizeof( float ) );
+	Ids = nextSection( position, static_cast<__int64>( elementCount ) * sizeof( int ) );
+	End = position;
+}
+
+// Places the section of the given size at the next aligned position
+__int64 CBinnedProblemLayout::nextSection( __int64& position, __int64 size )
+{
+	const __int64 start = ( position + BinnedProblemSectionAlignment - 1 )
+		/ BinnedProblemSectionAlignment * BinnedProblemSectionAlignment;
+	position = start + size;
+	return start;
+}
+
+// Writes the data to the file section and moves the section position
+static void writeSection( CArchiveFile& file, __int64& position, const void* data, __int64 size )
+{
+	file.Seek( position, CBaseFile::begin );
+	const char* ptr = static_cast<const char*>( data );
+	for( __int64 written = 0; written < size; written += BinnedProblemWriteChunkSize ) {
+		file.Write( ptr + written, static_cast<int>( min<__int64>( size - written, BinnedProblemWriteChunkSize ) ) );
+	}
+	position += size;
+}
+
+// Merges the sorted distinct values of a feature into its summary
+// If the summary gets too long, the neighboring values are grouped by weight
+static void mergeToSummary( const CArray<CFeatureValue>& values, int summarySize, CArray<CFeatureValue>& summary,
+	CArray<CFeatureValue>& buffer )
+{
+	if( values.IsEmpty() ) {
+		return;
+	}
+
+	buffer.SetSize( summary.Size() + values.Size() );
+	int size = 0;
+	int i = 0;
+	int j = 0;
+	while( i < summary.Size() || j < values.Size() ) {
+		CFeatureValue next;
+		if( j == values.Size() || ( i < summary.Size() && summary[i].Value < values[j].Value ) ) {
+			next = summary[i++];
+		} else if( i == summary.Size() || values[j].Value < summary[i].Value ) {
+			next = values[j++];
+		} else {
+			next = summary[i++];
+			next.Weight += values[j++].Weight;
+		}
+		buffer[size++] = next;
+	}
+	buffer.SetSize( size );
+
+	if( buffer.Size() > summarySize ) {
+		// Each group is represented by its largest value and keeps the total weight
+		double totalWeight = 0;
+		for( int k = 0; k < buffer.Size(); k++ ) {
+			totalWeight += buffer[k].Weight;
+		}
+		const double groupWeight = totalWeight / summarySize;
+		summary.SetSize( 0 );
+		double sumWeight = 0;
+		double currentGroupWeight = 0;
+		for( int k = 0; k < buffer.Size(); k++ ) {
+			sumWeight += buffer[k].Weight;
+			currentGroupWeight += buffer[k].Weight;
+			if( k + 1 == buffer.Size() || sumWeight >= ( summary.Size() + 1 ) * groupWeight ) {
+				CFeatureValue group;
+				group.Value = buffer[k].Value;
+				group.Weight = currentGroupWeight;
+				summary.Add( group );
+				currentGroupWeight = 0;
+			}
+		}
+	} else {
+		buffer.CopyTo( summary );
+	}
+}
+
+// Finds the bin of the feature value
+static inline int findBin( const float* cuts, const int* featurePos, int feature, float value )
+{
+	const float* valuePtr = cuts + featurePos[feature];
+	const int valueCount = featurePos[feature + 1] - featurePos[feature];
+	int pos = FindInsertionPoint<float, Ascending<float>, float>( value, valuePtr, valueCount );
+	if( pos > 0 && valuePtr[pos - 1] == value ) {
+		pos--;
+	}
+	return featurePos[feature] + pos;
+}
+
+void CGradientBoostBinnedProblem::Build( const IMultivariateRegressionChunkedProblem& problem, int maxBins,
+	const char* fileName, int threadCount )
+{
+	NeoAssert( maxBins > 1 );
+	NeoAssert( threadCount > 0 );
+
+	const int featureCount = problem.GetFeatureCount();
+	const int valueSize = problem.GetValueSize();
+	NeoAssert( featureCount > 0 );
+	NeoAssert( valueSize > 0 );
+
+	// Looking for the bins
+	const int summarySize = max( BinnedProblemMinSummarySize, 128 * maxBins );
+	CArray< CArray<CFeatureValue> > summaries;
+	summaries.SetSize( featureCount );
+	CArray< CArray<CFeatureValue> > chunkValues;
+	chunkValues.SetSize( featureCount );
+	double totalWeight = 0;
+	int vectorCount = 0;
+	__int64 elementCount = 0;
+	for( int chunkIndex = 0; chunkIndex < problem.GetChunkCount(); chunkIndex++ ) {
+		CPtr<const IMultivariateRegressionProblem> chunk = problem.GetChunk( chunkIndex );
+		NeoAssert( chunk != nullptr );
+		NeoAssert( chunk->GetFeatureCount() == featureCount );
+		NeoAssert( chunk->GetValueSize() == valueSize );
+		const CFloatMatrixDesc matrix = chunk->GetMatrix();
+
+		for( int i = 0; i < chunk->GetVectorCount(); i++ ) {
+			const double vectorWeight = chunk->GetVectorWeight( i );
+			if( vectorWeight == 0 ) {
+				continue;
+			}
+			CFloatVectorDesc vector;
+			matrix.GetRow( i, vector );
+			for( int j = 0; j < vector.Size; j++ ) {
+				if( vector.Values[j] != 0.0 ) {
+					const int index = vector.Indexes == nullptr ? j : vector.Indexes[j];
+					CFeatureValue newValue;
+					newValue.Value = vector.Values[j];
+					newValue.Weight = vectorWeight;
+					chunkValues[index].Add( newValue );
+					elementCount++;
+				}
+			}
+			totalWeight += vectorWeight;
+			vectorCount++;
+		}
+
+		NEOML_OMP_NUM_THREADS( threadCount )
+		{
+			CArray<CFeatureValue> buffer;
+			int index = 0;
+			int count = 0;
+			if( OmpGetTaskIndexAndCount( featureCount, index, count ) ) {
+				for( int i = index; i < index + count; i++ ) {
+					CGradientBoostFastHistProblem::MergeFeatureValues( chunkValues[i] );
+					mergeToSummary( chunkValues[i], summarySize, summaries[i], buffer );
+					chunkValues[i].SetSize( 0 );
+				}
+			}
+		}
+	}
+	NeoAssert( vectorCount > 0 );
+	NeoAssert( elementCount < INT_MAX );
+
+	CArray<int> featurePos;
+	CArray<float> cuts;
+	CArray<int> nullValueIds;
+	CGradientBoostFastHistProblem::BuildBins( threadCount, maxBins, totalWeight, summaries, featurePos, cuts, nullValueIds );
+	summaries.DeleteAll();
+	chunkValues.DeleteAll();
+	const int idCount = featurePos.Last();
+
+	// Writing the header
+	CArchiveFile file( fileName, CArchive::store );
+	{
+		CArchive archive( &file, CArchive::SD_Storing );
+		archive << BinnedProblemSignature;
+		archive.SerializeVersion( BinnedProblemVersion );
+		archive << featureCount << valueSize << vectorCount << static_cast<int>( elementCount ) << idCount;
+		archive.Close();
+	}
+	CBinnedProblemLayout layout( file.GetPosition(), featureCount, valueSize, vectorCount,
+		static_cast<int>( elementCount ), idCount );
+	CBinnedProblemLayout position = layout;
+
+	// Quantizing the vectors
+	CArray<int> idVectorCounts;
+	idVectorCounts.Add( 0, idCount );
+	CArray<double> chunkWeights;
+	CArray<float> chunkFunctionValues;
+	CArray<int> chunkVectors; // the indices of the chunk vectors with non-zero weight
+	CArray<int> chunkVectorPtr;
+	CArray<int> chunkColumns;
+	CArray<float> chunkElementValues;
+	CArray<int> chunkIds;
+	int vectorDataPtr = 0; // the position of the first element of the chunk
+	for( int chunkIndex = 0; chunkIndex < problem.GetChunkCount(); chunkIndex++ ) {
+		CPtr<const IMultivariateRegressionProblem> chunk = problem.GetChunk( chunkIndex );
+		const CFloatMatrixDesc matrix = chunk->GetMatrix();
+
+		chunkVectors.SetSize( 0 );
+		chunkWeights.SetSize( 0 );
+		for( int i = 0; i < chunk->GetVectorCount(); i++ ) {
+			const double vectorWeight = chunk->GetVectorWeight( i );
+			if( vectorWeight != 0 ) {
+				chunkVectors.Add( i );
+				chunkWeights.Add( vectorWeight );
+			}
+		}
+		const int chunkVectorCount = chunkVectors.Size();
+
+		// Counting the non-zero values of each vector
+		chunkFunctionValues.SetSize( chunkVectorCount * valueSize );
+		chunkVectorPtr.SetSize( chunkVectorCount + 1 );
+		chunkVectorPtr[0] = 0;
+		NEOML_OMP_FOR_NUM_THREADS( threadCount )
+		for( int i = 0; i < chunkVectorCount; i++ ) {
+			const CFloatVector value = chunk->GetValue( chunkVectors[i] );
+			NeoAssert( value.Size() == valueSize );
+			::memcpy( chunkFunctionValues.GetPtr() + i * valueSize, value.GetPtr(), valueSize * sizeof( float ) );
+
+			CFloatVectorDesc vector;
+			matrix.GetRow( chunkVectors[i], vector );
+			int nonZeroCount = 0;
+			for( int j = 0; j < vector.Size; j++ ) {
+				if( vector.Values[j] != 0.0 ) {
+					nonZeroCount++;
+				}
+			}
+			chunkVectorPtr[i + 1] = nonZeroCount;
+		}
+		for( int i = 0; i < chunkVectorCount; i++ ) {
+			chunkVectorPtr[i + 1] += chunkVectorPtr[i];
+		}
+
+		// Replacing the values by their bins
+		const int chunkElementCount = chunkVectorPtr.Last();
+		chunkColumns.SetSize( chunkElementCount );
+		chunkElementValues.SetSize( chunkElementCount );
+		chunkIds.SetSize( chunkElementCount );
+		NEOML_OMP_FOR_NUM_THREADS( threadCount )
+		for( int i = 0; i < chunkVectorCount; i++ ) {
+			CFloatVectorDesc vector;
+			matrix.GetRow( chunkVectors[i], vector );
+			int element = chunkVectorPtr[i];
+			for( int j = 0; j < vector.Size; j++ ) {
+				if( vector.Values[j] != 0.0 ) {
+					const int index = vector.Indexes == nullptr ? j : vector.Indexes[j];
+					const int id = findBin( cuts.GetPtr(), featurePos.GetPtr(), index, vector.Values[j] );
+					chunkColumns[element] = index;
+					chunkElementValues[element] = cuts[id];
+					chunkIds[element] = id;
+					element++;
+				}
+			}
+		}
+		for( int i = 0; i < chunkElementCount; i++ ) {
+			idVectorCounts[chunkIds[i]]++;
+		}
+		for( int i = 0; i <= chunkVectorCount; i++ ) {
+			chunkVectorPtr[i] += vectorDataPtr;
+		}
+		vectorDataPtr += chunkElementCount;
+
+		writeSection( file, position.Weights, chunkWeights.GetPtr(), chunkVectorCount * sizeof( double ) );
+		writeSection( file, position.Values, chunkFunctionValues.GetPtr(),
+			static_cast<__int64>( chunkFunctionValues.Size() ) * sizeof( float ) );
+		// The last position is written with the next chunk
+		writeSection( file, position.VectorPtr, chunkVectorPtr.GetPtr(), chunkVectorCount * sizeof( int ) );
+		writeSection( file, position.Columns, chunkColumns.GetPtr(), chunkElementCount * sizeof( int ) );
+		writeSection( file, position.ElementValues, chunkElementValues.GetPtr(), chunkElementCount * sizeof( float ) );
+		writeSection( file, position.Ids, chunkIds.GetPtr(), chunkElementCount * sizeof( int ) );
+	}
+	NeoAssert( vectorDataPtr == elementCount );
+
+	writeSection( file, position.VectorPtr, &vectorDataPtr, sizeof( int ) );
+	writeSection( file, position.FeaturePos, featurePos.GetPtr(), featurePos.Size() * sizeof( int ) );
+	writeSection( file, position.NullValueIds, nullValueIds.GetPtr(), nullValueIds.Size() * sizeof( int ) );
+	writeSection( file, position.Cuts, cuts.GetPtr(), cuts.Size() * sizeof( float ) );
+	writeSection( file, position.IdVectorCounts, idVectorCounts.GetPtr(), idVectorCounts.Size() * sizeof( int ) );
+	if( file.GetLength() < layout.End ) {
+		file.SetLength( layout.End );
+	}
+	file.Close();
+}
+
+CGradientBoostBinnedProblem::CGradientBoostBinnedProblem( const char* fileName )
+{
+	CMappedArchiveFile file( fileName );
+	mapping = file.GetMapping();
+	const char* data = file.GetData();
+
+	CArchive archive( &file, CArchive::SD_Loading );
+	unsigned int signature = 0;
+	archive >> signature;
+	check( signature == BinnedProblemSignature, ERR_BAD_ARCHIVE, archive.Name() );
+	archive.SerializeVersion( BinnedProblemVersion );
+	int elementCount = 0;
+	archive >> featureCount >> valueSize >> vectorCount >> elementCount >> idCount;
+	check( featureCount > 0 && valueSize > 0 && vectorCount > 0 && elementCount >= 0 && idCount >= featureCount,
+		ERR_BAD_ARCHIVE, archive.Name() );
+	const CBinnedProblemLayout layout( archive.GetPosition(), featureCount, valueSize, vectorCount, elementCount, idCount );
+	check( layout.End <= file.GetLength(), ERR_BAD_ARCHIVE, archive.Name() );
+
+	featurePos = reinterpret_cast<const int*>( data + layout.FeaturePos );
+	nullValueIds = reinterpret_cast<const int*>( data + layout.NullValueIds );
+	cuts = reinterpret_cast<const float*>( data + layout.Cuts );
+	idVectorCounts = reinterpret_cast<const int*>( data + layout.IdVectorCounts );
+	weights = reinterpret_cast<const double*>( data + layout.Weights );
+	values = reinterpret_cast<const float*>( data + layout.Values );
+	vectorPtr = reinterpret_cast<const int*>( data + layout.VectorPtr );
+	columns = reinterpret_cast<const int*>( data + layout.Columns );
+	elementValues = reinterpret_cast<const float*>( data + layout.ElementValues );
+	ids = reinterpret_cast<const int*>( data + layout.Ids );
+	check( featurePos[0] == 0 && featurePos[featureCount] == idCount && vectorPtr[0] == 0
+		&& vectorPtr[vectorCount] == elementCount, ERR_BAD_ARCHIVE, archive.Name() );
+	archive.Close();
+}
+
+CFloatMatrixDesc CGradientBoostBinnedProblem::GetMatrix() const
+{
+	// The mapping is copy-on-write, so the file is never changed through the matrix
+	CFloatMatrixDesc matrix;
+	matrix.Height = vectorCount;
+	matrix.Width = featureCount;
+	matrix.Columns = const_cast<int*>( columns );
+	matrix.Values = const_cast<float*>( elementValues );
+	matrix.PointerB = const_cast<int*>( vectorPtr );
+	matrix.PointerE = const_cast<int*>( vectorPtr + 1 );
+	return matrix;
+}
+
+double CGradientBoostBinnedProblem::GetVectorWeight( int index ) const
+{
+	NeoAssert( 0 <= index && index < vectorCount );
+	return weights[index];
+}
+
+CFloatVector CGradientBoostBinnedProblem::GetValue( int index ) const
+{
+	NeoAssert( 0 <= index && index < vectorCount );
+	CFloatVector result( valueSize );
+	::memcpy( result.CopyOnWrite(), values + static_cast<__int64>( index ) * valueSize, valueSize * sizeof( float ) );
+	return result;
+}
+
+} // namespace NeoML
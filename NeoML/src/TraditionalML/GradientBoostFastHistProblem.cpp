@@ -21,11 +21,23 @@ limitations under the License.
 
 namespace NeoML {
 
+// Copies the data to the array
+template<class T>
+static void copyToArray( const T* data, int size, CArray<T>& result )
+{
+	result.SetSize( size );
+	if( size > 0 ) {
+		::memcpy( result.GetPtr(), data, size * sizeof( T ) );
+	}
+}
+
 CGradientBoostFastHistProblem::CGradientBoostFastHistProblem( int threadCount, int maxBins,
 		const IMultivariateRegressionProblem& baseProblem,
 		const CArray<int>& _usedVectors, const CArray<int>& _usedFeatures ) :
 	usedVectors( _usedVectors ),
-	usedFeatures( _usedFeatures )
+	usedFeatures( _usedFeatures ),
+	vectorData( nullptr ),
+	vectorPtr( nullptr )
 {
 	CFloatMatrixDesc matrix = baseProblem.GetMatrix();
 	NeoAssert( matrix.Height == baseProblem.GetVectorCount() );
@@ -34,7 +46,23 @@ CGradientBoostFastHistProblem::CGradientBoostFastHistProblem( int threadCount, i
 	initializeFeatureInfo( threadCount, maxBins, matrix, baseProblem );
 
 	// Build vector data
-	buildVectorData( matrix );
+	buildVectorData( threadCount, matrix );
+}
+
+CGradientBoostFastHistProblem::CGradientBoostFastHistProblem( const CGradientBoostBinnedProblem& _binnedProblem,
+		const CArray<int>& _usedVectors, const CArray<int>& _usedFeatures ) :
+	usedVectors( _usedVectors ),
+	usedFeatures( _usedFeatures ),
+	vectorData( _binnedProblem.ids ),
+	vectorPtr( _binnedProblem.vectorPtr ),
+	binnedProblem( &_binnedProblem )
+{
+	const int featureCount = binnedProblem->GetFeatureCount();
+	copyToArray( binnedProblem->featurePos, featureCount + 1, featurePos );
+	copyToArray( binnedProblem->nullValueIds, featureCount, nullValueIds );
+	copyToArray( binnedProblem->cuts, binnedProblem->idCount, cuts );
+	copyToArray( binnedProblem->idVectorCounts, binnedProblem->idCount, idVectorCounts );
+	initializeFeatureIndexes();
 }
 
 const int* CGradientBoostFastHistProblem::GetUsedVectorDataPtr( int index ) const
@@ -42,7 +70,7 @@ const int* CGradientBoostFastHistProblem::GetUsedVectorDataPtr( int index ) cons
 	NeoAssert( index >= 0 );
 	NeoAssert( index < usedVectors.Size() );
 
-	return vectorData.GetPtr() + vectorPtr[usedVectors[index]];
+	return vectorData + vectorPtr[usedVectors[index]];
 }
 
 int CGradientBoostFastHistProblem::GetUsedVectorDataSize( int index ) const
@@ -63,10 +91,7 @@ void CGradientBoostFastHistProblem::initializeFeatureInfo( int threadCount, int
 	CArray< CArray<CFeatureValue> > featureValues; // the values of all features
 	featureValues.SetSize( featureCount );
 
-	CArray<double> featureWeights; // total weight of all vectors for which the current feature is not 0
-	featureWeights.Add( 0.0, featureCount );
 	double totalWeight = 0.0; // total weight of all vectors
-	int totalElementCount = 0; // total number of non-zero elements
 
 	// Adding the non-zero values
 	for( int i = 0; i < vectorCount; i++ ) {
@@ -76,7 +101,6 @@ void CGradientBoostFastHistProblem::initializeFeatureInfo( int threadCount, int
 
 		for( int j = 0; j < vector.Size; j++ ) {
 			if( vector.Values[j] != 0.0 ) {
-				++totalElementCount;
 				const int index = vector.Indexes == nullptr ? j : vector.Indexes[j];
 				if( featureValues[index].IsEmpty()
 					|| featureValues[index].Last().Value != vector.Values[j] )
@@ -88,47 +112,74 @@ void CGradientBoostFastHistProblem::initializeFeatureInfo( int threadCount, int
 				} else {
 					featureValues[index].Last().Weight += vectorWeight;
 				}
-				featureWeights[index] += vectorWeight;
 			}
 		}
 		totalWeight += vectorWeight;
 	}
 
-	vectorData.SetBufferSize( totalElementCount );
+	BuildBins( threadCount, maxBins, totalWeight, featureValues, featurePos, cuts, nullValueIds );
+	initializeFeatureIndexes();
+}
 
+// Initializes the indices of the features to which the identifiers belong
+void CGradientBoostFastHistProblem::initializeFeatureIndexes()
+{
+	featureIndexes.SetBufferSize( featurePos.Last() );
+	for( int i = 0; i + 1 < featurePos.Size(); i++ ) {
+		featureIndexes.Add( i, featurePos[i + 1] - featurePos[i] );
+	}
+}
+
+// Sorts the feature values and merges the same values
+void CGradientBoostFastHistProblem::MergeFeatureValues( CArray<CFeatureValue>& values )
+{
+	if( values.IsEmpty() ) {
+		return;
+	}
+	values.QuickSort< AscendingByMember<CFeatureValue, float, &CFeatureValue::Value> >();
+	int size = 1;
+	for( int j = 1; j < values.Size(); j++ ) {
+		if( values[j].Value == values[size - 1].Value ) {
+			values[size - 1].Weight += values[j].Weight;
+		} else {
+			size++;
+			values[size - 1] = values[j];
+		}
+	}
+	values.SetSize( size );
+}
+
+// Builds the histogram bins from the non-zero values of each feature
+void CGradientBoostFastHistProblem::BuildBins( int threadCount, int maxBins, double totalWeight,
+	CArray< CArray<CFeatureValue> >& featureValues, CArray<int>& featurePos, CArray<float>& cuts, CArray<int>& nullValueIds )
+{
 	// Adding the zero values
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
 	for( int i = 0; i < featureValues.Size(); i++ ) {
+		double featureWeight = 0; // total weight of all vectors for which the current feature is not 0
+		for( int j = 0; j < featureValues[i].Size(); j++ ) {
+			featureWeight += featureValues[i][j].Weight;
+		}
 		CFeatureValue newValue;
 		newValue.Value = 0;
-		newValue.Weight = totalWeight - featureWeights[i];
+		newValue.Weight = totalWeight - featureWeight;
 		featureValues[i].Add( newValue );
-	}
 
-	// Sorting and merging the same values
-	NEOML_OMP_FOR_NUM_THREADS( threadCount )
-	for( int i = 0; i < featureValues.Size(); i++ ) {
-		featureValues[i].QuickSort< AscendingByMember<CFeatureValue, float, &CFeatureValue::Value> >();
-		int size = 1;
-		for( int j = 1; j < featureValues[i].Size(); j++ ) {
-			if( featureValues[i][j].Value == featureValues[i][size - 1].Value ) {
-				featureValues[i][size - 1].Weight += featureValues[i][j].Weight;
-			} else {
-				size++;
-				featureValues[i][size - 1] = featureValues[i][j];
-			}
-		}
-		featureValues[i].SetSize( size );
+		// Sorting and merging the same values
+		MergeFeatureValues( featureValues[i] );
 	}
 
 	compressFeatureValues( threadCount, maxBins, totalWeight, featureValues );
 
-	// Initializing the internal arrays
+	// Initializing the bins
+	nullValueIds.Empty();
 	nullValueIds.Add( NotFound, featureValues.Size() );
-	featurePos.SetBufferSize( featureValues.Size() );
+	featurePos.Empty();
+	featurePos.SetBufferSize( featureValues.Size() + 1 );
+	cuts.Empty();
 	int curPos = 0;
 	for( int i = 0; i < featureValues.Size(); i++ ) {
 		featurePos.Add( curPos );
-		featureIndexes.Add( i, featureValues[i].Size() );
 		curPos += featureValues[i].Size();
 
 		for( int j = 0; j < featureValues[i].Size(); j++ ) {
@@ -186,34 +237,62 @@ void CGradientBoostFastHistProblem::compressFeatureValues( int threadCount, int
 }
 
 // Builds an array with vector data
-void CGradientBoostFastHistProblem::buildVectorData( const CFloatMatrixDesc& matrix )
+// Only the non-zero values are stored, the zero values are restored from the feature totals when building histograms
+void CGradientBoostFastHistProblem::buildVectorData( int threadCount, const CFloatMatrixDesc& matrix )
 {
 	const int vectorCount = matrix.Height;
-	
-	vectorPtr.SetBufferSize( vectorCount + 1 );
-	int curVectorPtr = 0;
+
+	// Counting the non-zero values of each vector
+	CArray<int>& vectorPtr = vectorPtrBuffer;
+	vectorPtr.SetSize( vectorCount + 1 );
+	vectorPtr[0] = 0;
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
 	for( int i = 0; i < vectorCount; i++ ) {
-		vectorPtr.Add( curVectorPtr );
 		CFloatVectorDesc vector;
 		matrix.GetRow( i, vector );
+		int nonZeroCount = 0;
+		for( int j = 0; j < vector.Size; j++ ) {
+			if( vector.Values[j] != 0.0 ) {
+				nonZeroCount++;
+			}
+		}
+		vectorPtr[i + 1] = nonZeroCount;
+	}
+	for( int i = 0; i < vectorCount; i++ ) {
+		vectorPtr[i + 1] += vectorPtr[i];
+	}
 
+	// Each vector is written to its own place, so the vectors may be processed independently
+	CArray<int>& vectorData = vectorDataBuffer;
+	vectorData.SetSize( vectorPtr.Last() );
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < vectorCount; i++ ) {
+		CFloatVectorDesc vector;
+		matrix.GetRow( i, vector );
+		int* vectorDataPtr = vectorData.GetPtr() + vectorPtr[i];
 		for( int j = 0; j < vector.Size; j++ ) {
 			if( vector.Values[j] != 0.0 ) {
-				++curVectorPtr;
 				const int index = vector.Indexes == nullptr ? j : vector.Indexes[j];
-				float* valuePtr = cuts.GetPtr() + featurePos[index]; // the pointer to this feature values
-				int valueCount = featurePos[index + 1] - featurePos[index]; // the number of different values for the feature
+				const float* valuePtr = cuts.GetPtr() + featurePos[index]; // the pointer to this feature values
+				const int valueCount = featurePos[index + 1] - featurePos[index]; // the number of different values for the feature
 				// Now we get the bin into which the current value falls
 				int pos = FindInsertionPoint<float, Ascending<float>, float>( vector.Values[j], valuePtr, valueCount );
 				if( pos > 0 && *(valuePtr + pos - 1) == vector.Values[j] ) {
 					pos--;
 				}
-				vectorData.Add( featurePos[index] + pos );
+				*vectorDataPtr++ = featurePos[index] + pos;
 			}
 		}
 	}
 
-	vectorPtr.Add( curVectorPtr );
+	// The number of vectors for each identifier (used to balance the threads load while building histograms)
+	idVectorCounts.Add( 0, featurePos.Last() );
+	for( int i = 0; i < vectorData.Size(); i++ ) {
+		idVectorCounts[vectorData[i]]++;
+	}
+
+	this->vectorData = vectorData.GetPtr();
+	this->vectorPtr = vectorPtr.GetPtr();
 }
 
 } // namespace NeoML
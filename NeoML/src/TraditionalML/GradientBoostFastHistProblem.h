@@ -16,6 +16,7 @@ limitations under the License.
 #pragma once
 
 #include <NeoML/TraditionalML/Problem.h>
+#include <NeoML/TraditionalML/GradientBoostBinnedProblem.h>
 
 namespace NeoML {
 
@@ -28,6 +29,22 @@ public:
 	CGradientBoostFastHistProblem( int threadCount, int maxBins,
 		const IMultivariateRegressionProblem& baseProblem,
 		const CArray<int>& usedVectors, const CArray<int>& usedFeatures );
+	// Uses the bins and the vector data of the binned problem without copying the vector data
+	CGradientBoostFastHistProblem( const CGradientBoostBinnedProblem& binnedProblem,
+		const CArray<int>& usedVectors, const CArray<int>& usedFeatures );
+
+	// A feature value
+	struct CFeatureValue {
+		float Value;
+		double Weight;
+	};
+
+	// Sorts the feature values and merges the same values
+	static void MergeFeatureValues( CArray<CFeatureValue>& values );
+	// Builds the histogram bins from the non-zero values of each feature
+	// The weight of the zero value is the total weight minus the weight of the non-zero values
+	static void BuildBins( int threadCount, int maxBins, double totalWeight, CArray< CArray<CFeatureValue> >& featureValues,
+		CArray<int>& featurePos, CArray<float>& cuts, CArray<int>& nullValueIds );
 
 	// Gets the number of vectors used
 	int GetUsedVectorCount() const { return usedVectors.Size(); }
@@ -48,18 +65,14 @@ public:
 	const CArray<float>& GetFeatureCuts() const { return cuts; }
 	// Gets the array of identifiers for zero feature values
 	const CArray<int>& GetFeatureNullValueId() const { return nullValueIds; }
+	// Gets the number of vectors that contain each identifier
+	const CArray<int>& GetIdVectorCounts() const { return idVectorCounts; }
 
 protected:
 	// delete prohibited
 	~CGradientBoostFastHistProblem() override = default;
 
 private:
-	// A feature value
-	struct CFeatureValue {
-		float Value;
-		double Weight;
-	};
-
 	// The vectors used
 	// For each vector in the subsample, the array contains the index it had in the full sample
 	// The array has N * CParams::Subsample elements, where N is the number of vectors in the full sample
@@ -73,14 +86,19 @@ private:
 	CArray<int> featureIndexes; // the indices of the feature to which the identifier belongs
 	CArray<float> cuts; // the cut values for histograms
 	CArray<int> nullValueIds; // the identifiers of the zero feature values
-	CArray<int> vectorData; // the vector data
-	CArray<int> vectorPtr; // the pointers to the data of the given vector
+	const int* vectorData; // the vector data
+	const int* vectorPtr; // the pointers to the data of the given vector
+	CArray<int> vectorDataBuffer; // the vector data if it is built from the matrix
+	CArray<int> vectorPtrBuffer; // the pointers to the data of the given vector if it is built from the matrix
+	CPtr<const CGradientBoostBinnedProblem> binnedProblem; // the problem that holds the vector data if it isn't built
+	CArray<int> idVectorCounts; // the number of vectors that contain the given identifier
 
 	void initializeFeatureInfo( int threadCount, int maxBins, const CFloatMatrixDesc& matrix,
 		const IMultivariateRegressionProblem& baseProblem );
-	void compressFeatureValues( int threadCount, int maxBins, double totalWeight,
+	static void compressFeatureValues( int threadCount, int maxBins, double totalWeight,
 		CArray< CArray<CFeatureValue> >& featureValues );
-	void buildVectorData( const CFloatMatrixDesc& matrix );
+	void initializeFeatureIndexes();
+	void buildVectorData( int threadCount, const CFloatMatrixDesc& matrix );
 };
 
 } // namespace NeoML
@@ -26,6 +26,7 @@ template<class T>
 CGradientBoostFastHistTreeBuilder<T>::CGradientBoostFastHistTreeBuilder( const CGradientBoostFastHistTreeBuilderParams& _params, CTextStream* _logStream, int _predictionSize ) :
 	params( _params ),
 	logStream( _logStream ),
+	threadPool( CreateThreadPool( _params.ThreadCount ) ),
 	predictionSize( _predictionSize  ),
 	histSize( NotFound )
 {
@@ -167,6 +168,41 @@ void CGradientBoostFastHistTreeBuilder<T>::initHistData( const CGradientBoostFas
 	for( int i = 0; i <= params.MaxTreeDepth; i++ ) {
 		freeHists.Add( i * histSize ); // a histogram is identified by the pointer to its start in the histData array
 	}
+
+	initThreadIdRanges( problem );
+}
+
+// Splits the identifiers into the ranges for building histograms in several threads
+// The ranges are balanced by the number of vector values that fall into them
+template<class T>
+void CGradientBoostFastHistTreeBuilder<T>::initThreadIdRanges( const CGradientBoostFastHistProblem& problem )
+{
+	const CArray<int>& idVectorCounts = problem.GetIdVectorCounts();
+	NeoAssert( idVectorCounts.Size() == idPos.Size() );
+
+	// The first range also calculates the total statistics of the node
+	int64_t totalCount = problem.GetUsedVectorCount();
+	for( int i = 0; i < idVectorCounts.Size(); i++ ) {
+		if( idPos[i] != NotFound ) {
+			totalCount += idVectorCounts[i];
+		}
+	}
+
+	threadIdRanges.SetSize( params.ThreadCount + 1 );
+	threadIdRanges[0] = 0;
+	int64_t currentCount = problem.GetUsedVectorCount();
+	int id = 0;
+	for( int i = 1; i < params.ThreadCount; i++ ) {
+		const int64_t rangeEndCount = totalCount * i / params.ThreadCount;
+		while( id < idVectorCounts.Size() && currentCount < rangeEndCount ) {
+			if( idPos[id] != NotFound ) {
+				currentCount += idVectorCounts[id];
+			}
+			id++;
+		}
+		threadIdRanges[i] = id;
+	}
+	threadIdRanges[params.ThreadCount] = idVectorCounts.Size();
 }
 
 // Gets a free histogram 
@@ -193,6 +229,7 @@ void CGradientBoostFastHistTreeBuilder<T>::freeHist( int ptr )
 template<class T>
 void CGradientBoostFastHistTreeBuilder<T>::subHist( int firstPtr, int secondPtr )
 {
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
 	for( int i = 0; i < histSize; i++ ) {
 		histStats[firstPtr + i].Sub( histStats[secondPtr + i] );
 	}
@@ -212,43 +249,31 @@ void CGradientBoostFastHistTreeBuilder<T>::buildHist( const CGradientBoostFastHi
 	totalStats.SetSize( predictionSize );
 	totalStats.Erase();
 
-	const bool isOmp = ( node.VectorSetSize > 4 * params.ThreadCount ); // check if using OpenMP makes sense
+	// check if using OpenMP makes sense
+	const bool isOmp = params.ThreadCount > 1 && node.VectorSetSize > 4 * params.ThreadCount;
 	if( isOmp ) {
 		// There are many vectors in the set, so we'll use several threads to build the histogram
-		CArray<T> results;
-		results.Add( T( predictionSize ), params.ThreadCount );
-
-		const int valueSize = histStatsPtr[0].ValueSize();
-		tempHistStats.SetSize( params.ThreadCount * histSize );
-		for( int i = 0; i < params.ThreadCount * histSize; i++ ) {
-			tempHistStats[i].SetSize( valueSize );
-			tempHistStats[i].Erase();
-		}
-
-		NEOML_OMP_NUM_THREADS(params.ThreadCount)
+		// Each thread fills its own range of identifiers, so no copies of the histogram are needed
+		// and the result doesn't depend on the number of threads
+		// A thread reads only its own slice of every vector
+		NEOML_OMP_NUM_THREADS( params.ThreadCount )
 		{
-			const int threadNumber = OmpGetThreadNum();
-			NeoAssert( threadNumber < params.ThreadCount );
-			int i = threadNumber;
-			while( i < node.VectorSetSize ) {
-				const int vectorIndex = vectorSet[node.VectorSetPtr + i];
-				addVectorToHist( problem.GetUsedVectorDataPtr( vectorIndex ), problem.GetUsedVectorDataSize( vectorIndex ),
-					gradients, hessians, weights, tempHistStats.GetPtr() + histSize * threadNumber, vectorIndex );
-				results[threadNumber].Add( gradients, hessians, weights, vectorIndex );
-				i += OmpGetThreadCount();
-			}
-		}
-
-		// Merge the threads' results
-		for( int i = 0; i < params.ThreadCount; i++ ) {
-			totalStats.Add( results[i] );
-		}
-
-		NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
-		for( int i = 0; i < histSize; i++ ) {
-			for( int j = 0; j < params.ThreadCount; j++ ) {
-				const int index = j * histSize + i;
-				histStatsPtr[i].Add( tempHistStats[index] );
+			for( int range = OmpGetThreadNum(); range < params.ThreadCount; range += OmpGetThreadCount() ) {
+				for( int i = 0; i < node.VectorSetSize; i++ ) {
+					const int vectorIndex = vectorSet[node.VectorSetPtr + i];
+					const int* vectorPtr = problem.GetUsedVectorDataPtr( vectorIndex );
+					const int vectorSize = problem.GetUsedVectorDataSize( vectorIndex );
+					// The identifiers in the vector data are sorted ascending, so the slice bounds are found by the binary search
+					const int sliceStart = range == 0 ? 0 : FindInsertionPoint<int, Ascending<int>, int>(
+						threadIdRanges[range] - 1, vectorPtr, vectorSize );
+					const int sliceEnd = range == params.ThreadCount - 1 ? vectorSize : FindInsertionPoint<int, Ascending<int>, int>(
+						threadIdRanges[range + 1] - 1, vectorPtr + sliceStart, vectorSize - sliceStart ) + sliceStart;
+					addVectorToHist( vectorPtr + sliceStart, sliceEnd - sliceStart,
+						gradients, hessians, weights, histStatsPtr, vectorIndex );
+					if( range == 0 ) {
+						totalStats.Add( gradients, hessians, weights, vectorIndex );
+					}
+				}
 			}
 		}
 	} else {
@@ -306,9 +331,7 @@ int CGradientBoostFastHistTreeBuilder<T>::evaluateSplit( const CGradientBoostFas
 	}
 
 	const CArray<int>& usedFeatures = problem.GetUsedFeatures();
-	const CArray<int>& featurePos = problem.GetFeaturePos();
 	double bestValue = node.Statistics.CalcCriterion( params.L1RegFactor, params.L2RegFactor );
-	const T* histStatsPtr = histStats.GetPtr() + node.HistPtr;
 
 	// Initializing the search results for each thread
 	// The default bestValue is the parent's Gain (the node is not split by default)
@@ -323,48 +346,20 @@ int CGradientBoostFastHistTreeBuilder<T>::evaluateSplit( const CGradientBoostFas
 		rightCandidates.Add( T( predictionSize ), params.ThreadCount );
 	}
 
-	NEOML_OMP_NUM_THREADS(params.ThreadCount)
-	{
-		const int threadNumber = OmpGetThreadNum();
-		NeoAssert( threadNumber < params.ThreadCount );
-		T leftCandidate( predictionSize );
-		T rightCandidate( predictionSize );
-
-		// Iterate through features (a separate subset for each thread)
-		for( int i = threadNumber; i < usedFeatures.Size(); i += params.ThreadCount ) {
-			T left( predictionSize ); // the gain for the left node after the split
-			T right( predictionSize ); // for the right node after the split (calculated as the complement to the parent)
-			const int firstFeatureIndex = featurePos[usedFeatures[i]];
-			const int lastFeatureIndex = featurePos[usedFeatures[i] + 1];
-			// Iterate through feature values (sorted ascending) looking for the split position
-			for( int j = firstFeatureIndex; j < lastFeatureIndex; j++ ) {
-				const T& featureStats = histStatsPtr[idPos[j]];
-				left.Add( featureStats );
-				right = node.Statistics;
-				right.Sub( left );
-				leftCandidate = left;
-				rightCandidate = right;
-
-				// Calculating the gain: if the node is split at this position, 
-				// the criterion loses the parent node (bestValue) and replaces it by left.CalcCriterion and right.CalcCriterion
-				// In the reference paper, a gamma coefficient is also needed for a new node, but we take that into account while pruning
-				double criterion;
-				if( !T::CalcCriterion( criterion, leftCandidate, rightCandidate, node.Statistics,
-					params.L1RegFactor, params.L2RegFactor, params.MinSubsetHessian, params.MinSubsetWeight, params.DenseTreeBoostCoefficient ) )
-				{
-					continue;
-				}
-
-				if( splitGainsByThread[threadNumber] < criterion ) {
-					splitGainsByThread[threadNumber] = criterion;
-					splitIds[threadNumber] = j;  // this number refers both to the feature and its value
-					// save statistics for childs for case when class if not splitting further
-					leftCandidates[threadNumber] = leftCandidate;
-					rightCandidates[threadNumber] = rightCandidate;
-				}
-			}
-		}
-	}
+	// The features have different numbers of values, so they are handed out to the threads dynamically
+	// The chunks are processed in ascending order, so each thread finds the first of its equally good splits
+	struct CSearchParams {
+		const CGradientBoostFastHistTreeBuilder<T>* Builder;
+		const CGradientBoostFastHistProblem* Problem;
+		const CNode* Node;
+	};
+	CSearchParams searchParams{ this, &problem, &node };
+	const int grain = max( 1, usedFeatures.Size() / ( 16 * params.ThreadCount ) );
+	ParallelFor( *threadPool, usedFeatures.Size(), grain, &searchParams,
+		[]( int threadIndex, void* ptr, int begin, int end ) {
+			const CSearchParams& search = *static_cast<const CSearchParams*>( ptr );
+			search.Builder->evaluateFeatureSplits( *search.Problem, *search.Node, begin, end, threadIndex );
+		} );
 
 	// Choose the best result over all threads
 	int result = NotFound;
@@ -381,6 +376,55 @@ int CGradientBoostFastHistTreeBuilder<T>::evaluateSplit( const CGradientBoostFas
 	return result;
 }
 
+// Looks for the best split over the [firstFeature, lastFeature) range of the used features
+// The results are written to the search buffers of the given thread
+template<class T>
+void CGradientBoostFastHistTreeBuilder<T>::evaluateFeatureSplits( const CGradientBoostFastHistProblem& problem,
+	const CNode& node, int firstFeature, int lastFeature, int threadIndex ) const
+{
+	NeoAssert( threadIndex < params.ThreadCount );
+
+	const CArray<int>& usedFeatures = problem.GetUsedFeatures();
+	const CArray<int>& featurePos = problem.GetFeaturePos();
+	const T* histStatsPtr = histStats.GetPtr() + node.HistPtr;
+	T leftCandidate( predictionSize );
+	T rightCandidate( predictionSize );
+
+	for( int i = firstFeature; i < lastFeature; i++ ) {
+		T left( predictionSize ); // the gain for the left node after the split
+		T right( predictionSize ); // for the right node after the split (calculated as the complement to the parent)
+		const int firstFeatureIndex = featurePos[usedFeatures[i]];
+		const int lastFeatureIndex = featurePos[usedFeatures[i] + 1];
+		// Iterate through feature values (sorted ascending) looking for the split position
+		for( int j = firstFeatureIndex; j < lastFeatureIndex; j++ ) {
+			const T& featureStats = histStatsPtr[idPos[j]];
+			left.Add( featureStats );
+			right = node.Statistics;
+			right.Sub( left );
+			leftCandidate = left;
+			rightCandidate = right;
+
+			// Calculating the gain: if the node is split at this position, 
+			// the criterion loses the parent node (bestValue) and replaces it by left.CalcCriterion and right.CalcCriterion
+			// In the reference paper, a gamma coefficient is also needed for a new node, but we take that into account while pruning
+			double criterion;
+			if( !T::CalcCriterion( criterion, leftCandidate, rightCandidate, node.Statistics,
+				params.L1RegFactor, params.L2RegFactor, params.MinSubsetHessian, params.MinSubsetWeight, params.DenseTreeBoostCoefficient ) )
+			{
+				continue;
+			}
+
+			if( splitGainsByThreadBuffer[threadIndex] < criterion ) {
+				splitGainsByThreadBuffer[threadIndex] = criterion;
+				splitIdsBuffer[threadIndex] = j;  // this number refers both to the feature and its value
+				// save statistics for childs for case when class if not splitting further
+				leftCandidates[threadIndex] = leftCandidate;
+				rightCandidates[threadIndex] = rightCandidate;
+			}
+		}
+	}
+}
+
 // Splits a node
 template<class T>
 void CGradientBoostFastHistTreeBuilder<T>::applySplit( const CGradientBoostFastHistProblem& problem, int node,
@@ -19,6 +19,8 @@ limitations under the License.
 #include <GradientBoostStatisticsSingle.h>
 #include <GradientBoostStatisticsMulti.h>
 #include <NeoML/TraditionalML/Model.h>
+#include <NeoMathEngine/ThreadPool.h>
+#include <memory>
 
 namespace NeoML {
 
@@ -55,6 +57,8 @@ protected:
 private:
 	const CGradientBoostFastHistTreeBuilderParams params; // classifier parameters
 	CTextStream* const logStream; // the logging stream
+	// The pool for the loops with uneven iterations (the features have different numbers of values)
+	const std::unique_ptr<IThreadPool> threadPool;
 
 	// A node in the tree
 	struct CNode {
@@ -91,7 +95,9 @@ private:
 	CArray<int> freeHists; // free histograms list
 	CArray<T> histStats; // the array for storing histograms
 	CArray<int> idPos; // the identifier positions in the current histogram
-	CArray<T> tempHistStats; // a temporary array for building histograms
+	// The boundaries of the identifier ranges for building histograms in several threads
+	// The i-th range starts at threadIdRanges[i] and ends at threadIdRanges[i + 1]
+	CArray<int> threadIdRanges;
 
 	// Caching the buffers
 	mutable CArray<double> splitGainsByThreadBuffer;
@@ -103,6 +109,7 @@ private:
 	void initHistData( const CGradientBoostFastHistProblem& problem );
 	int allocHist();
 	void freeHist( int ptr );
+	void initThreadIdRanges( const CGradientBoostFastHistProblem& problem );
 	void subHist( int firstPtr, int secondPtr );
 	void buildHist( const CGradientBoostFastHistProblem& problem, const CNode& node,
 		const CArray<typename T::Type>& gradients, const CArray<typename T::Type>& hessians, const CArray<double>& weights,
@@ -110,6 +117,8 @@ private:
 	void addVectorToHist( const int* vectorPtr, int vectorSize, const CArray<typename T::Type>& gradients, 
 		const CArray<typename T::Type>& hessians, const CArray<double>& weights, T* stats, int vectorIndex );
 	int evaluateSplit( const CGradientBoostFastHistProblem& problem, CNode& node ) const;
+	void evaluateFeatureSplits( const CGradientBoostFastHistProblem& problem, const CNode& node,
+		int firstFeature, int lastFeature, int threadIndex ) const;
 	void applySplit( const CGradientBoostFastHistProblem& problem, int node, int& leftNode, int& rightNode );
 	bool prune( int node );
 	CPtr<CLinkedRegressionTree> buildTree( int node, const CArray<int>& featureIndexes, const CArray<float>& cuts ) const;
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <GradientBoostModel.h>
 #include <CompactRegressionTree.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -52,6 +53,24 @@ bool CGradientBoostModel::Classify( const CFloatVectorDesc& data, CClassificatio
 	return classify( predictions, result );
 }
 
+bool CGradientBoostModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	results.SetSize( data.Height );
+	const int size = predictionSize();
+	processBatch( data, threadCount, [&]( int firstRow, int rowCount, const CArray<double>& predictions ) {
+		CFastArray<double, 1> rowPredictions;
+		rowPredictions.SetSize( size );
+		for( int i = 0; i < rowCount; i++ ) {
+			for( int j = 0; j < size; j++ ) {
+				rowPredictions[j] = predictions[i * size + j];
+			}
+			classify( rowPredictions, results[firstRow + i] );
+		}
+	} );
+	return true;
+}
+
 void CGradientBoostModel::Serialize( CArchive& archive )
 {
 #ifdef NEOML_USE_FINEOBJ
@@ -243,6 +262,17 @@ double CGradientBoostModel::Predict( const CFloatVectorDesc& data ) const
 	return predictions[0];
 }
 
+void CGradientBoostModel::PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount ) const
+{
+	NeoAssert( ensembles.Size() == 1 && valueSize == 1 );
+	results.SetSize( data.Height );
+	processBatch( data, threadCount, [&]( int firstRow, int rowCount, const CArray<double>& predictions ) {
+		for( int i = 0; i < rowCount; i++ ) {
+			results[firstRow + i] = predictions[i];
+		}
+	} );
+}
+
 // IMultivariateRegressionModel interface method
 CFloatVector CGradientBoostModel::MultivariatePredict( const CFloatVectorDesc& data ) const
 {
@@ -269,6 +299,83 @@ CFloatVector CGradientBoostModel::MultivariatePredict( const CFloatVectorDesc& d
 	return result;
 }
 
+int CGradientBoostModel::MultivariatePredictBatch( const CFloatMatrixDesc& data, CArray<float>& results,
+	int threadCount ) const
+{
+	const int size = predictionSize();
+	results.SetSize( data.Height * size );
+	processBatch( data, threadCount, [&]( int firstRow, int rowCount, const CArray<double>& predictions ) {
+		float* rowResults = results.GetPtr() + firstRow * size;
+		for( int i = 0; i < rowCount * size; i++ ) {
+			rowResults[i] = static_cast<float>( predictions[i] );
+		}
+	} );
+	return size;
+}
+
+// The number of rows processed together: each tree is applied to all the rows of the block while it is in cache
+static const int PredictionBlockSize = 64;
+
+// Splits the rows between the threads and calls processBlock for the predictions of each block of rows
+template<typename TProcessBlock>
+void CGradientBoostModel::processBatch( const CFloatMatrixDesc& data, int threadCount,
+	const TProcessBlock& processBlock ) const
+{
+	NeoAssert( threadCount > 0 );
+	NeoAssert( !ensembles.IsEmpty() );
+
+	NEOML_OMP_NUM_THREADS( threadCount )
+	{
+		int firstRow = 0;
+		int rowCount = 0;
+		if( OmpGetTaskIndexAndCount( data.Height, PredictionBlockSize, firstRow, rowCount ) ) {
+			CArray<double> predictions;
+			CRegressionTree::CPrediction treePrediction;
+			for( int blockStart = firstRow; blockStart < firstRow + rowCount; blockStart += PredictionBlockSize ) {
+				const int blockSize = min( PredictionBlockSize, firstRow + rowCount - blockStart );
+				predictBlock( data, blockStart, blockSize, predictions, treePrediction );
+				processBlock( blockStart, blockSize, predictions );
+			}
+		}
+	}
+}
+
+// Calculates the raw predictions for the rows [firstRow, firstRow + rowCount)
+// The predictions of the row are stored one after another
+void CGradientBoostModel::predictBlock( const CFloatMatrixDesc& data, int firstRow, int rowCount,
+	CArray<double>& predictions, CRegressionTree::CPrediction& treePrediction ) const
+{
+	const int size = predictionSize();
+	predictions.SetSize( rowCount * size );
+	for( int i = 0; i < predictions.Size(); i++ ) {
+		predictions[i] = 0;
+	}
+
+	CFloatVectorDesc row;
+	for( int ensembleIndex = 0; ensembleIndex < ensembles.Size(); ensembleIndex++ ) {
+		const CGradientBoostEnsemble& ensemble = ensembles[ensembleIndex];
+		for( int treeIndex = 0; treeIndex < ensemble.Size(); treeIndex++ ) {
+			const CRegressionTree* tree = static_cast<const CRegressionTree*>( ensemble[treeIndex].Ptr() );
+			for( int i = 0; i < rowCount; i++ ) {
+				data.GetRow( firstRow + i, row );
+				if( ensembles.Size() > 1 || valueSize == 1 ) {
+					predictions[i * size + ensembleIndex] += tree->Predict( row );
+				} else {
+					tree->Predict( row, treePrediction );
+					NeoPresume( treePrediction.Size() == size );
+					for( int j = 0; j < size; j++ ) {
+						predictions[i * size + j] += treePrediction[j];
+					}
+				}
+			}
+		}
+	}
+
+	for( int i = 0; i < predictions.Size(); i++ ) {
+		predictions[i] *= learningRate;
+	}
+}
+
 // Performs classification
 bool CGradientBoostModel::classify( CFastArray<double, 1>& predictions, CClassificationResult& result ) const
 {
@@ -39,6 +39,8 @@ public:
 	// IModel interface methods
 	int GetClassCount() const override { return ( valueSize == 1 && ensembles.Size() == 1 ) ? 2 : valueSize * ensembles.Size(); }
 	bool Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const override;
+	bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const override;
 	void Serialize( CArchive& archive ) override;
 
 	// IGradientBoostModel inteface methods
@@ -53,9 +55,12 @@ public:
 
 	// IRegressionModel interface methods
 	double Predict( const CFloatVectorDesc& data ) const override;
+	void PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount = 1 ) const override;
 
 	// IMultivariateRegressionModel interface methods
 	CFloatVector MultivariatePredict( const CFloatVectorDesc& data ) const override;
+	int MultivariatePredictBatch( const CFloatMatrixDesc& data, CArray<float>& results,
+		int threadCount = 1 ) const override;
 
 private:
 	CArray<CGradientBoostEnsemble> ensembles; // the models
@@ -63,6 +68,11 @@ private:
 	CGradientBoost::TLossFunction lossFunction; // the loss function to be optimized
 	int valueSize; // the value size of each model, if valueSize > 1 then ensemble consists of multiclass trees
 
+	int predictionSize() const { return ensembles.Size() > 1 ? ensembles.Size() : valueSize; }
+	template<typename TProcessBlock>
+	void processBatch( const CFloatMatrixDesc& data, int threadCount, const TProcessBlock& processBlock ) const;
+	void predictBlock( const CFloatMatrixDesc& data, int firstRow, int rowCount, CArray<double>& predictions,
+		CRegressionTree::CPrediction& treePrediction ) const;
 	bool classify( CFastArray<double, 1>& predictions, CClassificationResult& result ) const;
 	double probability( double prediction ) const;
 };
@@ -28,12 +28,16 @@ limitations under the License.
 //		So we don't need to pass zero feature values to the algorithm because the bit mask does not change anyway. 
 //		For inverted nodes the < operator is changed to >=, so we use two mask sets: for inverted and non-inverted nodes, 
 //		search in both sets and merge the results.
+//		  The batch prediction uses the block-wise variant of the algorithm (BWQS): the trees are split into blocks
+//		that fit into L2 cache, and each block is applied to a small batch of documents at once.
+//		The node criteria are checked for all the documents of the batch by branchless loops that are vectorized by the compiler.
 
 #include <common.h>
 #pragma hdrstop
 
 #include <GradientBoostQSEnsemble.h>
 #include <SerializeCompact.h>
+#include <limits>
 
 namespace NeoML {
 
@@ -298,6 +302,7 @@ void CGradientBoostQSEnsemble::Build( const CGradientBoostEnsemble &treeModel )
 
 	// Find the offsets for nodes of each feature
 	buildFeatureNodesOffsets( features );
+	buildTreeBlocks( features );
 }
 
 double CGradientBoostQSEnsemble::Predict( const CFloatVectorDesc& data ) const
@@ -554,6 +559,7 @@ void CGradientBoostQSEnsemble::load( CArchive& archive )
 
 	// Find the offsets for each feature nodes
 	buildFeatureNodesOffsets( features );
+	buildTreeBlocks( features );
 }
 
 // Reads from archive a node in the optimized subtree
@@ -736,6 +742,199 @@ void CGradientBoostQSEnsemble::processFeature( int featureIndex, float value, CF
 	}
 }
 
+// The number of documents processed together by the batch prediction
+static const int QSBatchSize = 16;
+// The memory size of a tree block in bytes (a half of the typical L2 cache)
+static const int QSTreeBlockCacheSize = 128 * 1024;
+
+// Splits the trees into blocks and distributes the optimized nodes between them
+void CGradientBoostQSEnsemble::buildTreeBlocks( const CArray<int>& features )
+{
+	// Number the used features in ascending order
+	int maxFeature = NotFound;
+	for( int i = 0; i < qsNodes.Size(); i++ ) {
+		maxFeature = max( maxFeature, features[treeQsLeavesOffsets[qsNodes[i].Tree] + qsNodes[i].Order] );
+	}
+	featureSlots.Empty();
+	featureSlots.Add( NotFound, maxFeature + 1 );
+	for( int i = 0; i < qsNodes.Size(); i++ ) {
+		featureSlots[features[treeQsLeavesOffsets[qsNodes[i].Tree] + qsNodes[i].Order]] = 0;
+	}
+	usedFeatures.Empty();
+	for( int i = 0; i < featureSlots.Size(); i++ ) {
+		if( featureSlots[i] != NotFound ) {
+			featureSlots[i] = usedFeatures.Size();
+			usedFeatures.Add( i );
+		}
+	}
+
+	// Split the trees into blocks
+	treeBlocks.DeleteAll();
+	CArray<int> treeBlockIndices;
+	treeBlockIndices.SetSize( GetTreesCount() );
+	int blockSize = 0;
+	for( int i = 0; i < GetTreesCount(); i++ ) {
+		const int leafCount = ( i + 1 < GetTreesCount() ? treeQsLeavesOffsets[i + 1] : qsLeaves.Size() )
+			- treeQsLeavesOffsets[i];
+		const int treeSize = static_cast<int>( leafCount * sizeof( CQSLeaf ) + ( leafCount - 1 ) * sizeof( CQSNode )
+			+ QSBatchSize * sizeof( unsigned __int64 ) );
+		if( treeBlocks.IsEmpty() || blockSize + treeSize > QSTreeBlockCacheSize ) {
+			treeBlocks.Add( FINE_DEBUG_NEW CQSTreeBlock( i, 0 ) );
+			blockSize = 0;
+		}
+		treeBlocks.Last()->TreeCount++;
+		blockSize += treeSize;
+		treeBlockIndices[i] = treeBlocks.Size() - 1;
+	}
+
+	// Distribute the nodes keeping their order
+	// The nodes are sorted by features twice (for non-inverted and for inverted nodes),
+	// so the position of the next feature in the block is searched for starting from the previous one
+	CArray<int> featurePositions;
+	featurePositions.Add( 0, treeBlocks.Size() );
+	bool isInvertedPart = false;
+	for( int i = 0; i < qsNodes.Size(); i++ ) {
+		const CQSNode& node = qsNodes[i];
+		const bool isInverted = HasFlag( node.PropertiesMask, PM_Inverted );
+		if( isInverted != isInvertedPart ) {
+			featurePositions.DeleteAll();
+			featurePositions.Add( 0, treeBlocks.Size() );
+			isInvertedPart = isInverted;
+		}
+
+		const int blockIndex = treeBlockIndices[node.Tree];
+		CQSTreeBlock& block = *treeBlocks[blockIndex];
+		const int slot = featureSlots[features[treeQsLeavesOffsets[node.Tree] + node.Order]];
+		int& position = featurePositions[blockIndex];
+		while( position < block.FeatureSlots.Size() && block.FeatureSlots[position] < slot ) {
+			position++;
+		}
+		if( position == block.FeatureSlots.Size() || block.FeatureSlots[position] != slot ) {
+			block.FeatureSlots.InsertAt( slot, position );
+			block.FeatureOffsets.InsertAt( CQSNodeOffset(), position );
+		}
+
+		CInterval& interval = isInverted ? block.FeatureOffsets[position].More : block.FeatureOffsets[position].Less;
+		if( interval.Begin == NotFound ) {
+			interval.Begin = block.Nodes.Size();
+		}
+		interval.End = block.Nodes.Size();
+		block.Nodes.Add( node );
+	}
+}
+
+void CGradientBoostQSEnsemble::PredictBatch( const CFloatMatrixDesc& data, int firstRow, int rowCount,
+	CQSBatchBuffers& buffers, double* predictions ) const
+{
+	NeoAssert( firstRow >= 0 && rowCount >= 0 && firstRow + rowCount <= data.Height );
+
+	int maxBlockTreeCount = 0;
+	for( int i = 0; i < treeBlocks.Size(); i++ ) {
+		maxBlockTreeCount = max( maxBlockTreeCount, treeBlocks[i]->TreeCount );
+	}
+	buffers.FeatureValues.SetSize( usedFeatures.Size() * QSBatchSize );
+	buffers.Bitvectors.SetSize( maxBlockTreeCount * QSBatchSize );
+	buffers.Scores.SetSize( QSBatchSize );
+	buffers.Rows.SetSize( QSBatchSize );
+
+	for( int batchStart = firstRow; batchStart < firstRow + rowCount; batchStart += QSBatchSize ) {
+		const int batchSize = min( QSBatchSize, firstRow + rowCount - batchStart );
+		for( int i = 0; i < batchSize; i++ ) {
+			data.GetRow( batchStart + i, buffers.Rows[i] );
+			buffers.Scores[i] = 0;
+		}
+		fillBatchFeatureValues( batchSize, buffers );
+		for( int i = 0; i < treeBlocks.Size(); i++ ) {
+			processBlock( *treeBlocks[i], batchSize, buffers );
+		}
+		for( int i = 0; i < batchSize; i++ ) {
+			predictions[batchStart - firstRow + i] = buffers.Scores[i];
+		}
+	}
+}
+
+// Gathers the values of the used features for the batch
+// The features absent in the vector are set to NaN: all the node criteria are false for them
+// and the masks don't change, as in the case of a single vector when the absent features are not processed
+void CGradientBoostQSEnsemble::fillBatchFeatureValues( int batchSize, CQSBatchBuffers& buffers ) const
+{
+	float* values = buffers.FeatureValues.GetPtr();
+	const float missing = std::numeric_limits<float>::quiet_NaN();
+	for( int i = 0; i < buffers.FeatureValues.Size(); i++ ) {
+		values[i] = missing;
+	}
+
+	for( int doc = 0; doc < batchSize; doc++ ) {
+		const CFloatVectorDesc& row = buffers.Rows[doc];
+		if( row.Indexes == nullptr ) {
+			for( int slot = 0; slot < usedFeatures.Size() && usedFeatures[slot] < row.Size; slot++ ) {
+				values[slot * QSBatchSize + doc] = row.Values[usedFeatures[slot]];
+			}
+		} else {
+			for( int i = 0; i < row.Size; i++ ) {
+				const int feature = row.Indexes[i];
+				if( feature < featureSlots.Size() && featureSlots[feature] != NotFound ) {
+					values[featureSlots[feature] * QSBatchSize + doc] = row.Values[i];
+				}
+			}
+		}
+	}
+}
+
+// Applies the block of trees to the batch and adds the results to the scores
+void CGradientBoostQSEnsemble::processBlock( const CQSTreeBlock& block, int batchSize, CQSBatchBuffers& buffers ) const
+{
+	unsigned __int64* bitvectors = buffers.Bitvectors.GetPtr();
+	memset( bitvectors, ~0, block.TreeCount * QSBatchSize * sizeof( unsigned __int64 ) );
+
+	for( int i = 0; i < block.FeatureSlots.Size(); i++ ) {
+		const float* values = buffers.FeatureValues.GetPtr() + block.FeatureSlots[i] * QSBatchSize;
+		// The node traversal stops when the criterion is fulfilled for all the documents
+		float minValue = FLT_MAX;
+		float maxValue = -FLT_MAX;
+		for( int doc = 0; doc < batchSize; doc++ ) {
+			minValue = values[doc] < minValue ? values[doc] : minValue;
+			maxValue = values[doc] > maxValue ? values[doc] : maxValue;
+		}
+
+		const CQSNodeOffset& offset = block.FeatureOffsets[i];
+		if( offset.Less.Begin != NotFound ) {
+			for( int j = offset.Less.Begin; j <= offset.Less.End && block.Nodes[j].Threshold < maxValue; j++ ) {
+				const CQSNode& node = block.Nodes[j];
+				unsigned __int64* treeBitvectors = bitvectors + ( node.Tree - block.FirstTree ) * QSBatchSize;
+				for( int doc = 0; doc < QSBatchSize; doc++ ) {
+					const unsigned __int64 isApplied = 0 - static_cast<unsigned __int64>( node.Threshold < values[doc] );
+					treeBitvectors[doc] &= node.Mask | ~isApplied;
+				}
+			}
+		}
+		if( offset.More.Begin != NotFound ) {
+			for( int j = offset.More.Begin; j <= offset.More.End && block.Nodes[j].Threshold >= minValue; j++ ) {
+				const CQSNode& node = block.Nodes[j];
+				unsigned __int64* treeBitvectors = bitvectors + ( node.Tree - block.FirstTree ) * QSBatchSize;
+				for( int doc = 0; doc < QSBatchSize; doc++ ) {
+					const unsigned __int64 isApplied = 0 - static_cast<unsigned __int64>( node.Threshold >= values[doc] );
+					treeBitvectors[doc] &= node.Mask | ~isApplied;
+				}
+			}
+		}
+	}
+
+	// The trees are processed in the same order as for a single vector, so the scores are the same
+	for( int i = 0; i < block.TreeCount; i++ ) {
+		const CQSLeaf* leaves = qsLeaves.GetPtr() + treeQsLeavesOffsets[block.FirstTree + i];
+		const unsigned __int64* treeBitvectors = bitvectors + i * QSBatchSize;
+		for( int doc = 0; doc < batchSize; doc++ ) {
+			const CQSLeaf& leaf = leaves[findLowestBitIndex( treeBitvectors[doc] )];
+			if( leaf.SimpleNodeIndex == NotFound ) {
+				buffers.Scores[doc] += leaf.Value;
+			} else {
+				buffers.Scores[doc] += calculateSimpleSubtreeValue( buffers.Rows[doc], leaf.SimpleNodeIndex );
+			}
+		}
+	}
+}
+
 static inline float getFeatureValue( const CFloatVectorDesc& data, int index )
 {
 	float result;
@@ -762,19 +961,23 @@ double CGradientBoostQSEnsemble::calculateScore( const CFloatVectorDesc& data, c
 		if( leaf.SimpleNodeIndex == NotFound ) {
 			score += leaf.Value;
 		} else {
-			int nodeIndex = leaf.SimpleNodeIndex;
-
-			while( simpleNodes[nodeIndex].Feature != NotFound ) {
-				if( getFeatureValue( data, simpleNodes[nodeIndex].Feature ) <= simpleNodes[nodeIndex].Value ) {
-					nodeIndex++;
-				} else {
-					nodeIndex = simpleNodes[nodeIndex].RightChild;
-				}
-			}
-			score += simpleNodes[nodeIndex].Value;
+			score += calculateSimpleSubtreeValue( data, leaf.SimpleNodeIndex );
 		}
 	}
 	return score;
 }
 
+// Finds the leaf of the non-optimized subtree with the standard algorithm
+float CGradientBoostQSEnsemble::calculateSimpleSubtreeValue( const CFloatVectorDesc& data, int nodeIndex ) const
+{
+	while( simpleNodes[nodeIndex].Feature != NotFound ) {
+		if( getFeatureValue( data, simpleNodes[nodeIndex].Feature ) <= simpleNodes[nodeIndex].Value ) {
+			nodeIndex++;
+		} else {
+			nodeIndex = simpleNodes[nodeIndex].RightChild;
+		}
+	}
+	return simpleNodes[nodeIndex].Value;
+}
+
 } // namespace NeoML
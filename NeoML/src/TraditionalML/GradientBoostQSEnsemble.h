@@ -80,6 +80,27 @@ struct CQSNodeOffset {
 	CQSNodeOffset() : Less( NotFound, NotFound ), More( NotFound, NotFound ) {}
 };
 
+// The block of the consecutive trees processed together in the batch mode
+// The block is small enough for its nodes, leaves and the bit masks of the document batch to fit into L2 cache
+struct CQSTreeBlock {
+	int FirstTree; // the index of the first tree of the block
+	int TreeCount; // the number of trees in the block
+	CArray<CQSNode> Nodes; // the optimized nodes of the block trees, in the same order as in the whole ensemble
+	CArray<int> FeatureSlots; // the features used in the block (as indices in the array of the used features)
+	CArray<CQSNodeOffset> FeatureOffsets; // the offsets to the nodes of each feature in the Nodes array
+
+	CQSTreeBlock( int firstTree, int treeCount ) : FirstTree( firstTree ), TreeCount( treeCount ) {}
+};
+
+// The buffers used for the batch prediction
+// May be reused for the subsequent calls on the same thread
+struct CQSBatchBuffers {
+	CArray<float> FeatureValues; // the values of the used features, the values of one feature for the whole batch are together
+	CArray<unsigned __int64> Bitvectors; // the bit masks of the block trees, the masks of one tree for the whole batch are together
+	CArray<float> Scores; // the scores of the batch
+	CArray<CFloatVectorDesc> Rows; // the rows of the batch
+};
+
 //------------------------------------------------------------------------------------------------------------
 
 class IQsSerializer;
@@ -96,6 +117,12 @@ public:
 	// The prediction method that uses only the trees in the 0 to lastTreeIndex range
 	double Predict( const CFloatVectorDesc& data, int lastTreeIndex ) const;
 
+	// Predicts the values for the rows [firstRow, firstRow + rowCount) of the matrix
+	// The documents are processed in small batches by the blocks of trees (the block-wise QuickScorer)
+	// The results are the same as the results of the Predict method
+	void PredictBatch( const CFloatMatrixDesc& data, int firstRow, int rowCount, CQSBatchBuffers& buffers,
+		double* predictions ) const;
+
 	// Gets the number of trees in the ensemble
 	int GetTreesCount() const { return treeQsLeavesOffsets.Size(); };
 
@@ -112,6 +139,10 @@ private:
 	CArray<CQSLeaf> qsLeaves; // the leaves of the i subtree start from treeQsLeavesOffsets[i] index
 	CArray<int> treeQsLeavesOffsets; // offsets to optimized subtree leaves for the specified tree in the ensemble
 	CArray<CSimpleNode> simpleNodes; // the descriptions of the nodes that are not in optimized subtrees
+	// The data for the batch prediction; built from the data above and not serialized
+	CArray<int> usedFeatures; // the features used in the optimized nodes
+	CArray<int> featureSlots; // the index in usedFeatures for each feature, NotFound if the feature isn't used
+	CPointerArray<CQSTreeBlock> treeBlocks; // the blocks of trees
 
 	void store( CArchive& archive ) const;
 	void storeQSNode( IQsSerializer& serializer, const CArray<int>& links, const CArray<int>& features,
@@ -126,9 +157,13 @@ private:
 	void loadQSLeaf( IQsSerializer& serializer, int featureIndex, float threshold );
 	void loadSimpleSubtree( IQsSerializer& serializer, int featureIndex, float threshold );
 	void buildFeatureNodesOffsets( const CArray<int>& features );
+	void buildTreeBlocks( const CArray<int>& features );
 
 	void processFeature( int feature, float value, CFastArray<unsigned __int64, 512>& bitvectors ) const;
 	double calculateScore( const CFloatVectorDesc& data, const CFastArray<unsigned __int64, 512>& bitvectors, int lastTreeIndex ) const;
+	void fillBatchFeatureValues( int batchSize, CQSBatchBuffers& buffers ) const;
+	void processBlock( const CQSTreeBlock& block, int batchSize, CQSBatchBuffers& buffers ) const;
+	float calculateSimpleSubtreeValue( const CFloatVectorDesc& data, int nodeIndex ) const;
 };
 
 } // namespace NeoML
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <NeoML/TraditionalML/GradientBoostQuickScorer.h>
 #include <GradientBoostQSEnsemble.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -56,6 +57,8 @@ public:
 	// IGradientBoostQSModel interface methods
 	int GetClassCount() const override { return ensembles.Size() == 1 ? 2 : ensembles.Size(); };
 	bool Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const override;
+	bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const override;
 
 	// IGradientBoostQSModel interface methods
 	bool ClassifyEx( const CSparseFloatVector& data, CArray<CClassificationResult>& results ) const override;
@@ -63,6 +66,7 @@ public:
 
 	// IRegressionModel interface method
 	double Predict( const CFloatVectorDesc& data ) const override;
+	void PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount = 1 ) const override;
 
 	// General methods
 	double GetLearningRate() const override { return learningRate; };
@@ -118,6 +122,61 @@ bool CGradientBoostQSModel::Classify( const CFloatVectorDesc& data, CClassificat
 	return classify( predictions, result );
 }
 
+void CGradientBoostQSModel::PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	NEOML_OMP_NUM_THREADS( threadCount )
+	{
+		int firstRow = 0;
+		int rowCount = 0;
+		if( OmpGetTaskIndexAndCount( data.Height, 1, firstRow, rowCount ) ) {
+			CQSBatchBuffers buffers;
+			ensembles.First()->PredictBatch( data, firstRow, rowCount, buffers, results.GetPtr() + firstRow );
+			for( int i = firstRow; i < firstRow + rowCount; i++ ) {
+				results[i] *= learningRate;
+			}
+		}
+	}
+}
+
+bool CGradientBoostQSModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	NEOML_OMP_NUM_THREADS( threadCount )
+	{
+		int firstRow = 0;
+		int rowCount = 0;
+		if( OmpGetTaskIndexAndCount( data.Height, 1, firstRow, rowCount ) ) {
+			// The predictions of each ensemble for all the rows of the thread
+			CQSBatchBuffers buffers;
+			CArray<double> ensemblePredictions;
+			ensemblePredictions.SetSize( ensembles.Size() * rowCount );
+			for( int i = 0; i < ensembles.Size(); i++ ) {
+				ensembles[i]->PredictBatch( data, firstRow, rowCount, buffers, ensemblePredictions.GetPtr() + i * rowCount );
+			}
+
+			CArray<double> predictions;
+			for( int row = 0; row < rowCount; row++ ) {
+				if( GetClassCount() == 2 ) {
+					classify( ensemblePredictions[row] * learningRate, results[firstRow + row] );
+				} else {
+					predictions.SetSize( ensembles.Size() );
+					for( int i = 0; i < ensembles.Size(); i++ ) {
+						predictions[i] = ensemblePredictions[i * rowCount + row];
+					}
+					classify( predictions, results[firstRow + row] );
+				}
+			}
+		}
+	}
+	return true;
+}
+
 bool CGradientBoostQSModel::ClassifyEx( const CSparseFloatVector& data, CArray<CClassificationResult>& results ) const
 {
 	return ClassifyEx( data.GetDesc(), results );
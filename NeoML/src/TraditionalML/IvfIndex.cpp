@@ -0,0 +1,506 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <NeoML/TraditionalML/IvfIndex.h>
+#include <NeoML/TraditionalML/KMeansClustering.h>
+#include <NeoML/Dnn/DnnBlob.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <float.h>
+#include <memory>
+
+namespace NeoML {
+
+// The matrix as the clustering data with unit weights
+class CIvfClusteringData : public IClusteringData {
+public:
+	explicit CIvfClusteringData( const CFloatMatrixDesc& _matrix ) : matrix( _matrix ) {}
+
+	int GetVectorCount() const override { return matrix.Height; }
+	int GetFeaturesCount() const override { return matrix.Width; }
+	CFloatMatrixDesc GetMatrix() const override { return matrix; }
+	double GetVectorWeight( int /* index */ ) const override { return 1; }
+
+private:
+	const CFloatMatrixDesc matrix;
+};
+
+// The candidate neighbour (or the candidate list while choosing the lists to search)
+struct CIvfNeighbour {
+	float Distance;
+	int Id;
+};
+
+// The farthest neighbour is on top
+typedef CPriorityQueue<CArray<CIvfNeighbour>, CompositeComparer<CIvfNeighbour,
+	AscendingByMember<CIvfNeighbour, float, &CIvfNeighbour::Distance>,
+	AscendingByMember<CIvfNeighbour, int, &CIvfNeighbour::Id>>> CIvfNeighbourQueue;
+
+// Keeps maxCount nearest neighbours in the queue
+static void pushNeighbour( CIvfNeighbourQueue& queue, int maxCount, const CIvfNeighbour& neighbour )
+{
+	if( queue.Size() < maxCount ) {
+		queue.Push( neighbour );
+		return;
+	}
+	const CIvfNeighbour& farthest = queue.Peek();
+	if( neighbour.Distance < farthest.Distance
+		|| ( neighbour.Distance == farthest.Distance && neighbour.Id < farthest.Id ) )
+	{
+		queue.PopAndPush( neighbour );
+	}
+}
+
+// Copies the row of the matrix into the dense buffer of matrix.Width elements
+static void getDenseRow( const CFloatMatrixDesc& matrix, int row, float* result )
+{
+	CFloatVectorDesc desc;
+	matrix.GetRow( row, desc );
+	if( desc.Indexes == nullptr ) {
+		for( int i = 0; i < desc.Size; i++ ) {
+			result[i] = desc.Values[i];
+		}
+		for( int i = desc.Size; i < matrix.Width; i++ ) {
+			result[i] = 0;
+		}
+	} else {
+		for( int i = 0; i < matrix.Width; i++ ) {
+			result[i] = 0;
+		}
+		for( int i = 0; i < desc.Size; i++ ) {
+			result[desc.Indexes[i]] = desc.Values[i];
+		}
+	}
+}
+
+static float squaredDistance( const float* first, const float* second, int size )
+{
+	float result = 0;
+	for( int i = 0; i < size; i++ ) {
+		const float diff = first[i] - second[i];
+		result += diff * diff;
+	}
+	return result;
+}
+
+// Clusterizes the dense rowCount x width matrix and returns the centers
+static void trainCenters( const float* values, int rowCount, int width, const CKMeansClustering::CParam& params,
+	CArray<float>& centers )
+{
+	CArray<int> pointers;
+	pointers.SetBufferSize( rowCount + 1 );
+	for( int i = 0; i <= rowCount; i++ ) {
+		pointers.Add( i * width );
+	}
+	CFloatMatrixDesc matrix;
+	matrix.Height = rowCount;
+	matrix.Width = width;
+	matrix.Values = const_cast<float*>( values );
+	matrix.PointerB = pointers.GetPtr();
+	matrix.PointerE = pointers.GetPtr() + 1;
+
+	CPtr<CIvfClusteringData> data = FINE_DEBUG_NEW CIvfClusteringData( matrix );
+	CClusteringResult result;
+	CKMeansClustering( params ).Clusterize( data, result );
+
+	centers.SetBufferSize( result.ClusterCount * width );
+	for( int i = 0; i < result.ClusterCount; i++ ) {
+		const float* mean = result.Clusters[i].Mean.GetPtr();
+		for( int j = 0; j < width; j++ ) {
+			centers.Add( mean[j] );
+		}
+	}
+}
+
+// The maximum number of elements in the buffer of distances between the vectors and the centers
+static const int IvfDistanceBufferSize = 1024 * 1024;
+
+//---------------------------------------------------------------------------------------------------------
+
+CIvfIndex::CIvfIndex( const CParams& _params ) :
+	params( _params ),
+	featureCount( 0 ),
+	vectorCount( 0 )
+{
+	NeoAssert( params.ListCount > 0 );
+	NeoAssert( params.SubspaceCount >= 0 );
+	NeoAssert( params.SubspaceCenterCount > 0 && params.SubspaceCenterCount <= 256 );
+	NeoAssert( params.ThreadCount > 0 );
+	SetProbeCount( params.ProbeCount );
+}
+
+void CIvfIndex::SetProbeCount( int probeCount )
+{
+	NeoAssert( probeCount > 0 );
+	params.ProbeCount = probeCount;
+}
+
+void CIvfIndex::Train( const CFloatMatrixDesc& data )
+{
+	NeoAssert( vectorCount == 0 );
+	NeoAssert( data.Height > params.ListCount );
+	NeoAssert( !useProductQuantization() || data.Width % params.SubspaceCount == 0 );
+	NeoAssert( !useProductQuantization() || data.Height > params.SubspaceCenterCount );
+
+	featureCount = data.Width;
+	CArray<float> rows;
+	rows.SetSize( data.Height * featureCount );
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		getDenseRow( data, i, rows.GetPtr() + i * featureCount );
+	}
+
+	CKMeansClustering::CParam clusteringParams;
+	clusteringParams.DistanceFunc = DF_Euclid;
+	clusteringParams.Algo = CKMeansClustering::KMA_Lloyd;
+	clusteringParams.Initialization = CKMeansClustering::KMI_KMeansPlusPlus;
+	clusteringParams.MaxIterations = params.MaxIterations;
+	clusteringParams.ThreadCount = params.ThreadCount;
+	clusteringParams.Seed = params.Seed;
+	clusteringParams.InitialClustersCount = params.ListCount;
+	centers.DeleteAll();
+	trainCenters( rows.GetPtr(), data.Height, featureCount, clusteringParams, centers );
+	calcCenterNorms();
+
+	listIds.DeleteAll();
+	listIds.SetSize( params.ListCount );
+	listVectors.DeleteAll();
+	listCodes.DeleteAll();
+	if( !useProductQuantization() ) {
+		listVectors.SetSize( params.ListCount );
+		return;
+	}
+	listCodes.SetSize( params.ListCount );
+
+	// The product quantizer is trained on the differences between the vectors and their closest centers
+	IMathEngine& mathEngine = getMathEngine();
+	CArray<float> residuals;
+	residuals.SetSize( data.Height * featureCount );
+	const int batchSize = getBatchSize();
+	CArray<float> batchRows;
+	CArray<float> distances;
+	for( int firstRow = 0; firstRow < data.Height; firstRow += batchSize ) {
+		const int rowCount = min( batchSize, data.Height - firstRow );
+		calcCenterDistances( mathEngine, data, firstRow, rowCount, batchRows, distances );
+		NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+		for( int i = 0; i < rowCount; i++ ) {
+			const float* rowDistances = distances.GetPtr() + i * params.ListCount;
+			int list = 0;
+			for( int j = 1; j < params.ListCount; j++ ) {
+				if( rowDistances[j] < rowDistances[list] ) {
+					list = j;
+				}
+			}
+			const float* row = batchRows.GetPtr() + i * featureCount;
+			const float* center = centers.GetPtr() + list * featureCount;
+			float* residual = residuals.GetPtr() + ( firstRow + i ) * featureCount;
+			for( int j = 0; j < featureCount; j++ ) {
+				residual[j] = row[j] - center[j];
+			}
+		}
+	}
+
+	const int size = subspaceSize();
+	clusteringParams.InitialClustersCount = params.SubspaceCenterCount;
+	subspaceCenters.DeleteAll();
+	subspaceCenters.SetBufferSize( params.SubspaceCount * params.SubspaceCenterCount * size );
+	CArray<float> subspaceRows;
+	subspaceRows.SetSize( data.Height * size );
+	for( int s = 0; s < params.SubspaceCount; s++ ) {
+		for( int i = 0; i < data.Height; i++ ) {
+			const float* residual = residuals.GetPtr() + i * featureCount + s * size;
+			for( int j = 0; j < size; j++ ) {
+				subspaceRows[i * size + j] = residual[j];
+			}
+		}
+		CArray<float> currentCenters;
+		trainCenters( subspaceRows.GetPtr(), data.Height, size, clusteringParams, currentCenters );
+		NeoAssert( currentCenters.Size() == params.SubspaceCenterCount * size );
+		subspaceCenters.Add( currentCenters );
+	}
+}
+
+void CIvfIndex::Add( const CFloatMatrixDesc& data )
+{
+	NeoAssert( IsTrained() );
+	NeoAssert( data.Width == featureCount );
+
+	IMathEngine& mathEngine = getMathEngine();
+	const int codeSize = params.SubspaceCount;
+	const int batchSize = getBatchSize();
+	CArray<float> rows;
+	CArray<float> distances;
+	CArray<int> nearestLists;
+	CArray<unsigned char> codes;
+	for( int firstRow = 0; firstRow < data.Height; firstRow += batchSize ) {
+		const int rowCount = min( batchSize, data.Height - firstRow );
+		calcCenterDistances( mathEngine, data, firstRow, rowCount, rows, distances );
+		nearestLists.SetSize( rowCount );
+		codes.SetSize( rowCount * codeSize );
+
+		NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+			CArray<float> residual;
+			residual.SetSize( featureCount );
+			int firstIndex = 0;
+			int indexCount = 0;
+			if( OmpGetTaskIndexAndCount( rowCount, firstIndex, indexCount ) ) {
+				const int lastIndex = firstIndex + indexCount;
+				for( int i = firstIndex; i < lastIndex; i++ ) {
+					const float* rowDistances = distances.GetPtr() + i * params.ListCount;
+					int list = 0;
+					for( int j = 1; j < params.ListCount; j++ ) {
+						if( rowDistances[j] < rowDistances[list] ) {
+							list = j;
+						}
+					}
+					nearestLists[i] = list;
+					if( useProductQuantization() ) {
+						const float* row = rows.GetPtr() + i * featureCount;
+						const float* center = centers.GetPtr() + list * featureCount;
+						for( int j = 0; j < featureCount; j++ ) {
+							residual[j] = row[j] - center[j];
+						}
+						encode( residual.GetPtr(), codes.GetPtr() + i * codeSize );
+					}
+				}
+			}
+		}
+
+		// The vectors are added in the order of their ids
+		for( int i = 0; i < rowCount; i++ ) {
+			const int list = nearestLists[i];
+			listIds[list].Add( vectorCount++ );
+			if( useProductQuantization() ) {
+				for( int j = 0; j < codeSize; j++ ) {
+					listCodes[list].Add( codes[i * codeSize + j] );
+				}
+			} else {
+				for( int j = 0; j < featureCount; j++ ) {
+					listVectors[list].Add( rows[i * featureCount + j] );
+				}
+			}
+		}
+	}
+}
+
+void CIvfIndex::Search( const CFloatMatrixDesc& queries, int neighbourCount,
+	CArray<int>& ids, CArray<float>& distances ) const
+{
+	NeoAssert( IsTrained() );
+	NeoAssert( queries.Width == featureCount );
+	NeoAssert( neighbourCount > 0 );
+
+	ids.DeleteAll();
+	ids.Add( NotFound, queries.Height * neighbourCount );
+	distances.DeleteAll();
+	distances.Add( FLT_MAX, queries.Height * neighbourCount );
+
+	IMathEngine& mathEngine = getMathEngine();
+	const int probeCount = min( params.ProbeCount, params.ListCount );
+	const int codeSize = params.SubspaceCount;
+	const int batchSize = getBatchSize();
+	CArray<float> rows;
+	CArray<float> centerDistances;
+	for( int firstRow = 0; firstRow < queries.Height; firstRow += batchSize ) {
+		const int rowCount = min( batchSize, queries.Height - firstRow );
+		calcCenterDistances( mathEngine, queries, firstRow, rowCount, rows, centerDistances );
+
+		NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+			CIvfNeighbourQueue lists;
+			CIvfNeighbourQueue neighbours;
+			CArray<CIvfNeighbour> sortedNeighbours;
+			CArray<float> residual;
+			CArray<float> distanceTable;
+			if( useProductQuantization() ) {
+				residual.SetSize( featureCount );
+				distanceTable.SetSize( params.SubspaceCount * params.SubspaceCenterCount );
+			}
+			int firstIndex = 0;
+			int indexCount = 0;
+			if( OmpGetTaskIndexAndCount( rowCount, firstIndex, indexCount ) ) {
+				const int lastIndex = firstIndex + indexCount;
+				for( int i = firstIndex; i < lastIndex; i++ ) {
+					const float* row = rows.GetPtr() + i * featureCount;
+					const float* rowDistances = centerDistances.GetPtr() + i * params.ListCount;
+					lists.Reset();
+					for( int j = 0; j < params.ListCount; j++ ) {
+						pushNeighbour( lists, probeCount, CIvfNeighbour{ rowDistances[j], j } );
+					}
+
+					neighbours.Reset();
+					CIvfNeighbour list;
+					while( lists.Pop( list ) ) {
+						const CArray<int>& currentIds = listIds[list.Id];
+						if( useProductQuantization() ) {
+							const float* center = centers.GetPtr() + list.Id * featureCount;
+							for( int j = 0; j < featureCount; j++ ) {
+								residual[j] = row[j] - center[j];
+							}
+							fillDistanceTable( residual.GetPtr(), distanceTable.GetPtr() );
+							const unsigned char* code = listCodes[list.Id].GetPtr();
+							for( int v = 0; v < currentIds.Size(); v++, code += codeSize ) {
+								float distance = 0;
+								for( int s = 0; s < codeSize; s++ ) {
+									distance += distanceTable[s * params.SubspaceCenterCount + code[s]];
+								}
+								pushNeighbour( neighbours, neighbourCount, CIvfNeighbour{ distance, currentIds[v] } );
+							}
+						} else {
+							const float* vector = listVectors[list.Id].GetPtr();
+							for( int v = 0; v < currentIds.Size(); v++, vector += featureCount ) {
+								pushNeighbour( neighbours, neighbourCount,
+									CIvfNeighbour{ squaredDistance( row, vector, featureCount ), currentIds[v] } );
+							}
+						}
+					}
+
+					neighbours.DetachAndSort( sortedNeighbours );
+					const int resultOffset = ( firstRow + i ) * neighbourCount;
+					for( int j = 0; j < sortedNeighbours.Size(); j++ ) {
+						ids[resultOffset + j] = sortedNeighbours[j].Id;
+						distances[resultOffset + j] = sortedNeighbours[j].Distance;
+					}
+				}
+			}
+		}
+	}
+}
+
+void CIvfIndex::Serialize( CArchive& archive )
+{
+	archive.SerializeVersion( 0 );
+	if( archive.IsStoring() ) {
+		archive << params.ListCount << params.ProbeCount << params.SubspaceCount << params.SubspaceCenterCount;
+		archive << params.MaxIterations << params.ThreadCount << params.Seed;
+		archive << featureCount << vectorCount;
+		archive << centers << subspaceCenters;
+		archive << listIds << listVectors << listCodes;
+	} else if( archive.IsLoading() ) {
+		archive >> params.ListCount >> params.ProbeCount >> params.SubspaceCount >> params.SubspaceCenterCount;
+		archive >> params.MaxIterations >> params.ThreadCount >> params.Seed;
+		{
+			// The engine is recreated with the loaded number of threads
+			CCriticalSectionLock lock( mathEngineSection );
+			mathEngine.reset();
+		}
+		archive >> featureCount >> vectorCount;
+		archive >> centers >> subspaceCenters;
+		archive >> listIds >> listVectors >> listCodes;
+		calcCenterNorms();
+	} else {
+		NeoAssert( false );
+	}
+}
+
+void CIvfIndex::calcCenterNorms()
+{
+	centerNorms.SetSize( params.ListCount );
+	for( int i = 0; i < params.ListCount; i++ ) {
+		const float* center = centers.GetPtr() + i * featureCount;
+		centerNorms[i] = 0;
+		for( int j = 0; j < featureCount; j++ ) {
+			centerNorms[i] += center[j] * center[j];
+		}
+	}
+}
+
+// The math engine is created once and shared by all calls
+IMathEngine& CIvfIndex::getMathEngine() const
+{
+	CCriticalSectionLock lock( mathEngineSection );
+	if( mathEngine == nullptr ) {
+		mathEngine.reset( CreateCpuMathEngine( params.ThreadCount, 0 ) );
+	}
+	return *mathEngine;
+}
+
+// The number of vectors processed at once, so that the buffers of distances and vectors are limited
+int CIvfIndex::getBatchSize() const
+{
+	return max( 1, IvfDistanceBufferSize / max( params.ListCount, featureCount ) );
+}
+
+// Calculates the squared distances from the rows firstRow, ..., firstRow + rowCount - 1 of the data to the coarse centers
+// The dense rows are stored into rows (rowCount x featureCount), the distances into distances (rowCount x ListCount)
+void CIvfIndex::calcCenterDistances( IMathEngine& mathEngine, const CFloatMatrixDesc& data, int firstRow, int rowCount,
+	CArray<float>& rows, CArray<float>& distances ) const
+{
+	const int listCount = params.ListCount;
+	rows.SetSize( rowCount * featureCount );
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < rowCount; i++ ) {
+		getDenseRow( data, firstRow + i, rows.GetPtr() + i * featureCount );
+	}
+
+	// (a - b)^2 = a^2 + b^2 - 2*a*b, the products are calculated by the math engine
+	CPtr<CDnnBlob> rowBlob = CDnnBlob::CreateDataBlob( mathEngine, CT_Float, 1, rowCount, featureCount );
+	rowBlob->CopyFrom( rows.GetPtr() );
+	CPtr<CDnnBlob> centerBlob = CDnnBlob::CreateDataBlob( mathEngine, CT_Float, 1, listCount, featureCount );
+	centerBlob->CopyFrom( centers.GetPtr() );
+	CPtr<CDnnBlob> productBlob = CDnnBlob::CreateDataBlob( mathEngine, CT_Float, 1, rowCount, listCount );
+	mathEngine.MultiplyMatrixByTransposedMatrix( 1, rowBlob->GetData(), rowCount, featureCount,
+		centerBlob->GetData(), listCount, productBlob->GetData(), rowCount * listCount );
+	distances.SetSize( rowCount * listCount );
+	productBlob->CopyTo( distances.GetPtr() );
+
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < rowCount; i++ ) {
+		const float* row = rows.GetPtr() + i * featureCount;
+		float rowNorm = 0;
+		for( int j = 0; j < featureCount; j++ ) {
+			rowNorm += row[j] * row[j];
+		}
+		float* rowDistances = distances.GetPtr() + i * listCount;
+		for( int j = 0; j < listCount; j++ ) {
+			rowDistances[j] = max( rowNorm + centerNorms[j] - 2 * rowDistances[j], 0.f );
+		}
+	}
+}
+
+// Finds the closest subspace center for each subvector of the residual
+void CIvfIndex::encode( const float* residual, unsigned char* code ) const
+{
+	const int size = subspaceSize();
+	for( int s = 0; s < params.SubspaceCount; s++ ) {
+		const float* subspaceResidual = residual + s * size;
+		const float* subspaceCenter = subspaceCenters.GetPtr() + s * params.SubspaceCenterCount * size;
+		int best = 0;
+		float bestDistance = FLT_MAX;
+		for( int j = 0; j < params.SubspaceCenterCount; j++, subspaceCenter += size ) {
+			const float distance = squaredDistance( subspaceResidual, subspaceCenter, size );
+			if( distance < bestDistance ) {
+				bestDistance = distance;
+				best = j;
+			}
+		}
+		code[s] = static_cast<unsigned char>( best );
+	}
+}
+
+// Calculates the distances from each subvector of the residual to all subspace centers
+void CIvfIndex::fillDistanceTable( const float* residual, float* table ) const
+{
+	const int size = subspaceSize();
+	const float* subspaceCenter = subspaceCenters.GetPtr();
+	for( int s = 0; s < params.SubspaceCount; s++ ) {
+		for( int j = 0; j < params.SubspaceCenterCount; j++, subspaceCenter += size ) {
+			*table++ = squaredDistance( residual + s * size, subspaceCenter, size );
+		}
+	}
+}
+
+} // namespace NeoML
@@ -19,6 +19,7 @@ limitations under the License.
 #include <NeoML/TraditionalML/KMeansClustering.h>
 #include <NeoML/TraditionalML/CommonCluster.h>
 #include <NeoML/TraditionalML/VariableMatrix.h>
+#include <ParallelTasks.h>
 #include <NeoML/Random.h>
 #include <NeoMathEngine/OpenMP.h>
 #include <NeoMathEngine/NeoMathEngine.h>
@@ -130,7 +131,7 @@ bool CKMeansClustering::runClusterization( IClusteringData* input, int seed, CCl
 		}
 	}
 
-	bool success = clusterize( matrix, weights, inertia );
+	bool success = clusterize( matrix, weights, seed, inertia );
 
 	result.ClusterCount = clusters.Size();
 	result.Data.SetSize( matrix.Height );
@@ -178,12 +179,14 @@ bool CKMeansClustering::denseLloydL2Clusterize( IClusteringData* rawData, int se
 	CPtr<CDnnBlob> sizes = CDnnBlob::CreateVector( *mathEngine, CT_Float, clusterCount );
 	CPtr<CDnnBlob> labels = CDnnBlob::CreateVector( *mathEngine, CT_Int, vectorCount );
 
-	static_assert( KMA_Count == 2, "KMA_Count != 2" );
+	static_assert( KMA_Count == 4, "KMA_Count != 4" );
 	switch( params.Algo ) {
 		case KMA_Lloyd:
 			success = lloydBlobClusterization( *data, *weight, *centers, *sizes, *labels, inertia );
 			break;
 		case KMA_Elkan:
+		case KMA_Hamerly:
+		case KMA_MiniBatch:
 			// Only Lloyd algorithm is supported for dense data
 		default:
 			NeoAssert( false );
@@ -306,14 +309,30 @@ void CKMeansClustering::kMeansPlusPlusInitialization( const CFloatMatrixDesc& ma
 	CArray<double> dists;
 	dists.Add( HUGE_VAL, vectorCount );
 
+	CFastArray<double, 8> localDistSum;
+	localDistSum.Add( 0., params.ThreadCount );
 	while( clusters.Size() < params.InitialClustersCount ) {
-		double distSum = 0;
-		for( int i = 0; i < vectorCount; ++i ) {
-			dists[i] = min( dists[i], clusters.Last()->CalcDistance( matrix.GetRow( i ), params.DistanceFunc ) );
-			if( params.DistanceFunc == DF_Cosine ) {
-				dists[i] *= dists[i];
+		const CCommonCluster& lastCluster = *clusters.Last();
+		NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+			const int threadIndex = OmpGetThreadNum();
+			localDistSum[threadIndex] = 0;
+			int firstVector = 0;
+			int threadVectorCount = 0;
+			if( OmpGetTaskIndexAndCount( vectorCount, firstVector, threadVectorCount ) ) {
+				const int lastVector = firstVector + threadVectorCount;
+				for( int i = firstVector; i < lastVector; ++i ) {
+					dists[i] = min( dists[i], lastCluster.CalcDistance( matrix.GetRow( i ), params.DistanceFunc ) );
+					if( params.DistanceFunc == DF_Cosine ) {
+						dists[i] *= dists[i];
+					}
+					localDistSum[threadIndex] += dists[i];
+				}
 			}
-			distSum += dists[i];
+		}
+
+		double distSum = 0;
+		for( int i = 0; i < localDistSum.Size(); ++i ) {
+			distSum += localDistSum[i];
 		}
 
 		double selectedSum = random.Uniform( 0, distSum );
@@ -329,13 +348,23 @@ void CKMeansClustering::kMeansPlusPlusInitialization( const CFloatMatrixDesc& ma
 	}
 }
 
-bool CKMeansClustering::clusterize( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia )
+bool CKMeansClustering::clusterize( const CFloatMatrixDesc& matrix, const CArray<double>& weights, int seed,
+	double& inertia )
 {
-	if( params.Algo == KMA_Lloyd ) {
-		return lloydClusterization( matrix, weights, inertia );
-	} else {
-		return elkanClusterization( matrix, weights, inertia );
+	static_assert( KMA_Count == 4, "KMA_Count != 4" );
+	switch( params.Algo ) {
+		case KMA_Lloyd:
+			return lloydClusterization( matrix, weights, inertia );
+		case KMA_Elkan:
+			return elkanClusterization( matrix, weights, inertia );
+		case KMA_Hamerly:
+			return hamerlyClusterization( matrix, weights, inertia );
+		case KMA_MiniBatch:
+			return miniBatchClusterization( matrix, weights, seed, inertia );
+		default:
+			NeoAssert( false );
 	}
+	return false;
 }
 
 bool CKMeansClustering::lloydClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia )
@@ -395,10 +424,10 @@ int CKMeansClustering::findNearestCluster( const CFloatMatrixDesc& matrix, int d
 {
 	double bestDistance = DBL_MAX;
 	int res = NotFound;
-	
+	CFloatVectorDesc desc;
+	matrix.GetRow( dataIndex, desc );
+
 	for( int i = 0; i < clusters.Size(); i++ ) {
-		CFloatVectorDesc desc;
-		matrix.GetRow( dataIndex, desc );
 		const double distance = clusters[i]->CalcDistance( desc, params.DistanceFunc );
 		if( distance < bestDistance ) {
 			bestDistance = distance;
@@ -419,26 +448,47 @@ void CKMeansClustering::storeClusterCenters( CArray<CClusterCenter>& result )
 	}
 }
 
-// Updates the clusters and returns true if the clusters were changed, false if they stayed the same
-bool CKMeansClustering::updateClusters( const CFloatMatrixDesc& matrix, const CArray<double>& weights,
-	const CArray<int>& dataCluster, const CArray<CClusterCenter>& oldCenters )
+// Groups the elements by clusters: the elements of the cluster c are elements[begin[c]]...elements[begin[c + 1] - 1]
+// The elements of each cluster are in ascending order
+static void groupByClusters( const CArray<int>& dataCluster, int clusterCount, CArray<int>& begin, CArray<int>& elements )
 {
-	// Store the old cluster centers
-	for( int i = 0; i < clusters.Size(); i++ ) {
-		clusters[i]->Reset();
+	begin.DeleteAll();
+	begin.Add( 0, clusterCount + 1 );
+	for( int i = 0; i < dataCluster.Size(); i++ ) {
+		begin[dataCluster[i] + 1]++;
+	}
+	for( int c = 0; c < clusterCount; c++ ) {
+		begin[c + 1] += begin[c];
 	}
 
-	// Update the cluster contents
+	CArray<int> position;
+	begin.CopyTo( position );
+	elements.SetSize( dataCluster.Size() );
 	for( int i = 0; i < dataCluster.Size(); i++ ) {
-		CFloatVectorDesc desc;
-		matrix.GetRow( i, desc );
-		clusters[dataCluster[i]]->Add( i, desc, weights[i] );
+		elements[position[dataCluster[i]]++] = i;
 	}
+}
 
-	// Update the cluster centers
-	for( int i = 0; i < clusters.Size(); i++ ) {
-		if( clusters[i]->GetElementsCount() > 0 ) {
-			clusters[i]->RecalcCenter();
+// Updates the clusters and returns true if the clusters were changed, false if they stayed the same
+bool CKMeansClustering::updateClusters( const CFloatMatrixDesc& matrix, const CArray<double>& weights,
+	const CArray<int>& dataCluster, const CArray<CClusterCenter>& oldCenters )
+{
+	// Each cluster is updated by a single thread, so the result does not depend on the number of threads
+	CArray<int> clusterBegin;
+	CArray<int> clusterElements;
+	groupByClusters( dataCluster, clusters.Size(), clusterBegin, clusterElements );
+
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int c = 0; c < clusters.Size(); c++ ) {
+		clusters[c]->Reset();
+		for( int j = clusterBegin[c]; j < clusterBegin[c + 1]; j++ ) {
+			const int i = clusterElements[j];
+			CFloatVectorDesc desc;
+			matrix.GetRow( i, desc );
+			clusters[c]->Add( i, desc, weights[i] );
+		}
+		if( clusters[c]->GetElementsCount() > 0 ) {
+			clusters[c]->RecalcCenter();
 		}
 	}
 
@@ -530,18 +580,24 @@ void CKMeansClustering::initializeElkanStatistics( const CFloatMatrixDesc& matri
 
 void CKMeansClustering::computeClustersDists( CVariableMatrix<float>& dists, CArray<float>& closestCluster ) const
 {
-	for( int i = 0; i < clusters.Size(); i++ ) {
-		closestCluster[i] = FLT_MAX;
-	}
-	for( int i = 0; i < clusters.Size() - 1; i++ ) {
+	// The rows have different length, so they are distributed between the threads dynamically
+	ExecuteParallelTasks( clusters.Size(), params.ThreadCount, [&]( int i ) {
 		dists( i, i ) = FLT_MAX;
 		for( int j = i + 1; j < clusters.Size(); j++ ) {
 			const float dist = static_cast<float>(
 				sqrt( clusters[i]->CalcDistance( *clusters[j], params.DistanceFunc ) ) );
 			dists( i, j ) = dist;
 			dists( j, i ) = dist;
-			closestCluster[i] = min( 0.5f * dist, closestCluster[i] );
-			closestCluster[j] = min( 0.5f * dist, closestCluster[j] );
+		}
+	} );
+
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < clusters.Size(); i++ ) {
+		closestCluster[i] = FLT_MAX;
+		for( int j = 0; j < clusters.Size(); j++ ) {
+			if( j != i ) {
+				closestCluster[i] = min( 0.5f * dists( i, j ), closestCluster[i] );
+			}
 		}
 	}
 }
@@ -595,6 +651,7 @@ void CKMeansClustering::assignVectors( const CFloatMatrixDesc& matrix, const CVa
 
 void CKMeansClustering::updateMoveDistance( const CArray<CClusterCenter>& oldCenters, CArray<float>& moveDistance ) const
 {
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
 	for( int i = 0; i < clusters.Size(); ++i ) {
 		const double moveNorm = sqrt( clusters[i]->CalcDistance( oldCenters[i].Mean, params.DistanceFunc ) );
 		moveDistance[i] = static_cast<float>( moveNorm );
@@ -643,6 +700,254 @@ bool CKMeansClustering::isPruned( const CArray<float>& upperBounds, const CVaria
 		( upperBounds[id] <= 0.5 * clusterDists( currentCluster, clusterToProcess ) );
 }
 
+bool CKMeansClustering::hamerlyClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights, double& inertia )
+{
+	// Metric must support triangle inequality
+	NeoAssert( params.DistanceFunc == DF_Euclid );
+
+	// Element assignments (objectCount)
+	CArray<int> assignments;
+	assignments.Add( 0, matrix.Height );
+	// Upper bounds of the distance to the assigned center (objectCount)
+	CArray<float> upperBounds;
+	upperBounds.Add( FLT_MAX, matrix.Height );
+	// Lower bounds of the distance to the closest center other than the assigned one (objectCount)
+	CArray<float> lowerBounds;
+	lowerBounds.Add( 0.f, matrix.Height );
+	// Half of the distance to the closest center of another cluster (clusterCount)
+	CArray<float> closestClusterDist;
+	closestClusterDist.Add( FLT_MAX, clusters.Size() );
+	// Distances between old and updated centers of each cluster (clusterCount)
+	CArray<float> moveDistance;
+	moveDistance.Add( 0.f, clusters.Size() );
+
+	double lastResidual = DBL_MAX;
+	for( int i = 0; i < params.MaxIterations; i++ ) {
+		computeClosestClusterDists( closestClusterDist );
+		assignVectors( matrix, closestClusterDist, assignments, upperBounds, lowerBounds );
+		CArray<CClusterCenter> oldCenters;
+		storeClusterCenters( oldCenters );
+		updateClusters( matrix, weights, assignments, oldCenters );
+		updateMoveDistance( oldCenters, moveDistance );
+		inertia = updateUpperAndLowerBounds( matrix, moveDistance, assignments, upperBounds, lowerBounds );
+		if( abs( inertia - lastResidual ) <= params.Tolerance ) {
+			return true;
+		}
+		lastResidual = inertia;
+		if( log != 0 ) {
+			*log << L"Step " << i << L"Itertia: " << inertia << L"\n";
+		}
+	}
+
+	return false;
+}
+
+// Calculates half of the distance from each center to the closest other center
+// Unlike computeClustersDists, doesn't store the clusterCount x clusterCount distance matrix
+void CKMeansClustering::computeClosestClusterDists( CArray<float>& closestClusterDist ) const
+{
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < clusters.Size(); i++ ) {
+		double closestDist = DBL_MAX;
+		for( int j = 0; j < clusters.Size(); j++ ) {
+			if( j != i ) {
+				closestDist = min( closestDist, clusters[i]->CalcDistance( *clusters[j], params.DistanceFunc ) );
+			}
+		}
+		closestClusterDist[i] = closestDist == DBL_MAX ? FLT_MAX : static_cast<float>( 0.5 * sqrt( closestDist ) );
+	}
+}
+
+void CKMeansClustering::assignVectors( const CFloatMatrixDesc& matrix, const CArray<float>& closestClusterDist,
+	CArray<int>& assignments, CArray<float>& upperBounds, CArray<float>& lowerBounds ) const
+{
+	NeoAssert( assignments.Size() == matrix.Height );
+	NeoAssert( upperBounds.Size() == assignments.Size() );
+	NeoAssert( lowerBounds.Size() == assignments.Size() );
+	NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+		int firstVector = 0;
+		int vectorCount = 0;
+		if( OmpGetTaskIndexAndCount( matrix.Height, firstVector, vectorCount ) ) {
+			const int lastVector = firstVector + vectorCount;
+			for( int i = firstVector; i < lastVector; i++ ) {
+				// No other center can be closer than the assigned one
+				const float bound = max( closestClusterDist[assignments[i]], lowerBounds[i] );
+				if( upperBounds[i] <= bound ) {
+					continue;
+				}
+				CFloatVectorDesc desc;
+				matrix.GetRow( i, desc );
+				upperBounds[i] = static_cast<float>(
+					sqrt( clusters[assignments[i]]->CalcDistance( desc, params.DistanceFunc ) ) );
+				if( upperBounds[i] <= bound ) {
+					continue;
+				}
+				// Find the closest and the second closest centers
+				double closestDist = DBL_MAX;
+				double secondClosestDist = DBL_MAX;
+				for( int c = 0; c < clusters.Size(); c++ ) {
+					const double dist = clusters[c]->CalcDistance( desc, params.DistanceFunc );
+					if( dist < closestDist ) {
+						secondClosestDist = closestDist;
+						closestDist = dist;
+						assignments[i] = c;
+					} else if( dist < secondClosestDist ) {
+						secondClosestDist = dist;
+					}
+				}
+				upperBounds[i] = static_cast<float>( sqrt( closestDist ) );
+				lowerBounds[i] = secondClosestDist == DBL_MAX ? FLT_MAX : static_cast<float>( sqrt( secondClosestDist ) );
+			}
+		}
+	}
+}
+
+double CKMeansClustering::updateUpperAndLowerBounds( const CFloatMatrixDesc& matrix, const CArray<float>& moveDistance,
+	const CArray<int>& assignments, CArray<float>& upperBounds, CArray<float>& lowerBounds ) const
+{
+	// The lower bound decreases by the largest move of the centers other than the assigned one
+	int maxMoveCluster = 0;
+	float maxMove = 0;
+	float secondMaxMove = 0;
+	for( int c = 0; c < clusters.Size(); c++ ) {
+		if( moveDistance[c] > maxMove ) {
+			secondMaxMove = maxMove;
+			maxMove = moveDistance[c];
+			maxMoveCluster = c;
+		} else if( moveDistance[c] > secondMaxMove ) {
+			secondMaxMove = moveDistance[c];
+		}
+	}
+
+	CFastArray<double, 16> localInertia;
+	localInertia.Add( 0., params.ThreadCount );
+
+	NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+		const int threadIndex = OmpGetThreadNum();
+		int firstVector = 0;
+		int vectorCount = 0;
+		if( OmpGetTaskIndexAndCount( matrix.Height, firstVector, vectorCount ) ) {
+			const int lastVector = firstVector + vectorCount;
+			for( int j = firstVector; j < lastVector; j++ ) {
+				const int cluster = assignments[j];
+				upperBounds[j] += moveDistance[cluster];
+				lowerBounds[j] = max( lowerBounds[j] - ( cluster == maxMoveCluster ? secondMaxMove : maxMove ), 0.f );
+				localInertia[threadIndex] += clusters[cluster]->CalcDistance( matrix.GetRow( j ), params.DistanceFunc );
+			}
+		}
+	}
+
+	double inertia = 0;
+	for( int i = 0; i < localInertia.Size(); ++i ) {
+		inertia += localInertia[i];
+	}
+
+	return inertia;
+}
+
+bool CKMeansClustering::miniBatchClusterization( const CFloatMatrixDesc& matrix, const CArray<double>& weights,
+	int seed, double& inertia )
+{
+	NeoAssert( params.MiniBatchSize > 0 );
+
+	CRandom random( seed );
+	CArray<int> batch;
+	CArray<int> batchCluster;
+	bool success = false;
+	for( int i = 0; i < params.MaxIterations; i++ ) {
+		batch.DeleteAll();
+		if( params.MiniBatchSize >= matrix.Height ) {
+			// The data is small enough to be used as a whole
+			for( int j = 0; j < matrix.Height; j++ ) {
+				batch.Add( j );
+			}
+		} else {
+			for( int j = 0; j < params.MiniBatchSize; j++ ) {
+				batch.Add( random.UniformInt( 0, matrix.Height - 1 ) );
+			}
+		}
+
+		const double batchInertia = classifyBatch( matrix, batch, batchCluster );
+		if( log != 0 ) {
+			*log << L"Step " << i << L" Batch inertia: " << batchInertia << L"\n";
+		}
+		if( !updateClustersByBatch( matrix, weights, batch, batchCluster ) ) {
+			success = true;
+			break;
+		}
+	}
+
+	// Assign all elements to the nearest clusters
+	CArray<int> dataCluster;
+	classifyAllData( matrix, dataCluster, inertia );
+	CArray<CClusterCenter> oldCenters;
+	storeClusterCenters( oldCenters );
+	updateClusters( matrix, weights, dataCluster, oldCenters );
+	return success;
+}
+
+// Assigns the batch elements to the nearest clusters and returns the inertia of the batch
+double CKMeansClustering::classifyBatch( const CFloatMatrixDesc& matrix, const CArray<int>& batch,
+	CArray<int>& batchCluster ) const
+{
+	batchCluster.SetSize( batch.Size() );
+	CFastArray<double, 8> localInertia;
+	localInertia.Add( 0., params.ThreadCount );
+	NEOML_OMP_NUM_THREADS( params.ThreadCount ) {
+		int firstElement = 0;
+		int elementCount = 0;
+		if( OmpGetTaskIndexAndCount( batch.Size(), firstElement, elementCount ) ) {
+			const int lastElement = firstElement + elementCount;
+			for( int i = firstElement; i < lastElement; i++ ) {
+				batchCluster[i] = findNearestCluster( matrix, batch[i], localInertia[OmpGetThreadNum()] );
+			}
+		}
+	}
+
+	double inertia = 0;
+	for( int i = 0; i < localInertia.Size(); ++i ) {
+		inertia += localInertia[i];
+	}
+	return inertia;
+}
+
+// Moves each center to the weighted mean of the elements assigned to it over all batches so far
+// The clusters accumulate the batch elements, so the variances and the weights are updated the same way as in Lloyd
+// Returns true if the centers were changed, false if the total squared move is within Tolerance
+bool CKMeansClustering::updateClustersByBatch( const CFloatMatrixDesc& matrix, const CArray<double>& weights,
+	const CArray<int>& batch, const CArray<int>& batchCluster )
+{
+	CArray<int> clusterBegin;
+	CArray<int> clusterElements;
+	groupByClusters( batchCluster, clusters.Size(), clusterBegin, clusterElements );
+
+	CArray<double> moveDistance;
+	moveDistance.Add( 0., clusters.Size() );
+
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int c = 0; c < clusters.Size(); c++ ) {
+		if( clusterBegin[c] == clusterBegin[c + 1] ) {
+			continue;
+		}
+		const CFloatVector oldMean = clusters[c]->GetCenter().Mean;
+		for( int j = clusterBegin[c]; j < clusterBegin[c + 1]; j++ ) {
+			const int element = batch[clusterElements[j]];
+			CFloatVectorDesc desc;
+			matrix.GetRow( element, desc );
+			clusters[c]->Add( element, desc, weights[element] );
+		}
+		clusters[c]->RecalcCenter();
+		moveDistance[c] = clusters[c]->CalcDistance( oldMean, DF_Euclid );
+	}
+
+	double totalMove = 0;
+	for( int c = 0; c < clusters.Size(); c++ ) {
+		totalMove += moveDistance[c];
+	}
+	return totalMove > params.Tolerance;
+}
+
+
 // Selects initial centers from dense data
 void CKMeansClustering::selectInitialClusters( const CDnnBlob& data, int seed, CDnnBlob& centers )
 {
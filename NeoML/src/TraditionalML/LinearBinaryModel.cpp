@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <LinearBinaryModel.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -36,6 +37,21 @@ bool CLinearBinaryModel::Classify( const CFloatVectorDesc& data, CClassification
 	return classify( distance, result );
 }
 
+bool CLinearBinaryModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		classify( LinearFunction( plane, row ), results[i] );
+	}
+	return true;
+}
+
 // Calculates classification result from the distance to the separating plane
 bool CLinearBinaryModel::classify( double distance, CClassificationResult& result ) const
 {
@@ -75,4 +91,17 @@ double CLinearBinaryModel::Predict( const CFloatVectorDesc& data ) const
 	return LinearFunction( plane, data );
 }
 
+void CLinearBinaryModel::PredictBatch( const CFloatMatrixDesc& data, CArray<double>& results, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		results[i] = LinearFunction( plane, row );
+	}
+}
+
 } // namespace NeoML
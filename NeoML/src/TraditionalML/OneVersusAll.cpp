@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <NeoML/TraditionalML/OneVersusAll.h>
 #include <OneVersusAllModel.h>
+#include <ParallelTasks.h>
 
 namespace NeoML {
 
@@ -52,10 +53,12 @@ inline COneVersusAllTrainingData::COneVersusAllTrainingData( const IProblem* _da
 
 //---------------------------------------------------------------------------------------------------------
 
-COneVersusAll::COneVersusAll( ITrainingModel& _baseBinaryClassifier ) :
+COneVersusAll::COneVersusAll( ITrainingModel& _baseBinaryClassifier, int _threadCount ) :
 	baseBinaryClassifier( _baseBinaryClassifier ),
+	threadCount( _threadCount ),
 	logStream( 0 )
 {
+	NeoAssert( threadCount > 0 );
 }
 
 CPtr<IModel> COneVersusAll::Train( const IProblem& trainingClassificationData )
@@ -64,11 +67,13 @@ CPtr<IModel> COneVersusAll::Train( const IProblem& trainingClassificationData )
 		*logStream << "\nOne versus all training started:\n";
 	}
 
+	// The binary problems share the matrix of the source data
 	CObjectArray<IModel> etalons;
-	for( int i = 0; i < trainingClassificationData.GetClassCount(); i++ ) {
+	etalons.SetSize( trainingClassificationData.GetClassCount() );
+	ExecuteParallelTasks( etalons.Size(), threadCount, [&]( int i ) {
 		CPtr<IProblem> trainingData = FINE_DEBUG_NEW COneVersusAllTrainingData( &trainingClassificationData, i );
-		etalons.Add( baseBinaryClassifier.Train( *trainingData ) );
-	}
+		etalons[i] = baseBinaryClassifier.Train( *trainingData );
+	} );
 
 	if( logStream != 0 ) {
 		*logStream << "\nOne versus all training finished\n";
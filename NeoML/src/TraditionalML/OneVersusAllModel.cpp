@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <OneVersusAllModel.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -85,6 +86,45 @@ bool COneVersusAllModel::Classify( const CFloatVectorDesc& data, CClassification
 	return true;
 }
 
+bool COneVersusAllModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+
+	// Each binary classifier processes the whole batch, probabilities[row * classCount + class] is the class probability
+	const int classCount = classifiers.Size();
+	CArray<double> probabilities;
+	probabilities.SetSize( data.Height * classCount );
+	for( int i = 0; i < classCount; i++ ) {
+		NeoAssert( classifiers[i]->ClassifyBatch( data, results, threadCount ) );
+		for( int row = 0; row < data.Height; row++ ) {
+			probabilities[row * classCount + i] = results[row].Probabilities[0].GetValue();
+		}
+	}
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int row = 0; row < data.Height; row++ ) {
+		const double* rowProbabilities = probabilities.GetPtr() + row * classCount;
+		double sigmoidSum = 0;
+		int preferredClass = 0;
+		for( int i = 0; i < classCount; i++ ) {
+			sigmoidSum += rowProbabilities[i];
+			if( rowProbabilities[i] > rowProbabilities[preferredClass] ) {
+				preferredClass = i;
+			}
+		}
+
+		CClassificationResult& result = results[row];
+		result.ExceptionProbability = CClassificationProbability( 0 );
+		result.PreferredClass = preferredClass;
+		result.Probabilities.SetSize( classCount );
+		for( int i = 0; i < classCount; i++ ) {
+			result.Probabilities[i] = CClassificationProbability( rowProbabilities[i] / sigmoidSum );
+		}
+	}
+	return true;
+}
+
 void COneVersusAllModel::Serialize( CArchive& archive )
 {
 #ifdef NEOML_USE_FINEOBJ
@@ -18,13 +18,16 @@ limitations under the License.
 
 #include <NeoML/TraditionalML/OneVersusOne.h>
 #include <OneVersusOneModel.h>
+#include <ParallelTasks.h>
 
 namespace NeoML {
 
 // The data for training binary classification: 0 for the first class, 1 for the second
 class COneVersusOneTrainingData : public IProblem {
 public:
-	COneVersusOneTrainingData( const IProblem& data, int firstClass, int secondClass );
+	// firstVectors and secondVectors are the sorted indices of the vectors of each class
+	COneVersusOneTrainingData( const IProblem& data, int firstClass, int secondClass,
+		const CArray<int>& firstVectors, const CArray<int>& secondVectors );
 
 	// IProblem interface methods
 	int GetClassCount() const override { return 2; }
@@ -46,25 +49,36 @@ private:
 	CArray<int> vectorIndices; // indices of vectors in base problem
 };
 
-COneVersusOneTrainingData::COneVersusOneTrainingData( const IProblem& data, int _firstClass, int _secondClass ) :
+COneVersusOneTrainingData::COneVersusOneTrainingData( const IProblem& data, int _firstClass, int _secondClass,
+		const CArray<int>& firstVectors, const CArray<int>& secondVectors ) :
 	baseProblem( &data ),
 	firstClass( _firstClass ),
 	secondClass( _secondClass )
 {
 	NeoAssert( firstClass != secondClass );
 	const CFloatMatrixDesc baseDesc = data.GetMatrix();
-	desc.Height = 0;
+	desc.Height = firstVectors.Size() + secondVectors.Size();
 	desc.Width = baseDesc.Width;
 	desc.Columns = baseDesc.Columns; // This works for both sparse and dense cases
 	desc.Values = baseDesc.Values;
-	for( int vecIndex = 0; vecIndex < baseDesc.Height; ++vecIndex ) {
-		const int currClass = baseProblem->GetClass( vecIndex );
-		if( currClass == firstClass || currClass == secondClass ) {
-			desc.Height++;
-			rowStart.Add( baseDesc.PointerB[vecIndex] );
-			rowEnd.Add( baseDesc.PointerE[vecIndex] );
-			vectorIndices.Add( vecIndex );
+	rowStart.SetBufferSize( desc.Height );
+	rowEnd.SetBufferSize( desc.Height );
+	vectorIndices.SetBufferSize( desc.Height );
+	// Merge the vectors of both classes keeping the original order
+	int first = 0;
+	int second = 0;
+	while( first < firstVectors.Size() || second < secondVectors.Size() ) {
+		int vecIndex = NotFound;
+		if( second == secondVectors.Size()
+			|| ( first < firstVectors.Size() && firstVectors[first] < secondVectors[second] ) )
+		{
+			vecIndex = firstVectors[first++];
+		} else {
+			vecIndex = secondVectors[second++];
 		}
+		rowStart.Add( baseDesc.PointerB[vecIndex] );
+		rowEnd.Add( baseDesc.PointerE[vecIndex] );
+		vectorIndices.Add( vecIndex );
 	}
 	desc.PointerB = rowStart.GetPtr();
 	desc.PointerE = rowEnd.GetPtr();
@@ -79,10 +93,12 @@ int COneVersusOneTrainingData::GetClass( int index ) const
 
 //---------------------------------------------------------------------------------------------------------
 
-COneVersusOne::COneVersusOne( ITrainingModel& _baseClassifier ) :
+COneVersusOne::COneVersusOne( ITrainingModel& _baseClassifier, int _threadCount ) :
 	baseClassifier( _baseClassifier ),
+	threadCount( _threadCount ),
 	log( nullptr )
 {
+	NeoAssert( threadCount > 0 );
 }
 
 CPtr<IModel> COneVersusOne::Train( const IProblem& trainingData )
@@ -91,15 +107,32 @@ CPtr<IModel> COneVersusOne::Train( const IProblem& trainingData )
 		*log << "\nOne versus one traning started:\n";
 	}
 
-	CObjectArray<IModel> classifiers;
+	// The vectors of each class, so that the subproblems don't scan the whole data
 	const int classCount = trainingData.GetClassCount();
+	CArray<CArray<int>> classVectors;
+	classVectors.SetSize( classCount );
+	for( int i = 0; i < trainingData.GetVectorCount(); ++i ) {
+		classVectors[trainingData.GetClass( i )].Add( i );
+	}
+
+	CArray<int> firstClasses;
+	CArray<int> secondClasses;
 	for( int firstClass = 0; firstClass < classCount - 1; ++firstClass ) {
 		for( int secondClass = firstClass + 1; secondClass < classCount; ++secondClass ) {
-			CPtr<IProblem> subproblem = FINE_DEBUG_NEW COneVersusOneTrainingData( trainingData, firstClass, secondClass );
-			classifiers.Add( baseClassifier.Train( *subproblem ) );
+			firstClasses.Add( firstClass );
+			secondClasses.Add( secondClass );
 		}
 	}
 
+	// The binary problems share the matrix of the source data
+	CObjectArray<IModel> classifiers;
+	classifiers.SetSize( firstClasses.Size() );
+	ExecuteParallelTasks( classifiers.Size(), threadCount, [&]( int i ) {
+		CPtr<IProblem> subproblem = FINE_DEBUG_NEW COneVersusOneTrainingData( trainingData, firstClasses[i], secondClasses[i],
+			classVectors[firstClasses[i]], classVectors[secondClasses[i]] );
+		classifiers[i] = baseClassifier.Train( *subproblem );
+	} );
+
 	if( log != nullptr ) {
 		*log << "\nOne versus one training finished\n";
 	}
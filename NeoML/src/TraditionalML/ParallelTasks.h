@@ -0,0 +1,61 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoMathEngine/OpenMP.h>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace NeoML {
+
+// Calls task( index ) for each index in [0, taskCount) using threadCount threads
+// The threads take the tasks one by one, so the tasks of different duration are balanced
+// If there are fewer tasks than threads, the tasks are executed one after another,
+// so that each of them may use all the threads by itself
+// If a task throws, no new tasks are started and the first exception is rethrown after all the threads finish
+template<class TTask>
+inline void ExecuteParallelTasks( int taskCount, int threadCount, const TTask& task )
+{
+	NeoAssert( threadCount > 0 );
+	if( taskCount < threadCount ) {
+		threadCount = 1;
+	}
+
+	std::atomic<int> nextTask( 0 );
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	NEOML_OMP_NUM_THREADS( threadCount )
+	{
+		for( int index = nextTask++; index < taskCount; index = nextTask++ ) {
+			try {
+				task( index );
+			} catch( ... ) {
+				// The exceptions may not leave the OpenMP region
+				std::lock_guard<std::mutex> lock( errorMutex );
+				if( error == nullptr ) {
+					error = std::current_exception();
+				}
+				nextTask = taskCount;
+			}
+		}
+	}
+	if( error != nullptr ) {
+		std::rethrow_exception( error );
+	}
+}
+
+} // namespace NeoML
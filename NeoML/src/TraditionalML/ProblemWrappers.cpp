@@ -28,6 +28,8 @@ IRegressionProblem::~IRegressionProblem() = default;
 
 IMultivariateRegressionProblem::~IMultivariateRegressionProblem() = default;
 
+IMultivariateRegressionChunkedProblem::~IMultivariateRegressionChunkedProblem() = default;
+
 IDataAccumulator::~IDataAccumulator() = default;
 
 ISubProblem::~ISubProblem() = default;
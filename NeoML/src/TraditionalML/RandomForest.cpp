@@ -0,0 +1,134 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <NeoML/TraditionalML/RandomForest.h>
+#include <RandomForestModel.h>
+#include <NeoMathEngine/OpenMP.h>
+
+namespace NeoML {
+
+// The bootstrap sample of the problem
+// The vector drawn several times is included once, with its weight multiplied by the number of draws
+class CRandomForestSubproblem : public IProblem {
+public:
+	CRandomForestSubproblem( const IProblem& problem, double subsampleRate, CRandom& random );
+
+	// IProblem interface methods
+	int GetClassCount() const override { return problem->GetClassCount(); }
+	int GetFeatureCount() const override { return problem->GetFeatureCount(); }
+	bool IsDiscreteFeature( int index ) const override { return problem->IsDiscreteFeature( index ); }
+	int GetVectorCount() const override { return vectors.Size(); }
+	int GetClass( int index ) const override { return problem->GetClass( vectors[index] ); }
+	CFloatMatrixDesc GetMatrix() const override { return matrix; }
+	double GetVectorWeight( int index ) const override { return weights[index]; }
+	int GetDiscretizationValue( int index ) const override { return problem->GetDiscretizationValue( index ); }
+
+protected:
+	~CRandomForestSubproblem() override = default; // delete prohibited
+
+private:
+	const CPtr<const IProblem> problem; // the source problem
+	CArray<int> vectors; // the indices of the sampled vectors in the source problem
+	CArray<double> weights; // the weights of the sampled vectors
+	CArray<int> pointerB; // the rows of the sampled vectors in the source matrix
+	CArray<int> pointerE;
+	CFloatMatrixDesc matrix; // the matrix of the sampled vectors
+};
+
+CRandomForestSubproblem::CRandomForestSubproblem( const IProblem& _problem, double subsampleRate, CRandom& random ) :
+	problem( &_problem )
+{
+	const int vectorCount = problem->GetVectorCount();
+	const int sampleSize = max( 1, static_cast<int>( vectorCount * subsampleRate ) );
+	CArray<int> drawCounts;
+	drawCounts.Add( 0, vectorCount );
+	for( int i = 0; i < sampleSize; i++ ) {
+		drawCounts[random.UniformInt( 0, vectorCount - 1 )]++;
+	}
+
+	matrix = problem->GetMatrix();
+	for( int i = 0; i < vectorCount; i++ ) {
+		if( drawCounts[i] > 0 ) {
+			vectors.Add( i );
+			weights.Add( drawCounts[i] * problem->GetVectorWeight( i ) );
+			pointerB.Add( matrix.PointerB[i] );
+			pointerE.Add( matrix.PointerE[i] );
+		}
+	}
+	matrix.Height = vectors.Size();
+	matrix.PointerB = pointerB.GetPtr();
+	matrix.PointerE = pointerE.GetPtr();
+}
+
+//---------------------------------------------------------------------------------------------------------
+
+CRandomForest::CRandomForest( const CParams& _params, CRandom* _random ) :
+	params( _params ),
+	random( _random != nullptr ? *_random : defRandom ),
+	logStream( 0 )
+{
+	NeoAssert( params.TreeCount > 0 );
+	NeoAssert( params.SubsampleRate > 0 );
+	NeoAssert( params.ThreadCount > 0 );
+}
+
+CPtr<IModel> CRandomForest::Train( const IProblem& problem )
+{
+	NeoAssert( problem.GetVectorCount() > 0 );
+	NeoAssert( problem.GetClassCount() > 1 );
+	NeoAssert( problem.GetFeatureCount() > 0 );
+
+	if( logStream != 0 ) {
+		*logStream << "\nRandom forest training started:\n";
+	}
+
+	CDecisionTree::CParams treeParams = params.TreeParams;
+	treeParams.ThreadCount = 1;
+	if( treeParams.RandomSelectedFeaturesCount == NotFound ) {
+		const int featureCount = problem.GetFeatureCount();
+		const int selectedFeaturesCount = max( 1, static_cast<int>( sqrt( static_cast<double>( featureCount ) ) ) );
+		if( selectedFeaturesCount < featureCount ) {
+			treeParams.RandomSelectedFeaturesCount = selectedFeaturesCount;
+		}
+	}
+
+	// Each tree has its own random numbers generator, so the ensemble does not depend on the number of threads
+	CArray<unsigned int> seeds;
+	seeds.SetBufferSize( params.TreeCount );
+	for( int i = 0; i < params.TreeCount; i++ ) {
+		seeds.Add( random.Next() );
+	}
+
+	CObjectArray<IModel> trees;
+	trees.SetSize( params.TreeCount );
+	NEOML_OMP_FOR_NUM_THREADS( params.ThreadCount )
+	for( int i = 0; i < params.TreeCount; i++ ) {
+		CRandom treeRandom( seeds[i] );
+		CPtr<const IProblem> sample = FINE_DEBUG_NEW CRandomForestSubproblem( problem, params.SubsampleRate, treeRandom );
+		CDecisionTree tree( treeParams, &treeRandom );
+		trees[i] = tree.Train( *sample );
+	}
+
+	if( logStream != 0 ) {
+		*logStream << "\nRandom forest training finished\n";
+	}
+
+	return FINE_DEBUG_NEW CRandomForestModel( trees, problem.GetClassCount() );
+}
+
+} // namespace NeoML
@@ -0,0 +1,123 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <RandomForestModel.h>
+#include <NeoMathEngine/OpenMP.h>
+
+namespace NeoML {
+
+IRandomForestModel::~IRandomForestModel() = default;
+
+REGISTER_NEOML_MODEL( CRandomForestModel, RandomForestModelName )
+
+CRandomForestModel::CRandomForestModel( CObjectArray<IModel>& _trees, int _classCount ) :
+	classCount( _classCount )
+{
+	NeoAssert( !_trees.IsEmpty() );
+	NeoAssert( classCount > 1 );
+	_trees.MoveTo( trees );
+}
+
+bool CRandomForestModel::Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const
+{
+	CArray<double> probabilities;
+	probabilities.Add( 0.0, classCount );
+	for( int i = 0; i < trees.Size(); i++ ) {
+		CClassificationResult treeResult;
+		NeoAssert( trees[i]->Classify( data, treeResult ) );
+		NeoAssert( treeResult.Probabilities.Size() == classCount );
+		for( int j = 0; j < classCount; j++ ) {
+			probabilities[j] += treeResult.Probabilities[j].GetValue();
+		}
+	}
+	setResult( probabilities.GetPtr(), result );
+	return true;
+}
+
+bool CRandomForestModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+
+	// Each tree processes the whole batch, probabilities[row * classCount + class] is the sum of the class probabilities
+	CArray<double> probabilities;
+	probabilities.Add( 0.0, data.Height * classCount );
+	for( int i = 0; i < trees.Size(); i++ ) {
+		NeoAssert( trees[i]->ClassifyBatch( data, results, threadCount ) );
+		NEOML_OMP_FOR_NUM_THREADS( threadCount )
+		for( int row = 0; row < data.Height; row++ ) {
+			NeoAssert( results[row].Probabilities.Size() == classCount );
+			for( int j = 0; j < classCount; j++ ) {
+				probabilities[row * classCount + j] += results[row].Probabilities[j].GetValue();
+			}
+		}
+	}
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int row = 0; row < data.Height; row++ ) {
+		setResult( probabilities.GetPtr() + row * classCount, results[row] );
+	}
+	return true;
+}
+
+void CRandomForestModel::Serialize( CArchive& archive )
+{
+	archive.SerializeVersion( 0 );
+
+	if( archive.IsStoring() ) {
+		archive << classCount;
+		archive << trees.Size();
+		for( int i = 0; i < trees.Size(); i++ ) {
+			archive << CString( GetModelName( trees[i] ) );
+			trees[i]->Serialize( archive );
+		}
+	} else if( archive.IsLoading() ) {
+		archive >> classCount;
+		int size = 0;
+		archive >> size;
+		trees.SetSize( size );
+		for( int i = 0; i < trees.Size(); i++ ) {
+			CString name;
+			archive >> name;
+			trees[i] = CreateModel<IModel>( name );
+			trees[i]->Serialize( archive );
+		}
+	} else {
+		NeoAssert( false );
+	}
+}
+
+// Fills the result by the sums of the class probabilities over the trees
+void CRandomForestModel::setResult( const double* probabilities, CClassificationResult& result ) const
+{
+	int preferredClass = 0;
+	for( int i = 1; i < classCount; i++ ) {
+		if( probabilities[i] > probabilities[preferredClass] ) {
+			preferredClass = i;
+		}
+	}
+
+	result.ExceptionProbability = CClassificationProbability( 0 );
+	result.PreferredClass = preferredClass;
+	result.Probabilities.SetSize( classCount );
+	for( int i = 0; i < classCount; i++ ) {
+		result.Probabilities[i] = CClassificationProbability( probabilities[i] / trees.Size() );
+	}
+}
+
+} // namespace NeoML
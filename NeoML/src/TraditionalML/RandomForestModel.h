@@ -0,0 +1,51 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoML/TraditionalML/RandomForest.h>
+
+namespace NeoML {
+
+// Random forest classifier
+class CRandomForestModel : public IRandomForestModel {
+public:
+	CRandomForestModel() : classCount( 0 ) {}
+	CRandomForestModel( CObjectArray<IModel>& trees, int classCount );
+
+	// For serialization
+	static CPtr<IModel> Create() { return FINE_DEBUG_NEW CRandomForestModel(); }
+
+	// IModel interface methods
+	int GetClassCount() const override { return classCount; }
+	bool Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const override;
+	bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const override;
+	void Serialize( CArchive& archive ) override;
+
+	// IRandomForestModel interface methods
+	const CObjectArray<IModel>& GetTrees() const override { return trees; }
+
+protected:
+	~CRandomForestModel() override = default; // delete prohibited
+
+private:
+	CObjectArray<IModel> trees; // the trees of the ensemble
+	int classCount; // the number of classes
+
+	void setResult( const double* probabilities, CClassificationResult& result ) const;
+};
+
+} // namespace NeoML
@@ -23,6 +23,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <SMOptimizer.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -184,10 +185,161 @@ void CKernelCache::SwapIndices( int i, int j )
 	}
 }
 
+CSvmKernelCache::CSvmKernelCache( const CSvmKernel& _kernel, const CFloatMatrixDesc& _matrix, int cacheSize,
+		bool _useFloat16 ) :
+	kernel( _kernel ),
+	matrix( _matrix ),
+	useFloat16( _useFloat16 )
+{
+	NeoAssert( cacheSize > 0 );
+
+	squaredNorms.SetSize( matrix.Height );
+	vectorIndices.SetHashTableSize( matrix.Height );
+	for( int i = 0; i < matrix.Height; i++ ) {
+		CFloatVectorDesc vector;
+		matrix.GetRow( i, vector );
+		squaredNorms[i] = DotProduct( vector, vector );
+		// The empty sparse vectors may share the pointer with the next vector
+		if( !vectorIndices.Has( vector.Values ) ) {
+			vectorIndices.Add( vector.Values, i );
+		}
+	}
+
+	rows.SetSize( matrix.Height );
+	lruPrev.Add( matrix.Height, matrix.Height + 1 );
+	lruNext.Add( matrix.Height, matrix.Height + 1 );
+	const int valueSize = useFloat16 ? sizeof( unsigned short ) : sizeof( float );
+	freeSpace = static_cast<int>( min( static_cast<int64_t>( INT_MAX ),
+		static_cast<int64_t>( cacheSize ) * ( 1 << 20 ) / valueSize ) );
+}
+
+int CSvmKernelCache::FindVector( const CFloatVectorDesc& vector ) const
+{
+	int index = NotFound;
+	if( !vectorIndices.Lookup( vector.Values, index ) ) {
+		return NotFound;
+	}
+	CFloatVectorDesc found;
+	matrix.GetRow( index, found );
+	if( found.Size != vector.Size || found.Indexes != vector.Indexes ) {
+		return NotFound;
+	}
+	return index;
+}
+
+CPtr<const CSvmKernelCache::CRow> CSvmKernelCache::GetRow( int i, int threadCount )
+{
+	NeoAssert( 0 <= i && i < matrix.Height );
+	{
+		CCriticalSectionLock lock( section );
+		if( rows[i] != nullptr ) {
+			lruDelete( i );
+			lruInsert( i );
+			return rows[i];
+		}
+	}
+
+	// The row is calculated without the lock, so the other threads may use the cache meanwhile
+	CPtr<CRow> row = FINE_DEBUG_NEW CRow();
+	if( useFloat16 ) {
+		row->Float16Values.SetSize( matrix.Height );
+	} else {
+		row->Values.SetSize( matrix.Height );
+	}
+	const CFloatVectorDesc x_i = matrix.GetRow( i );
+	const int curThreadCount = IsOmpRelevant( matrix.Height,
+		static_cast<int64_t>( matrix.Height ) * max( x_i.Size, 1 ) ) ? threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int j = 0; j < matrix.Height; j++ ) {
+		const float value = static_cast<float>( kernel.Calculate( x_i, squaredNorms[i], matrix.GetRow( j ), squaredNorms[j] ) );
+		if( useFloat16 ) {
+			row->Float16Values[j] = FloatToFloat16( value );
+		} else {
+			row->Values[j] = value;
+		}
+	}
+
+	CCriticalSectionLock lock( section );
+	if( rows[i] != nullptr ) {
+		// Another thread has calculated the same row
+		return rows[i];
+	}
+	const int head = matrix.Height;
+	while( freeSpace < matrix.Height && lruNext[head] != head ) {
+		const int old = lruNext[head];
+		lruDelete( old );
+		rows[old] = nullptr;
+		freeSpace += matrix.Height;
+	}
+	if( freeSpace >= matrix.Height ) {
+		rows[i] = row.Ptr();
+		lruInsert( i );
+		freeSpace -= matrix.Height;
+	}
+	return row.Ptr();
+}
+
+float CSvmKernelCache::Float16ToFloat( unsigned short value )
+{
+	const uint32_t sign = static_cast<uint32_t>( value & 0x8000 ) << 16;
+	const uint32_t exponent = ( value >> 10 ) & 0x1f;
+	const uint32_t mantissa = value & 0x3ff;
+	if( exponent == 0 ) {
+		// zero or subnormal number
+		const float result = ldexpf( static_cast<float>( mantissa ), -24 );
+		return sign != 0 ? -result : result;
+	}
+	// The infinity and NaN are never stored
+	const uint32_t bits = sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+	float result;
+	memcpy( &result, &bits, sizeof( result ) );
+	return result;
+}
+
+unsigned short CSvmKernelCache::FloatToFloat16( float value )
+{
+	uint32_t bits;
+	memcpy( &bits, &value, sizeof( bits ) );
+	const unsigned short sign = static_cast<unsigned short>( ( bits >> 16 ) & 0x8000 );
+	uint32_t absBits = bits & 0x7fffffff;
+	if( absBits >= 0x477fe000 ) {
+		// Saturate to the maximum float16 value (65504)
+		return sign | 0x7bff;
+	}
+	if( absBits < 0x38800000 ) {
+		// The subnormal float16 numbers have the fixed step 2^-24
+		const float absValue = fabsf( value );
+		return sign | static_cast<unsigned short>( absValue * 16777216.f + 0.5f );
+	}
+	// Change the exponent bias and round the mantissa to the nearest even
+	absBits -= 0x38000000;
+	return sign | static_cast<unsigned short>( ( absBits + 0xfff + ( ( absBits >> 13 ) & 1 ) ) >> 13 );
+}
+
+// Deletes the row from the LRU list
+void CSvmKernelCache::lruDelete( int i )
+{
+	lruNext[lruPrev[i]] = lruNext[i];
+	lruPrev[lruNext[i]] = lruPrev[i];
+}
+
+// Inserts the row into the end of the LRU list (so it will be deleted last)
+void CSvmKernelCache::lruInsert( int i )
+{
+	const int head = matrix.Height;
+	lruNext[i] = head;
+	lruPrev[i] = lruPrev[head];
+	lruNext[lruPrev[i]] = i;
+	lruPrev[head] = i;
+}
+
+//---------------------------------------------------------------------------------------------------
+
 // The kernel matrix CKernelMatrix(i, j) = K(i, j) * y_i * y_j
 class CKernelMatrix {
 public:
-	CKernelMatrix( const IProblem& data, const CSvmKernel& kernel, int cacheSize );
+	CKernelMatrix( const IProblem& data, const CSvmKernel& kernel, int cacheSize, int threadCount,
+		CSvmKernelCache* sharedCache );
 
 	// Gets the pointer to a column
 	const float* GetColumn( int i, int len ) const;
@@ -200,6 +352,8 @@ public:
 
 private:
 	CSvmKernel kernel; // the SVM kernel
+	const int threadCount; // the number of threads for calculating the columns
+	const CPtr<CSvmKernelCache> sharedCache; // the cache shared with the other optimizers (may be null)
 	mutable CKernelCache cache; // the columns cache
 	CArray<CFloatVectorDesc> matrix; // the problem data
 	CFloatVectorDesc* x; // raw pointer to data
@@ -207,24 +361,47 @@ private:
 	float* y; // raw pointer to binary classes
 	CArray<double> diagonal; // the matrix diagonal
 	double* d; // raw pointer to diagonal
+	CArray<double> squaredNormArray; // the squared norms of the vectors
+	double* squaredNorms; // raw pointer to squared norms
+	CArray<int> sharedIndexArray; // the indices of the vectors in the shared cache (NotFound if not there)
+	int* sharedIndices; // raw pointer to shared indices
+
+	double calculate( int i, int j ) const { return kernel.Calculate( x[i], squaredNorms[i], x[j], squaredNorms[j] ); }
+	void fillColumn( int i, float* column, int start, int len ) const;
+	void fillColumnFromSharedCache( int i, float* column, int start, int len ) const;
 };
 
-CKernelMatrix::CKernelMatrix( const IProblem& data, const CSvmKernel& kernel, int cacheSize ) :
+CKernelMatrix::CKernelMatrix( const IProblem& data, const CSvmKernel& kernel, int cacheSize, int _threadCount,
+		CSvmKernelCache* _sharedCache ) :
 	kernel(kernel), 
+	threadCount( _threadCount ),
+	sharedCache( _sharedCache ),
 	cache( data.GetVectorCount(), cacheSize * (1<<20) )
 {
-	matrix.SetSize( data.GetVectorCount() );
+	const int vectorCount = data.GetVectorCount();
+	matrix.SetSize( vectorCount );
 	x = matrix.GetPtr();
-	classes.SetSize( data.GetVectorCount() );
+	classes.SetSize( vectorCount );
 	y = classes.GetPtr();
-	diagonal.SetSize( data.GetVectorCount() );
+	diagonal.SetSize( vectorCount );
 	d = diagonal.GetPtr();
+	squaredNormArray.SetSize( vectorCount );
+	squaredNorms = squaredNormArray.GetPtr();
+	sharedIndexArray.SetSize( vectorCount );
+	sharedIndices = sharedIndexArray.GetPtr();
+
 	// Calculate the matrix diagonal and fill the matrix with sparse vector descs
-	for( int i = 0; i < diagonal.Size(); i++ ) {
+	const CFloatMatrixDesc desc = data.GetMatrix();
+	const int curThreadCount = IsOmpRelevant( vectorCount, static_cast<int64_t>( vectorCount ) * desc.Width ) ?
+		threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int i = 0; i < vectorCount; i++ ) {
 		auto& x_i = x[i];
 		y[i] = static_cast<float>( data.GetBinaryClass( i ) );
-		data.GetMatrix().GetRow( i, x_i );
+		desc.GetRow( i, x_i );
 		d[i] = kernel.Calculate( x_i, x_i );
+		squaredNorms[i] = DotProduct( x_i, x_i );
+		sharedIndices[i] = sharedCache == nullptr ? NotFound : sharedCache->FindVector( x_i );
 	}
 }
 
@@ -233,60 +410,90 @@ const float* CKernelMatrix::GetColumn( int i, int len ) const
 	float* column;
 	int start = cache.GetColumn( i, column, len );
 	if( start < len ) {
-		float y_i = y[i];
-		auto x_i = x[i];
-		auto calcData = [&]( int j ) {
-			// the cache matrix is symmetrical so col[i][j] == col[j][i]
-			int jColLen;
-			float* jColData = cache.GetColumn( j, jColLen );
-			if( jColLen > i ) {
-				column[j] = jColData[i];
-			} else {
-				column[j] = static_cast<float>( y_i * y[j] * kernel.Calculate( x_i, x[j] ) );
-			}
-		};
-
-		// set diagonal element if it's needed
-		if( i >= start && i < len ) {
-			for( int j = start; j < i; ++j ) {
-				calcData( j );
-			}
-			column[i] = static_cast<float>( d[i] );
-			for( int j = i+1; j < len; ++j ) {
-				calcData( j );
-			}
+		if( sharedIndices[i] != NotFound ) {
+			fillColumnFromSharedCache( i, column, start, len );
 		} else {
-			for( int j = start; j < len; ++j ) {
-				calcData( j );
-			}
+			fillColumn( i, column, start, len );
 		}
 	}
 	return column;
 }
 
+// Fills column[start, len) calculating the kernel
+void CKernelMatrix::fillColumn( int i, float* column, int start, int len ) const
+{
+	const float y_i = y[i];
+	const int curThreadCount = IsOmpRelevant( len - start,
+		static_cast<int64_t>( len - start ) * max( x[i].Size, 1 ) ) ? threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int j = start; j < len; ++j ) {
+		if( j == i ) {
+			column[j] = static_cast<float>( d[i] );
+			continue;
+		}
+		// the cache matrix is symmetrical so col[i][j] == col[j][i]
+		int jColLen;
+		const float* jColData = cache.GetColumn( j, jColLen );
+		if( jColLen > i ) {
+			column[j] = jColData[i];
+		} else {
+			column[j] = static_cast<float>( y_i * y[j] * calculate( i, j ) );
+		}
+	}
+}
+
+// Fills column[start, len) taking the kernel values from the shared cache row
+void CKernelMatrix::fillColumnFromSharedCache( int i, float* column, int start, int len ) const
+{
+	const CPtr<const CSvmKernelCache::CRow> row = sharedCache->GetRow( sharedIndices[i], threadCount );
+	const bool isFloat16 = !row->Float16Values.IsEmpty();
+	const float* values = row->Values.GetPtr();
+	const unsigned short* float16Values = row->Float16Values.GetPtr();
+	const float y_i = y[i];
+	const int curThreadCount = IsOmpRelevant( len - start, len - start ) ? threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int j = start; j < len; ++j ) {
+		const int index = sharedIndices[j];
+		if( j == i ) {
+			column[j] = static_cast<float>( d[i] );
+		} else if( index == NotFound ) {
+			column[j] = static_cast<float>( y_i * y[j] * calculate( i, j ) );
+		} else if( isFloat16 ) {
+			column[j] = y_i * y[j] * CSvmKernelCache::Float16ToFloat( float16Values[index] );
+		} else {
+			column[j] = y_i * y[j] * values[index];
+		}
+	}
+}
+
 void CKernelMatrix::SwapIndices( int i, int j )
 {
 	cache.SwapIndices( i, j );
 	swap( x[i], x[j] );
 	swap( y[i], y[j] );
 	swap( d[i], d[j] );
+	swap( squaredNorms[i], squaredNorms[j] );
+	swap( sharedIndices[i], sharedIndices[j] );
 }
 
 //---------------------------------------------------------------------------------------------------
 
 CSMOptimizer::CSMOptimizer(const CSvmKernel& kernel, const IProblem& _data,
-		int _maxIter, double _errorWeight, double _tolerance, bool _doShrinking, int cacheSize) :
+		int _maxIter, double _errorWeight, double _tolerance, bool _doShrinking, int cacheSize, int _threadCount,
+		CSvmKernelCache* sharedCache ) :
 	data( &_data ),
 	maxIter( _maxIter ),
 	errorWeight( _errorWeight ),
 	tolerance( _tolerance ),
 	doShrinking( _doShrinking ),
-	kernelMatrix( FINE_DEBUG_NEW CKernelMatrix( _data, kernel, cacheSize ) ),
+	kernelMatrix( FINE_DEBUG_NEW CKernelMatrix( _data, kernel, cacheSize, _threadCount, sharedCache ) ),
 	log( nullptr ),
 	vectorCount( data->GetVectorCount() ),
 	y( kernelMatrix->GetBinaryClasses() ),
-	matrixDiagonal( kernelMatrix->GetDiagonal() )
+	matrixDiagonal( kernelMatrix->GetDiagonal() ),
+	threadCount( _threadCount )
 {
+	NeoAssert( threadCount > 0 );
 	weightsMultErrorWeightArray.SetBufferSize( vectorCount );
 	for( int i = 0; i < vectorCount; ++i ) {
 		weightsMultErrorWeightArray.Add( data->GetVectorWeight( i ) * errorWeight );
@@ -534,6 +741,8 @@ void CSMOptimizer::optimizeIndices( int i, int j )
 	// Modify the g
 	double deltaAlpha_i = alpha[i] - oldAlpha_i;
 	double deltaAlpha_j = alpha[j] - oldAlpha_j;
+	const int curThreadCount = IsOmpRelevant( activeSize, activeSize ) ? threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
 	for(int k = 0; k < activeSize; k++) {
 		g[k] += q_i[k] * deltaAlpha_i + q_j[k] * deltaAlpha_j;
 	}
@@ -555,11 +764,14 @@ void CSMOptimizer::updateAlphaStatusAndGradient0( int i )
 	bool isUB = alphaStatus[i] == AS_UpperBound;
 	if( wasUB != isUB ) {
 		auto q_i = kernelMatrix->GetColumn( i, vectorCount );
+		const int curThreadCount = IsOmpRelevant( vectorCount, vectorCount ) ? threadCount : 1;
 		if( wasUB ) {
+			NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
 			for( int j = 0; j < vectorCount; ++j ) {
 				g0[j] -= c_i * q_i[j];
 			}
 		} else {
+			NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
 			for( int j = 0; j < vectorCount; ++j ) {
 				g0[j] += c_i * q_i[j];
 			}
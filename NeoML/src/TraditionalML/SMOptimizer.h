@@ -25,6 +25,53 @@ namespace NeoML {
 
 class CKernelMatrix;
 
+// The cache of the kernel rows over all vectors of a matrix
+// It is shared by the optimizers of the binary problems built from the same data (one versus all, one versus one)
+// The optimizer finds its vectors in the matrix by their data pointers, so the subproblems must refer to the matrix rows
+// The rows may be stored in float16 to fit twice as many of them in the same memory
+// The cache may be used from several threads
+class CSvmKernelCache : public IObject {
+public:
+	// cacheSize is the cache size in MB
+	CSvmKernelCache( const CSvmKernel& kernel, const CFloatMatrixDesc& matrix, int cacheSize, bool useFloat16 );
+
+	// The kernel row of one vector: K(x_i, x_j) for all j
+	class CRow : public IObject {
+	public:
+		// Only one of the arrays is filled
+		CArray<float> Values;
+		CArray<unsigned short> Float16Values;
+	};
+
+	// Finds the vector in the matrix, returns NotFound if the vector is not one of the matrix rows
+	int FindVector( const CFloatVectorDesc& vector ) const;
+	// Gets the kernel row of the i-th vector of the matrix, calculating it if necessary
+	CPtr<const CRow> GetRow( int i, int threadCount );
+
+	// Converts the values stored in float16
+	static float Float16ToFloat( unsigned short value );
+	static unsigned short FloatToFloat16( float value );
+
+protected:
+	~CSvmKernelCache() override = default;
+
+private:
+	const CSvmKernel kernel; // the SVM kernel
+	const CFloatMatrixDesc matrix; // the vectors
+	const bool useFloat16; // store the rows in float16
+	CArray<double> squaredNorms; // the squared norms of the vectors
+	CMap<const float*, int> vectorIndices; // the vector indices by their data pointers
+
+	CCriticalSection section; // guards the fields below
+	CArray<CPtr<const CRow>> rows; // the cached rows, null if not cached
+	CArray<int> lruPrev; // the LRU list of the cached rows; the matrix height is the list head
+	CArray<int> lruNext;
+	int freeSpace; // the number of row values that can be added to the cache
+
+	void lruDelete( int i );
+	void lruInsert( int i );
+};
+
 // The classification rule:
 //
 // Sum(alpha_i*y_i*K(x_i, x)) + freeTerm <> 0
@@ -45,8 +92,10 @@ public:
 	// data contains the training set
 	// tolerance is the required precision
 	// cacheSize is the cache size in MB
+	// threadCount is the number of threads used for calculating the kernel columns
+	// sharedCache is the cache shared with the other optimizers over the same data (may be null)
 	CSMOptimizer(const CSvmKernel& kernel, const IProblem& data, int maxIter, double errorWeight, double tolerance,
-		bool doShrinking, int cacheSize = 200);
+		bool doShrinking, int cacheSize = 200, int threadCount = 1, CSvmKernelCache* sharedCache = nullptr);
 	~CSMOptimizer();
 
 	// Calculates the optimal multipliers for the support vectors
@@ -86,6 +135,7 @@ private:
 	int vectorCount; // a problem length
 	const float* y; // vector of [-1,1] class labels
 	const double* matrixDiagonal; // matrix diagonal
+	int threadCount; // the number of threads for the gradient updates
 
 	CArray<TAlphaStatus> alphaStatusArray; // alpha statuses
 	TAlphaStatus* alphaStatus; // alpha status raw pointer array
@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <NeoML/TraditionalML/SubwordEncoder.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -36,6 +37,43 @@ ISubwordEncoderWithCache::CCache::CCachedData::CCachedData( CCachedData&& other
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void ISubwordEncoder::EncodeBatch( const CArray<CString>& words, CArray<int>& tokenIds,
+	CArray<int>& tokenLengths, CArray<int>& wordTokenCounts, int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	const int curThreadCount = IsOmpRelevant( words.Size() ) ? min( threadCount, words.Size() ) : 1;
+
+	// Each thread encodes a contiguous range of words, then the results are concatenated in the order of the threads
+	CArray<CArray<int>> threadTokenIds;
+	threadTokenIds.SetSize( curThreadCount );
+	CArray<CArray<int>> threadTokenLengths;
+	threadTokenLengths.SetSize( curThreadCount );
+	const int firstWordCount = wordTokenCounts.Size();
+	wordTokenCounts.Add( 0, words.Size() );
+
+	NEOML_OMP_NUM_THREADS( curThreadCount )
+	{
+		int start;
+		int count;
+		if( OmpGetTaskIndexAndCount( words.Size(), start, count ) ) {
+			CArray<int>& curTokenIds = threadTokenIds[OmpGetThreadNum()];
+			CArray<int>& curTokenLengths = threadTokenLengths[OmpGetThreadNum()];
+			for( int i = start; i < start + count; i++ ) {
+				const int prevSize = curTokenIds.Size();
+				Encode( words[i], curTokenIds, curTokenLengths );
+				wordTokenCounts[firstWordCount + i] = curTokenIds.Size() - prevSize;
+			}
+		}
+	}
+
+	for( int i = 0; i < curThreadCount; i++ ) {
+		tokenIds.Add( threadTokenIds[i] );
+		tokenLengths.Add( threadTokenLengths[i] );
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void ISubwordEncoderWithCache::CCache::SetCachePeriod( int newPeriod )
 {
 	NeoAssert( newPeriod == NotFound || newPeriod > 0 );
@@ -45,43 +83,62 @@ void ISubwordEncoderWithCache::CCache::SetCachePeriod( int newPeriod )
 	}
 }
 
+void ISubwordEncoderWithCache::CCache::Clear()
+{
+	for( CShard& shard : shards ) {
+		CCriticalSectionLock lock( shard.Section );
+		shard.CacheTime = 0;
+		shard.WordCache.DeleteAll();
+	}
+}
+
+ISubwordEncoderWithCache::CCache::CShard& ISubwordEncoderWithCache::CCache::getShard( const CString& word )
+{
+	return shards[static_cast<unsigned int>( CDefaultHash<CString>::HashKey( word ) ) % ShardCount];
+}
+
 bool ISubwordEncoderWithCache::CCache::Request( const CString& word,
 	CArray<int>& tokenIds, CArray<int>& tokenLengths )
 {
-	if( cachePeriod == NotFound ) {
+	const int period = cachePeriod;
+	if( period == NotFound ) {
 		return false;
 	}
+	const int shardPeriod = max( 1, period / ShardCount );
 
-	cacheTime++;
+	CShard& shard = getShard( word );
+	CCriticalSectionLock lock( shard.Section );
+	shard.CacheTime++;
 	bool success = false;
-	if( wordCache.Has( word ) ) {
-		CCachedData& wordData = wordCache.Get( word );
-		tokenIds.SetBufferSize( wordData.TokenIds.Size() );
-		tokenLengths.SetBufferSize( wordData.TokenLengths.Size() );
+	const TMapPosition wordPos = shard.WordCache.GetFirstPosition( word );
+	if( wordPos != NotFound ) {
+		CCachedData& wordData = shard.WordCache.GetValue( wordPos );
+		tokenIds.SetBufferSize( tokenIds.Size() + wordData.TokenIds.Size() );
+		tokenLengths.SetBufferSize( tokenLengths.Size() + wordData.TokenLengths.Size() );
 
 		for( int i = 0; i < wordData.TokenIds.Size(); i++ ) {
 			tokenIds.Add( wordData.TokenIds[i] );
 			tokenLengths.Add( wordData.TokenLengths[i] );
 		}
-		wordData.Time = cacheTime;
+		wordData.Time = shard.CacheTime;
 		success = true;
 	}
 
 	// Removes items from cache.
 	// The item is erased if there has not been a request with the same word since the previous cleanup. 
-	if( cacheTime % cachePeriod == 0 ) {
+	if( shard.CacheTime % shardPeriod == 0 ) {
 		CArray<CString> wordsToDelete;
-		for( TMapPosition pos = wordCache.GetFirstPosition(); pos != NotFound;
-			pos = wordCache.GetNextPosition( pos ) )
+		for( TMapPosition pos = shard.WordCache.GetFirstPosition(); pos != NotFound;
+			pos = shard.WordCache.GetNextPosition( pos ) )
 		{
-			const CCachedData& wordData = wordCache.GetValue( pos );
-			if( cacheTime - wordData.Time >= cachePeriod ) {
-				wordsToDelete.Add( wordCache.GetKey( pos ) );
+			const CCachedData& wordData = shard.WordCache.GetValue( pos );
+			if( shard.CacheTime - wordData.Time >= shardPeriod ) {
+				wordsToDelete.Add( shard.WordCache.GetKey( pos ) );
 			}
 		}
 
 		for( int i = 0; i < wordsToDelete.Size(); i++ ) {
-			wordCache.Delete( wordsToDelete[i] );
+			shard.WordCache.Delete( wordsToDelete[i] );
 		}
 	}
 
@@ -91,16 +148,24 @@ bool ISubwordEncoderWithCache::CCache::Request( const CString& word,
 void ISubwordEncoderWithCache::CCache::Add( const CString& word,
 	const CArray<int>& tokenIds, const CArray<int>& tokenLengths )
 {
-	NeoAssert( !wordCache.Has( word ) );
 	NeoAssert( tokenIds.Size() == tokenLengths.Size() );
-	
+	if( cachePeriod == NotFound ) {
+		return;
+	}
+
 	CCachedData wordData;
-	wordData.Time = cacheTime;
 	for( int i = 0; i < tokenIds.Size(); i++ ) {
 		wordData.TokenIds.Add( tokenIds[i] );
 		wordData.TokenLengths.Add( tokenLengths[i] );
 	}
-	wordCache.Add( word, wordData );
+
+	CShard& shard = getShard( word );
+	CCriticalSectionLock lock( shard.Section );
+	// Another thread may have already encoded the same word
+	if( !shard.WordCache.Has( word ) ) {
+		wordData.Time = shard.CacheTime;
+		shard.WordCache.Add( word, wordData );
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////
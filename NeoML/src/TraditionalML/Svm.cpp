@@ -27,32 +27,14 @@ limitations under the License.
 
 namespace NeoML {
 
-CSvm::CSvm( const CParams& _params ) :
-	params( _params ),
-	log( nullptr )
-{
-}
-
-CPtr<IModel> CSvm::Train( const IProblem& problem )
+// Trains a binary classifier
+static CPtr<IModel> trainBinarySvm( const CSvm::CParams& params, CTextStream* log, const IProblem& problem,
+	CSvmKernelCache* sharedCache )
 {
-	if( problem.GetClassCount() > 2 ) {
-		static_assert( MM_Count == 3, "MM_Count != 3" );
-		switch( params.MulticlassMode ) {
-			case MM_OneVsAll:
-				return COneVersusAll( *this ).Train( problem );
-			case MM_OneVsOne:
-				return COneVersusOne( *this ).Train( problem );
-			case MM_SingleClassifier:
-			default:
-				NeoAssert( false );
-		}
-		return nullptr;
-	}
-
 	CSvmKernel kernel( params.KernelType, params.Degree, params.Gamma, params.Coeff0 );
 
 	CSMOptimizer optimizer( kernel, problem, params.MaxIterations, params.ErrorWeight, params.Tolerance,
-		params.DoShrinking );
+		params.DoShrinking, params.CacheSize, params.ThreadCount, sharedCache );
 	if( log != nullptr ) {
 		optimizer.SetLog( log );
 	}
@@ -120,4 +102,52 @@ CPtr<IModel> CSvm::Train( const IProblem& problem )
 	}
 }
 
+// The binary classifiers trainer for the multiclass problem, which shares the kernel cache between classifiers
+class CSvmSharedCacheTrainer : public ITrainingModel {
+public:
+	CSvmSharedCacheTrainer( const CSvm::CParams& params, CTextStream* log, CSvmKernelCache& sharedCache ) :
+		params( params ), log( log ), sharedCache( sharedCache ) {}
+
+	CPtr<IModel> Train( const IProblem& problem ) override
+		{ return trainBinarySvm( params, log, problem, &sharedCache ); }
+
+private:
+	const CSvm::CParams& params;
+	CTextStream* const log;
+	CSvmKernelCache& sharedCache;
+};
+
+//---------------------------------------------------------------------------------------------------------
+
+CSvm::CSvm( const CParams& _params ) :
+	params( _params ),
+	log( nullptr )
+{
+}
+
+CPtr<IModel> CSvm::Train( const IProblem& problem )
+{
+	if( problem.GetClassCount() > 2 ) {
+		// The binary problems are built over the same vectors, so the kernel rows are calculated once for all of them
+		CSvmKernel kernel( params.KernelType, params.Degree, params.Gamma, params.Coeff0 );
+		CPtr<CSvmKernelCache> sharedCache = FINE_DEBUG_NEW CSvmKernelCache( kernel, problem.GetMatrix(),
+			params.CacheSize, params.Float16Cache );
+		CSvmSharedCacheTrainer trainer( params, log, *sharedCache );
+
+		static_assert( MM_Count == 3, "MM_Count != 3" );
+		switch( params.MulticlassMode ) {
+			case MM_OneVsAll:
+				return COneVersusAll( trainer, params.ThreadCount ).Train( problem );
+			case MM_OneVsOne:
+				return COneVersusOne( trainer, params.ThreadCount ).Train( problem );
+			case MM_SingleClassifier:
+			default:
+				NeoAssert( false );
+		}
+		return nullptr;
+	}
+
+	return trainBinarySvm( params, log, problem, nullptr );
+}
+
 } // namespace NeoML
@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <SvmBinaryModel.h>
+#include <NeoMathEngine/OpenMP.h>
 
 namespace NeoML {
 
@@ -63,6 +64,39 @@ bool CSvmBinaryModel::Classify( const CFloatVectorDesc& data, CClassificationRes
 		value += alpha[i] * kernel.Calculate( data, desc );
 	}
 
+	classify( value, result );
+	return true;
+}
+
+bool CSvmBinaryModel::ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+	int threadCount ) const
+{
+	NeoAssert( threadCount > 0 );
+	results.SetSize( data.Height );
+
+	// The support vectors are shared by all the rows
+	CArray<CFloatVectorDesc> vectors;
+	vectors.SetSize( alpha.Size() );
+	for( int i = 0; i < alpha.Size(); i++ ) {
+		matrix.GetRow( i, vectors[i] );
+	}
+
+	NEOML_OMP_FOR_NUM_THREADS( threadCount )
+	for( int i = 0; i < data.Height; i++ ) {
+		CFloatVectorDesc row;
+		data.GetRow( i, row );
+		double value = freeTerm;
+		for( int j = 0; j < vectors.Size(); j++ ) {
+			value += alpha[j] * kernel.Calculate( row, vectors[j] );
+		}
+		classify( value, results[i] );
+	}
+	return true;
+}
+
+// Calculates the classification result from the value of the decision function
+void CSvmBinaryModel::classify( double value, CClassificationResult& result )
+{
 	const double probability = 1 / ( 1 + exp( value ) );
 	result.ExceptionProbability = CClassificationProbability( 0 );
 	result.Probabilities.SetSize( 2 );
@@ -74,7 +108,6 @@ bool CSvmBinaryModel::Classify( const CFloatVectorDesc& data, CClassificationRes
 	} else {
 		result.PreferredClass = 1;
 	}
-	return true;
 }
 
 void CSvmBinaryModel::Serialize( CArchive& archive )
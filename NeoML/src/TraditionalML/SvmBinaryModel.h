@@ -31,6 +31,8 @@ public:
 	// IModel interface methods
 	int GetClassCount() const override { return 2; }
 	bool Classify( const CFloatVectorDesc& data, CClassificationResult& result ) const override;
+	bool ClassifyBatch( const CFloatMatrixDesc& data, CArray<CClassificationResult>& results,
+		int threadCount = 1 ) const override;
 	void Serialize( CArchive& archive ) override;
 
 	// ISvmBinaryModel interface methods
@@ -47,6 +49,8 @@ private:
 	double freeTerm{}; // the free term
 	CSparseFloatMatrix matrix; // the support vectors
 	CArray<double> alpha; // the coefficients
+
+	static void classify( double value, CClassificationResult& result );
 };
 
 } // namespace NeoML
@@ -98,6 +98,17 @@ double CSvmKernel::Calculate(const CFloatVectorDesc& x1, const CFloatVectorDesc&
 	}
 }
 
+double CSvmKernel::Calculate( const CFloatVectorDesc& x1, double squaredNorm1,
+	const CFloatVectorDesc& x2, double squaredNorm2 ) const
+{
+	if( kernelType != KT_RBF ) {
+		return Calculate( x1, x2 );
+	}
+	// The rounding errors may make the squared distance between close vectors negative
+	const double square = max( 0., squaredNorm1 + squaredNorm2 - 2 * DotProduct( x1, x2 ) );
+	return exp( -gamma * square );
+}
+
 double CSvmKernel::rbfDenseBySparse( const CFloatVectorDesc& x1, const CFloatVectorDesc& x2 ) const
 {
 	double square = 0;
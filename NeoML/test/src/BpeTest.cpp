@@ -17,6 +17,7 @@ limitations under the License.
 #pragma hdrstop
 
 #include <TestFixture.h>
+#include <thread>
 
 using namespace NeoML;
 using namespace NeoMLTest;
@@ -360,3 +361,137 @@ TEST_F( CBpeTest, UnknownId )
 		EXPECT_EQ( tokenIds[i] + offset, newTokenIds[i] );
 	}
 }
+
+// The straightforward implementation of encoding: the leftmost pair with the lowest token index is merged on each step
+static void naiveEncode( const CMap<CString, int>& tokenToId, const IBytePairEncoder& encoder, const CString& word,
+	CArray<int>& tokenIds )
+{
+	CArray<CString> wordTokens;
+	if( encoder.UseStartOfWordToken() ) {
+		wordTokens.Add( "/\xFF" );
+	}
+	for( int i = 0; i < word.Length(); ++i ) {
+		wordTokens.Add( CString( ( const char* )word + i, 1 ) );
+	}
+	if( encoder.UseEndOfWordToken() ) {
+		wordTokens.Add( "\\\xFF" );
+	}
+
+	while( true ) {
+		int bestId = NotFound;
+		int bestPos = NotFound;
+		for( int i = 0; i < wordTokens.Size() - 1; ++i ) {
+			int id = NotFound;
+			if( tokenToId.Lookup( wordTokens[i] + wordTokens[i + 1], id ) && ( bestId == NotFound || id < bestId ) ) {
+				bestId = id;
+				bestPos = i;
+			}
+		}
+		if( bestId == NotFound ) {
+			break;
+		}
+		wordTokens[bestPos] += wordTokens[bestPos + 1];
+		wordTokens.DeleteAt( bestPos + 1 );
+	}
+
+	for( int i = 0; i < wordTokens.Size(); ++i ) {
+		int id = NotFound;
+		tokenIds.Add( tokenToId.Lookup( wordTokens[i], id ) ? id : encoder.UnknownTokenId() );
+	}
+}
+
+TEST_F( CBpeTest, CompareWithNaive )
+{
+	CString trainText = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor"
+		" incididunt ut labore et dolore magna aliqua ut enim ad minim veniam quis nostrud exercitation ullamco laboris nisi ut aliquip ex"
+		" ea commodo consequat duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur excepteur"
+		" sint occaecat cupidatat non proident sunt in culpa qui officia deserunt mollit anim id est laborum aaaaaaaaaaaa abababababab .";
+	auto dictionary = fillDictionary( trainText );
+
+	CBytePairEncoderTrainer trainer( { 150, true, true, false }, dictionary );
+	auto tokenizer = trainer.Train();
+	CMap<CString, int> tokenToId;
+	tokenizer->GetTokenToIdMapping( tokenToId );
+
+	CArray<CString> words;
+	splitString( trainText + " mattis pellentesque id nibh tortor aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa xyz"
+		" ababababababababababababababab aliquetaliquetaliquet", words );
+	for( int i = 0; i < words.Size(); ++i ) {
+		CArray<int> tokenIds, tokenLengths;
+		tokenizer->Encode( words[i], tokenIds, tokenLengths );
+		CArray<int> expectedIds;
+		naiveEncode( tokenToId, *tokenizer, words[i], expectedIds );
+		EXPECT_EQ( expectedIds, tokenIds ) << words[i];
+	}
+}
+
+TEST_F( CBpeTest, EncodeBatch )
+{
+	CString trainText = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor"
+		" incididunt ut labore et dolore magna aliqua ut enim ad minim veniam quis nostrud exercitation ullamco laboris nisi ut aliquip ex";
+	auto dictionary = fillDictionary( trainText );
+
+	CBytePairEncoderTrainer trainer( { 50, true, false, false }, dictionary );
+	auto tokenizer = trainer.Train();
+
+	CArray<CString> words;
+	splitString( trainText + " ea commodo consequat duis aute irure dolor in reprehenderit in voluptate velit esse", words );
+
+	CArray<int> expectedIds, expectedLengths, expectedCounts;
+	for( int i = 0; i < words.Size(); ++i ) {
+		const int size = expectedIds.Size();
+		tokenizer->Encode( words[i], expectedIds, expectedLengths );
+		expectedCounts.Add( expectedIds.Size() - size );
+	}
+
+	for( int threadCount = 1; threadCount <= 4; threadCount *= 2 ) {
+		CArray<int> tokenIds, tokenLengths, wordTokenCounts;
+		tokenizer->EncodeBatch( words, tokenIds, tokenLengths, wordTokenCounts, threadCount );
+		EXPECT_EQ( expectedIds, tokenIds );
+		EXPECT_EQ( expectedLengths, tokenLengths );
+		EXPECT_EQ( expectedCounts, wordTokenCounts );
+	}
+}
+
+TEST_F( CBpeTest, ConcurrentEncode )
+{
+	CString trainText = "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod tempor"
+		" incididunt ut labore et dolore magna aliqua ut enim ad minim veniam quis nostrud exercitation ullamco laboris nisi ut aliquip ex";
+	auto dictionary = fillDictionary( trainText );
+
+	CBytePairEncoderTrainer trainer( { 50, false, true, false }, dictionary );
+	auto tokenizer = trainer.Train();
+
+	CArray<CString> words;
+	splitString( trainText, words );
+	CArray<int> expectedIds, expectedLengths;
+	for( int i = 0; i < words.Size(); ++i ) {
+		tokenizer->Encode( words[i], expectedIds, expectedLengths );
+	}
+
+	// A small cache period makes the cache be cleaned up while the other threads are using it
+	tokenizer->SetCachePeriod( 20 );
+	const int threadCount = 4;
+	CArray<int> threadIds[threadCount];
+	CArray<int> threadLengths[threadCount];
+	std::vector<std::thread> threads;
+	for( int t = 0; t < threadCount; ++t ) {
+		threads.emplace_back( [&, t]() {
+			for( int repeat = 0; repeat < 10; ++repeat ) {
+				threadIds[t].DeleteAll();
+				threadLengths[t].DeleteAll();
+				for( int i = 0; i < words.Size(); ++i ) {
+					tokenizer->Encode( words[i], threadIds[t], threadLengths[t] );
+				}
+			}
+		} );
+	}
+	for( auto& thread : threads ) {
+		thread.join();
+	}
+
+	for( int t = 0; t < threadCount; ++t ) {
+		EXPECT_EQ( expectedIds, threadIds[t] );
+		EXPECT_EQ( expectedLengths, threadLengths[t] );
+	}
+}
@@ -327,6 +327,98 @@ TEST_F( RandomBinaryClassification4000x20, DecisionTree )
 	TestBinaryClassificationResult();
 }
 
+TEST_F( RandomBinaryClassification4000x20, DecisionTreeThreadCount )
+{
+	CDecisionTree::CParams param;
+	param.ThreadCount = 4;
+	CDecisionTree decisionTree( param );
+	TrainBinary( decisionTree );
+	TestBinaryClassificationResult();
+
+	// The tree does not depend on the number of threads
+	param.ThreadCount = 1;
+	CDecisionTree singleThreadDecisionTree( param );
+	CPtr<IModel> singleThreadModel = singleThreadDecisionTree.Train( *DenseRandomBinaryProblem );
+	for( int i = 0; i < DenseBinaryTestData->GetVectorCount(); i++ ) {
+		CClassificationResult expected;
+		CClassificationResult result;
+		ASSERT_TRUE( singleThreadModel->Classify( DenseBinaryTestData->GetVector( i ), expected ) );
+		ASSERT_TRUE( ModelDense->Classify( DenseBinaryTestData->GetVector( i ), result ) );
+		ASSERT_EQ( expected.PreferredClass, result.PreferredClass );
+		for( int j = 0; j < expected.Probabilities.Size(); j++ ) {
+			ASSERT_DOUBLE_EQ( expected.Probabilities[j].GetValue(), result.Probabilities[j].GetValue() );
+		}
+	}
+}
+
+TEST_F( RandomMultiClassification2000x20, RandomForest )
+{
+	CRandomForest::CParams params;
+	params.TreeCount = 20;
+	params.ThreadCount = 4;
+	CRandom random( 0 );
+	CRandomForest forest( params, &random );
+	ModelDense = forest.Train( *DenseRandomMultiProblem );
+	random.Reset( 0 );
+	ModelSparse = forest.Train( *SparseRandomMultiProblem );
+	TestMultiClassificationResult();
+
+	// The ensemble does not depend on the number of threads
+	params.ThreadCount = 1;
+	random.Reset( 0 );
+	CRandomForest singleThreadForest( params, &random );
+	CPtr<IModel> singleThreadModel = singleThreadForest.Train( *DenseRandomMultiProblem );
+
+	CMemoryFile file;
+	{
+		CArchive archive( &file, CArchive::store );
+		SerializeModel( archive, ModelDense );
+	}
+	file.SeekToBegin();
+	CPtr<IModel> loadedModel;
+	{
+		CArchive archive( &file, CArchive::load );
+		SerializeModel( archive, loadedModel );
+	}
+	ASSERT_EQ( 20, CheckCast<IRandomForestModel>( loadedModel )->GetTrees().Size() );
+
+	for( int i = 0; i < DenseMultiTestData->GetVectorCount(); i++ ) {
+		CClassificationResult expected;
+		ASSERT_TRUE( ModelDense->Classify( DenseMultiTestData->GetVector( i ), expected ) );
+		for( const IModel* model : { singleThreadModel.Ptr(), loadedModel.Ptr() } ) {
+			CClassificationResult result;
+			ASSERT_TRUE( model->Classify( DenseMultiTestData->GetVector( i ), result ) );
+			ASSERT_EQ( expected.PreferredClass, result.PreferredClass );
+			for( int j = 0; j < expected.Probabilities.Size(); j++ ) {
+				ASSERT_DOUBLE_EQ( expected.Probabilities[j].GetValue(), result.Probabilities[j].GetValue() );
+			}
+		}
+	}
+}
+
+TEST_F( RandomBinaryClassification4000x20, ParallelCrossValidation )
+{
+	CLinear::CParams params( EF_SquaredHinge );
+	CLinear linear( params );
+	CCrossValidation crossValidation( linear, DenseRandomBinaryProblem );
+	CCrossValidationResult expected;
+	crossValidation.Execute( 5, AccuracyScore, expected, true );
+
+	CCrossValidation parallelCrossValidation( linear, DenseRandomBinaryProblem, 4 );
+	CCrossValidationResult result;
+	parallelCrossValidation.Execute( 5, AccuracyScore, result, true );
+
+	ASSERT_EQ( expected.Models.Size(), result.Models.Size() );
+	for( int i = 0; i < expected.Success.Size(); i++ ) {
+		ASSERT_EQ( expected.Success[i], result.Success[i] );
+	}
+	ASSERT_EQ( expected.Results.Size(), result.Results.Size() );
+	for( int i = 0; i < expected.Results.Size(); i++ ) {
+		ASSERT_EQ( expected.ModelIndex[i], result.ModelIndex[i] );
+		ASSERT_EQ( expected.Results[i].PreferredClass, result.Results[i].PreferredClass );
+	}
+}
+
 TEST_F( RandomMultiClassification2000x20, GBTB_Full )
 {
 	CRandom random( 0 );
@@ -454,6 +546,88 @@ TEST_F( RandomMultiClassification2000x20, OneVsAllDecisionTree )
 	TestClassificationResult( ModelSparse, modelImplicitSparse, DenseMultiTestData, SparseMultiTestData );
 }
 
+// Checks that the models give exactly the same results
+static void checkSameClassification( const IModel& expectedModel, const IModel& model, const CClassificationRandomProblem& testData )
+{
+	for( int i = 0; i < testData.GetVectorCount(); i++ ) {
+		CClassificationResult expected;
+		CClassificationResult result;
+		ASSERT_TRUE( expectedModel.Classify( testData.GetVector( i ), expected ) );
+		ASSERT_TRUE( model.Classify( testData.GetVector( i ), result ) );
+		ASSERT_EQ( expected.PreferredClass, result.PreferredClass );
+		ASSERT_EQ( expected.Probabilities.Size(), result.Probabilities.Size() );
+		for( int j = 0; j < expected.Probabilities.Size(); j++ ) {
+			ASSERT_DOUBLE_EQ( expected.Probabilities[j].GetValue(), result.Probabilities[j].GetValue() );
+		}
+	}
+}
+
+TEST_F( RandomMultiClassification2000x20, ParallelOneVsAllOneVsOne )
+{
+	CLinear::CParams params( EF_SquaredHinge );
+	CLinear linear( params );
+
+	COneVersusAll ova( linear );
+	COneVersusAll parallelOva( linear, 4 );
+	checkSameClassification( *ova.Train( *DenseRandomMultiProblem ),
+		*parallelOva.Train( *DenseRandomMultiProblem ), *DenseMultiTestData );
+
+	COneVersusOne ovo( linear );
+	COneVersusOne parallelOvo( linear, 4 );
+	checkSameClassification( *ovo.Train( *SparseRandomMultiProblem ),
+		*parallelOvo.Train( *SparseRandomMultiProblem ), *SparseMultiTestData );
+}
+
+TEST_F( RandomMultiClassification2000x20, SvmSharedCache )
+{
+	CSvm::CParams params( CSvmKernel::KT_RBF );
+	params.ThreadCount = 4;
+
+	// The kernel cache shared by the binary classifiers does not change them
+	CSvm ovaSvm( params );
+	COneVersusAll ova( ovaSvm );
+	checkSameClassification( *ova.Train( *DenseRandomMultiProblem ),
+		*ovaSvm.Train( *DenseRandomMultiProblem ), *DenseMultiTestData );
+
+	params.MulticlassMode = MM_OneVsOne;
+	CSvm ovoSvm( params );
+	COneVersusOne ovo( ovoSvm );
+	checkSameClassification( *ovo.Train( *SparseRandomMultiProblem ),
+		*ovoSvm.Train( *SparseRandomMultiProblem ), *SparseMultiTestData );
+
+	// The float16 cache gives almost the same classifier
+	params.MulticlassMode = MM_OneVsAll;
+	CPtr<IModel> model = CSvm( params ).Train( *DenseRandomMultiProblem );
+	params.Float16Cache = true;
+	CPtr<IModel> float16Model = CSvm( params ).Train( *DenseRandomMultiProblem );
+	int sameCount = 0;
+	for( int i = 0; i < DenseMultiTestData->GetVectorCount(); i++ ) {
+		CClassificationResult expected;
+		CClassificationResult result;
+		ASSERT_TRUE( model->Classify( DenseMultiTestData->GetVector( i ), expected ) );
+		ASSERT_TRUE( float16Model->Classify( DenseMultiTestData->GetVector( i ), result ) );
+		if( expected.PreferredClass == result.PreferredClass ) {
+			sameCount++;
+		}
+	}
+	EXPECT_LE( 0.95 * DenseMultiTestData->GetVectorCount(), sameCount );
+}
+
+TEST_F( RandomBinaryClassification4000x20, SvmRbfThreadCount )
+{
+	CSvm::CParams params( CSvmKernel::KT_RBF );
+	params.ThreadCount = 4;
+	CSvm svmRbf( params );
+	TrainBinary( svmRbf );
+	TestBinaryClassificationResult();
+
+	// The kernel columns do not depend on the number of threads
+	params.ThreadCount = 1;
+	CSvm singleThreadSvmRbf( params );
+	checkSameClassification( *ModelDense, *singleThreadSvmRbf.Train( *DenseRandomBinaryProblem ), *DenseBinaryTestData );
+	checkSameClassification( *ModelSparse, *singleThreadSvmRbf.Train( *SparseRandomBinaryProblem ), *SparseBinaryTestData );
+}
+
 TEST_F( RandomMultiClassification2000x20, OneVsOneLinear )
 {
 	CLinear::CParams params( EF_SquaredHinge );
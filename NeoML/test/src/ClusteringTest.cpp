@@ -215,6 +215,34 @@ static void kmeansElkanClustering( IClusteringData* data, CClusteringResult& res
 	kMeans.Clusterize( data, result );
 }
 
+static void kmeansHamerlyClustering( IClusteringData* data, CClusteringResult& result )
+{
+	CKMeansClustering::CParam params;
+	params.DistanceFunc = DF_Euclid;
+	params.InitialClustersCount = 2;
+	params.MaxIterations = 50;
+	params.Algo = CKMeansClustering::KMA_Hamerly;
+	params.Initialization = CKMeansClustering::KMI_KMeansPlusPlus;
+	params.ThreadCount = 4;
+
+	CKMeansClustering kMeans( params );
+	kMeans.Clusterize( data, result );
+}
+
+static void kmeansMiniBatchClustering( IClusteringData* data, CClusteringResult& result )
+{
+	CKMeansClustering::CParam params;
+	params.DistanceFunc = DF_Euclid;
+	params.InitialClustersCount = 2;
+	params.MaxIterations = 50;
+	params.Algo = CKMeansClustering::KMA_MiniBatch;
+	params.Initialization = CKMeansClustering::KMI_KMeansPlusPlus;
+	params.ThreadCount = 4;
+
+	CKMeansClustering kMeans( params );
+	kMeans.Clusterize( data, result );
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // Result check functions
 
@@ -403,6 +431,20 @@ static void kmeansElkanDefaultInitClustering( IClusteringData* data, CClustering
 	kMeans.Clusterize( data, result );
 }
 
+static void kmeansHamerlyDefaultInitClustering( IClusteringData* data, CClusteringResult& result )
+{
+	CKMeansClustering::CParam params;
+	params.DistanceFunc = DF_Euclid;
+	params.InitialClustersCount = 2;
+	params.MaxIterations = 50;
+	params.Algo = CKMeansClustering::KMA_Hamerly;
+	params.Initialization = CKMeansClustering::KMI_Default;
+	params.ThreadCount = 4;
+
+	CKMeansClustering kMeans( params );
+	kMeans.Clusterize( data, result );
+}
+
 TEST_F( CClusteringTest, PrecalcKmeans )
 {
 	CClusteringResult expectedResult;
@@ -418,6 +460,84 @@ TEST_F( CClusteringTest, PrecalcKmeans )
 	precalcTestImpl( kmeansLloydClustering, expectedResult );
 	// Check that different algos with the same initialization return similar results
 	precalcTestImpl( kmeansElkanDefaultInitClustering, expectedResult );
+	precalcTestImpl( kmeansHamerlyDefaultInitClustering, expectedResult );
+}
+
+// The sum of squared distances from the elements to the centers of their clusters
+static double calcInertia( IClusteringData* data, const CClusteringResult& result )
+{
+	double inertia = 0;
+	for( int i = 0; i < data->GetVectorCount(); ++i ) {
+		inertia += CalcDistance( result.Clusters[result.Data[i]], data->GetMatrix().GetRow( i ), DF_Euclid );
+	}
+	return inertia;
+}
+
+TEST_F( CClusteringTest, KMeansThreadCount )
+{
+	CPtr<IClusteringData> sparseData = nullptr;
+	CPtr<IClusteringData> denseData = nullptr;
+	generateData( 512, 32, 0x1984, sparseData, denseData );
+
+	CKMeansClustering::CParam params;
+	params.DistanceFunc = DF_Euclid;
+	params.InitialClustersCount = 10;
+	params.MaxIterations = 50;
+	params.MiniBatchSize = 64;
+	params.Initialization = CKMeansClustering::KMI_Default;
+
+	for( int algo = 0; algo < CKMeansClustering::KMA_Count; ++algo ) {
+		params.Algo = static_cast<CKMeansClustering::TKMeansAlgo>( algo );
+		params.ThreadCount = 1;
+		CClusteringResult expectedResult;
+		CKMeansClustering( params ).Clusterize( sparseData, expectedResult );
+
+		params.ThreadCount = 4;
+		CClusteringResult result;
+		CKMeansClustering( params ).Clusterize( sparseData, result );
+
+		EXPECT_TRUE( isEqual( expectedResult, result ) ) << algo;
+		EXPECT_EQ( expectedResult.Data, result.Data ) << algo;
+	}
+}
+
+TEST_F( CClusteringTest, KMeansMiniBatch )
+{
+	CPtr<IClusteringData> sparseData = nullptr;
+	CPtr<IClusteringData> denseData = nullptr;
+	generateData( 2048, 16, 0x1984, sparseData, denseData );
+
+	CKMeansClustering::CParam params;
+	params.DistanceFunc = DF_Euclid;
+	params.InitialClustersCount = 8;
+	params.MaxIterations = 100;
+	params.Initialization = CKMeansClustering::KMI_KMeansPlusPlus;
+	params.ThreadCount = 4;
+
+	params.Algo = CKMeansClustering::KMA_Lloyd;
+	CClusteringResult lloydResult;
+	CKMeansClustering( params ).Clusterize( sparseData, lloydResult );
+
+	params.Algo = CKMeansClustering::KMA_MiniBatch;
+	params.MiniBatchSize = 256;
+	CClusteringResult miniBatchResult;
+	CKMeansClustering( params ).Clusterize( sparseData, miniBatchResult );
+
+	ASSERT_EQ( lloydResult.ClusterCount, miniBatchResult.ClusterCount );
+	ASSERT_EQ( sparseData->GetVectorCount(), miniBatchResult.Data.Size() );
+	// The mini-batch result is an approximation of the full one
+	EXPECT_LT( calcInertia( sparseData, miniBatchResult ), 1.05 * calcInertia( sparseData, lloydResult ) );
+
+	// The weights and the variances of the clusters are calculated as in the other algorithms
+	double totalWeight = 0;
+	for( int i = 0; i < miniBatchResult.ClusterCount; i++ ) {
+		const CClusterCenter& center = miniBatchResult.Clusters[i];
+		totalWeight += center.Weight;
+		for( int j = 0; j < center.Disp.Size(); j++ ) {
+			EXPECT_LT( 0.f, center.Disp[j] );
+		}
+	}
+	EXPECT_DOUBLE_EQ( sparseData->GetVectorCount(), totalWeight );
 }
 
 // Returns data with a specific dendrogram (only Distances may vary)
@@ -578,4 +698,5 @@ INSTANTIATE_TEST_CASE_P( CClusteringTestInstantiation, CClusteringTest,
 		hierarchicalClustering<CHierarchicalClustering::L_Average>,
 		hierarchicalClustering<CHierarchicalClustering::L_Complete>,
 		hierarchicalClustering<CHierarchicalClustering::L_Ward>,
-		isoDataClustering, kmeansElkanClustering, kmeansLloydClustering ) );
+		isoDataClustering, kmeansElkanClustering, kmeansLloydClustering,
+		kmeansHamerlyClustering, kmeansMiniBatchClustering ) );
@@ -0,0 +1,111 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+#include <cstdio>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static void buildMappedModelTestDnn( CDnn& dnn )
+{
+	CSourceLayer* data = Source( dnn, "data" );
+	CConvLayer* conv = Conv( 6, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "conv", data );
+	CBatchNormalizationLayer* batchNorm = BatchNormalization( true )( "batchNorm", conv );
+	CReLULayer* relu = Relu()( "relu", batchNorm );
+	CFullyConnectedLayer* fc = FullyConnected( 7 )( "fc", relu );
+	Sink( fc, "sink" );
+}
+
+static void runMappedModelTestDnn( CDnn& dnn, const CDnnBlob& input, CArray<float>& output )
+{
+	CheckCast<CSourceLayer>( dnn.GetLayer( "data" ) )->SetBlob( input.GetCopy() );
+	dnn.RunOnce();
+	CPtr<CDnnBlob> result = CheckCast<CSinkLayer>( dnn.GetLayer( "sink" ) )->GetBlob();
+	output.SetSize( result->GetDataSize() );
+	result->CopyTo( output.GetPtr() );
+}
+
+TEST( DnnMappedModelTest, StoreAndLoad )
+{
+	const char* fileName = "mapped_model.bin";
+	CRandom random( 0x89a );
+	CPtr<CDnnBlob> input = CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, 2, 1, 5, 4, 1, 3 } );
+	CArray<float> inputData;
+	for( int i = 0; i < input->GetDataSize(); ++i ) {
+		inputData.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	input->CopyFrom( inputData.GetPtr() );
+
+	CArray<float> expected;
+	{
+		CDnn dnn( random, MathEngine() );
+		buildMappedModelTestDnn( dnn );
+		runMappedModelTestDnn( dnn, *input, expected );
+		dnn.StoreMapped( fileName );
+	}
+
+	CArray<float> actual;
+	{
+		CDnn dnn( random, MathEngine() );
+		dnn.LoadMapped( fileName );
+		ASSERT_EQ( 6, dnn.GetLayerCount() );
+		runMappedModelTestDnn( dnn, *input, actual );
+		ASSERT_EQ( expected.Size(), actual.Size() );
+		for( int i = 0; i < expected.Size(); ++i ) {
+			ASSERT_EQ( expected[i], actual[i] ) << "at index " << i;
+		}
+
+		// The change of the parameters isn't written to the file
+		CFullyConnectedLayer* fc = CheckCast<CFullyConnectedLayer>( dnn.GetLayer( "fc" ) );
+		CPtr<CDnnBlob> weights = fc->GetWeightsData();
+		weights->Fill( 0.5f );
+		fc->SetWeightsData( weights );
+		runMappedModelTestDnn( dnn, *input, actual );
+		EXPECT_NE( expected[0], actual[0] );
+	}
+
+	{
+		CDnn dnn( random, MathEngine() );
+		dnn.LoadMapped( fileName );
+		runMappedModelTestDnn( dnn, *input, actual );
+		for( int i = 0; i < expected.Size(); ++i ) {
+			ASSERT_EQ( expected[i], actual[i] ) << "at index " << i;
+		}
+	}
+
+	// The mapping is released together with the network
+	std::remove( fileName );
+}
+
+TEST( DnnMappedModelTest, WrongFormat )
+{
+	const char* fileName = "mapped_model_wrong.bin";
+	CRandom random( 0x89b );
+	{
+		CDnn dnn( random, MathEngine() );
+		buildMappedModelTestDnn( dnn );
+		CArchiveFile file( fileName, CArchive::store, GetPlatformEnv() );
+		CArchive archive( &file, CArchive::store );
+		dnn.Serialize( archive );
+	}
+
+	CDnn dnn( random, MathEngine() );
+	EXPECT_ANY_THROW( dnn.LoadMapped( fileName ) );
+	EXPECT_EQ( 0, std::remove( fileName ) );
+}
@@ -0,0 +1,170 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static CPtr<CDnnBlob> createMemoryPlanTestBlob( CRandom& random, std::initializer_list<int> dims )
+{
+	CPtr<CDnnBlob> blob = CDnnBlob::CreateTensor( MathEngine(), CT_Float, dims );
+	CArray<float> data;
+	for( int i = 0; i < blob->GetDataSize(); ++i ) {
+		data.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	blob->CopyFrom( data.GetPtr() );
+	return blob;
+}
+
+// Runs the network and copies the data of the sinks
+static void runMemoryPlanTestDnn( CDnn& dnn, const CArray<CString>& sinkNames, CArray<CArray<float>>& outputs )
+{
+	dnn.RunOnce();
+	outputs.SetSize( sinkNames.Size() );
+	for( int i = 0; i < sinkNames.Size(); ++i ) {
+		CPtr<CDnnBlob> blob = CheckCast<CSinkLayer>( dnn.GetLayer( sinkNames[i] ) )->GetBlob();
+		outputs[i].SetSize( blob->GetDataSize() );
+		if( blob->GetDataType() == CT_Int ) {
+			CArray<int> intData;
+			intData.SetSize( blob->GetDataSize() );
+			blob->CopyTo( intData.GetPtr() );
+			for( int j = 0; j < intData.Size(); ++j ) {
+				outputs[i][j] = static_cast<float>( intData[j] );
+			}
+		} else {
+			blob->CopyTo( outputs[i].GetPtr() );
+		}
+	}
+}
+
+static void checkMemoryPlanTestOutputs( const CArray<CArray<float>>& expected, const CArray<CArray<float>>& actual )
+{
+	ASSERT_EQ( expected.Size(), actual.Size() );
+	for( int i = 0; i < expected.Size(); ++i ) {
+		ASSERT_EQ( expected[i].Size(), actual[i].Size() );
+		for( int j = 0; j < expected[i].Size(); ++j ) {
+			ASSERT_EQ( expected[i][j], actual[i][j] ) << "sink " << i << " at index " << j;
+		}
+	}
+}
+
+TEST( DnnMemoryPlanTest, Chain )
+{
+	const int batchSize = 8;
+	const int layerSize = 64;
+	const int layerCount = 10;
+
+	CRandom random( 0x456 );
+	CDnn dnn( random, MathEngine() );
+	CBaseLayer* layer = Source( dnn, "data" );
+	for( int i = 0; i < layerCount; ++i ) {
+		layer = FullyConnected( layerSize )( "fc" + Str( i ), layer );
+		layer = Relu()( "relu" + Str( i ), layer );
+	}
+	Sink( layer, "sink" );
+	CheckCast<CSourceLayer>( dnn.GetLayer( "data" ) )->SetBlob(
+		createMemoryPlanTestBlob( random, { 1, batchSize, 1, 1, 1, 1, layerSize } ) );
+
+	const CArray<CString> sinkNames = { "sink" };
+	CArray<CArray<float>> expected;
+	runMemoryPlanTestDnn( dnn, sinkNames, expected );
+
+	dnn.EnableStaticMemoryPlanning( true );
+	EXPECT_TRUE( dnn.IsStaticMemoryPlanningEnabled() );
+	CArray<CArray<float>> actual;
+	runMemoryPlanTestDnn( dnn, sinkNames, actual );
+	checkMemoryPlanTestOutputs( expected, actual );
+	// The ReLU layers work in-place, so two buffers are enough for the whole chain
+	EXPECT_EQ( 2 * batchSize * layerSize * sizeof( float ), dnn.GetStaticMemoryPlanSize() );
+
+	// The second run uses the same plan
+	runMemoryPlanTestDnn( dnn, sinkNames, actual );
+	checkMemoryPlanTestOutputs( expected, actual );
+
+	dnn.EnableStaticMemoryPlanning( false );
+	EXPECT_EQ( 0, dnn.GetStaticMemoryPlanSize() );
+	runMemoryPlanTestDnn( dnn, sinkNames, actual );
+	checkMemoryPlanTestOutputs( expected, actual );
+}
+
+TEST( DnnMemoryPlanTest, Branches )
+{
+	CRandom random( 0x567 );
+	CDnn dnn( random, MathEngine() );
+	CSourceLayer* data = Source( dnn, "data" );
+	CConvLayer* conv = Conv( 8, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "conv", data );
+	CReLULayer* relu = Relu()( "relu", conv );
+	CConvLayer* left = Conv( 8, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "left", relu );
+	CConvLayer* right = Conv( 8, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "right", relu );
+	CEltwiseSumLayer* sum = Sum()( "sum", left, right, relu );
+	CFullyConnectedLayer* fc = FullyConnected( 5 )( "fc", sum );
+	Sink( fc, "sink" );
+	// The output from the middle of the network must not be overwritten by the following layers
+	Sink( left, "leftSink" );
+	CFullyConnectedLayer* intFc = FullyConnected( 3 )( "intFc", fc );
+	CCastLayer* cast = Cast( CT_Int )( "cast", intFc );
+	Sink( cast, "intSink" );
+
+	const CArray<CString> sinkNames = { "sink", "leftSink", "intSink" };
+	for( int batchSize = 1; batchSize <= 3; ++batchSize ) {
+		data->SetBlob( createMemoryPlanTestBlob( random, { 1, batchSize, 1, 7, 6, 1, 4 } ) );
+		dnn.EnableStaticMemoryPlanning( false );
+		CArray<CArray<float>> expected;
+		runMemoryPlanTestDnn( dnn, sinkNames, expected );
+
+		// The plan is rebuilt after the reshape
+		dnn.EnableStaticMemoryPlanning( true );
+		CArray<CArray<float>> actual;
+		runMemoryPlanTestDnn( dnn, sinkNames, actual );
+		checkMemoryPlanTestOutputs( expected, actual );
+		EXPECT_LT( 0, dnn.GetStaticMemoryPlanSize() );
+	}
+}
+
+TEST( DnnMemoryPlanTest, Reshape )
+{
+	const int layerSize = 16;
+	CRandom random( 0x678 );
+	CDnn dnn( random, MathEngine() );
+	CSourceLayer* data = Source( dnn, "data" );
+	CFullyConnectedLayer* fc = FullyConnected( layerSize )( "fc", data );
+	CReLULayer* relu = Relu()( "relu", fc );
+	CFullyConnectedLayer* out = FullyConnected( layerSize )( "out", relu );
+	Sink( out, "sink" );
+
+	const CArray<CString> sinkNames = { "sink" };
+	CObjectArray<CDnnBlob> inputs;
+	CArray<CArray<CArray<float>>> expected;
+	for( int batchSize = 1; batchSize <= 3; ++batchSize ) {
+		inputs.Add( createMemoryPlanTestBlob( random, { 1, batchSize, 1, 1, 1, 1, layerSize } ) );
+		data->SetBlob( inputs.Last() );
+		runMemoryPlanTestDnn( dnn, sinkNames, expected.Append() );
+	}
+
+	// The plan stays enabled while the input size changes
+	dnn.EnableStaticMemoryPlanning( true );
+	for( int step = 0; step < 2 * inputs.Size(); ++step ) {
+		const int index = step % inputs.Size();
+		data->SetBlob( inputs[index] );
+		CArray<CArray<float>> actual;
+		runMemoryPlanTestDnn( dnn, sinkNames, actual );
+		checkMemoryPlanTestOutputs( expected[index], actual );
+		EXPECT_EQ( 2 * ( index + 1 ) * layerSize * sizeof( float ), dnn.GetStaticMemoryPlanSize() );
+	}
+}
@@ -0,0 +1,194 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static CPtr<CDnnBlob> createOptimizationTestBlob( CRandom& random, std::initializer_list<int> dims )
+{
+	CPtr<CDnnBlob> blob = CDnnBlob::CreateTensor( MathEngine(), CT_Float, dims );
+	CArray<float> data;
+	for( int i = 0; i < blob->GetDataSize(); ++i ) {
+		data.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	blob->CopyFrom( data.GetPtr() );
+	return blob;
+}
+
+// Sets random final parameters of the batch normalization
+static void setRandomBatchNormParams( CRandom& random, CBatchNormalizationLayer& batchNorm )
+{
+	CPtr<CDnnBlob> params = batchNorm.GetFinalParams();
+	CArray<float> data;
+	for( int i = 0; i < params->GetDataSize(); ++i ) {
+		data.Add( static_cast<float>( random.Uniform( 0.5, 1.5 ) ) );
+	}
+	params->CopyFrom( data.GetPtr() );
+	batchNorm.SetFinalParams( params );
+}
+
+// Checks that the outputs of the sinks are the same as before the optimization
+static void checkSinkOutputs( CDnn& dnn, const CArray<CString>& sinkNames, const CObjectArray<CDnnBlob>& expected )
+{
+	dnn.RunOnce();
+	for( int i = 0; i < sinkNames.Size(); ++i ) {
+		CPtr<CDnnBlob> actualBlob = CheckCast<CSinkLayer>( dnn.GetLayer( sinkNames[i] ) )->GetBlob();
+		ASSERT_TRUE( actualBlob->HasEqualDimensions( expected[i] ) );
+		CDnnBlobBuffer<float> expectedBuffer( *expected[i], TDnnBlobBufferAccess::Read );
+		CDnnBlobBuffer<float> actual( *actualBlob, TDnnBlobBufferAccess::Read );
+		for( int j = 0; j < expectedBuffer.Size(); ++j ) {
+			ASSERT_NEAR( expectedBuffer[j], actual[j], 1e-4 ) << "at index " << j;
+		}
+	}
+}
+
+// Runs the dnn and stores the outputs of the sinks
+static void getSinkOutputs( CDnn& dnn, const CArray<CString>& sinkNames, CObjectArray<CDnnBlob>& outputs )
+{
+	dnn.RunOnce();
+	outputs.DeleteAll();
+	for( int i = 0; i < sinkNames.Size(); ++i ) {
+		outputs.Add( CheckCast<CSinkLayer>( dnn.GetLayer( sinkNames[i] ) )->GetBlob()->GetCopy() );
+	}
+}
+
+TEST( DnnOptimizationTest, TrivialLayers )
+{
+	CRandom random( 0x123 );
+	CDnn dnn( random, MathEngine() );
+	CSourceLayer* data = Source( dnn, "data" );
+	CDropoutLayer* dropout = Dropout( 0.3f )( "dropout", data );
+	CLinearLayer* identity = Linear( 1.f, 0.f )( "identity", dropout );
+	CTransposeLayer* firstTranspose = Transpose( BD_Height, BD_Width )( "firstTranspose", identity );
+	CTransposeLayer* secondTranspose = Transpose( BD_Width, BD_Height )( "secondTranspose", firstTranspose );
+	CTransformLayer* firstTransform = Transform( 1, TransformInferenceSame, 1, TransformInferenceRemainder, 1, 1, 3 )
+		( "firstTransform", secondTranspose );
+	CTransformLayer* secondTransform = Transform( 1, 2, 1, 1, 1, 1, TransformInferenceRemainder )
+		( "secondTransform", firstTransform );
+	CLinearLayer* linear = Linear( 2.f, 0.f )( "linear", secondTransform );
+	Sink( linear, "sink" );
+
+	data->SetBlob( createOptimizationTestBlob( random, { 1, 2, 1, 4, 5, 1, 3 } ) );
+	const CArray<CString> sinkNames = { "sink" };
+	CObjectArray<CDnnBlob> expected;
+	getSinkOutputs( dnn, sinkNames, expected );
+
+	CDnnOptimizationReport report = OptimizeDnn( dnn );
+	EXPECT_EQ( 5, report.RemovedTrivialLayers );
+	EXPECT_EQ( 0, report.FusedBatchNormalizations );
+	EXPECT_EQ( 0, report.FusedActivations );
+	EXPECT_EQ( 4, dnn.GetLayerCount() );
+	EXPECT_TRUE( dnn.HasLayer( "secondTransform" ) );
+	EXPECT_FALSE( dnn.HasLayer( "firstTransform" ) );
+	checkSinkOutputs( dnn, sinkNames, expected );
+}
+
+TEST( DnnOptimizationTest, BatchNormalizationFusion )
+{
+	CRandom random( 0x234 );
+	CDnn dnn( random, MathEngine() );
+	CSourceLayer* data = Source( dnn, "data" );
+	CConvLayer* conv = Conv( 6, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "conv", data );
+	CBatchNormalizationLayer* convNorm = BatchNormalization( true )( "convNorm", conv );
+	CFullyConnectedLayer* fc = FullyConnected( 5, true )( "fc", convNorm );
+	CBatchNormalizationLayer* fcNorm = BatchNormalization( false )( "fcNorm", fc );
+	Sink( fcNorm, "sink" );
+	// The normalization isn't fused if the output of the convolution is used somewhere else
+	CConvLayer* sharedConv = Conv( 4, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "sharedConv", data );
+	CBatchNormalizationLayer* sharedNorm = BatchNormalization( true )( "sharedNorm", sharedConv );
+	Sink( sharedNorm, "sharedSink" );
+	Sink( sharedConv, "sharedConvSink" );
+
+	data->SetBlob( createOptimizationTestBlob( random, { 1, 3, 1, 6, 5, 1, 4 } ) );
+	dnn.RunOnce();
+	setRandomBatchNormParams( random, *convNorm );
+	setRandomBatchNormParams( random, *fcNorm );
+	setRandomBatchNormParams( random, *sharedNorm );
+	const CArray<CString> sinkNames = { "sink", "sharedSink", "sharedConvSink" };
+	CObjectArray<CDnnBlob> expected;
+	getSinkOutputs( dnn, sinkNames, expected );
+
+	CDnnOptimizationReport report = OptimizeDnn( dnn );
+	EXPECT_EQ( 0, report.RemovedTrivialLayers );
+	EXPECT_EQ( 2, report.FusedBatchNormalizations );
+	EXPECT_EQ( 0, report.FusedActivations );
+	EXPECT_EQ( 8, dnn.GetLayerCount() );
+	EXPECT_TRUE( dnn.HasLayer( "sharedNorm" ) );
+	checkSinkOutputs( dnn, sinkNames, expected );
+}
+
+TEST( DnnOptimizationTest, ActivationFusion )
+{
+	CRandom random( 0x345 );
+	CDnn dnn( random, MathEngine() );
+	CSourceLayer* data = Source( dnn, "data" );
+	CConvLayer* conv = Conv( 4, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "conv", data );
+	CReLULayer* convReLU = Relu()( "convReLU", conv );
+	CConvLayer* secondConv = Conv( 4, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "secondConv", convReLU );
+	CEltwiseSumLayer* sum = Sum()( "sum", convReLU, secondConv );
+	CReLULayer* sumReLU = Relu( 0.5f )( "sumReLU", sum );
+	CFullyConnectedLayer* fc = FullyConnected( 7 )( "fc", sumReLU );
+	CReLULayer* fcReLU = Relu( 6.f )( "fcReLU", fc );
+	Sink( fcReLU, "sink" );
+	// ReLU isn't fused if the output of the fully-connected layer is used somewhere else
+	CFullyConnectedLayer* sharedFc = FullyConnected( 3 )( "sharedFc", data );
+	CReLULayer* sharedReLU = Relu()( "sharedReLU", sharedFc );
+	Sink( sharedReLU, "sharedSink" );
+	Sink( sharedFc, "sharedFcSink" );
+
+	data->SetBlob( createOptimizationTestBlob( random, { 1, 3, 1, 6, 5, 1, 4 } ) );
+	const CArray<CString> sinkNames = { "sink", "sharedSink", "sharedFcSink" };
+	CObjectArray<CDnnBlob> expected;
+	getSinkOutputs( dnn, sinkNames, expected );
+
+	CDnnOptimizationReport report = OptimizeDnn( dnn );
+	EXPECT_EQ( 0, report.RemovedTrivialLayers );
+	EXPECT_EQ( 0, report.FusedBatchNormalizations );
+	EXPECT_EQ( 3, report.FusedActivations );
+	EXPECT_EQ( 10, dnn.GetLayerCount() );
+	EXPECT_TRUE( conv->IsReLUFused() );
+	EXPECT_EQ( 0.f, conv->GetFusedReLUThreshold() );
+	EXPECT_TRUE( sum->IsReLUFused() );
+	EXPECT_EQ( 0.5f, sum->GetFusedReLUThreshold() );
+	EXPECT_TRUE( fc->IsReLUFused() );
+	EXPECT_EQ( 6.f, fc->GetFusedReLUThreshold() );
+	EXPECT_FALSE( sharedFc->IsReLUFused() );
+	checkSinkOutputs( dnn, sinkNames, expected );
+
+	// The fused ReLU is serialized
+	CMemoryFile file;
+	{
+		CArchive archive( &file, CArchive::store );
+		dnn.Serialize( archive );
+	}
+	file.SeekToBegin();
+	{
+		CArchive archive( &file, CArchive::load );
+		dnn.Serialize( archive );
+	}
+	data = CheckCast<CSourceLayer>( dnn.GetLayer( "data" ) );
+	data->SetBlob( createOptimizationTestBlob( random, { 1, 3, 1, 6, 5, 1, 4 } ) );
+	getSinkOutputs( dnn, sinkNames, expected );
+	EXPECT_TRUE( CheckCast<CFullyConnectedLayer>( dnn.GetLayer( "fc" ) )->IsReLUFused() );
+	for( int i = 0; i < expected[0]->GetDataSize(); ++i ) {
+		const float value = expected[0]->GetData().GetValueAt( i );
+		ASSERT_TRUE( value >= 0.f && value <= 6.f );
+	}
+}
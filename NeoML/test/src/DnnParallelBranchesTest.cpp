@@ -0,0 +1,112 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Builds the network with several independent branches
+// The in-place ReLU layer overwrites the output used by the other branches
+static void buildParallelBranchesTestDnn( CDnn& dnn )
+{
+	CSourceLayer* data = Source( dnn, "data" );
+	CConvLayer* stem = Conv( 8, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "stem", data );
+	CConvLayer* branch1 = Conv( 4, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "branch1", stem );
+	CConvLayer* branch2 = Conv( 4, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "branch2", stem );
+	CConvLayer* branch3a = Conv( 4, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "branch3a", stem );
+	CConvLayer* branch3b = Conv( 4, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "branch3b", branch3a );
+	CReLULayer* relu = Relu()( "relu", stem );
+	CConvLayer* branch4 = Conv( 4, CConvAxisParams( 1 ), CConvAxisParams( 1 ) )( "branch4", relu );
+	CConcatChannelsLayer* concat = ConcatChannels()( "concat", branch1, branch2, branch3b, branch4 );
+	CFullyConnectedLayer* fc = FullyConnected( 10 )( "fc", concat );
+	Sink( fc, "sink" );
+	Sink( branch2, "branch2Sink" );
+}
+
+static void runParallelBranchesTestDnn( CDnn& dnn, CArray<float>& output, CArray<float>& branchOutput )
+{
+	dnn.RunOnce();
+	CPtr<CDnnBlob> blob = CheckCast<CSinkLayer>( dnn.GetLayer( "sink" ) )->GetBlob();
+	output.SetSize( blob->GetDataSize() );
+	blob->CopyTo( output.GetPtr() );
+	blob = CheckCast<CSinkLayer>( dnn.GetLayer( "branch2Sink" ) )->GetBlob();
+	branchOutput.SetSize( blob->GetDataSize() );
+	blob->CopyTo( branchOutput.GetPtr() );
+}
+
+TEST( DnnParallelBranchesTest, SameResults )
+{
+	CRandom random( 0x789 );
+	CDnn dnn( random, MathEngine() );
+	buildParallelBranchesTestDnn( dnn );
+
+	for( int batchSize = 1; batchSize <= 3; ++batchSize ) {
+		CPtr<CDnnBlob> input = CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, batchSize, 1, 9, 7, 1, 3 } );
+		CArray<float> inputData;
+		for( int i = 0; i < input->GetDataSize(); ++i ) {
+			inputData.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+		}
+		input->CopyFrom( inputData.GetPtr() );
+		CheckCast<CSourceLayer>( dnn.GetLayer( "data" ) )->SetBlob( input );
+
+		dnn.DisableParallelBranches();
+		EXPECT_FALSE( dnn.IsParallelBranchesEnabled() );
+		CArray<float> expected;
+		CArray<float> expectedBranch;
+		runParallelBranchesTestDnn( dnn, expected, expectedBranch );
+
+		for( int threadCount = 0; threadCount <= 4; threadCount += 2 ) {
+			dnn.EnableParallelBranches( threadCount );
+			EXPECT_TRUE( dnn.IsParallelBranchesEnabled() );
+			CArray<float> actual;
+			CArray<float> actualBranch;
+			runParallelBranchesTestDnn( dnn, actual, actualBranch );
+
+			ASSERT_EQ( expected.Size(), actual.Size() );
+			for( int i = 0; i < expected.Size(); ++i ) {
+				ASSERT_NEAR( expected[i], actual[i], 1e-4f ) << "at index " << i;
+			}
+			ASSERT_EQ( expectedBranch.Size(), actualBranch.Size() );
+			for( int i = 0; i < expectedBranch.Size(); ++i ) {
+				ASSERT_NEAR( expectedBranch[i], actualBranch[i], 1e-4f ) << "at index " << i;
+			}
+		}
+	}
+}
+
+TEST( DnnParallelBranchesTest, CriticalPath )
+{
+	CRandom random( 0x78a );
+	CDnn dnn( random, MathEngine() );
+	buildParallelBranchesTestDnn( dnn );
+	CheckCast<CSourceLayer>( dnn.GetLayer( "data" ) )->SetBlob(
+		CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, 2, 1, 9, 7, 1, 3 } ) );
+	dnn.RunOnce();
+
+	// Without the profiling each layer costs 1
+	CDnnCriticalPath path;
+	dnn.GetCriticalPath( path );
+	EXPECT_EQ( dnn.GetLayerCount(), path.TotalCost );
+	EXPECT_EQ( 7, path.PathCost );
+	const CArray<CString> expected = { "data", "stem", "branch3a", "branch3b", "concat", "fc", "sink" };
+	ASSERT_EQ( expected.Size(), path.Layers.Size() );
+	for( int i = 0; i < expected.Size(); ++i ) {
+		EXPECT_EQ( expected[i], path.Layers[i] );
+	}
+}
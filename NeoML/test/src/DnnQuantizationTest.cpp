@@ -0,0 +1,207 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Builds source -> conv -> relu -> fully-connected -> sink network and fills the input with random data
+static void buildQuantizationTestNet( CDnn& net, CRandom& random )
+{
+	const int batchSize = 4;
+	const int imageSize = 12;
+	const int channels = 6;
+
+	CSourceLayer* data = Source( net, "data" );
+	CConvLayer* conv = Conv( 16, CConvAxisParams( 3, 1 ), CConvAxisParams( 3, 1 ) )( "conv", data );
+	CReLULayer* relu = Relu()( "relu", conv );
+	CFullyConnectedLayer* fc = FullyConnected( 10 )( "fc", relu );
+	Sink( fc, "sink" );
+
+	CPtr<CDnnBlob> input = CDnnBlob::Create2DImageBlob( MathEngine(), CT_Float, 1, batchSize, imageSize, imageSize, channels );
+	CArray<float> inputBuff;
+	for( int i = 0; i < input->GetDataSize(); ++i ) {
+		inputBuff.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	input->CopyFrom( inputBuff.GetPtr() );
+	data->SetBlob( input );
+}
+
+static void getSinkOutput( CDnn& net, CArray<float>& output )
+{
+	CPtr<CDnnBlob> blob = CheckCast<CSinkLayer>( net.GetLayer( "sink" ) )->GetBlob();
+	output.SetSize( blob->GetDataSize() );
+	blob->CopyTo( output.GetPtr() );
+}
+
+// The int8 result should be close to the float one relative to the output range
+static void checkQuantizedOutput( const CArray<float>& expected, const CArray<float>& actual )
+{
+	ASSERT_EQ( expected.Size(), actual.Size() );
+	float maxAbs = 0;
+	for( int i = 0; i < expected.Size(); ++i ) {
+		maxAbs = max( maxAbs, fabsf( expected[i] ) );
+	}
+	for( int i = 0; i < expected.Size(); ++i ) {
+		ASSERT_NEAR( expected[i], actual[i], 0.03f * maxAbs );
+	}
+}
+
+TEST( CDnnQuantizationTest, Calibrated )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( 0x123 );
+	CDnn net( random, MathEngine() );
+	buildQuantizationTestNet( net, random );
+
+	net.RunOnce();
+	CArray<float> expected;
+	getSinkOutput( net, expected );
+
+	BeginInt8Calibration( net );
+	net.RunOnce();
+	CDnnQuantizationReport report = QuantizeDnnToInt8( net );
+	EXPECT_EQ( 1, report.FullyConnectedLayers );
+	EXPECT_EQ( 1, report.ConvLayers );
+	EXPECT_EQ( 0, report.DynamicInputLayers );
+	EXPECT_TRUE( CheckCast<CConvLayer>( net.GetLayer( "conv" ) )->GetInt8InputMaxAbs() > 0 );
+
+	net.RunOnce();
+	CArray<float> actual;
+	getSinkOutput( net, actual );
+	checkQuantizedOutput( expected, actual );
+
+	DisableInt8Inference( net );
+	net.RunOnce();
+	getSinkOutput( net, actual );
+	for( int i = 0; i < expected.Size(); ++i ) {
+		ASSERT_FLOAT_EQ( expected[i], actual[i] );
+	}
+}
+
+TEST( CDnnQuantizationTest, Dynamic )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( 0x456 );
+	CDnn net( random, MathEngine() );
+	buildQuantizationTestNet( net, random );
+
+	net.RunOnce();
+	CArray<float> expected;
+	getSinkOutput( net, expected );
+
+	CDnnQuantizationReport report = QuantizeDnnToInt8( net );
+	EXPECT_EQ( 2, report.DynamicInputLayers );
+
+	net.RunOnce();
+	CArray<float> actual;
+	getSinkOutput( net, actual );
+	checkQuantizedOutput( expected, actual );
+}
+
+TEST( CDnnQuantizationTest, Serialization )
+{
+	CRandom random( 0x789 );
+	CDnn net( random, MathEngine() );
+	buildQuantizationTestNet( net, random );
+	BeginInt8Calibration( net );
+	net.RunOnce();
+	QuantizeDnnToInt8( net );
+	const float convMaxAbs = CheckCast<CConvLayer>( net.GetLayer( "conv" ) )->GetInt8InputMaxAbs();
+	const float fcMaxAbs = CheckCast<CFullyConnectedLayer>( net.GetLayer( "fc" ) )->GetInt8InputMaxAbs();
+
+	CMemoryFile file;
+	{
+		CArchive archive( &file, CArchive::SD_Storing );
+		net.Serialize( archive );
+	}
+	file.SeekToBegin();
+	CDnn loaded( random, MathEngine() );
+	{
+		CArchive archive( &file, CArchive::SD_Loading );
+		loaded.Serialize( archive );
+	}
+
+	CPtr<CConvLayer> conv = CheckCast<CConvLayer>( loaded.GetLayer( "conv" ) );
+	EXPECT_TRUE( conv->IsInt8InferenceEnabled() );
+	EXPECT_FALSE( conv->IsInt8CalibrationEnabled() );
+	EXPECT_EQ( convMaxAbs, conv->GetInt8InputMaxAbs() );
+	CPtr<CFullyConnectedLayer> fc = CheckCast<CFullyConnectedLayer>( loaded.GetLayer( "fc" ) );
+	EXPECT_TRUE( fc->IsInt8InferenceEnabled() );
+	EXPECT_EQ( fcMaxAbs, fc->GetInt8InputMaxAbs() );
+}
+
+TEST( CDnnQuantizationTest, DropFloatWeights )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( 0xABC );
+	CDnn net( random, MathEngine() );
+	buildQuantizationTestNet( net, random );
+
+	net.RunOnce();
+	CArray<float> expected;
+	getSinkOutput( net, expected );
+
+	BeginInt8Calibration( net );
+	net.RunOnce();
+	QuantizeDnnToInt8( net, true );
+	EXPECT_TRUE( CheckCast<CConvLayer>( net.GetLayer( "conv" ) )->IsFloatFilterDropped() );
+	EXPECT_TRUE( CheckCast<CConvLayer>( net.GetLayer( "conv" ) )->GetFilterData() == nullptr );
+	EXPECT_TRUE( CheckCast<CFullyConnectedLayer>( net.GetLayer( "fc" ) )->AreFloatWeightsDropped() );
+	EXPECT_TRUE( CheckCast<CFullyConnectedLayer>( net.GetLayer( "fc" ) )->GetWeightsData() == nullptr );
+
+	net.RunOnce();
+	CArray<float> quantized;
+	getSinkOutput( net, quantized );
+	checkQuantizedOutput( expected, quantized );
+
+	// Only the int8 weights are stored, the loaded network gives exactly the same result
+	CMemoryFile file;
+	{
+		CArchive archive( &file, CArchive::SD_Storing );
+		net.Serialize( archive );
+	}
+	file.SeekToBegin();
+	CDnn loaded( random, MathEngine() );
+	{
+		CArchive archive( &file, CArchive::SD_Loading );
+		loaded.Serialize( archive );
+	}
+	EXPECT_TRUE( CheckCast<CConvLayer>( loaded.GetLayer( "conv" ) )->IsFloatFilterDropped() );
+	EXPECT_TRUE( CheckCast<CFullyConnectedLayer>( loaded.GetLayer( "fc" ) )->AreFloatWeightsDropped() );
+
+	CheckCast<CSourceLayer>( loaded.GetLayer( "data" ) )->SetBlob(
+		CheckCast<CSourceLayer>( net.GetLayer( "data" ) )->GetBlob().Ptr() );
+	loaded.RunOnce();
+	CArray<float> actual;
+	getSinkOutput( loaded, actual );
+	ASSERT_EQ( quantized.Size(), actual.Size() );
+	for( int i = 0; i < quantized.Size(); ++i ) {
+		ASSERT_EQ( quantized[i], actual[i] );
+	}
+}
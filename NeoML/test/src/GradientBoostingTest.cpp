@@ -145,4 +145,148 @@ TEST( CGradientBoostingTest, IterativeRegressionTest )
 		params.TreeBuilder = type;
 		regressionTest( train.Ptr(), test.Ptr(), params );
 	}
-}
\ No newline at end of file
+}
+TEST( CGradientBoostingTest, FastHistThreadCountTest )
+{
+	CRandom rand( 42 );
+	auto train = CClassificationRandomProblem::Random( rand, 3000, 20, 3 );
+	auto test = CClassificationRandomProblem::Random( rand, 500, 20, 3 );
+
+	// The histograms are built in the same order for any number of threads
+	CObjectArray<IModel> models;
+	for( int threadCount : { 1, 4 } ) {
+		CRandom random( 0 );
+		CGradientBoost::CParams params;
+		params.Random = &random;
+		params.IterationsCount = 30;
+		params.MaxTreeDepth = 6;
+		params.Subsample = 0.8f;
+		params.TreeBuilder = GBTB_FastHist;
+		params.ThreadCount = threadCount;
+		CGradientBoost boosting( params );
+		models.Add( boosting.Train( *train->CreateSparse() ) );
+	}
+
+	for( int i = 0; i < test->GetVectorCount(); i++ ) {
+		CClassificationResult result1;
+		CClassificationResult result2;
+		ASSERT_TRUE( models[0]->Classify( test->GetVector( i ), result1 ) );
+		ASSERT_TRUE( models[1]->Classify( test->GetVector( i ), result2 ) );
+
+		ASSERT_EQ( result1.PreferredClass, result2.PreferredClass );
+		for( int j = 0; j < result1.Probabilities.Size(); j++ ) {
+			ASSERT_EQ( result1.Probabilities[j].GetValue(), result2.Probabilities[j].GetValue() );
+		}
+	}
+}
+
+// The histogram builder is faster than the baseline one, and the extra threads don't add passes over the data
+TEST( CGradientBoostingTest, FastHistBuildTime )
+{
+	CRandom rand( 42 );
+	auto train = CClassificationRandomProblem::Random( rand, 20000, 100, 2 );
+	CPtr<CClassificationRandomProblem> sparseTrain = train->CreateSparse();
+
+	struct CBuilderRun {
+		TGradientBoostTreeBuilder Builder;
+		int ThreadCount;
+		int Time;
+	};
+	CBuilderRun runs[] = { { GBTB_FastHist, 1, 0 }, { GBTB_FastHist, 8, 0 }, { GBTB_Full, 8, 0 } };
+	for( CBuilderRun& run : runs ) {
+		CRandom random( 0 );
+		CGradientBoost::CParams params;
+		params.Random = &random;
+		params.IterationsCount = 10;
+		params.MaxTreeDepth = 8;
+		params.TreeBuilder = run.Builder;
+		params.ThreadCount = run.ThreadCount;
+		CGradientBoost boosting( params );
+		const int begin = GetTickCount();
+		ASSERT_TRUE( boosting.Train( *sparseTrain ) != nullptr );
+		run.Time = GetTickCount() - begin;
+		GTEST_LOG_( INFO ) << ( run.Builder == GBTB_FastHist ? "FastHist" : "Full" )
+			<< ", " << run.ThreadCount << " thread(s), train time: " << run.Time;
+	}
+	EXPECT_LT( runs[1].Time, runs[2].Time );
+	// Even with one core available the 8 threads are no more than twice slower
+	EXPECT_LT( runs[1].Time, 2 * runs[0].Time + 100 );
+}
+
+// A part of the regression problem
+class CRegressionProblemChunk : public IMultivariateRegressionProblem {
+public:
+	CRegressionProblemChunk( const IRegressionProblem* _problem, int _first, int _count ) :
+		problem( _problem ), first( _first ), count( _count ) {}
+
+	int GetFeatureCount() const override { return problem->GetFeatureCount(); }
+	int GetVectorCount() const override { return count; }
+	CFloatMatrixDesc GetMatrix() const override
+	{
+		CFloatMatrixDesc matrix = problem->GetMatrix();
+		matrix.Height = count;
+		matrix.PointerB += first;
+		matrix.PointerE += first;
+		return matrix;
+	}
+	double GetVectorWeight( int index ) const override { return problem->GetVectorWeight( first + index ); }
+	int GetValueSize() const override { return 1; }
+	CFloatVector GetValue( int index ) const override
+		{ return CFloatVector( 1, static_cast<float>( problem->GetValue( first + index ) ) ); }
+
+private:
+	const CPtr<const IRegressionProblem> problem;
+	const int first;
+	const int count;
+};
+
+// The regression problem split into chunks
+class CChunkedRegressionProblem : public IMultivariateRegressionChunkedProblem {
+public:
+	CChunkedRegressionProblem( const IRegressionProblem* _problem, int _chunkSize ) :
+		problem( _problem ), chunkSize( _chunkSize ) {}
+
+	int GetFeatureCount() const override { return problem->GetFeatureCount(); }
+	int GetValueSize() const override { return 1; }
+	int GetChunkCount() const override { return ( problem->GetVectorCount() + chunkSize - 1 ) / chunkSize; }
+	CPtr<const IMultivariateRegressionProblem> GetChunk( int index ) const override
+	{
+		const int first = index * chunkSize;
+		return FINE_DEBUG_NEW CRegressionProblemChunk( problem, first, min( chunkSize, problem->GetVectorCount() - first ) );
+	}
+
+private:
+	const CPtr<const IRegressionProblem> problem;
+	const int chunkSize;
+};
+
+TEST( CGradientBoostingTest, BinnedProblemTest )
+{
+	CRandom rand( 42 );
+	auto train = CRegressionRandomProblem::Random( rand, 2000, 20, 10 );
+	auto test = CRegressionRandomProblem::Random( rand, 500, 20, 10 );
+	const char* fileName = "gb_binned_problem";
+
+	CGradientBoost::CParams params;
+	params.IterationsCount = 30;
+	params.MaxTreeDepth = 4;
+	params.TreeBuilder = GBTB_FastHist;
+	CGradientBoostBinnedProblem::Build( CChunkedRegressionProblem( train->CreateSparse(), 300 ), params.MaxBins, fileName );
+
+	// The binned problem has the same bins, so the trees are the same as on the data in memory
+	CGradientBoost boosting( params );
+	CPtr<IRegressionModel> model = boosting.TrainRegression( *train );
+	CPtr<IMultivariateRegressionModel> binnedModel;
+	{
+		CPtr<CGradientBoostBinnedProblem> binnedProblem = FINE_DEBUG_NEW CGradientBoostBinnedProblem( fileName );
+		ASSERT_EQ( train->GetVectorCount(), binnedProblem->GetVectorCount() );
+		CGradientBoost binnedBoosting( params );
+		binnedModel = binnedBoosting.TrainRegression( *binnedProblem );
+	}
+	::remove( fileName );
+
+	for( int i = 0; i < test->GetVectorCount(); i++ ) {
+		ASSERT_FLOAT_EQ( static_cast<float>( model->Predict( test->GetVector( i ) ) ),
+			binnedModel->MultivariatePredict( test->GetVector( i ) )[0] );
+	}
+}
@@ -0,0 +1,224 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Dense vectors grouped around random centers
+class CIvfTestData {
+public:
+	CIvfTestData( int vectorCount, int featureCount, int clusterCount, CRandom& random );
+
+	const CFloatMatrixDesc& GetDesc() const { return desc; }
+
+private:
+	CArray<float> values;
+	CArray<int> pointers;
+	CFloatMatrixDesc desc;
+};
+
+CIvfTestData::CIvfTestData( int vectorCount, int featureCount, int clusterCount, CRandom& random )
+{
+	CArray<float> centers;
+	for( int i = 0; i < clusterCount * featureCount; i++ ) {
+		centers.Add( static_cast<float>( random.Uniform( -10, 10 ) ) );
+	}
+
+	for( int i = 0; i < vectorCount; i++ ) {
+		const int cluster = random.UniformInt( 0, clusterCount - 1 );
+		pointers.Add( values.Size() );
+		for( int j = 0; j < featureCount; j++ ) {
+			values.Add( centers[cluster * featureCount + j] + static_cast<float>( random.Normal( 0, 1 ) ) );
+		}
+	}
+	pointers.Add( values.Size() );
+
+	desc.Height = vectorCount;
+	desc.Width = featureCount;
+	desc.Values = values.GetPtr();
+	desc.PointerB = pointers.GetPtr();
+	desc.PointerE = pointers.GetPtr() + 1;
+}
+
+// Finds the exact nearest neighbours
+static void bruteForceSearch( const CFloatMatrixDesc& data, const CFloatMatrixDesc& queries, int neighbourCount,
+	CArray<int>& ids )
+{
+	ids.DeleteAll();
+	for( int i = 0; i < queries.Height; i++ ) {
+		CArray<double> distances;
+		CArray<int> order;
+		for( int j = 0; j < data.Height; j++ ) {
+			double distance = 0;
+			for( int k = 0; k < data.Width; k++ ) {
+				const double diff = data.Values[data.PointerB[j] + k] - queries.Values[queries.PointerB[i] + k];
+				distance += diff * diff;
+			}
+			distances.Add( distance );
+			order.Add( j );
+		}
+		for( int k = 0; k < neighbourCount; k++ ) {
+			int best = k;
+			for( int j = k + 1; j < order.Size(); j++ ) {
+				if( distances[order[j]] < distances[order[best]] ) {
+					best = j;
+				}
+			}
+			swap( order[k], order[best] );
+			ids.Add( order[k] );
+		}
+	}
+}
+
+// The share of the exact neighbours found
+static double calcRecall( const CArray<int>& expectedIds, const CArray<int>& ids )
+{
+	EXPECT_EQ( expectedIds.Size(), ids.Size() );
+	int found = 0;
+	for( int i = 0; i < expectedIds.Size(); i++ ) {
+		if( ids.Has( expectedIds[i] ) ) {
+			found++;
+		}
+	}
+	return static_cast<double>( found ) / expectedIds.Size();
+}
+
+class CIvfIndexTest : public CNeoMLTestFixture {
+public:
+	static bool InitTestFixture() { return true; }
+	static void DeinitTestFixture() {}
+};
+
+//---------------------------------------------------------------------------------------------------------
+
+TEST_F( CIvfIndexTest, ExactWithAllLists )
+{
+	CRandom random( 0x123 );
+	CIvfTestData data( 2000, 16, 20, random );
+	CIvfTestData queries( 50, 16, 20, random );
+	const int neighbourCount = 10;
+
+	CIvfIndex::CParams params;
+	params.ListCount = 32;
+	params.ProbeCount = params.ListCount;
+	params.ThreadCount = 4;
+	CIvfIndex index( params );
+	index.Train( data.GetDesc() );
+	index.Add( data.GetDesc() );
+	ASSERT_EQ( data.GetDesc().Height, index.Size() );
+
+	CArray<int> ids;
+	CArray<float> distances;
+	index.Search( queries.GetDesc(), neighbourCount, ids, distances );
+	CArray<int> expectedIds;
+	bruteForceSearch( data.GetDesc(), queries.GetDesc(), neighbourCount, expectedIds );
+	EXPECT_EQ( 1., calcRecall( expectedIds, ids ) );
+	for( int i = 0; i < queries.GetDesc().Height; i++ ) {
+		for( int j = 1; j < neighbourCount; j++ ) {
+			EXPECT_LE( distances[i * neighbourCount + j - 1], distances[i * neighbourCount + j] );
+		}
+	}
+
+	// Searching fewer lists finds most of the neighbours
+	index.SetProbeCount( 4 );
+	index.Search( queries.GetDesc(), neighbourCount, ids, distances );
+	EXPECT_LT( 0.9, calcRecall( expectedIds, ids ) );
+}
+
+TEST_F( CIvfIndexTest, ProductQuantization )
+{
+	CRandom random( 0x456 );
+	CIvfTestData data( 3000, 16, 20, random );
+	CIvfTestData queries( 50, 16, 20, random );
+	const int neighbourCount = 10;
+
+	CIvfIndex::CParams params;
+	params.ListCount = 16;
+	params.ProbeCount = 4;
+	params.SubspaceCount = 8;
+	params.SubspaceCenterCount = 64;
+	params.ThreadCount = 4;
+	CIvfIndex index( params );
+	index.Train( data.GetDesc() );
+	index.Add( data.GetDesc() );
+
+	CArray<int> ids;
+	CArray<float> distances;
+	index.Search( queries.GetDesc(), neighbourCount, ids, distances );
+	CArray<int> expectedIds;
+	bruteForceSearch( data.GetDesc(), queries.GetDesc(), neighbourCount, expectedIds );
+	EXPECT_LT( 0.5, calcRecall( expectedIds, ids ) );
+
+	// The results do not depend on the number of threads
+	params.ThreadCount = 1;
+	CIvfIndex singleThreadIndex( params );
+	singleThreadIndex.Train( data.GetDesc() );
+	singleThreadIndex.Add( data.GetDesc() );
+	CArray<int> singleThreadIds;
+	CArray<float> singleThreadDistances;
+	singleThreadIndex.Search( queries.GetDesc(), neighbourCount, singleThreadIds, singleThreadDistances );
+	ASSERT_EQ( ids.Size(), singleThreadIds.Size() );
+	for( int i = 0; i < ids.Size(); i++ ) {
+		EXPECT_EQ( singleThreadIds[i], ids[i] ) << "at index " << i;
+		EXPECT_EQ( singleThreadDistances[i], distances[i] ) << "at index " << i;
+	}
+}
+
+TEST_F( CIvfIndexTest, Serialization )
+{
+	CRandom random( 0x789 );
+	CIvfTestData data( 1000, 8, 10, random );
+	CIvfTestData queries( 20, 8, 10, random );
+	const int neighbourCount = 5;
+
+	for( int subspaceCount : { 0, 4 } ) {
+		CIvfIndex::CParams params;
+		params.ListCount = 8;
+		params.ProbeCount = 2;
+		params.SubspaceCount = subspaceCount;
+		params.SubspaceCenterCount = 16;
+		CIvfIndex index( params );
+		index.Train( data.GetDesc() );
+		index.Add( data.GetDesc() );
+
+		CMemoryFile file;
+		{
+			CArchive archive( &file, CArchive::store );
+			index.Serialize( archive );
+		}
+		file.SeekToBegin();
+		CIvfIndex loadedIndex;
+		{
+			CArchive archive( &file, CArchive::load );
+			loadedIndex.Serialize( archive );
+		}
+		ASSERT_EQ( index.Size(), loadedIndex.Size() );
+		ASSERT_EQ( index.GetFeatureCount(), loadedIndex.GetFeatureCount() );
+
+		CArray<int> expectedIds;
+		CArray<float> expectedDistances;
+		index.Search( queries.GetDesc(), neighbourCount, expectedIds, expectedDistances );
+		CArray<int> ids;
+		CArray<float> distances;
+		loadedIndex.Search( queries.GetDesc(), neighbourCount, ids, distances );
+		EXPECT_EQ( expectedIds, ids );
+		EXPECT_EQ( expectedDistances, distances );
+	}
+}
@@ -295,7 +295,9 @@ TEST( MobileNetConversionTest, SinkFromTheMiddle )
 	CDnnOptimizationReport report = OptimizeDnn( dnn );
 	ASSERT_EQ( 0, report.MobileNetV2NonResidualBlocks );
 	ASSERT_EQ( 0, report.MobileNetV2ResidualBlocks );
-	ASSERT_EQ( 9, dnn.GetLayerCount() );
+	// expandReLU is merged into expandConv
+	ASSERT_EQ( 1, report.FusedActivations );
+	ASSERT_EQ( 8, dnn.GetLayerCount() );
 }
 
 TEST( MobileNetConversionTest, SinkDisablesResidual )
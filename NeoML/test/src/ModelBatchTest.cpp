@@ -0,0 +1,199 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+#include <RandomProblem.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Checks that the batch classification gives the same results as the classification of each row
+static void checkClassifyBatch( const IModel& model, const CClassificationRandomProblem& test )
+{
+	const CFloatMatrixDesc matrix = test.GetMatrix();
+	for( int threadCount : { 1, 4 } ) {
+		CArray<CClassificationResult> results;
+		ASSERT_TRUE( model.ClassifyBatch( matrix, results, threadCount ) );
+		ASSERT_EQ( matrix.Height, results.Size() );
+
+		for( int i = 0; i < matrix.Height; i++ ) {
+			CClassificationResult expected;
+			ASSERT_TRUE( model.Classify( test.GetVector( i ), expected ) );
+			ASSERT_EQ( expected.PreferredClass, results[i].PreferredClass );
+			ASSERT_EQ( expected.Probabilities.Size(), results[i].Probabilities.Size() );
+			for( int j = 0; j < expected.Probabilities.Size(); j++ ) {
+				ASSERT_NEAR( expected.Probabilities[j].GetValue(), results[i].Probabilities[j].GetValue(), 1e-9 );
+			}
+		}
+	}
+}
+
+TEST( CModelBatchTest, ClassifyBatch )
+{
+	CRandom random( 0 );
+	for( int classCount : { 2, 3 } ) {
+		CPtr<CClassificationRandomProblem> train = CClassificationRandomProblem::Random( random, 1000, 20, classCount );
+		CPtr<CClassificationRandomProblem> test = CClassificationRandomProblem::Random( random, 300, 20, classCount );
+		CPtr<CClassificationRandomProblem> sparseTest = test->CreateSparse();
+
+		CObjectArray<IModel> models;
+		CGradientBoost::CParams boostParams;
+		boostParams.Random = &random;
+		boostParams.IterationsCount = 20;
+		for( TGradientBoostTreeBuilder builder : { GBTB_Full, GBTB_MultiFull } ) {
+			boostParams.TreeBuilder = builder;
+			CGradientBoost boosting( boostParams );
+			models.Add( boosting.Train( *train ) );
+		}
+		CLinear linear( EF_SquaredHinge );
+		models.Add( linear.Train( *train ) );
+		CSvm svm( CSvmKernel::KT_RBF );
+		models.Add( svm.Train( *train ) );
+		CDecisionTree::CParams treeParams;
+		CDecisionTree decisionTree( treeParams );
+		models.Add( decisionTree.Train( *train ) );
+
+		for( int i = 0; i < models.Size(); i++ ) {
+			ASSERT_TRUE( models[i] != nullptr );
+			checkClassifyBatch( *models[i], *test );
+			checkClassifyBatch( *models[i], *sparseTest );
+		}
+	}
+}
+
+TEST( CModelBatchTest, PredictBatch )
+{
+	CRandom random( 0 );
+	CPtr<CRegressionRandomProblem> train = CRegressionRandomProblem::Random( random, 1000, 20, 10 );
+	CPtr<CRegressionRandomProblem> test = CRegressionRandomProblem::Random( random, 300, 20, 10 );
+	const CFloatMatrixDesc matrix = test->GetMatrix();
+
+	CGradientBoost::CParams boostParams;
+	boostParams.Random = &random;
+	boostParams.IterationsCount = 20;
+	CGradientBoost boosting( boostParams );
+	CPtr<IRegressionModel> boostModel = boosting.TrainRegression( *train );
+	CLinear linear( EF_L2_Regression );
+	CPtr<IRegressionModel> linearModel = linear.TrainRegression( *train );
+
+	for( const IRegressionModel* model : { boostModel.Ptr(), linearModel.Ptr() } ) {
+		CArray<double> results;
+		model->PredictBatch( matrix, results, 4 );
+		ASSERT_EQ( matrix.Height, results.Size() );
+		for( int i = 0; i < matrix.Height; i++ ) {
+			ASSERT_NEAR( model->Predict( test->GetVector( i ) ), results[i], 1e-9 );
+		}
+	}
+
+	const IMultivariateRegressionModel* multivariateModel =
+		dynamic_cast<const IMultivariateRegressionModel*>( boostModel.Ptr() );
+	ASSERT_TRUE( multivariateModel != nullptr );
+	CArray<float> values;
+	const int valueSize = multivariateModel->MultivariatePredictBatch( matrix, values, 4 );
+	ASSERT_EQ( 1, valueSize );
+	ASSERT_EQ( matrix.Height, values.Size() );
+	for( int i = 0; i < matrix.Height; i++ ) {
+		ASSERT_EQ( multivariateModel->MultivariatePredict( test->GetVector( i ) )[0], values[i] );
+	}
+}
+
+TEST( CModelBatchTest, QuickScorerBatch )
+{
+	CRandom random( 0 );
+	for( int classCount : { 2, 3 } ) {
+		CPtr<CClassificationRandomProblem> train = CClassificationRandomProblem::Random( random, 1000, 20, classCount );
+		CPtr<CClassificationRandomProblem> test = CClassificationRandomProblem::Random( random, 300, 20, classCount );
+
+		// Enough trees for several blocks, some of them with more than 64 leaves
+		CGradientBoost::CParams params;
+		params.Random = &random;
+		params.IterationsCount = 150;
+		params.MaxTreeDepth = 8;
+		CGradientBoost boosting( params );
+		CPtr<IGradientBoostModel> model = CheckCast<IGradientBoostModel>( boosting.Train( *train ) );
+		CGradientBoostQuickScorer quickScorer;
+		CPtr<IGradientBoostQSModel> qsModel = quickScorer.Build( *model );
+
+		checkClassifyBatch( *qsModel, *test );
+		checkClassifyBatch( *qsModel, *test->CreateSparse() );
+	}
+
+	CPtr<CRegressionRandomProblem> train = CRegressionRandomProblem::Random( random, 1000, 20, 10 );
+	CPtr<CRegressionRandomProblem> test = CRegressionRandomProblem::Random( random, 300, 20, 10 );
+	CGradientBoost::CParams params;
+	params.Random = &random;
+	params.IterationsCount = 150;
+	params.MaxTreeDepth = 8;
+	CGradientBoost boosting( params );
+	CPtr<IGradientBoostRegressionModel> model = CheckCast<IGradientBoostRegressionModel>( boosting.TrainRegression( *train ) );
+	CGradientBoostQuickScorer quickScorer;
+	CPtr<IGradientBoostQSRegressionModel> qsModel = quickScorer.BuildRegression( *model );
+
+	const CFloatMatrixDesc matrix = test->GetMatrix();
+	CArray<double> results;
+	qsModel->PredictBatch( matrix, results, 4 );
+	ASSERT_EQ( matrix.Height, results.Size() );
+	for( int i = 0; i < matrix.Height; i++ ) {
+		ASSERT_EQ( qsModel->Predict( test->GetVector( i ) ), results[i] );
+	}
+}
+
+TEST( CModelBatchTest, ClassifyBatchPerformance )
+{
+	CRandom random( 0 );
+	CPtr<CClassificationRandomProblem> train = CClassificationRandomProblem::Random( random, 2000, 50, 2 );
+	CPtr<CClassificationRandomProblem> test = CClassificationRandomProblem::Random( random, 20000, 50, 2 );
+	const CFloatMatrixDesc matrix = test->GetMatrix();
+
+	CGradientBoost::CParams params;
+	params.Random = &random;
+	params.IterationsCount = 1000;
+	params.MaxTreeDepth = 6;
+	params.TreeBuilder = GBTB_FastHist;
+	CGradientBoost boosting( params );
+	CPtr<IModel> model = boosting.Train( *train );
+
+	CArray<CClassificationResult> results;
+	results.SetSize( matrix.Height );
+	int begin = GetTickCount();
+	for( int i = 0; i < matrix.Height; i++ ) {
+		model->Classify( test->GetVector( i ), results[i] );
+	}
+	GTEST_LOG_( INFO ) << "Per-row classification time: " << GetTickCount() - begin;
+
+	for( int threadCount : { 1, 4 } ) {
+		begin = GetTickCount();
+		ASSERT_TRUE( model->ClassifyBatch( matrix, results, threadCount ) );
+		GTEST_LOG_( INFO ) << "Batch classification time (" << threadCount << " threads): " << GetTickCount() - begin;
+	}
+
+	CGradientBoostQuickScorer quickScorer;
+	CPtr<IGradientBoostQSModel> qsModel = quickScorer.Build( *CheckCast<IGradientBoostModel>( model ) );
+	begin = GetTickCount();
+	for( int i = 0; i < matrix.Height; i++ ) {
+		qsModel->Classify( test->GetVector( i ), results[i] );
+	}
+	GTEST_LOG_( INFO ) << "QuickScorer per-row classification time: " << GetTickCount() - begin;
+
+	for( int threadCount : { 1, 4 } ) {
+		begin = GetTickCount();
+		ASSERT_TRUE( qsModel->ClassifyBatch( matrix, results, threadCount ) );
+		GTEST_LOG_( INFO ) << "QuickScorer batch classification time (" << threadCount << " threads): "
+			<< GetTickCount() - begin;
+	}
+}
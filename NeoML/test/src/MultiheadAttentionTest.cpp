@@ -0,0 +1,325 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static CPtr<CDnnBlob> createRandomBlob( CRandom& random, std::initializer_list<int> dims, float minValue, float maxValue )
+{
+	CPtr<CDnnBlob> blob = CDnnBlob::CreateTensor( MathEngine(), CT_Float, dims );
+	CArray<float> data;
+	for( int i = 0; i < blob->GetDataSize(); ++i ) {
+		data.Add( static_cast<float>( random.Uniform( minValue, maxValue ) ) );
+	}
+	blob->CopyFrom( data.GetPtr() );
+	return blob;
+}
+
+// The mask with ~30% of ignored elements
+static CPtr<CDnnBlob> createRandomMask( CRandom& random, std::initializer_list<int> dims )
+{
+	CPtr<CDnnBlob> blob = CDnnBlob::CreateTensor( MathEngine(), CT_Float, dims );
+	CArray<float> data;
+	for( int i = 0; i < blob->GetDataSize(); ++i ) {
+		data.Add( random.Uniform( 0, 1 ) < 0.3 ? 1.f : 0.f );
+	}
+	blob->CopyFrom( data.GetPtr() );
+	return blob;
+}
+
+static void getBlobData( const CDnnBlob& blob, CArray<float>& data )
+{
+	data.SetSize( blob.GetDataSize() );
+	blob.CopyTo( data.GetPtr() );
+}
+
+// Checks that the fused attention gives the same result as the sublayers
+static void testFusedAttention( CMultiheadAttentionLayer::TMaskType maskType, bool useMask )
+{
+	CRandom random( 0x1A2B );
+
+	const int batchSize = 3;
+	const int headCount = 4;
+	const int hiddenSize = 32;
+	const int seqQ = 37;
+	const int seqKV = 45;
+	const int channels = 12;
+
+	CDnn net( random, MathEngine() );
+	CPtr<CSourceLayer> q = AddLayer<CSourceLayer>( "q", net );
+	CPtr<CSourceLayer> k = AddLayer<CSourceLayer>( "k", net );
+	CPtr<CSourceLayer> v = AddLayer<CSourceLayer>( "v", net );
+	CPtr<CMultiheadAttentionLayer> attention = AddLayer<CMultiheadAttentionLayer>( "attention", { q, k, v } );
+	attention->SetHeadCount( headCount );
+	attention->SetHiddenSize( hiddenSize );
+	attention->SetOutputSize( channels );
+	attention->SetUseMask( useMask );
+	attention->SetMaskType( maskType );
+	CPtr<CSinkLayer> output = AddLayer<CSinkLayer>( "output", { attention } );
+
+	q->SetBlob( createRandomBlob( random, { 1, batchSize, seqQ, 1, 1, 1, channels }, -1, 1 ) );
+	k->SetBlob( createRandomBlob( random, { 1, batchSize, seqKV, 1, 1, 1, channels }, -1, 1 ) );
+	v->SetBlob( createRandomBlob( random, { 1, batchSize, seqKV, 1, 1, 1, channels }, -1, 1 ) );
+	if( useMask ) {
+		CPtr<CSourceLayer> mask = AddLayer<CSourceLayer>( "mask", net );
+		attention->Connect( 3, *mask );
+		if( maskType == CMultiheadAttentionLayer::MT_Eltwise ) {
+			mask->SetBlob( createRandomMask( random, { 1, batchSize, headCount, 1, seqQ, 1, seqKV } ) );
+		} else {
+			mask->SetBlob( createRandomMask( random, { 1, 1, 1, 1, seqQ, 1, seqKV } ) );
+		}
+	}
+
+	net.RunOnce();
+	CArray<float> fused;
+	getBlobData( *output->GetBlob(), fused );
+
+	if( maskType == CMultiheadAttentionLayer::MT_Triangle ) {
+		// The last element of K and V is visible only to the last element of Q
+		CArray<float> data;
+		getBlobData( *v->GetBlob(), data );
+		for( int b = 0; b < batchSize; ++b ) {
+			for( int c = 0; c < channels; ++c ) {
+				data[( b * seqKV + seqKV - 1 ) * channels + c] += 10.f;
+			}
+		}
+		v->GetBlob()->CopyFrom( data.GetPtr() );
+		net.RunOnce();
+		CArray<float> changed;
+		getBlobData( *output->GetBlob(), changed );
+		for( int b = 0; b < batchSize; ++b ) {
+			for( int i = 0; i < ( seqQ - 1 ) * channels; ++i ) {
+				ASSERT_EQ( fused[b * seqQ * channels + i], changed[b * seqQ * channels + i] );
+			}
+		}
+		changed.CopyTo( fused );
+	}
+
+	// The softmax output can't be calculated by the fused attention
+	CPtr<CSinkLayer> softmax = new CSinkLayer( MathEngine() );
+	softmax->SetName( "softmax" );
+	softmax->Connect( 0, *attention, 1 );
+	net.AddLayer( *softmax );
+
+	net.RunOnce();
+	CArray<float> expected;
+	getBlobData( *output->GetBlob(), expected );
+
+	ASSERT_EQ( expected.Size(), fused.Size() );
+	for( int i = 0; i < expected.Size(); ++i ) {
+		ASSERT_TRUE( FloatEq( expected[i], fused[i], 1e-4f ) );
+	}
+}
+
+TEST( CMultiheadAttentionLayerTest, FusedNoMask )
+{
+	testFusedAttention( CMultiheadAttentionLayer::MT_OneObject, false );
+}
+
+TEST( CMultiheadAttentionLayerTest, FusedOneObjectMask )
+{
+	testFusedAttention( CMultiheadAttentionLayer::MT_OneObject, true );
+}
+
+TEST( CMultiheadAttentionLayerTest, FusedEltwiseMask )
+{
+	testFusedAttention( CMultiheadAttentionLayer::MT_Eltwise, true );
+}
+
+TEST( CMultiheadAttentionLayerTest, FusedTriangleMask )
+{
+	testFusedAttention( CMultiheadAttentionLayer::MT_Triangle, false );
+}
+
+// Copies the positions [0; length) of the given object
+static CPtr<CDnnBlob> getObjectPositions( const CDnnBlob& blob, int index, int length )
+{
+	const int listSize = blob.GetListSize();
+	const int channels = blob.GetChannelsCount();
+	CArray<float> data;
+	getBlobData( blob, data );
+
+	CPtr<CDnnBlob> result = CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, 1, length, 1, 1, 1, channels } );
+	result->CopyFrom( data.GetPtr() + index * listSize * channels );
+	return result;
+}
+
+TEST( CMultiheadAttentionLayerTest, FusedSequenceLengths )
+{
+	CRandom random( 0x5E6F );
+
+	const int batchSize = 4;
+	const int seqQ = 9;
+	const int seqKV = 23;
+	const int channels = 8;
+	// The batch doesn't need to be sorted by the lengths
+	const int lengths[batchSize] = { 23, 5, 17, 1 };
+
+	CDnn net( random, MathEngine() );
+	CPtr<CSourceLayer> q = AddLayer<CSourceLayer>( "q", net );
+	CPtr<CSourceLayer> k = AddLayer<CSourceLayer>( "k", net );
+	CPtr<CSourceLayer> v = AddLayer<CSourceLayer>( "v", net );
+	CPtr<CSourceLayer> lengthsSource = AddLayer<CSourceLayer>( "lengths", net );
+	CPtr<CMultiheadAttentionLayer> attention = AddLayer<CMultiheadAttentionLayer>( "attention",
+		{ q, k, v, lengthsSource } );
+	attention->SetHeadCount( 2 );
+	attention->SetHiddenSize( 16 );
+	attention->SetOutputSize( channels );
+	attention->SetUseMask( true );
+	attention->SetMaskType( CMultiheadAttentionLayer::MT_SequenceLengths );
+	CPtr<CSinkLayer> output = AddLayer<CSinkLayer>( "output", { attention } );
+
+	CPtr<CDnnBlob> qBlob = createRandomBlob( random, { 1, batchSize, seqQ, 1, 1, 1, channels }, -1, 1 );
+	CPtr<CDnnBlob> kBlob = createRandomBlob( random, { 1, batchSize, seqKV, 1, 1, 1, channels }, -1, 1 );
+	CPtr<CDnnBlob> vBlob = createRandomBlob( random, { 1, batchSize, seqKV, 1, 1, 1, channels }, -1, 1 );
+	q->SetBlob( qBlob );
+	k->SetBlob( kBlob );
+	v->SetBlob( vBlob );
+	CPtr<CDnnBlob> lengthsBlob = CDnnBlob::CreateDataBlob( MathEngine(), CT_Int, 1, batchSize, 1 );
+	lengthsBlob->CopyFrom( lengths );
+	lengthsSource->SetBlob( lengthsBlob );
+
+	net.RunOnce();
+	CArray<float> fused;
+	getBlobData( *output->GetBlob(), fused );
+
+	// Each object without the padded keys and values and with the same weights
+	CDnn objectNet( random, MathEngine() );
+	CPtr<CSourceLayer> objectQ = AddLayer<CSourceLayer>( "q", objectNet );
+	CPtr<CSourceLayer> objectK = AddLayer<CSourceLayer>( "k", objectNet );
+	CPtr<CSourceLayer> objectV = AddLayer<CSourceLayer>( "v", objectNet );
+	CPtr<CMultiheadAttentionLayer> objectAttention = AddLayer<CMultiheadAttentionLayer>( "attention",
+		{ objectQ, objectK, objectV } );
+	objectAttention->SetHeadCount( 2 );
+	objectAttention->SetHiddenSize( 16 );
+	objectAttention->SetOutputSize( channels );
+	CPtr<CSinkLayer> objectOutput = AddLayer<CSinkLayer>( "output", { objectAttention } );
+
+	for( int b = 0; b < batchSize; ++b ) {
+		objectQ->SetBlob( getObjectPositions( *qBlob, b, seqQ ) );
+		objectK->SetBlob( getObjectPositions( *kBlob, b, lengths[b] ) );
+		objectV->SetBlob( getObjectPositions( *vBlob, b, lengths[b] ) );
+		if( b == 0 ) {
+			objectNet.RunOnce();
+			for( const char* name : { "Q", "K", "V", "Out.Dense" } ) {
+				CPtr<CFullyConnectedLayer> from = CheckCast<CFullyConnectedLayer>( attention->GetLayer( name ) );
+				CPtr<CFullyConnectedLayer> to = CheckCast<CFullyConnectedLayer>( objectAttention->GetLayer( name ) );
+				to->SetWeightsData( from->GetWeightsData() );
+				to->SetFreeTermData( from->GetFreeTermData() );
+			}
+		}
+		objectNet.RunOnce();
+
+		CArray<float> expected;
+		getBlobData( *objectOutput->GetBlob(), expected );
+		ASSERT_EQ( seqQ * channels, expected.Size() );
+		for( int i = 0; i < expected.Size(); ++i ) {
+			ASSERT_TRUE( FloatEq( expected[i], fused[b * seqQ * channels + i], 1e-4f ) );
+		}
+	}
+}
+
+// Copies the positions [start; start + length) of the sequences
+static CPtr<CDnnBlob> getPositions( const CDnnBlob& blob, int start, int length )
+{
+	const int batchWidth = blob.GetBatchWidth();
+	const int listSize = blob.GetListSize();
+	const int channels = blob.GetChannelsCount();
+	CArray<float> data;
+	getBlobData( blob, data );
+
+	CArray<float> positions;
+	for( int b = 0; b < batchWidth; ++b ) {
+		for( int i = ( b * listSize + start ) * channels; i < ( b * listSize + start + length ) * channels; ++i ) {
+			positions.Add( data[i] );
+		}
+	}
+	CPtr<CDnnBlob> result = CDnnBlob::CreateTensor( MathEngine(), CT_Float, { 1, batchWidth, length, 1, 1, 1, channels } );
+	result->CopyFrom( positions.GetPtr() );
+	return result;
+}
+
+// Runs the net on the positions [start; start + length) and checks the output against the expected positions
+static void checkDecodingStep( CDnn& net, CSourceLayer& input, CSinkLayer& output, const CDnnBlob& fullInput,
+	const CDnnBlob& expectedOutput, int start, int length )
+{
+	input.SetBlob( getPositions( fullInput, start, length ) );
+	net.RunOnce();
+
+	CArray<float> actual;
+	getBlobData( *output.GetBlob(), actual );
+	CArray<float> expected;
+	getBlobData( *getPositions( expectedOutput, start, length ), expected );
+	ASSERT_EQ( expected.Size(), actual.Size() );
+	for( int i = 0; i < expected.Size(); ++i ) {
+		ASSERT_TRUE( FloatEq( expected[i], actual[i], 1e-4f ) );
+	}
+}
+
+TEST( CMultiheadAttentionLayerTest, DecodingMode )
+{
+	CRandom random( 0x3C4D );
+
+	const int batchSize = 2;
+	const int seqLength = 19;
+	const int promptLength = 7;
+	const int channels = 16;
+
+	CDnn net( random, MathEngine() );
+	CPtr<CSourceLayer> input = AddLayer<CSourceLayer>( "input", net );
+	CPtr<CTransformerEncoderLayer> encoder = AddLayer<CTransformerEncoderLayer>( "encoder", { input } );
+	encoder->SetHeadCount( 4 );
+	encoder->SetHiddenSize( 24 );
+	encoder->SetFeedForwardSize( 32 );
+	encoder->SetMaskType( CMultiheadAttentionLayer::MT_Triangle );
+	CPtr<CSinkLayer> output = AddLayer<CSinkLayer>( "output", { encoder } );
+
+	// The causal run over the whole sequences
+	CPtr<CDnnBlob> fullInput = createRandomBlob( random, { 1, batchSize, seqLength, 1, 1, 1, channels }, -1, 1 );
+	input->SetBlob( fullInput );
+	net.RunOnce();
+	CPtr<CDnnBlob> expectedOutput = output->GetBlob()->GetCopy();
+
+	// The prompt at once and then the positions one by one
+	encoder->SetDecodingMode( true );
+	checkDecodingStep( net, *input, *output, *fullInput, *expectedOutput, 0, promptLength );
+	EXPECT_EQ( promptLength, encoder->GetCachedLength() );
+	EXPECT_EQ( promptLength, encoder->GetCacheCapacity() );
+	for( int i = promptLength; i < seqLength; ++i ) {
+		checkDecodingStep( net, *input, *output, *fullInput, *expectedOutput, i, 1 );
+	}
+	EXPECT_EQ( seqLength, encoder->GetCachedLength() );
+	// The capacity is doubled on overflow
+	EXPECT_EQ( 4 * promptLength, encoder->GetCacheCapacity() );
+
+	// Discard a part of the sequences and decode it once again
+	encoder->TrimCache( promptLength + 2 );
+	EXPECT_EQ( promptLength + 2, encoder->GetCachedLength() );
+	checkDecodingStep( net, *input, *output, *fullInput, *expectedOutput, promptLength + 2, seqLength - promptLength - 2 );
+	EXPECT_EQ( seqLength, encoder->GetCachedLength() );
+
+	encoder->ResetCache();
+	EXPECT_EQ( 0, encoder->GetCachedLength() );
+	checkDecodingStep( net, *input, *output, *fullInput, *expectedOutput, 0, seqLength );
+	EXPECT_EQ( 4 * promptLength, encoder->GetCacheCapacity() );
+
+	encoder->SetDecodingMode( false );
+	EXPECT_EQ( 0, encoder->GetCacheCapacity() );
+}
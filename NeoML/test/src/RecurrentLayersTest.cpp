@@ -0,0 +1,267 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Checks that the whole sequence run of the recurrent layer calculates the same result as its internal network
+static void checkWholeSequenceRun( const CPtr<CRecurrentLayer>& recurrent, bool isReverse )
+{
+	const int sequenceLength = 7;
+	const int batchWidth = 3;
+	const int inputSize = 5;
+
+	CRandom random( 0x1A5 );
+	CDnn dnn( random, MathEngine() );
+	CPtr<CSourceLayer> source = AddLayer<CSourceLayer>( "source", dnn );
+	recurrent->SetReverseSequence( isReverse );
+	AddLayer( recurrent, "recurrent", { source } );
+	CPtr<CSinkLayer> sink = AddLayer<CSinkLayer>( "sink", { recurrent } );
+
+	CPtr<CDnnBlob> input = CDnnBlob::CreateDataBlob( MathEngine(), CT_Float, sequenceLength, batchWidth, inputSize );
+	CArray<float> inputData;
+	for( int i = 0; i < input->GetDataSize(); ++i ) {
+		inputData.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	input->CopyFrom( inputData.GetPtr() );
+	source->SetBlob( input );
+
+	// The whole sequence run is used on CPU when the sequence is restarted on each run
+	dnn.RunOnce();
+	CArray<float> wholeSequenceResult;
+	wholeSequenceResult.SetSize( sink->GetBlob()->GetDataSize() );
+	sink->GetBlob()->CopyTo( wholeSequenceResult.GetPtr() );
+
+	// Otherwise the internal network is run step by step
+	dnn.SetAutoRestartMode( false );
+	dnn.RestartSequence();
+	dnn.RunOnce();
+	CArray<float> stepByStepResult;
+	stepByStepResult.SetSize( sink->GetBlob()->GetDataSize() );
+	sink->GetBlob()->CopyTo( stepByStepResult.GetPtr() );
+
+	ASSERT_EQ( sequenceLength * batchWidth * 6, wholeSequenceResult.Size() );
+	ASSERT_EQ( stepByStepResult.Size(), wholeSequenceResult.Size() );
+	for( int i = 0; i < stepByStepResult.Size(); ++i ) {
+		ASSERT_TRUE( FloatEq( stepByStepResult[i], wholeSequenceResult[i], 1e-4f ) );
+	}
+}
+
+TEST( CRecurrentLayersTest, LstmWholeSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CLstmLayer> lstm = new CLstmLayer( MathEngine() );
+		lstm->SetHiddenSize( 6 );
+		checkWholeSequenceRun( lstm.Ptr(), isReverse );
+	}
+}
+
+TEST( CRecurrentLayersTest, GruWholeSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CGruLayer> gru = new CGruLayer( MathEngine() );
+		gru->SetHiddenSize( 6 );
+		checkWholeSequenceRun( gru.Ptr(), isReverse );
+	}
+}
+
+TEST( CRecurrentLayersTest, IrnnWholeSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CIrnnLayer> irnn = new CIrnnLayer( MathEngine() );
+		irnn->SetHiddenSize( 6 );
+		irnn->SetIdentityScale( 0.5f );
+		irnn->SetInputWeightStd( 0.5f );
+		checkWholeSequenceRun( irnn.Ptr(), isReverse );
+	}
+}
+
+// Copies the positions [0; length) of the given sequence
+static CPtr<CDnnBlob> getSequence( const CDnnBlob& blob, int index, int length )
+{
+	const int batchWidth = blob.GetBatchWidth();
+	const int objectSize = blob.GetObjectSize();
+	CArray<float> data;
+	data.SetSize( blob.GetDataSize() );
+	blob.CopyTo( data.GetPtr() );
+
+	CArray<float> sequence;
+	for( int pos = 0; pos < length; ++pos ) {
+		for( int i = 0; i < objectSize; ++i ) {
+			sequence.Add( data[( pos * batchWidth + index ) * objectSize + i] );
+		}
+	}
+	CPtr<CDnnBlob> result = CDnnBlob::CreateDataBlob( MathEngine(), CT_Float, length, 1, objectSize );
+	result->CopyFrom( sequence.GetPtr() );
+	return result;
+}
+
+// Checks that each sequence of the packed batch is calculated as if it were processed alone
+static void checkPackedSequence( const CPtr<CRecurrentLayer>& recurrent, int stateInputCount, bool isReverse )
+{
+	const int sequenceLength = 7;
+	const int batchWidth = 5;
+	const int inputSize = 5;
+	const int hiddenSize = 6;
+	const int lengths[batchWidth] = { 7, 5, 5, 2, 0 };
+
+	CRandom random( 0x2B6 );
+	CDnn dnn( random, MathEngine() );
+	CPtr<CSourceLayer> source = AddLayer<CSourceLayer>( "source", dnn );
+	CPtr<CSourceLayer> lengthsSource = AddLayer<CSourceLayer>( "lengths", dnn );
+	recurrent->SetReverseSequence( isReverse );
+	recurrent->SetPackedSequence( true );
+	CArray<CBaseLayer*> inputs = { source, lengthsSource };
+	CObjectArray<CSourceLayer> stateSources;
+	for( int i = 0; i < stateInputCount; ++i ) {
+		stateSources.Add( AddLayer<CSourceLayer>( CString( "state" ) + Str( i ), dnn ) );
+		inputs.Add( stateSources.Last() );
+	}
+	AddLayer( recurrent, "recurrent", inputs );
+	CPtr<CSinkLayer> sink = AddLayer<CSinkLayer>( "sink", { recurrent } );
+
+	CPtr<CDnnBlob> input = CDnnBlob::CreateDataBlob( MathEngine(), CT_Float, sequenceLength, batchWidth, inputSize );
+	CArray<float> data;
+	for( int i = 0; i < input->GetDataSize(); ++i ) {
+		data.Add( static_cast<float>( random.Uniform( -1, 1 ) ) );
+	}
+	input->CopyFrom( data.GetPtr() );
+	source->SetBlob( input );
+	CPtr<CDnnBlob> lengthsBlob = CDnnBlob::CreateDataBlob( MathEngine(), CT_Int, 1, batchWidth, 1 );
+	lengthsBlob->CopyFrom( lengths );
+	lengthsSource->SetBlob( lengthsBlob );
+	CObjectArray<CDnnBlob> states;
+	for( int i = 0; i < stateInputCount; ++i ) {
+		states.Add( CDnnBlob::CreateDataBlob( MathEngine(), CT_Float, 1, batchWidth, hiddenSize ) );
+		data.SetSize( states.Last()->GetDataSize() );
+		for( int j = 0; j < data.Size(); ++j ) {
+			data[j] = static_cast<float>( random.Uniform( -1, 1 ) );
+		}
+		states.Last()->CopyFrom( data.GetPtr() );
+		stateSources[i]->SetBlob( states.Last() );
+	}
+
+	dnn.RunOnce();
+	CArray<float> packedResult;
+	packedResult.SetSize( sink->GetBlob()->GetDataSize() );
+	sink->GetBlob()->CopyTo( packedResult.GetPtr() );
+	ASSERT_EQ( sequenceLength * batchWidth * hiddenSize, packedResult.Size() );
+
+	for( int b = 0; b < batchWidth; ++b ) {
+		// The positions after the end of the sequence are zeros
+		for( int pos = lengths[b]; pos < sequenceLength; ++pos ) {
+			for( int i = 0; i < hiddenSize; ++i ) {
+				ASSERT_EQ( 0.f, packedResult[( pos * batchWidth + b ) * hiddenSize + i] );
+			}
+		}
+		if( lengths[b] == 0 ) {
+			continue;
+		}
+
+		// The batch of one sequence without padding
+		source->SetBlob( getSequence( *input, b, lengths[b] ) );
+		CPtr<CDnnBlob> lengthBlob = CDnnBlob::CreateDataBlob( MathEngine(), CT_Int, 1, 1, 1 );
+		lengthBlob->CopyFrom( &lengths[b] );
+		lengthsSource->SetBlob( lengthBlob );
+		for( int i = 0; i < stateInputCount; ++i ) {
+			stateSources[i]->SetBlob( getSequence( *states[i], b, 1 ) );
+		}
+		dnn.RunOnce();
+		CArray<float> expected;
+		expected.SetSize( sink->GetBlob()->GetDataSize() );
+		sink->GetBlob()->CopyTo( expected.GetPtr() );
+		ASSERT_EQ( lengths[b] * hiddenSize, expected.Size() );
+		for( int pos = 0; pos < lengths[b]; ++pos ) {
+			for( int i = 0; i < hiddenSize; ++i ) {
+				ASSERT_TRUE( FloatEq( expected[pos * hiddenSize + i],
+					packedResult[( pos * batchWidth + b ) * hiddenSize + i], 1e-4f ) );
+			}
+		}
+	}
+
+	// The packed mode is serialized
+	CMemoryFile file;
+	{
+		CArchive archive( &file, CArchive::store );
+		CPtr<CBaseLayer> layer = recurrent.Ptr();
+		SerializeLayer( archive, MathEngine(), layer );
+	}
+	file.SeekToBegin();
+	CPtr<CBaseLayer> loaded;
+	{
+		CArchive archive( &file, CArchive::load );
+		SerializeLayer( archive, MathEngine(), loaded );
+	}
+	EXPECT_TRUE( CheckCast<CRecurrentLayer>( loaded )->IsPackedSequence() );
+}
+
+TEST( CRecurrentLayersTest, LstmPackedSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CLstmLayer> lstm = new CLstmLayer( MathEngine() );
+		lstm->SetHiddenSize( 6 );
+		checkPackedSequence( lstm.Ptr(), 2, isReverse );
+	}
+}
+
+TEST( CRecurrentLayersTest, GruPackedSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CGruLayer> gru = new CGruLayer( MathEngine() );
+		gru->SetHiddenSize( 6 );
+		checkPackedSequence( gru.Ptr(), 1, isReverse );
+	}
+}
+
+TEST( CRecurrentLayersTest, IrnnPackedSequence )
+{
+	for( bool isReverse : { false, true } ) {
+		CPtr<CIrnnLayer> irnn = new CIrnnLayer( MathEngine() );
+		irnn->SetHiddenSize( 6 );
+		irnn->SetIdentityScale( 0.5f );
+		irnn->SetInputWeightStd( 0.5f );
+		checkPackedSequence( irnn.Ptr(), 0, isReverse );
+	}
+}
+
+// The internal network doesn't support the packed sequences
+TEST( CRecurrentLayersTest, PackedSequenceStepByStep )
+{
+	CRandom random( 0x2B7 );
+	CDnn dnn( random, MathEngine() );
+	CPtr<CSourceLayer> source = AddLayer<CSourceLayer>( "source", dnn );
+	CPtr<CSourceLayer> lengthsSource = AddLayer<CSourceLayer>( "lengths", dnn );
+	CPtr<CGruLayer> gru = new CGruLayer( MathEngine() );
+	gru->SetHiddenSize( 6 );
+	gru->SetPackedSequence( true );
+	AddLayer( gru, "gru", { source, lengthsSource } );
+	AddLayer<CSinkLayer>( "sink", { gru } );
+
+	CPtr<CDnnBlob> input = CDnnBlob::CreateDataBlob( MathEngine(), CT_Float, 4, 2, 5 );
+	input->Fill( 0.5f );
+	source->SetBlob( input );
+	const int lengths[] = { 4, 3 };
+	CPtr<CDnnBlob> lengthsBlob = CDnnBlob::CreateDataBlob( MathEngine(), CT_Int, 1, 2, 1 );
+	lengthsBlob->CopyFrom( lengths );
+	lengthsSource->SetBlob( lengthsBlob );
+
+	dnn.SetAutoRestartMode( false );
+	EXPECT_ANY_THROW( dnn.RunOnce() );
+}
@@ -0,0 +1,230 @@
+/* Copyright © 2017-2022 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <TestFixture.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+namespace NeoMLTest {
+
+struct CThreadPoolTestParams {
+	int ThreadCount;
+	std::vector<std::atomic<int>> Counters;
+
+	CThreadPoolTestParams( int threadCount, int counterCount ) : ThreadCount( threadCount ), Counters( counterCount )
+	{
+		for( auto& counter : Counters ) {
+			counter = 0;
+		}
+	}
+};
+
+} // namespace NeoMLTest
+
+// Each thread index must be executed only by its own thread
+TEST( ThreadPoolTest, BoundTasks )
+{
+	const int threadCount = 4;
+	std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+	CThreadPoolTestParams params( threadCount, threadCount );
+
+	for( int i = 0; i < 3; ++i ) {
+		NEOML_NUM_THREADS( *pool, &params, []( int threadIndex, void* ptr ) {
+			CThreadPoolTestParams& params = *static_cast<CThreadPoolTestParams*>( ptr );
+			ASSERT_TRUE( threadIndex >= 0 && threadIndex < params.ThreadCount );
+			params.Counters[threadIndex]++;
+		} );
+	}
+
+	for( int i = 0; i < threadCount; ++i ) {
+		EXPECT_EQ( 3, params.Counters[i].load() );
+	}
+}
+
+// The uneven tasks of the group are spread over the threads
+TEST( ThreadPoolTest, UnevenGroupTasks )
+{
+	const int threadCount = 4;
+	const int taskCount = 64;
+	std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+	CThreadPoolTestParams params( threadCount, taskCount );
+
+	struct CTaskParams {
+		CThreadPoolTestParams* Common;
+		int Index;
+	};
+	std::vector<CTaskParams> taskParams( taskCount );
+	CThreadPoolTaskGroup group;
+	for( int i = 0; i < taskCount; ++i ) {
+		taskParams[i] = CTaskParams{ &params, i };
+		pool->AddTask( group, []( int threadIndex, void* ptr ) {
+			CTaskParams& task = *static_cast<CTaskParams*>( ptr );
+			ASSERT_TRUE( threadIndex >= 0 && threadIndex < task.Common->ThreadCount );
+			if( task.Index % 8 == 0 ) {
+				std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+			}
+			task.Common->Counters[task.Index]++;
+		}, &taskParams[i] );
+	}
+	pool->WaitGroup( group );
+
+	EXPECT_TRUE( group.IsFinished() );
+	for( int i = 0; i < taskCount; ++i ) {
+		EXPECT_EQ( 1, params.Counters[i].load() );
+	}
+}
+
+// The tasks may add the subtasks and wait for them
+TEST( ThreadPoolTest, NestedGroups )
+{
+	const int threadCount = 3;
+	const int outerCount = 8;
+	const int innerCount = 16;
+	std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+
+	struct COuterParams {
+		IThreadPool* Pool;
+		std::atomic<int>* Counter;
+	};
+	std::atomic<int> counter( 0 );
+	COuterParams outerParams{ pool.get(), &counter };
+
+	CThreadPoolTaskGroup group;
+	for( int i = 0; i < outerCount; ++i ) {
+		pool->AddTask( group, []( int, void* ptr ) {
+			COuterParams& params = *static_cast<COuterParams*>( ptr );
+			CThreadPoolTaskGroup innerGroup;
+			for( int j = 0; j < innerCount; ++j ) {
+				params.Pool->AddTask( innerGroup, []( int, void* counter ) {
+					( *static_cast<std::atomic<int>*>( counter ) )++;
+				}, params.Counter );
+			}
+			params.Pool->WaitGroup( innerGroup );
+		}, &outerParams );
+	}
+	pool->WaitGroup( group );
+	pool->WaitAllTask();
+
+	EXPECT_EQ( outerCount * innerCount, counter.load() );
+}
+
+// Each element of the range is processed exactly once
+TEST( ThreadPoolTest, ParallelFor )
+{
+	for( int threadCount : { 1, 4 } ) {
+		std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+		for( int grain : { 1, 7, 1000 } ) {
+			const int count = 513;
+			CThreadPoolTestParams params( threadCount, count );
+			ParallelFor( *pool, count, grain, &params, []( int threadIndex, void* ptr, int begin, int end ) {
+				CThreadPoolTestParams& params = *static_cast<CThreadPoolTestParams*>( ptr );
+				ASSERT_TRUE( threadIndex >= 0 && threadIndex < params.ThreadCount );
+				ASSERT_TRUE( 0 <= begin && begin < end && end <= static_cast<int>( params.Counters.size() ) );
+				for( int i = begin; i < end; ++i ) {
+					params.Counters[i]++;
+				}
+			} );
+			for( int i = 0; i < count; ++i ) {
+				EXPECT_EQ( 1, params.Counters[i].load() );
+			}
+		}
+	}
+}
+
+namespace NeoMLTest {
+
+struct CParallelForBalancingParams {
+	std::vector<std::atomic<int>> Counters;
+	std::atomic<int> Done; // the number of the processed elements
+	std::atomic<int> ThreadMask; // the bits of the threads that have processed any chunks
+	bool IsSlowChunkBalanced; // the other elements were processed while the first chunk was running
+
+	explicit CParallelForBalancingParams( int count ) : Counters( count ), Done( 0 ), ThreadMask( 0 ),
+		IsSlowChunkBalanced( false )
+	{
+		for( auto& counter : Counters ) {
+			counter = 0;
+		}
+	}
+};
+
+} // namespace NeoMLTest
+
+// While one thread is busy with a slow chunk, the other threads process the rest of the range
+// The first chunk waits until all the other elements are processed; the static split would never finish it
+TEST( ThreadPoolTest, ParallelForBalancing )
+{
+	const int threadCount = 4;
+	const int count = 64;
+	std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+
+	CParallelForBalancingParams params( count );
+	ParallelFor( *pool, count, 1, &params, []( int threadIndex, void* ptr, int begin, int end ) {
+		CParallelForBalancingParams& params = *static_cast<CParallelForBalancingParams*>( ptr );
+		params.ThreadMask |= 1 << threadIndex;
+		for( int i = begin; i < end; ++i ) {
+			if( i == 0 ) {
+				// The timeout only keeps the test from hanging if the range isn't balanced
+				const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 30 );
+				while( params.Done.load() < count - 1 && std::chrono::steady_clock::now() < deadline ) {
+					std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+				}
+				params.IsSlowChunkBalanced = params.Done.load() == count - 1;
+			}
+			params.Counters[i]++;
+			params.Done++;
+		}
+	} );
+
+	EXPECT_TRUE( params.IsSlowChunkBalanced );
+	for( int i = 0; i < count; ++i ) {
+		EXPECT_EQ( 1, params.Counters[i].load() );
+	}
+	// More than one thread has taken the chunks
+	const int threadMask = params.ThreadMask.load();
+	EXPECT_NE( 0, threadMask & ( threadMask - 1 ) );
+}
+
+// The group tasks queued before the pool is stopped are executed, so their waiter doesn't hang
+TEST( ThreadPoolTest, StopWithQueuedTasks )
+{
+	const int threadCount = 2;
+	const int taskCount = 32;
+	std::unique_ptr<IThreadPool> pool( CreateThreadPool( threadCount ) );
+
+	std::atomic<int> counter( 0 );
+	CThreadPoolTaskGroup group;
+	for( int i = 0; i < taskCount; ++i ) {
+		pool->AddTask( group, []( int, void* ptr ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+			( *static_cast<std::atomic<int>*>( ptr ) )++;
+		}, &counter );
+	}
+	std::thread waiter( [&pool, &group] { pool->WaitGroup( group ); } );
+	pool->StopAndWait();
+	waiter.join();
+
+	EXPECT_TRUE( group.IsFinished() );
+	EXPECT_EQ( taskCount, counter.load() );
+	EXPECT_FALSE( pool->AddTask( 0, []( int, void* ) {}, nullptr ) );
+}
@@ -52,6 +52,16 @@ enum TActivationFunction {
 	AF_Count
 };
 
+// The activation applied to the result inside the computation kernel
+// Only AF_Linear and AF_ReLU are supported; for AF_ReLU Param is the upper threshold (no threshold if it is <= 0)
+struct CFusedActivation {
+	TActivationFunction Type;
+	float Param;
+
+	CFusedActivation() : Type( AF_Linear ), Param( 0.f ) {}
+	CFusedActivation( TActivationFunction type, float param ) : Type( type ), Param( param ) {}
+};
+
 // Supported coordinate modes for linear interpolation
 // The variables in formula:
 //     - scale - size multiplier
@@ -663,6 +673,7 @@ struct NEOMATHENGINE_API CGlobalMaxOverTimePoolingDesc : public CCrtAllocatedObj
 struct NEOMATHENGINE_API CMaxOverTimePoolingDesc : public CCrtAllocatedObject { public: virtual ~CMaxOverTimePoolingDesc(); };
 struct NEOMATHENGINE_API CLrnDesc : public CCrtAllocatedObject { public: virtual ~CLrnDesc(); };
 struct NEOMATHENGINE_API CLstmDesc : public CCrtAllocatedObject { public: virtual ~CLstmDesc(); };
+struct NEOMATHENGINE_API CQuantizedMatrixDesc : public CCrtAllocatedObject { public: virtual ~CQuantizedMatrixDesc(); };
 
 //------------------------------------------------------------------------------------------------------------
 // RLE format
@@ -1006,6 +1017,13 @@ public:
 		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
 		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink, const CConstFloatHandle& input,
 		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) = 0;
+	// Calculates one LSTM step when the input fully connected layer has been applied to the whole sequence beforehand
+	// inputFullyConnectedResult is the objectCount x (4 * hiddenSize) result for this step with the free term added;
+	// it is used as a temporary buffer and is overwritten
+	virtual void LstmRecurrentStep( CLstmDesc& desc, const CFloatHandle& inputFullyConnectedResult,
+		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
+		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink,
+		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) = 0;
 
 	// CTC
 
@@ -1067,6 +1085,71 @@ public:
 		const CConstFloatHandle* channelwiseFreeTerm, const CConstFloatHandle& channelwiseReLUThreshold,
 		const CConstFloatHandle& downFilter, const CConstFloatHandle* downFreeTerm, bool residual,
 		const CFloatHandle& outputHandle ) = 0;
+
+	// Int8 quantized inference (supported only on CPU)
+	// The matrix is quantized row by row: row[i] ~= int8Row[i] * scale[i], the scales are chosen by the max absolute values
+	// The descriptor should be destroyed using the standard delete operator after use.
+	virtual CQuantizedMatrixDesc* InitQuantizedMatrix( const CConstFloatHandle& matrix, int height, int width ) = 0;
+	// Creates the quantized matrix from the int8 data (height x width) and the row scales (height)
+	// returned by GetQuantizedMatrixData, so that the matrix may be stored without the float original
+	virtual CQuantizedMatrixDesc* InitQuantizedMatrix( const signed char* data, const float* scales, int height, int width ) = 0;
+	virtual void GetQuantizedMatrixData( const CQuantizedMatrixDesc& matrix, signed char* data, float* scales ) = 0;
+	// result = activation( first * transposed( second ) + freeTerm )
+	// The first matrix is quantized on the fly with firstScale (or with the max absolute value of each row if firstScale <= 0)
+	// The values which don't fit into the int8 range after scaling are saturated
+	// The quantized values of the first matrix are in the int8 range, but the CPU math engine keeps them widened to int16
+	virtual void MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle& first, int firstHeight, int firstWidth,
+		float firstScale, const CQuantizedMatrixDesc& second, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) = 0;
+	// Convolution with the filter quantized by InitQuantizedMatrix( filter, filterCount, filterObjectSize )
+	// The source is quantized the same way as the first matrix in MultiplyMatrixByTransposedQuantizedMatrix
+	virtual void BlobQuantizedConvolution( const CConvolutionDesc& desc, const CConstFloatHandle& source, float sourceScale,
+		const CQuantizedMatrixDesc& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) = 0;
+
+	// The operations with the activation applied inside the kernel (supported only on CPU)
+	// Each block of the result is activated right after it is calculated, the result isn't passed again
+	// The same as BlobConvolution followed by the activation
+	virtual void BlobConvolutionWithActivation( const CConvolutionDesc& desc, const CConstFloatHandle& source,
+		const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) = 0;
+	// result = activation( first * transposed( second ) + freeTerm )
+	// The result is firstHeight * secondHeight, freeTerm may be null
+	virtual void MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle& first, int firstHeight,
+		int firstWidth, const CConstFloatHandle& second, int secondHeight, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) = 0;
+	// result = activation( first + second )
+	virtual void VectorAddWithActivation( const CConstFloatHandle& first, const CConstFloatHandle& second,
+		const CFloatHandle& result, int vectorSize, const CFusedActivation& activation ) = 0;
+
+	// Multihead scaled dot-product attention: result = softmax( Q * K_t * scale - 1e9 * mask ) * V (supported only on CPU)
+	// The scores are processed by tiles with the online softmax, so the seqQ x seqKV matrix is never stored
+	// q and result are (batchSize x seqQ x headCount x headSize), k and v are (batchSize x seqKV x headCount x headSize)
+	// mask may be null; it is (seqQ x seqKV) if maskObjectCount == 1
+	// or (batchSize x headCount x seqQ x seqKV) if maskObjectCount == batchSize * headCount
+	// If isCausal is true the i'th position of Q attends only to the positions j <= i + seqKV - seqQ of K and V
+	// kvLengths may be null; otherwise it contains batchSize numbers of the valid K and V positions (1..seqKV)
+	// and the padded positions after them are skipped without calculating their scores
+	virtual void ScaledDotProductAttention( int batchSize, int headCount, int headSize, int seqQ, int seqKV, float scale,
+		const CConstFloatHandle& q, const CConstFloatHandle& k, const CConstFloatHandle& v,
+		const CConstFloatHandle* mask, int maskObjectCount, bool isCausal, const CConstIntHandle* kvLengths,
+		const CFloatHandle& result ) = 0;
+
+	// Layer normalization of each object: result = ( input - mean ) / sqrt( variance + epsilon ) * scale + bias
+	// The mean and the variance of each object are calculated in one pass with the Welford algorithm
+	// input and result are (objectCount x objectSize), scale and bias are vectors of objectSize
+	// normalizedInput (may be null) is set to ( input - mean ) / sqrt( variance + epsilon ) for the backward pass
+	// invSqrtVariance (may be null) is set to 1 / sqrt( variance + epsilon ) of each object
+	// result may be the same as input
+	virtual void LayerNormalization( int objectCount, int objectSize, const CConstFloatHandle& input, float epsilon,
+		const CConstFloatHandle& scale, const CConstFloatHandle& bias, const CFloatHandle& result,
+		const CFloatHandle* normalizedInput, const CFloatHandle* invSqrtVariance ) = 0;
+	// The backward pass of the layer normalization:
+	// inputDiff = invSqrtVariance * ( g - mean( g ) - normalizedInput * mean( g * normalizedInput ) ), where g = outputDiff * scale
+	// inputDiff may be the same as outputDiff
+	virtual void LayerNormalizationBackward( int objectCount, int objectSize, const CConstFloatHandle& normalizedInput,
+		const CConstFloatHandle& invSqrtVariance, const CConstFloatHandle& scale, const CConstFloatHandle& outputDiff,
+		const CFloatHandle& inputDiff ) = 0;
 };
 
 //------------------------------------------------------------------------------------------------------------
@@ -1164,6 +1247,21 @@ public:
 	// Creates a handle with data from another math engine
 	virtual CMemoryHandle CopyFrom( const CMemoryHandle& handle, size_t size ) = 0;
 
+	// Creates a handle to the host memory allocated outside of the math engine (e.g. a memory-mapped file)
+	// The memory must stay valid while the handle is used and must not be freed through the math engine
+	// Returns the null handle if the math engine can't work with the host memory directly
+	virtual CMemoryHandle WrapHostMemory( const void* /*data*/ ) { return CMemoryHandle(); }
+
+	// Convolution autotuning
+	// In the autotuning mode InitBlobConvolution, InitBlobChannelwiseConvolution and InitTimeConvolution
+	// measure the available algorithms once for each new convolution shape and choose the fastest one
+	// The choices may be saved to a file and loaded on another host to skip the measurements;
+	// the loaded choices are used even if the autotuning mode is off
+	// Only the CPU math engine supports autotuning, the loading and saving return false for the other engines
+	virtual void SetConvolutionAutotuningMode( bool /*enable*/ ) {}
+	virtual bool LoadConvolutionAutotuningCache( const char* /*fileName*/ ) { return false; }
+	virtual bool SaveConvolutionAutotuningCache( const char* /*fileName*/ ) const { return false; }
+
 	// Creates a object for aggregating statistics.
 	// This object should be destroyed using the standard delete operator after use.
 	virtual IPerformanceCounters* CreatePerformanceCounters() const = 0;
@@ -1184,6 +1282,18 @@ public:
 // This math engine should be destroyed using the standard delete operator after use
 NEOMATHENGINE_API IMathEngine* CreateCpuMathEngine( int threadCount, size_t memoryLimit );
 
+// The memory allocators of the CPU math engine
+enum TCpuMemoryAllocator {
+	// The pools of the buffers for each thread, guarded by the math engine lock (default)
+	CMA_Pool,
+	// The thread-local caches of the buffers without the math engine lock
+	// Recommended when many threads use the same math engine at the same time
+	CMA_ThreadCache
+};
+
+// Creates a math engine that uses a CPU for calculations and the specified memory allocator
+NEOMATHENGINE_API IMathEngine* CreateCpuMathEngine( int threadCount, size_t memoryLimit, TCpuMemoryAllocator allocator );
+
 // Destroys all global data that is shared between CPU math engines
 // Should be called only if there are no running CpuMathEngine instances
 NEOMATHENGINE_API void CpuMathEngineCleanUp();
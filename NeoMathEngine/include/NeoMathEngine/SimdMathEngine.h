@@ -26,6 +26,13 @@ typedef void ( *SgemmFunc )( bool transA, bool transB,
 	float* cPtr, size_t cRowSize,
 	size_t m, size_t n, size_t k );
 
+// Calculates the 4 x secondCount block of first * transposed( second ) for the int8 quantized inference
+// first contains 4 rows of the int8 values widened to int16, second contains secondCount rows of the int8 values
+// All the rows have rowSize elements which is a multiple of 32 (the rows are padded with zeros); secondCount is even
+// The int32 sums are stored into 4 rows of result with resultRowSize elements
+typedef void ( *Int8MultiplyFunc )( const short* first, const signed char* second, int secondCount, int rowSize,
+	int* result, int resultRowSize );
+
 struct CMathEngineLstmDesc;
 
 class ISimdMathEngine : public CCrtAllocatedObject {
@@ -38,10 +45,12 @@ public:
 		int strideHeight, int strideWidth, int dilationHeight, int dilationWidth, const CBlobDesc& filter,
         const CBlobDesc& result ) const = 0;
 
+	// The activation is applied to each row of the result right after it is calculated
 	virtual void BlobConvolution( const CConvolutionDesc& convDesc, const float* source,
-		const float* filter, const float* freeTerm, float* result ) const = 0;
+		const float* filter, const float* freeTerm, const CFusedActivation& activation, float* result ) const = 0;
 
 	virtual SgemmFunc GetSgemmFunction() const = 0;
+	virtual Int8MultiplyFunc GetInt8MultiplyFunction() const = 0;
 
 	virtual void Tanh( float* dst, const float* src, size_t dataSize, bool isMultithread = true ) = 0;
 	virtual void Sigmoid( float* dst, const float* src, size_t dataSize, bool isMultithread = true ) = 0;
@@ -18,9 +18,27 @@ limitations under the License.
 #include <NeoMathEngine/NeoMathEngineDefs.h>
 #include <NeoMathEngine/CrtAllocatedObject.h>
 #include <NeoMathEngine/NeoMathEngineException.h>
+#include <atomic>
 
 namespace NeoML {
 
+// The group of tasks which may be waited for together (see IThreadPool::WaitGroup)
+// The group must not be destroyed until all its tasks are completed
+class CThreadPoolTaskGroup {
+public:
+	CThreadPoolTaskGroup() : unfinishedCount( 0 ) {}
+	CThreadPoolTaskGroup( const CThreadPoolTaskGroup& ) = delete;
+	CThreadPoolTaskGroup& operator=( const CThreadPoolTaskGroup& ) = delete;
+
+	// Checks if all the tasks of the group are completed
+	bool IsFinished() const { return unfinishedCount.load( std::memory_order_acquire ) == 0; }
+
+private:
+	std::atomic<int> unfinishedCount;
+
+	friend class CThreadPool;
+};
+
 // The class provides thread pool functionality.
 class NEOMATHENGINE_API IThreadPool : public CCrtAllocatedObject {
 public:
@@ -33,12 +51,25 @@ public:
 	virtual int Size() const = 0;
 
 	// Adds a task with parameters for the given thread.
+	// Returns false if the pool is stopped; the task isn't executed then.
 	virtual bool AddTask( int threadIndex, TFunction function, void* params ) = 0;
 
+	// Adds a task to the group. The task may be executed by any thread of the pool
+	// (the idle threads steal the tasks from the busy ones).
+	// The function gets the index of the thread which actually executes it.
+	// May be called from inside a task: the new task is put to the current thread's queue.
+	// Must not be called after StopAndWait.
+	virtual void AddTask( CThreadPoolTaskGroup& group, TFunction function, void* params ) = 0;
+
+	// Waits for all tasks of the group to complete.
+	// When called from inside a task, the current thread executes other tasks while waiting.
+	virtual void WaitGroup( CThreadPoolTaskGroup& group ) = 0;
+
 	// Waits for all tasks to complete.
 	virtual void WaitAllTask() = 0;
 
 	// Stops all threads and waits for them to complete.
+	// The tasks added before the call are executed, so the waiters of their groups don't hang.
 	virtual void StopAndWait() = 0;
 };
 
@@ -95,4 +126,14 @@ inline bool GetTaskIndexAndCount( int threadCount, int threadIndex, int fullCoun
 	return GetTaskIndexAndCount(threadCount, threadIndex, fullCount, 1, index, count);
 }
 
+//------------------------------------------------------------------------------------------------------------
+
+// The function processing the [begin, end) range of ParallelFor
+typedef void(*TParallelForFunction)(int threadIndex, void* params, int begin, int end);
+
+// Processes the [0, count) range on the pool threads by chunks of grain elements
+// The chunks are handed out dynamically, so the uneven chunks don't stall the whole loop
+NEOMATHENGINE_API void ParallelFor( IThreadPool& threadPool, int count, int grain, void* params,
+	TParallelForFunction function );
+
 } // namespace NeoML
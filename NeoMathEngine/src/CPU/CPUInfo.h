@@ -26,6 +26,7 @@ limitations under the License.
 #endif // !FINE_ARCHITECTURE( FINE_ARM64 )
 
 #include <cstring>
+#include <cstdint>
 
 
 // The structure with CPU information
@@ -174,7 +175,18 @@ struct CCPUInfo {
 		// Check avx512_f bit in EBX ( any CPU with AVX512 has this bit )
 		bool AnyAvx512IsAvailable = regs.ebx & ( 1 << 16 );
 
-		return AnyAvx512IsAvailable;
+		// The OS must also keep opmask and zmm registers when switching contexts
+		return AnyAvx512IsAvailable && isAvx512StateEnabled();
+	}
+
+	// AVX-512 with the byte and word instructions (AVX512BW)
+	static bool IsAvx512BwAvailable()
+	{
+		Regs regs;
+		callCpuIdEx( regs, 7, 0 );
+
+		const unsigned int avx512BwBit = ( 1u << 30 );
+		return ( regs.ebx & avx512BwBit ) == avx512BwBit && IsAvx512Available();
 	}
 
 private:
@@ -206,6 +218,38 @@ private:
 #endif // !FINE_ARCHITECTURE( FINE_ARM64 )
 	}
 
+	static bool isAvx512StateEnabled() {
+		Regs regs;
+		callCpuId( regs, 1 );
+
+		// xgetbv may be used only if OSXSAVE is set
+		const unsigned int osxsaveBit = ( 1 << 27 );
+		if( ( regs.ecx & osxsaveBit ) != osxsaveBit ) {
+			return false;
+		}
+
+		// XCR0: SSE, AVX, opmask, ZMM_Hi256 and Hi16_ZMM states
+		const uint64_t Avx512StateMask = 0xe6;
+		return ( getXcr0() & Avx512StateMask ) == Avx512StateMask;
+	}
+
+	static uint64_t getXcr0() {
+#if !FINE_ARCHITECTURE( FINE_ARM64 ) && !FINE_ARCHITECTURE( FINE_ARM )
+#if FINE_PLATFORM( FINE_WINDOWS )
+		return _xgetbv( 0 );
+#elif FINE_PLATFORM( FINE_LINUX ) || FINE_PLATFORM( FINE_DARWIN )
+		uint32_t eax = 0;
+		uint32_t edx = 0;
+		__asm__ volatile( "xgetbv" : "=a"( eax ), "=d"( edx ) : "c"( 0 ) );
+		return ( static_cast<uint64_t>( edx ) << 32 ) | eax;
+#else
+		return 0;
+#endif
+#else
+		return 0;
+#endif // !FINE_ARCHITECTURE( FINE_ARM64 )
+	}
+
 	static void callCpuIdEx( Regs& outRegs, const RegType& eax, const RegType& ecx ) {
 		outRegs = { 0, 0, 0, 0 };
 #if !FINE_ARCHITECTURE( FINE_ARM64 ) && !FINE_ARCHITECTURE( FINE_ARM )
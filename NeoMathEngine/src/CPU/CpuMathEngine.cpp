@@ -50,17 +50,19 @@ static CCPUInfo::TCpuArch CPUArch = CCPUInfo::GetCpuArch();
 
 CCpuMathEngine::CCpuMathEngine( int _threadCount, size_t _memoryLimit,
 		std::shared_ptr<CMultiThreadDistributedCommunicator> communicator,
-		const CMathEngineDistributedInfo& distributedInfo ) :
+		const CMathEngineDistributedInfo& distributedInfo, TCpuMemoryAllocator allocator ) :
 	threadCount( _threadCount <= 0 ? OmpGetMaxThreadCount() : _threadCount ),
 	floatAlignment( FloatAlignment ),
 	memoryAlignment( floatAlignment * sizeof(float) ),
 	communicator( communicator ),
 	distributedInfo( distributedInfo ),
-	memoryPool( new CMemoryPool( _memoryLimit == 0 ? SIZE_MAX : _memoryLimit, this, distributedInfo.Threads > 1 ) ),
+	memoryPool( new CMemoryPool( _memoryLimit == 0 ? SIZE_MAX : _memoryLimit, this, distributedInfo.Threads > 1,
+		allocator == CMA_ThreadCache ) ),
 	stackAllocator( new CDeviceStackAllocator( *memoryPool, memoryAlignment ) ),
 	dllLoader( CDllLoader::AVX_DLL ),
 	simdMathEngine( nullptr ),
-	customSgemmFunction( nullptr )
+	customSgemmFunction( nullptr ),
+	customInt8MultiplyFunction( nullptr )
 {
 #ifdef NEOML_USE_AVX
 	if( dllLoader.IsLoaded( CDllLoader::AVX_DLL ) ) {
@@ -74,10 +76,12 @@ CCpuMathEngine::CCpuMathEngine( int _threadCount, size_t _memoryLimit,
 			// Non Intel architectures
 			customSgemmFunction = simdMathEngine->GetSgemmFunction();
 		}
+		customInt8MultiplyFunction = simdMathEngine->GetInt8MultiplyFunction();
 	}
 #else // NEOML_USE_AVX
 	// warning fix
 	(void)customSgemmFunction;
+	(void)customInt8MultiplyFunction;
 #endif
 #ifdef NEOML_USE_MKL
 	vmlSetMode( VML_ERRMODE_NOERR );
@@ -97,13 +101,19 @@ void CCpuMathEngine::SetReuseMemoryMode( bool enable )
 		return;
 	}
 
-	std::lock_guard<std::mutex> lock( mutex );
+	std::unique_lock<std::mutex> lock( mutex, std::defer_lock );
+	if( !memoryPool->IsThreadSafe() ) {
+		lock.lock();
+	}
 	memoryPool->SetReuseMemoryMode( enable );
 }
 
 CMemoryHandle CCpuMathEngine::HeapAlloc( size_t size )
 {
-	std::lock_guard<std::mutex> lock( mutex );
+	std::unique_lock<std::mutex> lock( mutex, std::defer_lock );
+	if( !memoryPool->IsThreadSafe() ) {
+		lock.lock();
+	}
 	CMemoryHandle result = memoryPool->Alloc( size );
 	if( result.IsNull() ) {
 		THROW_MEMORY_EXCEPTION;
@@ -115,7 +125,10 @@ void CCpuMathEngine::HeapFree( const CMemoryHandle& handle )
 {
 	ASSERT_EXPR( handle.GetMathEngine() == this );
 
-	std::lock_guard<std::mutex> lock( mutex );
+	std::unique_lock<std::mutex> lock( mutex, std::defer_lock );
+	if( !memoryPool->IsThreadSafe() ) {
+		lock.lock();
+	}
 	memoryPool->Free( handle );
 }
 
@@ -201,6 +214,12 @@ CMemoryHandle CCpuMathEngine::CopyFrom( const CMemoryHandle& handle, size_t size
 	return result;
 }
 
+CMemoryHandle CCpuMathEngine::WrapHostMemory( const void* data )
+{
+	ASSERT_EXPR( data != nullptr );
+	return CMemoryHandleInternal::CreateMemoryHandle( this, data );
+}
+
 CMemoryHandle CCpuMathEngine::Alloc( size_t size )
 {
 	// Ensure the correct alignment
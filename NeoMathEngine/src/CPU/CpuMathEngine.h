@@ -22,6 +22,7 @@ limitations under the License.
 #include <mutex>
 #include <memory>
 #include <CpuMathEngineDnnDistributed.h>
+#include <CpuMathEngineDnnConvAutotuner.h>
 
 namespace NeoML {
 
@@ -38,7 +39,8 @@ class CCpuMathEngine : public IMathEngine, public IRawMemoryManager {
 public:
 	CCpuMathEngine( int threadCount, size_t memoryLimit,
 		std::shared_ptr<CMultiThreadDistributedCommunicator> communicator = nullptr, 
-		const CMathEngineDistributedInfo& distributedInfo = CMathEngineDistributedInfo() );
+		const CMathEngineDistributedInfo& distributedInfo = CMathEngineDistributedInfo(),
+		TCpuMemoryAllocator allocator = CMA_Pool );
 	~CCpuMathEngine() override;
 
 	// IMathEngine interface methods
@@ -57,6 +59,10 @@ public:
 	void DataExchangeRaw( const CMemoryHandle& handle, const void* data, size_t size ) override;
 	void DataExchangeRaw( void* data, const CMemoryHandle& handle, size_t size ) override;
 	CMemoryHandle CopyFrom( const CMemoryHandle& handle, size_t size ) override;
+	CMemoryHandle WrapHostMemory( const void* data ) override;
+	void SetConvolutionAutotuningMode( bool enable ) override { convolutionAutotuner.Enable( enable ); }
+	bool LoadConvolutionAutotuningCache( const char* fileName ) override { return convolutionAutotuner.Load( fileName ); }
+	bool SaveConvolutionAutotuningCache( const char* fileName ) const override { return convolutionAutotuner.Save( fileName ); }
 	void GetMathEngineInfo( CMathEngineInfo& info ) const override;
 
 	// IVectorMathEngine interface methods
@@ -564,6 +570,10 @@ public:
 		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
 		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink, const CConstFloatHandle& input,
 		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) override;
+	void LstmRecurrentStep( CLstmDesc& desc, const CFloatHandle& inputFullyConnectedResult,
+		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
+		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink,
+		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) override;
 	void LinearInterpolation( const CConstFloatHandle& dataHandle, const CFloatHandle& resultHandle,
 		TInterpolationCoords coords, TInterpolationRound round, int objectCount, int scaledAxis,
 		int objectSize, float scale ) override;
@@ -578,6 +588,33 @@ public:
 		const CConstFloatHandle* channelwiseFreeTerm, const CConstFloatHandle& channelwiseReLUThreshold,
 		const CConstFloatHandle& downFilter, const CConstFloatHandle* downFreeTerm, bool residual,
 		const CFloatHandle& outputHandle ) override;
+	CQuantizedMatrixDesc* InitQuantizedMatrix( const CConstFloatHandle& matrix, int height, int width ) override;
+	CQuantizedMatrixDesc* InitQuantizedMatrix( const signed char* data, const float* scales, int height, int width ) override;
+	void GetQuantizedMatrixData( const CQuantizedMatrixDesc& matrix, signed char* data, float* scales ) override;
+	void MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle& first, int firstHeight, int firstWidth,
+		float firstScale, const CQuantizedMatrixDesc& second, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) override;
+	void BlobQuantizedConvolution( const CConvolutionDesc& desc, const CConstFloatHandle& source, float sourceScale,
+		const CQuantizedMatrixDesc& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) override;
+	void BlobConvolutionWithActivation( const CConvolutionDesc& desc, const CConstFloatHandle& source,
+		const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) override;
+	void MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle& first, int firstHeight,
+		int firstWidth, const CConstFloatHandle& second, int secondHeight, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) override;
+	void VectorAddWithActivation( const CConstFloatHandle& first, const CConstFloatHandle& second,
+		const CFloatHandle& result, int vectorSize, const CFusedActivation& activation ) override;
+	void ScaledDotProductAttention( int batchSize, int headCount, int headSize, int seqQ, int seqKV, float scale,
+		const CConstFloatHandle& q, const CConstFloatHandle& k, const CConstFloatHandle& v,
+		const CConstFloatHandle* mask, int maskObjectCount, bool isCausal, const CConstIntHandle* kvLengths,
+		const CFloatHandle& result ) override;
+	void LayerNormalization( int objectCount, int objectSize, const CConstFloatHandle& input, float epsilon,
+		const CConstFloatHandle& scale, const CConstFloatHandle& bias, const CFloatHandle& result,
+		const CFloatHandle* normalizedInput, const CFloatHandle* invSqrtVariance ) override;
+	void LayerNormalizationBackward( int objectCount, int objectSize, const CConstFloatHandle& normalizedInput,
+		const CConstFloatHandle& invSqrtVariance, const CConstFloatHandle& scale, const CConstFloatHandle& outputDiff,
+		const CFloatHandle& inputDiff ) override;
 
 	IPerformanceCounters* CreatePerformanceCounters() const override;
 	void AllReduce( const CFloatHandle& handle, int size ) override;
@@ -598,17 +635,20 @@ private:
 	CMathEngineDistributedInfo distributedInfo;
 	const std::unique_ptr<CMemoryPool> memoryPool; // the memory manager
 	const std::unique_ptr<CDeviceStackAllocator> stackAllocator; // the stack memory allocator
-	mutable std::mutex mutex; // to protect the allocations
+	mutable std::mutex mutex; // to protect the allocations (the heap allocations aren't protected if the memory pool is thread-safe)
 
 	CDllLoader dllLoader; // loading library for simd instructions
 	std::unique_ptr<ISimdMathEngine> simdMathEngine; // interface for using simd instructions
 	SgemmFunc customSgemmFunction; // Used when it is availabled and is faster then default sgemm
+	Int8MultiplyFunc customInt8MultiplyFunction; // The int8 micro-kernel with ymm or zmm registers
+	CConvolutionAutotuner convolutionAutotuner; // chooses the convolution algorithms
 
 	IMathEngine& mathEngine() { IMathEngine* engine = this; return *engine; }
 
 	void blob3dConvolution1x1x1( const CBlobDesc& source, const CBlobDesc& filter, const CBlobDesc& result,
 		int strideHeight, int strideWidth, int strideDepth,
-		const float* sourceData, const float* filterData, const float* freeTermData, float* resultData );
+		const float* sourceData, const float* filterData, const float* freeTermData,
+		const CFusedActivation& activation, float* resultData );
 	void blob3dConvolution1x1x1Backward( const CCommon3dConvolutionDesc& desc, const float* outputDiffData,
 		const float* filterData, const CConstFloatHandle* freeTermData, float* inputDiffData );
 	void blob3dConvolution1x1x1LearnAdd( const CCommon3dConvolutionDesc& desc, const CConstFloatHandle& inputData,
@@ -651,6 +691,9 @@ private:
 		int firstWidth, const CConstFloatHandle& secondHandle, int secondHeight, const CFloatHandle& resultHandle );
 	void multiplyMatrixByTransposedMatrixAndAdd( const float* first, int firstHeight, int firstWidth, int firstRowSize,
 		const float* second, int secondHeight, int secondRowSize, float* result, int resultRowSize );
+	void multiplyMatrixByTransposedQuantizedMatrix( const float* first, int firstHeight, int firstWidth, float firstScale,
+		const CQuantizedMatrixDesc& second, int secondStart, int secondCount, const float* freeTerm,
+		const CFusedActivation& activation, float* result, int resultRowSize );
 
 	template<class T>
 	void blobMergeByDimCommon( int dimNum, const CBlobDesc* from, const CTypedMemoryHandle<T>* fromData, int fromCount,
@@ -684,9 +727,15 @@ private:
 		int batch, int resultStart, int resultCount, float* result );
 	void fillTempData( const float* sourceData, float* filterData, const CCpuConvolutionDesc& desc, int start, int count );
 	void blobConvolutionForwardAlgo0( const CCpuConvolutionDesc& desc, const float* sourceData,
-		const float* filterData, const CConstFloatHandle* freeTermData, float* resultData );
+		const float* filterData, const CConstFloatHandle* freeTermData, const CFusedActivation& activation,
+		float* resultData );
 	void blobConvolutionForwardAlgo1( const CCpuConvolutionDesc& desc, const float* sourceData,
-		const float* filterData, const CConstFloatHandle* freeTermData, float* resultData );
+		const float* filterData, const CConstFloatHandle* freeTermData, const CFusedActivation& activation,
+		float* resultData );
+	void blobConvolutionWinograd( int objectCount, int sourceHeight, int sourceWidth, int sourceChannels,
+		int paddingHeight, int paddingWidth, int resultHeight, int resultWidth, int resultChannels,
+		const float* sourceData, const float* transformedFilter, const float* freeTermData,
+		const CFusedActivation& activation, float* resultData );
 	void backwardConvolutionAddFilterToOutput( const CCpuConvolutionDesc& desc, const CConstFloatHandle& temp,
 		const CConstFloatHandle* freeTerm, const CFloatHandle& output );
 	void backwardDilationConvolutionAddFilterToOutput( const CCpuConvolutionDesc& desc, const CConstFloatHandle& temp,
@@ -965,6 +965,55 @@ void CCpuMathEngine::MultiplyMatrixByTransposedMatrix(const CConstFloatHandle& f
 	}
 }
 
+void CCpuMathEngine::MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle& firstHandle, int firstHeight,
+	int firstWidth, const CConstFloatHandle& secondHandle, int secondHeight, const CConstFloatHandle* freeTermHandle,
+	const CFusedActivation& activation, const CFloatHandle& resultHandle )
+{
+	ASSERT_EXPR( firstHandle.GetMathEngine() == this );
+	ASSERT_EXPR( secondHandle.GetMathEngine() == this );
+	ASSERT_EXPR( freeTermHandle == nullptr || freeTermHandle->GetMathEngine() == this );
+	ASSERT_EXPR( resultHandle.GetMathEngine() == this );
+	ASSERT_EXPR( activation.Type == AF_Linear || activation.Type == AF_ReLU );
+	CCpuExecutionScope scope;
+
+	const float* first = GetRaw( firstHandle );
+	const float* second = GetRaw( secondHandle );
+	const float* freeTerm = freeTermHandle == nullptr ? nullptr : GetRaw( *freeTermHandle );
+	float* result = GetRaw( resultHandle );
+
+	const int curThreadCount = IsOmpRelevant( firstHeight * secondHeight, firstWidth * firstHeight * secondHeight )
+		? threadCount : 1;
+	NEOML_OMP_NUM_THREADS( curThreadCount )
+	{
+		int firstHeightStart;
+		int firstHeightCount;
+		int secondHeightStart;
+		int secondHeightCount;
+		if( OmpGetTaskIndexAndCount2D( firstHeight, 1, secondHeight, floatAlignment,
+			firstHeightStart, firstHeightCount, secondHeightStart, secondHeightCount ) )
+		{
+			const float* secondData = second + secondHeightStart * firstWidth;
+			// The rows are processed by blocks so that the free term and the activation are applied
+			// while the block of the result is still in cache
+			const int blockHeight = std::max( 1, 16 * 1024 / secondHeightCount );
+			for( int blockStart = firstHeightStart; blockStart < firstHeightStart + firstHeightCount; blockStart += blockHeight ) {
+				const int blockCount = std::min( blockHeight, firstHeightStart + firstHeightCount - blockStart );
+				float* resultData = result + blockStart * secondHeight + secondHeightStart;
+				multiplyMatrixByTransposedMatrix( first + blockStart * firstWidth, blockCount, firstWidth, firstWidth,
+					secondData, secondHeightCount, firstWidth, resultData, secondHeight );
+
+				for( int i = 0; i < blockCount; i++ ) {
+					float* resultRow = resultData + i * secondHeight;
+					if( freeTerm != nullptr ) {
+						vectorAdd( resultRow, freeTerm + secondHeightStart, resultRow, secondHeightCount );
+					}
+					applyActivation( activation, resultRow, secondHeightCount );
+				}
+			}
+		}
+	}
+}
+
 void CCpuMathEngine::MultiplyMatrixByTransposedMatrix( int batchSize, const CConstFloatHandle& firstHandle,
 	int firstHeight, int firstWidth, const CConstFloatHandle& secondHandle, int secondHeight,
 	const CFloatHandle& resultHandle, int resultBufferSize )
@@ -0,0 +1,157 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <CpuMathEngine.h>
+#include <CpuExecutionScope.h>
+#include <CpuMathEnginePrivate.h>
+#include <MemoryHandleInternal.h>
+#include <NeoMathEngine/NeoMathEngineException.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace NeoML {
+
+// The number of Q rows processed by one task
+static const int AttentionQueryTileSize = 32;
+// The number of K and V rows processed at once
+static const int AttentionKeyTileSize = 128;
+// The multiplier of the mask which is added to the scores
+static const float AttentionMaskMultiplier = -1e+9f;
+
+void CCpuMathEngine::ScaledDotProductAttention( int batchSize, int headCount, int headSize, int seqQ, int seqKV,
+	float scale, const CConstFloatHandle& qHandle, const CConstFloatHandle& kHandle, const CConstFloatHandle& vHandle,
+	const CConstFloatHandle* maskHandle, int maskObjectCount, bool isCausal, const CConstIntHandle* kvLengthsHandle,
+	const CFloatHandle& resultHandle )
+{
+	ASSERT_EXPR( qHandle.GetMathEngine() == this );
+	ASSERT_EXPR( kHandle.GetMathEngine() == this );
+	ASSERT_EXPR( vHandle.GetMathEngine() == this );
+	ASSERT_EXPR( resultHandle.GetMathEngine() == this );
+	ASSERT_EXPR( maskHandle == nullptr || maskHandle->GetMathEngine() == this );
+	ASSERT_EXPR( maskHandle == nullptr || maskObjectCount == 1 || maskObjectCount == batchSize * headCount );
+	ASSERT_EXPR( kvLengthsHandle == nullptr || kvLengthsHandle->GetMathEngine() == this );
+	ASSERT_EXPR( batchSize > 0 && headCount > 0 && headSize > 0 && seqQ > 0 && seqKV > 0 );
+	// Otherwise the first positions of Q don't attend to anything
+	ASSERT_EXPR( !isCausal || seqKV >= seqQ );
+	CCpuExecutionScope scope;
+
+	const float* q = GetRaw( qHandle );
+	const float* k = GetRaw( kHandle );
+	const float* v = GetRaw( vHandle );
+	const float* mask = maskHandle == nullptr ? nullptr : GetRaw( *maskHandle );
+	const int* kvLengths = kvLengthsHandle == nullptr ? nullptr : GetRaw( *kvLengthsHandle );
+	float* result = GetRaw( resultHandle );
+	if( kvLengths != nullptr ) {
+		for( int batch = 0; batch < batchSize; ++batch ) {
+			ASSERT_EXPR( kvLengths[batch] > 0 && kvLengths[batch] <= seqKV );
+		}
+	}
+
+	const int rowSize = headCount * headSize;
+	const int causalOffset = seqKV - seqQ;
+	const int queryTileCount = ( seqQ + AttentionQueryTileSize - 1 ) / AttentionQueryTileSize;
+	const int taskCount = batchSize * headCount * queryTileCount;
+	const int curThreadCount = IsOmpRelevant( taskCount,
+		static_cast<int64_t>( batchSize ) * headCount * seqQ * seqKV * headSize ) ? threadCount : 1;
+
+	// The buffers of each thread: the scores tile, the output accumulators, the running maximums and sums
+	const int scoresSize = AttentionQueryTileSize * AttentionKeyTileSize;
+	const int outputSize = AttentionQueryTileSize * headSize;
+	const int bufferSize = scoresSize + outputSize + 2 * AttentionQueryTileSize;
+	std::vector<float> buffers( static_cast<size_t>( curThreadCount ) * bufferSize );
+
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int task = 0; task < taskCount; ++task ) {
+		float* scores = buffers.data() + static_cast<size_t>( OmpGetThreadNum() ) * bufferSize;
+		float* output = scores + scoresSize;
+		float* maxValues = output + outputSize;
+		float* sums = maxValues + AttentionQueryTileSize;
+
+		const int head = task / queryTileCount;
+		const int batch = head / headCount;
+		const int headIndex = head % headCount;
+		const int queryStart = ( task % queryTileCount ) * AttentionQueryTileSize;
+		const int queryCount = std::min( AttentionQueryTileSize, seqQ - queryStart );
+
+		const float* query = q + ( static_cast<size_t>( batch ) * seqQ + queryStart ) * rowSize + headIndex * headSize;
+		const float* key = k + static_cast<size_t>( batch ) * seqKV * rowSize + headIndex * headSize;
+		const float* value = v + static_cast<size_t>( batch ) * seqKV * rowSize + headIndex * headSize;
+		const float* maskTile = mask == nullptr ? nullptr
+			: mask + ( static_cast<size_t>( maskObjectCount == 1 ? 0 : head ) * seqQ + queryStart ) * seqKV;
+		// The padded positions of K and V are never processed
+		const int kvLength = kvLengths == nullptr ? seqKV : kvLengths[batch];
+		const int keyEnd = isCausal ? std::min( kvLength, queryStart + queryCount + causalOffset ) : kvLength;
+
+		vectorFill( output, 0.f, queryCount * headSize );
+		vectorFill( maxValues, -FLT_MAX, queryCount );
+		vectorFill( sums, 0.f, queryCount );
+
+		for( int keyStart = 0; keyStart < keyEnd; keyStart += AttentionKeyTileSize ) {
+			const int keyCount = std::min( AttentionKeyTileSize, keyEnd - keyStart );
+			multiplyMatrixByTransposedMatrix( query, queryCount, headSize, rowSize,
+				key + static_cast<size_t>( keyStart ) * rowSize, keyCount, rowSize, scores, keyCount );
+
+			// The online softmax: the accumulated values are rescaled when the maximum changes
+			for( int i = 0; i < queryCount; ++i ) {
+				float* scoresRow = scores + i * keyCount;
+				const int validCount = isCausal
+					? std::max( 0, std::min( keyCount, queryStart + i + causalOffset + 1 - keyStart ) ) : keyCount;
+				const float* maskRow = maskTile == nullptr ? nullptr : maskTile + static_cast<size_t>( i ) * seqKV + keyStart;
+
+				float maxValue = maxValues[i];
+				for( int j = 0; j < validCount; ++j ) {
+					scoresRow[j] *= scale;
+					if( maskRow != nullptr ) {
+						scoresRow[j] += AttentionMaskMultiplier * maskRow[j];
+					}
+					maxValue = std::max( maxValue, scoresRow[j] );
+				}
+
+				float sum = 0;
+				for( int j = 0; j < validCount; ++j ) {
+					scoresRow[j] = expf( scoresRow[j] - maxValue );
+					sum += scoresRow[j];
+				}
+				for( int j = validCount; j < keyCount; ++j ) {
+					scoresRow[j] = 0;
+				}
+
+				if( maxValue != maxValues[i] ) {
+					const float correction = expf( maxValues[i] - maxValue );
+					vectorMultiply( output + i * headSize, output + i * headSize, correction, headSize );
+					sums[i] *= correction;
+					maxValues[i] = maxValue;
+				}
+				sums[i] += sum;
+			}
+
+			multiplyMatrixByMatrixAndAdd( scores, queryCount, keyCount, keyCount,
+				value + static_cast<size_t>( keyStart ) * rowSize, headSize, rowSize, output, headSize );
+		}
+
+		float* resultTile = result + ( static_cast<size_t>( batch ) * seqQ + queryStart ) * rowSize + headIndex * headSize;
+		for( int i = 0; i < queryCount; ++i ) {
+			vectorMultiply( output + i * headSize, resultTile + static_cast<size_t>( i ) * rowSize, 1.f / sums[i], headSize );
+		}
+	}
+}
+
+} // namespace NeoML
@@ -309,30 +309,33 @@ void CCpuMathEngine::BlobChannelwiseConvolution( const CChannelwiseConvolutionDe
 	const CConstFloatHandle& filterData, const CConstFloatHandle* freeTermData, const CFloatHandle& resultData )
 {
 	CCpuExecutionScope scope;
-	const CCommonChannelwiseConvolutionDesc& desc = static_cast<const CCommonChannelwiseConvolutionDesc&>( convDesc );
+	const CCpuChannelwiseConvolutionDesc& desc = static_cast<const CCpuChannelwiseConvolutionDesc&>( convDesc );
 
 	const float* source = GetRaw( sourceData );
 	const float* filter = GetRaw( filterData );
 	const float* freeTerm = freeTermData != 0 ? GetRaw( *freeTermData ) : 0;
 	float* result = GetRaw( resultData );
 
-	if( desc.Filter.Height() == 3 && desc.Filter.Width() == 3 && desc.PaddingHeight == 1 && desc.PaddingWidth == 1 && desc.Filter.Channels() % 4 == 0 ) {
-		if( desc.StrideHeight == 1 && desc.StrideWidth == 1 ) {
+	if( ( desc.ForwardImpl == CI_Default || desc.ForwardImpl == CI_Filter3x3 ) && desc.IsFilter3x3Available() ) {
+		if( desc.StrideHeight == 1 ) {
 			blobChannelwiseConvolutionFilter3x3Padding1Stride1( desc, source, filter, freeTerm, result );
-			return;
-		}
-		if( desc.StrideHeight == 2 && desc.StrideWidth == 2 ) {
+		} else {
 			blobChannelwiseConvolutionFilter3x3Padding1Stride2( desc, source, filter, freeTerm, result );
-			return;
 		}
+		return;
 	}
 
 	const CBlobDesc& sourceDesc = desc.Source;
 	const CBlobDesc& filterDesc = desc.Filter;
 	const CBlobDesc& resultDesc = desc.Result;
 
-	const int curThreadCount = IsOmpRelevant( sourceDesc.ObjectCount() * resultDesc.Height(),
-		static_cast<int64_t>( sourceDesc.BlobSize() ) * filterDesc.BlobSize() ) ? threadCount : 1;
+	int curThreadCount = threadCount;
+	if( desc.ForwardImpl == CI_SingleThread ) {
+		curThreadCount = 1;
+	} else if( desc.ForwardImpl == CI_Default ) {
+		curThreadCount = IsOmpRelevant( sourceDesc.ObjectCount() * resultDesc.Height(),
+			static_cast<int64_t>( sourceDesc.BlobSize() ) * filterDesc.BlobSize() ) ? threadCount : 1;
+	}
 
 	const int channels = sourceDesc.Channels() * sourceDesc.Depth();
 
@@ -35,15 +35,24 @@ enum TConvAlgo {
 	CA_2,		// work with the data directly (only for stride = 1 and padding = 0)
 				// most efficient when the image is large and especially when it has many channels
 				
-	CA_1x1		// for convolution with a 1*1 filter, no padding and dilation (both 2D and 3D)
+	CA_1x1,		// for convolution with a 1*1 filter, no padding and dilation (both 2D and 3D)
+	CA_Winograd	// Winograd F(2x2, 3x3) for 3*3 filter with stride 1 and no dilation
+				// uses 16 multiplications instead of 36 for each 2*2 output tile
 };
 
 const int BlobConvolutionCacheSize = 256 * 1024;
 
+// The minimum number of input and output channels when the Winograd algorithm is faster than the matrix multiplication
+const int WinogradMinChannels = 8;
+// The number of elements in the transformed 4*4 tile
+const int WinogradTileSize = 16;
+
 // Convolution descriptor
 struct CCpuConvolutionDesc : public CCommonConvolutionDesc {
 	TConvAlgo ForwardAlgo;
 	TConvAlgo BackwardAlgo;
+	TConvAlgo LearnAlgo;
+	TConvolutionImpl ForwardImpl; // the forward pass implementation chosen by the autotuner
 	std::unique_ptr<CConvolutionDesc> SimdConvolutionDesc;
 
 	CCpuConvolutionDesc( std::unique_ptr<CConvolutionDesc>& simdConvolutionDesc, const CBlobDesc& source, const CBlobDesc& result, const CBlobDesc& filter,
@@ -51,16 +60,23 @@ struct CCpuConvolutionDesc : public CCommonConvolutionDesc {
 		CCommonConvolutionDesc( source, result, filter, paddingHeight, paddingWidth, strideHeight, strideWidth, dilationHeight, dilationWidth ),
 		ForwardAlgo( getActualForwardAlgo() ),
 		BackwardAlgo( getActualBackwardAlgo() ),
+		LearnAlgo( getActualLearnAlgo() ),
+		ForwardImpl( CI_Default ),
 		SimdConvolutionDesc( std::move( simdConvolutionDesc ) )
 	{
 	}
 
 	TConvAlgo getActualForwardAlgo() const;
 	TConvAlgo getActualBackwardAlgo() const;
+	TConvAlgo getActualLearnAlgo() const;
+
+private:
+	TConvAlgo getMatrixAlgo() const;
+	bool isWinogradAvailable() const;
 };
 
-// Gets the algorithm to be used for this convolution
-inline TConvAlgo CCpuConvolutionDesc::getActualForwardAlgo() const
+// Gets the algorithm that uses the matrix multiplication on the data in its original form or reordered
+inline TConvAlgo CCpuConvolutionDesc::getMatrixAlgo() const
 {
 	if( PaddingHeight == 0 && PaddingWidth == 0
 		&& DilationHeight == 1 && DilationWidth == 1
@@ -87,9 +103,33 @@ inline TConvAlgo CCpuConvolutionDesc::getActualForwardAlgo() const
 	return CA_1;
 }
 
+// Checks if the Winograd algorithm may be used both for the forward and the backward pass
+// The backward pass is the convolution with the padding 2 - padding, so the padding may not be greater than 2
+inline bool CCpuConvolutionDesc::isWinogradAvailable() const
+{
+	return Filter.Height() == 3 && Filter.Width() == 3
+		&& StrideHeight == 1 && StrideWidth == 1
+		&& DilationHeight == 1 && DilationWidth == 1
+		&& PaddingHeight <= 2 && PaddingWidth <= 2
+		&& Result.Height() >= 2 && Result.Width() >= 2
+		&& Source.Depth() * Source.Channels() >= WinogradMinChannels
+		&& Filter.BatchWidth() >= WinogradMinChannels;
+}
+
+// Gets the algorithm to be used for this convolution
+inline TConvAlgo CCpuConvolutionDesc::getActualForwardAlgo() const
+{
+	return isWinogradAvailable() ? CA_Winograd : getMatrixAlgo();
+}
+
 inline TConvAlgo CCpuConvolutionDesc::getActualBackwardAlgo() const
 {
-	TConvAlgo ret = getActualForwardAlgo();
+	return isWinogradAvailable() ? CA_Winograd : getActualLearnAlgo();
+}
+
+inline TConvAlgo CCpuConvolutionDesc::getActualLearnAlgo() const
+{
+	TConvAlgo ret = getMatrixAlgo();
 	if( ret == CA_2 && ( PaddingHeight != 0 || PaddingWidth != 0 ) ) {
 		ret = CA_1;
 	}
@@ -139,6 +179,40 @@ CConvolutionDesc* CCpuMathEngine::InitBlobConvolution( const CBlobDesc& source,
 
 	CCpuConvolutionDesc* desc = new CCpuConvolutionDesc( simdConvolutionDesc, source, result, filter,
 		paddingHeight, paddingWidth, strideHeight, strideWidth, dilationHeight, dilationWidth );
+
+	TConvolutionImpl candidates[5];
+	int candidateCount = 0;
+	if( desc->SimdConvolutionDesc != nullptr ) {
+		candidates[candidateCount++] = CI_Simd;
+	}
+	candidates[candidateCount++] = CI_Algo0;
+	candidates[candidateCount++] = CI_Algo1;
+	if( desc->ForwardAlgo == CA_Winograd ) {
+		candidates[candidateCount++] = CI_Winograd;
+	} else if( desc->ForwardAlgo == CA_1x1 ) {
+		candidates[candidateCount++] = CI_1x1;
+	}
+
+	std::string key = "conv";
+	CConvolutionAutotuner::AddToKey( key, source );
+	CConvolutionAutotuner::AddToKey( key, filter );
+	CConvolutionAutotuner::AddToKey( key, paddingHeight );
+	CConvolutionAutotuner::AddToKey( key, paddingWidth );
+	CConvolutionAutotuner::AddToKey( key, strideHeight );
+	CConvolutionAutotuner::AddToKey( key, strideWidth );
+	CConvolutionAutotuner::AddToKey( key, dilationHeight );
+	CConvolutionAutotuner::AddToKey( key, dilationWidth );
+	CConvolutionAutotuner::AddToKey( key, threadCount );
+
+	std::unique_ptr<CConvolutionAutotuningData> data;
+	desc->ForwardImpl = convolutionAutotuner.Choose( key, candidates, candidateCount, [&]( TConvolutionImpl impl ) {
+		if( data == nullptr ) {
+			data.reset( new CConvolutionAutotuningData( mathEngine(), source, filter, filter.ObjectCount(), result ) );
+		}
+		const CConstFloatHandle freeTerm = data->FreeTerm.GetHandle();
+		desc->ForwardImpl = impl;
+		BlobConvolution( *desc, data->Source.GetHandle(), data->Filter.GetHandle(), &freeTerm, data->Result.GetHandle() );
+	} );
 	return desc;
 }
 
@@ -392,7 +466,7 @@ inline int ceilTo( int val, int discret )
 }
 
 void CCpuMathEngine::blobConvolutionForwardAlgo0( const CCpuConvolutionDesc& desc, const float* sourceData,
-	const float* filterData, const CConstFloatHandle* freeTermData, float* resultData )
+	const float* filterData, const CConstFloatHandle* freeTermData, const CFusedActivation& activation, float* resultData )
 {
 	const int resultItemCount = desc.Result.ObjectCount() * desc.Result.Width() * desc.Result.Height();
 	const int curThreadCount = IsOmpRelevant( resultItemCount, static_cast< int64_t >( desc.Result.BlobSize() ) * desc.Filter.ObjectSize() ) ? threadCount : 1;
@@ -427,6 +501,7 @@ void CCpuMathEngine::blobConvolutionForwardAlgo0( const CCpuConvolutionDesc& des
 					addVectorToMatrixRows( resultDataPtr, resultDataPtr, size, filterObjectCount, filterObjectCount, 
 						filterObjectCount, GetRaw( *freeTermData ) );
 				}
+				applyActivation( activation, resultDataPtr, size * filterObjectCount );
 
 				index += size;
 			}
@@ -435,7 +510,7 @@ void CCpuMathEngine::blobConvolutionForwardAlgo0( const CCpuConvolutionDesc& des
 }
 
 void CCpuMathEngine::blobConvolutionForwardAlgo1( const CCpuConvolutionDesc& desc, const float* sourceData,
-	const float* filterData, const CConstFloatHandle* freeTermData, float* resultData )
+	const float* filterData, const CConstFloatHandle* freeTermData, const CFusedActivation& activation, float* resultData )
 {
 	const float* freeTermDataRaw = freeTermData == nullptr ? nullptr : GetRaw( *freeTermData );
 
@@ -497,6 +572,7 @@ void CCpuMathEngine::blobConvolutionForwardAlgo1( const CCpuConvolutionDesc& des
 						filter.ObjectSize(), filterData, filter.BatchWidth(), filter.ObjectSize(), outputTransposedPtr,
 						filter.BatchWidth() );
 				}
+				applyActivation( activation, outputTransposedPtr, result.Height() * resultCount * outputChannels );
 
 				// Transpose the result
 				transposeResult( desc, outputTransposedPtr, batch, resultStart, resultCount, resultData );
@@ -505,21 +581,188 @@ void CCpuMathEngine::blobConvolutionForwardAlgo1( const CCpuConvolutionDesc& des
 	}
 }
 
-void CCpuMathEngine::BlobConvolution( const CConvolutionDesc& convDesc, const CConstFloatHandle& source,
-	const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFloatHandle& result )
+// Transforms the 3*3 filter for the Winograd algorithm: U = G * g * G^T
+// The result contains WinogradTileSize matrices of outputChannels * inputChannels
+// For the backward pass the filter is rotated by 180 degrees and its input and output channels are swapped
+static void transformWinogradFilter( const float* filter, int filterCount, int channels, bool isBackward, float* result )
 {
-	CCpuExecutionScope scope;
+	const int resultMatrixSize = filterCount * channels;
+	for( int f = 0; f < filterCount; f++ ) {
+		for( int c = 0; c < channels; c++ ) {
+			float g[3][3];
+			for( int i = 0; i < 3; i++ ) {
+				for( int j = 0; j < 3; j++ ) {
+					g[i][j] = isBackward ? filter[( f * 9 + ( 2 - i ) * 3 + ( 2 - j ) ) * channels + c]
+						: filter[( f * 9 + i * 3 + j ) * channels + c];
+				}
+			}
+			// temp = G * g
+			float temp[4][3];
+			for( int j = 0; j < 3; j++ ) {
+				temp[0][j] = g[0][j];
+				temp[1][j] = 0.5f * ( g[0][j] + g[1][j] + g[2][j] );
+				temp[2][j] = 0.5f * ( g[0][j] - g[1][j] + g[2][j] );
+				temp[3][j] = g[2][j];
+			}
+			// U = temp * G^T
+			const int resultIndex = isBackward ? c * filterCount + f : f * channels + c;
+			for( int i = 0; i < 4; i++ ) {
+				float* u = result + i * 4 * resultMatrixSize + resultIndex;
+				u[0] = temp[i][0];
+				u[resultMatrixSize] = 0.5f * ( temp[i][0] + temp[i][1] + temp[i][2] );
+				u[2 * resultMatrixSize] = 0.5f * ( temp[i][0] - temp[i][1] + temp[i][2] );
+				u[3 * resultMatrixSize] = temp[i][2];
+			}
+		}
+	}
+}
 
-	const float* sourceRaw = GetRaw( source );
-	const float* filterRaw = GetRaw( filter );
-	const float* freeTermRaw = freeTerm != nullptr ? GetRaw( *freeTerm ) : nullptr;
-	float* resultRaw = GetRaw( result );
+// Calculates the 3*3 convolution with stride 1 using the Winograd F(2x2, 3x3) algorithm
+// The output is split into 2*2 tiles; each tile is calculated from the 4*4 input tile
+// After the input tiles are transformed, the convolution is reduced to WinogradTileSize matrix multiplications
+void CCpuMathEngine::blobConvolutionWinograd( int objectCount, int sourceHeight, int sourceWidth, int sourceChannels,
+	int paddingHeight, int paddingWidth, int resultHeight, int resultWidth, int resultChannels,
+	const float* sourceData, const float* transformedFilter, const float* freeTermData,
+	const CFusedActivation& activation, float* resultData )
+{
+	const int tileRows = ( resultHeight + 1 ) / 2;
+	const int tileColumns = ( resultWidth + 1 ) / 2;
+	const int tileCount = objectCount * tileRows * tileColumns;
 
-	const CCpuConvolutionDesc& desc = static_cast<const CCpuConvolutionDesc&>( convDesc );
+	const int curThreadCount = IsOmpRelevant( tileCount,
+		static_cast<int64_t>( tileCount ) * WinogradTileSize * sourceChannels * resultChannels ) ? threadCount : 1;
+	const int blockSize = std::max( 1, std::min( ( tileCount + curThreadCount - 1 ) / curThreadCount,
+		BlobConvolutionCacheSize / ( WinogradTileSize * ( sourceChannels + resultChannels ) ) ) );
+	const int threadBufferSize = WinogradTileSize * ( blockSize * ( sourceChannels + resultChannels ) + sourceChannels );
+
+	CFloatHandleStackVar buffer( mathEngine(), curThreadCount * threadBufferSize );
+	float* bufferRaw = GetRaw( buffer.GetHandle() );
+
+	NEOML_OMP_NUM_THREADS( curThreadCount )
+	{
+		float* transformedSource = bufferRaw + OmpGetThreadNum() * threadBufferSize;
+		float* transformedResult = transformedSource + WinogradTileSize * blockSize * sourceChannels;
+		float* tile = transformedResult + WinogradTileSize * blockSize * resultChannels;
+
+		int start;
+		int count;
+		if( OmpGetTaskIndexAndCount( tileCount, start, count ) ) {
+			for( int blockStart = start; blockStart < start + count; blockStart += blockSize ) {
+				const int size = std::min( blockSize, start + count - blockStart );
+				// The stride between the transformed elements of one tile
+				const int sourceStride = size * sourceChannels;
+				const int resultStride = size * resultChannels;
+
+				// Transform the input tiles: V = B^T * d * B
+				for( int t = 0; t < size; t++ ) {
+					const int tileIndex = blockStart + t;
+					const int object = tileIndex / ( tileRows * tileColumns );
+					const int row = 2 * ( tileIndex / tileColumns % tileRows ) - paddingHeight;
+					const int column = 2 * ( tileIndex % tileColumns ) - paddingWidth;
+					for( int i = 0; i < 4; i++ ) {
+						for( int j = 0; j < 4; j++ ) {
+							float* tilePtr = tile + ( i * 4 + j ) * sourceChannels;
+							if( row + i < 0 || row + i >= sourceHeight || column + j < 0 || column + j >= sourceWidth ) {
+								vectorFill( tilePtr, 0, sourceChannels );
+							} else {
+								dataCopy( tilePtr, sourceData
+									+ ( ( object * sourceHeight + row + i ) * sourceWidth + column + j ) * sourceChannels,
+									sourceChannels );
+							}
+						}
+					}
+
+					float* v = transformedSource + t * sourceChannels;
+					for( int i = 0; i < 4; i++ ) {
+						const float* d0 = tile + ( 0 * 4 + i ) * sourceChannels;
+						const float* d1 = tile + ( 1 * 4 + i ) * sourceChannels;
+						const float* d2 = tile + ( 2 * 4 + i ) * sourceChannels;
+						const float* d3 = tile + ( 3 * 4 + i ) * sourceChannels;
+						// The i-th column of B^T * d is stored in place of the i-th column of the tile
+						float* c0 = tile + ( 0 * 4 + i ) * sourceChannels;
+						float* c1 = tile + ( 1 * 4 + i ) * sourceChannels;
+						float* c2 = tile + ( 2 * 4 + i ) * sourceChannels;
+						float* c3 = tile + ( 3 * 4 + i ) * sourceChannels;
+						for( int c = 0; c < sourceChannels; c++ ) {
+							const float x0 = d0[c] - d2[c];
+							const float x1 = d1[c] + d2[c];
+							const float x2 = d2[c] - d1[c];
+							const float x3 = d1[c] - d3[c];
+							c0[c] = x0;
+							c1[c] = x1;
+							c2[c] = x2;
+							c3[c] = x3;
+						}
+					}
+					for( int i = 0; i < 4; i++ ) {
+						const float* d0 = tile + ( i * 4 + 0 ) * sourceChannels;
+						const float* d1 = tile + ( i * 4 + 1 ) * sourceChannels;
+						const float* d2 = tile + ( i * 4 + 2 ) * sourceChannels;
+						const float* d3 = tile + ( i * 4 + 3 ) * sourceChannels;
+						float* v0 = v + ( i * 4 + 0 ) * sourceStride;
+						float* v1 = v + ( i * 4 + 1 ) * sourceStride;
+						float* v2 = v + ( i * 4 + 2 ) * sourceStride;
+						float* v3 = v + ( i * 4 + 3 ) * sourceStride;
+						for( int c = 0; c < sourceChannels; c++ ) {
+							v0[c] = d0[c] - d2[c];
+							v1[c] = d1[c] + d2[c];
+							v2[c] = d2[c] - d1[c];
+							v3[c] = d1[c] - d3[c];
+						}
+					}
+				}
+
+				// Multiply the transformed tiles by the transformed filter
+				for( int i = 0; i < WinogradTileSize; i++ ) {
+					multiplyMatrixByTransposedMatrix( transformedSource + i * sourceStride, size, sourceChannels,
+						sourceChannels, transformedFilter + i * resultChannels * sourceChannels, resultChannels,
+						sourceChannels, transformedResult + i * resultStride, resultChannels );
+				}
 
+				// Transform the results back: Y = A^T * m * A
+				for( int t = 0; t < size; t++ ) {
+					const int tileIndex = blockStart + t;
+					const int object = tileIndex / ( tileRows * tileColumns );
+					const int row = 2 * ( tileIndex / tileColumns % tileRows );
+					const int column = 2 * ( tileIndex % tileColumns );
+					const float* m = transformedResult + t * resultChannels;
+					float* result00 = resultData + ( ( object * resultHeight + row ) * resultWidth + column ) * resultChannels;
+					const bool hasSecondRow = row + 1 < resultHeight;
+					const bool hasSecondColumn = column + 1 < resultWidth;
+					for( int c = 0; c < resultChannels; c++ ) {
+						float s[2][4];
+						for( int j = 0; j < 4; j++ ) {
+							const float m0 = m[j * resultStride + c];
+							const float m1 = m[( 4 + j ) * resultStride + c];
+							const float m2 = m[( 8 + j ) * resultStride + c];
+							const float m3 = m[( 12 + j ) * resultStride + c];
+							s[0][j] = m0 + m1 + m2;
+							s[1][j] = m1 - m2 - m3;
+						}
+						const float freeTerm = freeTermData == nullptr ? 0.f : freeTermData[c];
+						result00[c] = applyActivation( activation, s[0][0] + s[0][1] + s[0][2] + freeTerm );
+						if( hasSecondColumn ) {
+							result00[resultChannels + c] = applyActivation( activation, s[0][1] - s[0][2] - s[0][3] + freeTerm );
+						}
+						if( hasSecondRow ) {
+							float* result10 = result00 + resultWidth * resultChannels;
+							result10[c] = applyActivation( activation, s[1][0] + s[1][1] + s[1][2] + freeTerm );
+							if( hasSecondColumn ) {
+								result10[resultChannels + c] = applyActivation( activation, s[1][1] - s[1][2] - s[1][3] + freeTerm );
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// Chooses the forward pass implementation using the heuristics
+static TConvolutionImpl getDefaultForwardImpl( const CCpuConvolutionDesc& desc, int threadCount )
+{
 	if( desc.SimdConvolutionDesc != nullptr ) {
-		simdMathEngine->BlobConvolution( *desc.SimdConvolutionDesc, sourceRaw, filterRaw, freeTermRaw, resultRaw );
-		return;
+		return CI_Simd;
 	}
 
 	switch( desc.ForwardAlgo ) {
@@ -534,25 +777,122 @@ void CCpuMathEngine::BlobConvolution( const CConvolutionDesc& convDesc, const CC
 			const int64_t algo1DataSize = static_cast<int64_t>( desc.Result.Width() ) * desc.Result.Height() * desc.Filter.ObjectSize() + desc.Result.ObjectSize();
 
 			if( std::min( desc.Result.ObjectCount(), algo1ThreadCount ) * algo1DataSize <= algo0ThreadCount * BlobConvolutionCacheSize ) {
-				blobConvolutionForwardAlgo1( desc, sourceRaw, filterRaw, freeTerm, resultRaw );
-			} else {
-				blobConvolutionForwardAlgo0( desc, sourceRaw, filterRaw, freeTerm, resultRaw );
+				return CI_Algo1;
 			}
-			break;
+			return CI_Algo0;
 		}
+		case CA_Winograd:
+			return CI_Winograd;
 		case CA_1x1:
-			{
-				bool needsFlatten = desc.Source.Depth() != 1;
+			return CI_1x1;
+		default:
+			ASSERT_EXPR( false );
+	}
+	return CI_Default;
+}
 
-				blob3dConvolution1x1x1( needsFlatten ? flatten( desc.Source ) : desc.Source, needsFlatten ? flatten( desc.Filter ) : desc.Filter,
-					desc.Result, desc.StrideHeight, desc.StrideWidth, 1, sourceRaw, filterRaw, freeTermRaw, resultRaw );
-				break;
-			}
+void CCpuMathEngine::BlobConvolution( const CConvolutionDesc& convDesc, const CConstFloatHandle& source,
+	const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFloatHandle& result )
+{
+	BlobConvolutionWithActivation( convDesc, source, filter, freeTerm, CFusedActivation(), result );
+}
+
+void CCpuMathEngine::BlobConvolutionWithActivation( const CConvolutionDesc& convDesc, const CConstFloatHandle& source,
+	const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+	const CFloatHandle& result )
+{
+	ASSERT_EXPR( activation.Type == AF_Linear || activation.Type == AF_ReLU );
+	CCpuExecutionScope scope;
+
+	const float* sourceRaw = GetRaw( source );
+	const float* filterRaw = GetRaw( filter );
+	const float* freeTermRaw = freeTerm != nullptr ? GetRaw( *freeTerm ) : nullptr;
+	float* resultRaw = GetRaw( result );
+
+	const CCpuConvolutionDesc& desc = static_cast<const CCpuConvolutionDesc&>( convDesc );
+
+	const TConvolutionImpl impl = desc.ForwardImpl != CI_Default ? desc.ForwardImpl : getDefaultForwardImpl( desc, threadCount );
+	switch( impl ) {
+		case CI_Simd:
+			simdMathEngine->BlobConvolution( *desc.SimdConvolutionDesc, sourceRaw, filterRaw, freeTermRaw, activation,
+				resultRaw );
+			break;
+		case CI_Algo0:
+			blobConvolutionForwardAlgo0( desc, sourceRaw, filterRaw, freeTerm, activation, resultRaw );
+			break;
+		case CI_Algo1:
+			blobConvolutionForwardAlgo1( desc, sourceRaw, filterRaw, freeTerm, activation, resultRaw );
+			break;
+		case CI_Winograd:
+		{
+			const int channels = desc.Source.Depth() * desc.Source.Channels();
+			// The filter is transformed on every call: it may be changed between the calls
+			CFloatHandleStackVar transformed( mathEngine(), WinogradTileSize * desc.Filter.BatchWidth() * channels );
+			transformWinogradFilter( filterRaw, desc.Filter.BatchWidth(), channels, false, GetRaw( transformed.GetHandle() ) );
+			blobConvolutionWinograd( desc.Source.ObjectCount(), desc.Source.Height(), desc.Source.Width(), channels,
+				desc.PaddingHeight, desc.PaddingWidth, desc.Result.Height(), desc.Result.Width(), desc.Result.Channels(),
+				sourceRaw, GetRaw( transformed.GetHandle() ), freeTermRaw, activation, resultRaw );
+			break;
+		}
+		case CI_1x1:
+		{
+			bool needsFlatten = desc.Source.Depth() != 1;
+
+			blob3dConvolution1x1x1( needsFlatten ? flatten( desc.Source ) : desc.Source, needsFlatten ? flatten( desc.Filter ) : desc.Filter,
+				desc.Result, desc.StrideHeight, desc.StrideWidth, 1, sourceRaw, filterRaw, freeTermRaw, activation, resultRaw );
+			break;
+		}
 		default:
 			ASSERT_EXPR( false );
 	}
 }
 
+void CCpuMathEngine::BlobQuantizedConvolution( const CConvolutionDesc& convDesc, const CConstFloatHandle& source,
+	float sourceScale, const CQuantizedMatrixDesc& filter, const CConstFloatHandle* freeTerm,
+	const CFusedActivation& activation, const CFloatHandle& result )
+{
+	ASSERT_EXPR( source.GetMathEngine() == this );
+	ASSERT_EXPR( result.GetMathEngine() == this );
+	ASSERT_EXPR( activation.Type == AF_Linear || activation.Type == AF_ReLU );
+	CCpuExecutionScope scope;
+
+	const CCpuConvolutionDesc& desc = static_cast<const CCpuConvolutionDesc&>( convDesc );
+	const float* sourceRaw = GetRaw( source );
+	const float* freeTermRaw = freeTerm != nullptr ? GetRaw( *freeTerm ) : nullptr;
+	float* resultRaw = GetRaw( result );
+
+	// The same blocking as in blobConvolutionForwardAlgo0, the unrolled rows are quantized during multiplication
+	const int resultItemCount = desc.Result.ObjectCount() * desc.Result.Width() * desc.Result.Height();
+	const int filterObjectCount = desc.Filter.ObjectCount();
+	const int filterObjectSize = desc.Filter.ObjectSize();
+	const int curThreadCount = IsOmpRelevant( resultItemCount, static_cast<int64_t>( desc.Result.BlobSize() ) * filterObjectSize ) ? threadCount : 1;
+	const int cacheItemCount = std::max( 1, std::min( ceilTo( BlobConvolutionCacheSize / filterObjectSize, 16 ), resultItemCount / curThreadCount ) );
+
+	CFloatHandleStackVar tempData( mathEngine(), curThreadCount * cacheItemCount * filterObjectSize );
+	float* tempDataRaw = GetRaw( tempData.GetHandle() );
+
+	NEOML_OMP_NUM_THREADS( curThreadCount )
+	{
+		float* tempDataPtr = tempDataRaw + OmpGetThreadNum() * cacheItemCount * filterObjectSize;
+
+		int start;
+		int count;
+		if( OmpGetTaskIndexAndCount( resultItemCount, start, count ) ) {
+			int index = 0;
+			while( index < count ) {
+				const int size = std::min( count - index, cacheItemCount );
+
+				fillTempData( sourceRaw, tempDataPtr, desc, start + index, size );
+				multiplyMatrixByTransposedQuantizedMatrix( tempDataPtr, size, filterObjectSize, sourceScale, filter,
+					0, filterObjectCount, freeTermRaw, activation, resultRaw + ( start + index ) * filterObjectCount,
+					filterObjectCount );
+
+				index += size;
+			}
+		}
+	}
+}
+
 void CCpuMathEngine::backwardConvolutionAddFilterToOutput( const CCpuConvolutionDesc& desc, const CConstFloatHandle& temp,
 	const CConstFloatHandle* freeTermData, const CFloatHandle& outputData )
 {
@@ -883,6 +1223,19 @@ void CCpuMathEngine::BlobConvolutionBackward( const CConvolutionDesc& convDesc,
 		case CA_2:
 			blobConvolutionBackwardAlgo2( desc, outputDiffData, filter, freeTerm, inputDiffData );
 			break;
+		case CA_Winograd:
+		{
+			// The backward pass is the convolution of the output diff with the rotated filter
+			const int channels = desc.Source.Depth() * desc.Source.Channels();
+			CFloatHandleStackVar transformed( mathEngine(), WinogradTileSize * desc.Filter.BatchWidth() * channels );
+			transformWinogradFilter( GetRaw( filter ), desc.Filter.BatchWidth(), channels, true,
+				GetRaw( transformed.GetHandle() ) );
+			blobConvolutionWinograd( desc.Result.ObjectCount(), desc.Result.Height(), desc.Result.Width(),
+				desc.Result.Channels(), 2 - desc.PaddingHeight, 2 - desc.PaddingWidth, desc.Source.Height(),
+				desc.Source.Width(), channels, GetRaw( outputDiffData ), GetRaw( transformed.GetHandle() ),
+				freeTerm == nullptr ? nullptr : GetRaw( *freeTerm ), CFusedActivation(), GetRaw( inputDiffData ) );
+			break;
+		}
 		case CA_1x1:
 			{
 				bool needsFlatten = desc.Filter.Depth() != 1;
@@ -1085,7 +1438,7 @@ void CCpuMathEngine::BlobConvolutionLearnAdd( const CConvolutionDesc& convDesc,
 	CCpuExecutionScope scope;
 	const CCpuConvolutionDesc& desc = static_cast<const CCpuConvolutionDesc&>( convDesc );
 
-	switch( desc.BackwardAlgo ) {
+	switch( desc.LearnAlgo ) {
 		case CA_1:
 			blobConvolutionLearnAlgo1( desc, input, outputDiff, filterDiff, freeTermDiff, isFreeTermDiffFromInput );
 			break;
@@ -1130,8 +1483,39 @@ CChannelwiseConvolutionDesc* CCpuMathEngine::InitBlobChannelwiseConvolution( con
 	ASSERT_EXPR(result.Height() == expectedOutputHeight);
 	ASSERT_EXPR(result.Width() == expectedOutputWidth);
 
-	CCommonChannelwiseConvolutionDesc* desc = new CCommonChannelwiseConvolutionDesc( paddingHeight, paddingWidth,
+	CCpuChannelwiseConvolutionDesc* desc = new CCpuChannelwiseConvolutionDesc( paddingHeight, paddingWidth,
 		strideHeight, strideWidth, source, filter, result );
+
+	TConvolutionImpl candidates[3];
+	int candidateCount = 0;
+	if( desc->IsFilter3x3Available() ) {
+		candidates[candidateCount++] = CI_Filter3x3;
+	}
+	candidates[candidateCount++] = CI_MultiThread;
+	if( threadCount > 1 ) {
+		candidates[candidateCount++] = CI_SingleThread;
+	}
+
+	std::string key = "channelwise";
+	CConvolutionAutotuner::AddToKey( key, source );
+	CConvolutionAutotuner::AddToKey( key, filter );
+	CConvolutionAutotuner::AddToKey( key, paddingHeight );
+	CConvolutionAutotuner::AddToKey( key, paddingWidth );
+	CConvolutionAutotuner::AddToKey( key, strideHeight );
+	CConvolutionAutotuner::AddToKey( key, strideWidth );
+	CConvolutionAutotuner::AddToKey( key, freeTerm != nullptr ? 1 : 0 );
+	CConvolutionAutotuner::AddToKey( key, threadCount );
+
+	std::unique_ptr<CConvolutionAutotuningData> data;
+	desc->ForwardImpl = convolutionAutotuner.Choose( key, candidates, candidateCount, [&]( TConvolutionImpl impl ) {
+		if( data == nullptr ) {
+			data.reset( new CConvolutionAutotuningData( mathEngine(), source, filter, filter.Channels(), result ) );
+		}
+		const CConstFloatHandle freeTermData = data->FreeTerm.GetHandle();
+		desc->ForwardImpl = impl;
+		BlobChannelwiseConvolution( *desc, data->Source.GetHandle(), data->Filter.GetHandle(),
+			freeTerm != nullptr ? &freeTermData : nullptr, data->Result.GetHandle() );
+	} );
 	return desc;
 }
 
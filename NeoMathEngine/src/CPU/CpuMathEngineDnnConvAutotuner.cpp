@@ -0,0 +1,136 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <CpuMathEngineDnnConvAutotuner.h>
+#include <cstdio>
+#include <cstring>
+
+namespace NeoML {
+
+// The first line of the cache file
+static const char* const AutotunerFileHeader = "NeoMathEngineConvolutionAutotuner 1";
+// The maximum length of a line in the cache file
+static const int AutotunerMaxLineLength = 1024;
+
+CConvolutionAutotuningData::CConvolutionAutotuningData( IMathEngine& mathEngine, const CBlobDesc& source,
+		const CBlobDesc& filter, int freeTermSize, const CBlobDesc& result ) :
+	Source( mathEngine, source.BlobSize() ),
+	Filter( mathEngine, filter.BlobSize() ),
+	FreeTerm( mathEngine, freeTermSize ),
+	Result( mathEngine, result.BlobSize() )
+{
+	// Any values not leading to denormals are fine
+	mathEngine.VectorFill( Source.GetHandle(), 0.5f, source.BlobSize() );
+	mathEngine.VectorFill( Filter.GetHandle(), 0.25f, filter.BlobSize() );
+	mathEngine.VectorFill( FreeTerm.GetHandle(), 1.f, freeTermSize );
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+bool CConvolutionAutotuner::Load( const char* fileName )
+{
+	FILE* file = ::fopen( fileName, "r" );
+	if( file == nullptr ) {
+		return false;
+	}
+
+	// The file is parsed completely before the choices are changed
+	std::map<std::string, int> loaded;
+	bool isValid = false;
+	char line[AutotunerMaxLineLength];
+	if( ::fgets( line, AutotunerMaxLineLength, file ) != nullptr
+		&& std::string( line ).compare( 0, std::strlen( AutotunerFileHeader ), AutotunerFileHeader ) == 0 )
+	{
+		isValid = true;
+		char key[AutotunerMaxLineLength];
+		int impl = 0;
+		while( ::fgets( line, AutotunerMaxLineLength, file ) != nullptr ) {
+			if( ::sscanf( line, "%1023s %d", key, &impl ) != 2 || impl <= CI_Default || impl > CI_SingleThread ) {
+				isValid = false;
+				break;
+			}
+			loaded[key] = impl;
+		}
+	}
+	::fclose( file );
+	if( !isValid ) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock( mutex );
+	for( const auto& choice : loaded ) {
+		choices[choice.first] = choice.second;
+	}
+	return true;
+}
+
+bool CConvolutionAutotuner::Save( const char* fileName ) const
+{
+	FILE* file = ::fopen( fileName, "w" );
+	if( file == nullptr ) {
+		return false;
+	}
+
+	bool isSaved = ::fprintf( file, "%s\n", AutotunerFileHeader ) > 0;
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		for( const auto& choice : choices ) {
+			isSaved = isSaved && ::fprintf( file, "%s %d\n", choice.first.c_str(), choice.second ) > 0;
+		}
+	}
+	return ::fclose( file ) == 0 && isSaved;
+}
+
+void CConvolutionAutotuner::AddToKey( std::string& key, const CBlobDesc& desc )
+{
+	for( int dim = 0; dim < BD_Count; dim++ ) {
+		AddToKey( key, desc.DimSize( dim ) );
+	}
+}
+
+void CConvolutionAutotuner::AddToKey( std::string& key, int value )
+{
+	key += '_';
+	key += std::to_string( value );
+}
+
+// Looks for the cached choice; the choice is ignored if it's not available on this host (e.g. the JIT convolution)
+bool CConvolutionAutotuner::lookup( const std::string& key, const TConvolutionImpl* candidates, int candidateCount,
+	TConvolutionImpl& impl ) const
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	const auto choice = choices.find( key );
+	if( choice == choices.end() ) {
+		return false;
+	}
+	for( int i = 0; i < candidateCount; i++ ) {
+		if( candidates[i] == choice->second ) {
+			impl = candidates[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+void CConvolutionAutotuner::add( const std::string& key, TConvolutionImpl impl )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	choices[key] = impl;
+}
+
+} // namespace NeoML
@@ -0,0 +1,153 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <NeoMathEngine/NeoMathEngine.h>
+#include <MathEngineDnnConv.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace NeoML {
+
+// The convolution implementation
+// The values are stored in the autotuning cache files, so they should not be changed
+enum TConvolutionImpl {
+	CI_Default = 0,		// chosen by the heuristics
+	CI_Simd = 1,		// the JIT convolution of the SIMD math engine
+	CI_Algo0 = 2,		// the matrix multiplication by the blocks of the result rows
+	CI_Algo1 = 3,		// the matrix multiplication by the whole result objects
+	CI_Winograd = 4,	// the Winograd F(2x2, 3x3) algorithm
+	CI_1x1 = 5,			// the convolution with a 1*1 filter
+	CI_Filter3x3 = 6,	// the channelwise convolution specialized for a 3*3 filter
+	CI_MultiThread = 7,	// the general algorithm using all the threads
+	CI_SingleThread = 8	// the general algorithm using one thread
+};
+
+// The channelwise convolution descriptor with the chosen forward pass implementation
+struct CCpuChannelwiseConvolutionDesc : public CCommonChannelwiseConvolutionDesc {
+	TConvolutionImpl ForwardImpl;
+
+	CCpuChannelwiseConvolutionDesc( int paddingHeight, int paddingWidth, int strideHeight, int strideWidth,
+			const CBlobDesc& source, const CBlobDesc& filter, const CBlobDesc& result ) :
+		CCommonChannelwiseConvolutionDesc( paddingHeight, paddingWidth, strideHeight, strideWidth, source, filter, result ),
+		ForwardImpl( CI_Default )
+	{
+	}
+
+	// Checks if the implementation specialized for a 3*3 filter may be used
+	bool IsFilter3x3Available() const
+	{
+		return Filter.Height() == 3 && Filter.Width() == 3 && PaddingHeight == 1 && PaddingWidth == 1
+			&& Filter.Channels() % 4 == 0
+			&& ( ( StrideHeight == 1 && StrideWidth == 1 ) || ( StrideHeight == 2 && StrideWidth == 2 ) );
+	}
+};
+
+// The time convolution descriptor with the chosen forward pass implementation
+struct CCpuTimeConvolutionDesc : public CCommonTimeConvolutionDesc {
+	TConvolutionImpl ForwardImpl;
+
+	CCpuTimeConvolutionDesc( const CBlobDesc& source, const CBlobDesc& result, const CBlobDesc& filter,
+			int stride, int paddingFront, int paddingBack, int dilation ) :
+		CCommonTimeConvolutionDesc( source, result, filter, stride, paddingFront, paddingBack, dilation ),
+		ForwardImpl( CI_Default )
+	{
+	}
+};
+
+// The blobs used to measure the convolution time
+struct CConvolutionAutotuningData {
+	CFloatHandleVar Source;
+	CFloatHandleVar Filter;
+	CFloatHandleVar FreeTerm;
+	CFloatHandleVar Result;
+
+	CConvolutionAutotuningData( IMathEngine& mathEngine, const CBlobDesc& source, const CBlobDesc& filter,
+		int freeTermSize, const CBlobDesc& result );
+};
+
+// Chooses the fastest convolution implementation for each convolution shape
+// The choices are kept in the cache that may be saved to a file and loaded on another host
+// When autotuning is off, only the cached choices are used and the rest of the shapes use the heuristics
+class CConvolutionAutotuner {
+public:
+	CConvolutionAutotuner() : isEnabled( false ) {}
+
+	void Enable( bool enable ) { isEnabled = enable; }
+	bool IsEnabled() const { return isEnabled; }
+
+	// Loads the choices from the file; the loaded choices replace the cached ones with the same keys
+	// Returns false if the file could not be read
+	bool Load( const char* fileName );
+	// Saves all the cached choices to the file
+	bool Save( const char* fileName ) const;
+
+	// Gets the implementation for the convolution with the given key
+	// The candidates are the implementations available for this convolution
+	// run( impl ) calculates the convolution using impl; it is called only when the choice is not cached
+	template<class TRun>
+	TConvolutionImpl Choose( const std::string& key, const TConvolutionImpl* candidates, int candidateCount, const TRun& run );
+
+	// Builds the key part describing the blob
+	static void AddToKey( std::string& key, const CBlobDesc& desc );
+	static void AddToKey( std::string& key, int value );
+
+private:
+	// The number of timed runs for each candidate; the fastest of them is used
+	static const int RunCount = 3;
+
+	std::atomic<bool> isEnabled;
+	mutable std::mutex mutex; // to protect the choices
+	std::map<std::string, int> choices;
+
+	bool lookup( const std::string& key, const TConvolutionImpl* candidates, int candidateCount,
+		TConvolutionImpl& impl ) const;
+	void add( const std::string& key, TConvolutionImpl impl );
+};
+
+template<class TRun>
+inline TConvolutionImpl CConvolutionAutotuner::Choose( const std::string& key, const TConvolutionImpl* candidates,
+	int candidateCount, const TRun& run )
+{
+	TConvolutionImpl result = CI_Default;
+	if( candidateCount < 2 || lookup( key, candidates, candidateCount, result ) || !isEnabled ) {
+		return result;
+	}
+
+	double bestTime = 0;
+	for( int i = 0; i < candidateCount; i++ ) {
+		run( candidates[i] ); // the warm-up run initializes the caches
+		double time = 0;
+		for( int j = 0; j < RunCount; j++ ) {
+			const auto start = std::chrono::steady_clock::now();
+			run( candidates[i] );
+			const double runTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+			time = j == 0 ? runTime : std::min( time, runTime );
+		}
+		if( i == 0 || time < bestTime ) {
+			bestTime = time;
+			result = candidates[i];
+		}
+	}
+	add( key, result );
+	return result;
+}
+
+} // namespace NeoML
@@ -0,0 +1,95 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <CpuMathEngine.h>
+#include <CpuExecutionScope.h>
+#include <CpuMathEnginePrivate.h>
+#include <MemoryHandleInternal.h>
+#include <NeoMathEngine/NeoMathEngineException.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <cmath>
+
+namespace NeoML {
+
+void CCpuMathEngine::LayerNormalization( int objectCount, int objectSize, const CConstFloatHandle& inputHandle,
+	float epsilon, const CConstFloatHandle& scaleHandle, const CConstFloatHandle& biasHandle, const CFloatHandle& resultHandle,
+	const CFloatHandle* normalizedInputHandle, const CFloatHandle* invSqrtVarianceHandle )
+{
+	ASSERT_EXPR( inputHandle.GetMathEngine() == this );
+	ASSERT_EXPR( scaleHandle.GetMathEngine() == this );
+	ASSERT_EXPR( biasHandle.GetMathEngine() == this );
+	ASSERT_EXPR( resultHandle.GetMathEngine() == this );
+	ASSERT_EXPR( normalizedInputHandle == nullptr || normalizedInputHandle->GetMathEngine() == this );
+	ASSERT_EXPR( invSqrtVarianceHandle == nullptr || invSqrtVarianceHandle->GetMathEngine() == this );
+	ASSERT_EXPR( objectCount > 0 && objectSize > 0 );
+	ASSERT_EXPR( epsilon > 0 );
+	CCpuExecutionScope scope;
+
+	const float* input = GetRaw( inputHandle );
+	const float* scale = GetRaw( scaleHandle );
+	const float* bias = GetRaw( biasHandle );
+	float* result = GetRaw( resultHandle );
+	float* normalizedInput = normalizedInputHandle == nullptr ? nullptr : GetRaw( *normalizedInputHandle );
+	float* invSqrtVariance = invSqrtVarianceHandle == nullptr ? nullptr : GetRaw( *invSqrtVarianceHandle );
+
+	const int curThreadCount = IsOmpRelevant( objectCount, static_cast<int64_t>( objectCount ) * objectSize ) ? threadCount : 1;
+
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int i = 0; i < objectCount; ++i ) {
+		const int offset = i * objectSize;
+		float mean;
+		float variance;
+		vectorMeanAndVariance( input + offset, objectSize, mean, variance );
+		const float invSqrtVar = 1.f / std::sqrt( variance + epsilon );
+		if( invSqrtVariance != nullptr ) {
+			invSqrtVariance[i] = invSqrtVar;
+		}
+		vectorLayerNormalization( input + offset, objectSize, mean, invSqrtVar, scale, bias,
+			normalizedInput == nullptr ? nullptr : normalizedInput + offset, result + offset );
+	}
+}
+
+void CCpuMathEngine::LayerNormalizationBackward( int objectCount, int objectSize,
+	const CConstFloatHandle& normalizedInputHandle, const CConstFloatHandle& invSqrtVarianceHandle,
+	const CConstFloatHandle& scaleHandle, const CConstFloatHandle& outputDiffHandle, const CFloatHandle& inputDiffHandle )
+{
+	ASSERT_EXPR( normalizedInputHandle.GetMathEngine() == this );
+	ASSERT_EXPR( invSqrtVarianceHandle.GetMathEngine() == this );
+	ASSERT_EXPR( scaleHandle.GetMathEngine() == this );
+	ASSERT_EXPR( outputDiffHandle.GetMathEngine() == this );
+	ASSERT_EXPR( inputDiffHandle.GetMathEngine() == this );
+	ASSERT_EXPR( objectCount > 0 && objectSize > 0 );
+	CCpuExecutionScope scope;
+
+	const float* normalizedInput = GetRaw( normalizedInputHandle );
+	const float* invSqrtVariance = GetRaw( invSqrtVarianceHandle );
+	const float* scale = GetRaw( scaleHandle );
+	const float* outputDiff = GetRaw( outputDiffHandle );
+	float* inputDiff = GetRaw( inputDiffHandle );
+
+	const int curThreadCount = IsOmpRelevant( objectCount, static_cast<int64_t>( objectCount ) * objectSize ) ? threadCount : 1;
+
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int i = 0; i < objectCount; ++i ) {
+		const int offset = i * objectSize;
+		vectorLayerNormalizationBackward( normalizedInput + offset, outputDiff + offset, scale, objectSize,
+			invSqrtVariance[i], inputDiff + offset );
+	}
+}
+
+} // namespace NeoML
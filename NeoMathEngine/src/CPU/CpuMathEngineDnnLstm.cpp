@@ -39,6 +39,18 @@ CLstmDesc* CCpuMathEngine::InitLstm( CLstmDesc* currentDesc, const CFloatHandle&
 	}
 }
 
+// Applies the fully connected layer to the matrix of objects
+static void fullyConnectedRunOnce( IMathEngine& mathEngine, const CConstFloatHandle& input, int inputHeight, int inputWidth,
+	const CConstFloatHandle& weights, int weightsWidth, const CConstFloatHandle& freeTerm, const CFloatHandle& output )
+{
+	mathEngine.MultiplyMatrixByTransposedMatrix( input, inputHeight, inputWidth, inputWidth,
+		weights, weightsWidth, inputWidth, output, weightsWidth, inputHeight * weightsWidth );
+
+	if( !freeTerm.IsNull() ) {
+		mathEngine.AddVectorToMatrixRows( 1, output, output, inputHeight, weightsWidth, freeTerm );
+	}
+}
+
 void CCpuMathEngine::Lstm( CLstmDesc& desc, 
 	const CFloatHandle& inputWeights, const CConstFloatHandle& inputFreeTerm,
 	const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
@@ -47,35 +59,36 @@ void CCpuMathEngine::Lstm( CLstmDesc& desc,
 {
 	CMathEngineLstmDesc& lstmDesc = dynamic_cast< CMathEngineLstmDesc& >( desc );
 
-	auto fullyConnectedRunOnce = [&]( const CConstFloatHandle& input, int inputHeight, int inputWidth,
-		const CFloatHandle& weights, int weightHeight, int weightsWidth,
-		const CFloatHandle& output, const CConstFloatHandle& freeTerm ) {
-		MultiplyMatrixByTransposedMatrix( input, inputHeight, inputWidth, inputWidth,
-			weights, weightsWidth, weightHeight,
-			output, weightsWidth, inputHeight * weightsWidth );
-
-		if( !freeTerm.IsNull() ) {
-			AddVectorToMatrixRows( 1, output, output, inputHeight,
-				weightsWidth, freeTerm );
-		}
-	};
-
-	//-----------------------------------------------------------------------------------------------------------------
-	// Apply fully connected layers
-	fullyConnectedRunOnce( input, lstmDesc.objectCount, lstmDesc.objectSize,
-		inputWeights, lstmDesc.objectSize, CMathEngineLstmDesc::GatesNum * lstmDesc.hiddenSize,
-		lstmDesc.inputFullyConnectedResult, inputFreeTerm );
-
-	fullyConnectedRunOnce( inputMainBackLink, lstmDesc.objectCount, lstmDesc.hiddenSize,
-		recurrentWeights, lstmDesc.hiddenSize, CMathEngineLstmDesc::GatesNum * lstmDesc.hiddenSize,
-		lstmDesc.reccurentFullyConnectedResult, recurrentFreeTerm );
+	fullyConnectedRunOnce( *this, input, lstmDesc.objectCount, lstmDesc.objectSize,
+		inputWeights, CMathEngineLstmDesc::GatesNum * lstmDesc.hiddenSize, inputFreeTerm,
+		lstmDesc.inputFullyConnectedResult );
+
+	LstmRecurrentStep( desc, lstmDesc.inputFullyConnectedResult, recurrentWeights, recurrentFreeTerm,
+		inputStateBackLink, inputMainBackLink, outputStateBackLink, outputMainBackLink );
+}
+
+void CCpuMathEngine::LstmRecurrentStep( CLstmDesc& desc, const CFloatHandle& inputFullyConnectedResult,
+	const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
+	const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink,
+	const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink )
+{
+	ASSERT_EXPR( inputFullyConnectedResult.GetMathEngine() == this );
+	CMathEngineLstmDesc& lstmDesc = dynamic_cast< CMathEngineLstmDesc& >( desc );
+
+	fullyConnectedRunOnce( *this, inputMainBackLink, lstmDesc.objectCount, lstmDesc.hiddenSize,
+		recurrentWeights, CMathEngineLstmDesc::GatesNum * lstmDesc.hiddenSize, recurrentFreeTerm,
+		lstmDesc.reccurentFullyConnectedResult );
 
+	// The rest of LSTM sums the fully connected results in the buffer of the input one
+	const CFloatHandle descInputFullyConnectedResult = lstmDesc.inputFullyConnectedResult;
+	lstmDesc.inputFullyConnectedResult = inputFullyConnectedResult;
 	// if outputMainBackLink != output then we are in compatibility mode
 	if( simdMathEngine != nullptr ) {
 		simdMathEngine->RunOnceRestOfLstm( &lstmDesc, inputStateBackLink, outputStateBackLink, outputMainBackLink );
 	} else {
 		lstmDesc.RunOnceRestOfLstm( inputStateBackLink, outputStateBackLink, outputMainBackLink );
 	}
+	lstmDesc.inputFullyConnectedResult = descInputFullyConnectedResult;
 }
 
 } // namespace NeoML
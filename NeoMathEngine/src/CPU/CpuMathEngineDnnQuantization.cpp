@@ -0,0 +1,251 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <CpuMathEngine.h>
+#include <CpuExecutionScope.h>
+#include <CpuMathEnginePrivate.h>
+#include <MemoryHandleInternal.h>
+#include <NeoMathEngine/NeoMathEngineException.h>
+#include <NeoMathEngine/OpenMP.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace NeoML {
+
+// The maximum absolute value of a quantized number
+// -128 is not used so that the quantization is symmetric
+static const int MaxInt8Value = 127;
+
+// The int8 micro-kernel calculates the block of Int8KernelHeight rows of the first matrix
+// by Int8KernelWidth rows of the second matrix
+// The first matrix is quantized to [-MaxInt8Value; MaxInt8Value] but stored widened to int16 on purpose:
+// - the products are summed by pmaddwd exactly, while the u8 x s8 pmaddubsw saturates the sums of pairs to int16
+//   (255 * 127 * 2 doesn't fit) and needs the activations shifted to unsigned with the zero point correction
+// - the quantization stays symmetric with no zero point, the same for the weights and the activations
+// - the same data layout is used by the SSE2, AVX2, AVX-512 and NEON kernels
+//   (vpdpbusd would avoid the saturation, but it requires AVX-512 VNNI or AVX-VNNI)
+// The first rows are quantized by blocks that fit into L1 cache, so the wider storage doesn't add memory traffic
+static const int Int8KernelHeight = 4;
+static const int Int8KernelWidth = 2;
+// The rows are padded to Int8KernelStep values so that any of the micro-kernels (up to zmm) may process them
+static const int Int8KernelStep = 32;
+// The block of the quantized first matrix, its Int8KernelHeight rows should fit into L1 cache
+static const int QuantizedFirstBlockSize = 64 * 1024;
+// The block of the second matrix, should fit into L2 cache together with the first block
+static const int QuantizedSecondBlockSize = 128 * 1024;
+
+// The int8 matrix with a separate scale for each row
+// The rows are stored with the zero padding required by the micro-kernel
+struct CCpuQuantizedMatrixDesc : public CQuantizedMatrixDesc {
+	int Height;
+	int Width;
+	int RowSize; // Width rounded up to Int8KernelStep
+	std::vector<signed char> Data; // Height rounded up to Int8KernelWidth x RowSize
+	std::vector<float> Scales; // Height; row[i] ~= Data[i] * Scales[i]
+
+	CCpuQuantizedMatrixDesc( int height, int width ) :
+		Height( height ),
+		Width( width ),
+		RowSize( ( width + Int8KernelStep - 1 ) / Int8KernelStep * Int8KernelStep ),
+		Data( static_cast<size_t>( ( height + Int8KernelWidth - 1 ) / Int8KernelWidth * Int8KernelWidth ) * RowSize ),
+		Scales( height )
+	{
+	}
+};
+
+// Calculates the scale which maps the values of the vector onto [-MaxInt8Value; MaxInt8Value]
+static inline float calcInt8Scale( const float* data, int size )
+{
+	const float maxAbs = vectorMaxAbs( data, size );
+	return maxAbs > 0 ? maxAbs / MaxInt8Value : 1.f;
+}
+
+// Quantizes the vector with the given scale; the values out of range are saturated
+static inline void quantizeInt8( const float* data, int size, float scale, signed char* result )
+{
+	const float multiplier = 1.f / scale;
+	for( int i = 0; i < size; ++i ) {
+		const float value = std::round( data[i] * multiplier );
+		result[i] = static_cast<signed char>( std::min( std::max( value, -static_cast<float>( MaxInt8Value ) ),
+			static_cast<float>( MaxInt8Value ) ) );
+	}
+}
+
+CQuantizedMatrixDesc* CCpuMathEngine::InitQuantizedMatrix( const CConstFloatHandle& matrixHandle, int height, int width )
+{
+	ASSERT_EXPR( matrixHandle.GetMathEngine() == this );
+	ASSERT_EXPR( height > 0 );
+	ASSERT_EXPR( width > 0 );
+	CCpuExecutionScope scope;
+
+	CCpuQuantizedMatrixDesc* desc = new CCpuQuantizedMatrixDesc( height, width );
+	const float* matrix = GetRaw( matrixHandle );
+
+	const int curThreadCount = IsOmpRelevant( height, static_cast<int64_t>( height ) * width ) ? threadCount : 1;
+	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
+	for( int row = 0; row < height; ++row ) {
+		const float* matrixRow = matrix + static_cast<size_t>( row ) * width;
+		desc->Scales[row] = calcInt8Scale( matrixRow, width );
+		quantizeInt8( matrixRow, width, desc->Scales[row], desc->Data.data() + static_cast<size_t>( row ) * desc->RowSize );
+	}
+	return desc;
+}
+
+CQuantizedMatrixDesc* CCpuMathEngine::InitQuantizedMatrix( const signed char* data, const float* scales, int height, int width )
+{
+	ASSERT_EXPR( data != nullptr );
+	ASSERT_EXPR( scales != nullptr );
+	ASSERT_EXPR( height > 0 );
+	ASSERT_EXPR( width > 0 );
+
+	CCpuQuantizedMatrixDesc* desc = new CCpuQuantizedMatrixDesc( height, width );
+	for( int row = 0; row < height; ++row ) {
+		::memcpy( desc->Data.data() + static_cast<size_t>( row ) * desc->RowSize, data + static_cast<size_t>( row ) * width,
+			width * sizeof( signed char ) );
+	}
+	::memcpy( desc->Scales.data(), scales, height * sizeof( float ) );
+	return desc;
+}
+
+void CCpuMathEngine::GetQuantizedMatrixData( const CQuantizedMatrixDesc& matrixDesc, signed char* data, float* scales )
+{
+	ASSERT_EXPR( data != nullptr );
+	ASSERT_EXPR( scales != nullptr );
+	const CCpuQuantizedMatrixDesc& matrix = static_cast<const CCpuQuantizedMatrixDesc&>( matrixDesc );
+
+	for( int row = 0; row < matrix.Height; ++row ) {
+		::memcpy( data + static_cast<size_t>( row ) * matrix.Width, matrix.Data.data() + static_cast<size_t>( row ) * matrix.RowSize,
+			matrix.Width * sizeof( signed char ) );
+	}
+	::memcpy( scales, matrix.Scales.data(), matrix.Height * sizeof( float ) );
+}
+
+// The default Int8MultiplyFunc, used when the simd library is not loaded
+static void multiplyInt8Rows( const short* first, const signed char* second, int secondCount, int rowSize,
+	int* result, int resultRowSize )
+{
+	for( int j = 0; j < secondCount; j += Int8KernelWidth ) {
+		multiplyInt8Kernel4x2( first, second + static_cast<size_t>( j ) * rowSize, rowSize, result + j, resultRowSize );
+	}
+}
+
+// Multiplies the first matrix by the rows [secondStart; secondStart + secondCount) of the quantized matrix
+// The first matrix is quantized by blocks which are multiplied by the blocks of the second matrix with the micro-kernel
+// secondStart must be a multiple of Int8KernelWidth
+void CCpuMathEngine::multiplyMatrixByTransposedQuantizedMatrix( const float* first, int firstHeight, int firstWidth,
+	float firstScale, const CQuantizedMatrixDesc& secondDesc, int secondStart, int secondCount, const float* freeTerm,
+	const CFusedActivation& activation, float* result, int resultRowSize )
+{
+	const CCpuQuantizedMatrixDesc& second = static_cast<const CCpuQuantizedMatrixDesc&>( secondDesc );
+	const int rowSize = second.RowSize;
+	const int secondEnd = secondStart + secondCount;
+
+	const int firstBlockHeight = std::max( 1, QuantizedFirstBlockSize
+		/ static_cast<int>( Int8KernelHeight * rowSize * sizeof( short ) ) ) * Int8KernelHeight;
+	const int secondBlockHeight = std::max( 1, QuantizedSecondBlockSize / ( Int8KernelWidth * rowSize ) ) * Int8KernelWidth;
+	// The quantized rows of the first matrix; the padding is filled with zeros
+	// The rows after the end of the last block are left from the previous block, their products are not stored
+	std::vector<short> quantizedRows( static_cast<size_t>( std::min( firstBlockHeight,
+		( firstHeight + Int8KernelHeight - 1 ) / Int8KernelHeight * Int8KernelHeight ) ) * rowSize );
+	std::vector<float> rowScales( firstBlockHeight );
+	// The int32 products of Int8KernelHeight rows by a block of the second matrix
+	std::vector<int> kernelResult( Int8KernelHeight * secondBlockHeight );
+	const Int8MultiplyFunc multiplyRows = customInt8MultiplyFunction != nullptr ?
+		customInt8MultiplyFunction : multiplyInt8Rows;
+
+	for( int blockStart = 0; blockStart < firstHeight; blockStart += firstBlockHeight ) {
+		const int blockHeight = std::min( firstBlockHeight, firstHeight - blockStart );
+		for( int i = 0; i < blockHeight; ++i ) {
+			const float* firstRow = first + static_cast<size_t>( blockStart + i ) * firstWidth;
+			rowScales[i] = firstScale > 0 ? firstScale : calcInt8Scale( firstRow, firstWidth );
+			vectorQuantizeInt8( firstRow, firstWidth, 1.f / rowScales[i], static_cast<float>( MaxInt8Value ),
+				quantizedRows.data() + static_cast<size_t>( i ) * rowSize );
+		}
+
+		float* resultBlock = result + static_cast<size_t>( blockStart ) * resultRowSize;
+		for( int secondBlockStart = secondStart; secondBlockStart < secondEnd; secondBlockStart += secondBlockHeight ) {
+			const int secondBlockCount = std::min( secondEnd - secondBlockStart, secondBlockHeight );
+			// The padding row of the second matrix is zero so the block is rounded up to the kernel width
+			const int kernelCount = ( secondBlockCount + Int8KernelWidth - 1 ) / Int8KernelWidth * Int8KernelWidth;
+			const float* secondScales = second.Scales.data() + secondBlockStart;
+			for( int i = 0; i < blockHeight; i += Int8KernelHeight ) {
+				multiplyRows( quantizedRows.data() + static_cast<size_t>( i ) * rowSize,
+					second.Data.data() + static_cast<size_t>( secondBlockStart ) * rowSize, kernelCount, rowSize,
+					kernelResult.data(), secondBlockHeight );
+
+				const int kernelHeight = std::min( Int8KernelHeight, blockHeight - i );
+				for( int row = 0; row < kernelHeight; ++row ) {
+					const int* kernelRow = kernelResult.data() + row * secondBlockHeight;
+					float* resultRow = resultBlock + static_cast<size_t>( i + row ) * resultRowSize
+						+ secondBlockStart - secondStart;
+					const float rowScale = rowScales[i + row];
+					for( int column = 0; column < secondBlockCount; ++column ) {
+						resultRow[column] = kernelRow[column] * rowScale * secondScales[column];
+					}
+				}
+			}
+		}
+
+		for( int i = 0; i < blockHeight; ++i ) {
+			float* resultRow = resultBlock + static_cast<size_t>( i ) * resultRowSize;
+			if( freeTerm != nullptr ) {
+				vectorAdd( resultRow, freeTerm + secondStart, resultRow, secondCount );
+			}
+			applyActivation( activation, resultRow, secondCount );
+		}
+	}
+}
+
+void CCpuMathEngine::MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle& firstHandle, int firstHeight,
+	int firstWidth, float firstScale, const CQuantizedMatrixDesc& secondDesc, const CConstFloatHandle* freeTermHandle,
+	const CFusedActivation& activation, const CFloatHandle& resultHandle )
+{
+	ASSERT_EXPR( firstHandle.GetMathEngine() == this );
+	ASSERT_EXPR( resultHandle.GetMathEngine() == this );
+	ASSERT_EXPR( freeTermHandle == nullptr || freeTermHandle->GetMathEngine() == this );
+	const CCpuQuantizedMatrixDesc& second = static_cast<const CCpuQuantizedMatrixDesc&>( secondDesc );
+	ASSERT_EXPR( second.Width == firstWidth );
+	ASSERT_EXPR( activation.Type == AF_Linear || activation.Type == AF_ReLU );
+	CCpuExecutionScope scope;
+
+	const float* first = GetRaw( firstHandle );
+	const float* freeTerm = freeTermHandle == nullptr ? nullptr : GetRaw( *freeTermHandle );
+	float* result = GetRaw( resultHandle );
+
+	// The same split as in the float multiplication: a few rows of the first matrix are multiplied
+	// by the different parts of the second matrix in parallel
+	const int curThreadCount = IsOmpRelevant( firstHeight * second.Height,
+		static_cast<int64_t>( firstHeight ) * firstWidth * second.Height ) ? threadCount : 1;
+	NEOML_OMP_NUM_THREADS( curThreadCount )
+	{
+		int firstStart;
+		int firstCount;
+		int secondStart;
+		int secondCount;
+		if( OmpGetTaskIndexAndCount2D( firstHeight, 1, second.Height, Int8KernelWidth,
+			firstStart, firstCount, secondStart, secondCount ) )
+		{
+			multiplyMatrixByTransposedQuantizedMatrix( first + static_cast<size_t>( firstStart ) * firstWidth, firstCount,
+				firstWidth, firstScale, second, secondStart, secondCount, freeTerm, activation,
+				result + static_cast<size_t>( firstStart ) * second.Height + secondStart, second.Height );
+		}
+	}
+}
+
+} // namespace NeoML
@@ -48,7 +48,34 @@ CTimeConvolutionDesc* CCpuMathEngine::InitTimeConvolution( const CBlobDesc& sour
 	ASSERT_EXPR( paddingFront < ( filter.Height() - 1 ) * dilation + 1 );
 	ASSERT_EXPR( paddingBack < ( filter.Height() - 1 ) * dilation + 1 );
 
-	CCommonTimeConvolutionDesc* desc = new CCommonTimeConvolutionDesc( source, result, filter, stride, paddingFront, paddingBack, dilation );
+	CCpuTimeConvolutionDesc* desc = new CCpuTimeConvolutionDesc( source, result, filter, stride, paddingFront, paddingBack, dilation );
+
+	// The only choice is whether to split the sequence between the threads
+	TConvolutionImpl candidates[2];
+	int candidateCount = 0;
+	candidates[candidateCount++] = CI_MultiThread;
+	if( threadCount > 1 ) {
+		candidates[candidateCount++] = CI_SingleThread;
+	}
+
+	std::string key = "time";
+	CConvolutionAutotuner::AddToKey( key, source );
+	CConvolutionAutotuner::AddToKey( key, filter );
+	CConvolutionAutotuner::AddToKey( key, stride );
+	CConvolutionAutotuner::AddToKey( key, paddingFront );
+	CConvolutionAutotuner::AddToKey( key, paddingBack );
+	CConvolutionAutotuner::AddToKey( key, dilation );
+	CConvolutionAutotuner::AddToKey( key, threadCount );
+
+	std::unique_ptr<CConvolutionAutotuningData> data;
+	desc->ForwardImpl = convolutionAutotuner.Choose( key, candidates, candidateCount, [&]( TConvolutionImpl impl ) {
+		if( data == nullptr ) {
+			data.reset( new CConvolutionAutotuningData( mathEngine(), source, filter, filter.ObjectCount(), result ) );
+		}
+		desc->ForwardImpl = impl;
+		BlobTimeConvolution( *desc, data->Source.GetHandle(), data->Filter.GetHandle(), data->FreeTerm.GetHandle(),
+			data->Result.GetHandle() );
+	} );
 	return desc;
 }
 
@@ -65,7 +92,7 @@ void CCpuMathEngine::BlobTimeConvolution( const CTimeConvolutionDesc& convDesc,
 	const float* filterDataRaw = GetRaw( filterData );
 	float* resultDataRaw = GetRaw( resultData );
 
-	const CCommonTimeConvolutionDesc& desc = static_cast<const CCommonTimeConvolutionDesc&>( convDesc );
+	const CCpuTimeConvolutionDesc& desc = static_cast<const CCpuTimeConvolutionDesc&>( convDesc );
 	const CBlobDesc& source = desc.Source;
 	const CBlobDesc& result = desc.Result;
 	const CBlobDesc& filter = desc.Filter;
@@ -75,7 +102,12 @@ void CCpuMathEngine::BlobTimeConvolution( const CTimeConvolutionDesc& convDesc,
 	int inputObjectSize = source.ObjectSize();
 	int inputRowSize = source.BatchWidth() * inputObjectSize;
 
-	const int curThreadCount = IsOmpRelevant( result.BatchLength() ) ? threadCount : 1;
+	int curThreadCount = threadCount;
+	if( desc.ForwardImpl == CI_SingleThread ) {
+		curThreadCount = 1;
+	} else if( desc.ForwardImpl == CI_Default ) {
+		curThreadCount = IsOmpRelevant( result.BatchLength() ) ? threadCount : 1;
+	}
 
 	NEOML_OMP_FOR_NUM_THREADS( curThreadCount )
 	for( int outSeqNum = 0; outSeqNum < result.BatchLength(); ++outSeqNum ) {
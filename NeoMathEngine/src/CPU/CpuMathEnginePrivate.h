@@ -36,3 +36,31 @@ limitations under the License.
 #error "Platform isn't supported!"
 
 #endif
+
+#include <NeoMathEngine/NeoMathEngine.h>
+
+namespace NeoML {
+
+// Applies the fused activation to the data in place
+inline void applyActivation( const CFusedActivation& activation, float* data, int dataSize )
+{
+	if( activation.Type == AF_ReLU ) {
+		if( activation.Param > 0 ) {
+			vectorReLU( data, data, dataSize, activation.Param );
+		} else {
+			vectorReLU( data, data, dataSize );
+		}
+	}
+}
+
+// Applies the fused activation to one value
+inline float applyActivation( const CFusedActivation& activation, float value )
+{
+	if( activation.Type == AF_ReLU ) {
+		value = value > 0 ? value : 0.f;
+		return activation.Param > 0 && value > activation.Param ? activation.Param : value;
+	}
+	return value;
+}
+
+} // namespace NeoML
@@ -238,6 +238,31 @@ void CCpuMathEngine::VectorAdd(const CConstFloatHandle& firstHandle, const CCons
 	}
 }
 
+void CCpuMathEngine::VectorAddWithActivation( const CConstFloatHandle& firstHandle, const CConstFloatHandle& secondHandle,
+	const CFloatHandle& resultHandle, int vectorSize, const CFusedActivation& activation )
+{
+	ASSERT_EXPR( firstHandle.GetMathEngine() == this );
+	ASSERT_EXPR( secondHandle.GetMathEngine() == this );
+	ASSERT_EXPR( resultHandle.GetMathEngine() == this );
+	ASSERT_EXPR( activation.Type == AF_Linear || activation.Type == AF_ReLU );
+	CCpuExecutionScope scope;
+
+	const float* first = GetRaw( firstHandle );
+	const float* second = GetRaw( secondHandle );
+	float* result = GetRaw( resultHandle );
+	// The sum is activated by blocks which are still in the L1 cache
+	const int blockSize = 1024;
+	auto function = [=]( int index, int count ) {
+		for( int start = index; start < index + count; start += blockSize ) {
+			const int size = std::min( blockSize, index + count - start );
+			NeoML::vectorAdd( first + start, second + start, result + start, size );
+			applyActivation( activation, result + start, size );
+		}
+	};
+	const int curThreadCount = IsOmpRelevant( vectorSize, vectorSize ) ? threadCount : 1;
+	applyOmpVectorFunction( curThreadCount, vectorSize, function );
+}
+
 void CCpuMathEngine::VectorSum(const CConstFloatHandle& firstHandle, int vectorSize, const CFloatHandle& resultHandle)
 {
 	ASSERT_EXPR( firstHandle.GetMathEngine() == this );
@@ -697,6 +697,213 @@ private:
 	const int32x4_t FloatBias;
 };
 
+
+// Adds the products of 16 values of the first row by 16 values of the two second rows to the sums
+// The second rows are already sign-extended to int16: low and high halves
+inline void addInt8RowProducts( const short* first, const int16x8_t& second0Low, const int16x8_t& second0High,
+	const int16x8_t& second1Low, const int16x8_t& second1High, int32x4_t& sum0, int32x4_t& sum1 )
+{
+	const int16x8_t firstLow = vld1q_s16( first );
+	const int16x8_t firstHigh = vld1q_s16( first + 8 );
+	sum0 = vmlal_s16( sum0, vget_low_s16( firstLow ), vget_low_s16( second0Low ) );
+	sum0 = vmlal_s16( sum0, vget_high_s16( firstLow ), vget_high_s16( second0Low ) );
+	sum0 = vmlal_s16( sum0, vget_low_s16( firstHigh ), vget_low_s16( second0High ) );
+	sum0 = vmlal_s16( sum0, vget_high_s16( firstHigh ), vget_high_s16( second0High ) );
+	sum1 = vmlal_s16( sum1, vget_low_s16( firstLow ), vget_low_s16( second1Low ) );
+	sum1 = vmlal_s16( sum1, vget_high_s16( firstLow ), vget_high_s16( second1Low ) );
+	sum1 = vmlal_s16( sum1, vget_low_s16( firstHigh ), vget_low_s16( second1High ) );
+	sum1 = vmlal_s16( sum1, vget_high_s16( firstHigh ), vget_high_s16( second1High ) );
+}
+
+// Stores the horizontal sums of two registers into result[0] and result[1]
+inline void storeInt8Sums( const int32x4_t& sum0, const int32x4_t& sum1, int* result )
+{
+	const int32x2_t sum = vpadd_s32( vadd_s32( vget_low_s32( sum0 ), vget_high_s32( sum0 ) ),
+		vadd_s32( vget_low_s32( sum1 ), vget_high_s32( sum1 ) ) );
+	vst1_s32( result, sum );
+}
+
+// The int8 matrix multiplication micro-kernel: calculates the 4 x 2 block of first * transposed( second )
+// The first matrix contains the int8 values widened to int16 (so that they are loaded only once for all the second rows),
+// the second matrix contains the int8 values which are sign-extended here
+// Both matrices have the rows of rowSize elements, rowSize is a multiple of 16 (the rows are padded with zeros)
+// The result is stored into 4 rows of result with resultRowSize elements
+inline void multiplyInt8Kernel4x2( const short* first, const signed char* second, int rowSize, int* result, int resultRowSize )
+{
+	int32x4_t sum00 = vdupq_n_s32( 0 );
+	int32x4_t sum01 = sum00;
+	int32x4_t sum10 = sum00;
+	int32x4_t sum11 = sum00;
+	int32x4_t sum20 = sum00;
+	int32x4_t sum21 = sum00;
+	int32x4_t sum30 = sum00;
+	int32x4_t sum31 = sum00;
+	for( int i = 0; i < rowSize; i += 16 ) {
+		const int8x16_t second0 = vld1q_s8( second + i );
+		const int8x16_t second1 = vld1q_s8( second + rowSize + i );
+		const int16x8_t second0Low = vmovl_s8( vget_low_s8( second0 ) );
+		const int16x8_t second0High = vmovl_s8( vget_high_s8( second0 ) );
+		const int16x8_t second1Low = vmovl_s8( vget_low_s8( second1 ) );
+		const int16x8_t second1High = vmovl_s8( vget_high_s8( second1 ) );
+
+		addInt8RowProducts( first + i, second0Low, second0High, second1Low, second1High, sum00, sum01 );
+		addInt8RowProducts( first + rowSize + i, second0Low, second0High, second1Low, second1High, sum10, sum11 );
+		addInt8RowProducts( first + 2 * rowSize + i, second0Low, second0High, second1Low, second1High, sum20, sum21 );
+		addInt8RowProducts( first + 3 * rowSize + i, second0Low, second0High, second1Low, second1High, sum30, sum31 );
+	}
+	storeInt8Sums( sum00, sum01, result );
+	storeInt8Sums( sum10, sum11, result + resultRowSize );
+	storeInt8Sums( sum20, sum21, result + 2 * resultRowSize );
+	storeInt8Sums( sum30, sum31, result + 3 * resultRowSize );
+}
+
+// Returns the maximum absolute value of the vector
+inline float vectorMaxAbs( const float* data, int size )
+{
+	const int neonSize = size / 4;
+	float32x4_t maxNeon = vdupq_n_f32( 0 );
+	for( int i = 0; i < neonSize; i++ ) {
+		maxNeon = vmaxq_f32( maxNeon, vabsq_f32( vld1q_f32( data ) ) );
+		data += 4;
+	}
+
+	float result = vget_lane_f32( HorizontalMaxNeon( maxNeon ), 0 );
+	for( int i = 4 * neonSize; i < size; i++ ) {
+		const float absValue = *data < 0 ? -*data : *data;
+		result = absValue > result ? absValue : result;
+		data++;
+	}
+	return result;
+}
+
+// Multiplies 4 values by multiplier, saturates them to [-maxValue; maxValue] and rounds half away from zero
+inline int32x4_t quantizeInt8Neon( const float* data, float multiplier, const float32x4_t& maxValue )
+{
+	float32x4_t value = vmulq_n_f32( vld1q_f32( data ), multiplier );
+	value = vmaxq_f32( vminq_f32( value, maxValue ), vnegq_f32( maxValue ) );
+	const uint32x4_t signMask = vdupq_n_u32( 0x80000000 );
+	const uint32x4_t half = vorrq_u32( vandq_u32( vreinterpretq_u32_f32( value ), signMask ),
+		vreinterpretq_u32_f32( vdupq_n_f32( 0.5f ) ) );
+	return vcvtq_s32_f32( vaddq_f32( value, vreinterpretq_f32_u32( half ) ) );
+}
+
+// Quantizes the vector for the int8 micro-kernel: round( data * multiplier ) saturated to [-maxValue; maxValue]
+// The values are rounded half away from zero like std::round and are stored widened to int16
+inline void vectorQuantizeInt8( const float* data, int size, float multiplier, float maxValue, short* result )
+{
+	const int neonSize = size / 8;
+	const float32x4_t maxValueNeon = vdupq_n_f32( maxValue );
+	for( int i = 0; i < neonSize; i++ ) {
+		const int16x4_t low = vmovn_s32( quantizeInt8Neon( data, multiplier, maxValueNeon ) );
+		const int16x4_t high = vmovn_s32( quantizeInt8Neon( data + 4, multiplier, maxValueNeon ) );
+		vst1q_s16( result, vcombine_s16( low, high ) );
+		data += 8;
+		result += 8;
+	}
+
+	for( int i = 8 * neonSize; i < size; i++ ) {
+		float value = *data * multiplier;
+		value = value > maxValue ? maxValue : ( value < -maxValue ? -maxValue : value );
+		*result = static_cast<short>( value + ( value < 0 ? -0.5f : 0.5f ) );
+		data++;
+		result++;
+	}
+}
+
+// Calculates the mean and the variance of the vector in one pass with the Welford algorithm
+// Each register field processes every fourth element, then the fields' statistics are merged
+inline void vectorMeanAndVariance( const float* data, int size, float& mean, float& variance )
+{
+	const int neonSize = size / 4;
+	float32x4_t meanNeon = vdupq_n_f32( 0 );
+	float32x4_t m2Neon = vdupq_n_f32( 0 );
+	for( int i = 0; i < neonSize; i++ ) {
+		const float32x4_t value = vld1q_f32( data );
+		const float32x4_t delta = vsubq_f32( value, meanNeon );
+		meanNeon = vmlaq_n_f32( meanNeon, delta, 1.f / ( i + 1 ) );
+		m2Neon = vmlaq_f32( m2Neon, delta, vsubq_f32( value, meanNeon ) );
+		data += 4;
+	}
+
+	// Merge the fields: they have the same number of elements
+	float resultMean = 0;
+	float resultM2 = 0;
+	if( neonSize > 0 ) {
+		resultMean = vget_lane_f32( HorizontalAddNeon( meanNeon ), 0 ) / 4;
+		const float32x4_t meanDiff = vsubq_f32( meanNeon, vdupq_n_f32( resultMean ) );
+		resultM2 = vget_lane_f32( HorizontalAddNeon( vmlaq_n_f32( m2Neon, vmulq_f32( meanDiff, meanDiff ),
+			static_cast<float>( neonSize ) ) ), 0 );
+	}
+
+	for( int i = 4 * neonSize; i < size; i++ ) {
+		const float delta = *data - resultMean;
+		resultMean += delta / ( i + 1 );
+		resultM2 += delta * ( *data - resultMean );
+		data++;
+	}
+	mean = resultMean;
+	variance = size > 0 ? resultM2 / size : 0.f;
+}
+
+// Normalizes the vector and applies the scale and the bias:
+// normalized = ( input - mean ) * invSqrtVariance, result = normalized * scale + bias
+// normalized may be null; result may be the same as input
+inline void vectorLayerNormalization( const float* input, int size, float mean, float invSqrtVariance,
+	const float* scale, const float* bias, float* normalized, float* result )
+{
+	const float32x4_t meanNeon = vdupq_n_f32( mean );
+	int i = 0;
+	for( ; i + 4 <= size; i += 4 ) {
+		const float32x4_t norm = vmulq_n_f32( vsubq_f32( vld1q_f32( input + i ), meanNeon ), invSqrtVariance );
+		if( normalized != nullptr ) {
+			vst1q_f32( normalized + i, norm );
+		}
+		vst1q_f32( result + i, vmlaq_f32( vld1q_f32( bias + i ), norm, vld1q_f32( scale + i ) ) );
+	}
+	for( ; i < size; i++ ) {
+		const float norm = ( input[i] - mean ) * invSqrtVariance;
+		if( normalized != nullptr ) {
+			normalized[i] = norm;
+		}
+		result[i] = norm * scale[i] + bias[i];
+	}
+}
+
+// The backward pass of the layer normalization for one vector
+// inputDiff = invSqrtVariance * ( g - mean( g ) - normalized * mean( g * normalized ) ), where g = outputDiff * scale
+// inputDiff may be the same as outputDiff
+inline void vectorLayerNormalizationBackward( const float* normalized, const float* outputDiff, const float* scale,
+	int size, float invSqrtVariance, float* inputDiff )
+{
+	float32x4_t sumNeon = vdupq_n_f32( 0 );
+	float32x4_t dotNeon = vdupq_n_f32( 0 );
+	int i = 0;
+	for( ; i + 4 <= size; i += 4 ) {
+		const float32x4_t g = vmulq_f32( vld1q_f32( outputDiff + i ), vld1q_f32( scale + i ) );
+		sumNeon = vaddq_f32( sumNeon, g );
+		dotNeon = vmlaq_f32( dotNeon, g, vld1q_f32( normalized + i ) );
+	}
+	float sum = vget_lane_f32( HorizontalAddNeon( sumNeon ), 0 );
+	float dot = vget_lane_f32( HorizontalAddNeon( dotNeon ), 0 );
+	for( ; i < size; i++ ) {
+		const float g = outputDiff[i] * scale[i];
+		sum += g;
+		dot += g * normalized[i];
+	}
+
+	const float negMean = -sum / size;
+	const float negDotMean = -dot / size;
+	const float32x4_t negMeanNeon = vdupq_n_f32( negMean );
+	for( i = 0; i + 4 <= size; i += 4 ) {
+		const float32x4_t g = vmulq_f32( vld1q_f32( outputDiff + i ), vld1q_f32( scale + i ) );
+		const float32x4_t diff = vmlaq_n_f32( vaddq_f32( g, negMeanNeon ), vld1q_f32( normalized + i ), negDotMean );
+		vst1q_f32( inputDiff + i, vmulq_n_f32( diff, invSqrtVariance ) );
+	}
+	for( ; i < size; i++ ) {
+		inputDiff[i] = ( outputDiff[i] * scale[i] + negMean + normalized[i] * negDotMean ) * invSqrtVariance;
+	}
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_NEON
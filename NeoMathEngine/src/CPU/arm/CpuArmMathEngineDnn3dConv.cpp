@@ -27,12 +27,14 @@ limitations under the License.
 #include <MathEngineDnnConv.h>
 #include <CpuArmMathEngineVectorMathPrivate.h>
 #include <CpuArmMathEngineBlasPrivate.h>
+#include <CpuMathEnginePrivate.h>
 
 namespace NeoML {
 
 void CCpuMathEngine::blob3dConvolution1x1x1( const CBlobDesc& source, const CBlobDesc& filter, const CBlobDesc& result,
 	int strideHeight, int strideWidth, int strideDepth,
-	const float* sourceData, const float* filterData, const float* freeTermData, float* resultData )
+	const float* sourceData, const float* filterData, const float* freeTermData,
+	const CFusedActivation& activation, float* resultData )
 {
 	static constexpr int goodDenominatorFirst = 8;
 	static constexpr int goodDenominatorSecond = 12;
@@ -62,6 +64,7 @@ void CCpuMathEngine::blob3dConvolution1x1x1( const CBlobDesc& source, const CBlo
 						geomCount, channels, channels,
 						filterData, newChannels, channels,
 						outputDataPtr, newChannels);
+					applyActivation(activation, outputDataPtr, geomCount * newChannels);
 				}
 			}
 		} else {
@@ -87,6 +90,11 @@ void CCpuMathEngine::blob3dConvolution1x1x1( const CBlobDesc& source, const CBlo
 						geomSize, channels, channels,
 						filterData + channelStart * channels, channelCount, channels,
 						resultData + channelStart, newChannels);
+					if( activation.Type != AF_Linear ) {
+						for( float* res = resultPtr; res < resultEnd; res += newChannels ) {
+							applyActivation(activation, res, channelCount);
+						}
+					}
 				}
 			}
 		}
@@ -125,6 +133,7 @@ void CCpuMathEngine::blob3dConvolution1x1x1( const CBlobDesc& source, const CBlo
 					geomCount, channels, channels,
 					filterData, newChannels, channels,
 					outputDataPtr, newChannels);
+				applyActivation(activation, outputDataPtr, geomCount * newChannels);
 			}
 		}
 	}
@@ -459,6 +459,216 @@ inline float euclidianSSE( const float* x, const float* y, const int size )
 	return result;
 }
 
+// Adds the products of 16 values of the first row by 16 values of the two second rows to the sums
+// The second rows are already sign-extended to int16: low and high halves
+inline void addInt8RowProducts( const short* first, const __m128i& second0Low, const __m128i& second0High,
+	const __m128i& second1Low, const __m128i& second1High, __m128i& sum0, __m128i& sum1 )
+{
+	const __m128i firstLow = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first ) );
+	const __m128i firstHigh = _mm_loadu_si128( reinterpret_cast<const __m128i*>( first + 8 ) );
+	sum0 = _mm_add_epi32( sum0, _mm_madd_epi16( firstLow, second0Low ) );
+	sum0 = _mm_add_epi32( sum0, _mm_madd_epi16( firstHigh, second0High ) );
+	sum1 = _mm_add_epi32( sum1, _mm_madd_epi16( firstLow, second1Low ) );
+	sum1 = _mm_add_epi32( sum1, _mm_madd_epi16( firstHigh, second1High ) );
+}
+
+// Stores the horizontal sums of two registers into result[0] and result[1]
+inline void storeInt8Sums( const __m128i& sum0, const __m128i& sum1, int* result )
+{
+	__m128i sum = _mm_add_epi32( _mm_unpacklo_epi32( sum0, sum1 ), _mm_unpackhi_epi32( sum0, sum1 ) );
+	sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( result ), sum );
+}
+
+// The int8 matrix multiplication micro-kernel: calculates the 4 x 2 block of first * transposed( second )
+// The first matrix contains the int8 values widened to int16 (so that they are loaded only once for all the second rows),
+// the second matrix contains the int8 values which are sign-extended here
+// Both matrices have the rows of rowSize elements, rowSize is a multiple of 16 (the rows are padded with zeros)
+// The result is stored into 4 rows of result with resultRowSize elements
+inline void multiplyInt8Kernel4x2( const short* first, const signed char* second, int rowSize, int* result, int resultRowSize )
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum00 = zero;
+	__m128i sum01 = zero;
+	__m128i sum10 = zero;
+	__m128i sum11 = zero;
+	__m128i sum20 = zero;
+	__m128i sum21 = zero;
+	__m128i sum30 = zero;
+	__m128i sum31 = zero;
+	for( int i = 0; i < rowSize; i += 16 ) {
+		const __m128i second0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( second + i ) );
+		const __m128i second1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( second + rowSize + i ) );
+		// Sign extension to int16
+		const __m128i second0Sign = _mm_cmpgt_epi8( zero, second0 );
+		const __m128i second1Sign = _mm_cmpgt_epi8( zero, second1 );
+		const __m128i second0Low = _mm_unpacklo_epi8( second0, second0Sign );
+		const __m128i second0High = _mm_unpackhi_epi8( second0, second0Sign );
+		const __m128i second1Low = _mm_unpacklo_epi8( second1, second1Sign );
+		const __m128i second1High = _mm_unpackhi_epi8( second1, second1Sign );
+
+		addInt8RowProducts( first + i, second0Low, second0High, second1Low, second1High, sum00, sum01 );
+		addInt8RowProducts( first + rowSize + i, second0Low, second0High, second1Low, second1High, sum10, sum11 );
+		addInt8RowProducts( first + 2 * rowSize + i, second0Low, second0High, second1Low, second1High, sum20, sum21 );
+		addInt8RowProducts( first + 3 * rowSize + i, second0Low, second0High, second1Low, second1High, sum30, sum31 );
+	}
+	storeInt8Sums( sum00, sum01, result );
+	storeInt8Sums( sum10, sum11, result + resultRowSize );
+	storeInt8Sums( sum20, sum21, result + 2 * resultRowSize );
+	storeInt8Sums( sum30, sum31, result + 3 * resultRowSize );
+}
+
+// Returns the maximum absolute value of the vector
+inline float vectorMaxAbs( const float* data, int size )
+{
+	const int sseSize = size / 4;
+	const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+	__m128 maxSse = _mm_setzero_ps();
+	for( int i = 0; i < sseSize; i++ ) {
+		maxSse = _mm_max_ps( maxSse, _mm_and_ps( _mm_loadu_ps( data ), absMask ) );
+		data += 4;
+	}
+
+	float result = _mm_cvtss_f32( HorizontalMaxSse( maxSse ) );
+	for( int i = 4 * sseSize; i < size; i++ ) {
+		const float absValue = *data < 0 ? -*data : *data;
+		result = absValue > result ? absValue : result;
+		data++;
+	}
+	return result;
+}
+
+// Multiplies 4 values by multiplier, saturates them to [-maxValue; maxValue] and rounds half away from zero
+inline __m128i quantizeInt8Sse( const float* data, const __m128& multiplier, const __m128& maxValue )
+{
+	const __m128 signMask = _mm_set1_ps( -0.f );
+	__m128 value = _mm_mul_ps( _mm_loadu_ps( data ), multiplier );
+	value = _mm_max_ps( _mm_min_ps( value, maxValue ), _mm_xor_ps( maxValue, signMask ) );
+	value = _mm_add_ps( value, _mm_or_ps( _mm_and_ps( value, signMask ), _mm_set1_ps( 0.5f ) ) );
+	return _mm_cvttps_epi32( value );
+}
+
+// Quantizes the vector for the int8 micro-kernel: round( data * multiplier ) saturated to [-maxValue; maxValue]
+// The values are rounded half away from zero like std::round and are stored widened to int16
+inline void vectorQuantizeInt8( const float* data, int size, float multiplier, float maxValue, short* result )
+{
+	const int sseSize = size / 8;
+	const __m128 multiplierSse = _mm_set1_ps( multiplier );
+	const __m128 maxValueSse = _mm_set1_ps( maxValue );
+	for( int i = 0; i < sseSize; i++ ) {
+		const __m128i low = quantizeInt8Sse( data, multiplierSse, maxValueSse );
+		const __m128i high = quantizeInt8Sse( data + 4, multiplierSse, maxValueSse );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( result ), _mm_packs_epi32( low, high ) );
+		data += 8;
+		result += 8;
+	}
+
+	for( int i = 8 * sseSize; i < size; i++ ) {
+		float value = *data * multiplier;
+		value = value > maxValue ? maxValue : ( value < -maxValue ? -maxValue : value );
+		*result = static_cast<short>( value + ( value < 0 ? -0.5f : 0.5f ) );
+		data++;
+		result++;
+	}
+}
+
+// Calculates the mean and the variance of the vector in one pass with the Welford algorithm
+// Each register field processes every fourth element, then the fields' statistics are merged
+inline void vectorMeanAndVariance( const float* data, int size, float& mean, float& variance )
+{
+	const int sseSize = size / 4;
+	__m128 meanSse = _mm_setzero_ps();
+	__m128 m2Sse = _mm_setzero_ps();
+	for( int i = 0; i < sseSize; i++ ) {
+		const __m128 value = _mm_loadu_ps( data );
+		const __m128 delta = _mm_sub_ps( value, meanSse );
+		meanSse = _mm_add_ps( meanSse, _mm_mul_ps( delta, _mm_set1_ps( 1.f / ( i + 1 ) ) ) );
+		m2Sse = _mm_add_ps( m2Sse, _mm_mul_ps( delta, _mm_sub_ps( value, meanSse ) ) );
+		data += 4;
+	}
+
+	// Merge the fields: they have the same number of elements
+	float resultMean = 0;
+	float resultM2 = 0;
+	if( sseSize > 0 ) {
+		resultMean = _mm_cvtss_f32( HorizontalAddSse( meanSse ) ) / 4;
+		const __m128 meanDiff = _mm_sub_ps( meanSse, _mm_set1_ps( resultMean ) );
+		resultM2 = _mm_cvtss_f32( HorizontalAddSse( _mm_add_ps( m2Sse,
+			_mm_mul_ps( _mm_mul_ps( meanDiff, meanDiff ), _mm_set1_ps( static_cast<float>( sseSize ) ) ) ) ) );
+	}
+
+	for( int i = 4 * sseSize; i < size; i++ ) {
+		const float delta = *data - resultMean;
+		resultMean += delta / ( i + 1 );
+		resultM2 += delta * ( *data - resultMean );
+		data++;
+	}
+	mean = resultMean;
+	variance = size > 0 ? resultM2 / size : 0.f;
+}
+
+// Normalizes the vector and applies the scale and the bias:
+// normalized = ( input - mean ) * invSqrtVariance, result = normalized * scale + bias
+// normalized may be null; result may be the same as input
+inline void vectorLayerNormalization( const float* input, int size, float mean, float invSqrtVariance,
+	const float* scale, const float* bias, float* normalized, float* result )
+{
+	const __m128 meanSse = _mm_set1_ps( mean );
+	const __m128 invSqrtVarianceSse = _mm_set1_ps( invSqrtVariance );
+	int i = 0;
+	for( ; i + 4 <= size; i += 4 ) {
+		const __m128 norm = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( input + i ), meanSse ), invSqrtVarianceSse );
+		if( normalized != nullptr ) {
+			_mm_storeu_ps( normalized + i, norm );
+		}
+		_mm_storeu_ps( result + i, _mm_add_ps( _mm_mul_ps( norm, _mm_loadu_ps( scale + i ) ), _mm_loadu_ps( bias + i ) ) );
+	}
+	for( ; i < size; i++ ) {
+		const float norm = ( input[i] - mean ) * invSqrtVariance;
+		if( normalized != nullptr ) {
+			normalized[i] = norm;
+		}
+		result[i] = norm * scale[i] + bias[i];
+	}
+}
+
+// The backward pass of the layer normalization for one vector
+// inputDiff = invSqrtVariance * ( g - mean( g ) - normalized * mean( g * normalized ) ), where g = outputDiff * scale
+// inputDiff may be the same as outputDiff
+inline void vectorLayerNormalizationBackward( const float* normalized, const float* outputDiff, const float* scale,
+	int size, float invSqrtVariance, float* inputDiff )
+{
+	__m128 sumSse = _mm_setzero_ps();
+	__m128 dotSse = _mm_setzero_ps();
+	int i = 0;
+	for( ; i + 4 <= size; i += 4 ) {
+		const __m128 g = _mm_mul_ps( _mm_loadu_ps( outputDiff + i ), _mm_loadu_ps( scale + i ) );
+		sumSse = _mm_add_ps( sumSse, g );
+		dotSse = _mm_add_ps( dotSse, _mm_mul_ps( g, _mm_loadu_ps( normalized + i ) ) );
+	}
+	float sum = _mm_cvtss_f32( HorizontalAddSse( sumSse ) );
+	float dot = _mm_cvtss_f32( HorizontalAddSse( dotSse ) );
+	for( ; i < size; i++ ) {
+		const float g = outputDiff[i] * scale[i];
+		sum += g;
+		dot += g * normalized[i];
+	}
+
+	const float negMean = -sum / size;
+	const float negDotMean = -dot / size;
+	const __m128 negMeanSse = _mm_set1_ps( negMean );
+	const __m128 negDotMeanSse = _mm_set1_ps( negDotMean );
+	const __m128 invSqrtVarianceSse = _mm_set1_ps( invSqrtVariance );
+	for( i = 0; i + 4 <= size; i += 4 ) {
+		const __m128 g = _mm_mul_ps( _mm_loadu_ps( outputDiff + i ), _mm_loadu_ps( scale + i ) );
+		const __m128 diff = _mm_add_ps( _mm_add_ps( g, negMeanSse ), _mm_mul_ps( _mm_loadu_ps( normalized + i ), negDotMeanSse ) );
+		_mm_storeu_ps( inputDiff + i, _mm_mul_ps( diff, invSqrtVarianceSse ) );
+	}
+	for( ; i < size; i++ ) {
+		inputDiff[i] = ( outputDiff[i] * scale[i] + negMean + normalized[i] * negDotMean ) * invSqrtVariance;
+	}
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_SSE
@@ -28,12 +28,14 @@ limitations under the License.
 #include <MathEngineDnnConv.h>
 #include <CpuX86MathEngineBlasPrivate.h>
 #include <CpuX86MathEngineVectorMathPrivate.h>
+#include <CpuMathEnginePrivate.h>
 
 namespace NeoML {
 
 void CCpuMathEngine::blob3dConvolution1x1x1(  const CBlobDesc& source, const CBlobDesc& filter, const CBlobDesc& result,
 	int strideHeight, int strideWidth, int strideDepth,
-	const float* sourceData, const float* filterData, const float* freeTermData, float* resultData )
+	const float* sourceData, const float* filterData, const float* freeTermData,
+	const CFusedActivation& activation, float* resultData )
 {
 	static constexpr int goodDenominatorFirst = 2;
 	static constexpr int goodDenominatorSecond = 2;
@@ -63,6 +65,7 @@ void CCpuMathEngine::blob3dConvolution1x1x1(  const CBlobDesc& source, const CBl
 						geomCount, channels, channels,
 						filterData, newChannels, channels,
 						outputDataPtr, newChannels);
+					applyActivation(activation, outputDataPtr, geomCount * newChannels);
 				}
 			}
 		} else {
@@ -88,6 +91,11 @@ void CCpuMathEngine::blob3dConvolution1x1x1(  const CBlobDesc& source, const CBl
 						geomSize, channels, channels,
 						filterData + channelStart * channels, channelCount, channels,
 						resultData + channelStart, newChannels);
+					if( activation.Type != AF_Linear ) {
+						for( float* res = resultPtr; res < resultEnd; res += newChannels ) {
+							applyActivation(activation, res, channelCount);
+						}
+					}
 				}
 			}
 		}
@@ -126,6 +134,7 @@ void CCpuMathEngine::blob3dConvolution1x1x1(  const CBlobDesc& source, const CBl
 					geomCount, channels, channels,
 					filterData, newChannels, channels,
 					outputDataPtr, newChannels);
+				applyActivation(activation, outputDataPtr, geomCount * newChannels);
 		}
 	}
 }
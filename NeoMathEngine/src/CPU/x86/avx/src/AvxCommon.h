@@ -17,6 +17,24 @@ limitations under the License.
 
 #include <immintrin.h>
 
+// The library is compiled for AVX2, so the AVX-512 functions need their own target
+// They must be called only if CCPUInfo::IsAvx512Available() returns true
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define AVX512_TARGET __attribute__( ( target( "avx512f" ) ) )
+#else
+#define AVX512_TARGET
+#endif
+
+// The integer functions need their own targets too: AVX2 is available whenever the library is loaded,
+// AVX512BW must be checked with CCPUInfo::IsAvx512BwAvailable()
+#if defined( __GNUC__ ) || defined( __clang__ )
+#define AVX2_TARGET __attribute__( ( target( "avx2" ) ) )
+#define AVX512BW_TARGET __attribute__( ( target( "avx512f,avx512bw" ) ) )
+#else
+#define AVX2_TARGET
+#define AVX512BW_TARGET
+#endif
+
 #define PERMUTE2( p1, p0 ) ( ( p0 << 0 ) + ( p1 << 4 ) )
 #define PERMUTE4( p3, p2, p1, p0 ) ( ( p0 << 0 ) + ( p1 << 2 ) + ( p2 << 4 ) + ( p3 << 6 ) )
 #define PERMUTE8( p7, p6, p5, p4, p3, p2, p1, p0 ) _mm256_set_epi32( p7, p6, p5, p4, p3, p2, p1, p0 )
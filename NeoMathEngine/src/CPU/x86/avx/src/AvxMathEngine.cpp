@@ -20,6 +20,7 @@ limitations under the License.
 #include <BlobConvolution.h>
 #include <PrimitivesJit.h>
 #include <CPUInfo.h>
+#include <Int8Multiply.h>
 
 namespace NeoML {
 
@@ -30,6 +31,13 @@ void AvxMultiplyMatrix( bool transA, bool transB,
 	float* cPtr, size_t cRowSize,
 	size_t m, size_t n, size_t k );
 
+void Avx512MultiplyMatrix( bool transA, bool transB,
+	IMathEngine *engine,
+	const float* aPtr, size_t aRowSize,
+	const float* bPtr, size_t bRowSize,
+	float* cPtr, size_t cRowSize,
+	size_t m, size_t n, size_t k );
+
 struct CAvxConvolutionDesc : public CConvolutionDesc {
 	~CAvxConvolutionDesc() override = default;
 
@@ -51,16 +59,18 @@ CAvxConvolutionDesc::CAvxConvolutionDesc( IMathEngine* mathEngine, const CBlobDe
 class CAvxMathEngine : public ISimdMathEngine {
 public:
 	CAvxMathEngine( IMathEngine* _mathEngine, int _threadCount ) :
-		mathEngine( _mathEngine ), threadCount( _threadCount ), primitives( _mathEngine, _threadCount ) {}
+		mathEngine( _mathEngine ), threadCount( _threadCount ), isAvx512Available( CCPUInfo::IsAvx512Available() ),
+		primitives( _mathEngine, _threadCount ) {}
 
 	CConvolutionDesc* InitBlobConvolution( const CBlobDesc& source, int paddingHeight, int paddingWidth,
 		int strideHeight, int strideWidth, int dilationHeight, int dilationWidth, const CBlobDesc& filter,
 		const CBlobDesc& result ) const override;
 
 	void BlobConvolution( const CConvolutionDesc& convDesc, const float* source,
-		const float* filter, const float* freeTerm, float* result ) const override;
+		const float* filter, const float* freeTerm, const CFusedActivation& activation, float* result ) const override;
 
 	SgemmFunc GetSgemmFunction() const override;
+	Int8MultiplyFunc GetInt8MultiplyFunction() const override;
 
 	void Tanh( float* dst, const float* src, size_t dataSize, bool isMultithread ) override;
 	void Sigmoid( float* dst, const float* src, size_t dataSize, bool isMultithread ) override;
@@ -71,6 +81,8 @@ public:
 private:
 	IMathEngine* mathEngine;
 	int threadCount;
+	// zmm kernels are used for sgemm and convolution when available
+	const bool isAvx512Available;
 	CPrimitivesJit primitives;
 };
 
@@ -78,26 +90,34 @@ CConvolutionDesc* CAvxMathEngine::InitBlobConvolution( const CBlobDesc& source,
 	int strideHeight, int strideWidth, int dilationHeight, int dilationWidth, const CBlobDesc& filter,
 	const CBlobDesc& result ) const
 {
-	if( !CCPUInfo::IsAvx512Available()
-		&& CBlobConvolutionFabric::IsBlobConvolutionAvailable( filter.BatchWidth() , filter.Height(), filter.Width() ) )
-	{
+	// On AVX-512 CPUs only the kernels with zmm registers are faster than the default implementation
+	const bool isJitAvailable = isAvx512Available ?
+		CBlobConvolutionFabric::IsAvx512BlobConvolutionAvailable( filter.BatchWidth(), filter.Height(), filter.Width() ) :
+		CBlobConvolutionFabric::IsBlobConvolutionAvailable( filter.BatchWidth(), filter.Height(), filter.Width() );
+	if( isJitAvailable ) {
 		return new CAvxConvolutionDesc( mathEngine, source, result, filter, paddingHeight, paddingWidth, strideHeight, strideWidth, dilationHeight, dilationWidth );
 	}
 	return nullptr;
 }
 
 void CAvxMathEngine::BlobConvolution( const CConvolutionDesc& convDesc, const float* source,
-	const float* filter, const float* freeTerm, float* result ) const
+	const float* filter, const float* freeTerm, const CFusedActivation& activation, float* result ) const
 {
 	const CAvxConvolutionDesc& desc = static_cast<const CAvxConvolutionDesc&>( convDesc );
 	
-	desc.BlobConvolution->ProcessConvolution( threadCount, source, filter, freeTerm, result );
+	desc.BlobConvolution->ProcessConvolution( threadCount, source, filter, freeTerm, activation, result );
 
 }
 
 SgemmFunc CAvxMathEngine::GetSgemmFunction() const
 {
-	return AvxMultiplyMatrix;
+	return isAvx512Available ? Avx512MultiplyMatrix : AvxMultiplyMatrix;
+}
+
+Int8MultiplyFunc CAvxMathEngine::GetInt8MultiplyFunction() const
+{
+	// The zmm integer instructions need AVX512BW in addition to AVX512F
+	return CCPUInfo::IsAvx512BwAvailable() ? Avx512MultiplyInt8 : AvxMultiplyInt8;
 }
 
 void CAvxMathEngine::Tanh( float* dst, const float* src, size_t dataSize, bool isMultithread )
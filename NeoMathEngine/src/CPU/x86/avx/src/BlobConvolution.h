@@ -23,6 +23,8 @@ limitations under the License.
 
 #include <NeoMathEngine/NeoMathEngine.h>
 #include <JitCommon.h>
+#include <AvxCommon.h>
+#include <CPUInfo.h>
 
 namespace NeoML {
 
@@ -31,7 +33,8 @@ using reg64_t = Xbyak::Reg64;
 class CBlobConvolutionBase : public CCrtAllocatedObject {
 public:
     virtual ~CBlobConvolutionBase() = default;
-    virtual void ProcessConvolution( int threadCount, const float* sourceData, const float* filterData, const float* freeTermData, float* resultData ) = 0;
+    virtual void ProcessConvolution( int threadCount, const float* sourceData, const float* filterData, const float* freeTermData,
+        const CFusedActivation& activation, float* resultData ) = 0;
 };
 
 template<int FltCnt>
@@ -44,8 +47,8 @@ public:
         int dilationHeight, int dilationWidth, int resultHeight, int resultWidth, int resObjCnt );
     ~CBlobConvolution() override = default;
 
-    void ProcessConvolution( int threadCount,
-        const float* sourceData, const float* filterData, const float* freeTermData, float* resultData ) override;
+    void ProcessConvolution( int threadCount, const float* sourceData, const float* filterData, const float* freeTermData,
+        const CFusedActivation& activation, float* resultData ) override;
 
 private:
     struct CSize {
@@ -95,12 +98,19 @@ private:
         void fillBatchProcessingKernel( CBlobConvolution<FltCnt>& bc, bool useNarrowProcessing, size_t windowIndex );
         void fillSingleProcessingKernel( CBlobConvolution<FltCnt>& bc, bool useNarrowProcessing, size_t windowIndex );
 
+        // Kernels with zmm registers, used when UseAvx512 is set
+        void fillBatchProcessingKernelAvx512( CBlobConvolution<FltCnt>& bc, size_t windowIndex );
+        void fillSingleProcessingKernelAvx512( CBlobConvolution<FltCnt>& bc, size_t windowIndex );
+
         // Initialize result registers with data from freeTerm (if it isn't nullptr)
         void initResRegs( size_t stepCount, size_t stepSize );
         // Flush result registers
         // 'fillKernel' will be called for filling of kernel in main loop
         // 'callBeforeFlush' will be called before flushing of result registers. It can be captured labda function.
         void flushResRegs( CBlobConvolution<FltCnt>& bc, size_t stepCount, size_t stepSize, bool useNarrowProcessing );
+        // The same for zmm registers: each result pixel takes FltCntZmmCount consecutive registers
+        void initResRegsAvx512( size_t regCount );
+        void flushResRegsAvx512( size_t regCount );
         void initProcessingMainLoop( CBlobConvolution<FltCnt>& bc,
             size_t stepCount, size_t stepSize, int batchChannelSize, const std::function<void( int )>& fillKernel,
             size_t windowIndex, bool useNarrowProcessing = false, const std::function<void()>* callBeforeFlush = nullptr );
@@ -124,11 +134,17 @@ private:
     const int ResH;
     const int ResW;
     const int ResObjCnt;
+    // The zmm kernels are used if AVX-512 is available and FltCnt is a multiple of the zmm register size
+    const bool UseAvx512;
     bool jitIsInited;
 
     // For some cases we will use FltCnt, rounded up to nearest integer multiple of 8
     static constexpr int FltCntM8 = ( FltCnt + 8 - 1 ) / 8 * 8;
     static constexpr size_t AvxAlignment = 32;
+    // Number of zmm registers for one result pixel (used only if FltCnt is a multiple of 16)
+    static constexpr int FltCntZmmCount = ( FltCnt + NumFloatInZmm - 1 ) / NumFloatInZmm;
+    // Number of zmm registers with results in the batch kernel
+    static constexpr int Avx512ResRegCount = 12;
 
     const float* src;
     const float* flt;
@@ -198,6 +214,8 @@ const int CBlobConvolution<FltCnt>::NarrowBatchKernelWidth = INT_MAX;
 class CBlobConvolutionFabric : public CCrtAllocatedObject {
 public:
     static bool IsBlobConvolutionAvailable( int FltCnt, int FltH, int FltW );
+    // The convolutions which have the kernels with zmm registers
+    static bool IsAvx512BlobConvolutionAvailable( int FltCnt, int FltH, int FltW );
     static std::unique_ptr<CBlobConvolutionBase> GetProperInstance(
         IMathEngine* mathEngine, int FltCnt,
         int channelCount, int filterHeight, int filterWidth, int sourceHeight, int sourceWidth,
@@ -216,4 +234,5 @@ public:
 #include <BlobConvolution_jit_FltCnt_16.inl>
 #include <BlobConvolution_jit_FltCnt_18.inl>
 #include <BlobConvolution_jit_FltCnt_24.inl>
-#include <BlobConvolution_jit_FltCnt_32.inl>
\ No newline at end of file
+#include <BlobConvolution_jit_FltCnt_32.inl>
+#include <BlobConvolution_jit_Avx512.inl>
\ No newline at end of file
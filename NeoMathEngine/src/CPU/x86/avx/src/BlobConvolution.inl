@@ -33,6 +33,11 @@ bool CBlobConvolutionFabric::IsBlobConvolutionAvailable( int FltCnt, int FltH, i
     return false;
 }
 
+bool CBlobConvolutionFabric::IsAvx512BlobConvolutionAvailable( int FltCnt, int FltH, int FltW )
+{
+    return FltCnt % NumFloatInZmm == 0 && IsBlobConvolutionAvailable( FltCnt, FltH, FltW );
+}
+
 std::unique_ptr<CBlobConvolutionBase> CBlobConvolutionFabric::GetProperInstance(
     IMathEngine* mathEngine, int filterCount,
     int channelCount, int filterHeight, int filterWidth, int sourceHeight, int sourceWidth,
@@ -109,6 +114,7 @@ CBlobConvolution<FltCnt>::CBlobConvolution(
     ResH( resultHeight ),
     ResW( resultWidth ),
     ResObjCnt( resObjCnt ),
+    UseAvx512( FltCnt % NumFloatInZmm == 0 && CCPUInfo::IsAvx512Available() ),
     jitIsInited( false ),
     src( nullptr ),
     flt( nullptr ),
@@ -128,9 +134,32 @@ CBlobConvolution<FltCnt>::CBlobConvolution(
     fillPixelOffset();
 }
 
+// Applies the fused activation to the calculated part of the result
+static inline void applyActivation( const CFusedActivation& activation, float* data, size_t size )
+{
+    if( activation.Type != AF_ReLU ) {
+        return;
+    }
+    const bool hasThreshold = activation.Param > 0;
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 threshold = _mm256_set1_ps( activation.Param );
+    size_t i = 0;
+    for( ; i + 8 <= size; i += 8 ) {
+        __m256 value = _mm256_max_ps( _mm256_loadu_ps( data + i ), zero );
+        if( hasThreshold ) {
+            value = _mm256_min_ps( value, threshold );
+        }
+        _mm256_storeu_ps( data + i, value );
+    }
+    for( ; i < size; i++ ) {
+        const float value = std::max( data[i], 0.f );
+        data[i] = hasThreshold ? std::min( value, activation.Param ) : value;
+    }
+}
+
 template<int FltCnt>
-void CBlobConvolution<FltCnt>::ProcessConvolution(
-    int threadCount, const float* sourceData, const float* filterData, const float* freeTermData, float* resultData )
+void CBlobConvolution<FltCnt>::ProcessConvolution( int threadCount, const float* sourceData, const float* filterData,
+    const float* freeTermData, const CFusedActivation& activation, float* resultData )
 {
     CFloatHandleStackVar filterTempBuffer( *mathEngine, FltW * FltH * FltCntM8 * ChCnt );
     CFloatHandleStackVar freeTermTempBuffer( *mathEngine, FltCntM8 );
@@ -195,8 +224,11 @@ void CBlobConvolution<FltCnt>::ProcessConvolution(
                         bool useNarrowProcessing = ryEnd - ry >= NarrowBatchProcessSize.Height;
 
                         jitCodes[yStepIndex]->Run( useNarrowProcessing, srcPtr, flt, freeTerm, resPtr );
-                        
-                        ry += useNarrowProcessing ? NarrowBatchProcessSize.Height : WideBatchProcessSize.Height;
+
+                        const int rowsProcessed = useNarrowProcessing ? NarrowBatchProcessSize.Height : WideBatchProcessSize.Height;
+                        // The rows are activated while they are in cache
+                        applyActivation( activation, resPtr, rowsProcessed * ResLineStride );
+                        ry += rowsProcessed;
                     }
                 }
             }
@@ -207,6 +239,9 @@ void CBlobConvolution<FltCnt>::ProcessConvolution(
 template<int FltCnt>
 inline typename CBlobConvolution<FltCnt>::CSize CBlobConvolution<FltCnt>::getWideBatchProcessSize()
 {
+    if( UseAvx512 ) {
+        return { 1, Avx512ResRegCount / FltCntZmmCount };
+    }
     return { WideBatchKernelHeight, WideBatchKernelWidth };
 }
 
@@ -214,6 +249,9 @@ template<int FltCnt>
 inline typename CBlobConvolution<FltCnt>::CSize CBlobConvolution<FltCnt>::getNarrowBatchProcessSize()
 {
     // Disable narrow processing by default
+    if( UseAvx512 ) {
+        return { INT_MAX, INT_MAX };
+    }
     return { NarrowBatchKernelHeight, NarrowBatchKernelWidth };
 }
 
@@ -0,0 +1,141 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+// CBlobConvolution kernels with zmm registers
+// Used when AVX-512 is available and FltCnt is a multiple of 16 (see UseAvx512).
+// Result registers are filled pixel by pixel, FltCntZmmCount registers per pixel, so there are no partial stores
+// and no shifts of the registers. Narrow processing isn't used.
+
+namespace NeoML {
+
+template<int FltCnt>
+inline void CBlobConvolution<FltCnt>::CJitConvolution::fillBatchProcessingKernelAvx512( CBlobConvolution<FltCnt>& bc, size_t windowIndex )
+{
+    using namespace Xbyak;
+
+    const int StepCount = bc.WideBatchProcessSize.Width;
+    const int StepSize = FltCntZmmCount;
+    const int BatchChannelSize = 4;
+
+    // zmm0 - zmm11 contain the result
+    const int SrcRegStart = 24;
+    const int SrcRegCount = 4;
+    const int FltRegStart = 28;
+
+    std::function<void( int )> fillKernel( [&]( int channelCount ) {
+        for( int i = 0; i < channelCount; i++ ) {
+            size_t fltOffset = i * FltCntM8 * sizeof( float );
+            size_t srcOffset = i * sizeof( float );
+            // Load one channel for the same pixel as in source for all filters.
+            // Neighbour channels use different registers in order not to wait for the previous channel.
+            const int fltReg = FltRegStart + ( i % 2 ) * StepSize;
+            for( int j = 0; j < StepSize; j++ ) {
+                vmovups( Zmm( fltReg + j ), ptr[regTempFltPtr + fltOffset + j * SizeOfZmm] );
+            }
+            for( int p = 0; p < StepCount; p++ ) {
+                // Load one channel from one pixel in sequenced windows and fill one zmm register with its value.
+                const Zmm src( SrcRegStart + p % SrcRegCount );
+                vbroadcastss( src, ptr[regTempSrcPtr + srcOffset + p * bc.SrcXStep * sizeof( float )] );
+                for( int j = 0; j < StepSize; j++ ) {
+                    vfmadd231ps( Zmm( p * StepSize + j ), Zmm( fltReg + j ), src );
+                }
+            }
+        }
+        } );
+
+    initProcessingMainLoop( bc, StepCount, StepSize, BatchChannelSize, fillKernel, windowIndex );
+}
+
+template<int FltCnt>
+inline void CBlobConvolution<FltCnt>::CJitConvolution::fillSingleProcessingKernelAvx512( CBlobConvolution<FltCnt>& bc, size_t windowIndex )
+{
+    using namespace Xbyak;
+
+    const int StepCount = 1;
+    const int StepSize = FltCntZmmCount;
+    const int BatchChannelSize = 8;
+
+    // The channels are accumulated in several independent groups of registers in order to hide the latency of fma.
+    // The first group contains the result, other groups are merged into it before flush.
+    const int AccGroupCount = 4;
+    const int SrcRegStart = 24;
+    const int SrcRegCount = 4;
+
+    for( int g = 1; g < AccGroupCount; g++ ) {
+        for( int j = 0; j < StepSize; j++ ) {
+            const Zmm acc( g * StepSize + j );
+            vpxord( acc, acc, acc );
+        }
+    }
+    std::function<void()> mergeResRegs( [&]() {
+        for( int g = 1; g < AccGroupCount; g++ ) {
+            for( int j = 0; j < StepSize; j++ ) {
+                vaddps( Zmm( j ), Zmm( j ), Zmm( g * StepSize + j ) );
+            }
+        }
+    } );
+
+    std::function<void( int )> fillKernel( [&]( int channelCount ) {
+        PRESUME_EXPR( channelCount <= BatchChannelSize );
+        for( int i = 0; i < channelCount; i++ ) {
+            const Zmm src( SrcRegStart + i % SrcRegCount );
+            vbroadcastss( src, ptr[regTempSrcPtr + i * sizeof( float )] );
+            for( int j = 0; j < StepSize; j++ ) {
+                vfmadd231ps( Zmm( ( i % AccGroupCount ) * StepSize + j ), src,
+                    ptr[regTempFltPtr + i * FltCntM8 * sizeof( float ) + j * SizeOfZmm] );
+            }
+        }
+        } );
+
+    initProcessingMainLoop( bc, StepCount, StepSize, BatchChannelSize, fillKernel,
+        windowIndex, false, &mergeResRegs );
+}
+
+template<int FltCnt>
+inline void CBlobConvolution<FltCnt>::CJitConvolution::initResRegsAvx512( size_t regCount )
+{
+    using namespace Xbyak;
+
+    Label labelFillWithZeroes, labelEnd;
+    test( regFreeTermPtr, regFreeTermPtr );
+    jz( labelFillWithZeroes, T_NEAR );
+
+    // Load free term for the first pixel and copy it to the others
+    for( int i = 0; i < FltCntZmmCount; i++ ) {
+        vmovups( Zmm( i ), ptr[regFreeTermPtr + i * SizeOfZmm] );
+    }
+    for( int i = FltCntZmmCount; i < static_cast<int>( regCount ); i++ ) {
+        vmovaps( Zmm( i ), Zmm( i % FltCntZmmCount ) );
+    }
+    jmp( labelEnd, T_NEAR );
+
+    L( labelFillWithZeroes );
+    for( int i = 0; i < static_cast<int>( regCount ); i++ ) {
+        vpxord( Zmm( i ), Zmm( i ), Zmm( i ) );
+    }
+    L( labelEnd );
+}
+
+template<int FltCnt>
+inline void CBlobConvolution<FltCnt>::CJitConvolution::flushResRegsAvx512( size_t regCount )
+{
+    using namespace Xbyak;
+
+    for( int i = 0; i < static_cast<int>( regCount ); i++ ) {
+        vmovups( ptr[regResPtr + i * SizeOfZmm], Zmm( i ) );
+    }
+}
+
+} // namespace NeoML
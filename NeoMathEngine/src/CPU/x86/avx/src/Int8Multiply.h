@@ -0,0 +1,126 @@
+/* Copyright © 2017-2021 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <AvxCommon.h>
+
+namespace NeoML {
+
+// The int8 micro-kernels calculate the 4 x 2 block of first * transposed( second )
+// The first rows contain the int8 values widened to int16, the second rows are sign-extended with vpmovsxbw
+// and the products are summed up with vpmaddwd
+
+// Stores the horizontal sums of two registers into result[0] and result[1]
+AVX2_TARGET inline void storeInt8SumsAvx( const __m256i& sum0, const __m256i& sum1, int* result )
+{
+	const __m256i sum = _mm256_add_epi32( _mm256_unpacklo_epi32( sum0, sum1 ), _mm256_unpackhi_epi32( sum0, sum1 ) );
+	__m128i sum128 = _mm_add_epi32( _mm256_castsi256_si128( sum ), _mm256_extracti128_si256( sum, 1 ) );
+	sum128 = _mm_add_epi32( sum128, _mm_shuffle_epi32( sum128, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+	_mm_storel_epi64( reinterpret_cast<__m128i*>( result ), sum128 );
+}
+
+// The ymm micro-kernel, processes the rows by 16 values
+AVX2_TARGET inline void multiplyInt8Kernel4x2Avx( const short* first, const signed char* second, int rowSize,
+	int* result, int resultRowSize )
+{
+	__m256i sum00 = _mm256_setzero_si256();
+	__m256i sum01 = _mm256_setzero_si256();
+	__m256i sum10 = _mm256_setzero_si256();
+	__m256i sum11 = _mm256_setzero_si256();
+	__m256i sum20 = _mm256_setzero_si256();
+	__m256i sum21 = _mm256_setzero_si256();
+	__m256i sum30 = _mm256_setzero_si256();
+	__m256i sum31 = _mm256_setzero_si256();
+	for( int i = 0; i < rowSize; i += 16 ) {
+		const __m256i second0 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( second + i ) ) );
+		const __m256i second1 = _mm256_cvtepi8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( second + rowSize + i ) ) );
+
+		__m256i firstRow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first + i ) );
+		sum00 = _mm256_add_epi32( sum00, _mm256_madd_epi16( firstRow, second0 ) );
+		sum01 = _mm256_add_epi32( sum01, _mm256_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first + rowSize + i ) );
+		sum10 = _mm256_add_epi32( sum10, _mm256_madd_epi16( firstRow, second0 ) );
+		sum11 = _mm256_add_epi32( sum11, _mm256_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first + 2 * rowSize + i ) );
+		sum20 = _mm256_add_epi32( sum20, _mm256_madd_epi16( firstRow, second0 ) );
+		sum21 = _mm256_add_epi32( sum21, _mm256_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( first + 3 * rowSize + i ) );
+		sum30 = _mm256_add_epi32( sum30, _mm256_madd_epi16( firstRow, second0 ) );
+		sum31 = _mm256_add_epi32( sum31, _mm256_madd_epi16( firstRow, second1 ) );
+	}
+	storeInt8SumsAvx( sum00, sum01, result );
+	storeInt8SumsAvx( sum10, sum11, result + resultRowSize );
+	storeInt8SumsAvx( sum20, sum21, result + 2 * resultRowSize );
+	storeInt8SumsAvx( sum30, sum31, result + 3 * resultRowSize );
+}
+
+// The zmm micro-kernel, processes the rows by 32 values
+AVX512BW_TARGET inline void multiplyInt8Kernel4x2Avx512( const short* first, const signed char* second, int rowSize,
+	int* result, int resultRowSize )
+{
+	__m512i sum00 = _mm512_setzero_si512();
+	__m512i sum01 = _mm512_setzero_si512();
+	__m512i sum10 = _mm512_setzero_si512();
+	__m512i sum11 = _mm512_setzero_si512();
+	__m512i sum20 = _mm512_setzero_si512();
+	__m512i sum21 = _mm512_setzero_si512();
+	__m512i sum30 = _mm512_setzero_si512();
+	__m512i sum31 = _mm512_setzero_si512();
+	for( int i = 0; i < rowSize; i += 32 ) {
+		const __m512i second0 = _mm512_cvtepi8_epi16( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( second + i ) ) );
+		const __m512i second1 = _mm512_cvtepi8_epi16( _mm256_loadu_si256( reinterpret_cast<const __m256i*>( second + rowSize + i ) ) );
+
+		__m512i firstRow = _mm512_loadu_si512( first + i );
+		sum00 = _mm512_add_epi32( sum00, _mm512_madd_epi16( firstRow, second0 ) );
+		sum01 = _mm512_add_epi32( sum01, _mm512_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm512_loadu_si512( first + rowSize + i );
+		sum10 = _mm512_add_epi32( sum10, _mm512_madd_epi16( firstRow, second0 ) );
+		sum11 = _mm512_add_epi32( sum11, _mm512_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm512_loadu_si512( first + 2 * rowSize + i );
+		sum20 = _mm512_add_epi32( sum20, _mm512_madd_epi16( firstRow, second0 ) );
+		sum21 = _mm512_add_epi32( sum21, _mm512_madd_epi16( firstRow, second1 ) );
+		firstRow = _mm512_loadu_si512( first + 3 * rowSize + i );
+		sum30 = _mm512_add_epi32( sum30, _mm512_madd_epi16( firstRow, second0 ) );
+		sum31 = _mm512_add_epi32( sum31, _mm512_madd_epi16( firstRow, second1 ) );
+	}
+	// Add the halves of zmm registers and use the same reduction as the ymm kernel
+	#define NEOML_INT8_ZMM_HALVES_SUM( sum ) \
+		_mm256_add_epi32( _mm512_castsi512_si256( sum ), _mm512_extracti64x4_epi64( sum, 1 ) )
+	storeInt8SumsAvx( NEOML_INT8_ZMM_HALVES_SUM( sum00 ), NEOML_INT8_ZMM_HALVES_SUM( sum01 ), result );
+	storeInt8SumsAvx( NEOML_INT8_ZMM_HALVES_SUM( sum10 ), NEOML_INT8_ZMM_HALVES_SUM( sum11 ), result + resultRowSize );
+	storeInt8SumsAvx( NEOML_INT8_ZMM_HALVES_SUM( sum20 ), NEOML_INT8_ZMM_HALVES_SUM( sum21 ), result + 2 * resultRowSize );
+	storeInt8SumsAvx( NEOML_INT8_ZMM_HALVES_SUM( sum30 ), NEOML_INT8_ZMM_HALVES_SUM( sum31 ), result + 3 * resultRowSize );
+	#undef NEOML_INT8_ZMM_HALVES_SUM
+}
+
+// The implementations of Int8MultiplyFunc
+AVX2_TARGET inline void AvxMultiplyInt8( const short* first, const signed char* second, int secondCount, int rowSize,
+	int* result, int resultRowSize )
+{
+	for( int j = 0; j < secondCount; j += 2 ) {
+		multiplyInt8Kernel4x2Avx( first, second + static_cast<size_t>( j ) * rowSize, rowSize, result + j, resultRowSize );
+	}
+}
+
+AVX512BW_TARGET inline void Avx512MultiplyInt8( const short* first, const signed char* second, int secondCount, int rowSize,
+	int* result, int resultRowSize )
+{
+	for( int j = 0; j < secondCount; j += 2 ) {
+		multiplyInt8Kernel4x2Avx512( first, second + static_cast<size_t>( j ) * rowSize, rowSize, result + j, resultRowSize );
+	}
+}
+
+} // namespace NeoML
@@ -28,6 +28,7 @@ limitations under the License.
 #include <Kernel_AVX_6x4.h>
 #include <Kernel_AVX_6x2.h>
 #include <Kernel_AVX_6x1.h>
+#include <Kernel_AVX512_6x32.h>
 
 namespace NeoML {
 
@@ -36,6 +37,14 @@ using CKernelCombi_8 = CKernelCombineHorizontal<CMicroKernel_6x16, CMicroKernel_
 using CKernelCombi_4 = CKernelCombineHorizontal<CMicroKernel_6x16, CMicroKernel_6x8, CMicroKernel_6x4>;
 using CKernelCombi_full = CKernelCombineHorizontal<CMicroKernel_6x16, CMicroKernel_6x8, CMicroKernel_6x4, CMicroKernel_6x2, CMicroKernel_6x1>;
 
+// AVX-512 combinations: the widest kernel uses zmm registers, the tails are processed by AVX2 kernels
+using CKernelCombiAvx512_32 = CKernelCombineHorizontal<CMicroKernelAvx512_6x32>;
+using CKernelCombiAvx512_16 = CKernelCombineHorizontal<CMicroKernelAvx512_6x32, CMicroKernel_6x16>;
+using CKernelCombiAvx512_8 = CKernelCombineHorizontal<CMicroKernelAvx512_6x32, CMicroKernel_6x16, CMicroKernel_6x8>;
+using CKernelCombiAvx512_4 = CKernelCombineHorizontal<CMicroKernelAvx512_6x32, CMicroKernel_6x16, CMicroKernel_6x8, CMicroKernel_6x4>;
+using CKernelCombiAvx512_full = CKernelCombineHorizontal<CMicroKernelAvx512_6x32, CMicroKernel_6x16, CMicroKernel_6x8,
+	CMicroKernel_6x4, CMicroKernel_6x2, CMicroKernel_6x1>;
+
 template< class Kernel>
 void AvxMultiplyMatrixSelected( bool transA, bool transB,
 	IMathEngine *engine,
@@ -96,4 +105,43 @@ void AvxMultiplyMatrix( bool transA, bool transB,
 	}
 }
 
+// Must be called only if CCPUInfo::IsAvx512Available() returns true
+void Avx512MultiplyMatrix( bool transA, bool transB,
+	IMathEngine *engine,
+	const float* aPtr, size_t aRowSize,
+	const float* bPtr, size_t bRowSize,
+	float* cPtr, size_t cRowSize,
+	size_t m, size_t n, size_t k )
+{
+	// The same selection as in AvxMultiplyMatrix, but over the doubled width of the main kernel
+	switch( n % 32 ) {
+	case 3:
+	case 11:
+	case 19:
+	case 27:
+		AvxMultiplyMatrixSelected<CKernelCombiAvx512_4>( transA, transB, engine, aPtr, aRowSize, bPtr, bRowSize, cPtr, cRowSize, m, n, k );
+		break;
+	case 5:
+	case 6:
+	case 7:
+	case 21:
+	case 22:
+	case 23:
+		AvxMultiplyMatrixSelected<CKernelCombiAvx512_8>( transA, transB, engine, aPtr, aRowSize, bPtr, bRowSize, cPtr, cRowSize, m, n, k );
+		break;
+	case 13:
+	case 14:
+	case 15:
+		AvxMultiplyMatrixSelected<CKernelCombiAvx512_16>( transA, transB, engine, aPtr, aRowSize, bPtr, bRowSize, cPtr, cRowSize, m, n, k );
+		break;
+	case 29:
+	case 30:
+	case 31:
+		AvxMultiplyMatrixSelected<CKernelCombiAvx512_32>( transA, transB, engine, aPtr, aRowSize, bPtr, bRowSize, cPtr, cRowSize, m, n, k );
+		break;
+	default:
+		AvxMultiplyMatrixSelected<CKernelCombiAvx512_full>( transA, transB, engine, aPtr, aRowSize, bPtr, bRowSize, cPtr, cRowSize, m, n, k );
+	}
+}
+
 }
@@ -442,3 +442,87 @@ struct CInterleaverBase<true, 6> {
 		}
 	}
 };
+
+//// Prepare and transpose the matrix
+// Used by the AVX-512 kernels; each 32-row block is transposed by 8x8 tiles
+template<>
+struct CInterleaverBase<true, 32> {
+	static void Prepare( float* out, const float* in, size_t stride, size_t width, size_t height )
+	{
+		const int Len = 32;
+
+		const size_t iStep = stride * Len;
+		const size_t oStep = width * Len;
+
+		for( ; height >= Len; height -= Len ) {
+			const float* tempIn = in;
+			float* tempOut = out;
+			size_t tempWidth = width;
+			for( ; tempWidth >= 8; tempWidth -= 8 ) {
+				for( int i = 0; i < Len; i += 8 ) {
+					transpose8x8( tempOut + i, Len, tempIn + i * stride, stride );
+				}
+				tempIn += 8;
+				tempOut += 8 * Len;
+			}
+
+			if( tempWidth != 0 ) {
+				CInterleaverBase<false, 1>::Transpose( tempOut, Len, tempIn, stride, Len, tempWidth );
+			}
+
+			in += iStep;
+			out += oStep;
+		}
+		height %= Len;
+		if( height > 0 ) {
+			CInterleaverBase<false, 1>::Transpose(out, Len, in, stride, height, width);
+			out += height;
+			const size_t len = (Len - height) * sizeof(float);
+			for( ; width > 0; --width ) {
+				memset(out, 0, len);
+				out += Len;
+			}
+		}
+	}
+
+private:
+	// Transposes 8x8 block, the same permutations as in CInterleaverBase<true, 8>
+	static void transpose8x8( float* out, size_t oStride, const float* in, size_t iStride )
+	{
+		__m256 a = _mm256_loadu_ps( in );
+		__m256 b = _mm256_loadu_ps( in + iStride );
+		__m256 c = _mm256_loadu_ps( in + 2 * iStride );
+		__m256 d = _mm256_loadu_ps( in + 3 * iStride );
+		__m256 e = _mm256_loadu_ps( in + 4 * iStride );
+		__m256 f = _mm256_loadu_ps( in + 5 * iStride );
+		__m256 j = _mm256_loadu_ps( in + 6 * iStride );
+		__m256 h = _mm256_loadu_ps( in + 7 * iStride );
+
+		__m256d ab0145 = _mm256_castps_pd( _mm256_unpacklo_ps( a, b ) );
+		__m256d cd0145 = _mm256_castps_pd( _mm256_unpacklo_ps( c, d ) );
+		__m256d ef0145 = _mm256_castps_pd( _mm256_unpacklo_ps( e, f ) );
+		__m256d jh0145 = _mm256_castps_pd( _mm256_unpacklo_ps( j, h ) );
+		__m256d ab2367 = _mm256_castps_pd( _mm256_unpackhi_ps( a, b ) );
+		__m256d cd2367 = _mm256_castps_pd( _mm256_unpackhi_ps( c, d ) );
+		__m256d ef2367 = _mm256_castps_pd( _mm256_unpackhi_ps( e, f ) );
+		__m256d jh2367 = _mm256_castps_pd( _mm256_unpackhi_ps( j, h ) );
+
+		__m256d abcd04 = _mm256_unpacklo_pd( ab0145, cd0145 );
+		__m256d efjh04 = _mm256_unpacklo_pd( ef0145, jh0145 );
+		__m256d abcd15 = _mm256_unpackhi_pd( ab0145, cd0145 );
+		__m256d efjh15 = _mm256_unpackhi_pd( ef0145, jh0145 );
+		__m256d abcd26 = _mm256_unpacklo_pd( ab2367, cd2367 );
+		__m256d efjh26 = _mm256_unpacklo_pd( ef2367, jh2367 );
+		__m256d abcd37 = _mm256_unpackhi_pd( ab2367, cd2367 );
+		__m256d efjh37 = _mm256_unpackhi_pd( ef2367, jh2367 );
+
+		_mm256_storeu_ps( out, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd04, efjh04, PERMUTE2( 2, 0 ) ) ) );
+		_mm256_storeu_ps( out + oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd15, efjh15, PERMUTE2( 2, 0 ) ) ) );
+		_mm256_storeu_ps( out + 2 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd26, efjh26, PERMUTE2( 2, 0 ) ) ) );
+		_mm256_storeu_ps( out + 3 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd37, efjh37, PERMUTE2( 2, 0 ) ) ) );
+		_mm256_storeu_ps( out + 4 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd04, efjh04, PERMUTE2( 3, 1 ) ) ) );
+		_mm256_storeu_ps( out + 5 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd15, efjh15, PERMUTE2( 3, 1 ) ) ) );
+		_mm256_storeu_ps( out + 6 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd26, efjh26, PERMUTE2( 3, 1 ) ) ) );
+		_mm256_storeu_ps( out + 7 * oStride, _mm256_castpd_ps( _mm256_permute2f128_pd( abcd37, efjh37, PERMUTE2( 3, 1 ) ) ) );
+	}
+};
@@ -0,0 +1,101 @@
+/* Copyright © 2017-2021 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <AvxCommon.h>
+#include <MicroKernels/MicroKernelBase.h>
+
+// The kernel uses zmm registers, so it must be called only if AVX-512 is available
+struct CMicroKernelAvx512_6x32 : public CMicroKernelBase<6, 32> {
+	AVX512_TARGET static void Calculate( const float* aPtr, const float* bPtr, float* cPtr, size_t cRowSize, size_t k ) {
+		// Each row of the result takes two cache lines
+		for( int i = 0; i < 6; i++ ) {
+			_mm_prefetch( reinterpret_cast<const char*>( cPtr + i * cRowSize ), _MM_HINT_T0 );
+			_mm_prefetch( reinterpret_cast<const char*>( cPtr + i * cRowSize + 16 ), _MM_HINT_T0 );
+		}
+		__m512 c00 = _mm512_setzero_ps();
+		__m512 c01 = _mm512_setzero_ps();
+		__m512 c10 = _mm512_setzero_ps();
+		__m512 c11 = _mm512_setzero_ps();
+		__m512 c20 = _mm512_setzero_ps();
+		__m512 c21 = _mm512_setzero_ps();
+		__m512 c30 = _mm512_setzero_ps();
+		__m512 c31 = _mm512_setzero_ps();
+		__m512 c40 = _mm512_setzero_ps();
+		__m512 c41 = _mm512_setzero_ps();
+		__m512 c50 = _mm512_setzero_ps();
+		__m512 c51 = _mm512_setzero_ps();
+
+		__m512 b0, b1, a0, a1;
+
+		for( ; k > 0; k-- ) {
+			//      b0   b1
+			// a0   c00  c01
+			// a1   c10  c11
+			// a2   c20  c21
+			// a3   c30  c31
+			// a4   c40  c41
+			// a5   c50  c51
+			_mm_prefetch( reinterpret_cast<const char*>( aPtr + 48 ), _MM_HINT_T0 );
+			_mm_prefetch( reinterpret_cast<const char*>( bPtr + 256 ), _MM_HINT_T0 );
+			// b0: b0[0-15]
+			b0 = _mm512_loadu_ps( bPtr + 0 );
+			// b1: b1[0-15]
+			b1 = _mm512_loadu_ps( bPtr + 16 );
+			// a0: a0[0] broadcasted to all 16 elements
+			a0 = _mm512_set1_ps( aPtr[0] );
+			a1 = _mm512_set1_ps( aPtr[1] );
+			c00 = _mm512_fmadd_ps( a0, b0, c00 );
+			c01 = _mm512_fmadd_ps( a0, b1, c01 );
+			c10 = _mm512_fmadd_ps( a1, b0, c10 );
+			c11 = _mm512_fmadd_ps( a1, b1, c11 );
+
+			a0 = _mm512_set1_ps( aPtr[2] );
+			a1 = _mm512_set1_ps( aPtr[3] );
+			c20 = _mm512_fmadd_ps( a0, b0, c20 );
+			c21 = _mm512_fmadd_ps( a0, b1, c21 );
+			c30 = _mm512_fmadd_ps( a1, b0, c30 );
+			c31 = _mm512_fmadd_ps( a1, b1, c31 );
+
+			a0 = _mm512_set1_ps( aPtr[4] );
+			a1 = _mm512_set1_ps( aPtr[5] );
+			c40 = _mm512_fmadd_ps( a0, b0, c40 );
+			c41 = _mm512_fmadd_ps( a0, b1, c41 );
+			c50 = _mm512_fmadd_ps( a1, b0, c50 );
+			c51 = _mm512_fmadd_ps( a1, b1, c51 );
+
+			bPtr += 32; aPtr += 6;
+		}
+
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c00, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c01, _mm512_loadu_ps( cPtr + 16 ) ) );
+		cPtr += cRowSize;
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c10, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c11, _mm512_loadu_ps( cPtr + 16 ) ) );
+		cPtr += cRowSize;
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c20, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c21, _mm512_loadu_ps( cPtr + 16 ) ) );
+		cPtr += cRowSize;
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c30, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c31, _mm512_loadu_ps( cPtr + 16 ) ) );
+		cPtr += cRowSize;
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c40, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c41, _mm512_loadu_ps( cPtr + 16 ) ) );
+		cPtr += cRowSize;
+		_mm512_storeu_ps( cPtr, _mm512_add_ps( c50, _mm512_loadu_ps( cPtr ) ) );
+		_mm512_storeu_ps( cPtr + 16, _mm512_add_ps( c51, _mm512_loadu_ps( cPtr + 16 ) ) );
+	}
+};
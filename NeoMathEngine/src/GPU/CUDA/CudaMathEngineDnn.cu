@@ -804,6 +804,72 @@ void CCudaMathEngine::ScatterND( const CConstIntHandle& indicesHandle, const CCo
 		GetRaw( dataHandle ), cudaDataDesc, updateCount, indexDims, objectSize );
 }
 
+CQuantizedMatrixDesc* CCudaMathEngine::InitQuantizedMatrix( const CConstFloatHandle&, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+CQuantizedMatrixDesc* CCudaMathEngine::InitQuantizedMatrix( const signed char*, const float*, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+void CCudaMathEngine::GetQuantizedMatrixData( const CQuantizedMatrixDesc&, signed char*, float* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle&, int, int, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::BlobQuantizedConvolution( const CConvolutionDesc&, const CConstFloatHandle&, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::BlobConvolutionWithActivation( const CConvolutionDesc&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle&, int, int,
+	const CConstFloatHandle&, int, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::VectorAddWithActivation( const CConstFloatHandle&, const CConstFloatHandle&,
+	const CFloatHandle&, int, const CFusedActivation& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::ScaledDotProductAttention( int, int, int, int, int, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CConstFloatHandle*, int, bool, const CConstIntHandle*,
+	const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::LayerNormalization( int, int, const CConstFloatHandle&, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CFloatHandle&, const CFloatHandle*, const CFloatHandle* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CCudaMathEngine::LayerNormalizationBackward( int, int, const CConstFloatHandle&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_CUDA
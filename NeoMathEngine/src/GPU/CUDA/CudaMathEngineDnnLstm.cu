@@ -37,6 +37,14 @@ void CCudaMathEngine::Lstm( CLstmDesc&,
 	ASSERT_EXPR( false );
 }
 
+void CCudaMathEngine::LstmRecurrentStep( CLstmDesc&, const CFloatHandle&,
+	const CFloatHandle&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&,
+	const CFloatHandle&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_CUDA
@@ -578,6 +578,10 @@ public:
 		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
 		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink, const CConstFloatHandle& input,
 		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) override;
+	void LstmRecurrentStep( CLstmDesc& desc, const CFloatHandle& inputFullyConnectedResult,
+		const CFloatHandle& recurrentWeights, const CConstFloatHandle& recurrentFreeTerm,
+		const CConstFloatHandle& inputStateBackLink, const CConstFloatHandle& inputMainBackLink,
+		const CFloatHandle& outputStateBackLink, const CFloatHandle& outputMainBackLink ) override;
 	void LinearInterpolation( const CConstFloatHandle& dataHandle, const CFloatHandle& resultHandle, TInterpolationCoords coords,
 		TInterpolationRound round, int objectCount, int scaledAxis, int objectSize, float scale ) override;
 	void ScatterND( const CConstIntHandle& indicesHandle, const CConstFloatHandle& updatesHandle,
@@ -591,6 +595,33 @@ public:
 		const CConstFloatHandle* channelwiseFreeTerm, const CConstFloatHandle& channelwiseReLUThreshold,
 		const CConstFloatHandle& downFilter, const CConstFloatHandle* downFreeTerm, bool residual,
 		const CFloatHandle& outputHandle ) override;
+	CQuantizedMatrixDesc* InitQuantizedMatrix( const CConstFloatHandle& matrix, int height, int width ) override;
+	CQuantizedMatrixDesc* InitQuantizedMatrix( const signed char* data, const float* scales, int height, int width ) override;
+	void GetQuantizedMatrixData( const CQuantizedMatrixDesc& matrix, signed char* data, float* scales ) override;
+	void MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle& first, int firstHeight, int firstWidth,
+		float firstScale, const CQuantizedMatrixDesc& second, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) override;
+	void BlobQuantizedConvolution( const CConvolutionDesc& desc, const CConstFloatHandle& source, float sourceScale,
+		const CQuantizedMatrixDesc& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) override;
+	void BlobConvolutionWithActivation( const CConvolutionDesc& desc, const CConstFloatHandle& source,
+		const CConstFloatHandle& filter, const CConstFloatHandle* freeTerm, const CFusedActivation& activation,
+		const CFloatHandle& result ) override;
+	void MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle& first, int firstHeight,
+		int firstWidth, const CConstFloatHandle& second, int secondHeight, const CConstFloatHandle* freeTerm,
+		const CFusedActivation& activation, const CFloatHandle& result ) override;
+	void VectorAddWithActivation( const CConstFloatHandle& first, const CConstFloatHandle& second,
+		const CFloatHandle& result, int vectorSize, const CFusedActivation& activation ) override;
+	void ScaledDotProductAttention( int batchSize, int headCount, int headSize, int seqQ, int seqKV, float scale,
+		const CConstFloatHandle& q, const CConstFloatHandle& k, const CConstFloatHandle& v,
+		const CConstFloatHandle* mask, int maskObjectCount, bool isCausal, const CConstIntHandle* kvLengths,
+		const CFloatHandle& result ) override;
+	void LayerNormalization( int objectCount, int objectSize, const CConstFloatHandle& input, float epsilon,
+		const CConstFloatHandle& scale, const CConstFloatHandle& bias, const CFloatHandle& result,
+		const CFloatHandle* normalizedInput, const CFloatHandle* invSqrtVariance ) override;
+	void LayerNormalizationBackward( int objectCount, int objectSize, const CConstFloatHandle& normalizedInput,
+		const CConstFloatHandle& invSqrtVariance, const CConstFloatHandle& scale, const CConstFloatHandle& outputDiff,
+		const CFloatHandle& inputDiff ) override;
 
 	IPerformanceCounters* CreatePerformanceCounters() const override { 	return new CPerformanceCountersDefault(); }
 	void AllReduce( const CFloatHandle& /*handle*/, int /*size*/ ) override {};
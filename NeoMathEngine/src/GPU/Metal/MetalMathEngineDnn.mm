@@ -687,6 +687,72 @@ void CMetalMathEngine::MobileNetV2Block( const CBlobDesc&, const CBlobDesc&, con
 	ASSERT_EXPR( false );
 }
 
+CQuantizedMatrixDesc* CMetalMathEngine::InitQuantizedMatrix( const CConstFloatHandle&, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+CQuantizedMatrixDesc* CMetalMathEngine::InitQuantizedMatrix( const signed char*, const float*, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+void CMetalMathEngine::GetQuantizedMatrixData( const CQuantizedMatrixDesc&, signed char*, float* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle&, int, int, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::BlobQuantizedConvolution( const CConvolutionDesc&, const CConstFloatHandle&, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::BlobConvolutionWithActivation( const CConvolutionDesc&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle&, int, int,
+	const CConstFloatHandle&, int, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::VectorAddWithActivation( const CConstFloatHandle&, const CConstFloatHandle&,
+	const CFloatHandle&, int, const CFusedActivation& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::ScaledDotProductAttention( int, int, int, int, int, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CConstFloatHandle*, int, bool, const CConstIntHandle*,
+	const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::LayerNormalization( int, int, const CConstFloatHandle&, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CFloatHandle&, const CFloatHandle*, const CFloatHandle* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CMetalMathEngine::LayerNormalizationBackward( int, int, const CConstFloatHandle&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_METAL
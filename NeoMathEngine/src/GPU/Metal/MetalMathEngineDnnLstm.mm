@@ -37,6 +37,14 @@ void CMetalMathEngine::Lstm( CLstmDesc&,
 	ASSERT_EXPR( false );
 }
 
+void CMetalMathEngine::LstmRecurrentStep( CLstmDesc&, const CFloatHandle&,
+	const CFloatHandle&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&,
+	const CFloatHandle&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_METAL
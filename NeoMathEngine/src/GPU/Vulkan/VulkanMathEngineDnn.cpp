@@ -700,6 +700,72 @@ void CVulkanMathEngine::MobileNetV2Block( const CBlobDesc&, const CBlobDesc&, co
 	ASSERT_EXPR( false );
 }
 
+CQuantizedMatrixDesc* CVulkanMathEngine::InitQuantizedMatrix( const CConstFloatHandle&, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+CQuantizedMatrixDesc* CVulkanMathEngine::InitQuantizedMatrix( const signed char*, const float*, int, int )
+{
+	ASSERT_EXPR( false );
+	return nullptr;
+}
+
+void CVulkanMathEngine::GetQuantizedMatrixData( const CQuantizedMatrixDesc&, signed char*, float* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::MultiplyMatrixByTransposedQuantizedMatrix( const CConstFloatHandle&, int, int, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::BlobQuantizedConvolution( const CConvolutionDesc&, const CConstFloatHandle&, float,
+	const CQuantizedMatrixDesc&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::BlobConvolutionWithActivation( const CConvolutionDesc&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::MultiplyMatrixByTransposedMatrixWithActivation( const CConstFloatHandle&, int, int,
+	const CConstFloatHandle&, int, const CConstFloatHandle*, const CFusedActivation&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::VectorAddWithActivation( const CConstFloatHandle&, const CConstFloatHandle&,
+	const CFloatHandle&, int, const CFusedActivation& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::ScaledDotProductAttention( int, int, int, int, int, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CConstFloatHandle*, int, bool, const CConstIntHandle*,
+	const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::LayerNormalization( int, int, const CConstFloatHandle&, float, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CFloatHandle&, const CFloatHandle*, const CFloatHandle* )
+{
+	ASSERT_EXPR( false );
+}
+
+void CVulkanMathEngine::LayerNormalizationBackward( int, int, const CConstFloatHandle&, const CConstFloatHandle&,
+	const CConstFloatHandle&, const CConstFloatHandle&, const CFloatHandle& )
+{
+	ASSERT_EXPR( false );
+}
+
 } // namespace NeoML
 
 #endif // NEOML_USE_VULKAN
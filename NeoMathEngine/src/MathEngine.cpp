@@ -69,6 +69,7 @@ CGlobalMaxOverTimePoolingDesc::~CGlobalMaxOverTimePoolingDesc() = default;
 CMaxOverTimePoolingDesc::~CMaxOverTimePoolingDesc() = default;
 CLrnDesc::~CLrnDesc() = default;
 CLstmDesc::~CLstmDesc() = default;
+CQuantizedMatrixDesc::~CQuantizedMatrixDesc() = default;
 
 // GPU manager implementation
 class CGpuMathEngineManager : public IGpuMathEngineManager {
@@ -216,6 +217,11 @@ IMathEngine* CreateCpuMathEngine( int threadCount, size_t memoryLimit )
 	return new CCpuMathEngine( threadCount, memoryLimit );
 }
 
+IMathEngine* CreateCpuMathEngine( int threadCount, size_t memoryLimit, TCpuMemoryAllocator allocator )
+{
+	return new CCpuMathEngine( threadCount, memoryLimit, nullptr, CMathEngineDistributedInfo(), allocator );
+}
+
 IMathEngine* CreateGpuMathEngine( size_t memoryLimit, int flags )
 {
 	CGpuMathEngineManager manager;
@@ -96,13 +96,15 @@ static const unsigned int BufferSizes[] = {
 template <typename T, int size>
 inline constexpr int lengthof( T(&)[size] ) { return size; }
 
-CMemoryPool::CMemoryPool( size_t _memoryLimit, IRawMemoryManager* _rawMemoryManager, bool reuseMemoryMode ) :
+CMemoryPool::CMemoryPool( size_t _memoryLimit, IRawMemoryManager* _rawMemoryManager, bool reuseMemoryMode,
+		bool useThreadCache ) :
 	memoryLimit( _memoryLimit ),
 	rawMemoryManager( _rawMemoryManager ),
 	defaultReuseMemoryMode( reuseMemoryMode ),
 	allocatedMemory( 0 ),
 	freeMemorySize( _memoryLimit ),
-	peakMemoryUsage( 0 )
+	peakMemoryUsage( 0 ),
+	threadCache( useThreadCache ? new CThreadCacheMemoryAllocator( _memoryLimit, _rawMemoryManager, reuseMemoryMode ) : nullptr )
 {
 }
 
@@ -118,6 +120,11 @@ CMemoryPool::~CMemoryPool()
 
 void CMemoryPool::SetReuseMemoryMode( bool enable )
 {
+	if( threadCache != nullptr ) {
+		threadCache->SetReuseMemoryMode( enable );
+		return;
+	}
+
 	std::thread::id id = std::this_thread::get_id();
 	auto pool = pools.find( id );
 	if( pool == pools.end() ) {
@@ -130,6 +137,10 @@ void CMemoryPool::SetReuseMemoryMode( bool enable )
 
 CMemoryHandle CMemoryPool::Alloc( size_t size )
 {
+	if( threadCache != nullptr ) {
+		return threadCache->Alloc( size );
+	}
+
 	std::thread::id id = std::this_thread::get_id();
 	auto pool = pools.find( id );
 	if( pool == pools.end() ) {
@@ -149,6 +160,11 @@ CMemoryHandle CMemoryPool::Alloc( size_t size )
 
 void CMemoryPool::Free( const CMemoryHandle& handle )
 {
+	if( threadCache != nullptr ) {
+		threadCache->Free( handle );
+		return;
+	}
+
 	TUsedAddressMap::const_iterator pos = usedMap.find( GetRaw(handle) );
 	const CUsedInfo& info = pos->second;
 	if( info.pool != 0 ) {
@@ -164,6 +180,10 @@ void CMemoryPool::Free( const CMemoryHandle& handle )
 
 size_t CMemoryPool::GetMemoryInPools() const
 {
+	if( threadCache != nullptr ) {
+		return threadCache->GetMemoryInPools();
+	}
+
 	std::thread::id id = std::this_thread::get_id();
 	auto pool = pools.find( id );
 	if( pool == pools.end() ) {
@@ -176,6 +196,10 @@ size_t CMemoryPool::GetMemoryInPools() const
 
 void CMemoryPool::CleanUp()
 {
+	if( threadCache != nullptr ) {
+		threadCache->CleanUp();
+		return;
+	}
 	cleanUp( std::this_thread::get_id() );
 }
 
@@ -19,6 +19,8 @@ limitations under the License.
 #include <NeoMathEngine/MemoryHandle.h>
 #include <NeoMathEngine/CrtAllocatedObject.h>
 #include <RawMemoryManager.h>
+#include <ThreadCacheMemoryAllocator.h>
+#include <memory>
 #include <unordered_map>
 #include <thread>
 
@@ -30,9 +32,14 @@ class CMemoryBuffer;
 // The memory manager
 class CMemoryPool : public CCrtAllocatedObject {
 public:
-	CMemoryPool( size_t memoryLimit, IRawMemoryManager* rawMemoryManager, bool reuseMemoryMode );
+	// useThreadCache turns on the mode with the thread-local caches (see CThreadCacheMemoryAllocator)
+	// In this mode the pool is thread-safe but may be used only with the host memory
+	CMemoryPool( size_t memoryLimit, IRawMemoryManager* rawMemoryManager, bool reuseMemoryMode, bool useThreadCache = false );
 	~CMemoryPool();
 
+	// Checks if the pool may be used from several threads without the external lock
+	bool IsThreadSafe() const { return threadCache != nullptr; }
+
 	// Turns on and off the memory reuse mode for the current thread
 	void SetReuseMemoryMode( bool enable );
 
@@ -43,10 +50,10 @@ public:
 	void Free( const CMemoryHandle& handle );
 
 	// Gets the amount of memory currently available
-	size_t GetFreeMemorySize() const { return freeMemorySize; }
+	size_t GetFreeMemorySize() const { return threadCache != nullptr ? threadCache->GetFreeMemorySize() : freeMemorySize; }
 
 	// Gets the peak memory usage achieved during processing
-	size_t GetPeakMemoryUsage() const { return peakMemoryUsage; }
+	size_t GetPeakMemoryUsage() const { return threadCache != nullptr ? threadCache->GetPeakMemoryUsage() : peakMemoryUsage; }
 
 	// Gets the amount of memory used for the pools
 	size_t GetMemoryInPools() const;
@@ -86,6 +93,9 @@ private:
 		CrtAllocator< std::pair<void* const, CUsedInfo> > > TUsedAddressMap;
 	TUsedAddressMap usedMap;
 
+	// The allocator used in the thread cache mode (null in the default mode)
+	const std::unique_ptr<CThreadCacheMemoryAllocator> threadCache;
+
 	void createPools( std::thread::id id );
 	void cleanUp( std::thread::id id );
 	CMemoryHandle tryAlloc( size_t size, CThreadData& data );
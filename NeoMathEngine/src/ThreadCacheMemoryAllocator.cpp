@@ -0,0 +1,321 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <common.h>
+#pragma hdrstop
+
+#include <ThreadCacheMemoryAllocator.h>
+#include <MemoryHandleInternal.h>
+#include <new>
+#include <unordered_set>
+
+namespace NeoML {
+
+// The size classes are 256, 384, 512, 768, 1024, ... (the powers of two and the numbers between them)
+static const size_t MinSizeClass = 256;
+static const int SizeClassCount = 45;
+// The largest cached block is 1 GB, the larger blocks are always allocated directly
+static const size_t MaxSizeClass = MinSizeClass << ( SizeClassCount / 2 );
+// The block is not cached
+static const int NotCachedSizeClass = -1;
+
+// The size of the block header (keeps the alignment of the raw memory)
+static const size_t BlockHeaderSize = 64;
+
+// Gets the size class of the block
+static inline int getSizeClass( size_t size )
+{
+	if( size <= MinSizeClass ) {
+		return 0;
+	}
+	// The largest power of two less than size
+	int log = 0;
+	for( size_t rest = ( size - 1 ) / MinSizeClass; rest > 1; rest >>= 1 ) {
+		++log;
+	}
+	const size_t base = MinSizeClass << log;
+	return size <= base + base / 2 ? 2 * log + 1 : 2 * log + 2;
+}
+
+// Gets the block size for the size class
+static inline size_t getClassSize( int sizeClass )
+{
+	const size_t base = MinSizeClass << ( sizeClass / 2 );
+	return sizeClass % 2 == 0 ? base : base + base / 2;
+}
+
+// The header placed before each block
+struct CThreadCacheBlock {
+	CMemoryHandle Raw; // the raw memory of the block (with the header)
+	size_t Size; // the block size (without the header)
+	CThreadCache* Owner; // the cache which the block is returned to (null if the block is not cached)
+	CThreadCacheBlock* Next; // the next block in the free list
+	int SizeClass; // the size class of the block
+
+	CThreadCacheBlock( const CMemoryHandle& raw, size_t size, int sizeClass ) :
+		Raw( raw ), Size( size ), Owner( nullptr ), Next( nullptr ), SizeClass( sizeClass ) {}
+
+	void* GetData() { return reinterpret_cast<char*>( this ) + BlockHeaderSize; }
+	static CThreadCacheBlock* FromData( void* data )
+		{ return reinterpret_cast<CThreadCacheBlock*>( static_cast<char*>( data ) - BlockHeaderSize ); }
+};
+
+static_assert( sizeof( CThreadCacheBlock ) <= BlockHeaderSize, "The block header is too large" );
+
+// The cache of one thread
+struct CThreadCache : public CCrtAllocatedObject {
+	// The free blocks; used only by the owner thread
+	CThreadCacheBlock* FreeLists[SizeClassCount];
+	// The blocks freed by the other threads; the blocks are pushed by CAS and taken all at once by exchange
+	std::atomic<CThreadCacheBlock*> RemoteFreeLists[SizeClassCount];
+	// The memory reuse mode of the thread
+	bool ReuseEnabled;
+	// The thread has finished (guarded by the allocator mutex)
+	bool IsAbandoned;
+
+	explicit CThreadCache( bool reuseEnabled ) : ReuseEnabled( reuseEnabled ), IsAbandoned( false )
+	{
+		for( int i = 0; i < SizeClassCount; ++i ) {
+			FreeLists[i] = nullptr;
+			RemoteFreeLists[i].store( nullptr, std::memory_order_relaxed );
+		}
+	}
+};
+
+// The identifiers of the existing allocators
+static std::mutex allocatorsMutex;
+static std::unordered_set<unsigned long long, std::hash<unsigned long long>, std::equal_to<unsigned long long>,
+	CrtAllocator<unsigned long long>> allocatorIds;
+static std::atomic<unsigned long long> nextAllocatorId( 0 );
+
+// The caches of the current thread for the different allocators
+class CThreadCacheList {
+public:
+	struct CRef {
+		unsigned long long AllocatorId;
+		CThreadCacheMemoryAllocator* Allocator;
+		CThreadCache* Cache;
+	};
+
+	~CThreadCacheList();
+
+	std::vector<CRef, CrtAllocator<CRef>> Refs;
+};
+
+// Returns the caches to the allocators which still exist
+CThreadCacheList::~CThreadCacheList()
+{
+	std::lock_guard<std::mutex> lock( allocatorsMutex );
+	for( const CRef& ref : Refs ) {
+		if( allocatorIds.find( ref.AllocatorId ) != allocatorIds.end() ) {
+			ref.Allocator->abandonCache( *ref.Cache );
+		}
+	}
+}
+
+static thread_local CThreadCacheList threadCaches;
+
+//------------------------------------------------------------------------------------------------------------
+
+CThreadCacheMemoryAllocator::CThreadCacheMemoryAllocator( size_t _memoryLimit, IRawMemoryManager* _rawMemoryManager,
+		bool reuseMemoryMode ) :
+	id( nextAllocatorId.fetch_add( 1 ) ),
+	memoryLimit( _memoryLimit ),
+	rawMemoryManager( _rawMemoryManager ),
+	defaultReuseMemoryMode( reuseMemoryMode ),
+	allocatedMemory( 0 ),
+	usedMemory( 0 ),
+	cachedMemory( 0 ),
+	peakMemoryUsage( 0 )
+{
+	std::lock_guard<std::mutex> lock( allocatorsMutex );
+	allocatorIds.insert( id );
+}
+
+CThreadCacheMemoryAllocator::~CThreadCacheMemoryAllocator()
+{
+	{
+		std::lock_guard<std::mutex> lock( allocatorsMutex );
+		allocatorIds.erase( id );
+	}
+	for( CThreadCache* cache : caches ) {
+		cleanUp( *cache );
+		delete cache;
+	}
+}
+
+void CThreadCacheMemoryAllocator::SetReuseMemoryMode( bool enable )
+{
+	getThreadCache().ReuseEnabled = enable;
+}
+
+CMemoryHandle CThreadCacheMemoryAllocator::Alloc( size_t size )
+{
+	CThreadCache& cache = getThreadCache();
+	CThreadCacheBlock* block = nullptr;
+	if( !cache.ReuseEnabled || size > MaxSizeClass ) {
+		block = allocBlock( size, NotCachedSizeClass );
+		if( block == nullptr ) {
+			// Not enough memory. Try to free the cached memory
+			cleanUp( cache );
+			block = allocBlock( size, NotCachedSizeClass );
+		}
+	} else {
+		const int sizeClass = getSizeClass( size );
+		block = cache.FreeLists[sizeClass];
+		if( block == nullptr ) {
+			block = cache.RemoteFreeLists[sizeClass].exchange( nullptr, std::memory_order_acquire );
+		}
+		if( block != nullptr ) {
+			cache.FreeLists[sizeClass] = block->Next;
+			block->Next = nullptr;
+			cachedMemory.fetch_sub( block->Size, std::memory_order_relaxed );
+		} else {
+			block = allocBlock( getClassSize( sizeClass ), sizeClass );
+			if( block == nullptr ) {
+				cleanUp( cache );
+				block = allocBlock( getClassSize( sizeClass ), sizeClass );
+			}
+			if( block != nullptr ) {
+				block->Owner = &cache;
+			}
+		}
+	}
+
+	if( block == nullptr ) {
+		return CMemoryHandle();
+	}
+	usedMemory.fetch_add( block->Size, std::memory_order_relaxed );
+	return CMemoryHandleInternal::CreateMemoryHandle( block->Raw.GetMathEngine(), block->GetData() );
+}
+
+void CThreadCacheMemoryAllocator::Free( const CMemoryHandle& handle )
+{
+	CThreadCacheBlock* block = CThreadCacheBlock::FromData( GetRaw( handle ) );
+	usedMemory.fetch_sub( block->Size, std::memory_order_relaxed );
+	CThreadCache* owner = block->Owner;
+	if( owner == nullptr ) {
+		freeBlock( block );
+		return;
+	}
+
+	cachedMemory.fetch_add( block->Size, std::memory_order_relaxed );
+	if( owner == &getThreadCache() ) {
+		block->Next = owner->FreeLists[block->SizeClass];
+		owner->FreeLists[block->SizeClass] = block;
+	} else {
+		std::atomic<CThreadCacheBlock*>& head = owner->RemoteFreeLists[block->SizeClass];
+		block->Next = head.load( std::memory_order_relaxed );
+		while( !head.compare_exchange_weak( block->Next, block, std::memory_order_release, std::memory_order_relaxed ) ) {
+		}
+	}
+}
+
+void CThreadCacheMemoryAllocator::CleanUp()
+{
+	cleanUp( getThreadCache() );
+
+	std::lock_guard<std::mutex> lock( cachesMutex );
+	for( CThreadCache* cache : caches ) {
+		if( cache->IsAbandoned ) {
+			// Only the blocks freed after the thread has finished may be there
+			cleanUp( *cache );
+		}
+	}
+}
+
+// Gets the cache of the current thread, creates it on the first call
+CThreadCache& CThreadCacheMemoryAllocator::getThreadCache()
+{
+	for( const CThreadCacheList::CRef& ref : threadCaches.Refs ) {
+		if( ref.AllocatorId == id ) {
+			return *ref.Cache;
+		}
+	}
+
+	CThreadCache* cache = new CThreadCache( defaultReuseMemoryMode );
+	{
+		std::lock_guard<std::mutex> lock( cachesMutex );
+		caches.push_back( cache );
+	}
+	threadCaches.Refs.push_back( CThreadCacheList::CRef{ id, this, cache } );
+	return *cache;
+}
+
+// Frees the cache of the finished thread
+void CThreadCacheMemoryAllocator::abandonCache( CThreadCache& cache )
+{
+	std::lock_guard<std::mutex> lock( cachesMutex );
+	cleanUp( cache );
+	cache.IsAbandoned = true;
+}
+
+// Allocates the block with the header; returns null if the memory limit is exceeded
+CThreadCacheBlock* CThreadCacheMemoryAllocator::allocBlock( size_t size, int sizeClass )
+{
+	if( size > memoryLimit - BlockHeaderSize ) {
+		return nullptr;
+	}
+	const size_t rawSize = size + BlockHeaderSize;
+	size_t allocated = allocatedMemory.load( std::memory_order_relaxed );
+	do {
+		if( allocated > memoryLimit - rawSize ) {
+			return nullptr;
+		}
+	} while( !allocatedMemory.compare_exchange_weak( allocated, allocated + rawSize, std::memory_order_relaxed ) );
+
+	const CMemoryHandle raw = rawMemoryManager->Alloc( rawSize );
+	if( raw.IsNull() ) {
+		allocatedMemory.fetch_sub( rawSize, std::memory_order_relaxed );
+		return nullptr;
+	}
+
+	size_t peak = peakMemoryUsage.load( std::memory_order_relaxed );
+	while( peak < allocated + rawSize
+		&& !peakMemoryUsage.compare_exchange_weak( peak, allocated + rawSize, std::memory_order_relaxed ) )
+	{
+	}
+	return new( GetRaw( raw ) ) CThreadCacheBlock( raw, size, sizeClass );
+}
+
+void CThreadCacheMemoryAllocator::freeBlock( CThreadCacheBlock* block )
+{
+	const CMemoryHandle raw = block->Raw;
+	allocatedMemory.fetch_sub( block->Size + BlockHeaderSize, std::memory_order_relaxed );
+	rawMemoryManager->Free( raw );
+}
+
+void CThreadCacheMemoryAllocator::freeList( CThreadCacheBlock* head )
+{
+	while( head != nullptr ) {
+		CThreadCacheBlock* next = head->Next;
+		cachedMemory.fetch_sub( head->Size, std::memory_order_relaxed );
+		freeBlock( head );
+		head = next;
+	}
+}
+
+// Frees the cached blocks of the thread
+// Should be called on the owner thread (or when no other threads use the allocator)
+void CThreadCacheMemoryAllocator::cleanUp( CThreadCache& cache )
+{
+	for( int i = 0; i < SizeClassCount; ++i ) {
+		freeList( cache.FreeLists[i] );
+		cache.FreeLists[i] = nullptr;
+		freeList( cache.RemoteFreeLists[i].exchange( nullptr, std::memory_order_acquire ) );
+	}
+}
+
+} // namespace NeoML
@@ -0,0 +1,89 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+	http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <MathEngineAllocator.h>
+#include <NeoMathEngine/MemoryHandle.h>
+#include <NeoMathEngine/CrtAllocatedObject.h>
+#include <RawMemoryManager.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace NeoML {
+
+struct CThreadCacheBlock;
+struct CThreadCache;
+
+// The memory allocator with the thread-local caches of the freed blocks
+// All the methods may be called from several threads at the same time without the external lock
+// The allocation info is stored in the header before each block, so the allocator works only with the host memory
+// The block freed by the thread which allocated it goes to the thread cache,
+// the block freed by another thread is pushed to the lock-free list of the owner cache
+// The cache of the finished thread is freed; the blocks returned to it later are freed on CleanUp
+class CThreadCacheMemoryAllocator : public CCrtAllocatedObject {
+public:
+	CThreadCacheMemoryAllocator( size_t memoryLimit, IRawMemoryManager* rawMemoryManager, bool reuseMemoryMode );
+	~CThreadCacheMemoryAllocator();
+
+	// Turns on and off the memory reuse mode for the current thread
+	void SetReuseMemoryMode( bool enable );
+
+	// Allocates the specified amount of memory
+	CMemoryHandle Alloc( size_t size );
+
+	// Frees the memory; may be called from any thread
+	void Free( const CMemoryHandle& handle );
+
+	// Gets the amount of memory currently available
+	size_t GetFreeMemorySize() const { return memoryLimit - usedMemory.load( std::memory_order_relaxed ); }
+
+	// Gets the peak memory usage achieved during processing
+	size_t GetPeakMemoryUsage() const { return peakMemoryUsage.load( std::memory_order_relaxed ); }
+
+	// Gets the amount of memory in the caches of all threads
+	size_t GetMemoryInPools() const { return cachedMemory.load( std::memory_order_relaxed ); }
+
+	// Frees the cached memory of the current thread and of the finished threads
+	void CleanUp();
+
+private:
+	// The unique identifier of the allocator (the thread caches of the destroyed allocators are never matched)
+	const unsigned long long id;
+	const size_t memoryLimit;
+	IRawMemoryManager* const rawMemoryManager;
+	const bool defaultReuseMemoryMode;
+
+	std::atomic<size_t> allocatedMemory; // the amount of memory allocated on device (belonging to the user + cached)
+	std::atomic<size_t> usedMemory; // the amount of memory belonging to the user
+	std::atomic<size_t> cachedMemory; // the amount of memory in the caches
+	std::atomic<size_t> peakMemoryUsage; // peak memory usage
+
+	// The caches of all threads, guarded by the mutex (used only when a thread starts using the allocator)
+	std::mutex cachesMutex;
+	std::vector<CThreadCache*, CrtAllocator<CThreadCache*>> caches;
+
+	friend class CThreadCacheList;
+
+	CThreadCache& getThreadCache();
+	void abandonCache( CThreadCache& cache );
+	CThreadCacheBlock* allocBlock( size_t size, int sizeClass );
+	void freeBlock( CThreadCacheBlock* block );
+	void freeList( CThreadCacheBlock* head );
+	void cleanUp( CThreadCache& cache );
+};
+
+} // namespace NeoML
@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <NeoMathEngine/ThreadPool.h>
 
+#include <algorithm>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 #include <queue>
@@ -28,124 +30,402 @@ namespace NeoML {
 struct CTask {
 	IThreadPool::TFunction Function;
 	void* Params;
+	CThreadPoolTaskGroup* Group; // nullptr for the tasks bound to a thread
 };
 
-struct CThreadParams {
-	int Count; // Number of threads in the pool.
-	int Index; // Thread index in the pool.
-	std::condition_variable ConditionVariable;
-	std::mutex Mutex;
-	std::queue<CTask> Queue;
-	bool Stopped;
+// The lock-free work-stealing deque (Chase-Lev) with fixed capacity
+// Only the owner thread may call Push and Pop; any thread may call Steal
+class CWorkStealingDeque {
+public:
+	CWorkStealingDeque();
+
+	// Returns false if the deque is full
+	bool Push( CTask* task );
+	// Takes the task from the bottom (the last pushed one)
+	CTask* Pop();
+	// Takes the task from the top (the first pushed one)
+	// May return nullptr if there is a concurrent Pop or Steal
+	CTask* Steal();
+
+private:
+	static const int64_t Capacity = 1024;
+	static const int64_t Mask = Capacity - 1;
+
+	std::atomic<int64_t> top;
+	char padding[64]; // top and bottom are updated by different threads
+	std::atomic<int64_t> bottom;
+	std::atomic<CTask*> buffer[Capacity];
 };
 
-static void threadEntry( CThreadParams* parameters )
+CWorkStealingDeque::CWorkStealingDeque() :
+	top( 0 ),
+	bottom( 0 )
 {
-	CThreadParams& params = *parameters;
-	std::unique_lock<std::mutex> lock(params.Mutex);
-
-	while(!params.Stopped) {
-		if( !params.Queue.empty() ) {
-			CTask task = params.Queue.front();
-			lock.unlock();
+	for( int64_t i = 0; i < Capacity; i++ ) {
+		buffer[i].store( nullptr, std::memory_order_relaxed );
+	}
+}
 
-			try {
-				task.Function(params.Index, task.Params);
-			} catch(...) {
-				ASSERT_EXPR(false); // Better than nothing
-			}
+bool CWorkStealingDeque::Push( CTask* task )
+{
+	const int64_t b = bottom.load( std::memory_order_relaxed );
+	const int64_t t = top.load( std::memory_order_acquire );
+	if( b - t >= Capacity ) {
+		return false;
+	}
+	buffer[b & Mask].store( task, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+	bottom.store( b + 1, std::memory_order_relaxed );
+	return true;
+}
 
-			lock.lock();
-			params.Queue.pop();
-			params.ConditionVariable.notify_all();
+CTask* CWorkStealingDeque::Pop()
+{
+	const int64_t b = bottom.load( std::memory_order_relaxed ) - 1;
+	bottom.store( b, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	int64_t t = top.load( std::memory_order_relaxed );
+	if( t > b ) {
+		// Empty
+		bottom.store( b + 1, std::memory_order_relaxed );
+		return nullptr;
+	}
+	CTask* task = buffer[b & Mask].load( std::memory_order_relaxed );
+	if( t == b ) {
+		// The last task: race with the thieves
+		if( !top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+			task = nullptr;
 		}
+		bottom.store( b + 1, std::memory_order_relaxed );
+	}
+	return task;
+}
 
-		params.ConditionVariable.wait(lock);
+CTask* CWorkStealingDeque::Steal()
+{
+	int64_t t = top.load( std::memory_order_acquire );
+	std::atomic_thread_fence( std::memory_order_seq_cst );
+	const int64_t b = bottom.load( std::memory_order_acquire );
+	if( t >= b ) {
+		return nullptr;
+	}
+	CTask* task = buffer[t & Mask].load( std::memory_order_relaxed );
+	if( !top.compare_exchange_strong( t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+		return nullptr;
 	}
+	return task;
 }
 
 //------------------------------------------------------------------------------------------------------------
 
+struct CWorker {
+	CWorkStealingDeque Deque; // the group tasks added by this thread
+	std::mutex BoundMutex;
+	std::queue<CTask*> BoundQueue; // the tasks which must be executed by this thread
+	std::atomic<int> BoundCount;
+	std::thread Thread;
+
+	CWorker() : BoundCount( 0 ) {}
+};
+
 class CThreadPool : public IThreadPool {
 public:
 	explicit CThreadPool(int threadCount);
 	~CThreadPool() override;
 
 	// IThreadPool:
-	int Size() const override { return static_cast<int>(threads.size()); }
+	int Size() const override { return static_cast<int>(workers.size()); }
 	bool AddTask( int threadIndex, TFunction function, void* params ) override;
+	void AddTask( CThreadPoolTaskGroup& group, TFunction function, void* params ) override;
+	void WaitGroup( CThreadPoolTaskGroup& group ) override;
 	void WaitAllTask() override;
 	void StopAndWait() override;
 
 private:
-	std::vector<std::thread*> threads; // CPointerArray isn't available in neoml.
-	std::vector<CThreadParams*> params;
+	std::vector<CWorker*> workers; // CPointerArray isn't available in neoml.
+
+	// The group tasks added from outside the pool or not fitting into the thread's deque
+	std::mutex globalMutex;
+	std::queue<CTask*> globalQueue;
+	std::atomic<int> globalCount;
+
+	std::atomic<int> queuedCount; // the group tasks waiting to be executed
+	std::atomic<int> unfinishedCount; // all the tasks added but not completed yet
+	std::atomic<bool> stopped;
+
+	// The idle threads sleep here
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::atomic<int> sleepingCount;
+
+	// The threads waiting for the tasks outside the pool sleep here
+	std::mutex doneMutex;
+	std::condition_variable doneCondition;
+
+	static thread_local CThreadPool* currentPool;
+	static thread_local int currentThreadIndex;
+
+	void threadEntry( int threadIndex );
+	CTask* findTask( int threadIndex, bool takeBound );
+	void runTask( CTask* task, int threadIndex );
+	void wakeUpThreads();
+	void notifyDone();
 
 	CThreadPool( const CThreadPool& );
 	CThreadPool& operator=( const CThreadPool& );
 };
 
-CThreadPool::CThreadPool( int threadCount )
+thread_local CThreadPool* CThreadPool::currentPool = nullptr;
+thread_local int CThreadPool::currentThreadIndex = 0;
+
+CThreadPool::CThreadPool( int threadCount ) :
+	globalCount( 0 ),
+	queuedCount( 0 ),
+	unfinishedCount( 0 ),
+	stopped( false ),
+	sleepingCount( 0 )
 {
 	for( int i = 0; i < threadCount; i++ ) {
-		CThreadParams* param = new CThreadParams();
-		param->Count = threadCount;
-		param->Index = i;
-		param->Stopped = false;
-		params.push_back(param);
-
-		std::thread* thread = new std::thread(threadEntry, param);
-		threads.push_back(thread);
+		workers.push_back(new CWorker());
+	}
+	// The threads may steal from each other, so all the workers must be created before
+	for( int i = 0; i < threadCount; i++ ) {
+		workers[i]->Thread = std::thread(&CThreadPool::threadEntry, this, i);
 	}
 }
 
 CThreadPool::~CThreadPool()
 {
+	// The threads complete all the queued tasks before exiting, so nobody waits for the dropped ones
 	StopAndWait();
-	for( auto t : threads ) {
-		delete t;
-	}
-	for( auto p : params ) {
-		delete p;
+	for( auto w : workers ) {
+		assert(w->BoundQueue.empty());
+		delete w;
 	}
+	assert(globalQueue.empty());
 }
 
 bool CThreadPool::AddTask( int threadIndex, TFunction function, void* functionParams )
 {
-	assert(0 <= threadIndex && threadIndex < static_cast<int>(params.size()));
+	assert(0 <= threadIndex && threadIndex < static_cast<int>(workers.size()));
+
+	if( stopped ) {
+		return false;
+	}
 
-	std::unique_lock<std::mutex> lock(params[threadIndex]->Mutex);
-	params[threadIndex]->Queue.push({function, functionParams});
-	params[threadIndex]->ConditionVariable.notify_all();
+	CWorker& worker = *workers[threadIndex];
+	unfinishedCount.fetch_add(1);
+	{
+		std::unique_lock<std::mutex> lock(worker.BoundMutex);
+		worker.BoundQueue.push(new CTask{function, functionParams, nullptr});
+		worker.BoundCount.fetch_add(1);
+	}
+	wakeUpThreads();
 
-	return !params[threadIndex]->Stopped;
+	return true;
 }
 
-void CThreadPool::WaitAllTask()
+void CThreadPool::AddTask( CThreadPoolTaskGroup& group, TFunction function, void* functionParams )
+{
+	assert(!workers.empty());
+	// The stopped pool has no threads to execute the task, so its waiter would hang
+	ASSERT_EXPR(!stopped);
+
+	CTask* task = new CTask{function, functionParams, &group};
+	group.unfinishedCount.fetch_add(1);
+	unfinishedCount.fetch_add(1);
+	if( currentPool != this || !workers[currentThreadIndex]->Deque.Push(task) ) {
+		std::unique_lock<std::mutex> lock(globalMutex);
+		globalQueue.push(task);
+		globalCount.fetch_add(1);
+	}
+	queuedCount.fetch_add(1);
+	wakeUpThreads();
+}
+
+void CThreadPool::WaitGroup( CThreadPoolTaskGroup& group )
 {
-	for( size_t i = 0; i < params.size(); i++ ) {
-		std::unique_lock<std::mutex> lock(params[i]->Mutex);
-		while(!params[i]->Queue.empty()) {
-			params[i]->ConditionVariable.wait(lock);
+	if( currentPool == this ) {
+		// Help the other threads instead of blocking one of them
+		// The bound tasks are not taken here: they must be executed one by one
+		while( !group.IsFinished() ) {
+			CTask* task = findTask(currentThreadIndex, false);
+			if( task != nullptr ) {
+				runTask(task, currentThreadIndex);
+			} else {
+				std::this_thread::yield();
+			}
 		}
+		return;
 	}
+
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneCondition.wait(lock, [&group] { return group.IsFinished(); });
+}
+
+void CThreadPool::WaitAllTask()
+{
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneCondition.wait(lock, [this] { return unfinishedCount.load() == 0; });
 }
 
 void CThreadPool::StopAndWait()
 {
-	for( size_t i = 0; i < threads.size(); i++ ) {
-		{
-			std::unique_lock<std::mutex> lock(params[i]->Mutex);
-			params[i]->Stopped = true;
-			params[i]->ConditionVariable.notify_all();
+	{
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		stopped = true;
+		sleepCondition.notify_all();
+	}
+	for( auto w : workers ) {
+		if( w->Thread.joinable() ) {
+			w->Thread.join();
 		}
-		threads[i]->join();
 	}
 }
 
+void CThreadPool::threadEntry( int threadIndex )
+{
+	currentPool = this;
+	currentThreadIndex = threadIndex;
+	CWorker& worker = *workers[threadIndex];
+
+	while( true ) {
+		CTask* task = findTask(threadIndex, true);
+		if( task != nullptr ) {
+			runTask(task, threadIndex);
+			continue;
+		}
+		if( stopped && queuedCount.load() == 0 && worker.BoundCount.load() == 0 ) {
+			// The pool is being stopped and all the tasks which this thread may execute are completed
+			// The tasks taken but not finished yet by the other threads are completed by them
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingCount.fetch_add(1);
+		sleepCondition.wait(lock, [this, &worker] {
+			return stopped || queuedCount.load() > 0 || worker.BoundCount.load() > 0; });
+		sleepingCount.fetch_sub(1);
+	}
+}
+
+// Looks for a task: the bound ones first, then the thread's own deque, the global queue
+// and finally tries to steal from the other threads
+CTask* CThreadPool::findTask( int threadIndex, bool takeBound )
+{
+	CWorker& worker = *workers[threadIndex];
+	if( takeBound && worker.BoundCount.load(std::memory_order_relaxed) > 0 ) {
+		std::unique_lock<std::mutex> lock(worker.BoundMutex);
+		if( !worker.BoundQueue.empty() ) {
+			CTask* task = worker.BoundQueue.front();
+			worker.BoundQueue.pop();
+			worker.BoundCount.fetch_sub(1);
+			return task;
+		}
+	}
+
+	CTask* task = worker.Deque.Pop();
+	if( task == nullptr && globalCount.load(std::memory_order_relaxed) > 0 ) {
+		std::unique_lock<std::mutex> lock(globalMutex);
+		if( !globalQueue.empty() ) {
+			task = globalQueue.front();
+			globalQueue.pop();
+			globalCount.fetch_sub(1);
+		}
+	}
+	const int threadCount = static_cast<int>(workers.size());
+	for( int i = 1; task == nullptr && i < threadCount; i++ ) {
+		task = workers[(threadIndex + i) % threadCount]->Deque.Steal();
+	}
+
+	if( task != nullptr ) {
+		queuedCount.fetch_sub(1);
+	}
+	return task;
+}
+
+void CThreadPool::runTask( CTask* task, int threadIndex )
+{
+	try {
+		task->Function(threadIndex, task->Params);
+	} catch(...) {
+		ASSERT_EXPR(false); // Better than nothing
+	}
+
+	// The group may be destroyed by its waiter right after the counter reaches zero
+	CThreadPoolTaskGroup* group = task->Group;
+	delete task;
+	const bool isGroupFinished = group != nullptr && group->unfinishedCount.fetch_sub(1) == 1;
+	if( unfinishedCount.fetch_sub(1) == 1 || isGroupFinished ) {
+		notifyDone();
+	}
+}
+
+void CThreadPool::wakeUpThreads()
+{
+	if( sleepingCount.load() > 0 ) {
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepCondition.notify_all();
+	}
+}
+
+void CThreadPool::notifyDone()
+{
+	std::unique_lock<std::mutex> lock(doneMutex);
+	doneCondition.notify_all();
+}
+
 IThreadPool* CreateThreadPool(int threadCount)
 {
 	return new CThreadPool(threadCount);
 }
 
+//------------------------------------------------------------------------------------------------------------
+
+struct CParallelForParams {
+	TParallelForFunction Function;
+	void* Params;
+	int Count;
+	int Grain;
+	std::atomic<int> Next; // the beginning of the next chunk to process
+};
+
+static void parallelForTask( int threadIndex, void* params )
+{
+	CParallelForParams& forParams = *static_cast<CParallelForParams*>( params );
+	for( int begin = forParams.Next.fetch_add( forParams.Grain ); begin < forParams.Count;
+		begin = forParams.Next.fetch_add( forParams.Grain ) )
+	{
+		forParams.Function( threadIndex, forParams.Params, begin, std::min( begin + forParams.Grain, forParams.Count ) );
+	}
+}
+
+void ParallelFor( IThreadPool& threadPool, int count, int grain, void* params, TParallelForFunction function )
+{
+	ASSERT_EXPR( count >= 0 );
+	ASSERT_EXPR( grain > 0 );
+	if( count == 0 ) {
+		return;
+	}
+	if( threadPool.Size() == 1 ) {
+		function( 0, params, 0, count );
+		return;
+	}
+
+	CParallelForParams forParams;
+	forParams.Function = function;
+	forParams.Params = params;
+	forParams.Count = count;
+	forParams.Grain = grain;
+	forParams.Next = 0;
+
+	const int chunkCount = ( count - 1 ) / grain + 1;
+	const int taskCount = std::min( threadPool.Size(), chunkCount );
+	CThreadPoolTaskGroup group;
+	for( int i = 0; i < taskCount; i++ ) {
+		threadPool.AddTask( group, parallelForTask, &forParams );
+	}
+	threadPool.WaitGroup( group );
+}
+
 } // namespace NeoML
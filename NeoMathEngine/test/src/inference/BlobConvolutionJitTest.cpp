@@ -170,6 +170,14 @@ CTestParams JitTestParams[] = {
     CTestParams( "MainParams = {  32,  3,  3,  1,  1,  1,  1,  1,  1,   4,   3, 1 }; ChCount = (1..17); TestCount = 1;" ),
     CTestParams( "MainParams = {  32,  3,  3,  1,  1,  1,  1,  1,  1,   3,   3, 1 }; ChCount = (1..15); TestCount = 1;" ),
     CTestParams( "MainParams = {  32,  9,  9,  1,  1,  1,  1,  4,  1,  97,  37, 1 }; ChCount = (1..17); TestCount = 1;" ),
+    // AVX-512 (FC = 16, 32)
+    // Kernels: wide - 1x12 (FC = 16), 1x6 (FC = 32)
+    // channelCount: batch - 4; single - 8
+    //                            FC  FW  FH  DW  DH  SW  SH  PW  PH SrcW SrcH FT
+    CTestParams( "MainParams = {  16,  3,  3,  1,  1,  1,  1,  1,  1,  14,   3, 1 }; ChCount = (1..9); TestCount = 1;" ),
+    CTestParams( "MainParams = {  16,  3,  3,  1,  1,  1,  1,  1,  1,  27,   4, 0 }; ChCount = (1..9); TestCount = 1;" ),
+    CTestParams( "MainParams = {  32,  3,  3,  1,  1,  1,  1,  1,  1,   8,   3, 1 }; ChCount = (1..9); TestCount = 1;" ),
+    CTestParams( "MainParams = {  32,  5,  5,  2,  1,  2,  1,  2,  2,  33,   6, 0 }; ChCount = (1..9); TestCount = 1;" ),
     // Huge JIT
     CTestParams( "MainParams = {  24, 13, 19,  2,  4,  5,  3,  1,  1, 311, 313, 1 }; ChCount = (25..25); TestCount = 1;" ),
     // Test fillPixelOffset() function
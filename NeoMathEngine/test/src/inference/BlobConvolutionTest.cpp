@@ -112,6 +112,26 @@ class CMathEngineBlobConvolutionTest : public CTestFixtureWithParams {
 
 INSTANTIATE_TEST_CASE_P( CMathEngineBlobConvolutionTestInstantiation, CMathEngineBlobConvolutionTest,
 	::testing::Values(
+		CTestParams(
+			"InputLength = (1..2);"
+			"InputBatch = (1..2);"
+			"InputHeight = (5..17);"
+			"InputWidth = (5..17);"
+			"InputDepth = (1..2);"
+			"InputChannels = (8..12);"
+			"FilterCount = (9..13);"
+			"FilterHeight = 3;"
+			"FilterWidth = 3;"
+			"PaddingHeight = (0..2);"
+			"PaddingWidth = (0..2);"
+			"DilationHeight = 1;"
+			"DilationWidth = 1;"
+			"StrideHeight = 1;"
+			"StrideWidth = 1;"
+			"IsZeroFreeTerm = (0..1);"
+			"Values = (-2..2);"
+			"TestCount = 20;"
+		),
 		CTestParams(
 			"InputLength = (1..3);"
 			"InputBatch = (1..3);"
@@ -639,3 +659,113 @@ TEST_P( CMathEngineBlobConvolutionTest, Random )
 {
 	RUN_TEST_IMPL( blobConvolutionTestImpl );
 }
+
+TEST_F( CMathEngineBlobConvolutionTest, FilterChange )
+{
+	// The descriptor may keep the transformed filter, so the same descriptor is used with different filters
+	CRandom random( 0x1A2B );
+	const int inputHeight = 12;
+	const int inputWidth = 10;
+	const int inputChannels = 16;
+	const int filterCount = 20;
+	const int outputSize = inputHeight * inputWidth * filterCount;
+
+	CREATE_FILL_FLOAT_ARRAY( inputData, -2.f, 2.f, inputHeight * inputWidth * inputChannels, random )
+	CFloatBlob inputBlob( MathEngine(), 1, 1, 1, inputHeight, inputWidth, 1, inputChannels );
+	inputBlob.CopyFrom( inputData.data() );
+	CFloatBlob filterBlob( MathEngine(), filterCount, 3, 3, 1, inputChannels );
+	CFloatBlob outputBlob( MathEngine(), 1, 1, 1, inputHeight, inputWidth, 1, filterCount );
+	std::vector<float> freeTermData( filterCount, 0.f );
+
+	CConvolutionDesc* convDesc = MathEngine().InitBlobConvolution( inputBlob.GetDesc(), 1, 1, 1, 1, 1, 1,
+		filterBlob.GetDesc(), outputBlob.GetDesc() );
+	for( int step = 0; step < 3; step++ ) {
+		CREATE_FILL_FLOAT_ARRAY( filterData, -2.f, 2.f, filterCount * 3 * 3 * inputChannels, random )
+		filterBlob.CopyFrom( filterData.data() );
+		MathEngine().BlobConvolution( *convDesc, inputBlob.GetData(), filterBlob.GetData(), nullptr,
+			outputBlob.GetData() );
+
+		std::vector<float> expectedData( outputSize );
+		std::vector<float> actualData( outputSize );
+		outputBlob.CopyTo( actualData.data() );
+		batchConvolutionForward( inputData.data(), filterData.data(), freeTermData.data(), expectedData.data(),
+			1, 1, inputHeight, inputWidth, 1, inputChannels, 1, 1, filterCount, 3, 3, 1, 1, 1, 1 );
+		for( int i = 0; i < outputSize; ++i ) {
+			ASSERT_TRUE( FloatEq( expectedData[i], actualData[i], 1e-3f ) );
+		}
+	}
+	delete convDesc;
+}
+
+TEST_F( CMathEngineBlobConvolutionTest, FusedReLU )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	// The shapes which are calculated by the different implementations:
+	// Winograd, JIT, the matrix multiplication with stride and dilation, and the 1*1 convolution split by rows,
+	// by channels and with repacking
+	struct CShape {
+		int Height;
+		int Width;
+		int FilterCount;
+		int FilterSize;
+		int Padding;
+		int Stride;
+		int Dilation;
+	};
+	const CShape shapes[] = {
+		{ 12, 10, 20, 3, 1, 1, 1 },
+		{ 12, 10, 24, 3, 1, 1, 1 },
+		{ 13, 11, 20, 3, 1, 2, 1 },
+		{ 13, 11, 20, 3, 2, 1, 2 },
+		{ 12, 10, 20, 1, 0, 1, 1 },
+		{ 2, 2, 40, 1, 0, 1, 1 },
+		{ 13, 11, 20, 1, 0, 2, 1 }
+	};
+
+	CRandom random( 0x3C4D );
+	const int batch = 2;
+	const int inputChannels = 16;
+	for( const CShape& shape : shapes ) {
+		for( float threshold : { 0.f, 1.5f } ) {
+			const int outputHeight = calcConvOutputSize( shape.Height, shape.Padding, shape.FilterSize, shape.Dilation, shape.Stride );
+			const int outputWidth = calcConvOutputSize( shape.Width, shape.Padding, shape.FilterSize, shape.Dilation, shape.Stride );
+			const int outputSize = batch * outputHeight * outputWidth * shape.FilterCount;
+
+			CREATE_FILL_FLOAT_ARRAY( inputData, -2.f, 2.f, batch * shape.Height * shape.Width * inputChannels, random )
+			CFloatBlob inputBlob( MathEngine(), 1, batch, 1, shape.Height, shape.Width, 1, inputChannels );
+			inputBlob.CopyFrom( inputData.data() );
+			CREATE_FILL_FLOAT_ARRAY( filterData, -1.f, 1.f,
+				shape.FilterCount * shape.FilterSize * shape.FilterSize * inputChannels, random )
+			CFloatBlob filterBlob( MathEngine(), shape.FilterCount, shape.FilterSize, shape.FilterSize, 1, inputChannels );
+			filterBlob.CopyFrom( filterData.data() );
+			CREATE_FILL_FLOAT_ARRAY( freeTermData, -1.f, 1.f, shape.FilterCount, random )
+			CFloatBlob freeTermBlob( MathEngine(), 1, 1, 1, shape.FilterCount );
+			freeTermBlob.CopyFrom( freeTermData.data() );
+			CFloatBlob outputBlob( MathEngine(), 1, batch, 1, outputHeight, outputWidth, 1, shape.FilterCount );
+
+			CConvolutionDesc* convDesc = MathEngine().InitBlobConvolution( inputBlob.GetDesc(), shape.Padding, shape.Padding,
+				shape.Stride, shape.Stride, shape.Dilation, shape.Dilation, filterBlob.GetDesc(), outputBlob.GetDesc() );
+			CConstFloatHandle freeTermHandle = freeTermBlob.GetData();
+			MathEngine().BlobConvolutionWithActivation( *convDesc, inputBlob.GetData(), filterBlob.GetData(), &freeTermHandle,
+				CFusedActivation( AF_ReLU, threshold ), outputBlob.GetData() );
+			delete convDesc;
+
+			std::vector<float> expectedData( outputSize );
+			std::vector<float> actualData( outputSize );
+			outputBlob.CopyTo( actualData.data() );
+			batchConvolutionForward( inputData.data(), filterData.data(), freeTermData.data(), expectedData.data(),
+				1, batch, shape.Height, shape.Width, 1, inputChannels, shape.Padding, shape.Padding, shape.FilterCount,
+				shape.FilterSize, shape.FilterSize, shape.Dilation, shape.Dilation, shape.Stride, shape.Stride );
+			for( int i = 0; i < outputSize; ++i ) {
+				float expected = std::max( expectedData[i], 0.f );
+				if( threshold > 0 ) {
+					expected = std::min( expected, threshold );
+				}
+				ASSERT_TRUE( FloatEq( expected, actualData[i], 1e-3f ) );
+			}
+		}
+	}
+}
@@ -0,0 +1,152 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+#include <MeTestCommon.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Replaces the values by their quantized approximations: round( x / scale ) * scale, saturated to 127 levels
+static void fakeQuantize( float* data, int size, float scale )
+{
+	const float multiplier = 1.f / scale;
+	for( int i = 0; i < size; ++i ) {
+		data[i] = std::min( std::max( std::round( data[i] * multiplier ), -127.f ), 127.f ) * scale;
+	}
+}
+
+static void blobQuantizedConvolutionTestImpl( const CTestParams& params, int seed )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( seed );
+
+	const CInterval batchInterval = params.GetInterval( "InputBatch" );
+	const CInterval inputHeightInterval = params.GetInterval( "InputHeight" );
+	const CInterval inputWidthInterval = params.GetInterval( "InputWidth" );
+	const CInterval channelsInterval = params.GetInterval( "InputChannels" );
+	const CInterval paddingInterval = params.GetInterval( "Padding" );
+	const CInterval filterCountInterval = params.GetInterval( "FilterCount" );
+	const CInterval filterSizeInterval = params.GetInterval( "FilterSize" );
+	const CInterval dilationInterval = params.GetInterval( "Dilation" );
+	const CInterval strideInterval = params.GetInterval( "Stride" );
+	const CInterval valuesInterval = params.GetInterval( "Values" );
+
+	const int inputBatch = random.UniformInt( batchInterval.Begin, batchInterval.End );
+	const int inputHeight = random.UniformInt( inputHeightInterval.Begin, inputHeightInterval.End );
+	const int inputWidth = random.UniformInt( inputWidthInterval.Begin, inputWidthInterval.End );
+	const int inputChannels = random.UniformInt( channelsInterval.Begin, channelsInterval.End );
+	const int padding = random.UniformInt( paddingInterval.Begin, paddingInterval.End );
+	const int filterCount = random.UniformInt( filterCountInterval.Begin, filterCountInterval.End );
+	const int filterSize = random.UniformInt( filterSizeInterval.Begin, filterSizeInterval.End );
+	const int dilation = random.UniformInt( dilationInterval.Begin, dilationInterval.End );
+	const int stride = random.UniformInt( strideInterval.Begin, strideInterval.End );
+	const int outputHeight = calcConvOutputSize( inputHeight, padding, filterSize, dilation, stride );
+	const int outputWidth = calcConvOutputSize( inputWidth, padding, filterSize, dilation, stride );
+	const int filterObjectSize = filterSize * filterSize * inputChannels;
+	// The static input scale is used so that the quantized input doesn't depend on the way the image is unrolled
+	const float sourceScale = static_cast<float>( valuesInterval.End ) / 127;
+
+	CREATE_FILL_FLOAT_ARRAY( inputData, valuesInterval.Begin, valuesInterval.End,
+		inputBatch * inputHeight * inputWidth * inputChannels, random )
+	CFloatBlob inputBlob( MathEngine(), 1, inputBatch, 1, inputHeight, inputWidth, 1, inputChannels );
+	inputBlob.CopyFrom( inputData.data() );
+
+	CREATE_FILL_FLOAT_ARRAY( filterData, valuesInterval.Begin, valuesInterval.End, filterCount * filterObjectSize, random )
+	CFloatBlob filterBlob( MathEngine(), filterCount, filterSize, filterSize, 1, inputChannels );
+	filterBlob.CopyFrom( filterData.data() );
+
+	CREATE_FILL_FLOAT_ARRAY( freeTermData, valuesInterval.Begin, valuesInterval.End, filterCount, random )
+	CFloatBlob freeTermBlob( MathEngine(), 1, 1, 1, filterCount );
+	freeTermBlob.CopyFrom( freeTermData.data() );
+
+	CFloatBlob outputBlob( MathEngine(), 1, inputBatch, 1, outputHeight, outputWidth, 1, filterCount );
+
+	CConvolutionDesc* convDesc = MathEngine().InitBlobConvolution( inputBlob.GetDesc(), padding, padding, stride, stride,
+		dilation, dilation, filterBlob.GetDesc(), outputBlob.GetDesc() );
+	CQuantizedMatrixDesc* quantizedFilter = MathEngine().InitQuantizedMatrix( filterBlob.GetData(), filterCount, filterObjectSize );
+	CConstFloatHandle freeTermDataPtr = freeTermBlob.GetData();
+	MathEngine().BlobQuantizedConvolution( *convDesc, inputBlob.GetData(), sourceScale, *quantizedFilter,
+		&freeTermDataPtr, CFusedActivation(), outputBlob.GetData() );
+	delete quantizedFilter;
+	delete convDesc;
+
+	const int outputSize = inputBatch * outputHeight * outputWidth * filterCount;
+	std::vector<float> actualData( outputSize );
+	outputBlob.CopyTo( actualData.data() );
+
+	// The quantized convolution is equal to the float convolution of the quantized data
+	fakeQuantize( inputData.data(), static_cast<int>( inputData.size() ), sourceScale );
+	for( int i = 0; i < filterCount; ++i ) {
+		float* filter = filterData.data() + i * filterObjectSize;
+		float maxAbs = 0;
+		for( int j = 0; j < filterObjectSize; ++j ) {
+			maxAbs = std::max( maxAbs, std::fabs( filter[j] ) );
+		}
+		fakeQuantize( filter, filterObjectSize, maxAbs > 0 ? maxAbs / 127 : 1.f );
+	}
+	std::vector<float> expectedData( outputSize );
+	batchConvolutionForward( inputData.data(), filterData.data(), freeTermData.data(), expectedData.data(),
+		1, inputBatch, inputHeight, inputWidth, 1, inputChannels, padding, padding, filterCount, filterSize, filterSize,
+		dilation, dilation, stride, stride );
+
+	for( int i = 0; i < outputSize; ++i ) {
+		ASSERT_TRUE( FloatEq( expectedData[i], actualData[i], 1e-3f ) );
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+class CMathEngineBlobQuantizedConvolutionTest : public CTestFixtureWithParams {
+};
+
+INSTANTIATE_TEST_CASE_P( CMathEngineBlobQuantizedConvolutionTestInstantiation, CMathEngineBlobQuantizedConvolutionTest,
+	::testing::Values(
+		CTestParams(
+			"InputBatch = (1..3);"
+			"InputHeight = (5..15);"
+			"InputWidth = (5..15);"
+			"InputChannels = (1..8);"
+			"FilterCount = (1..8);"
+			"FilterSize = (1..3);"
+			"Padding = (0..1);"
+			"Dilation = (1..2);"
+			"Stride = (1..2);"
+			"Values = (-1..1);"
+			"TestCount = 50;"
+		),
+		CTestParams(
+			"InputBatch = 2;"
+			"InputHeight = (20..30);"
+			"InputWidth = (20..30);"
+			"InputChannels = (16..32);"
+			"FilterCount = (16..32);"
+			"FilterSize = 3;"
+			"Padding = 1;"
+			"Dilation = 1;"
+			"Stride = 1;"
+			"Values = (-10..10);"
+			"TestCount = 5;"
+		)
+	)
+);
+
+TEST_P( CMathEngineBlobQuantizedConvolutionTest, Random )
+{
+	RUN_TEST_IMPL( blobQuantizedConvolutionTestImpl )
+}
@@ -0,0 +1,152 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// Calculates the convolutions of all three kinds on the given math engine
+static void calculateConvolutions( IMathEngine& mathEngine, const std::vector<float>& inputData,
+	const std::vector<float>& filterData, const std::vector<float>& freeTermData, std::vector<float>& results )
+{
+	results.clear();
+	CFloatBlob input( mathEngine, 1, 2, 1, 20, 18, 1, 16 );
+	input.CopyFrom( inputData.data() );
+
+	// The 3*3 convolutions with and without padding, and the 1*1 convolution
+	for( int filterSize : { 3, 1 } ) {
+		for( int padding = 0; padding <= 1; padding++ ) {
+			const int outputHeight = input.GetDesc().Height() - filterSize + 1 + 2 * padding;
+			const int outputWidth = input.GetDesc().Width() - filterSize + 1 + 2 * padding;
+			CFloatBlob filter( mathEngine, 24, filterSize, filterSize, 16 );
+			filter.CopyFrom( filterData.data() );
+			CFloatBlob freeTerm( mathEngine, 1, 1, 1, 24 );
+			freeTerm.CopyFrom( freeTermData.data() );
+			CFloatBlob output( mathEngine, 1, 2, 1, outputHeight, outputWidth, 1, 24 );
+			CConvolutionDesc* desc = mathEngine.InitBlobConvolution( input.GetDesc(), padding, padding, 1, 1, 1, 1,
+				filter.GetDesc(), output.GetDesc() );
+			CConstFloatHandle freeTermHandle = freeTerm.GetData();
+			mathEngine.BlobConvolution( *desc, input.GetData(), filter.GetData(), &freeTermHandle, output.GetData() );
+			delete desc;
+
+			std::vector<float> result( output.GetDataSize() );
+			output.CopyTo( result.data() );
+			results.insert( results.end(), result.begin(), result.end() );
+		}
+	}
+
+	// The channelwise convolutions with stride 1 and 2
+	for( int stride = 1; stride <= 2; stride++ ) {
+		CFloatBlob filter( mathEngine, 1, 3, 3, 16 );
+		filter.CopyFrom( filterData.data() );
+		CFloatBlob freeTerm( mathEngine, 1, 1, 1, 16 );
+		freeTerm.CopyFrom( freeTermData.data() );
+		CFloatBlob output( mathEngine, 1, 2, 1, ( 20 - 1 ) / stride + 1, ( 18 - 1 ) / stride + 1, 1, 16 );
+		CChannelwiseConvolutionDesc* desc = mathEngine.InitBlobChannelwiseConvolution( input.GetDesc(), 1, 1,
+			stride, stride, filter.GetDesc(), &freeTerm.GetDesc(), output.GetDesc() );
+		CConstFloatHandle freeTermHandle = freeTerm.GetData();
+		mathEngine.BlobChannelwiseConvolution( *desc, input.GetData(), filter.GetData(), &freeTermHandle, output.GetData() );
+		delete desc;
+
+		std::vector<float> result( output.GetDataSize() );
+		output.CopyTo( result.data() );
+		results.insert( results.end(), result.begin(), result.end() );
+	}
+
+	// The time convolution
+	{
+		CFloatBlob sequence( mathEngine, 30, 2, 1, 1, 1, 1, 16 );
+		sequence.CopyFrom( inputData.data() );
+		CFloatBlob filter( mathEngine, 8, 3, 1, 1, 16 );
+		filter.CopyFrom( filterData.data() );
+		CFloatBlob freeTerm( mathEngine, 1, 1, 1, 8 );
+		freeTerm.CopyFrom( freeTermData.data() );
+		CFloatBlob output( mathEngine, 30, 2, 1, 1, 1, 1, 8 );
+		CTimeConvolutionDesc* desc = mathEngine.InitTimeConvolution( sequence.GetDesc(), 1, 1, 1, 1,
+			filter.GetDesc(), output.GetDesc() );
+		mathEngine.BlobTimeConvolution( *desc, sequence.GetData(), filter.GetData(), freeTerm.GetData(), output.GetData() );
+		delete desc;
+
+		std::vector<float> result( output.GetDataSize() );
+		output.CopyTo( result.data() );
+		results.insert( results.end(), result.begin(), result.end() );
+	}
+}
+
+static std::string readFile( const char* fileName )
+{
+	std::ifstream file( fileName );
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+class CMathEngineConvolutionAutotuningTest : public CTestFixture {
+};
+
+TEST_F( CMathEngineConvolutionAutotuningTest, TunedResultsAndCache )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( 0x2A1 );
+	CREATE_FILL_FLOAT_ARRAY( inputData, -2, 2, 2 * 20 * 18 * 16, random )
+	CREATE_FILL_FLOAT_ARRAY( filterData, -2, 2, 24 * 3 * 3 * 16, random )
+	CREATE_FILL_FLOAT_ARRAY( freeTermData, -2, 2, 24, random )
+
+	std::unique_ptr<IMathEngine> referenceEngine( CreateCpuMathEngine( 2, 0 ) );
+	std::vector<float> expected;
+	calculateConvolutions( *referenceEngine, inputData, filterData, freeTermData, expected );
+
+	// The tuned convolutions calculate the same results
+	std::unique_ptr<IMathEngine> tunedEngine( CreateCpuMathEngine( 2, 0 ) );
+	tunedEngine->SetConvolutionAutotuningMode( true );
+	std::vector<float> results;
+	calculateConvolutions( *tunedEngine, inputData, filterData, freeTermData, results );
+	ASSERT_EQ( expected.size(), results.size() );
+	for( size_t i = 0; i < expected.size(); i++ ) {
+		ASSERT_NEAR( expected[i], results[i], 1e-3f * std::max( 1.f, std::fabs( expected[i] ) ) );
+	}
+
+	const char* fileName = "ConvolutionAutotuning.cache";
+	const char* loadedFileName = "ConvolutionAutotuningLoaded.cache";
+	ASSERT_TRUE( tunedEngine->SaveConvolutionAutotuningCache( fileName ) );
+
+	// Another math engine uses the loaded choices without tuning
+	std::unique_ptr<IMathEngine> loadedEngine( CreateCpuMathEngine( 2, 0 ) );
+	EXPECT_FALSE( loadedEngine->LoadConvolutionAutotuningCache( "NonExistent.cache" ) );
+	ASSERT_TRUE( loadedEngine->LoadConvolutionAutotuningCache( fileName ) );
+	calculateConvolutions( *loadedEngine, inputData, filterData, freeTermData, results );
+	ASSERT_EQ( expected.size(), results.size() );
+	for( size_t i = 0; i < expected.size(); i++ ) {
+		ASSERT_NEAR( expected[i], results[i], 1e-3f * std::max( 1.f, std::fabs( expected[i] ) ) );
+	}
+	ASSERT_TRUE( loadedEngine->SaveConvolutionAutotuningCache( loadedFileName ) );
+	const std::string savedCache = readFile( fileName );
+	EXPECT_FALSE( savedCache.empty() );
+	EXPECT_EQ( savedCache, readFile( loadedFileName ) );
+
+	std::remove( fileName );
+	std::remove( loadedFileName );
+}
@@ -0,0 +1,151 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+#include <cmath>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static void layerNormalizationNaive( int objectCount, int objectSize, const float* input, float epsilon,
+	const float* scale, const float* bias, float* normalized, float* invSqrtVariance, float* result )
+{
+	for( int i = 0; i < objectCount; ++i ) {
+		const float* object = input + i * objectSize;
+		double mean = 0;
+		for( int j = 0; j < objectSize; ++j ) {
+			mean += object[j];
+		}
+		mean /= objectSize;
+		double variance = 0;
+		for( int j = 0; j < objectSize; ++j ) {
+			variance += ( object[j] - mean ) * ( object[j] - mean );
+		}
+		variance /= objectSize;
+		const double invSqrtVar = 1. / std::sqrt( variance + epsilon );
+		invSqrtVariance[i] = static_cast<float>( invSqrtVar );
+		for( int j = 0; j < objectSize; ++j ) {
+			const double norm = ( object[j] - mean ) * invSqrtVar;
+			normalized[i * objectSize + j] = static_cast<float>( norm );
+			result[i * objectSize + j] = static_cast<float>( norm * scale[j] + bias[j] );
+		}
+	}
+}
+
+static void layerNormalizationTestImpl( const CTestParams& params, int seed )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( seed );
+
+	const CInterval objectCountInterval = params.GetInterval( "ObjectCount" );
+	const CInterval objectSizeInterval = params.GetInterval( "ObjectSize" );
+	const CInterval valuesInterval = params.GetInterval( "Values" );
+	const float shift = static_cast<float>( params.GetValue<double>( "Shift" ) );
+
+	const int objectCount = random.UniformInt( objectCountInterval.Begin, objectCountInterval.End );
+	const int objectSize = random.UniformInt( objectSizeInterval.Begin, objectSizeInterval.End );
+	const float epsilon = 1e-5f;
+
+	CREATE_FILL_FLOAT_ARRAY( input, valuesInterval.Begin, valuesInterval.End, objectCount * objectSize, random )
+	for( float& value : input ) {
+		value += shift;
+	}
+	CREATE_FILL_FLOAT_ARRAY( scale, valuesInterval.Begin, valuesInterval.End, objectSize, random )
+	CREATE_FILL_FLOAT_ARRAY( bias, valuesInterval.Begin, valuesInterval.End, objectSize, random )
+
+	std::vector<float> expectedNormalized( objectCount * objectSize );
+	std::vector<float> expectedInvSqrtVariance( objectCount );
+	std::vector<float> expected( objectCount * objectSize );
+	layerNormalizationNaive( objectCount, objectSize, input.data(), epsilon, scale.data(), bias.data(),
+		expectedNormalized.data(), expectedInvSqrtVariance.data(), expected.data() );
+
+	CFloatBlob inputBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	inputBlob.CopyFrom( input.data() );
+	CFloatBlob scaleBlob( MathEngine(), 1, 1, 1, objectSize );
+	scaleBlob.CopyFrom( scale.data() );
+	CFloatBlob biasBlob( MathEngine(), 1, 1, 1, objectSize );
+	biasBlob.CopyFrom( bias.data() );
+	CFloatBlob normalizedBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	CFloatBlob invSqrtVarianceBlob( MathEngine(), 1, 1, 1, objectCount );
+	CFloatBlob resultBlob( MathEngine(), objectCount, 1, 1, objectSize );
+
+	CFloatHandle normalizedHandle = normalizedBlob.GetData();
+	CFloatHandle invSqrtVarianceHandle = invSqrtVarianceBlob.GetData();
+	MathEngine().LayerNormalization( objectCount, objectSize, inputBlob.GetData(), epsilon, scaleBlob.GetData(),
+		biasBlob.GetData(), resultBlob.GetData(), &normalizedHandle, &invSqrtVarianceHandle );
+
+	std::vector<float> result( objectCount * objectSize );
+	resultBlob.CopyTo( result.data() );
+	std::vector<float> normalized( objectCount * objectSize );
+	normalizedBlob.CopyTo( normalized.data() );
+	std::vector<float> invSqrtVariance( objectCount );
+	invSqrtVarianceBlob.CopyTo( invSqrtVariance.data() );
+
+	for( int i = 0; i < objectCount; ++i ) {
+		ASSERT_NEAR( expectedInvSqrtVariance[i], invSqrtVariance[i], 1e-3f * expectedInvSqrtVariance[i] );
+	}
+	for( size_t i = 0; i < result.size(); ++i ) {
+		ASSERT_NEAR( expectedNormalized[i], normalized[i], 1e-3f );
+		ASSERT_NEAR( expected[i], result[i], 1e-2f );
+	}
+
+	// In-place calculation without the optional outputs
+	MathEngine().LayerNormalization( objectCount, objectSize, inputBlob.GetData(), epsilon, scaleBlob.GetData(),
+		biasBlob.GetData(), inputBlob.GetData(), nullptr, nullptr );
+	inputBlob.CopyTo( result.data() );
+	for( size_t i = 0; i < result.size(); ++i ) {
+		ASSERT_NEAR( expected[i], result[i], 1e-2f );
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+class CMathEngineLayerNormalizationTest : public CTestFixtureWithParams {
+};
+
+INSTANTIATE_TEST_CASE_P( CMathEngineLayerNormalizationTestInstantiation, CMathEngineLayerNormalizationTest,
+	::testing::Values(
+		CTestParams(
+			"ObjectCount = (1..50);"
+			"ObjectSize = (1..40);"
+			"Values = (-10..10);"
+			"Shift = 0;"
+			"TestCount = 100;"
+		),
+		CTestParams(
+			"ObjectCount = (1..10);"
+			"ObjectSize = (100..1000);"
+			"Values = (-1..1);"
+			"Shift = 0;"
+			"TestCount = 20;"
+		),
+		// The values far from zero check the numerical stability of the variance
+		CTestParams(
+			"ObjectCount = (1..10);"
+			"ObjectSize = (100..1000);"
+			"Values = (-1..1);"
+			"Shift = 1000;"
+			"TestCount = 20;"
+		)
+	)
+);
+
+TEST_P( CMathEngineLayerNormalizationTest, Random )
+{
+	RUN_TEST_IMPL( layerNormalizationTestImpl )
+}
@@ -0,0 +1,137 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+using namespace std::chrono;
+
+// The sizes of the buffers allocated in the test (in floats)
+static const int allocatorTestSizes[] = { 16, 100, 256, 1000, 4096, 20000 };
+static const int allocatorTestSizeCount = sizeof( allocatorTestSizes ) / sizeof( *allocatorTestSizes );
+
+// Allocates and frees the buffers on several threads
+// Half of the buffers are freed by the next thread
+// Returns the number of errors
+static int runAllocatorTestThreads( IMathEngine& mathEngine, int threadCount, int iterationCount )
+{
+	std::vector<std::vector<CFloatHandle>> passed( threadCount );
+	std::vector<std::mutex> passedMutexes( threadCount );
+	std::atomic<int> errorCount( 0 );
+
+	std::vector<std::thread> threads;
+	for( int t = 0; t < threadCount; ++t ) {
+		threads.emplace_back( [&, t]() {
+			mathEngine.SetReuseMemoryMode( true );
+			std::vector<CFloatHandle> handles;
+			std::vector<CFloatHandle> received;
+			for( int i = 0; i < iterationCount; ++i ) {
+				for( int j = 0; j < allocatorTestSizeCount; ++j ) {
+					const int size = allocatorTestSizes[( i + j + t ) % allocatorTestSizeCount];
+					CFloatHandle handle = mathEngine.HeapAllocTyped<float>( size );
+					handle.SetValueAt( 0, static_cast<float>( t ) );
+					handle.SetValueAt( size - 1, static_cast<float>( i ) );
+					handles.push_back( handle );
+				}
+				for( size_t j = 0; j < handles.size(); ++j ) {
+					const int size = allocatorTestSizes[( i + j + t ) % allocatorTestSizeCount];
+					// The buffers must not intersect
+					if( handles[j].GetValueAt( 0 ) != t || handles[j].GetValueAt( size - 1 ) != i ) {
+						++errorCount;
+					}
+					if( j % 2 == 0 ) {
+						mathEngine.HeapFree( handles[j] );
+					} else {
+						std::lock_guard<std::mutex> lock( passedMutexes[( t + 1 ) % threadCount] );
+						passed[( t + 1 ) % threadCount].push_back( handles[j] );
+					}
+				}
+				handles.clear();
+
+				{
+					std::lock_guard<std::mutex> lock( passedMutexes[t] );
+					received.swap( passed[t] );
+				}
+				for( const CFloatHandle& handle : received ) {
+					mathEngine.HeapFree( handle );
+				}
+				received.clear();
+			}
+			mathEngine.CleanUp();
+		} );
+	}
+	for( std::thread& thread : threads ) {
+		thread.join();
+	}
+
+	for( int t = 0; t < threadCount; ++t ) {
+		for( const CFloatHandle& handle : passed[t] ) {
+			mathEngine.HeapFree( handle );
+		}
+	}
+	return errorCount;
+}
+
+TEST( CMathEngineMemoryAllocatorTest, ThreadCache )
+{
+	const size_t memoryLimit = 256 * 1024 * 1024;
+	std::unique_ptr<IMathEngine> mathEngine( CreateCpuMathEngine( 1, memoryLimit, CMA_ThreadCache ) );
+	EXPECT_EQ( 0, runAllocatorTestThreads( *mathEngine, 4, 100 ) );
+	EXPECT_EQ( memoryLimit, mathEngine->GetFreeMemorySize() );
+	EXPECT_LT( 0u, mathEngine->GetPeakMemoryUsage() );
+
+	// The buffer freed on the same thread is reused
+	mathEngine->SetReuseMemoryMode( true );
+	CFloatHandle first = mathEngine->HeapAllocTyped<float>( 1000 );
+	mathEngine->HeapFree( first );
+	EXPECT_LT( 0u, mathEngine->GetMemoryInPools() );
+	CFloatHandle second = mathEngine->HeapAllocTyped<float>( 900 );
+	EXPECT_TRUE( first == second );
+	mathEngine->HeapFree( second );
+	mathEngine->CleanUp();
+	EXPECT_EQ( 0u, mathEngine->GetMemoryInPools() );
+
+	// Without the reuse mode the buffers are freed at once
+	mathEngine->SetReuseMemoryMode( false );
+	CFloatHandle handle = mathEngine->HeapAllocTyped<float>( 1000 );
+	EXPECT_EQ( memoryLimit - 1000 * sizeof( float ), mathEngine->GetFreeMemorySize() );
+	mathEngine->HeapFree( handle );
+	EXPECT_EQ( 0u, mathEngine->GetMemoryInPools() );
+}
+
+// Compares the allocators on many threads working with the same math engine
+// Takes several seconds, so it is disabled by default (run with --gtest_also_run_disabled_tests)
+TEST( CMathEngineMemoryAllocatorTest, DISABLED_Performance )
+{
+	const int threadCount = std::max( 2, static_cast<int>( std::thread::hardware_concurrency() ) );
+	const int iterationCount = 2000;
+	const TCpuMemoryAllocator allocators[] = { CMA_Pool, CMA_ThreadCache };
+	const char* allocatorNames[] = { "Pool", "ThreadCache" };
+	for( int i = 0; i < 2; ++i ) {
+		std::unique_ptr<IMathEngine> mathEngine( CreateCpuMathEngine( 1, 0, allocators[i] ) );
+		auto startTime = high_resolution_clock::now();
+		EXPECT_EQ( 0, runAllocatorTestThreads( *mathEngine, threadCount, iterationCount ) );
+		auto stopTime = high_resolution_clock::now();
+		GTEST_LOG_( INFO ) << allocatorNames[i] << " allocator, " << threadCount << " threads: "
+			<< duration_cast<microseconds>( stopTime - startTime ).count() / 1000. << " ms.";
+	}
+}
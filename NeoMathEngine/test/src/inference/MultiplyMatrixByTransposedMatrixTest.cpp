@@ -124,6 +124,44 @@ TEST_P( CMultiplyMatrixByTransposedMatrixTest, Random )
 	RUN_TEST_IMPL( multiplyMatrixByTransposedMatrixTestImpl )
 }
 
+TEST_F( CMultiplyMatrixByTransposedMatrixTest, WithReLU )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	// The last shape is calculated by several blocks of rows
+	const int shapes[][3] = { { 1, 20, 30 }, { 17, 33, 9 }, { 300, 40, 100 } };
+	CRandom random( 0x7A8B );
+	for( const auto& shape : shapes ) {
+		const int firstHeight = shape[0];
+		const int firstWidth = shape[1];
+		const int secondHeight = shape[2];
+		CREATE_FILL_FLOAT_ARRAY( a, -1.f, 1.f, firstHeight * firstWidth, random )
+		CREATE_FILL_FLOAT_ARRAY( b, -1.f, 1.f, firstWidth * secondHeight, random )
+		CREATE_FILL_FLOAT_ARRAY( freeTerm, -1.f, 1.f, secondHeight, random )
+
+		std::vector<float> product( firstHeight * secondHeight, 0.f );
+		multiplyMatrixByTransposedMatrixAndAddNaive( 1, a, b, firstHeight, firstWidth, secondHeight, product );
+		for( float threshold : { 0.f, 0.5f } ) {
+			std::vector<float> result( firstHeight * secondHeight );
+			CFloatWrapper freeTermWrapper( MathEngine(), freeTerm.data(), secondHeight );
+			CConstFloatHandle freeTermHandle = freeTermWrapper;
+			MathEngine().MultiplyMatrixByTransposedMatrixWithActivation( CARRAY_FLOAT_WRAPPER( a ), firstHeight, firstWidth,
+				CARRAY_FLOAT_WRAPPER( b ), secondHeight, &freeTermHandle, CFusedActivation( AF_ReLU, threshold ),
+				CARRAY_FLOAT_WRAPPER( result ) );
+
+			for( int i = 0; i < firstHeight * secondHeight; ++i ) {
+				float expected = std::max( product[i] + freeTerm[i % secondHeight], 0.f );
+				if( threshold > 0 ) {
+					expected = std::min( expected, threshold );
+				}
+				ASSERT_NEAR( expected, result[i], 1e-3 );
+			}
+		}
+	}
+}
+
 class CBatchMultiplyMatrixByTransposedMatrixTest : public CTestFixtureWithParams {
 };
 
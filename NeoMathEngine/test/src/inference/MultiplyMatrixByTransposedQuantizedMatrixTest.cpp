@@ -0,0 +1,191 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+
+#include <chrono>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+using namespace std::chrono;
+
+// Quantizes the vector exactly as the math engine does: symmetric, 127 levels
+static float quantizeNaive( const float* data, int size, float scale, std::vector<int>& result )
+{
+	if( scale <= 0 ) {
+		float maxAbs = 0;
+		for( int i = 0; i < size; ++i ) {
+			maxAbs = std::max( maxAbs, std::fabs( data[i] ) );
+		}
+		scale = maxAbs > 0 ? maxAbs / 127 : 1.f;
+	}
+	const float multiplier = 1.f / scale;
+	result.resize( size );
+	for( int i = 0; i < size; ++i ) {
+		result[i] = static_cast<int>( std::min( std::max( std::round( data[i] * multiplier ), -127.f ), 127.f ) );
+	}
+	return scale;
+}
+
+static void multiplyMatrixByTransposedQuantizedMatrixTestImpl( const CTestParams& params, int seed )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( seed );
+
+	const CInterval heightInterval = params.GetInterval( "Height" );
+	const CInterval widthInterval = params.GetInterval( "Width" );
+	const CInterval valuesInterval = params.GetInterval( "Values" );
+	const bool isStaticScale = params.GetValue<int>( "IsStaticScale" ) == 1;
+	const bool isZeroFreeTerm = params.GetValue<int>( "IsZeroFreeTerm" ) == 1;
+
+	const int secondHeight = random.UniformInt( heightInterval.Begin, heightInterval.End );
+	const int firstHeight = random.UniformInt( heightInterval.Begin, heightInterval.End );
+	const int firstWidth = random.UniformInt( widthInterval.Begin, widthInterval.End );
+
+	CREATE_FILL_FLOAT_ARRAY( a, valuesInterval.Begin, valuesInterval.End, firstHeight * firstWidth, random )
+	CREATE_FILL_FLOAT_ARRAY( b, valuesInterval.Begin, valuesInterval.End, firstWidth * secondHeight, random )
+	CREATE_FILL_FLOAT_ARRAY( freeTerm, valuesInterval.Begin, valuesInterval.End, secondHeight, random )
+	// The static scale is deliberately a bit too small so that the saturation is checked too
+	const float firstScale = isStaticScale ? static_cast<float>( valuesInterval.End ) / 150 : 0.f;
+
+	std::vector<float> expected( firstHeight * secondHeight );
+	std::vector<int> quantizedFirst;
+	std::vector<int> quantizedSecond;
+	for( int i = 0; i < firstHeight; ++i ) {
+		const float rowScale = quantizeNaive( a.data() + i * firstWidth, firstWidth, firstScale, quantizedFirst );
+		for( int j = 0; j < secondHeight; ++j ) {
+			const float secondScale = quantizeNaive( b.data() + j * firstWidth, firstWidth, 0.f, quantizedSecond );
+			int product = 0;
+			for( int k = 0; k < firstWidth; ++k ) {
+				product += quantizedFirst[k] * quantizedSecond[k];
+			}
+			expected[i * secondHeight + j] = product * rowScale * secondScale + ( isZeroFreeTerm ? 0.f : freeTerm[j] );
+		}
+	}
+
+	CQuantizedMatrixDesc* quantizedDesc = MathEngine().InitQuantizedMatrix( CARRAY_FLOAT_WRAPPER( b ), secondHeight, firstWidth );
+	CFloatWrapper freeTermWrapper( MathEngine(), freeTerm.data(), secondHeight );
+	CConstFloatHandle freeTermHandle = freeTermWrapper;
+	std::vector<float> result( firstHeight * secondHeight );
+	MathEngine().MultiplyMatrixByTransposedQuantizedMatrix( CARRAY_FLOAT_WRAPPER( a ), firstHeight, firstWidth, firstScale,
+		*quantizedDesc, isZeroFreeTerm ? nullptr : &freeTermHandle, CFusedActivation(), CARRAY_FLOAT_WRAPPER( result ) );
+	delete quantizedDesc;
+
+	for( int i = 0; i < firstHeight * secondHeight; ++i ) {
+		ASSERT_TRUE( FloatEq( expected[i], result[i], 1e-3f ) );
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+class CMultiplyMatrixByTransposedQuantizedMatrixTest : public CTestFixtureWithParams {
+};
+
+INSTANTIATE_TEST_CASE_P( CMultiplyMatrixByTransposedQuantizedMatrixTestInstantiation, CMultiplyMatrixByTransposedQuantizedMatrixTest,
+	::testing::Values(
+		CTestParams(
+			"Height = (1..50);"
+			"Width = (1..50);"
+			"Values = (-1..1);"
+			"IsStaticScale = (0..1);"
+			"IsZeroFreeTerm = (0..1);"
+			"TestCount = 100;"
+		),
+		CTestParams(
+			"Height = (100..300);"
+			"Width = (100..500);"
+			"Values = (-10..10);"
+			"IsStaticScale = (0..1);"
+			"IsZeroFreeTerm = (0..1);"
+			"TestCount = 5;"
+		)
+	)
+);
+
+TEST_P( CMultiplyMatrixByTransposedQuantizedMatrixTest, Random )
+{
+	RUN_TEST_IMPL( multiplyMatrixByTransposedQuantizedMatrixTestImpl )
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Compares the int8 multiplication with the float one on the typical fully connected layer shapes
+class CMultiplyMatrixByTransposedQuantizedMatrixPerformanceTest : public CTestFixture {
+public:
+	void SetUp() override { MathEngine().CleanUp(); }
+};
+
+TEST_F( CMultiplyMatrixByTransposedQuantizedMatrixPerformanceTest, CompareWithFloat )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	const int runCount = 10;
+	// FirstHeight | FirstWidth | SecondHeight
+	const int shapes[][3] = {
+		{ 1, 1024, 1024 },
+		{ 16, 1024, 1024 },
+		{ 64, 512, 512 },
+		{ 128, 1024, 1024 },
+		{ 256, 768, 3072 },
+		{ 1000, 256, 64 }
+	};
+
+	CRandom random( 0x3A1 );
+	for( const auto& shape : shapes ) {
+		const int firstHeight = shape[0];
+		const int firstWidth = shape[1];
+		const int secondHeight = shape[2];
+
+		CREATE_FILL_FLOAT_ARRAY( a, -1, 1, firstHeight * firstWidth, random )
+		CREATE_FILL_FLOAT_ARRAY( b, -1, 1, firstWidth * secondHeight, random )
+		std::vector<float> floatResult( firstHeight * secondHeight );
+		std::vector<float> int8Result( firstHeight * secondHeight );
+		CFloatWrapper aWrapper( MathEngine(), a.data(), firstHeight * firstWidth );
+		CFloatWrapper bWrapper( MathEngine(), b.data(), firstWidth * secondHeight );
+		CFloatWrapper floatResultWrapper( MathEngine(), floatResult.data(), firstHeight * secondHeight );
+		CFloatWrapper int8ResultWrapper( MathEngine(), int8Result.data(), firstHeight * secondHeight );
+		CQuantizedMatrixDesc* quantizedDesc = MathEngine().InitQuantizedMatrix( bWrapper, secondHeight, firstWidth );
+
+		// The first runs warm up the caches and the buffers
+		MathEngine().MultiplyMatrixByTransposedMatrix( aWrapper, firstHeight, firstWidth, firstWidth,
+			bWrapper, secondHeight, firstWidth, floatResultWrapper, secondHeight, firstHeight * secondHeight );
+		MathEngine().MultiplyMatrixByTransposedQuantizedMatrix( aWrapper, firstHeight, firstWidth, 0.f,
+			*quantizedDesc, nullptr, CFusedActivation(), int8ResultWrapper );
+
+		auto startTime = high_resolution_clock::now();
+		for( int i = 0; i < runCount; ++i ) {
+			MathEngine().MultiplyMatrixByTransposedMatrix( aWrapper, firstHeight, firstWidth, firstWidth,
+				bWrapper, secondHeight, firstWidth, floatResultWrapper, secondHeight, firstHeight * secondHeight );
+		}
+		const double floatTime = duration<double, std::milli>( high_resolution_clock::now() - startTime ).count() / runCount;
+
+		startTime = high_resolution_clock::now();
+		for( int i = 0; i < runCount; ++i ) {
+			MathEngine().MultiplyMatrixByTransposedQuantizedMatrix( aWrapper, firstHeight, firstWidth, 0.f,
+				*quantizedDesc, nullptr, CFusedActivation(), int8ResultWrapper );
+		}
+		const double int8Time = duration<double, std::milli>( high_resolution_clock::now() - startTime ).count() / runCount;
+		delete quantizedDesc;
+
+		GTEST_LOG_( INFO ) << firstHeight << " x " << firstWidth << " x " << secondHeight
+			<< ": float " << std::setprecision( 3 ) << floatTime << " ms, int8 " << int8Time << " ms, speedup "
+			<< floatTime / int8Time;
+	}
+}
@@ -0,0 +1,147 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+static void scaledDotProductAttentionNaive( int batchSize, int headCount, int headSize, int seqQ, int seqKV, float scale,
+	const std::vector<float>& q, const std::vector<float>& k, const std::vector<float>& v,
+	const float* mask, int maskObjectCount, bool isCausal, const int* kvLengths, std::vector<float>& result )
+{
+	const int rowSize = headCount * headSize;
+	result.assign( batchSize * seqQ * rowSize, 0.f );
+	std::vector<float> scores( seqKV );
+	for( int b = 0; b < batchSize; ++b ) {
+		for( int h = 0; h < headCount; ++h ) {
+			const float* maskMatrix = mask == nullptr ? nullptr
+				: mask + ( maskObjectCount == 1 ? 0 : b * headCount + h ) * seqQ * seqKV;
+			for( int i = 0; i < seqQ; ++i ) {
+				const int kvLength = kvLengths == nullptr ? seqKV : kvLengths[b];
+				const int keyEnd = std::min( kvLength, isCausal ? i + seqKV - seqQ + 1 : seqKV );
+				float maxValue = -FLT_MAX;
+				for( int j = 0; j < keyEnd; ++j ) {
+					float dot = 0;
+					for( int c = 0; c < headSize; ++c ) {
+						dot += q[( b * seqQ + i ) * rowSize + h * headSize + c] * k[( b * seqKV + j ) * rowSize + h * headSize + c];
+					}
+					scores[j] = dot * scale - ( maskMatrix == nullptr ? 0.f : 1e+9f * maskMatrix[i * seqKV + j] );
+					maxValue = std::max( maxValue, scores[j] );
+				}
+				float sum = 0;
+				for( int j = 0; j < keyEnd; ++j ) {
+					scores[j] = std::exp( scores[j] - maxValue );
+					sum += scores[j];
+				}
+				for( int j = 0; j < keyEnd; ++j ) {
+					for( int c = 0; c < headSize; ++c ) {
+						result[( b * seqQ + i ) * rowSize + h * headSize + c] +=
+							scores[j] / sum * v[( b * seqKV + j ) * rowSize + h * headSize + c];
+					}
+				}
+			}
+		}
+	}
+}
+
+static void scaledDotProductAttentionTestImpl( const CTestParams& params, int seed )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( seed );
+
+	const CInterval batchSizeInterval = params.GetInterval( "BatchSize" );
+	const CInterval headCountInterval = params.GetInterval( "HeadCount" );
+	const CInterval headSizeInterval = params.GetInterval( "HeadSize" );
+	const CInterval seqLengthInterval = params.GetInterval( "SeqLength" );
+	// 0 - no mask, 1 - one mask for all the objects, 2 - different masks, 3 - causal
+	const int maskMode = random.UniformInt( 0, 3 );
+
+	const int batchSize = random.UniformInt( batchSizeInterval.Begin, batchSizeInterval.End );
+	const int headCount = random.UniformInt( headCountInterval.Begin, headCountInterval.End );
+	const int headSize = random.UniformInt( headSizeInterval.Begin, headSizeInterval.End );
+	const int seqKV = random.UniformInt( seqLengthInterval.Begin, seqLengthInterval.End );
+	const int seqQ = maskMode == 3 ? random.UniformInt( 1, seqKV ) : random.UniformInt( seqLengthInterval.Begin, seqLengthInterval.End );
+	const int rowSize = headCount * headSize;
+	const float scale = static_cast<float>( 1. / std::sqrt( headSize ) );
+
+	CREATE_FILL_FLOAT_ARRAY( q, -1.f, 1.f, batchSize * seqQ * rowSize, random )
+	CREATE_FILL_FLOAT_ARRAY( k, -1.f, 1.f, batchSize * seqKV * rowSize, random )
+	CREATE_FILL_FLOAT_ARRAY( v, -1.f, 1.f, batchSize * seqKV * rowSize, random )
+
+	const int maskObjectCount = maskMode == 2 ? batchSize * headCount : 1;
+	std::vector<float> mask( maskObjectCount * seqQ * seqKV );
+	for( size_t i = 0; i < mask.size(); ++i ) {
+		mask[i] = random.UniformInt( 0, 3 ) == 0 ? 1.f : 0.f;
+	}
+	const bool useMask = maskMode == 1 || maskMode == 2;
+	const bool isCausal = maskMode == 3;
+	// The numbers of the valid positions of K and V; the rest of the positions are padding
+	const bool useKVLengths = random.UniformInt( 0, 1 ) == 1;
+	std::vector<int> kvLengths( batchSize );
+	for( int b = 0; b < batchSize; ++b ) {
+		kvLengths[b] = random.UniformInt( 1, seqKV );
+	}
+
+	std::vector<float> expected;
+	scaledDotProductAttentionNaive( batchSize, headCount, headSize, seqQ, seqKV, scale, q, k, v,
+		useMask ? mask.data() : nullptr, maskObjectCount, isCausal, useKVLengths ? kvLengths.data() : nullptr, expected );
+
+	CFloatWrapper maskWrapper( MathEngine(), mask.data(), static_cast<int>( mask.size() ) );
+	CConstFloatHandle maskHandle = maskWrapper;
+	CIntWrapper kvLengthsWrapper( MathEngine(), kvLengths.data(), batchSize );
+	CConstIntHandle kvLengthsHandle = kvLengthsWrapper;
+	std::vector<float> result( expected.size() );
+	MathEngine().ScaledDotProductAttention( batchSize, headCount, headSize, seqQ, seqKV, scale,
+		CARRAY_FLOAT_WRAPPER( q ), CARRAY_FLOAT_WRAPPER( k ), CARRAY_FLOAT_WRAPPER( v ),
+		useMask ? &maskHandle : nullptr, maskObjectCount, isCausal, useKVLengths ? &kvLengthsHandle : nullptr,
+		CARRAY_FLOAT_WRAPPER( result ) );
+
+	for( size_t i = 0; i < expected.size(); ++i ) {
+		ASSERT_TRUE( FloatEq( expected[i], result[i], 1e-4f ) );
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+
+class CScaledDotProductAttentionTest : public CTestFixtureWithParams {
+};
+
+INSTANTIATE_TEST_CASE_P( CScaledDotProductAttentionTestInstantiation, CScaledDotProductAttentionTest,
+	::testing::Values(
+		CTestParams(
+			"BatchSize = (1..3);"
+			"HeadCount = (1..4);"
+			"HeadSize = (1..16);"
+			"SeqLength = (1..40);"
+			"TestCount = 100;"
+		),
+		CTestParams(
+			"BatchSize = (1..2);"
+			"HeadCount = (1..8);"
+			"HeadSize = (16..64);"
+			"SeqLength = (100..300);"
+			"TestCount = 10;"
+		)
+	)
+);
+
+TEST_P( CScaledDotProductAttentionTest, Random )
+{
+	RUN_TEST_IMPL( scaledDotProductAttentionTestImpl )
+}
@@ -65,3 +65,28 @@ TEST_P( CMathEngineVectorAddTest, Random )
 {
 	RUN_TEST_IMPL(vectorAddTestImpl);
 }
+
+TEST_F( CMathEngineVectorAddTest, WithReLU )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( 0x5E6F );
+	for( int vectorSize : { 7, 1000, 5000 } ) {
+		CREATE_FILL_FLOAT_ARRAY( a, -10.f, 10.f, vectorSize, random )
+		CREATE_FILL_FLOAT_ARRAY( b, -10.f, 10.f, vectorSize, random )
+		for( float threshold : { 0.f, 4.f } ) {
+			std::vector<float> result( vectorSize );
+			MathEngine().VectorAddWithActivation( CARRAY_FLOAT_WRAPPER( a ), CARRAY_FLOAT_WRAPPER( b ),
+				CARRAY_FLOAT_WRAPPER( result ), vectorSize, CFusedActivation( AF_ReLU, threshold ) );
+			for( int i = 0; i < vectorSize; i++ ) {
+				float expected = std::max( a[i] + b[i], 0.f );
+				if( threshold > 0 ) {
+					expected = std::min( expected, threshold );
+				}
+				ASSERT_EQ( expected, result[i] );
+			}
+		}
+	}
+}
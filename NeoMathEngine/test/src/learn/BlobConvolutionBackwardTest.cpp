@@ -161,6 +161,26 @@ class CMathEngineBlobConvolutionBackwardTest : public CTestFixtureWithParams {
 
 INSTANTIATE_TEST_CASE_P( CMathEngineBlobConvolutionBackwardTestInstantiation, CMathEngineBlobConvolutionBackwardTest,
 	::testing::Values(
+		CTestParams(
+			"InputLength = (1..2);"
+			"InputBatch = (1..2);"
+			"InputHeight = (5..17);"
+			"InputWidth = (5..17);"
+			"InputDepth = (1..2);"
+			"InputChannels = (8..12);"
+			"FilterCount = (9..13);"
+			"FilterHeight = 3;"
+			"FilterWidth = 3;"
+			"PaddingHeight = (0..2);"
+			"PaddingWidth = (0..2);"
+			"DilationHeight = 1;"
+			"DilationWidth = 1;"
+			"StrideHeight = 1;"
+			"StrideWidth = 1;"
+			"IsZeroFreeTerm = (0..1);"
+			"Values = (-2..2);"
+			"TestCount = 20;"
+		),
 		CTestParams(
 			"InputLength = (1..3);"
 			"InputBatch = (1..3);"
@@ -0,0 +1,134 @@
+/* Copyright © 2017-2020 ABBYY Production LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+--------------------------------------------------------------------------------------------------------------*/
+
+#include <TestFixture.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace NeoML;
+using namespace NeoMLTest;
+
+// inputDiff = invSqrtVariance * ( g - mean( g ) - normalized * mean( g * normalized ) ), where g = outputDiff * scale
+static void layerNormalizationBackwardNaive( int objectCount, int objectSize, const float* normalized,
+	const float* invSqrtVariance, const float* scale, const float* outputDiff, float* inputDiff )
+{
+	for( int i = 0; i < objectCount; ++i ) {
+		const float* norm = normalized + i * objectSize;
+		const float* diff = outputDiff + i * objectSize;
+		double meanDiff = 0;
+		double meanDiffNorm = 0;
+		for( int j = 0; j < objectSize; ++j ) {
+			meanDiff += static_cast<double>( diff[j] ) * scale[j];
+			meanDiffNorm += static_cast<double>( diff[j] ) * scale[j] * norm[j];
+		}
+		meanDiff /= objectSize;
+		meanDiffNorm /= objectSize;
+		for( int j = 0; j < objectSize; ++j ) {
+			const double g = static_cast<double>( diff[j] ) * scale[j];
+			inputDiff[i * objectSize + j] = static_cast<float>( invSqrtVariance[i] * ( g - meanDiff - norm[j] * meanDiffNorm ) );
+		}
+	}
+}
+
+static void layerNormalizationBackwardTestImpl( const CTestParams& params, int seed )
+{
+	if( MathEngine().GetType() != MET_Cpu ) {
+		return;
+	}
+
+	CRandom random( seed );
+
+	const CInterval objectCountInterval = params.GetInterval( "ObjectCount" );
+	const CInterval objectSizeInterval = params.GetInterval( "ObjectSize" );
+	const CInterval valuesInterval = params.GetInterval( "Values" );
+
+	const int objectCount = random.UniformInt( objectCountInterval.Begin, objectCountInterval.End );
+	const int objectSize = random.UniformInt( objectSizeInterval.Begin, objectSizeInterval.End );
+	const float epsilon = 1e-5f;
+
+	CREATE_FILL_FLOAT_ARRAY( input, valuesInterval.Begin, valuesInterval.End, objectCount * objectSize, random )
+	CREATE_FILL_FLOAT_ARRAY( scale, valuesInterval.Begin, valuesInterval.End, objectSize, random )
+	CREATE_FILL_FLOAT_ARRAY( bias, valuesInterval.Begin, valuesInterval.End, objectSize, random )
+	CREATE_FILL_FLOAT_ARRAY( outputDiff, valuesInterval.Begin, valuesInterval.End, objectCount * objectSize, random )
+
+	CFloatBlob inputBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	inputBlob.CopyFrom( input.data() );
+	CFloatBlob scaleBlob( MathEngine(), 1, 1, 1, objectSize );
+	scaleBlob.CopyFrom( scale.data() );
+	CFloatBlob biasBlob( MathEngine(), 1, 1, 1, objectSize );
+	biasBlob.CopyFrom( bias.data() );
+	CFloatBlob normalizedBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	CFloatBlob invSqrtVarianceBlob( MathEngine(), 1, 1, 1, objectCount );
+	CFloatBlob resultBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	CFloatHandle normalizedHandle = normalizedBlob.GetData();
+	CFloatHandle invSqrtVarianceHandle = invSqrtVarianceBlob.GetData();
+	MathEngine().LayerNormalization( objectCount, objectSize, inputBlob.GetData(), epsilon, scaleBlob.GetData(),
+		biasBlob.GetData(), resultBlob.GetData(), &normalizedHandle, &invSqrtVarianceHandle );
+
+	std::vector<float> normalized( objectCount * objectSize );
+	normalizedBlob.CopyTo( normalized.data() );
+	std::vector<float> invSqrtVariance( objectCount );
+	invSqrtVarianceBlob.CopyTo( invSqrtVariance.data() );
+	std::vector<float> expected( objectCount * objectSize );
+	layerNormalizationBackwardNaive( objectCount, objectSize, normalized.data(), invSqrtVariance.data(), scale.data(),
+		outputDiff.data(), expected.data() );
+
+	CFloatBlob outputDiffBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	outputDiffBlob.CopyFrom( outputDiff.data() );
+	CFloatBlob inputDiffBlob( MathEngine(), objectCount, 1, 1, objectSize );
+	MathEngine().LayerNormalizationBackward( objectCount, objectSize, normalizedBlob.GetData(), invSqrtVarianceBlob.GetData(),
+		scaleBlob.GetData(), outputDiffBlob.GetData(), inputDiffBlob.GetData() );
+
+	std::vector<float> inputDiff( objectCount * objectSize );
+	inputDiffBlob.CopyTo( inputDiff.data() );
+	for( size_t i = 0; i < inputDiff.size(); ++i ) {
+		ASSERT_NEAR( expected[i], inputDiff[i], 1e-3f * std::max( 1.f, std::fabs( expected[i] ) ) );
+	}
+
+	// In-place calculation
+	MathEngine().LayerNormalizationBackward( objectCount, objectSize, normalizedBlob.GetData(), invSqrtVarianceBlob.GetData(),
+		scaleBlob.GetData(), outputDiffBlob.GetData(), outputDiffBlob.GetData() );
+	outputDiffBlob.CopyTo( inputDiff.data() );
+	for( size_t i = 0; i < inputDiff.size(); ++i ) {
+		ASSERT_NEAR( expected[i], inputDiff[i], 1e-3f * std::max( 1.f, std::fabs( expected[i] ) ) );
+	}
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+class CMathEngineLayerNormalizationBackwardTest : public CTestFixtureWithParams {
+};
+
+INSTANTIATE_TEST_CASE_P( CMathEngineLayerNormalizationBackwardTestInstantiation, CMathEngineLayerNormalizationBackwardTest,
+	::testing::Values(
+		CTestParams(
+			"ObjectCount = (1..50);"
+			"ObjectSize = (2..40);"
+			"Values = (-10..10);"
+			"TestCount = 100;"
+		),
+		CTestParams(
+			"ObjectCount = (1..10);"
+			"ObjectSize = (100..1000);"
+			"Values = (-1..1);"
+			"TestCount = 20;"
+		)
+	)
+);
+
+TEST_P( CMathEngineLayerNormalizationBackwardTest, Random )
+{
+	RUN_TEST_IMPL( layerNormalizationBackwardTestImpl )
+}